@@ -0,0 +1,201 @@
+/*
+ * FreeRTOS lwIP Mailbox Benchmark V1.0.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file sys_arch_mbox_benchmark.c
+ * @brief Measures how many pbufs per second pass through an lwIP mailbox.
+ *
+ * A producer task allocates pool pbufs and posts them to a mailbox the size of
+ * tcpip_thread's, while the calling task fetches and frees them the way
+ * tcpip_thread handles received packets. Run it on the Linux simulator once
+ * with LWIP_FREERTOS_LOCK_FREE_MBOX set to 0 and once with it set to 1 to
+ * compare the two mailbox implementations, and with a batch size above 1 to
+ * measure sys_arch_mbox_fetch_batch().
+ *
+ * To use it, add this file to a build that links lwIP and call
+ * sys_arch_mbox_benchmark() from a task after the scheduler has started.
+ */
+
+/* lwIP includes. */
+#include "lwip/opt.h"
+#include "lwip/sys.h"
+#include "lwip/pbuf.h"
+
+/**
+ * @brief Length of each pbuf, a full Ethernet frame.
+ */
+#ifndef SYS_ARCH_MBOX_BENCHMARK_PBUF_LENGTH
+    #define SYS_ARCH_MBOX_BENCHMARK_PBUF_LENGTH    1514
+#endif
+
+/**
+ * @brief Largest batch size sys_arch_mbox_benchmark() accepts.
+ */
+#ifndef SYS_ARCH_MBOX_BENCHMARK_MAX_BATCH
+    #define SYS_ARCH_MBOX_BENCHMARK_MAX_BATCH    16
+#endif
+
+/**
+ * @brief Stack size of the producer task.
+ */
+#ifndef SYS_ARCH_MBOX_BENCHMARK_STACK_SIZE
+    #define SYS_ARCH_MBOX_BENCHMARK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4 )
+#endif
+
+#if LWIP_FREERTOS_LOCK_FREE_MBOX
+    #define SYS_ARCH_MBOX_BENCHMARK_MBOX_NAME    "lock-free"
+#else
+    #define SYS_ARCH_MBOX_BENCHMARK_MBOX_NAME    "queue"
+#endif
+
+typedef struct BenchmarkContext
+{
+    sys_mbox_t xMbox;
+    sys_sem_t xDone;
+    u32_t ulPbufs;
+    u32_t ulAllocRetries;
+} BenchmarkContext_t;
+
+/*-----------------------------------------------------------*/
+
+static void prvProducerTask( void * pvParameters )
+{
+    BenchmarkContext_t * pxContext = ( BenchmarkContext_t * ) pvParameters;
+    struct pbuf * pxPbuf;
+    u32_t ulPosted;
+
+    for( ulPosted = 0UL; ulPosted < pxContext->ulPbufs; ulPosted++ )
+    {
+        pxPbuf = pbuf_alloc( PBUF_RAW, SYS_ARCH_MBOX_BENCHMARK_PBUF_LENGTH, PBUF_POOL );
+
+        /* The pool is smaller than the mailbox on some configurations, so let
+         * the consumer free some pbufs. */
+        while( pxPbuf == NULL )
+        {
+            pxContext->ulAllocRetries++;
+            taskYIELD();
+            pxPbuf = pbuf_alloc( PBUF_RAW, SYS_ARCH_MBOX_BENCHMARK_PBUF_LENGTH, PBUF_POOL );
+        }
+
+        sys_mbox_post( &( pxContext->xMbox ), pxPbuf );
+    }
+
+    sys_sem_signal( &( pxContext->xDone ) );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Pass pbufs from a producer task to the calling task through a
+ * mailbox and print the rate.
+ *
+ * @param[in] ulPbufs Number of pbufs to pass.
+ * @param[in] ulBatchSize 1 to fetch with sys_arch_mbox_fetch(), otherwise the
+ * most messages each sys_arch_mbox_fetch_batch() call takes.
+ */
+void sys_arch_mbox_benchmark( u32_t ulPbufs,
+                              u32_t ulBatchSize )
+{
+    static BenchmarkContext_t xContext;
+    void * pvMessages[ SYS_ARCH_MBOX_BENCHMARK_MAX_BATCH ];
+    TickType_t xStart, xElapsed;
+    u32_t ulFetched = 0UL, ulCalls = 0UL, ulCount, ulIndex;
+
+    configASSERT( ( ulBatchSize > 0UL ) && ( ulBatchSize <= SYS_ARCH_MBOX_BENCHMARK_MAX_BATCH ) );
+
+    memset( &xContext, 0x00, sizeof( xContext ) );
+    xContext.ulPbufs = ulPbufs;
+
+    if( sys_mbox_new( &( xContext.xMbox ), TCPIP_MBOX_SIZE ) != ERR_OK )
+    {
+        LWIP_PLATFORM_DIAG( ( "mbox benchmark: failed to create the mailbox.\n" ) );
+        return;
+    }
+
+    if( sys_sem_new( &( xContext.xDone ), 0 ) != ERR_OK )
+    {
+        LWIP_PLATFORM_DIAG( ( "mbox benchmark: failed to create the semaphore.\n" ) );
+        sys_mbox_free( &( xContext.xMbox ) );
+        return;
+    }
+
+    xStart = xTaskGetTickCount();
+
+    /* Run the producer at the same priority so the two tasks take turns
+     * the way a driver task and tcpip_thread do. */
+    if( sys_thread_new( "mbox_bench",
+                        prvProducerTask,
+                        &xContext,
+                        SYS_ARCH_MBOX_BENCHMARK_STACK_SIZE,
+                        ( int ) uxTaskPriorityGet( NULL ) ) == NULL )
+    {
+        LWIP_PLATFORM_DIAG( ( "mbox benchmark: failed to create the producer task.\n" ) );
+        sys_sem_free( &( xContext.xDone ) );
+        sys_mbox_free( &( xContext.xMbox ) );
+        return;
+    }
+
+    while( ulFetched < ulPbufs )
+    {
+        if( ulBatchSize == 1UL )
+        {
+            ulCount = ( sys_arch_mbox_fetch( &( xContext.xMbox ), &( pvMessages[ 0 ] ), 0 ) != SYS_ARCH_TIMEOUT ) ? 1UL : 0UL;
+        }
+        else
+        {
+            ulCount = sys_arch_mbox_fetch_batch( &( xContext.xMbox ), pvMessages, ulBatchSize, 0 );
+        }
+
+        for( ulIndex = 0UL; ulIndex < ulCount; ulIndex++ )
+        {
+            ( void ) pbuf_free( ( struct pbuf * ) pvMessages[ ulIndex ] );
+        }
+
+        ulFetched += ulCount;
+        ulCalls++;
+    }
+
+    xElapsed = ( xTaskGetTickCount() - xStart ) * portTICK_PERIOD_MS;
+
+    ( void ) sys_arch_sem_wait( &( xContext.xDone ), 0 );
+    sys_sem_free( &( xContext.xDone ) );
+    sys_mbox_free( &( xContext.xMbox ) );
+
+    if( xElapsed == 0U )
+    {
+        xElapsed = 1U;
+    }
+
+    LWIP_PLATFORM_DIAG( ( "mbox benchmark (%s): %lu pbufs in %lu ms, %lu pbufs/s, "
+                          "batch %lu, %lu fetch calls, %lu allocation retries.\n",
+                          SYS_ARCH_MBOX_BENCHMARK_MBOX_NAME,
+                          ( unsigned long ) ulPbufs,
+                          ( unsigned long ) xElapsed,
+                          ( unsigned long ) ( ( ( uint64_t ) ulPbufs * 1000U ) / xElapsed ),
+                          ( unsigned long ) ulBatchSize,
+                          ( unsigned long ) ulCalls,
+                          ( unsigned long ) xContext.ulAllocRetries ) );
+}
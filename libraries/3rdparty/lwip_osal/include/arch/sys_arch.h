@@ -37,6 +37,20 @@
 #include "queue.h"
 #include "semphr.h"
 
+/* For LWIP_FREERTOS_LOCK_FREE_MBOX set in lwipopts.h. */
+#include "lwip/opt.h"
+
+/**
+ * LWIP_FREERTOS_LOCK_FREE_MBOX: when 1, mailboxes are rings of message
+ * pointers claimed with atomic compare-and-swap instead of FreeRTOS queues.
+ * Posting and fetching only call into the kernel when a task has to block or
+ * be woken, so tcpip_thread drains a busy mailbox without a kernel call per
+ * message. The ring holds the requested size rounded up to a power of 2.
+ */
+#ifndef LWIP_FREERTOS_LOCK_FREE_MBOX
+    #define LWIP_FREERTOS_LOCK_FREE_MBOX    0
+#endif
+
 #define SYS_MBOX_NULL                     ( ( QueueHandle_t ) NULL )
 #define SYS_SEM_NULL                      ( ( SemaphoreHandle_t ) NULL )
 #define SYS_DEFAULT_THREAD_STACK_DEPTH    configMINIMAL_STACK_SIZE
@@ -45,18 +59,56 @@ typedef SemaphoreHandle_t   sys_sem_t;
 typedef SemaphoreHandle_t   sys_mutex_t;
 typedef TaskHandle_t        sys_thread_t;
 
-struct sys_mbox
-{
-    QueueHandle_t xMbox;
-    TaskHandle_t xTask;
-};
-typedef struct sys_mbox sys_mbox_t;
+#if LWIP_FREERTOS_LOCK_FREE_MBOX
+    struct sys_mbox_cell
+    {
+        volatile uint32_t ulSequence; /* Ring index the cell is next posted to, plus one once it holds a message. */
+        void * volatile pvMessage;
+    };
+
+    struct sys_mbox
+    {
+        struct sys_mbox_cell * pxCells;
+        uint32_t ulMask;                  /* Number of cells minus one. */
+        volatile uint32_t ulPostIndex;    /* Next ring index to post to. */
+        volatile uint32_t ulFetchIndex;   /* Next ring index to fetch from. */
+        volatile uint32_t ulPostWaiters;  /* Tasks blocked because the ring is full. */
+        volatile uint32_t ulFetchWaiters; /* Tasks blocked because the ring is empty. */
+        SemaphoreHandle_t xNotFull;
+        SemaphoreHandle_t xNotEmpty;
+        TaskHandle_t volatile xTask;
+    };
+    typedef struct sys_mbox sys_mbox_t;
+
+    #define sys_mbox_valid( x )          ( ( ( ( x ) == NULL ) || ( ( x )->pxCells == NULL ) ) ? pdFALSE : pdTRUE )
+    #define sys_mbox_set_invalid( x )    do { if( ( x ) != NULL ) { ( x )->pxCells = NULL; ( x )->xTask = NULL; } } while( 0 )
+#else /* if LWIP_FREERTOS_LOCK_FREE_MBOX */
+    struct sys_mbox
+    {
+        QueueHandle_t xMbox;
+        TaskHandle_t xTask;
+    };
+    typedef struct sys_mbox sys_mbox_t;
+
+    #define sys_mbox_valid( x )          ( ( ( ( x ) == NULL ) || ( ( x )->xMbox == NULL ) ) ? pdFALSE : pdTRUE )
+    #define sys_mbox_set_invalid( x )    do { if( ( x ) != NULL ) { ( x )->xMbox = NULL; ( x )->xTask = NULL; } } while( 0 )
+#endif /* if LWIP_FREERTOS_LOCK_FREE_MBOX */
 
-#define sys_mbox_valid( x )          ( ( ( ( x ) == NULL ) || ( ( x )->xMbox == NULL ) ) ? pdFALSE : pdTRUE )
-#define sys_mbox_set_invalid( x )    do { if( ( x ) != NULL ) { ( x )->xMbox = NULL; ( x )->xTask = NULL; } } while( 0 )
 #define sys_sem_valid( x )           ( ( ( * x ) == NULL ) ? pdFALSE : pdTRUE )
 #define sys_sem_set_invalid( x )     ( ( * x ) = NULL )
 
+/**
+ * Fetch up to ulMaxMessages messages from a mailbox into ppvBuffer. Blocks
+ * like sys_arch_mbox_fetch() until the first message arrives, then takes
+ * whatever else is already waiting without blocking again.
+ *
+ * @return The number of messages fetched, 0 on timeout.
+ */
+u32_t sys_arch_mbox_fetch_batch( sys_mbox_t * pxMailBox,
+                                 void ** ppvBuffer,
+                                 u32_t ulMaxMessages,
+                                 u32_t ulTimeOut );
+
 #if LWIP_NETCONN_SEM_PER_THREAD
     sys_sem_t * sys_arch_netconn_sem_get( void );
     #define LWIP_NETCONN_THREAD_SEM_GET()    sys_arch_netconn_sem_get()
@@ -48,6 +48,10 @@
 #include "lwip/mem.h"
 #include "lwip/stats.h"
 
+#if LWIP_FREERTOS_LOCK_FREE_MBOX
+    #include "atomic.h"
+#endif
+
 #if !INCLUDE_xTaskAbortDelay
     #error "lwIP FreeRTOS port requires INCLUDE_xTaskAbortDelay"
 #endif
@@ -60,6 +64,149 @@
  * the interrupt handler setting this variable manually. */
 portBASE_TYPE xInsideISR = pdFALSE;
 
+#if LWIP_FREERTOS_LOCK_FREE_MBOX
+
+/* The ring follows Dmitry Vyukov's bounded queue: each cell carries a
+ * sequence number, so posters and fetchers each claim a ring index with one
+ * compare-and-swap and never wait for each other. Any number of tasks and
+ * interrupts may post and fetch. Only one task at a time may block waiting for
+ * a message, as with the queue based mailbox, so sys_mbox_free() knows which
+ * task to wake. */
+
+/*---------------------------------------------------------------------------*
+* Routine:  prvMboxWake
+*---------------------------------------------------------------------------*
+* Description:
+*      Gives a mailbox semaphore if a task is blocked on it. Posting and
+*      fetching only reach the kernel through here, or when they block.
+* Inputs:
+*      SemaphoreHandle_t xSemaphore  -- xNotFull or xNotEmpty
+*      volatile uint32_t *pulWaiters -- Tasks blocked on xSemaphore
+*---------------------------------------------------------------------------*/
+    static void prvMboxWake( SemaphoreHandle_t xSemaphore,
+                             volatile uint32_t * pulWaiters )
+    {
+        portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+        if( *pulWaiters != 0UL )
+        {
+            if( xInsideISR != pdFALSE )
+            {
+                ( void ) xSemaphoreGiveFromISR( xSemaphore, &xHigherPriorityTaskWoken );
+            }
+            else
+            {
+                ( void ) xSemaphoreGive( xSemaphore );
+            }
+        }
+    }
+
+/*---------------------------------------------------------------------------*
+* Routine:  prvMboxPut
+*---------------------------------------------------------------------------*
+* Description:
+*      Posts a message to the ring without blocking and wakes the task
+*      waiting to fetch, if any.
+* Inputs:
+*      sys_mbox_t mbox         -- Handle of mailbox
+*      void *msg               -- Pointer to data to post
+* Outputs:
+*      BaseType_t              -- pdTRUE if posted, pdFALSE if the ring is full
+*---------------------------------------------------------------------------*/
+    static BaseType_t prvMboxPut( sys_mbox_t * pxMailBox,
+                                  void * pvMessage )
+    {
+        struct sys_mbox_cell * pxCell;
+        uint32_t ulIndex = pxMailBox->ulPostIndex;
+        int32_t lDifference;
+        BaseType_t xReturn = pdFALSE;
+
+        for( ; ; )
+        {
+            pxCell = &( pxMailBox->pxCells[ ulIndex & pxMailBox->ulMask ] );
+            lDifference = ( int32_t ) ( pxCell->ulSequence - ulIndex );
+
+            if( lDifference == 0 )
+            {
+                if( Atomic_CompareAndSwap_u32( &( pxMailBox->ulPostIndex ), ulIndex + 1UL, ulIndex ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+                {
+                    pxCell->pvMessage = pvMessage;
+
+                    /* Publish the message to fetchers. */
+                    pxCell->ulSequence = ulIndex + 1UL;
+                    xReturn = pdTRUE;
+                    break;
+                }
+            }
+            else if( lDifference < 0 )
+            {
+                /* The cell still holds the message posted one lap ago. */
+                break;
+            }
+
+            /* Another poster claimed this index first. */
+            ulIndex = pxMailBox->ulPostIndex;
+        }
+
+        if( xReturn == pdTRUE )
+        {
+            prvMboxWake( pxMailBox->xNotEmpty, &( pxMailBox->ulFetchWaiters ) );
+        }
+
+        return xReturn;
+    }
+
+/*---------------------------------------------------------------------------*
+* Routine:  prvMboxGet
+*---------------------------------------------------------------------------*
+* Description:
+*      Fetches a message from the ring without blocking. The caller wakes
+*      blocked posters with prvMboxWake().
+* Inputs:
+*      sys_mbox_t mbox         -- Handle of mailbox
+*      void **msg              -- Pointer to pointer to msg received
+* Outputs:
+*      BaseType_t              -- pdTRUE if fetched, pdFALSE if the ring is
+*                                  empty
+*---------------------------------------------------------------------------*/
+    static BaseType_t prvMboxGet( sys_mbox_t * pxMailBox,
+                                  void ** ppvBuffer )
+    {
+        struct sys_mbox_cell * pxCell;
+        uint32_t ulIndex = pxMailBox->ulFetchIndex;
+        int32_t lDifference;
+        BaseType_t xReturn = pdFALSE;
+
+        for( ; ; )
+        {
+            pxCell = &( pxMailBox->pxCells[ ulIndex & pxMailBox->ulMask ] );
+            lDifference = ( int32_t ) ( pxCell->ulSequence - ( ulIndex + 1UL ) );
+
+            if( lDifference == 0 )
+            {
+                if( Atomic_CompareAndSwap_u32( &( pxMailBox->ulFetchIndex ), ulIndex + 1UL, ulIndex ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+                {
+                    *ppvBuffer = pxCell->pvMessage;
+
+                    /* Hand the cell back to posters for the next lap. */
+                    pxCell->ulSequence = ulIndex + pxMailBox->ulMask + 1UL;
+                    xReturn = pdTRUE;
+                    break;
+                }
+            }
+            else if( lDifference < 0 )
+            {
+                /* Nothing has been posted to this index yet. */
+                break;
+            }
+
+            /* Another fetcher claimed this index first. */
+            ulIndex = pxMailBox->ulFetchIndex;
+        }
+
+        return xReturn;
+    }
+
 /*---------------------------------------------------------------------------*
 * Routine:  sys_mbox_new
 *---------------------------------------------------------------------------*
@@ -70,25 +217,55 @@ portBASE_TYPE xInsideISR = pdFALSE;
 * Outputs:
 *      sys_mbox_t              -- Handle to new mailbox
 *---------------------------------------------------------------------------*/
-err_t sys_mbox_new( sys_mbox_t * pxMailBox,
-                    int iSize )
-{
-    err_t xReturn = ERR_MEM;
-    sys_mbox_t pxTempMbox;
+    err_t sys_mbox_new( sys_mbox_t * pxMailBox,
+                        int iSize )
+    {
+        err_t xReturn = ERR_MEM;
+        sys_mbox_t xTempMbox;
+        uint32_t ulCells = 1UL;
+        uint32_t ulIndex;
 
-    pxTempMbox.xMbox = xQueueCreate( iSize, sizeof( void * ) );
+        while( ( int ) ulCells < iSize )
+        {
+            ulCells <<= 1;
+        }
 
-    if( pxTempMbox.xMbox != NULL )
-    {
-        pxTempMbox.xTask = NULL;
-        *pxMailBox = pxTempMbox;
-        xReturn = ERR_OK;
-        SYS_STATS_INC_USED( mbox );
-    }
+        memset( &xTempMbox, 0x00, sizeof( xTempMbox ) );
+        xTempMbox.pxCells = pvPortMalloc( ulCells * sizeof( struct sys_mbox_cell ) );
+        xTempMbox.xNotEmpty = xSemaphoreCreateBinary();
 
-    return xReturn;
-}
+        /* Every fetch may free a cell for a different blocked poster. */
+        xTempMbox.xNotFull = xSemaphoreCreateCounting( ulCells, 0 );
+
+        if( ( xTempMbox.pxCells != NULL ) && ( xTempMbox.xNotEmpty != NULL ) && ( xTempMbox.xNotFull != NULL ) )
+        {
+            for( ulIndex = 0UL; ulIndex < ulCells; ulIndex++ )
+            {
+                xTempMbox.pxCells[ ulIndex ].ulSequence = ulIndex;
+            }
+
+            xTempMbox.ulMask = ulCells - 1UL;
+            *pxMailBox = xTempMbox;
+            xReturn = ERR_OK;
+            SYS_STATS_INC_USED( mbox );
+        }
+        else
+        {
+            if( xTempMbox.xNotFull != NULL )
+            {
+                vSemaphoreDelete( xTempMbox.xNotFull );
+            }
+
+            if( xTempMbox.xNotEmpty != NULL )
+            {
+                vSemaphoreDelete( xTempMbox.xNotEmpty );
+            }
+
+            vPortFree( xTempMbox.pxCells );
+        }
 
+        return xReturn;
+    }
 
 /*---------------------------------------------------------------------------*
 * Routine:  sys_mbox_free
@@ -99,46 +276,45 @@ err_t sys_mbox_new( sys_mbox_t * pxMailBox,
 *      programming error in lwIP and the developer should be notified.
 * Inputs:
 *      sys_mbox_t mbox         -- Handle of mailbox
-* Outputs:
-*      sys_mbox_t              -- Handle to new mailbox
 *---------------------------------------------------------------------------*/
-void sys_mbox_free( sys_mbox_t * pxMailBox )
-{
-    unsigned long ulMessagesWaiting;
-    QueueHandle_t xMbox;
-    TaskHandle_t xTask;
-    sys_mbox_t volatile * pvxMailBox = pxMailBox;
-
-    if( pvxMailBox != NULL )
+    void sys_mbox_free( sys_mbox_t * pxMailBox )
     {
-        ulMessagesWaiting = uxQueueMessagesWaiting( pvxMailBox->xMbox );
-        configASSERT( ( ulMessagesWaiting == 0 ) );
+        unsigned long ulMessagesWaiting;
+        struct sys_mbox_cell * pxCells;
+        TaskHandle_t xTask;
 
-        #if SYS_STATS
-            {
-                if( ulMessagesWaiting != 0UL )
+        if( pxMailBox != NULL )
+        {
+            ulMessagesWaiting = pxMailBox->ulPostIndex - pxMailBox->ulFetchIndex;
+            configASSERT( ( ulMessagesWaiting == 0 ) );
+
+            #if SYS_STATS
                 {
-                    SYS_STATS_INC( mbox.err );
+                    if( ulMessagesWaiting != 0UL )
+                    {
+                        SYS_STATS_INC( mbox.err );
+                    }
+
+                    SYS_STATS_DEC( mbox.used );
                 }
+            #endif /* SYS_STATS */
 
-                SYS_STATS_DEC( mbox.used );
-            }
-        #endif /* SYS_STATS */
+            taskENTER_CRITICAL();
+            pxCells = pxMailBox->pxCells;
+            xTask = pxMailBox->xTask;
+            pxMailBox->pxCells = NULL;
+            taskEXIT_CRITICAL();
 
-        taskENTER_CRITICAL();
-        xMbox = pvxMailBox->xMbox;
-        xTask = pvxMailBox->xTask;
-        pvxMailBox->xMbox = NULL;
-        taskEXIT_CRITICAL();
+            if( xTask != NULL )
+            {
+                xTaskAbortDelay( xTask );
+            }
 
-        if( xTask != NULL )
-        {
-            xTaskAbortDelay( xTask );
+            vSemaphoreDelete( pxMailBox->xNotFull );
+            vSemaphoreDelete( pxMailBox->xNotEmpty );
+            vPortFree( pxCells );
         }
-
-        vQueueDelete( xMbox );
     }
-}
 
 /*---------------------------------------------------------------------------*
 * Routine:  sys_mbox_post
@@ -149,13 +325,26 @@ void sys_mbox_free( sys_mbox_t * pxMailBox )
 *      sys_mbox_t mbox         -- Handle of mailbox
 *      void *data              -- Pointer to data to post
 *---------------------------------------------------------------------------*/
-void sys_mbox_post( sys_mbox_t * pxMailBox,
-                    void * pxMessageToPost )
-{
-    while( xQueueSendToBack( pxMailBox->xMbox, &pxMessageToPost, portMAX_DELAY ) != pdTRUE )
+    void sys_mbox_post( sys_mbox_t * pxMailBox,
+                        void * pxMessageToPost )
     {
+        BaseType_t xPosted = prvMboxPut( pxMailBox, pxMessageToPost );
+
+        while( xPosted == pdFALSE )
+        {
+            /* Count this task as waiting before trying again, so a fetch that
+             * frees a cell after the retry fails always gives xNotFull. */
+            ( void ) Atomic_Increment_u32( &( pxMailBox->ulPostWaiters ) );
+            xPosted = prvMboxPut( pxMailBox, pxMessageToPost );
+
+            if( xPosted == pdFALSE )
+            {
+                ( void ) xSemaphoreTake( pxMailBox->xNotFull, portMAX_DELAY );
+            }
+
+            ( void ) Atomic_Decrement_u32( &( pxMailBox->ulPostWaiters ) );
+        }
     }
-}
 
 /*---------------------------------------------------------------------------*
 * Routine:  sys_mbox_trypost
@@ -170,46 +359,300 @@ void sys_mbox_post( sys_mbox_t * pxMailBox,
 *      err_t                   -- ERR_OK if message posted, else ERR_MEM
 *                                  if not.
 *---------------------------------------------------------------------------*/
-err_t sys_mbox_trypost( sys_mbox_t * pxMailBox,
-                        void * pxMessageToPost )
-{
-    err_t xReturn;
-    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+    err_t sys_mbox_trypost( sys_mbox_t * pxMailBox,
+                            void * pxMessageToPost )
+    {
+        err_t xReturn;
 
-    if( xInsideISR != pdFALSE )
+        if( prvMboxPut( pxMailBox, pxMessageToPost ) == pdTRUE )
+        {
+            xReturn = ERR_OK;
+        }
+        else
+        {
+            /* The mailbox was already full. */
+            xReturn = ERR_MEM;
+            SYS_STATS_INC( mbox.err );
+        }
+
+        return xReturn;
+    }
+
+/*---------------------------------------------------------------------------*
+* Routine:  sys_arch_mbox_fetch
+*---------------------------------------------------------------------------*
+* Description:
+*      Blocks the thread until a message arrives in the mailbox, but does
+*      not block the thread longer than "timeout" milliseconds (similar to
+*      the sys_arch_sem_wait() function). The "msg" argument is a result
+*      parameter that is set by the function (i.e., by doing "*msg =
+*      ptr"). The "msg" parameter maybe NULL to indicate that the message
+*      should be dropped.
+*
+*      A message that is already waiting is fetched without calling into
+*      the kernel.
+* Inputs:
+*      sys_mbox_t mbox         -- Handle of mailbox
+*      void **msg              -- Pointer to pointer to msg received
+*      u32_t timeout           -- Number of milliseconds until timeout
+* Outputs:
+*      u32_t                   -- SYS_ARCH_TIMEOUT if timeout, else 1
+*---------------------------------------------------------------------------*/
+    u32_t sys_arch_mbox_fetch( sys_mbox_t * pxMailBox,
+                               void ** ppvBuffer,
+                               u32_t ulTimeOut )
     {
-        xReturn = xQueueSendFromISR( pxMailBox->xMbox, &pxMessageToPost, &xHigherPriorityTaskWoken );
+        void * pvDummy;
+        unsigned long ulReturn = SYS_ARCH_TIMEOUT;
+        TickType_t xTicksToWait = portMAX_DELAY;
+        TimeOut_t xTimeOut;
+        BaseType_t xResult = pdFALSE;
+        BaseType_t xTimedOut = pdFALSE;
+
+        if( ( pxMailBox == NULL ) || ( pxMailBox->pxCells == NULL ) )
+        {
+            goto exit;
+        }
+
+        if( NULL == ppvBuffer )
+        {
+            ppvBuffer = &pvDummy;
+        }
+
+        xResult = prvMboxGet( pxMailBox, ppvBuffer );
+
+        if( ulTimeOut != 0UL )
+        {
+            xTicksToWait = ulTimeOut / portTICK_PERIOD_MS;
+        }
+
+        /* Only one task may block on the mailbox. */
+        if( ( xResult == pdFALSE ) &&
+            ( xTicksToWait != 0U ) &&
+            ( Atomic_CompareAndSwapPointers_p32( ( void * volatile * ) &( pxMailBox->xTask ),
+                                                 xTaskGetCurrentTaskHandle(),
+                                                 NULL ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS ) )
+        {
+            configASSERT( xInsideISR == ( portBASE_TYPE ) 0 );
+
+            vTaskSetTimeOutState( &xTimeOut );
+
+            while( ( xResult == pdFALSE ) && ( xTimedOut == pdFALSE ) && ( pxMailBox->pxCells != NULL ) )
+            {
+                /* Count this task as waiting before trying again, so a post
+                 * after the retry fails always gives xNotEmpty. */
+                ( void ) Atomic_Increment_u32( &( pxMailBox->ulFetchWaiters ) );
+                xResult = prvMboxGet( pxMailBox, ppvBuffer );
+
+                if( xResult == pdFALSE )
+                {
+                    xTimedOut = xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait );
+
+                    if( xTimedOut == pdFALSE )
+                    {
+                        ( void ) xSemaphoreTake( pxMailBox->xNotEmpty, xTicksToWait );
+                    }
+                }
+
+                ( void ) Atomic_Decrement_u32( &( pxMailBox->ulFetchWaiters ) );
+            }
+
+            pxMailBox->xTask = NULL;
+        }
+
+        if( xResult == pdTRUE )
+        {
+            prvMboxWake( pxMailBox->xNotFull, &( pxMailBox->ulPostWaiters ) );
+            ulReturn = 1UL;
+        }
+        else
+        {
+            /* Timed out. */
+            *ppvBuffer = NULL;
+        }
+
+exit:
+        return ulReturn;
     }
-    else
+
+/*---------------------------------------------------------------------------*
+* Routine:  sys_arch_mbox_tryfetch
+*---------------------------------------------------------------------------*
+* Description:
+*      Similar to sys_arch_mbox_fetch, but if message is not ready
+*      immediately, we'll return with SYS_MBOX_EMPTY.  On success, 0 is
+*      returned.
+* Inputs:
+*      sys_mbox_t mbox         -- Handle of mailbox
+*      void **msg              -- Pointer to pointer to msg received
+* Outputs:
+*      u32_t                   -- SYS_MBOX_EMPTY if no messages.  Otherwise,
+*                                  return ERR_OK.
+*---------------------------------------------------------------------------*/
+    u32_t sys_arch_mbox_tryfetch( sys_mbox_t * pxMailBox,
+                                  void ** ppvBuffer )
+    {
+        void * pvDummy;
+        unsigned long ulReturn;
+
+        if( ppvBuffer == NULL )
+        {
+            ppvBuffer = &pvDummy;
+        }
+
+        if( prvMboxGet( pxMailBox, ppvBuffer ) == pdTRUE )
+        {
+            prvMboxWake( pxMailBox->xNotFull, &( pxMailBox->ulPostWaiters ) );
+            ulReturn = ERR_OK;
+        }
+        else
+        {
+            ulReturn = SYS_MBOX_EMPTY;
+        }
+
+        return ulReturn;
+    }
+
+#else /* if LWIP_FREERTOS_LOCK_FREE_MBOX */
+
+/*---------------------------------------------------------------------------*
+* Routine:  sys_mbox_new
+*---------------------------------------------------------------------------*
+* Description:
+*      Creates a new mailbox
+* Inputs:
+*      int size                -- Size of elements in the mailbox
+* Outputs:
+*      sys_mbox_t              -- Handle to new mailbox
+*---------------------------------------------------------------------------*/
+    err_t sys_mbox_new( sys_mbox_t * pxMailBox,
+                        int iSize )
     {
-        xReturn = xQueueSend( pxMailBox->xMbox, &pxMessageToPost, ( TickType_t ) 0 );
+        err_t xReturn = ERR_MEM;
+        sys_mbox_t pxTempMbox;
+
+        pxTempMbox.xMbox = xQueueCreate( iSize, sizeof( void * ) );
+
+        if( pxTempMbox.xMbox != NULL )
+        {
+            pxTempMbox.xTask = NULL;
+            *pxMailBox = pxTempMbox;
+            xReturn = ERR_OK;
+            SYS_STATS_INC_USED( mbox );
+        }
+
+        return xReturn;
     }
 
-    if( xReturn == pdPASS )
+
+/*---------------------------------------------------------------------------*
+* Routine:  sys_mbox_free
+*---------------------------------------------------------------------------*
+* Description:
+*      Deallocates a mailbox. If there are messages still present in the
+*      mailbox when the mailbox is deallocated, it is an indication of a
+*      programming error in lwIP and the developer should be notified.
+* Inputs:
+*      sys_mbox_t mbox         -- Handle of mailbox
+* Outputs:
+*      sys_mbox_t              -- Handle to new mailbox
+*---------------------------------------------------------------------------*/
+    void sys_mbox_free( sys_mbox_t * pxMailBox )
     {
-        xReturn = ERR_OK;
+        unsigned long ulMessagesWaiting;
+        QueueHandle_t xMbox;
+        TaskHandle_t xTask;
+        sys_mbox_t volatile * pvxMailBox = pxMailBox;
+
+        if( pvxMailBox != NULL )
+        {
+            ulMessagesWaiting = uxQueueMessagesWaiting( pvxMailBox->xMbox );
+            configASSERT( ( ulMessagesWaiting == 0 ) );
+
+            #if SYS_STATS
+                {
+                    if( ulMessagesWaiting != 0UL )
+                    {
+                        SYS_STATS_INC( mbox.err );
+                    }
+
+                    SYS_STATS_DEC( mbox.used );
+                }
+            #endif /* SYS_STATS */
+
+            taskENTER_CRITICAL();
+            xMbox = pvxMailBox->xMbox;
+            xTask = pvxMailBox->xTask;
+            pvxMailBox->xMbox = NULL;
+            taskEXIT_CRITICAL();
+
+            if( xTask != NULL )
+            {
+                xTaskAbortDelay( xTask );
+            }
+
+            vQueueDelete( xMbox );
+        }
     }
-    else
+
+/*---------------------------------------------------------------------------*
+* Routine:  sys_mbox_post
+*---------------------------------------------------------------------------*
+* Description:
+*      Post the "msg" to the mailbox.
+* Inputs:
+*      sys_mbox_t mbox         -- Handle of mailbox
+*      void *data              -- Pointer to data to post
+*---------------------------------------------------------------------------*/
+    void sys_mbox_post( sys_mbox_t * pxMailBox,
+                        void * pxMessageToPost )
     {
-        /* The queue was already full. */
-        xReturn = ERR_MEM;
-        SYS_STATS_INC( mbox.err );
+        while( xQueueSendToBack( pxMailBox->xMbox, &pxMessageToPost, portMAX_DELAY ) != pdTRUE )
+        {
+        }
     }
 
-    return xReturn;
-}
+/*---------------------------------------------------------------------------*
+* Routine:  sys_mbox_trypost
+*---------------------------------------------------------------------------*
+* Description:
+*      Try to post the "msg" to the mailbox.  Returns immediately with
+*      error if cannot.
+* Inputs:
+*      sys_mbox_t mbox         -- Handle of mailbox
+*      void *msg               -- Pointer to data to post
+* Outputs:
+*      err_t                   -- ERR_OK if message posted, else ERR_MEM
+*                                  if not.
+*---------------------------------------------------------------------------*/
+    err_t sys_mbox_trypost( sys_mbox_t * pxMailBox,
+                            void * pxMessageToPost )
+    {
+        err_t xReturn;
+        portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 
-err_t sys_mbox_trypost_fromisr( sys_mbox_t * pxMailBox,
-                                void * pxMessageToPost )
-{
-    err_t xReturn;
+        if( xInsideISR != pdFALSE )
+        {
+            xReturn = xQueueSendFromISR( pxMailBox->xMbox, &pxMessageToPost, &xHigherPriorityTaskWoken );
+        }
+        else
+        {
+            xReturn = xQueueSend( pxMailBox->xMbox, &pxMessageToPost, ( TickType_t ) 0 );
+        }
 
-    xInsideISR = pdTRUE;
-    xReturn = sys_mbox_trypost( pxMailBox, pxMessageToPost );
-    xInsideISR = pdFALSE;
+        if( xReturn == pdPASS )
+        {
+            xReturn = ERR_OK;
+        }
+        else
+        {
+            /* The queue was already full. */
+            xReturn = ERR_MEM;
+            SYS_STATS_INC( mbox.err );
+        }
 
-    return xReturn;
-}
+        return xReturn;
+    }
 
 /*---------------------------------------------------------------------------*
 * Routine:  sys_arch_mbox_fetch
@@ -235,80 +678,80 @@ err_t sys_mbox_trypost_fromisr( sys_mbox_t * pxMailBox,
 * Outputs:
 *      u32_t                   -- SYS_ARCH_TIMEOUT if timeout, else 1
 *---------------------------------------------------------------------------*/
-u32_t sys_arch_mbox_fetch( sys_mbox_t * pxMailBox,
-                           void ** ppvBuffer,
-                           u32_t ulTimeOut )
-{
-    void * pvDummy;
-    unsigned long ulReturn = SYS_ARCH_TIMEOUT;
-    QueueHandle_t xMbox;
-    TaskHandle_t xTask;
-    BaseType_t xResult;
-    sys_mbox_t volatile * pvxMailBox = pxMailBox;
-
-    if( pvxMailBox == NULL )
-    {
-        goto exit;
-    }
-
-    taskENTER_CRITICAL();
-    xMbox = pvxMailBox->xMbox;
-    xTask = xTaskGetCurrentTaskHandle();
-
-    if( ( xMbox != NULL ) && ( xTask != NULL ) && ( pvxMailBox->xTask == NULL ) )
-    {
-        pvxMailBox->xTask = xTask;
-    }
-    else
-    {
-        xMbox = NULL;
-    }
-
-    taskEXIT_CRITICAL();
-
-    if( xMbox == NULL )
-    {
-        goto exit;
-    }
-
-    if( NULL == ppvBuffer )
+    u32_t sys_arch_mbox_fetch( sys_mbox_t * pxMailBox,
+                               void ** ppvBuffer,
+                               u32_t ulTimeOut )
     {
-        ppvBuffer = &pvDummy;
-    }
+        void * pvDummy;
+        unsigned long ulReturn = SYS_ARCH_TIMEOUT;
+        QueueHandle_t xMbox;
+        TaskHandle_t xTask;
+        BaseType_t xResult;
+        sys_mbox_t volatile * pvxMailBox = pxMailBox;
+
+        if( pvxMailBox == NULL )
+        {
+            goto exit;
+        }
 
-    if( ulTimeOut != 0UL )
-    {
-        configASSERT( xInsideISR == ( portBASE_TYPE ) 0 );
+        taskENTER_CRITICAL();
+        xMbox = pvxMailBox->xMbox;
+        xTask = xTaskGetCurrentTaskHandle();
 
-        if( pdTRUE == xQueueReceive( xMbox, &( *ppvBuffer ), ulTimeOut / portTICK_PERIOD_MS ) )
+        if( ( xMbox != NULL ) && ( xTask != NULL ) && ( pvxMailBox->xTask == NULL ) )
         {
-            ulReturn = 1UL;
+            pvxMailBox->xTask = xTask;
         }
         else
         {
-            /* Timed out. */
-            *ppvBuffer = NULL;
+            xMbox = NULL;
         }
-    }
-    else
-    {
-        for( xResult = pdFALSE; ( xMbox != NULL ) && ( xResult != pdTRUE ); )
+
+        taskEXIT_CRITICAL();
+
+        if( xMbox == NULL )
         {
-            xResult = xQueueReceive( xMbox, &( *ppvBuffer ), portMAX_DELAY );
-            xMbox = pvxMailBox->xMbox;
+            goto exit;
         }
 
-        if( xResult == pdTRUE )
+        if( NULL == ppvBuffer )
         {
-            ulReturn = 1UL;
+            ppvBuffer = &pvDummy;
         }
-    }
 
-    pvxMailBox->xTask = NULL;
+        if( ulTimeOut != 0UL )
+        {
+            configASSERT( xInsideISR == ( portBASE_TYPE ) 0 );
+
+            if( pdTRUE == xQueueReceive( xMbox, &( *ppvBuffer ), ulTimeOut / portTICK_PERIOD_MS ) )
+            {
+                ulReturn = 1UL;
+            }
+            else
+            {
+                /* Timed out. */
+                *ppvBuffer = NULL;
+            }
+        }
+        else
+        {
+            for( xResult = pdFALSE; ( xMbox != NULL ) && ( xResult != pdTRUE ); )
+            {
+                xResult = xQueueReceive( xMbox, &( *ppvBuffer ), portMAX_DELAY );
+                xMbox = pvxMailBox->xMbox;
+            }
+
+            if( xResult == pdTRUE )
+            {
+                ulReturn = 1UL;
+            }
+        }
+
+        pvxMailBox->xTask = NULL;
 
 exit:
-    return ulReturn;
-}
+        return ulReturn;
+    }
 
 /*---------------------------------------------------------------------------*
 * Routine:  sys_arch_mbox_tryfetch
@@ -324,38 +767,90 @@ exit:
 *      u32_t                   -- SYS_MBOX_EMPTY if no messages.  Otherwise,
 *                                  return ERR_OK.
 *---------------------------------------------------------------------------*/
-u32_t sys_arch_mbox_tryfetch( sys_mbox_t * pxMailBox,
-                              void ** ppvBuffer )
-{
-    void * pvDummy;
-    unsigned long ulReturn;
-    long lResult;
-    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-
-    if( ppvBuffer == NULL )
+    u32_t sys_arch_mbox_tryfetch( sys_mbox_t * pxMailBox,
+                                  void ** ppvBuffer )
     {
-        ppvBuffer = &pvDummy;
-    }
+        void * pvDummy;
+        unsigned long ulReturn;
+        long lResult;
+        portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 
-    if( xInsideISR != pdFALSE )
-    {
-        lResult = xQueueReceiveFromISR( pxMailBox->xMbox, &( *ppvBuffer ), &xHigherPriorityTaskWoken );
-    }
-    else
-    {
-        lResult = xQueueReceive( pxMailBox->xMbox, &( *ppvBuffer ), 0UL );
-    }
+        if( ppvBuffer == NULL )
+        {
+            ppvBuffer = &pvDummy;
+        }
 
-    if( lResult == pdPASS )
-    {
-        ulReturn = ERR_OK;
+        if( xInsideISR != pdFALSE )
+        {
+            lResult = xQueueReceiveFromISR( pxMailBox->xMbox, &( *ppvBuffer ), &xHigherPriorityTaskWoken );
+        }
+        else
+        {
+            lResult = xQueueReceive( pxMailBox->xMbox, &( *ppvBuffer ), 0UL );
+        }
+
+        if( lResult == pdPASS )
+        {
+            ulReturn = ERR_OK;
+        }
+        else
+        {
+            ulReturn = SYS_MBOX_EMPTY;
+        }
+
+        return ulReturn;
     }
-    else
+#endif /* if LWIP_FREERTOS_LOCK_FREE_MBOX */
+
+err_t sys_mbox_trypost_fromisr( sys_mbox_t * pxMailBox,
+                                void * pxMessageToPost )
+{
+    err_t xReturn;
+
+    xInsideISR = pdTRUE;
+    xReturn = sys_mbox_trypost( pxMailBox, pxMessageToPost );
+    xInsideISR = pdFALSE;
+
+    return xReturn;
+}
+
+
+/*---------------------------------------------------------------------------*
+* Routine:  sys_arch_mbox_fetch_batch
+*---------------------------------------------------------------------------*
+* Description:
+*      Blocks like sys_arch_mbox_fetch() until the first message arrives,
+*      then fetches up to "max" messages in total without blocking again,
+*      so a thread that owns its receive loop handles a burst of messages
+*      per wakeup.
+* Inputs:
+*      sys_mbox_t mbox         -- Handle of mailbox
+*      void **msgs             -- Array of at least "max" message pointers
+*      u32_t max               -- Most messages to fetch
+*      u32_t timeout           -- Number of milliseconds until timeout
+* Outputs:
+*      u32_t                   -- Number of messages fetched, 0 if timeout
+*---------------------------------------------------------------------------*/
+u32_t sys_arch_mbox_fetch_batch( sys_mbox_t * pxMailBox,
+                                 void ** ppvBuffer,
+                                 u32_t ulMaxMessages,
+                                 u32_t ulTimeOut )
+{
+    u32_t ulFetched = 0UL;
+
+    if( ( ulMaxMessages > 0UL ) &&
+        ( sys_arch_mbox_fetch( pxMailBox, &( ppvBuffer[ 0 ] ), ulTimeOut ) != SYS_ARCH_TIMEOUT ) )
     {
-        ulReturn = SYS_MBOX_EMPTY;
+        for( ulFetched = 1UL; ulFetched < ulMaxMessages; ulFetched++ )
+        {
+            if( sys_arch_mbox_tryfetch( pxMailBox, &( ppvBuffer[ ulFetched ] ) ) != ERR_OK )
+            {
+                break;
+            }
+        }
     }
 
-    return ulReturn;
+    return ulFetched;
 }
 
 /*---------------------------------------------------------------------------*
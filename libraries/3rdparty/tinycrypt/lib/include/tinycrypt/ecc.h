@@ -103,6 +103,29 @@ typedef uint64_t uECC_dword_t;
 
 /* Number of words of 32 bits to represent an element of the the curve p-256: */
 #define NUM_ECC_WORDS 8
+
+/*
+ * On little endian 64-bit hosts with a 128-bit integer type, field
+ * multiplication works on 64-bit limbs and the p-256 reduction sums its
+ * terms in 64-bit accumulators. The stored representation is unchanged.
+ * Define uECC_NO_VLI64 to use the 32-bit code everywhere.
+ */
+#if !defined(uECC_NO_VLI64) && defined(__SIZEOF_INT128__) && \
+	defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define uECC_VLI64 1
+#else
+#define uECC_VLI64 0
+#endif
+
+/*
+ * Precomputed multiples of the p-256 generator (1.5 KB of constant data):
+ * a signed comb for computing public keys and signatures in constant time,
+ * and odd multiples for verifying signatures. Enabled by default where
+ * uECC_VLI64 is; define to 0 or 1 to override.
+ */
+#ifndef uECC_FIXED_BASE_TABLES
+#define uECC_FIXED_BASE_TABLES uECC_VLI64
+#endif
 /* Number of bytes to represent an element of the the curve p-256: */
 #define NUM_ECC_BYTES (uECC_WORD_SIZE*NUM_ECC_WORDS)
 
@@ -303,6 +326,21 @@ void EccPoint_mult(uECC_word_t * result, const uECC_word_t * point,
 		   const uECC_word_t * scalar, const uECC_word_t * initial_Z,
 		   bitcount_t num_bits, uECC_Curve curve);
 
+/*
+ * @brief Computes u1 * G + u2 * point with Shamir's trick, sharing the point
+ * doublings between both scalars. Not constant time: for public scalars only,
+ * as in signature verification.
+ * @return Returns 1 on success, 0 if the result is the point at infinity.
+ * @param result OUT -- returns u1 * G + u2 * point
+ * @param u1 IN -- scalar for the generator
+ * @param u2 IN -- scalar for point
+ * @param point IN -- elliptic curve point
+ * @param curve IN -- elliptic curve
+ */
+uECC_word_t EccPoint_mult_twin(uECC_word_t * result, const uECC_word_t * u1,
+			       const uECC_word_t * u2,
+			       const uECC_word_t * point, uECC_Curve curve);
+
 /*
  * @brief Constant-time comparison to zero - secure way to compare long integers
  * @param vli IN -- very long integer
@@ -88,6 +88,30 @@ uint8_t _double_byte(uint8_t a);
  */
 int _compare(const uint8_t *a, const uint8_t *b, size_t size);
 
+/*
+ * Hardware acceleration of SHA-256 and AES encryption is compiled in for
+ * x86-64 and little endian AArch64 Linux hosts built with GCC or Clang, and
+ * used when the CPU supports it. Define TC_NO_HW_ACCEL to build the portable
+ * C code only.
+ */
+#if !defined(TC_NO_HW_ACCEL) && defined(__GNUC__) && defined(__x86_64__)
+#define TC_HW_ACCEL_X86
+#elif !defined(TC_NO_HW_ACCEL) && defined(__GNUC__) && defined(__aarch64__) && \
+	defined(__linux__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define TC_HW_ACCEL_ARM64
+#endif
+
+#define TC_CPU_SHA256 (1u << 0) /* SHA-NI or the ARMv8 SHA-256 instructions */
+#define TC_CPU_AES (1u << 1) /* AES-NI or the ARMv8 AES instructions */
+
+/*
+ * @brief Detect the crypto extensions of the running CPU. The result is
+ * cached after the first call.
+ * @return Returns a mask of TC_CPU_* flags, 0 if hardware acceleration is
+ * not compiled in
+ */
+unsigned int _cpu_features(void);
+
 #ifdef __cplusplus
 }
 #endif
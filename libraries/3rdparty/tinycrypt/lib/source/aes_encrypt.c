@@ -34,6 +34,12 @@
 #include <tinycrypt/utils.h>
 #include <tinycrypt/constants.h>
 
+#if defined(TC_HW_ACCEL_X86)
+#include <immintrin.h>
+#elif defined(TC_HW_ACCEL_ARM64)
+#include <arm_neon.h>
+#endif
+
 static const uint8_t sbox[256] = {
 	0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b,
 	0xfe, 0xd7, 0xab, 0x76, 0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0,
@@ -155,6 +161,59 @@ static inline void shift_rows(uint8_t *s)
 	(void) _copy(s, sizeof(t), t, sizeof(t));
 }
 
+#if defined(TC_HW_ACCEL_X86)
+/*
+ * AES-NI. The key schedule holds each word as a big endian integer, so the
+ * round keys are byte swapped as they are loaded.
+ */
+__attribute__((target("aes,ssse3")))
+static void encrypt_aesni(uint8_t *out, const uint8_t *in,
+			  const TCAesKeySched_t s)
+{
+	const __m128i bswap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11,
+					   4, 5, 6, 7, 0, 1, 2, 3);
+	__m128i state;
+	unsigned int i;
+
+	state = _mm_xor_si128(_mm_loadu_si128((const __m128i *) in),
+		_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) s->words), bswap));
+
+	for (i = 1; i < Nr; ++i) {
+		state = _mm_aesenc_si128(state, _mm_shuffle_epi8(_mm_loadu_si128(
+			(const __m128i *) (s->words + Nb*i)), bswap));
+	}
+
+	state = _mm_aesenclast_si128(state, _mm_shuffle_epi8(_mm_loadu_si128(
+		(const __m128i *) (s->words + Nb*Nr)), bswap));
+	_mm_storeu_si128((__m128i *) out, state);
+}
+#elif defined(TC_HW_ACCEL_ARM64)
+/*
+ * ARMv8 crypto extensions. aese adds the round key before SubBytes and
+ * ShiftRows, so the last key is added on its own.
+ */
+__attribute__((target("+crypto")))
+static void encrypt_armv8(uint8_t *out, const uint8_t *in,
+			  const TCAesKeySched_t s)
+{
+	uint8x16_t state;
+	unsigned int i;
+
+	state = vld1q_u8(in);
+
+	for (i = 0; i < (Nr - 1); ++i) {
+		state = vaesmcq_u8(vaeseq_u8(state, vrev32q_u8(vld1q_u8(
+			(const uint8_t *) (s->words + Nb*i)))));
+	}
+
+	state = vaeseq_u8(state, vrev32q_u8(vld1q_u8(
+		(const uint8_t *) (s->words + Nb*i))));
+	state = veorq_u8(state, vrev32q_u8(vld1q_u8(
+		(const uint8_t *) (s->words + Nb*Nr))));
+	vst1q_u8(out, state);
+}
+#endif
+
 int tc_aes_encrypt(uint8_t *out, const uint8_t *in, const TCAesKeySched_t s)
 {
 	uint8_t state[Nk*Nb];
@@ -168,6 +227,18 @@ int tc_aes_encrypt(uint8_t *out, const uint8_t *in, const TCAesKeySched_t s)
 		return TC_CRYPTO_FAIL;
 	}
 
+#if defined(TC_HW_ACCEL_X86)
+	if (_cpu_features() & TC_CPU_AES) {
+		encrypt_aesni(out, in, s);
+		return TC_CRYPTO_SUCCESS;
+	}
+#elif defined(TC_HW_ACCEL_ARM64)
+	if (_cpu_features() & TC_CPU_AES) {
+		encrypt_armv8(out, in, s);
+		return TC_CRYPTO_SUCCESS;
+	}
+#endif
+
 	(void)_copy(state, sizeof(state), in, sizeof(state));
 	add_round_key(state, s->words);
 
@@ -255,6 +255,82 @@ static void muladd(uECC_word_t a, uECC_word_t b, uECC_word_t *r0,
 
 }
 
+#if uECC_VLI64
+typedef unsigned __int128 uECC_qword_t;
+
+/* Computes result = left * right for 256-bit values, on 64-bit limbs. */
+static void vli_mult_64(uECC_word_t *result, const uECC_word_t *left,
+			const uECC_word_t *right)
+{
+	uint64_t a[4], b[4], r[8];
+	uint64_t r0 = 0, r1 = 0, r2 = 0;
+	uint64_t lo, hi;
+	uECC_qword_t p;
+	int i, k;
+
+	memcpy(a, left, sizeof(a));
+	memcpy(b, right, sizeof(b));
+
+	/* Compute each limb of the result in sequence, maintaining the carries. */
+	for (k = 0; k < 7; ++k) {
+		for (i = (k < 4 ? 0 : k - 3); i <= (k < 4 ? k : 3); ++i) {
+			p = (uECC_qword_t)a[i] * b[k - i];
+			lo = (uint64_t)p;
+			hi = (uint64_t)(p >> 64);
+			r0 += lo;
+			hi += (r0 < lo);
+			r1 += hi;
+			r2 += (r1 < hi);
+		}
+		r[k] = r0;
+		r0 = r1;
+		r1 = r2;
+		r2 = 0;
+	}
+	r[7] = r0;
+
+	memcpy(result, r, sizeof(r));
+}
+
+/* Computes result = left^2 for a 256-bit value, on 64-bit limbs. Each cross
+ * product is computed once and doubled. */
+static void vli_square_64(uECC_word_t *result, const uECC_word_t *left)
+{
+	uint64_t a[4], r[8] = { 0 };
+	uint64_t carry;
+	uECC_qword_t p;
+	int i, j;
+
+	memcpy(a, left, sizeof(a));
+
+	for (i = 0; i < 4; ++i) {
+		carry = 0;
+		for (j = i + 1; j < 4; ++j) {
+			p = (uECC_qword_t)a[i] * a[j] + r[i + j] + carry;
+			r[i + j] = (uint64_t)p;
+			carry = (uint64_t)(p >> 64);
+		}
+		r[i + 4] = carry;
+	}
+
+	for (i = 7; i > 0; --i) {
+		r[i] = (r[i] << 1) | (r[i - 1] >> 63);
+	}
+
+	carry = 0;
+	for (i = 0; i < 4; ++i) {
+		p = (uECC_qword_t)a[i] * a[i];
+		p += (uECC_qword_t)r[2 * i] + carry;
+		r[2 * i] = (uint64_t)p;
+		p = (uECC_qword_t)r[2 * i + 1] + (uint64_t)(p >> 64);
+		r[2 * i + 1] = (uint64_t)p;
+		carry = (uint64_t)(p >> 64);
+	}
+
+	memcpy(result, r, sizeof(r));
+}
+#endif
+
 /* Computes result = left * right. Result must be 2 * num_words long. */
 static void uECC_vli_mult(uECC_word_t *result, const uECC_word_t *left,
 			  const uECC_word_t *right, wordcount_t num_words)
@@ -265,6 +341,13 @@ static void uECC_vli_mult(uECC_word_t *result, const uECC_word_t *left,
 	uECC_word_t r2 = 0;
 	wordcount_t i, k;
 
+#if uECC_VLI64
+	if (num_words == NUM_ECC_WORDS) {
+		vli_mult_64(result, left, right);
+		return;
+	}
+#endif
+
 	/* Compute each digit of result in sequence, maintaining the carries. */
 	for (k = 0; k < num_words; ++k) {
 
@@ -383,7 +466,13 @@ static void uECC_vli_modSquare_fast(uECC_word_t *result,
 				    const uECC_word_t *left,
 				    uECC_Curve curve)
 {
+#if uECC_VLI64
+	uECC_word_t product[2 * NUM_ECC_WORDS];
+	vli_square_64(product, left);
+	curve->mmod_fast(result, product);
+#else
 	uECC_vli_modMult_fast(result, left, left, curve);
+#endif
 }
 
 
@@ -518,6 +607,59 @@ uECC_Curve uECC_secp256r1(void)
 	return &curve_secp256r1;
 }
 
+#if uECC_VLI64
+/* The same reduction with each result word's terms summed at once in a signed
+ * 64-bit accumulator, rather than adding and subtracting whole numbers. */
+void vli_mmod_fast_secp256r1(unsigned int *result, unsigned int*product)
+{
+	int64_t acc;
+	int carry;
+	uint64_t a[16];
+	int i;
+
+	for (i = 0; i < 16; ++i) {
+		a[i] = product[i];
+	}
+
+	/* t + 2s1 + 2s2 + s3 + s4 - d1 - d2 - d3 - d4, word by word */
+	acc = (int64_t)(a[0] + a[8] + a[9]) - (int64_t)(a[11] + a[12] + a[13] + a[14]);
+	result[0] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)(a[1] + a[9] + a[10]) - (int64_t)(a[12] + a[13] + a[14] + a[15]);
+	result[1] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)(a[2] + a[10] + a[11]) - (int64_t)(a[13] + a[14] + a[15]);
+	result[2] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)(a[3] + 2 * a[11] + 2 * a[12] + a[13]) - (int64_t)(a[15] + a[8] + a[9]);
+	result[3] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)(a[4] + 2 * a[12] + 2 * a[13] + a[14]) - (int64_t)(a[9] + a[10]);
+	result[4] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)(a[5] + 2 * a[13] + 2 * a[14] + a[15]) - (int64_t)(a[10] + a[11]);
+	result[5] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)(a[6] + 3 * a[14] + 2 * a[15] + a[13]) - (int64_t)(a[8] + a[9]);
+	result[6] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)(a[7] + 3 * a[15] + a[8]) - (int64_t)(a[10] + a[11] + a[12] + a[13]);
+	result[7] = (unsigned int)acc;
+	carry = (int)(acc >> 32);
+
+	if (carry < 0) {
+		do {
+			carry += uECC_vli_add(result, result, curve_secp256r1.p, NUM_ECC_WORDS);
+		}
+		while (carry < 0);
+	} else  {
+		while (carry || 
+		       uECC_vli_cmp_unsafe(curve_secp256r1.p, result, NUM_ECC_WORDS) != 1) {
+			carry -= uECC_vli_sub(result, result, curve_secp256r1.p, NUM_ECC_WORDS);
+		}
+	}
+}
+#else
 void vli_mmod_fast_secp256r1(unsigned int *result, unsigned int*product)
 {
 	unsigned int tmp[NUM_ECC_WORDS];
@@ -618,6 +760,7 @@ void vli_mmod_fast_secp256r1(unsigned int *result, unsigned int*product)
 		}
 	}
 }
+#endif
 
 uECC_word_t EccPoint_isZero(const uECC_word_t *point, uECC_Curve curve)
 {
@@ -771,6 +914,349 @@ void EccPoint_mult(uECC_word_t * result, const uECC_word_t * point,
 	uECC_vli_set(result + num_words, Ry[0], num_words);
 }
 
+#if uECC_FIXED_BASE_TABLES
+/* Adds the affine point (x2, y2) to the Jacobian point (X1, Y1, Z1), whose
+ * x and y are in co-Z form with Z1. x2 and y2 are overwritten. Returns 0,
+ * leaving (X1, Y1, Z1) unchanged, if the points are equal or opposite, which
+ * the co-Z addition can't handle. */
+static uECC_word_t add_affine(uECC_word_t * X1, uECC_word_t * Y1,
+			      uECC_word_t * Z1, uECC_word_t * x2,
+			      uECC_word_t * y2, uECC_Curve curve)
+{
+	uECC_word_t tz[NUM_ECC_WORDS];
+	wordcount_t num_words = curve->num_words;
+
+	apply_z(x2, y2, Z1, curve);
+	uECC_vli_modSub(tz, X1, x2, curve->p, num_words); /* Z = x1 - x2 */
+	if (uECC_vli_isZero(tz, num_words)) {
+		return 0;
+	}
+	XYcZ_add(x2, y2, X1, Y1, curve);
+	uECC_vli_modMult_fast(Z1, Z1, tz, curve);
+	return 1;
+}
+
+/*
+ * Signed comb with COMB_TEETH teeth spaced COMB_COLUMNS bits apart, see
+ * "Fast elliptic curve scalar multiplication resistant against side channel
+ * attacks" (Hedabou, Pinel, Beneteau). Entry i is
+ * G + i_0 * 2^64 G + i_1 * 2^128 G + i_2 * 2^192 G.
+ */
+#define COMB_TEETH 4
+#define COMB_COLUMNS 64
+#define COMB_SIGN 0x80
+
+static const uECC_word_t comb_secp256r1[8][NUM_ECC_WORDS * 2] = {
+	{ BYTES_TO_WORDS_8(96, C2, 98, D8, 45, 39, A1, F4),
+	  BYTES_TO_WORDS_8(A0, 33, EB, 2D, 81, 7D, 03, 77),
+	  BYTES_TO_WORDS_8(F2, 40, A4, 63, E5, E6, BC, F8),
+	  BYTES_TO_WORDS_8(47, 42, 2C, E1, F2, D1, 17, 6B),
+	  BYTES_TO_WORDS_8(F5, 51, BF, 37, 68, 40, B6, CB),
+	  BYTES_TO_WORDS_8(CE, 5E, 31, 6B, 57, 33, CE, 2B),
+	  BYTES_TO_WORDS_8(16, 9E, 0F, 7C, 4A, EB, E7, 8E),
+	  BYTES_TO_WORDS_8(9B, 7F, 1A, FE, E2, 42, E3, 4F) },
+	{ BYTES_TO_WORDS_8(AF, 92, 79, 09, E2, 1C, 39, 93),
+	  BYTES_TO_WORDS_8(FA, F1, 35, 0D, FD, 98, 6C, E9),
+	  BYTES_TO_WORDS_8(89, 27, E0, 95, DE, C0, 57, B2),
+	  BYTES_TO_WORDS_8(6F, 72, D6, 89, BC, 4B, 0A, 30),
+	  BYTES_TO_WORDS_8(A0, 27, 81, C0, 91, A2, 54, AA),
+	  BYTES_TO_WORDS_8(A5, 06, D8, A9, AD, EE, B1, 5B),
+	  BYTES_TO_WORDS_8(6F, 3C, 1E, FF, 25, DB, 1D, 7F),
+	  BYTES_TO_WORDS_8(44, 46, 9B, D0, E0, C7, AA, 72) },
+	{ BYTES_TO_WORDS_8(7F, 36, 1D, 2A, 93, 9C, 94, 13),
+	  BYTES_TO_WORDS_8(B7, 11, 0A, 1A, 2B, BD, 7F, EF),
+	  BYTES_TO_WORDS_8(60, FC, 1D, B9, 8B, 06, C6, DD),
+	  BYTES_TO_WORDS_8(FF, 72, 9C, 8A, 32, 19, 95, EF),
+	  BYTES_TO_WORDS_8(A8, D8, 76, 73, A7, 35, 60, 19),
+	  BYTES_TO_WORDS_8(40, 17, CA, 95, 08, 3B, 18, 23),
+	  BYTES_TO_WORDS_8(9C, 21, 2C, 02, 07, 98, EE, C1),
+	  BYTES_TO_WORDS_8(9B, 2C, BB, 7D, C3, 9F, 1E, 61) },
+	{ BYTES_TO_WORDS_8(01, DE, 5C, FC, FF, CA, 8E, E4),
+	  BYTES_TO_WORDS_8(26, 5F, 71, 0D, E7, 84, CD, 7C),
+	  BYTES_TO_WORDS_8(91, 43, 3E, F4, 83, F4, E8, A2),
+	  BYTES_TO_WORDS_8(EA, 41, 11, B2, 45, 77, 5D, EB),
+	  BYTES_TO_WORDS_8(79, 34, 1A, 73, E2, 17, C9, CA),
+	  BYTES_TO_WORDS_8(45, B6, 44, 28, FE, 2C, F2, 85),
+	  BYTES_TO_WORDS_8(EE, 6C, 00, 58, A1, E6, 90, 09),
+	  BYTES_TO_WORDS_8(7B, C1, EC, DB, EB, 72, FD, EA) },
+	{ BYTES_TO_WORDS_8(3E, 8A, 7C, 67, 04, 8C, F4, 2D),
+	  BYTES_TO_WORDS_8(6B, A5, 03, 02, 08, 2F, E0, 74),
+	  BYTES_TO_WORDS_8(DB, FE, C7, B8, 7D, 5F, 85, 31),
+	  BYTES_TO_WORDS_8(AD, DD, C9, 72, 76, 9E, 76, 4E),
+	  BYTES_TO_WORDS_8(B0, BB, 24, B8, 65, 61, C3, A4),
+	  BYTES_TO_WORDS_8(A5, 22, 91, 3B, 6F, E1, 9A, FB),
+	  BYTES_TO_WORDS_8(81, 72, 94, 06, 72, 05, C0, 1E),
+	  BYTES_TO_WORDS_8(63, 06, 83, DE, 82, 90, B9, 42) },
+	{ BYTES_TO_WORDS_8(73, 35, 1A, C3, D2, 1E, 99, 7F),
+	  BYTES_TO_WORDS_8(96, B4, 4F, D5, 5B, DD, 82, 5B),
+	  BYTES_TO_WORDS_8(AE, FC, 2F, 81, 20, 52, 5C, 59),
+	  BYTES_TO_WORDS_8(87, 12, 6B, 71, 4D, BC, 88, 0C),
+	  BYTES_TO_WORDS_8(A8, AC, 48, 5F, 63, BF, 57, 3A),
+	  BYTES_TO_WORDS_8(F3, 64, 25, DF, F4, 81, 81, 7C),
+	  BYTES_TO_WORDS_8(AA, E6, 04, 9C, B3, B5, D1, 18),
+	  BYTES_TO_WORDS_8(C6, 1D, 90, F3, A3, DE, 5D, DD) },
+	{ BYTES_TO_WORDS_8(7F, 2E, 58, A2, 89, 47, 6B, D3),
+	  BYTES_TO_WORDS_8(28, 9C, C3, 4E, 14, 10, 1A, 0D),
+	  BYTES_TO_WORDS_8(A0, D7, BA, ED, C3, 62, 3C, 66),
+	  BYTES_TO_WORDS_8(B9, 1D, 46, 6F, 4B, BF, 52, 40),
+	  BYTES_TO_WORDS_8(EB, 25, 8D, 18, C3, 27, 5A, 23),
+	  BYTES_TO_WORDS_8(5B, CC, BF, 99, 39, F3, 24, E7),
+	  BYTES_TO_WORDS_8(C8, 0C, D7, 71, BD, E6, 2B, 86),
+	  BYTES_TO_WORDS_8(61, FC, B0, 90, 51, 4D, CF, FE) },
+	{ BYTES_TO_WORDS_8(E5, 78, 1D, 0D, 11, B5, 15, 96),
+	  BYTES_TO_WORDS_8(4B, 74, C4, 25, 32, DE, B0, 66),
+	  BYTES_TO_WORDS_8(3A, 36, AF, 6A, FB, 46, 4A, 0A),
+	  BYTES_TO_WORDS_8(1C, A2, F7, 84, B4, 26, 8E, B4),
+	  BYTES_TO_WORDS_8(2D, 1B, A0, 21, F6, B0, EB, 06),
+	  BYTES_TO_WORDS_8(98, 0F, 7B, 8B, 04, E4, 04, C0),
+	  BYTES_TO_WORDS_8(68, F6, D6, FE, CD, 1B, 13, 64),
+	  BYTES_TO_WORDS_8(AB, 3D, 4D, 4D, 40, 15, C0, FA) }
+};
+
+/* The odd multiples G, 3G, 5G, ..., 31G, for width 6 NAF digits. */
+#define ODD_G_WIDTH 6
+static const uECC_word_t odd_secp256r1[16][NUM_ECC_WORDS * 2] = {
+	{ BYTES_TO_WORDS_8(96, C2, 98, D8, 45, 39, A1, F4),
+	  BYTES_TO_WORDS_8(A0, 33, EB, 2D, 81, 7D, 03, 77),
+	  BYTES_TO_WORDS_8(F2, 40, A4, 63, E5, E6, BC, F8),
+	  BYTES_TO_WORDS_8(47, 42, 2C, E1, F2, D1, 17, 6B),
+	  BYTES_TO_WORDS_8(F5, 51, BF, 37, 68, 40, B6, CB),
+	  BYTES_TO_WORDS_8(CE, 5E, 31, 6B, 57, 33, CE, 2B),
+	  BYTES_TO_WORDS_8(16, 9E, 0F, 7C, 4A, EB, E7, 8E),
+	  BYTES_TO_WORDS_8(9B, 7F, 1A, FE, E2, 42, E3, 4F) },
+	{ BYTES_TO_WORDS_8(6C, FD, E7, C6, 1B, 66, 41, FB),
+	  BYTES_TO_WORDS_8(85, A9, AD, EF, 21, B7, C6, E6),
+	  BYTES_TO_WORDS_8(65, F1, 4B, 1D, 95, EF, F7, C8),
+	  BYTES_TO_WORDS_8(44, 0A, 33, A6, D1, E4, CB, 5E),
+	  BYTES_TO_WORDS_8(32, 50, 7D, A2, 27, B1, 79, 9A),
+	  BYTES_TO_WORDS_8(3D, B8, 4F, 38, 36, B0, 2A, D8),
+	  BYTES_TO_WORDS_8(EC, A2, 64, 1A, CE, 06, 4B, 37),
+	  BYTES_TO_WORDS_8(7E, FF, 98, 49, 0C, 64, 34, 87) },
+	{ BYTES_TO_WORDS_8(ED, 33, D0, C3, 0D, 4A, 55, 21),
+	  BYTES_TO_WORDS_8(24, E5, 5B, 1F, FD, 82, 8C, EF),
+	  BYTES_TO_WORDS_8(DF, 8F, 66, 08, 56, C8, 84, D7),
+	  BYTES_TO_WORDS_8(D2, 40, 51, 51, 7A, 0B, 59, 51),
+	  BYTES_TO_WORDS_8(A4, 6D, A1, FD, 44, BB, D0, D1),
+	  BYTES_TO_WORDS_8(88, 08, D8, D4, 00, 2F, 01, 0D),
+	  BYTES_TO_WORDS_8(26, 79, 8A, BF, 36, BF, E1, 8A),
+	  BYTES_TO_WORDS_8(7D, 72, 4A, 90, A8, 7D, C1, E0) },
+	{ BYTES_TO_WORDS_8(A3, B2, 87, 31, 70, 28, 06, 30),
+	  BYTES_TO_WORDS_8(5B, EF, 0F, A8, B8, F8, F9, 7E),
+	  BYTES_TO_WORDS_8(60, FB, 01, 7C, 66, 30, BB, 25),
+	  BYTES_TO_WORDS_8(46, 7B, BF, A0, 6F, 3B, 53, 8E),
+	  BYTES_TO_WORDS_8(B4, 00, F4, C1, 86, 1A, 5E, C5),
+	  BYTES_TO_WORDS_8(21, 1B, 04, CB, 33, 36, C7, 53),
+	  BYTES_TO_WORDS_8(00, 90, F5, A6, 83, 9F, 06, 6D),
+	  BYTES_TO_WORDS_8(36, 18, 33, E0, BD, 1D, EB, 73) },
+	{ BYTES_TO_WORDS_8(E0, 9E, 94, 90, 4B, 8A, 9E, D7),
+	  BYTES_TO_WORDS_8(B3, F8, 6D, 2C, 8C, CB, 0A, 9E),
+	  BYTES_TO_WORDS_8(72, F8, 71, 1D, D5, 38, 89, 87),
+	  BYTES_TO_WORDS_8(71, 0B, DF, FE, B6, D7, 68, EA),
+	  BYTES_TO_WORDS_8(FA, 48, D0, 4D, 4A, 22, 5A, E8),
+	  BYTES_TO_WORDS_8(3F, 82, DE, A4, EA, 4F, 71, 4D),
+	  BYTES_TO_WORDS_8(C8, A0, 8E, 4A, 96, 4A, 01, 87),
+	  BYTES_TO_WORDS_8(E7, FC, C9, 72, C9, 44, 27, 2A) },
+	{ BYTES_TO_WORDS_8(D1, 21, BC, 74, D3, 91, 33, 43),
+	  BYTES_TO_WORDS_8(BF, 48, 50, 25, D0, 2E, 74, 16),
+	  BYTES_TO_WORDS_8(DA, 1C, C2, B0, 9D, 37, 38, 06),
+	  BYTES_TO_WORDS_8(59, 4C, 3B, 88, B7, 13, D1, 3E),
+	  BYTES_TO_WORDS_8(40, 37, 2A, E8, FC, EE, F8, E2),
+	  BYTES_TO_WORDS_8(DA, 89, 98, 5E, DA, 04, 0D, 09),
+	  BYTES_TO_WORDS_8(8A, C6, F4, A4, AF, 43, C8, 24),
+	  BYTES_TO_WORDS_8(A2, C8, C4, CC, 9A, 20, 99, 90) },
+	{ BYTES_TO_WORDS_8(01, 2C, 07, 46, 9D, 5D, E1, 98),
+	  BYTES_TO_WORDS_8(8A, D5, EA, 65, 4B, 28, 2E, 79),
+	  BYTES_TO_WORDS_8(FC, E2, 5E, D8, F2, 5D, 80, 61),
+	  BYTES_TO_WORDS_8(5A, 49, AC, E0, 7A, 83, 7C, 17),
+	  BYTES_TO_WORDS_8(D8, BF, C7, EF, E2, BB, 43, 9C),
+	  BYTES_TO_WORDS_8(F3, 4D, FB, A1, C3, 14, EE, 26),
+	  BYTES_TO_WORDS_8(72, 4E, 0F, B4, AD, 91, 40, A2),
+	  BYTES_TO_WORDS_8(58, A5, BE, 4E, CD, 58, BB, 63) },
+	{ BYTES_TO_WORDS_8(5F, 9D, 9B, E5, 63, 8C, 66, 63),
+	  BYTES_TO_WORDS_8(F1, 0E, 3A, DE, 92, AF, 03, AE),
+	  BYTES_TO_WORDS_8(65, 82, 88, 99, 89, 37, FB, AD),
+	  BYTES_TO_WORDS_8(E7, BA, 1A, 97, C6, 4D, 45, F0),
+	  BYTES_TO_WORDS_8(36, 4F, 03, 0D, DE, 9C, E5, 47),
+	  BYTES_TO_WORDS_8(3F, FA, B5, 75, CE, 21, 3B, 2A),
+	  BYTES_TO_WORDS_8(E6, 43, 96, 1F, E5, 94, 65, 4E),
+	  BYTES_TO_WORDS_8(1F, 2D, 2E, 59, E3, 3E, B9, B5) },
+	{ BYTES_TO_WORDS_8(3E, A7, 38, 47, E3, BC, 1A, BA),
+	  BYTES_TO_WORDS_8(F8, 4A, D6, F0, 78, 86, A6, 5F),
+	  BYTES_TO_WORDS_8(1A, 30, 75, 6F, B6, 84, 09, 9C),
+	  BYTES_TO_WORDS_8(3A, CC, F1, C0, 04, 69, 77, 47),
+	  BYTES_TO_WORDS_8(DC, FC, F1, 71, FF, 87, F7, 32),
+	  BYTES_TO_WORDS_8(3F, 73, D5, 28, 44, 80, B2, 81),
+	  BYTES_TO_WORDS_8(83, 8E, 64, 77, 65, 85, 31, 62),
+	  BYTES_TO_WORDS_8(28, 57, B9, B5, E6, 5E, 00, AA) },
+	{ BYTES_TO_WORDS_8(83, ED, 03, AB, 74, 7B, FC, C1),
+	  BYTES_TO_WORDS_8(95, 48, 88, 57, 22, 45, 2C, 78),
+	  BYTES_TO_WORDS_8(07, C5, 08, 71, C1, B7, 39, CE),
+	  BYTES_TO_WORDS_8(25, 0C, 2C, 10, 61, 28, 6D, CB),
+	  BYTES_TO_WORDS_8(AA, CD, CE, 2B, 75, 50, 91, E3),
+	  BYTES_TO_WORDS_8(03, 3E, FA, 30, 6E, 71, 96, A4),
+	  BYTES_TO_WORDS_8(E4, 6C, 6D, 0D, 10, E7, 35, 5C),
+	  BYTES_TO_WORDS_8(51, EF, D9, 24, 4B, 61, D7, 58) },
+	{ BYTES_TO_WORDS_8(83, 9E, 39, 67, 4E, 36, 76, FD),
+	  BYTES_TO_WORDS_8(23, 15, 2B, F4, 39, 21, 58, 3A),
+	  BYTES_TO_WORDS_8(A5, BC, 73, B4, 6E, C8, 4A, 2E),
+	  BYTES_TO_WORDS_8(7B, 7C, 63, 86, F6, FC, 50, 32),
+	  BYTES_TO_WORDS_8(09, 8C, D4, 71, A0, 24, DE, 15),
+	  BYTES_TO_WORDS_8(82, 6A, 56, 3B, C3, D3, 7C, 89),
+	  BYTES_TO_WORDS_8(8C, B8, 7E, 1D, 0D, 09, B3, 97),
+	  BYTES_TO_WORDS_8(93, 35, 7D, 66, 42, C3, E7, 42) },
+	{ BYTES_TO_WORDS_8(96, 78, CA, 45, 30, 57, 2E, 67),
+	  BYTES_TO_WORDS_8(FE, A4, 64, DF, A5, C0, 0B, 3C),
+	  BYTES_TO_WORDS_8(A6, 3F, 58, D4, 39, 3E, 8A, D2),
+	  BYTES_TO_WORDS_8(D7, 40, 26, 9C, 23, C7, 91, 0E),
+	  BYTES_TO_WORDS_8(55, AD, 40, 31, 54, 46, 80, 13),
+	  BYTES_TO_WORDS_8(AE, A5, E7, 75, 35, 83, 68, 7E),
+	  BYTES_TO_WORDS_8(6D, BD, E0, B8, 3B, 73, 22, 1A),
+	  BYTES_TO_WORDS_8(22, BA, 0D, 55, 3B, 5C, F6, 5D) },
+	{ BYTES_TO_WORDS_8(87, D6, 00, F2, 45, DC, A4, 84),
+	  BYTES_TO_WORDS_8(24, 1B, 6F, B7, C5, 2F, 65, 41),
+	  BYTES_TO_WORDS_8(84, FA, 07, 8C, 2D, F5, F4, 85),
+	  BYTES_TO_WORDS_8(B6, 0B, 0C, 4B, 55, E2, 67, 3A),
+	  BYTES_TO_WORDS_8(24, 93, F7, 02, B3, 16, ED, A9),
+	  BYTES_TO_WORDS_8(8A, 61, A7, 35, F7, 8A, 18, 8C),
+	  BYTES_TO_WORDS_8(0D, FB, 3A, 16, 67, F2, DA, 26),
+	  BYTES_TO_WORDS_8(43, CF, 1F, 2F, 87, F1, D0, 27) },
+	{ BYTES_TO_WORDS_8(D1, 83, 08, 3B, 17, 01, E2, F2),
+	  BYTES_TO_WORDS_8(AB, 54, 3E, 68, BD, 55, 63, 57),
+	  BYTES_TO_WORDS_8(78, F3, 11, 46, AC, 2F, BA, DE),
+	  BYTES_TO_WORDS_8(51, 0D, D8, 19, 58, FA, 4F, 18),
+	  BYTES_TO_WORDS_8(6F, 6E, 90, 60, C2, 42, D2, 20),
+	  BYTES_TO_WORDS_8(16, 49, F0, 63, CC, EC, BD, 45),
+	  BYTES_TO_WORDS_8(95, 99, CB, 26, 08, D9, C6, A4),
+	  BYTES_TO_WORDS_8(59, F3, 88, 66, 27, 6E, A6, C0) },
+	{ BYTES_TO_WORDS_8(EF, 4D, 78, 1C, 3D, 69, DD, DE),
+	  BYTES_TO_WORDS_8(41, 8A, B5, 88, C6, D1, 8C, FD),
+	  BYTES_TO_WORDS_8(8C, 3B, 85, 90, A0, 6D, C3, A7),
+	  BYTES_TO_WORDS_8(07, 5B, 19, FA, DE, 3A, D3, D6),
+	  BYTES_TO_WORDS_8(A6, BC, D1, 93, 45, 12, 0C, 55),
+	  BYTES_TO_WORDS_8(ED, ED, 95, 4B, AB, 66, A1, 09),
+	  BYTES_TO_WORDS_8(CB, 5D, 8A, 55, 5F, 24, 78, 3F),
+	  BYTES_TO_WORDS_8(7E, 5D, 19, EE, 16, BA, AA, 84) },
+	{ BYTES_TO_WORDS_8(8B, 5B, B4, A1, A0, 9A, 3F, 3E),
+	  BYTES_TO_WORDS_8(3E, 5B, A9, 52, 7D, DB, C9, FA),
+	  BYTES_TO_WORDS_8(A0, 9A, AE, A7, 26, A0, 5D, A8),
+	  BYTES_TO_WORDS_8(5D, E0, C7, 2D, 50, 9E, 1D, 30),
+	  BYTES_TO_WORDS_8(67, E2, 7E, A1, AE, B6, 8D, D5),
+	  BYTES_TO_WORDS_8(61, CA, 87, 68, E4, 9A, 8D, 29),
+	  BYTES_TO_WORDS_8(72, 7D, 01, 6B, 02, 3C, D2, E0),
+	  BYTES_TO_WORDS_8(23, 12, 06, B3, F6, B6, 51, 65) }
+};
+
+/* Recodes the odd scalar k into COMB_COLUMNS + 1 comb digits, each odd so no
+ * digit is the point at infinity. Bit 7 of a digit is its sign. */
+static void comb_recode(uint8_t *x, const uECC_word_t *k)
+{
+	unsigned int i, j;
+	uint8_t c = 0, cc, adjust;
+
+	for (i = 0; i < COMB_COLUMNS; ++i) {
+		x[i] = 0;
+		for (j = 0; j < COMB_TEETH; ++j) {
+			x[i] |= (uint8_t)(uECC_vli_testBit(k, i + COMB_COLUMNS * j) != 0) << j;
+		}
+	}
+	x[COMB_COLUMNS] = 0;
+
+	for (i = 1; i <= COMB_COLUMNS; ++i) {
+		/* add the carry and update it */
+		cc = x[i] & c;
+		x[i] = x[i] ^ c;
+		c = cc;
+
+		/* if x[i] is even, borrow x[i - 1] from it and negate x[i - 1] */
+		adjust = 1 - (x[i] & 0x01);
+		c |= x[i] & (x[i - 1] * adjust);
+		x[i] = x[i] ^ (x[i - 1] * adjust);
+		x[i - 1] |= adjust << 7;
+	}
+}
+
+/* Loads the comb entry for digit into (x, y), reading every entry so the
+ * memory access pattern does not depend on the digit. */
+static void comb_select(uECC_word_t *x, uECC_word_t *y, uint8_t digit,
+			uECC_Curve curve)
+{
+	uECC_word_t neg_y[NUM_ECC_WORDS];
+	uECC_word_t index = (digit & ~COMB_SIGN) >> 1;
+	uECC_word_t mask;
+	uECC_word_t i;
+	wordcount_t j;
+	wordcount_t num_words = curve->num_words;
+
+	uECC_vli_clear(x, num_words);
+	uECC_vli_clear(y, num_words);
+	for (i = 0; i < (1 << (COMB_TEETH - 1)); ++i) {
+		mask = 0 - (((i ^ index) - 1) >> (uECC_WORD_BITS - 1));
+		for (j = 0; j < num_words; ++j) {
+			x[j] |= comb_secp256r1[i][j] & mask;
+			y[j] |= comb_secp256r1[i][num_words + j] & mask;
+		}
+	}
+
+	uECC_vli_sub(neg_y, curve->p, y, num_words);
+	mask = 0 - (uECC_word_t)(digit >> 7);
+	for (j = 0; j < num_words; ++j) {
+		y[j] = (neg_y[j] & mask) | (y[j] & ~mask);
+	}
+}
+
+/* Computes result = k * G for 0 < k < n in constant time, except that it
+ * returns 0 in the unlikely event that the co-Z addition hits equal points. */
+static uECC_word_t EccPoint_mult_comb(uECC_word_t *result,
+				      const uECC_word_t *k, uECC_Curve curve)
+{
+	uECC_word_t m[NUM_ECC_WORDS];
+	uECC_word_t Rx[NUM_ECC_WORDS];
+	uECC_word_t Ry[NUM_ECC_WORDS];
+	uECC_word_t z[NUM_ECC_WORDS];
+	uECC_word_t tx[NUM_ECC_WORDS];
+	uECC_word_t ty[NUM_ECC_WORDS];
+	uint8_t x[COMB_COLUMNS + 1];
+	uECC_word_t even, mask;
+	wordcount_t num_words = curve->num_words;
+	wordcount_t j;
+	int i;
+
+	/* The recoding needs an odd scalar, so use n - k for even k and negate
+	 * the result. */
+	even = (k[0] & 1) ^ 1;
+	uECC_vli_sub(m, curve->n, k, num_words);
+	mask = 0 - even;
+	for (j = 0; j < num_words; ++j) {
+		m[j] = (m[j] & mask) | (k[j] & ~mask);
+	}
+	comb_recode(x, m);
+
+	comb_select(Rx, Ry, x[COMB_COLUMNS], curve);
+	uECC_vli_clear(z, num_words);
+	z[0] = 1;
+
+	for (i = COMB_COLUMNS - 1; i >= 0; --i) {
+		curve->double_jacobian(Rx, Ry, z, curve);
+		comb_select(tx, ty, x[i], curve);
+		if (!add_affine(Rx, Ry, z, tx, ty, curve)) {
+			return 0;
+		}
+	}
+
+	uECC_vli_modInv(z, z, curve->p, num_words); /* Z = 1/Z */
+	apply_z(Rx, Ry, z, curve);
+
+	uECC_vli_sub(ty, curve->p, Ry, num_words);
+	for (j = 0; j < num_words; ++j) {
+		Ry[j] = (ty[j] & mask) | (Ry[j] & ~mask);
+	}
+
+	uECC_vli_set(result, Rx, num_words);
+	uECC_vli_set(result + num_words, Ry, num_words);
+	return 1;
+}
+#endif
+
 uECC_word_t regularize_k(const uECC_word_t * const k, uECC_word_t *k0,
 			 uECC_word_t *k1, uECC_Curve curve)
 {
@@ -798,6 +1284,17 @@ uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
 	uECC_word_t *p2[2] = {tmp1, tmp2};
 	uECC_word_t carry;
 
+#if uECC_FIXED_BASE_TABLES
+	/* The comb only covers 0 < k < n and falls back to the ladder in the
+	 * rare case it meets equal points. */
+	if (!uECC_vli_isZero(private_key, curve->num_words) &&
+	    uECC_vli_cmp(curve->n, private_key,
+			 BITS_TO_WORDS(curve->num_n_bits)) == 1 &&
+	    EccPoint_mult_comb(result, private_key, curve)) {
+		return 1;
+	}
+#endif
+
 	/* Regularize the bitcount for the private key so that attackers cannot
 	 * use a side channel attack to learn the number of leading zeros. */
 	carry = regularize_k(private_key, tmp1, tmp2, curve);
@@ -810,6 +1307,226 @@ uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
 	return 1;
 }
 
+#if uECC_FIXED_BASE_TABLES
+/* Window of the NAF digits for the point, which has no precomputed table. */
+#define ODD_Q_WIDTH 4
+
+/* Writes the width w NAF of k to naf, least significant digit first, and
+ * returns the number of digits. Every nonzero digit is odd and is followed by
+ * at least w - 1 zero digits. */
+static bitcount_t wnaf_recode(int8_t *naf, const uECC_word_t *k,
+			      unsigned int w, wordcount_t num_words)
+{
+	uECC_word_t t[NUM_ECC_WORDS];
+	uECC_word_t d[NUM_ECC_WORDS];
+	bitcount_t len = 0;
+	int digit;
+
+	uECC_vli_set(t, k, num_words);
+	uECC_vli_clear(d, num_words);
+	while (!uECC_vli_isZero(t, num_words)) {
+		digit = 0;
+		if (t[0] & 1) {
+			digit = (int)(t[0] & ((1u << w) - 1));
+			if (digit >= (1 << (w - 1))) {
+				digit -= (1 << w);
+				d[0] = (uECC_word_t)-digit;
+				uECC_vli_add(t, t, d, num_words);
+			} else {
+				d[0] = (uECC_word_t)digit;
+				uECC_vli_sub(t, t, d, num_words);
+			}
+		}
+		naf[len++] = (int8_t)digit;
+		uECC_vli_rshift1(t, num_words);
+	}
+	return len;
+}
+
+/* Adds digit times the point whose odd multiples are in table to the
+ * Jacobian point (X1, Y1, Z1), tracking the point at infinity in *infinity. */
+static void add_naf_digit(uECC_word_t *X1, uECC_word_t *Y1, uECC_word_t *Z1,
+			  uECC_word_t *infinity, const uECC_word_t *table,
+			  int digit, uECC_Curve curve)
+{
+	uECC_word_t tx[NUM_ECC_WORDS];
+	uECC_word_t ty[NUM_ECC_WORDS];
+	wordcount_t num_words = curve->num_words;
+	const uECC_word_t *point =
+		table + (((digit < 0 ? -digit : digit) >> 1) * 2 * num_words);
+
+	uECC_vli_set(tx, point, num_words);
+	if (digit < 0) {
+		uECC_vli_sub(ty, curve->p, point + num_words, num_words);
+	} else {
+		uECC_vli_set(ty, point + num_words, num_words);
+	}
+
+	if (*infinity) {
+		uECC_vli_set(X1, tx, num_words);
+		uECC_vli_set(Y1, ty, num_words);
+		uECC_vli_clear(Z1, num_words);
+		Z1[0] = 1;
+		*infinity = 0;
+	} else if (!add_affine(X1, Y1, Z1, tx, ty, curve)) {
+		/* Same x: either the same point or its negation. */
+		if (uECC_vli_equal(Y1, ty, num_words) == 0) {
+			curve->double_jacobian(X1, Y1, Z1, curve);
+		} else {
+			*infinity = 1;
+		}
+	}
+}
+
+/* Converts the Jacobian point (X1, Y1, Z1) to affine coordinates. */
+static void jacobian_to_affine(uECC_word_t *X1, uECC_word_t *Y1,
+			       uECC_word_t *Z1, uECC_Curve curve)
+{
+	uECC_vli_modInv(Z1, Z1, curve->p, curve->num_words); /* Z = 1/Z */
+	apply_z(X1, Y1, Z1, curve);
+}
+
+uECC_word_t EccPoint_mult_twin(uECC_word_t * result, const uECC_word_t * u1,
+			       const uECC_word_t * u2,
+			       const uECC_word_t * point, uECC_Curve curve)
+{
+	int8_t naf1[NUM_ECC_WORDS * uECC_WORD_BITS + 1];
+	int8_t naf2[NUM_ECC_WORDS * uECC_WORD_BITS + 1];
+	uECC_word_t odd_q[1 << (ODD_Q_WIDTH - 2)][NUM_ECC_WORDS * 2];
+	uECC_word_t twice_x[NUM_ECC_WORDS];
+	uECC_word_t twice_y[NUM_ECC_WORDS];
+	uECC_word_t rx[NUM_ECC_WORDS];
+	uECC_word_t ry[NUM_ECC_WORDS];
+	uECC_word_t z[NUM_ECC_WORDS];
+	uECC_word_t infinity = 1;
+	wordcount_t num_words = curve->num_words;
+	wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+	bitcount_t len1, len2;
+	bitcount_t i;
+
+	/* odd_q = point, 3 * point, 5 * point, 7 * point, in affine form. */
+	uECC_vli_set(odd_q[0], point, 2 * num_words);
+	uECC_vli_set(twice_x, point, num_words);
+	uECC_vli_set(twice_y, point + num_words, num_words);
+	uECC_vli_clear(z, num_words);
+	z[0] = 1;
+	curve->double_jacobian(twice_x, twice_y, z, curve);
+	jacobian_to_affine(twice_x, twice_y, z, curve);
+	for (i = 1; i < (1 << (ODD_Q_WIDTH - 2)); ++i) {
+		uECC_vli_set(rx, twice_x, num_words);
+		uECC_vli_set(ry, twice_y, num_words);
+		uECC_vli_clear(z, num_words);
+		z[0] = 1;
+		uECC_vli_set(odd_q[i], odd_q[i - 1], 2 * num_words);
+		if (!add_affine(rx, ry, z, odd_q[i], odd_q[i] + num_words, curve)) {
+			return 0; /* point is not of order n */
+		}
+		jacobian_to_affine(rx, ry, z, curve);
+		uECC_vli_set(odd_q[i], rx, num_words);
+		uECC_vli_set(odd_q[i] + num_words, ry, num_words);
+	}
+
+	len1 = wnaf_recode(naf1, u1, ODD_G_WIDTH, num_n_words);
+	len2 = wnaf_recode(naf2, u2, ODD_Q_WIDTH, num_n_words);
+
+	for (i = (len1 > len2 ? len1 : len2) - 1; i >= 0; --i) {
+		if (!infinity) {
+			curve->double_jacobian(rx, ry, z, curve);
+		}
+		if (i < len1 && naf1[i]) {
+			add_naf_digit(rx, ry, z, &infinity, odd_secp256r1[0],
+				      naf1[i], curve);
+		}
+		if (i < len2 && naf2[i]) {
+			add_naf_digit(rx, ry, z, &infinity, odd_q[0], naf2[i],
+				      curve);
+		}
+	}
+
+	if (infinity) {
+		return 0;
+	}
+	jacobian_to_affine(rx, ry, z, curve);
+	uECC_vli_set(result, rx, num_words);
+	uECC_vli_set(result + num_words, ry, num_words);
+	return 1;
+}
+#else
+static bitcount_t smax(bitcount_t a, bitcount_t b)
+{
+	return (a > b ? a : b);
+}
+
+uECC_word_t EccPoint_mult_twin(uECC_word_t * result, const uECC_word_t * u1,
+			       const uECC_word_t * u2,
+			       const uECC_word_t * point, uECC_Curve curve)
+{
+	uECC_word_t z[NUM_ECC_WORDS];
+	uECC_word_t sum[NUM_ECC_WORDS * 2];
+	uECC_word_t rx[NUM_ECC_WORDS];
+	uECC_word_t ry[NUM_ECC_WORDS];
+	uECC_word_t tx[NUM_ECC_WORDS];
+	uECC_word_t ty[NUM_ECC_WORDS];
+	uECC_word_t tz[NUM_ECC_WORDS];
+	const uECC_word_t *points[4];
+	const uECC_word_t *p;
+	bitcount_t num_bits;
+	bitcount_t i;
+	wordcount_t num_words = curve->num_words;
+	wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+
+	/* Calculate sum = G + Q. */
+	uECC_vli_set(sum, point, num_words);
+	uECC_vli_set(sum + num_words, point + num_words, num_words);
+	uECC_vli_set(tx, curve->G, num_words);
+	uECC_vli_set(ty, curve->G + num_words, num_words);
+	uECC_vli_modSub(z, sum, tx, curve->p, num_words); /* z = x2 - x1 */
+	XYcZ_add(tx, ty, sum, sum + num_words, curve);
+	uECC_vli_modInv(z, z, curve->p, num_words); /* z = 1/z */
+	apply_z(sum, sum + num_words, z, curve);
+
+	/* Use Shamir's trick to calculate u1*G + u2*Q */
+	points[0] = 0;
+	points[1] = curve->G;
+	points[2] = point;
+	points[3] = sum;
+	num_bits = smax(uECC_vli_numBits(u1, num_n_words),
+	uECC_vli_numBits(u2, num_n_words));
+
+	p = points[(!!uECC_vli_testBit(u1, num_bits - 1)) |
+                   ((!!uECC_vli_testBit(u2, num_bits - 1)) << 1)];
+	uECC_vli_set(rx, p, num_words);
+	uECC_vli_set(ry, p + num_words, num_words);
+	uECC_vli_clear(z, num_words);
+	z[0] = 1;
+
+	for (i = num_bits - 2; i >= 0; --i) {
+		uECC_word_t index;
+		curve->double_jacobian(rx, ry, z, curve);
+
+		index = (!!uECC_vli_testBit(u1, i)) | ((!!uECC_vli_testBit(u2, i)) << 1);
+		p = points[index];
+		if (p) {
+			uECC_vli_set(tx, p, num_words);
+			uECC_vli_set(ty, p + num_words, num_words);
+			apply_z(tx, ty, z, curve);
+			uECC_vli_modSub(tz, rx, tx, curve->p, num_words); /* Z = x2 - x1 */
+			XYcZ_add(tx, ty, rx, ry, curve);
+			uECC_vli_modMult_fast(z, z, tz, curve);
+		}
+  	}
+
+	if (uECC_vli_isZero(z, num_words)) {
+		return 0;
+	}
+	uECC_vli_modInv(z, z, curve->p, num_words); /* Z = 1/Z */
+	apply_z(rx, ry, z, curve);
+	uECC_vli_set(result, rx, num_words);
+	uECC_vli_set(result + num_words, ry, num_words);
+	return 1;
+}
+#endif
+
 /* Converts an integer in uECC native format to big-endian bytes. */
 void uECC_vli_nativeToBytes(uint8_t *bytes, int num_bytes,
 			    const unsigned int *native)
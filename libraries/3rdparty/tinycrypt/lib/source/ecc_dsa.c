@@ -103,12 +103,9 @@ int uECC_sign_with_k(const uint8_t *private_key, const uint8_t *message_hash,
 
 	uECC_word_t tmp[NUM_ECC_WORDS];
 	uECC_word_t s[NUM_ECC_WORDS];
-	uECC_word_t *k2[2] = {tmp, s};
 	uECC_word_t p[NUM_ECC_WORDS * 2];
-	uECC_word_t carry;
 	wordcount_t num_words = curve->num_words;
 	wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
-	bitcount_t num_n_bits = curve->num_n_bits;
 
 	/* Make sure 0 < k < curve_n */
   	if (uECC_vli_isZero(k, num_words) ||
@@ -116,9 +113,8 @@ int uECC_sign_with_k(const uint8_t *private_key, const uint8_t *message_hash,
 		return 0;
 	}
 
-	carry = regularize_k(k, tmp, s, curve);
-	EccPoint_mult(p, curve->G, k2[!carry], 0, num_n_bits + 1, curve);
-	if (uECC_vli_isZero(p, num_words)) {
+	/* p = k * G, in constant time. */
+	if (!EccPoint_compute_public_key(p, k, curve)) {
 		return 0;
 	}
 
@@ -184,11 +180,6 @@ int uECC_sign(const uint8_t *private_key, const uint8_t *message_hash,
 	return 0;
 }
 
-static bitcount_t smax(bitcount_t a, bitcount_t b)
-{
-	return (a > b ? a : b);
-}
-
 int uECC_verify(const uint8_t *public_key, const uint8_t *message_hash,
 		unsigned hash_size, const uint8_t *signature,
 	        uECC_Curve curve)
@@ -196,16 +187,7 @@ int uECC_verify(const uint8_t *public_key, const uint8_t *message_hash,
 
 	uECC_word_t u1[NUM_ECC_WORDS], u2[NUM_ECC_WORDS];
 	uECC_word_t z[NUM_ECC_WORDS];
-	uECC_word_t sum[NUM_ECC_WORDS * 2];
-	uECC_word_t rx[NUM_ECC_WORDS];
-	uECC_word_t ry[NUM_ECC_WORDS];
-	uECC_word_t tx[NUM_ECC_WORDS];
-	uECC_word_t ty[NUM_ECC_WORDS];
-	uECC_word_t tz[NUM_ECC_WORDS];
-	const uECC_word_t *points[4];
-	const uECC_word_t *point;
-	bitcount_t num_bits;
-	bitcount_t i;
+	uECC_word_t rx[NUM_ECC_WORDS * 2];
 
 	uECC_word_t _public[NUM_ECC_WORDS * 2];
 	uECC_word_t r[NUM_ECC_WORDS], s[NUM_ECC_WORDS];
@@ -240,49 +222,10 @@ int uECC_verify(const uint8_t *public_key, const uint8_t *message_hash,
 	uECC_vli_modMult(u1, u1, z, curve->n, num_n_words); /* u1 = e/s */
 	uECC_vli_modMult(u2, r, z, curve->n, num_n_words); /* u2 = r/s */
 
-	/* Calculate sum = G + Q. */
-	uECC_vli_set(sum, _public, num_words);
-	uECC_vli_set(sum + num_words, _public + num_words, num_words);
-	uECC_vli_set(tx, curve->G, num_words);
-	uECC_vli_set(ty, curve->G + num_words, num_words);
-	uECC_vli_modSub(z, sum, tx, curve->p, num_words); /* z = x2 - x1 */
-	XYcZ_add(tx, ty, sum, sum + num_words, curve);
-	uECC_vli_modInv(z, z, curve->p, num_words); /* z = 1/z */
-	apply_z(sum, sum + num_words, z, curve);
-
-	/* Use Shamir's trick to calculate u1*G + u2*Q */
-	points[0] = 0;
-	points[1] = curve->G;
-	points[2] = _public;
-	points[3] = sum;
-	num_bits = smax(uECC_vli_numBits(u1, num_n_words),
-	uECC_vli_numBits(u2, num_n_words));
-
-	point = points[(!!uECC_vli_testBit(u1, num_bits - 1)) |
-                       ((!!uECC_vli_testBit(u2, num_bits - 1)) << 1)];
-	uECC_vli_set(rx, point, num_words);
-	uECC_vli_set(ry, point + num_words, num_words);
-	uECC_vli_clear(z, num_words);
-	z[0] = 1;
-
-	for (i = num_bits - 2; i >= 0; --i) {
-		uECC_word_t index;
-		curve->double_jacobian(rx, ry, z, curve);
-
-		index = (!!uECC_vli_testBit(u1, i)) | ((!!uECC_vli_testBit(u2, i)) << 1);
-		point = points[index];
-		if (point) {
-			uECC_vli_set(tx, point, num_words);
-			uECC_vli_set(ty, point + num_words, num_words);
-			apply_z(tx, ty, z, curve);
-			uECC_vli_modSub(tz, rx, tx, curve->p, num_words); /* Z = x2 - x1 */
-			XYcZ_add(tx, ty, rx, ry, curve);
-			uECC_vli_modMult_fast(z, z, tz, curve);
-		}
-  	}
-
-	uECC_vli_modInv(z, z, curve->p, num_words); /* Z = 1/Z */
-	apply_z(rx, ry, z, curve);
+	/* rx = u1 * G + u2 * Q, which must not be the point at infinity. */
+	if (!EccPoint_mult_twin(rx, u1, u2, _public, curve)) {
+		return 0;
+	}
 
 	/* v = x1 (mod n) */
 	if (uECC_vli_cmp_unsafe(curve->n, rx, num_n_words) != 1) {
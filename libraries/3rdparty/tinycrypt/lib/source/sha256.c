@@ -34,7 +34,14 @@
 #include <tinycrypt/constants.h>
 #include <tinycrypt/utils.h>
 
-static void compress(unsigned int *iv, const uint8_t *data);
+#if defined(TC_HW_ACCEL_X86)
+#include <immintrin.h>
+#elif defined(TC_HW_ACCEL_ARM64)
+#include <arm_neon.h>
+#endif
+
+static void compress_blocks(unsigned int *iv, const uint8_t *data,
+			    size_t blocks);
 
 int tc_sha256_init(TCSha256State_t s)
 {
@@ -64,6 +71,8 @@ int tc_sha256_init(TCSha256State_t s)
 
 int tc_sha256_update(TCSha256State_t s, const uint8_t *data, size_t datalen)
 {
+	size_t n;
+
 	/* input sanity check: */
 	if (s == (TCSha256State_t) 0 ||
 	    data == (void *) 0) {
@@ -72,15 +81,36 @@ int tc_sha256_update(TCSha256State_t s, const uint8_t *data, size_t datalen)
 		return TC_CRYPTO_SUCCESS;
 	}
 
-	while (datalen-- > 0) {
-		s->leftover[s->leftover_offset++] = *(data++);
-		if (s->leftover_offset >= TC_SHA256_BLOCK_SIZE) {
-			compress(s->iv, s->leftover);
-			s->leftover_offset = 0;
-			s->bits_hashed += (TC_SHA256_BLOCK_SIZE << 3);
+	/* top up a block left over from the previous call */
+	if (s->leftover_offset > 0) {
+		n = TC_SHA256_BLOCK_SIZE - s->leftover_offset;
+		if (n > datalen) {
+			n = datalen;
+		}
+		(void)_copy(s->leftover + s->leftover_offset, n, data, n);
+		s->leftover_offset += n;
+		data += n;
+		datalen -= n;
+		if (s->leftover_offset < TC_SHA256_BLOCK_SIZE) {
+			return TC_CRYPTO_SUCCESS;
 		}
+		compress_blocks(s->iv, s->leftover, 1);
+		s->leftover_offset = 0;
+		s->bits_hashed += (TC_SHA256_BLOCK_SIZE << 3);
+	}
+
+	/* hash whole blocks straight from the input */
+	n = datalen / TC_SHA256_BLOCK_SIZE;
+	if (n > 0) {
+		compress_blocks(s->iv, data, n);
+		s->bits_hashed += ((uint64_t) n * TC_SHA256_BLOCK_SIZE) << 3;
+		data += n * TC_SHA256_BLOCK_SIZE;
+		datalen -= n * TC_SHA256_BLOCK_SIZE;
 	}
 
+	(void)_copy(s->leftover, datalen, data, datalen);
+	s->leftover_offset = datalen;
+
 	return TC_CRYPTO_SUCCESS;
 }
 
@@ -101,7 +131,7 @@ int tc_sha256_final(uint8_t *digest, TCSha256State_t s)
 		/* there is not room for all the padding in this block */
 		_set(s->leftover + s->leftover_offset, 0x00,
 		     sizeof(s->leftover) - s->leftover_offset);
-		compress(s->iv, s->leftover);
+		compress_blocks(s->iv, s->leftover, 1);
 		s->leftover_offset = 0;
 	}
 
@@ -118,7 +148,7 @@ int tc_sha256_final(uint8_t *digest, TCSha256State_t s)
 	s->leftover[sizeof(s->leftover) - 8] = (uint8_t)(s->bits_hashed >> 56);
 
 	/* hash the padding and length */
-	compress(s->iv, s->leftover);
+	compress_blocks(s->iv, s->leftover, 1);
 
 	/* copy the iv out to digest */
 	for (i = 0; i < TC_SHA256_STATE_BLOCKS; ++i) {
@@ -215,3 +245,131 @@ static void compress(unsigned int *iv, const uint8_t *data)
 	iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
 	iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
 }
+
+#if defined(TC_HW_ACCEL_X86)
+/*
+ * SHA-NI. The state is kept as ABEF and CDGH, the order sha256rnds2 wants.
+ * Each group of four rounds also advances the message schedule: msg2 finishes
+ * the words four groups ahead and msg1 starts those after them.
+ */
+__attribute__((target("sha,sse4.1")))
+static void compress_shani(unsigned int *iv, const uint8_t *data,
+			   size_t blocks)
+{
+	const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+					     0x0405060700010203ULL);
+	__m128i state0, state1, save0, save1, msg, tmp;
+	__m128i m[4];
+	unsigned int i;
+
+	tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) &iv[0]), 0xb1);
+	state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) &iv[4]), 0x1b);
+	state0 = _mm_alignr_epi8(tmp, state1, 8);
+	state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+	while (blocks-- > 0) {
+		save0 = state0;
+		save1 = state1;
+
+		for (i = 0; i < 16; ++i) {
+			if (i < 4) {
+				m[i] = _mm_shuffle_epi8(_mm_loadu_si128(
+					(const __m128i *) (data + 16 * i)), bswap);
+			}
+
+			msg = _mm_add_epi32(m[i & 3], _mm_loadu_si128(
+				(const __m128i *) &k256[4 * i]));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg = _mm_shuffle_epi32(msg, 0x0e);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+			if (i >= 3 && i < 15) {
+				tmp = _mm_alignr_epi8(m[i & 3], m[(i - 1) & 3], 4);
+				m[(i + 1) & 3] = _mm_add_epi32(m[(i + 1) & 3], tmp);
+				m[(i + 1) & 3] = _mm_sha256msg2_epu32(m[(i + 1) & 3],
+								      m[i & 3]);
+			}
+			if (i >= 1 && i < 13) {
+				m[(i - 1) & 3] = _mm_sha256msg1_epu32(m[(i - 1) & 3],
+								      m[i & 3]);
+			}
+		}
+
+		state0 = _mm_add_epi32(state0, save0);
+		state1 = _mm_add_epi32(state1, save1);
+		data += TC_SHA256_BLOCK_SIZE;
+	}
+
+	tmp = _mm_shuffle_epi32(state0, 0x1b);
+	state1 = _mm_shuffle_epi32(state1, 0xb1);
+	state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+	state1 = _mm_alignr_epi8(state1, tmp, 8);
+	_mm_storeu_si128((__m128i *) &iv[0], state0);
+	_mm_storeu_si128((__m128i *) &iv[4], state1);
+}
+#elif defined(TC_HW_ACCEL_ARM64)
+/*
+ * ARMv8 crypto extensions. sha256su0/su1 compute the next four message words
+ * from the last sixteen while sha256h/h2 run four rounds.
+ */
+__attribute__((target("+crypto")))
+static void compress_armv8(unsigned int *iv, const uint8_t *data,
+			   size_t blocks)
+{
+	uint32x4_t state0, state1, save0, save1, msg, tmp;
+	uint32x4_t m[4];
+	unsigned int i;
+
+	state0 = vld1q_u32(&iv[0]);
+	state1 = vld1q_u32(&iv[4]);
+
+	while (blocks-- > 0) {
+		save0 = state0;
+		save1 = state1;
+
+		for (i = 0; i < 4; ++i) {
+			m[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16 * i)));
+		}
+
+		for (i = 0; i < 16; ++i) {
+			msg = vaddq_u32(m[i & 3], vld1q_u32(&k256[4 * i]));
+			if (i < 12) {
+				m[i & 3] = vsha256su1q_u32(
+					vsha256su0q_u32(m[i & 3], m[(i + 1) & 3]),
+					m[(i + 2) & 3], m[(i + 3) & 3]);
+			}
+			tmp = state0;
+			state0 = vsha256hq_u32(state0, state1, msg);
+			state1 = vsha256h2q_u32(state1, tmp, msg);
+		}
+
+		state0 = vaddq_u32(state0, save0);
+		state1 = vaddq_u32(state1, save1);
+		data += TC_SHA256_BLOCK_SIZE;
+	}
+
+	vst1q_u32(&iv[0], state0);
+	vst1q_u32(&iv[4], state1);
+}
+#endif
+
+static void compress_blocks(unsigned int *iv, const uint8_t *data,
+			    size_t blocks)
+{
+#if defined(TC_HW_ACCEL_X86)
+	if (_cpu_features() & TC_CPU_SHA256) {
+		compress_shani(iv, data, blocks);
+		return;
+	}
+#elif defined(TC_HW_ACCEL_ARM64)
+	if (_cpu_features() & TC_CPU_SHA256) {
+		compress_armv8(iv, data, blocks);
+		return;
+	}
+#endif
+
+	while (blocks-- > 0) {
+		compress(iv, data);
+		data += TC_SHA256_BLOCK_SIZE;
+	}
+}
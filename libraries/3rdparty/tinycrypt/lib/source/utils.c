@@ -35,6 +35,13 @@
 
 #include <string.h>
 
+#if defined(TC_HW_ACCEL_X86)
+#include <cpuid.h>
+#elif defined(TC_HW_ACCEL_ARM64)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
 #define MASK_TWENTY_SEVEN 0x1b
 
 unsigned int _copy(uint8_t *to, unsigned int to_len,
@@ -73,3 +80,52 @@ int _compare(const uint8_t *a, const uint8_t *b, size_t size)
 	}
 	return result;
 }
+
+unsigned int _cpu_features(void)
+{
+#if defined(TC_HW_ACCEL_X86)
+	static unsigned int features = ~0u;
+	unsigned int found = 0;
+	unsigned int eax, ebx, ecx, edx;
+
+	if (features != ~0u) {
+		return features;
+	}
+
+	/* every path also needs SSSE3 for byte shuffles, SHA-NI needs SSE4.1 */
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSSE3)) {
+		if (ecx & bit_AES) {
+			found |= TC_CPU_AES;
+		}
+		if ((ecx & bit_SSE4_1) &&
+		    __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) &&
+		    (ebx & bit_SHA)) {
+			found |= TC_CPU_SHA256;
+		}
+	}
+
+	features = found;
+	return found;
+#elif defined(TC_HW_ACCEL_ARM64)
+	static unsigned int features = ~0u;
+	unsigned int found = 0;
+	unsigned long hwcap;
+
+	if (features != ~0u) {
+		return features;
+	}
+
+	hwcap = getauxval(AT_HWCAP);
+	if (hwcap & HWCAP_SHA2) {
+		found |= TC_CPU_SHA256;
+	}
+	if (hwcap & HWCAP_AES) {
+		found |= TC_CPU_AES;
+	}
+
+	features = found;
+	return found;
+#else
+	return 0;
+#endif
+}
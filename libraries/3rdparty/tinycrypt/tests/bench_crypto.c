@@ -0,0 +1,181 @@
+/*  bench_crypto.c - TinyCrypt SHA-256, AES and HMAC-PRNG throughput */
+
+/*
+ *  Copyright (C) 2017 by Intel Corporation, All Rights Reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *    - Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *    - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ *    - Neither the name of Intel Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+  DESCRIPTION
+  Measures the throughput of SHA-256, AES-128 block encryption, CTR mode and
+  HMAC-PRNG generation, and checks that hashing a buffer in one call and in
+  odd sized pieces gives the same digest.
+
+  Build the library with -DTC_NO_HW_ACCEL to compare against the portable code.
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <tinycrypt/sha256.h>
+#include <tinycrypt/aes.h>
+#include <tinycrypt/ctr_mode.h>
+#include <tinycrypt/hmac_prng.h>
+#include <tinycrypt/utils.h>
+#include <tinycrypt/constants.h>
+#include <test_utils.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#define BENCH_BUF_SIZE (1024 * 1024)
+#define BENCH_ROUNDS (16)
+
+static uint8_t buf[BENCH_BUF_SIZE];
+static uint8_t out[BENCH_BUF_SIZE];
+
+static double now(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, double start, size_t bytes)
+{
+	TC_PRINT("%-24s %8.1f MB/s\n", name,
+		 bytes / (now() - start) / (1024 * 1024));
+}
+
+unsigned int bench_sha256(void)
+{
+	struct tc_sha256_state_struct s;
+	uint8_t digest[TC_SHA256_DIGEST_SIZE];
+	uint8_t chunked[TC_SHA256_DIGEST_SIZE];
+	size_t off, n;
+	unsigned int i;
+	double start;
+
+	start = now();
+	for (i = 0; i < BENCH_ROUNDS; ++i) {
+		(void)tc_sha256_init(&s);
+		(void)tc_sha256_update(&s, buf, sizeof(buf));
+		(void)tc_sha256_final(digest, &s);
+	}
+	report("SHA-256", start, sizeof(buf) * BENCH_ROUNDS);
+
+	(void)tc_sha256_init(&s);
+	for (off = 0, n = 1; off < sizeof(buf); off += n, n = n * 7 % 251 + 1) {
+		if (n > sizeof(buf) - off) {
+			n = sizeof(buf) - off;
+		}
+		(void)tc_sha256_update(&s, buf + off, n);
+	}
+	(void)tc_sha256_final(chunked, &s);
+
+	return check_result(1, digest, sizeof(digest), chunked, sizeof(chunked));
+}
+
+unsigned int bench_aes(void)
+{
+	struct tc_aes_key_sched_struct s;
+	const uint8_t key[TC_AES_KEY_SIZE] = { 0x2b, 0x7e, 0x15, 0x16 };
+	uint8_t ctr[TC_AES_BLOCK_SIZE] = { 0 };
+	size_t off;
+	unsigned int i;
+	double start;
+
+	(void)tc_aes128_set_encrypt_key(&s, key);
+
+	start = now();
+	for (i = 0; i < BENCH_ROUNDS; ++i) {
+		for (off = 0; off < sizeof(buf); off += TC_AES_BLOCK_SIZE) {
+			(void)tc_aes_encrypt(out + off, buf + off, &s);
+		}
+	}
+	report("AES-128 block", start, sizeof(buf) * BENCH_ROUNDS);
+
+	start = now();
+	for (i = 0; i < BENCH_ROUNDS; ++i) {
+		(void)tc_ctr_mode(out, sizeof(buf), buf, sizeof(buf), ctr, &s);
+	}
+	report("AES-128 CTR", start, sizeof(buf) * BENCH_ROUNDS);
+
+	return TC_PASS;
+}
+
+unsigned int bench_hmac_prng(void)
+{
+	struct tc_hmac_prng_struct prng;
+	const size_t chunk = 4096;
+	size_t off;
+	unsigned int i;
+	double start;
+
+	(void)tc_hmac_prng_init(&prng, buf, 32);
+	(void)tc_hmac_prng_reseed(&prng, buf + 32, 32, 0, 0);
+
+	start = now();
+	for (i = 0; i < BENCH_ROUNDS / 4; ++i) {
+		for (off = 0; off < sizeof(buf); off += chunk) {
+			if (tc_hmac_prng_generate(out + off, chunk, &prng) !=
+			    TC_CRYPTO_SUCCESS) {
+				(void)tc_hmac_prng_reseed(&prng, buf + 32, 32, 0, 0);
+			}
+		}
+	}
+	report("HMAC-PRNG generate", start, sizeof(buf) * (BENCH_ROUNDS / 4));
+
+	return TC_PASS;
+}
+
+int main(void)
+{
+	unsigned int result = TC_PASS;
+	size_t i;
+
+	for (i = 0; i < sizeof(buf); ++i) {
+		buf[i] = (uint8_t)(i * 131 + (i >> 8));
+	}
+
+	TC_START("Performing crypto throughput benchmark:");
+	TC_PRINT("Hardware SHA-256: %s, hardware AES: %s\n",
+		 (_cpu_features() & TC_CPU_SHA256) ? "yes" : "no",
+		 (_cpu_features() & TC_CPU_AES) ? "yes" : "no");
+
+	result |= bench_sha256();
+	result |= bench_aes();
+	result |= bench_hmac_prng();
+
+	TC_END_RESULT(result);
+	TC_END_REPORT(result);
+	return result;
+}
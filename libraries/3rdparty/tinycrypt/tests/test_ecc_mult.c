@@ -0,0 +1,339 @@
+/* test_ecc_mult.c - TinyCrypt tests of the p-256 point multiplications */
+
+/*
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *    - Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *    - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ *    - Neither the name of Intel Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  test_ecc_mult.c -- Checks the fixed-base comb used for public keys and
+ *  signatures against the Montgomery ladder, or against an affine double and
+ *  add for keys close to 0 and n, and EccPoint_mult_twin used for verification
+ *  against a plain affine sum of two ladder products.
+ *
+ */
+#include <tinycrypt/ecc.h>
+#include <tinycrypt/ecc_platform_specific.h>
+#include <test_ecc_utils.h>
+#include <test_utils.h>
+#include <tinycrypt/constants.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_COMB_KEYS 2000
+#define NUM_TWIN_CASES 1000
+
+/* Computes result = k * point with the Montgomery ladder, as
+ * uECC_shared_secret does. */
+static void ladder_mult(uECC_word_t *result, const uECC_word_t *point,
+			const uECC_word_t *k, uECC_Curve curve)
+{
+	uECC_word_t tmp1[NUM_ECC_WORDS];
+	uECC_word_t tmp2[NUM_ECC_WORDS];
+	uECC_word_t *p2[2] = {tmp1, tmp2};
+	uECC_word_t carry;
+
+	carry = regularize_k(k, tmp1, tmp2, curve);
+	EccPoint_mult(result, point, p2[!carry], 0, curve->num_n_bits + 1, curve);
+}
+
+/* Computes result = a + b in affine coordinates with the generic modular
+ * arithmetic. Returns 0 if the sum is the point at infinity. */
+static int affine_add(uECC_word_t *result, const uECC_word_t *a,
+		      const uECC_word_t *b, uECC_Curve curve)
+{
+	uECC_word_t lambda[NUM_ECC_WORDS];
+	uECC_word_t t[NUM_ECC_WORDS];
+	uECC_word_t x3[NUM_ECC_WORDS];
+	uECC_word_t three[NUM_ECC_WORDS];
+	wordcount_t num_words = curve->num_words;
+	const uECC_word_t *p = curve->p;
+	const uECC_word_t *x1 = a;
+	const uECC_word_t *y1 = a + num_words;
+	const uECC_word_t *x2 = b;
+	const uECC_word_t *y2 = b + num_words;
+
+	if (uECC_vli_equal(x1, x2, num_words) != 0) {
+		/* lambda = (y2 - y1) / (x2 - x1) */
+		uECC_vli_modSub(t, y2, y1, p, num_words);
+		uECC_vli_modSub(lambda, x2, x1, p, num_words);
+		uECC_vli_modInv(lambda, lambda, p, num_words);
+		uECC_vli_modMult(lambda, lambda, t, p, num_words);
+	} else if (uECC_vli_equal(y1, y2, num_words) == 0 &&
+		   !uECC_vli_isZero(y1, num_words)) {
+		/* lambda = (3 * x1^2 + a) / (2 * y1), with a = -3 */
+		uECC_vli_clear(three, num_words);
+		three[0] = 3;
+		uECC_vli_modMult(t, x1, x1, p, num_words);
+		uECC_vli_modAdd(lambda, t, t, p, num_words);
+		uECC_vli_modAdd(t, lambda, t, p, num_words);
+		uECC_vli_modSub(t, t, three, p, num_words);
+		uECC_vli_modAdd(lambda, y1, y1, p, num_words);
+		uECC_vli_modInv(lambda, lambda, p, num_words);
+		uECC_vli_modMult(lambda, lambda, t, p, num_words);
+	} else {
+		return 0;
+	}
+
+	/* x3 = lambda^2 - x1 - x2, y3 = lambda * (x1 - x3) - y1 */
+	uECC_vli_modMult(x3, lambda, lambda, p, num_words);
+	uECC_vli_modSub(x3, x3, x1, p, num_words);
+	uECC_vli_modSub(x3, x3, x2, p, num_words);
+	uECC_vli_modSub(t, x1, x3, p, num_words);
+	uECC_vli_modMult(t, t, lambda, p, num_words);
+	uECC_vli_modSub(result + num_words, t, y1, p, num_words);
+	uECC_vli_set(result, x3, num_words);
+	return 1;
+}
+
+/* Computes result = k * point by double and add with affine_add. Slow, but
+ * unlike the ladder it also covers scalars close to 0 and n. Returns 0 if the
+ * product is the point at infinity. */
+static int affine_mult(uECC_word_t *result, const uECC_word_t *point,
+		       const uECC_word_t *k, uECC_Curve curve)
+{
+	uECC_word_t sum[2 * NUM_ECC_WORDS];
+	int infinity = 1;
+	bitcount_t i;
+
+	for (i = uECC_vli_numBits(k, NUM_ECC_WORDS) - 1; i >= 0; --i) {
+		if (!infinity) {
+			infinity = !affine_add(sum, result, result, curve);
+			uECC_vli_set(result, sum, 2 * NUM_ECC_WORDS);
+		}
+		if (uECC_vli_testBit(k, i)) {
+			if (infinity) {
+				uECC_vli_set(result, point, 2 * NUM_ECC_WORDS);
+				infinity = 0;
+			} else {
+				infinity = !affine_add(sum, result, point, curve);
+				uECC_vli_set(result, sum, 2 * NUM_ECC_WORDS);
+			}
+		}
+	}
+	return !infinity;
+}
+
+static void random_scalar(uECC_word_t *k, uECC_Curve curve)
+{
+	if (!uECC_generate_random_int(k, curve->n,
+				      BITS_TO_WORDS(curve->num_n_bits))) {
+		TC_ERROR("uECC_generate_random_int failed.\n");
+		exit(TC_FAIL);
+	}
+}
+
+/* Checks EccPoint_compute_public_key against the ladder, or against
+ * affine_mult for the edge keys the ladder can't compute. */
+static unsigned int check_comb_key(int num, const uECC_word_t *k, int edge,
+				   uECC_Curve curve)
+{
+	uECC_word_t private_key[NUM_ECC_WORDS];
+	uECC_word_t expected[2 * NUM_ECC_WORDS];
+	uECC_word_t computed[2 * NUM_ECC_WORDS];
+
+	uECC_vli_set(private_key, k, NUM_ECC_WORDS);
+	if (edge) {
+		affine_mult(expected, curve->G, k, curve);
+	} else {
+		ladder_mult(expected, curve->G, k, curve);
+	}
+
+	if (!EccPoint_compute_public_key(computed, private_key, curve)) {
+		TC_ERROR("EccPoint_compute_public_key failed on key #%d.\n", num);
+		return TC_FAIL;
+	}
+
+	return check_ecc_result(num, "k*G", expected, computed,
+				2 * NUM_ECC_WORDS, false);
+}
+
+/* Compares k * G from EccPoint_compute_public_key, which uses the comb when
+ * uECC_FIXED_BASE_TABLES is set, with the ladder on random keys. The comb
+ * also covers the keys close to 0 and n, where the ladder fails, so those are
+ * only checked with the tables. */
+int comb_vs_ladder(void)
+{
+	const struct uECC_Curve_t * curve = uECC_secp256r1();
+	uECC_word_t k[NUM_ECC_WORDS];
+	int num = 0;
+#if uECC_FIXED_BASE_TABLES
+	uECC_word_t small[NUM_ECC_WORDS];
+	const uECC_word_t edges[] = { 1, 2, 3, 4, 5, 0x10, 0xff, 0x100 };
+	unsigned int i;
+	wordcount_t j;
+
+	/* Small keys and their negations, n - k. 1 * G must be G. */
+	for (i = 0; i < sizeof(edges) / sizeof(edges[0]); ++i) {
+		uECC_vli_clear(small, NUM_ECC_WORDS);
+		small[0] = edges[i];
+		if (check_comb_key(num++, small, 1, curve) == TC_FAIL) {
+			return TC_FAIL;
+		}
+		uECC_vli_sub(k, curve->n, small, NUM_ECC_WORDS);
+		if (check_comb_key(num++, k, 1, curve) == TC_FAIL) {
+			return TC_FAIL;
+		}
+	}
+
+	/* (n - 1) / 2 and (n + 1) / 2, around the middle of the key range. */
+	for (j = 0; j < NUM_ECC_WORDS; ++j) {
+		k[j] = (curve->n[j] >> 1) |
+		       (j + 1 < NUM_ECC_WORDS ? curve->n[j + 1] << 31 : 0);
+	}
+	if (check_comb_key(num++, k, 1, curve) == TC_FAIL) {
+		return TC_FAIL;
+	}
+	k[0] += 1;
+	if (check_comb_key(num++, k, 1, curve) == TC_FAIL) {
+		return TC_FAIL;
+	}
+
+	/* Only the top bit set. */
+	uECC_vli_clear(k, NUM_ECC_WORDS);
+	k[NUM_ECC_WORDS - 1] = 0x80000000;
+	if (check_comb_key(num++, k, 1, curve) == TC_FAIL) {
+		return TC_FAIL;
+	}
+#endif
+
+	while (num < NUM_COMB_KEYS) {
+		random_scalar(k, curve);
+		if (check_comb_key(num++, k, 0, curve) == TC_FAIL) {
+			return TC_FAIL;
+		}
+	}
+
+	TC_PRINT("  %d keys match.\n", num);
+	return TC_PASS;
+}
+
+/* Compares EccPoint_mult_twin with the affine sum of the two ladder
+ * products. */
+int twin_vs_affine(void)
+{
+	const struct uECC_Curve_t * curve = uECC_secp256r1();
+	uECC_word_t u1[NUM_ECC_WORDS];
+	uECC_word_t u2[NUM_ECC_WORDS];
+	uECC_word_t d[NUM_ECC_WORDS];
+	uECC_word_t point[2 * NUM_ECC_WORDS];
+	uECC_word_t u1G[2 * NUM_ECC_WORDS];
+	uECC_word_t u2Q[2 * NUM_ECC_WORDS];
+	uECC_word_t expected[2 * NUM_ECC_WORDS];
+	uECC_word_t computed[2 * NUM_ECC_WORDS];
+	int expected_ok, computed_ok;
+	int infinite = 0;
+	int num;
+
+	for (num = 0; num < NUM_TWIN_CASES; ++num) {
+		random_scalar(u1, curve);
+		random_scalar(u2, curve);
+
+		/* The edge cases need the twin with the generator tables: the
+		 * Shamir version precomputes G + Q, which is undefined for
+		 * Q = +-G. */
+		switch (uECC_FIXED_BASE_TABLES ? num % 8 : 7) {
+		case 0: /* Q = G */
+			uECC_vli_set(point, curve->G, 2 * NUM_ECC_WORDS);
+			break;
+		case 1: /* Q = -G */
+			uECC_vli_set(point, curve->G, NUM_ECC_WORDS);
+			uECC_vli_sub(point + NUM_ECC_WORDS, curve->p,
+				     curve->G + NUM_ECC_WORDS, NUM_ECC_WORDS);
+			break;
+		case 2: /* Q = G and u2 = u1, so the sum is a doubling. */
+			uECC_vli_set(point, curve->G, 2 * NUM_ECC_WORDS);
+			uECC_vli_set(u2, u1, NUM_ECC_WORDS);
+			break;
+		case 3: /* Q = G and u2 = n - u1: infinite result. */
+			uECC_vli_set(point, curve->G, 2 * NUM_ECC_WORDS);
+			uECC_vli_sub(u2, curve->n, u1, NUM_ECC_WORDS);
+			break;
+		case 4: /* Q = -G and u2 = u1: infinite result. */
+			uECC_vli_set(point, curve->G, NUM_ECC_WORDS);
+			uECC_vli_sub(point + NUM_ECC_WORDS, curve->p,
+				     curve->G + NUM_ECC_WORDS, NUM_ECC_WORDS);
+			uECC_vli_set(u2, u1, NUM_ECC_WORDS);
+			break;
+		default: /* Q = d * G for a random d. */
+			random_scalar(d, curve);
+			ladder_mult(point, curve->G, d, curve);
+			break;
+		}
+
+		ladder_mult(u1G, curve->G, u1, curve);
+		ladder_mult(u2Q, point, u2, curve);
+		expected_ok = affine_add(expected, u1G, u2Q, curve);
+		computed_ok = (int)EccPoint_mult_twin(computed, u1, u2, point, curve);
+
+		if (check_code(num, "infinity", expected_ok, computed_ok,
+			       false) == TC_FAIL) {
+			return TC_FAIL;
+		}
+		if (!expected_ok) {
+			++infinite;
+		} else if (check_ecc_result(num, "u1*G+u2*Q", expected, computed,
+					    2 * NUM_ECC_WORDS, false) == TC_FAIL) {
+			return TC_FAIL;
+		}
+	}
+
+	TC_PRINT("  %d cases match, %d of them at infinity.\n", num, infinite);
+	return TC_PASS;
+}
+
+int main()
+{
+	unsigned int result = TC_PASS;
+
+	TC_START("Performing ECC point multiplication tests:");
+
+	/* Setup of the Cryptographically Secure PRNG. */
+	uECC_set_rng(&default_CSPRNG);
+
+	TC_PRINT("Generator tables: %s\n",
+		 uECC_FIXED_BASE_TABLES ? "on" : "off");
+
+	TC_PRINT("Performing comb_vs_ladder test:\n");
+	result = comb_vs_ladder();
+	if (result == TC_FAIL) { /* terminate test */
+		TC_ERROR("comb_vs_ladder test failed.\n");
+		goto exitTest;
+	}
+	TC_PRINT("Performing twin_vs_affine test:\n");
+	result = twin_vs_affine();
+	if (result == TC_FAIL) { /* terminate test */
+		TC_ERROR("twin_vs_affine test failed.\n");
+		goto exitTest;
+	}
+
+	TC_PRINT("All ECC point multiplication tests succeeded!\n");
+
+exitTest:
+	TC_END_RESULT(result);
+	TC_END_REPORT(result);
+	return result;
+}
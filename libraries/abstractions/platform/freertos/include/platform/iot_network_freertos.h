@@ -171,6 +171,13 @@ IotNetworkError_t IotNetworkAfr_Close( void * pConnection );
  */
 IotNetworkError_t IotNetworkAfr_Destroy( void * pConnection );
 
+/**
+ * @brief An implementation of #IotNetworkInterface_t::getStatistics for
+ * FreeRTOS Secure Sockets.
+ */
+IotNetworkError_t IotNetworkAfr_GetStatistics( void * pConnection,
+                                               IotNetworkStatistics_t * pStatistics );
+
 /**
  * @cond DOXYGEN_IGNORE
  * Doxygen should ignore this section.
@@ -52,16 +52,27 @@
 #if AWS_IOT_SECURE_SOCKETS_METRICS_ENABLED == 1
 
 /**
- * @brief Used to match metrics connection records by network connection.
+ * @brief Select the hash set bucket of a network connection.
  *
- * @param[in] pConnectionLink Pointer to a metrics connection record's link element.
- * @param[in] pContext The network connection to match.
+ * @param[in] pContext The network connection.
  *
- * @return `true` if the given metrics connection record matches the given
- * network connection; `false` otherwise.
+ * @return Index of the bucket in #_pConnectionBuckets.
  */
-    static bool _connectionMatch( const IotLink_t * pConnectionLink,
-                                  void * pContext );
+    static size_t _connectionBucket( void * pContext );
+
+/**
+ * @brief Find the metrics connection record of a network connection.
+ *
+ * @param[in] pContext The network connection to find.
+ *
+ * @return Pointer to the bucket entry that points to the connection record. The
+ * entry is `NULL` if the network connection has no record.
+ *
+ * @note This function should be called with #_connectionListMutex or
+ * #_connectionCountersMutex locked. The bucket entries are only modified with
+ * both locked.
+ */
+    static IotMetricsTcpConnection_t ** _findConnection( void * pContext );
 
     static void _metricsAddTcpConnection( Socket_t xSocket,
                                           SocketsSockaddr_t * pxAddress );
@@ -74,22 +85,66 @@
     static IotListDouble_t _connectionList = IOT_LIST_DOUBLE_INITIALIZER;
 
 /**
- * @brief Protects #_connectionList from concurrent access.
+ * @brief Hash set of the connections in #_connectionList, keyed by network
+ * connection. Each bucket is a singly-linked list.
+ *
+ * Send and receive only need the record of their own connection, so they
+ * search the hash set with #_connectionCountersMutex locked instead of
+ * #_connectionListMutex.
+ */
+    static IotMetricsTcpConnection_t * _pConnectionBuckets[ AWS_IOT_SECURE_SOCKETS_METRICS_HASH_BUCKETS ] = { 0 };
+
+/**
+ * @brief Protects #_connectionList and #_pConnectionBuckets from concurrent access.
  */
     static IotMutex_t _connectionListMutex;
 
+/**
+ * @brief Protects #_pConnectionBuckets and the counters of the connection
+ * records. It is only held for a bucket update or a counter update, so send and
+ * receive do not wait while the connection list is reported.
+ *
+ * It may be locked while #_connectionListMutex is locked, but not the other way
+ * around.
+ */
+    static IotMutex_t _connectionCountersMutex;
+
+/**
+ * @brief Notified of established and closed TCP connections. Protected by
+ * #_connectionListMutex.
+ */
+    static IotMetricsTcpConnectionCallback_t _connectionCallback = NULL;
+
+/**
+ * @brief Context of #_connectionCallback.
+ */
+    static void * _pConnectionCallbackContext = NULL;
+
 /*-----------------------------------------------------------*/
 
-    static bool _connectionMatch( const IotLink_t * pConnectionLink,
-                                  void * pContext )
+    static size_t _connectionBucket( void * pContext )
     {
-        /* Retrieve the pointer the the TCP connection record. The given link
-         * pointer is never NULL. */
-        IotMetricsTcpConnection_t * pTcpConnection = IotLink_Container( IotMetricsTcpConnection_t,
-                                                                        pConnectionLink,
-                                                                        link );
+        uintptr_t hash = ( uintptr_t ) pContext;
+
+        /* Sockets are aligned allocations, so mix the higher bits into the
+         * lower ones before selecting a bucket. */
+        hash ^= ( hash >> 4 ) ^ ( hash >> 12 );
 
-        return( pTcpConnection->pNetworkContext == pContext );
+        return ( size_t ) ( hash % AWS_IOT_SECURE_SOCKETS_METRICS_HASH_BUCKETS );
+    }
+
+/*-----------------------------------------------------------*/
+
+    static IotMetricsTcpConnection_t ** _findConnection( void * pContext )
+    {
+        IotMetricsTcpConnection_t ** pEntry = &( _pConnectionBuckets[ _connectionBucket( pContext ) ] );
+
+        while( ( *pEntry != NULL ) && ( ( *pEntry )->pNetworkContext != pContext ) )
+        {
+            pEntry = &( ( *pEntry )->pNextInBucket );
+        }
+
+        return pEntry;
     }
 
 /*-----------------------------------------------------------*/
@@ -97,14 +152,28 @@
     bool IotMetrics_Init( void )
     {
         IotListDouble_Create( &_connectionList );
+        ( void ) memset( _pConnectionBuckets, 0x00, sizeof( _pConnectionBuckets ) );
 
-        return IotMutex_Create( &_connectionListMutex, false );
+        bool status = IotMutex_Create( &_connectionListMutex, false );
+
+        if( status )
+        {
+            status = IotMutex_Create( &_connectionCountersMutex, false );
+
+            if( !status )
+            {
+                IotMutex_Destroy( &_connectionListMutex );
+            }
+        }
+
+        return status;
     }
 
 /*-----------------------------------------------------------*/
 
     void IotMetrics_Cleanup( void )
     {
+        IotMutex_Destroy( &_connectionCountersMutex );
         IotMutex_Destroy( &_connectionListMutex );
     }
 
@@ -120,21 +189,47 @@
         IotMutex_Unlock( &_connectionListMutex );
     }
 
+/*-----------------------------------------------------------*/
+
+    void IotMetrics_SetTcpConnectionCallback( void * pContext,
+                                              IotMetricsTcpConnectionCallback_t callback )
+    {
+        IotLink_t * pConnectionLink = NULL;
+
+        IotMutex_Lock( &_connectionListMutex );
+
+        _connectionCallback = callback;
+        _pConnectionCallbackContext = pContext;
+
+        /* Report the active connections to the new callback. */
+        if( callback != NULL )
+        {
+            IotContainers_ForEach( &_connectionList, pConnectionLink )
+            {
+                callback( pContext,
+                          IotLink_Container( IotMetricsTcpConnection_t, pConnectionLink, link ),
+                          true );
+            }
+        }
+
+        IotMutex_Unlock( &_connectionListMutex );
+    }
+
 /*-----------------------------------------------------------*/
 
     static void _metricsAddTcpConnection( Socket_t xSocket,
                                           SocketsSockaddr_t * pxAddress )
     {
         IotMetricsTcpConnection_t * pTcpConnection = NULL;
+        IotMetricsTcpConnection_t ** pEntry = NULL;
         void * pSocketContext = ( void * ) xSocket;
 
         IotMutex_Lock( &_connectionListMutex );
 
+        pEntry = _findConnection( pSocketContext );
+
         /* Only add if it doesn't exist in the _connectionList. */
-        if( IotListDouble_FindFirstMatch( &_connectionList,
-                                          NULL,
-                                          _connectionMatch,
-                                          pSocketContext ) == NULL )
+        if( *pEntry == NULL )
         {
             /* Allocate memory for a new metrics connection. */
             pTcpConnection = IotMetrics_MallocTcpConnection( sizeof( IotMetricsTcpConnection_t ) );
@@ -153,8 +248,17 @@
 
                 pTcpConnection->addressLength = strlen( pTcpConnection->pRemoteAddress );
 
-                /* Insert to the list. */
+                /* Insert to the list and the hash set. */
                 IotListDouble_InsertTail( &_connectionList, &( pTcpConnection->link ) );
+
+                IotMutex_Lock( &_connectionCountersMutex );
+                *pEntry = pTcpConnection;
+                IotMutex_Unlock( &_connectionCountersMutex );
+
+                if( _connectionCallback != NULL )
+                {
+                    _connectionCallback( _pConnectionCallbackContext, pTcpConnection, true );
+                }
             }
         }
 
@@ -167,14 +271,23 @@
     {
         IotMutex_Lock( &_connectionListMutex );
 
-        IotLink_t * pFoundConnectionLink = IotListDouble_RemoveFirstMatch( &_connectionList,
-                                                                           NULL,
-                                                                           _connectionMatch,
-                                                                           ( void * ) xSocket );
+        IotMetricsTcpConnection_t ** pEntry = _findConnection( ( void * ) xSocket );
+        IotMetricsTcpConnection_t * pFoundTcpConnection = *pEntry;
 
-        if( pFoundConnectionLink != NULL )
+        if( pFoundTcpConnection != NULL )
         {
-            IotMetricsTcpConnection_t * pFoundTcpConnection = IotLink_Container( IotMetricsTcpConnection_t, pFoundConnectionLink, link );
+            /* Remove from the hash set and the list. Once out of the hash set,
+             * the record is no longer updated by send and receive. */
+            IotMutex_Lock( &_connectionCountersMutex );
+            *pEntry = pFoundTcpConnection->pNextInBucket;
+            IotMutex_Unlock( &_connectionCountersMutex );
+
+            IotListDouble_Remove( &( pFoundTcpConnection->link ) );
+
+            if( _connectionCallback != NULL )
+            {
+                _connectionCallback( _pConnectionCallbackContext, pFoundTcpConnection, false );
+            }
 
             IotMetrics_FreeTcpConnection( pFoundTcpConnection );
         }
@@ -227,4 +340,80 @@
         return result;
     }
 
+/*-----------------------------------------------------------*/
+
+    #if AWS_IOT_SECURE_SOCKETS_METRICS_COUNTERS_ENABLED == 1
+
+        static void _metricsCountTransfer( Socket_t xSocket,
+                                           int32_t transferred,
+                                           bool sent )
+        {
+            IotMetricsTcpConnection_t * pTcpConnection = NULL;
+
+            /* Only this connection's record is updated, so the connection list
+             * mutex is not needed. */
+            IotMutex_Lock( &_connectionCountersMutex );
+
+            pTcpConnection = *_findConnection( ( void * ) xSocket );
+
+            if( pTcpConnection != NULL )
+            {
+                if( sent )
+                {
+                    pTcpConnection->bytesSent += ( uint64_t ) transferred;
+                    pTcpConnection->packetsSent++;
+                }
+                else
+                {
+                    pTcpConnection->bytesReceived += ( uint64_t ) transferred;
+                    pTcpConnection->packetsReceived++;
+                }
+            }
+
+            IotMutex_Unlock( &_connectionCountersMutex );
+        }
+
+/*-----------------------------------------------------------*/
+
+        int32_t Sockets_MetricsSend( Socket_t xSocket,
+                                     const void * pvBuffer,
+                                     size_t xDataLength,
+                                     uint32_t ulFlags )
+        {
+            int32_t result = SOCKETS_Send( xSocket, pvBuffer, xDataLength, ulFlags );
+
+            if( result > 0 )
+            {
+                _metricsCountTransfer( xSocket, result, true );
+            }
+
+            return result;
+        }
+
+/*-----------------------------------------------------------*/
+
+        int32_t Sockets_MetricsRecv( Socket_t xSocket,
+                                     void * pvBuffer,
+                                     size_t xBufferLength,
+                                     uint32_t ulFlags )
+        {
+            int32_t result = SOCKETS_Recv( xSocket, pvBuffer, xBufferLength, ulFlags );
+
+            if( result > 0 )
+            {
+                _metricsCountTransfer( xSocket, result, false );
+            }
+
+            return result;
+        }
+
+    #endif /* if AWS_IOT_SECURE_SOCKETS_METRICS_COUNTERS_ENABLED == 1 */
+
+/*-----------------------------------------------------------*/
+
+/* Provide access to internal functions and variables if testing. */
+    #if IOT_BUILD_TESTS == 1
+        #include "iot_test_access_metrics.c"
+    #endif
+
 #endif /* ifdef AWS_IOT_SECURE_SOCKETS_METRICS_ENABLED */
@@ -45,6 +45,11 @@
 /* FreeRTOS network include. */
 #include "platform/iot_network_freertos.h"
 
+/* Secure sockets DNS cache include. */
+#if ( socketsconfigUSE_DNS_CACHE == 1 )
+    #include "iot_secure_sockets_dns.h"
+#endif
+
 /* Configure logs for the functions in this file. */
 #ifdef IOT_LOG_LEVEL_NETWORK
     #define LIBRARY_LOG_LEVEL        IOT_LOG_LEVEL_NETWORK
@@ -93,6 +98,7 @@ typedef struct _networkConnection
     void * pReceiveContext;                      /**< @brief The context for the receive callback. */
     bool bufferedByteValid;                      /**< @brief Used to determine if the buffered byte is valid. */
     uint8_t bufferedByte;                        /**< @brief A single byte buffered from a receive, since AFR Secure Sockets does not have poll(). */
+    IotNetworkStatistics_t statistics;           /**< @brief I/O statistics, without the TLS record counts. */
 } _networkConnection_t;
 
 /*-----------------------------------------------------------*/
@@ -108,11 +114,77 @@ const IotNetworkInterface_t IotNetworkAfr =
     .receive            = IotNetworkAfr_Receive,
     .receiveUpto        = IotNetworkAfr_ReceiveUpto,
     .close              = IotNetworkAfr_Close,
-    .destroy            = IotNetworkAfr_Destroy
+    .destroy            = IotNetworkAfr_Destroy,
+    .getStatistics      = IotNetworkAfr_GetStatistics
 };
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Counts a Secure Sockets call in a blocking time histogram.
+ *
+ * @param[in] pHistogram The histogram to update.
+ * @param[in] startTime The tick count before the call.
+ */
+static void _recordBlockingTime( uint32_t * pHistogram,
+                                 TickType_t startTime )
+{
+    uint32_t blockingMs = ( uint32_t ) ( ( xTaskGetTickCount() - startTime ) * portTICK_PERIOD_MS );
+    size_t bucket = 0;
+
+    /* Bucket n holds times in [2^(n-1), 2^n) ms, the last bucket everything longer. */
+    while( ( blockingMs > 0U ) && ( bucket < ( IOT_NETWORK_STATISTICS_HISTOGRAM_BUCKETS - 1 ) ) )
+    {
+        blockingMs >>= 1;
+        bucket++;
+    }
+
+    pHistogram[ bucket ]++;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Calls SOCKETS_Recv and updates the receive statistics.
+ *
+ * @param[in] pNetworkConnection The connection to receive on.
+ * @param[out] pBuffer Where to place the received data.
+ * @param[in] bufferSize The size of `pBuffer`.
+ *
+ * @return The return value of SOCKETS_Recv.
+ */
+static int32_t _socketsRecv( _networkConnection_t * pNetworkConnection,
+                             uint8_t * pBuffer,
+                             size_t bufferSize )
+{
+    IotNetworkStatistics_t * pStatistics = &( pNetworkConnection->statistics );
+    TickType_t startTime = xTaskGetTickCount();
+    int32_t socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
+                                         pBuffer,
+                                         bufferSize,
+                                         0 );
+
+    _recordBlockingTime( pStatistics->receiveBlockingMs, startTime );
+    pStatistics->receiveCalls++;
+
+    if( socketStatus > 0 )
+    {
+        pStatistics->bytesReceived += ( uint64_t ) socketStatus;
+    }
+    else if( ( socketStatus < 0 ) && ( socketStatus != SOCKETS_EWOULDBLOCK ) )
+    {
+        pStatistics->receiveErrors++;
+    }
+    else
+    {
+        /* Timed out without data. */
+    }
+
+    return socketStatus;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Destroys a network connection.
  *
@@ -178,6 +250,9 @@ static void _networkReceiveTask( void * pArgument )
             break;
         }
 
+        /* The wait above is idle time, so it is left out of the receive
+         * statistics apart from the byte it returned. */
+        pNetworkConnection->statistics.bytesReceived++;
         pNetworkConnection->bufferedByteValid = true;
 
         /* Invoke the network callback. */
@@ -367,7 +442,12 @@ IotNetworkError_t IotNetworkAfr_Create( void * pConnectionInfo,
     /* Establish connection. */
     serverAddress.ucSocketDomain = SOCKETS_AF_INET;
     serverAddress.usPort = SOCKETS_htons( pServerInfo->port );
-    serverAddress.ulAddress = SOCKETS_GetHostByName( pServerInfo->pHostName );
+
+    #if ( socketsconfigUSE_DNS_CACHE == 1 )
+        serverAddress.ulAddress = SOCKETS_DnsResolve( pServerInfo->pHostName );
+    #else
+        serverAddress.ulAddress = SOCKETS_GetHostByName( pServerInfo->pHostName );
+    #endif
 
     /* Check for errors from DNS lookup. */
     if( serverAddress.ulAddress == 0 )
@@ -383,6 +463,12 @@ IotNetworkError_t IotNetworkAfr_Create( void * pConnectionInfo,
     if( socketStatus != SOCKETS_ERROR_NONE )
     {
         IotLogError( "Failed to establish new connection. Socket status: %d.", socketStatus );
+
+        #if ( socketsconfigUSE_DNS_CACHE == 1 )
+            /* Look the host up again on the next attempt, its address may have changed. */
+            SOCKETS_DnsFlush( pServerInfo->pHostName );
+        #endif
+
         IOT_SET_AND_GOTO_CLEANUP( IOT_NETWORK_SYSTEM_ERROR );
     }
 
@@ -478,6 +564,7 @@ size_t IotNetworkAfr_Send( void * pConnection,
 {
     size_t bytesSent = 0U, bytesRemaining = messageLength;
     int32_t socketStatus = SOCKETS_ERROR_NONE;
+    TickType_t startTime = 0;
 
     /* Cast network connection to the correct type. */
     _networkConnection_t * pNetworkConnection = ( _networkConnection_t * ) pConnection;
@@ -489,13 +576,19 @@ size_t IotNetworkAfr_Send( void * pConnection,
     {
         while( bytesRemaining > 0U )
         {
+            startTime = xTaskGetTickCount();
             socketStatus = SOCKETS_Send( pNetworkConnection->socket,
                                          pMessage,
                                          bytesRemaining,
                                          0 );
 
+            /* The socket mutex also serializes the send statistics. */
+            _recordBlockingTime( pNetworkConnection->statistics.sendBlockingMs, startTime );
+            pNetworkConnection->statistics.sendCalls++;
+
             if( socketStatus > 0 )
             {
+                pNetworkConnection->statistics.bytesSent += ( uint64_t ) socketStatus;
                 bytesSent += ( size_t ) socketStatus;
                 pMessage += ( size_t ) socketStatus;
                 bytesRemaining -= ( size_t ) socketStatus;
@@ -503,6 +596,7 @@ size_t IotNetworkAfr_Send( void * pConnection,
             }
             else
             {
+                pNetworkConnection->statistics.sendErrors++;
                 IotLogError( "Error %ld while sending data.", ( long int ) socketStatus );
                 break;
             }
@@ -542,10 +636,9 @@ size_t IotNetworkAfr_Receive( void * pConnection,
     /* Block and wait for incoming data. */
     while( bytesRemaining > 0 )
     {
-        socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
+        socketStatus = _socketsRecv( pNetworkConnection,
                                      pBuffer + bytesReceived,
-                                     bytesRemaining,
-                                     0 );
+                                     bytesRemaining );
 
         if( socketStatus == SOCKETS_EWOULDBLOCK )
         {
@@ -609,10 +702,9 @@ size_t IotNetworkAfr_ReceiveUpto( void * pConnection,
     if( bufferSize - bytesReceived > 0 )
     {
         /* Block and wait for incoming data. */
-        socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
+        socketStatus = _socketsRecv( pNetworkConnection,
                                      pBuffer + bytesReceived,
-                                     bufferSize - bytesReceived,
-                                     0 );
+                                     bufferSize - bytesReceived );
 
         if( socketStatus <= 0 )
         {
@@ -688,3 +780,37 @@ IotNetworkError_t IotNetworkAfr_Destroy( void * pConnection )
 }
 
 /*-----------------------------------------------------------*/
+
+IotNetworkError_t IotNetworkAfr_GetStatistics( void * pConnection,
+                                               IotNetworkStatistics_t * pStatistics )
+{
+    IOT_FUNCTION_ENTRY( IotNetworkError_t, IOT_NETWORK_SUCCESS );
+    SocketsTlsRecordCounts_t tlsRecordCounts = { 0 };
+    SocketsTlsRecordCounts_t * pTlsRecordCounts = &tlsRecordCounts;
+
+    /* Cast network connection to the correct type. */
+    _networkConnection_t * pNetworkConnection = ( _networkConnection_t * ) pConnection;
+
+    if( ( pNetworkConnection == NULL ) || ( pStatistics == NULL ) )
+    {
+        IOT_SET_AND_GOTO_CLEANUP( IOT_NETWORK_BAD_PARAMETER );
+    }
+
+    *pStatistics = pNetworkConnection->statistics;
+
+    /* The TLS record counts stay 0 for connections without TLS and for
+     * Secure Sockets ports that do not count records. */
+    if( SOCKETS_SetSockOpt( pNetworkConnection->socket,
+                            0,
+                            SOCKETS_SO_TLS_RECORD_COUNTS,
+                            &pTlsRecordCounts,
+                            sizeof( pTlsRecordCounts ) ) == SOCKETS_ERROR_NONE )
+    {
+        pStatistics->tlsRecordsSent = tlsRecordCounts.ulRecordsSent;
+        pStatistics->tlsRecordsReceived = tlsRecordCounts.ulRecordsReceived;
+    }
+
+    IOT_FUNCTION_EXIT_NO_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
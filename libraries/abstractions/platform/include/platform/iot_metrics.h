@@ -43,6 +43,9 @@
 /* Linear containers (lists and queues) include. */
 #include "iot_linear_containers.h"
 
+/* Platform types include. */
+#include "types/iot_platform_types.h"
+
 /**
  * @functions_page{platform_metrics,platform metrics component,Metrics}
  * @functions_brief{platform metrics component}
@@ -52,6 +55,8 @@
  * @function_brief{platform_metrics_function_cleanup}
  * - @function_name{platform_metrics_function_gettcpconnections}
  * @function_brief{platform_metrics_function_gettcpconnections}
+ * - @function_name{platform_metrics_function_settcpconnectioncallback}
+ * @function_brief{platform_metrics_function_settcpconnectioncallback}
  */
 
 /**
@@ -64,7 +69,23 @@
  * @function_page{IotMetrics_GetTcpConnections,platform_metrics,gettcpconnections}
  * @function_snippet{platform_metrics,gettcpconnections,this}
  * @copydoc IotMetrics_GetTcpConnections
+ * @function_page{IotMetrics_SetTcpConnectionCallback,platform_metrics,settcpconnectioncallback}
+ * @function_snippet{platform_metrics,settcpconnectioncallback,this}
+ * @copydoc IotMetrics_SetTcpConnectionCallback
+ */
+
+/**
+ * @brief Function called when a TCP connection is established or closed.
+ *
+ * @param[in] pContext The context given to @ref platform_metrics_function_settcpconnectioncallback.
+ * @param[in] pTcpConnection The TCP connection. It should not be used after this
+ * function returns.
+ * @param[in] established `true` if the connection was established; `false` if
+ * it was closed.
  */
+typedef void ( * IotMetricsTcpConnectionCallback_t )( void * pContext,
+                                                      const IotMetricsTcpConnection_t * pTcpConnection,
+                                                      bool established );
 
 /**
  * @brief One-time initialization function for the platform metrics component.
@@ -110,4 +131,24 @@ void IotMetrics_GetTcpConnections( void * pContext,
                                    void ( * metricsCallback )( void *, const IotListDouble_t * ) );
 /* @[declare_platform_metrics_gettcpconnections] */
 
+/**
+ * @brief Set a function to be notified of established and closed TCP connections.
+ *
+ * Lets Device Defender track changes to the TCP connections as they happen
+ * instead of reading the complete list for every report. When a callback is
+ * set, it is immediately called for every active TCP connection, so that no
+ * connection is missed between reading the list and setting the callback.
+ *
+ * @param[in] pContext Context passed as the first parameter of `callback`.
+ * @param[in] callback Called for every established or closed TCP connection.
+ * Pass `NULL` to remove a previously set callback.
+ *
+ * @note The callback is invoked with the TCP connection list locked. It must
+ * not call any other metrics function.
+ */
+/* @[declare_platform_metrics_settcpconnectioncallback] */
+void IotMetrics_SetTcpConnectionCallback( void * pContext,
+                                          IotMetricsTcpConnectionCallback_t callback );
+/* @[declare_platform_metrics_settcpconnectioncallback] */
+
 #endif /* ifndef IOT_METRICS_H_ */
@@ -49,6 +49,50 @@ typedef enum IotNetworkError
     IOT_NETWORK_SYSTEM_ERROR   /**< An error occurred when calling a system API. */
 } IotNetworkError_t;
 
+/**
+ * @brief Number of buckets in each blocking time histogram of
+ * #IotNetworkStatistics_t.
+ *
+ * Bucket 0 counts calls that blocked for less than 1 ms. Bucket `n` counts
+ * calls that blocked for at least 2^(n-1) ms and less than 2^n ms, and the
+ * last bucket also counts all longer calls.
+ */
+#define IOT_NETWORK_STATISTICS_HISTOGRAM_BUCKETS    ( 12 )
+
+/**
+ * @ingroup platform_datatypes_paramstructs
+ * @brief I/O statistics of a network connection, read with
+ * @ref platform_network_function_getstatistics.
+ *
+ * All counts start at zero when the connection is created. They are updated
+ * without a lock, so a copy taken while another task is sending or receiving
+ * may mix counts from before and after that call.
+ */
+typedef struct IotNetworkStatistics
+{
+    uint64_t bytesSent;     /**< @brief Bytes accepted by the network stack. */
+    uint64_t bytesReceived; /**< @brief Bytes returned by the network stack. */
+    uint32_t sendCalls;     /**< @brief Calls to the network stack's send function. */
+    uint32_t receiveCalls;  /**< @brief Calls to the network stack's receive function. */
+    uint32_t sendErrors;    /**< @brief Send calls that returned an error. */
+    uint32_t receiveErrors; /**< @brief Receive calls that returned an error. */
+
+    /**
+     * @brief Number of send calls by the time they blocked, see
+     * #IOT_NETWORK_STATISTICS_HISTOGRAM_BUCKETS.
+     */
+    uint32_t sendBlockingMs[ IOT_NETWORK_STATISTICS_HISTOGRAM_BUCKETS ];
+
+    /**
+     * @brief Number of receive calls by the time they blocked, see
+     * #IOT_NETWORK_STATISTICS_HISTOGRAM_BUCKETS.
+     */
+    uint32_t receiveBlockingMs[ IOT_NETWORK_STATISTICS_HISTOGRAM_BUCKETS ];
+
+    uint32_t tlsRecordsSent;     /**< @brief TLS records sent, 0 if the connection does not use TLS. */
+    uint32_t tlsRecordsReceived; /**< @brief TLS records received, 0 if the connection does not use TLS. */
+} IotNetworkStatistics_t;
+
 /**
  * @page platform_network_functions Networking
  * @brief Functions of the network abstraction component.
@@ -75,6 +119,8 @@ typedef enum IotNetworkError
  * @function_brief{platform_network_function_close}
  * - @function_name{platform_network_function_destroy}
  * @function_brief{platform_network_function_destroy}
+ * - @function_name{platform_network_function_getstatistics}
+ * @function_brief{platform_network_function_getstatistics}
  * - @function_name{platform_network_function_receivecallback}
  * @function_brief{platform_network_function_receivecallback}
  */
@@ -101,6 +147,9 @@ typedef enum IotNetworkError
  * @function_page{IotNetworkInterface_t::destroy,platform_network,destroy}
  * @function_snippet{platform_network,destroy,this}
  * @copydoc IotNetworkInterface_t::destroy
+ * @function_page{IotNetworkInterface_t::getStatistics,platform_network,getstatistics}
+ * @function_snippet{platform_network,getstatistics,this}
+ * @copydoc IotNetworkInterface_t::getStatistics
  * @function_page{IotNetworkReceiveCallback_t,platform_network,receivecallback}
  * @function_snippet{platform_network,receivecallback,this}
  * @copydoc IotNetworkReceiveCallback_t
@@ -281,6 +330,25 @@ typedef struct IotNetworkInterface
     /* @[declare_platform_network_destroy] */
     IotNetworkError_t ( * destroy )( void * pConnection );
     /* @[declare_platform_network_destroy] */
+
+    /**
+     * @brief Get the I/O statistics of a network connection.
+     *
+     * This function is optional. Network stacks that do not keep statistics
+     * leave it `NULL`.
+     *
+     * @param[in] pConnection The network connection, defined by the network stack.
+     * @param[out] pStatistics Set to a copy of the connection's statistics.
+     *
+     * @return Any #IotNetworkError_t, as defined by the network stack.
+     *
+     * @note This function may be called on a closed connection, which keeps
+     * the statistics it had when it was closed.
+     */
+    /* @[declare_platform_network_getstatistics] */
+    IotNetworkError_t ( * getStatistics )( void * pConnection,
+                                           IotNetworkStatistics_t * pStatistics );
+    /* @[declare_platform_network_getstatistics] */
 } IotNetworkInterface_t;
 
 /**
@@ -146,6 +146,17 @@ typedef struct IotMetricsTcpConnection
     void * pNetworkContext; /**< @brief Context that may be used by metrics or Defender. */
     size_t addressLength;   /**< @brief The length of the address stored in #IotMetricsTcpConnection_t.pRemoteAddress. */
 
+    /**
+     * @brief Next connection in the same bucket of the metrics connection hash
+     * set. Used only by the metrics implementation.
+     */
+    struct IotMetricsTcpConnection * pNextInBucket;
+
+    uint64_t bytesSent;       /**< @brief Bytes sent on this connection, if counted by the metrics implementation. */
+    uint64_t bytesReceived;   /**< @brief Bytes received on this connection, if counted by the metrics implementation. */
+    uint32_t packetsSent;     /**< @brief Successful send calls on this connection, if counted by the metrics implementation. */
+    uint32_t packetsReceived; /**< @brief Successful receive calls on this connection, if counted by the metrics implementation. */
+
     /**
      * @brief NULL-terminated IP address and port in text format.
      *
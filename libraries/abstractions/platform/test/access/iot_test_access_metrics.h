@@ -0,0 +1,80 @@
+/*
+ * FreeRTOS Platform V1.1.2
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_test_access_metrics.h
+ * @brief Declares the functions that provide access to the internal functions
+ * and variables of the FreeRTOS metrics implementation.
+ */
+
+#ifndef IOT_TEST_ACCESS_METRICS_H_
+#define IOT_TEST_ACCESS_METRICS_H_
+
+/*--------------------------- iot_metrics.c ---------------------------*/
+
+/**
+ * @brief Test access function for #_connectionBucket.
+ *
+ * @see #_connectionBucket.
+ */
+size_t IotTestMetrics_connectionBucket( void * pContext );
+
+/**
+ * @brief Test access function for #_findConnection.
+ *
+ * @return The connection record of `pContext`; `NULL` if it has none.
+ *
+ * @see #_findConnection.
+ */
+IotMetricsTcpConnection_t * IotTestMetrics_findConnection( void * pContext );
+
+/**
+ * @brief Test access function for #_metricsAddTcpConnection.
+ *
+ * @see #_metricsAddTcpConnection.
+ */
+void IotTestMetrics_addTcpConnection( Socket_t xSocket,
+                                      SocketsSockaddr_t * pxAddress );
+
+/**
+ * @brief Test access function for #_metricsRemoveTcpConnection.
+ *
+ * @see #_metricsRemoveTcpConnection.
+ */
+void IotTestMetrics_removeTcpConnection( Socket_t xSocket );
+
+#if AWS_IOT_SECURE_SOCKETS_METRICS_COUNTERS_ENABLED == 1
+
+/**
+ * @brief Test access function for #_metricsCountTransfer.
+ *
+ * @see #_metricsCountTransfer.
+ */
+    void IotTestMetrics_countTransfer( Socket_t xSocket,
+                                       int32_t transferred,
+                                       bool sent );
+#endif
+
+#endif /* ifndef IOT_TEST_ACCESS_METRICS_H_ */
@@ -0,0 +1,262 @@
+/*
+ * FreeRTOS Platform V1.1.2
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_test_platform_metrics.c
+ * @brief Tests for the connection hash set of the FreeRTOS metrics implementation.
+ */
+
+#include "iot_config.h"
+
+/* Test framework includes. */
+#include <string.h>
+#include "unity_fixture.h"
+
+#include "platform/iot_metrics.h"
+#include "iot_secure_sockets.h"
+
+#if AWS_IOT_SECURE_SOCKETS_METRICS_ENABLED == 1
+
+/* Test access include. */
+    #include "iot_test_access_metrics.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Stand-ins for socket handles. The metrics implementation only uses a
+ * handle as a key, so any distinct address works. With one more handle than
+ * there are buckets, at least two of them share a bucket.
+ */
+    static uint32_t _sockets[ AWS_IOT_SECURE_SOCKETS_METRICS_HASH_BUCKETS + 1 ];
+
+/**
+ * @brief Remote address of the test connections.
+ */
+    static SocketsSockaddr_t _address = { 0 };
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the fake socket handle at an index of #_sockets.
+ */
+    static Socket_t _socket( size_t index )
+    {
+        return ( Socket_t ) &( _sockets[ index ] );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for Platform Metrics tests.
+ */
+    TEST_GROUP( UTIL_Platform_Metrics );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for Platform Metrics tests.
+ */
+    TEST_SETUP( UTIL_Platform_Metrics )
+    {
+        TEST_ASSERT_TRUE( IotMetrics_Init() );
+
+        _address.ucLength = sizeof( SocketsSockaddr_t );
+        _address.ucSocketDomain = SOCKETS_AF_INET;
+        _address.usPort = SOCKETS_htons( 443 );
+        _address.ulAddress = SOCKETS_inet_addr_quick( 10, 0, 0, 1 );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for Platform Metrics tests.
+ */
+    TEST_TEAR_DOWN( UTIL_Platform_Metrics )
+    {
+        size_t i = 0;
+
+        /* Remove any connection left behind by a failed test. */
+        for( i = 0; i < ( sizeof( _sockets ) / sizeof( _sockets[ 0 ] ) ); i++ )
+        {
+            IotTestMetrics_removeTcpConnection( _socket( i ) );
+        }
+
+        IotMetrics_Cleanup();
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for Platform Metrics tests.
+ */
+    TEST_GROUP_RUNNER( UTIL_Platform_Metrics )
+    {
+        RUN_TEST_CASE( UTIL_Platform_Metrics, InsertRemove );
+        RUN_TEST_CASE( UTIL_Platform_Metrics, InsertDuplicate );
+        RUN_TEST_CASE( UTIL_Platform_Metrics, BucketCollision );
+        #if AWS_IOT_SECURE_SOCKETS_METRICS_COUNTERS_ENABLED == 1
+            RUN_TEST_CASE( UTIL_Platform_Metrics, CountTransfer );
+        #endif
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that an added connection can be found until it is removed.
+ */
+    TEST( UTIL_Platform_Metrics, InsertRemove )
+    {
+        IotMetricsTcpConnection_t * pTcpConnection = NULL;
+
+        TEST_ASSERT_NULL( IotTestMetrics_findConnection( _socket( 0 ) ) );
+
+        IotTestMetrics_addTcpConnection( _socket( 0 ), &_address );
+
+        pTcpConnection = IotTestMetrics_findConnection( _socket( 0 ) );
+        TEST_ASSERT_NOT_NULL( pTcpConnection );
+        TEST_ASSERT_EQUAL_PTR( _socket( 0 ), pTcpConnection->pNetworkContext );
+        TEST_ASSERT_EQUAL_STRING( "10.0.0.1:443", pTcpConnection->pRemoteAddress );
+        TEST_ASSERT_EQUAL( strlen( "10.0.0.1:443" ), pTcpConnection->addressLength );
+
+        IotTestMetrics_removeTcpConnection( _socket( 0 ) );
+        TEST_ASSERT_NULL( IotTestMetrics_findConnection( _socket( 0 ) ) );
+
+        /* Removing a connection without a record has no effect. */
+        IotTestMetrics_removeTcpConnection( _socket( 0 ) );
+        TEST_ASSERT_NULL( IotTestMetrics_findConnection( _socket( 0 ) ) );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that adding a connection twice keeps a single record.
+ */
+    TEST( UTIL_Platform_Metrics, InsertDuplicate )
+    {
+        IotMetricsTcpConnection_t * pTcpConnection = NULL;
+
+        IotTestMetrics_addTcpConnection( _socket( 0 ), &_address );
+        pTcpConnection = IotTestMetrics_findConnection( _socket( 0 ) );
+        TEST_ASSERT_NOT_NULL( pTcpConnection );
+
+        IotTestMetrics_addTcpConnection( _socket( 0 ), &_address );
+        TEST_ASSERT_EQUAL_PTR( pTcpConnection, IotTestMetrics_findConnection( _socket( 0 ) ) );
+
+        /* A single removal must remove the connection. */
+        IotTestMetrics_removeTcpConnection( _socket( 0 ) );
+        TEST_ASSERT_NULL( IotTestMetrics_findConnection( _socket( 0 ) ) );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test connections that share a bucket of the hash set.
+ */
+    TEST( UTIL_Platform_Metrics, BucketCollision )
+    {
+        size_t i = 0, j = 0, first = 0, second = 0;
+        size_t count = sizeof( _sockets ) / sizeof( _sockets[ 0 ] );
+
+        /* Find two handles in the same bucket. */
+        for( i = 0; ( i < count ) && ( second == 0 ); i++ )
+        {
+            for( j = i + 1; ( j < count ) && ( second == 0 ); j++ )
+            {
+                if( IotTestMetrics_connectionBucket( _socket( i ) ) ==
+                    IotTestMetrics_connectionBucket( _socket( j ) ) )
+                {
+                    first = i;
+                    second = j;
+                }
+            }
+        }
+
+        TEST_ASSERT_NOT_EQUAL( 0, second );
+
+        /* Both connections must be found in the shared bucket. */
+        IotTestMetrics_addTcpConnection( _socket( first ), &_address );
+        IotTestMetrics_addTcpConnection( _socket( second ), &_address );
+
+        TEST_ASSERT_EQUAL_PTR( _socket( first ), IotTestMetrics_findConnection( _socket( first ) )->pNetworkContext );
+        TEST_ASSERT_EQUAL_PTR( _socket( second ), IotTestMetrics_findConnection( _socket( second ) )->pNetworkContext );
+
+        /* Removing the first connection inserted keeps the other one. */
+        IotTestMetrics_removeTcpConnection( _socket( first ) );
+        TEST_ASSERT_NULL( IotTestMetrics_findConnection( _socket( first ) ) );
+        TEST_ASSERT_NOT_NULL( IotTestMetrics_findConnection( _socket( second ) ) );
+
+        /* Re-add it and remove the other connection instead. */
+        IotTestMetrics_addTcpConnection( _socket( first ), &_address );
+        IotTestMetrics_removeTcpConnection( _socket( second ) );
+        TEST_ASSERT_NOT_NULL( IotTestMetrics_findConnection( _socket( first ) ) );
+        TEST_ASSERT_NULL( IotTestMetrics_findConnection( _socket( second ) ) );
+
+        IotTestMetrics_removeTcpConnection( _socket( first ) );
+        TEST_ASSERT_NULL( IotTestMetrics_findConnection( _socket( first ) ) );
+    }
+
+/*-----------------------------------------------------------*/
+
+    #if AWS_IOT_SECURE_SOCKETS_METRICS_COUNTERS_ENABLED == 1
+
+/**
+ * @brief Test that transfers are counted only on their own connection.
+ */
+        TEST( UTIL_Platform_Metrics, CountTransfer )
+        {
+            IotMetricsTcpConnection_t * pFirst = NULL, * pSecond = NULL;
+
+            IotTestMetrics_addTcpConnection( _socket( 0 ), &_address );
+            IotTestMetrics_addTcpConnection( _socket( 1 ), &_address );
+            pFirst = IotTestMetrics_findConnection( _socket( 0 ) );
+            pSecond = IotTestMetrics_findConnection( _socket( 1 ) );
+
+            IotTestMetrics_countTransfer( _socket( 0 ), 100, true );
+            IotTestMetrics_countTransfer( _socket( 0 ), 20, true );
+            IotTestMetrics_countTransfer( _socket( 0 ), 7, false );
+            IotTestMetrics_countTransfer( _socket( 1 ), 5, false );
+
+            TEST_ASSERT_EQUAL( 120, pFirst->bytesSent );
+            TEST_ASSERT_EQUAL( 2, pFirst->packetsSent );
+            TEST_ASSERT_EQUAL( 7, pFirst->bytesReceived );
+            TEST_ASSERT_EQUAL( 1, pFirst->packetsReceived );
+            TEST_ASSERT_EQUAL( 0, pSecond->bytesSent );
+            TEST_ASSERT_EQUAL( 0, pSecond->packetsSent );
+            TEST_ASSERT_EQUAL( 5, pSecond->bytesReceived );
+            TEST_ASSERT_EQUAL( 1, pSecond->packetsReceived );
+
+            /* A transfer on a connection without a record is ignored. */
+            IotTestMetrics_removeTcpConnection( _socket( 1 ) );
+            IotTestMetrics_countTransfer( _socket( 1 ), 5, false );
+            TEST_ASSERT_EQUAL( 7, pFirst->bytesReceived );
+
+            IotTestMetrics_removeTcpConnection( _socket( 0 ) );
+        }
+
+    #endif /* if AWS_IOT_SECURE_SOCKETS_METRICS_COUNTERS_ENABLED == 1 */
+
+/*-----------------------------------------------------------*/
+
+#endif /* if AWS_IOT_SECURE_SOCKETS_METRICS_ENABLED == 1 */
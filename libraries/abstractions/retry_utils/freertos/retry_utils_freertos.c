@@ -25,6 +25,7 @@
  */
 
 /* Standard includes. */
+#include <stddef.h>
 #include <stdint.h>
 #include <time.h>
 
@@ -39,14 +40,33 @@
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Optional hook that fills a buffer with random bytes for the jitter.
+ *
+ * Define retryutilsconfigGENERATE_RANDOM in FreeRTOSConfig.h to the name of a
+ * function with this prototype, returning zero on success. For example, an
+ * application that links TLS can use its shared DRBG with:
+ *
+ * #define retryutilsconfigGENERATE_RANDOM    TLS_GenerateRandom
+ *
+ * If it is not defined, or the function fails, a pseudo random generator
+ * seeded from the tick count is used.
+ */
+#ifdef retryutilsconfigGENERATE_RANDOM
+    extern BaseType_t retryutilsconfigGENERATE_RANDOM( unsigned char * pucRandom,
+                                                       size_t xRandomLength );
+#endif
+
 /* @brief This is used by the pseudo random number generator. */
 static uint32_t ulNextRand;
 
 /**
- * @brief A psuedo random generator function.
+ * @brief Generates a random number for the backoff jitter.
  *
- * @note  This is not a secure method of generating a random number.
- * Production devices should use a True Random Number Generator (TRNG).
+ * The number is drawn from retryutilsconfigGENERATE_RANDOM when it is
+ * defined. Otherwise, or if that fails, a pseudo random generator seeded from
+ * the tick count is used instead, which is not a secure method of generating a
+ * random number but is enough to spread out retries.
  *
  * @return The generated random number.
  */
@@ -62,16 +82,29 @@ static void initializeRand();
 static uint32_t generateRandNum()
 {
     const uint32_t ulMultiplier = 0x015a4e35UL, ulIncrement = 1UL;
+    uint32_t ulRandomValue = 0;
 
-    /*
-     * Utility function to generate a pseudo random number.
-     *
-     * !!!NOTE!!!
-     * This is not a secure method of generating a random number.  Production
-     * devices should use a True Random Number Generator (TRNG).
-     */
-    ulNextRand = ( ulMultiplier * ulNextRand ) + ulIncrement;
-    return( ( int ) ( ulNextRand >> 16UL ) & 0x7fffUL );
+    #ifdef retryutilsconfigGENERATE_RANDOM
+        if( 0 == retryutilsconfigGENERATE_RANDOM( ( unsigned char * ) &ulRandomValue, sizeof( ulRandomValue ) ) )
+        {
+            /* Keep the range of the fallback generator below. */
+            ulRandomValue &= 0x7fffUL;
+        }
+        else
+    #endif
+    {
+        /*
+         * Utility function to generate a pseudo random number.
+         *
+         * !!!NOTE!!!
+         * This is not a secure method of generating a random number.  Production
+         * devices should use a True Random Number Generator (TRNG).
+         */
+        ulNextRand = ( ulMultiplier * ulNextRand ) + ulIncrement;
+        ulRandomValue = ( ulNextRand >> 16UL ) & 0x7fffUL;
+    }
+
+    return ulRandomValue;
 }
 
 /*-----------------------------------------------------------*/
@@ -79,7 +112,7 @@ static uint32_t generateRandNum()
 static void initializeRand()
 {
     /*
-     * Seed random number generator.
+     * Seed the fallback random number generator.
      *
      * !!!NOTE!!!
      * This is not a secure method of generating a random number.  Production
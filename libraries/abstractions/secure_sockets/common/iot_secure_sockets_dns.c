@@ -0,0 +1,478 @@
+/*
+ * FreeRTOS Secure Sockets V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_secure_sockets_dns.c
+ * @brief DNS cache and resolver task shared by the secure sockets ports.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Secure sockets includes. */
+#include "iot_secure_sockets_dns.h"
+
+/**
+ * @brief Function names are looked up with, if not SOCKETS_GetHostByName().
+ */
+static SocketsDnsLookup_t xDnsLookup = NULL;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Look a host name up with the lookup function in use.
+ *
+ * @param[in] pcHostName The host name to resolve.
+ * @param[out] pulTtlMs Set to the TTL of the record, or 0 if it is not known.
+ *
+ * @return The IPv4 address of the host, or 0 if it could not be resolved.
+ */
+static uint32_t prvDnsLookup( const char * pcHostName,
+                              uint32_t * pulTtlMs )
+{
+    SocketsDnsLookup_t xLookup = xDnsLookup;
+    uint32_t ulAddress;
+
+    *pulTtlMs = 0;
+
+    if( NULL != xLookup )
+    {
+        ulAddress = xLookup( pcHostName, pulTtlMs );
+    }
+    else
+    {
+        ulAddress = SOCKETS_GetHostByName( pcHostName );
+    }
+
+    return ulAddress;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( socketsconfigUSE_DNS_CACHE == 1 )
+
+/**
+ * @brief States of a DNS cache entry.
+ */
+    #define dnsENTRY_FREE        ( 0 ) /**< @brief Not in use. */
+    #define dnsENTRY_PENDING     ( 1 ) /**< @brief Queued for or being looked up by the resolver task. */
+    #define dnsENTRY_RESOLVED    ( 2 ) /**< @brief Holds the result of a lookup, 0 if it failed. */
+
+/**
+ * @brief A host name in the DNS cache.
+ */
+    typedef struct SocketsDnsEntry
+    {
+        char cHostName[ securesocketsMAX_DNS_NAME_LENGTH + 1 ];
+        uint32_t ulAddress;
+        TickType_t xResolvedTime;
+        TickType_t xTtl;
+        TickType_t xLastUsed;
+        BaseType_t xState;
+        SocketsDnsQuery_t * pxWaiters;
+    } SocketsDnsEntry_t;
+
+/**
+ * @brief The DNS cache, protected by xDnsLock.
+ */
+    static SocketsDnsEntry_t xDnsCache[ socketsconfigDNS_CACHE_ENTRIES ];
+
+/**
+ * @brief Lock for the DNS cache.
+ */
+    static SemaphoreHandle_t xDnsLock = NULL;
+
+/**
+ * @brief Entries waiting for the resolver task. It is created with the task,
+ * the first time a name is resolved.
+ */
+    static QueueHandle_t xDnsQueue = NULL;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Resolver task. Looks up each entry that is queued and calls the
+ * queries waiting for it.
+ *
+ * @param[in] pvParameters Unused.
+ */
+    static void prvDnsTask( void * pvParameters )
+    {
+        char cHostName[ securesocketsMAX_DNS_NAME_LENGTH + 1 ];
+        SocketsDnsEntry_t * pxEntry = NULL;
+        SocketsDnsQuery_t * pxWaiters;
+        SocketsDnsQuery_t * pxNext;
+        uint32_t ulAddress;
+        uint32_t ulTtlMs;
+
+        ( void ) pvParameters;
+
+        for( ; ; )
+        {
+            ( void ) xQueueReceive( xDnsQueue, &pxEntry, portMAX_DELAY );
+
+            /* The name of a pending entry does not change, so it can be read
+             * without the lock while the lookup blocks. */
+            ulAddress = prvDnsLookup( pxEntry->cHostName, &ulTtlMs );
+
+            if( 0U == ulAddress )
+            {
+                ulTtlMs = socketsconfigDNS_NEGATIVE_TTL_MS;
+            }
+            else if( 0U == ulTtlMs )
+            {
+                ulTtlMs = socketsconfigDNS_CACHE_TTL_MS;
+            }
+            else if( ulTtlMs > socketsconfigDNS_CACHE_MAX_TTL_MS )
+            {
+                ulTtlMs = socketsconfigDNS_CACHE_MAX_TTL_MS;
+            }
+
+            ( void ) xSemaphoreTake( xDnsLock, portMAX_DELAY );
+
+            pxEntry->ulAddress = ulAddress;
+            pxEntry->xResolvedTime = xTaskGetTickCount();
+            pxEntry->xTtl = pdMS_TO_TICKS( ulTtlMs );
+            pxEntry->xState = dnsENTRY_RESOLVED;
+            pxWaiters = pxEntry->pxWaiters;
+            pxEntry->pxWaiters = NULL;
+
+            /* The entry may be reused as soon as the lock is given. */
+            ( void ) strcpy( cHostName, pxEntry->cHostName );
+
+            ( void ) xSemaphoreGive( xDnsLock );
+
+            /* A callback may free its query, so move past it first. */
+            while( NULL != pxWaiters )
+            {
+                pxNext = pxWaiters->pxNext;
+                pxWaiters->xCallback( pxWaiters->pvContext, cHostName, ulAddress );
+                pxWaiters = pxNext;
+            }
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Create the lock the first time through and take it.
+ */
+    static void prvDnsTakeLock( void )
+    {
+        static StaticSemaphore_t xStaticSemaphore;
+
+        portENTER_CRITICAL();
+
+        if( NULL == xDnsLock )
+        {
+            xDnsLock = xSemaphoreCreateMutexStatic( &xStaticSemaphore );
+        }
+
+        portEXIT_CRITICAL();
+
+        ( void ) xSemaphoreTake( xDnsLock, portMAX_DELAY );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Create the queue and the resolver task if they do not exist yet.
+ * Called with the lock held.
+ *
+ * @return pdPASS if the resolver task is running.
+ */
+    static BaseType_t prvDnsStartTask( void )
+    {
+        BaseType_t xResult = pdPASS;
+
+        if( NULL == xDnsQueue )
+        {
+            /* Only pending entries are queued, and only once each, so the queue
+             * cannot fill up. */
+            xDnsQueue = xQueueCreate( socketsconfigDNS_CACHE_ENTRIES, sizeof( SocketsDnsEntry_t * ) );
+
+            if( NULL == xDnsQueue )
+            {
+                xResult = pdFAIL;
+            }
+            else if( pdPASS != xTaskCreate( prvDnsTask,
+                                            "DNS",
+                                            socketsconfigDNS_TASK_STACK_SIZE,
+                                            NULL,
+                                            socketsconfigDNS_TASK_PRIORITY,
+                                            NULL ) )
+            {
+                vQueueDelete( xDnsQueue );
+                xDnsQueue = NULL;
+                xResult = pdFAIL;
+            }
+        }
+
+        return xResult;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Find the entry of a host name, or one to store it in. Called with
+ * the lock held.
+ *
+ * @param[in] pcHostName The host name to look for.
+ *
+ * @return The entry of the name if it is cached. Otherwise a free entry or
+ * the least recently used resolved entry, or NULL if every entry is pending.
+ */
+    static SocketsDnsEntry_t * prvDnsFindEntry( const char * pcHostName )
+    {
+        SocketsDnsEntry_t * pxVictim = NULL;
+        SocketsDnsEntry_t * pxEntry;
+        UBaseType_t uxIndex;
+        TickType_t xNow = xTaskGetTickCount();
+
+        for( uxIndex = 0; uxIndex < socketsconfigDNS_CACHE_ENTRIES; uxIndex++ )
+        {
+            pxEntry = &xDnsCache[ uxIndex ];
+
+            if( dnsENTRY_FREE == pxEntry->xState )
+            {
+                if( ( NULL == pxVictim ) || ( dnsENTRY_FREE != pxVictim->xState ) )
+                {
+                    pxVictim = pxEntry;
+                }
+            }
+            else if( 0 == strcmp( pxEntry->cHostName, pcHostName ) )
+            {
+                break;
+            }
+            else if( ( dnsENTRY_RESOLVED == pxEntry->xState ) &&
+                     ( ( NULL == pxVictim ) ||
+                       ( ( dnsENTRY_RESOLVED == pxVictim->xState ) &&
+                         ( ( xNow - pxEntry->xLastUsed ) > ( xNow - pxVictim->xLastUsed ) ) ) ) )
+            {
+                pxVictim = pxEntry;
+            }
+        }
+
+        if( uxIndex < socketsconfigDNS_CACHE_ENTRIES )
+        {
+            pxVictim = pxEntry;
+        }
+        else if( NULL != pxVictim )
+        {
+            /* Clear the name so that it is not reported as cached. */
+            pxVictim->xState = dnsENTRY_FREE;
+            pxVictim->cHostName[ 0 ] = '\0';
+        }
+
+        return pxVictim;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Context of a SOCKETS_DnsResolve() call waiting for the resolver.
+ */
+    typedef struct SocketsDnsWait
+    {
+        SemaphoreHandle_t xDone;
+        uint32_t ulAddress;
+    } SocketsDnsWait_t;
+
+/**
+ * @brief Callback of SOCKETS_DnsResolve(), wakes the waiting task.
+ */
+    static void prvDnsResolveDone( void * pvContext,
+                                   const char * pcHostName,
+                                   uint32_t ulAddress )
+    {
+        SocketsDnsWait_t * pxWait = ( SocketsDnsWait_t * ) pvContext;
+
+        ( void ) pcHostName;
+
+        pxWait->ulAddress = ulAddress;
+        ( void ) xSemaphoreGive( pxWait->xDone );
+    }
+
+#endif /* if ( socketsconfigUSE_DNS_CACHE == 1 ) */
+
+/*-----------------------------------------------------------*/
+
+uint32_t SOCKETS_DnsResolve( const char * pcHostName )
+{
+    uint32_t ulAddress = 0;
+    uint32_t ulTtlMs;
+
+    #if ( socketsconfigUSE_DNS_CACHE == 1 )
+        StaticSemaphore_t xDoneBuffer;
+        SocketsDnsQuery_t xQuery;
+        SocketsDnsWait_t xWait;
+        int32_t lStatus;
+
+        xWait.xDone = xSemaphoreCreateBinaryStatic( &xDoneBuffer );
+        xWait.ulAddress = 0;
+
+        lStatus = SOCKETS_DnsResolveAsync( pcHostName, &xQuery, prvDnsResolveDone, &xWait );
+
+        if( SOCKETS_ERROR_NONE == lStatus )
+        {
+            ( void ) xSemaphoreTake( xWait.xDone, portMAX_DELAY );
+            ulAddress = xWait.ulAddress;
+        }
+        else if( SOCKETS_ENOMEM == lStatus )
+        {
+            /* Every entry is being resolved, look the name up without caching it. */
+            ulAddress = prvDnsLookup( pcHostName, &ulTtlMs );
+        }
+
+        vSemaphoreDelete( xWait.xDone );
+    #else /* if ( socketsconfigUSE_DNS_CACHE == 1 ) */
+        if( NULL != pcHostName )
+        {
+            ulAddress = prvDnsLookup( pcHostName, &ulTtlMs );
+        }
+    #endif /* if ( socketsconfigUSE_DNS_CACHE == 1 ) */
+
+    return ulAddress;
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_DnsResolveAsync( const char * pcHostName,
+                                 SocketsDnsQuery_t * pxQuery,
+                                 SocketsDnsCallback_t xCallback,
+                                 void * pvContext )
+{
+    int32_t lStatus = SOCKETS_ERROR_NONE;
+    uint32_t ulAddress = 0;
+    BaseType_t xAnswered = pdFALSE;
+
+    #if ( socketsconfigUSE_DNS_CACHE == 1 )
+        SocketsDnsEntry_t * pxEntry = NULL;
+        TickType_t xNow;
+    #else
+        uint32_t ulTtlMs;
+    #endif
+
+    if( ( NULL == pcHostName ) || ( NULL == pxQuery ) || ( NULL == xCallback ) ||
+        ( strlen( pcHostName ) > ( size_t ) securesocketsMAX_DNS_NAME_LENGTH ) )
+    {
+        lStatus = SOCKETS_EINVAL;
+    }
+    else
+    {
+        pxQuery->xCallback = xCallback;
+        pxQuery->pvContext = pvContext;
+        pxQuery->pxNext = NULL;
+
+        #if ( socketsconfigUSE_DNS_CACHE == 1 )
+            prvDnsTakeLock();
+
+            xNow = xTaskGetTickCount();
+            pxEntry = prvDnsFindEntry( pcHostName );
+
+            if( NULL == pxEntry )
+            {
+                lStatus = SOCKETS_ENOMEM;
+            }
+            else if( ( dnsENTRY_RESOLVED == pxEntry->xState ) &&
+                     ( ( xNow - pxEntry->xResolvedTime ) < pxEntry->xTtl ) )
+            {
+                pxEntry->xLastUsed = xNow;
+                ulAddress = pxEntry->ulAddress;
+                xAnswered = pdTRUE;
+            }
+            else if( dnsENTRY_PENDING == pxEntry->xState )
+            {
+                /* Wait for the lookup that is already running. */
+                pxQuery->pxNext = pxEntry->pxWaiters;
+                pxEntry->pxWaiters = pxQuery;
+            }
+            else if( pdPASS != prvDnsStartTask() )
+            {
+                lStatus = SOCKETS_ENOMEM;
+            }
+            else
+            {
+                /* A free entry, or one whose record has expired. */
+                ( void ) strcpy( pxEntry->cHostName, pcHostName );
+                pxEntry->xState = dnsENTRY_PENDING;
+                pxEntry->xLastUsed = xNow;
+                pxEntry->pxWaiters = pxQuery;
+
+                ( void ) xQueueSend( xDnsQueue, &pxEntry, 0 );
+            }
+
+            ( void ) xSemaphoreGive( xDnsLock );
+        #else /* if ( socketsconfigUSE_DNS_CACHE == 1 ) */
+            ulAddress = prvDnsLookup( pcHostName, &ulTtlMs );
+            xAnswered = pdTRUE;
+        #endif /* if ( socketsconfigUSE_DNS_CACHE == 1 ) */
+
+        if( pdTRUE == xAnswered )
+        {
+            xCallback( pvContext, pcHostName, ulAddress );
+        }
+    }
+
+    return lStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+void SOCKETS_DnsFlush( const char * pcHostName )
+{
+    #if ( socketsconfigUSE_DNS_CACHE == 1 )
+        UBaseType_t uxIndex;
+
+        prvDnsTakeLock();
+
+        for( uxIndex = 0; uxIndex < socketsconfigDNS_CACHE_ENTRIES; uxIndex++ )
+        {
+            if( ( dnsENTRY_RESOLVED == xDnsCache[ uxIndex ].xState ) &&
+                ( ( NULL == pcHostName ) || ( 0 == strcmp( xDnsCache[ uxIndex ].cHostName, pcHostName ) ) ) )
+            {
+                xDnsCache[ uxIndex ].xState = dnsENTRY_FREE;
+                xDnsCache[ uxIndex ].cHostName[ 0 ] = '\0';
+            }
+        }
+
+        ( void ) xSemaphoreGive( xDnsLock );
+    #else
+        ( void ) pcHostName;
+    #endif /* if ( socketsconfigUSE_DNS_CACHE == 1 ) */
+}
+
+/*-----------------------------------------------------------*/
+
+void SOCKETS_DnsSetLookupFunction( SocketsDnsLookup_t xLookup )
+{
+    xDnsLookup = xLookup;
+}
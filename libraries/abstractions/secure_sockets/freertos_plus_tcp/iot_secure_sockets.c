@@ -290,6 +290,7 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
     char ** ppcAlpnIn = ( char ** ) pvOptionValue;
     size_t xLength = 0;
     uint32_t ulProtocol;
+    SocketsTlsRecordCounts_t * pxCounts;
 
     if( ( xSocket != SOCKETS_INVALID_SOCKET ) && ( xSocket != NULL ) )
     {
@@ -450,6 +451,28 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
                                                xOptionLength );
                 break;
 
+            case SOCKETS_SO_TLS_RECORD_COUNTS:
+
+                if( ( NULL == pvOptionValue ) || ( sizeof( SocketsTlsRecordCounts_t * ) != xOptionLength ) )
+                {
+                    lStatus = SOCKETS_EINVAL;
+                }
+
+                /* Records are only counted once TLS has been negotiated. */
+                else if( ( pdTRUE != pxContext->xRequireTLS ) || ( NULL == pxContext->pvTLSContext ) )
+                {
+                    lStatus = SOCKETS_ENOTCONN;
+                }
+                else
+                {
+                    pxCounts = *( ( SocketsTlsRecordCounts_t * const * ) pvOptionValue ); /*lint !e9087 pvOptionValue passed should be of SocketsTlsRecordCounts_t * */
+                    TLS_GetRecordCounts( pxContext->pvTLSContext,
+                                         &pxCounts->ulRecordsSent,
+                                         &pxCounts->ulRecordsReceived );
+                }
+
+                break;
+
             default:
                 lStatus = FreeRTOS_setsockopt( pxContext->xSocket,
                                                lLevel,
@@ -661,28 +684,13 @@ static CK_RV prvSocketsGetCryptoSession( SemaphoreHandle_t * pxSessionLock,
 
 BaseType_t xApplicationGetRandomNumber( uint32_t * pulNumber )
 {
-    CK_RV xResult = 0;
-    SemaphoreHandle_t xSessionLock = NULL;
-    CK_SESSION_HANDLE xPkcs11Session = 0;
-    CK_FUNCTION_LIST_PTR pxPkcs11FunctionList = NULL;
     uint32_t ulRandomValue = 0;
     BaseType_t xReturn; /* Return pdTRUE if successful */
 
-    xResult = prvSocketsGetCryptoSession( &xSessionLock,
-                                          &xPkcs11Session,
-                                          &pxPkcs11FunctionList );
-
-    if( 0 == xResult )
-    {
-        /* Request a sequence of cryptographically random byte values using
-         * PKCS#11. */
-        xResult = pxPkcs11FunctionList->C_GenerateRandom( xPkcs11Session,
-                                                          ( CK_BYTE_PTR ) &ulRandomValue,
-                                                          sizeof( ulRandomValue ) );
-    }
-
-    /* Check if any of the API calls failed. */
-    if( 0 == xResult )
+    /* Draw from the DRBG shared with TLS, which is seeded through PKCS#11,
+     * rather than making a PKCS#11 call for every number. */
+    if( 0 == TLS_GenerateRandom( ( unsigned char * ) &ulRandomValue,
+                                 sizeof( ulRandomValue ) ) )
     {
         xReturn = pdTRUE;
         *( pulNumber ) = ulRandomValue;
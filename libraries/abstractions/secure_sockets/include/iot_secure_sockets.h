@@ -172,6 +172,7 @@ typedef struct xSOCKET * Socket_t; /**< @brief Socket handle data type. */
 #define SOCKETS_SO_TCPKEEPALIVE_INTERVAL         ( 19 ) /**< Set the time in seconds between individual TCP keep-alive probes. */
 #define SOCKETS_SO_TCPKEEPALIVE_COUNT            ( 20 ) /**< Set the maximum number of keep-alive probes TCP should send before dropping the connection. */
 #define SOCKETS_SO_TCPKEEPALIVE_IDLE_TIME        ( 21 ) /**< Set the time in seconds for which the connection needs to remain idle before TCP starts sending keep-alive probes. */
+#define SOCKETS_SO_TLS_RECORD_COUNTS             ( 22 ) /**< Read the number of TLS records sent and received on the socket. */
 
 /**@} */
 
@@ -206,6 +207,16 @@ typedef struct SocketsSockaddr
     uint32_t ulAddress;     /**< IP Address. Convention is to call this sin_addr. */
 } SocketsSockaddr_t;
 
+/**
+ * @ingroup SecureSockets_datatypes_paramstructs
+ * @brief TLS record counts read with @ref SOCKETS_SO_TLS_RECORD_COUNTS.
+ */
+typedef struct SocketsTlsRecordCounts
+{
+    uint32_t ulRecordsSent;     /**< Application data records sent since the handshake. */
+    uint32_t ulRecordsReceived; /**< Application data records received since the handshake. */
+} SocketsTlsRecordCounts_t;
+
 /**
  * @brief Well-known port numbers.
  */
@@ -529,6 +540,12 @@ int32_t SOCKETS_Close( Socket_t xSocket );
  *      - Set the time in seconds for which the connection needs to remain idle
  *        before TCP starts sending keep-alive probes.
  *      - pvOptionValue is the time in seconds.
+ *    - @ref SOCKETS_SO_TLS_RECORD_COUNTS
+ *      - Read the number of TLS application data records sent and received
+ *        on a connected socket that uses TLS.
+ *      - pvOptionValue is a pointer to a (SocketsTlsRecordCounts_t *) that
+ *        receives the counts.
+ *      - xOptionLength is sizeof( SocketsTlsRecordCounts_t * ).
  *
  * @return
  * * On success, 0 is returned.
@@ -69,4 +69,87 @@
     #define AWS_IOT_SECURE_SOCKETS_METRICS_ENABLED    ( 0 )
 #endif
 
+/**
+ * @brief By default, secure sockets metrics do not count the bytes and packets
+ * of each connection.
+ *
+ * When enabled along with #AWS_IOT_SECURE_SOCKETS_METRICS_ENABLED, SOCKETS_Send
+ * and SOCKETS_Recv are also wrapped to update the counters of the metrics
+ * connection record.
+ */
+#ifndef AWS_IOT_SECURE_SOCKETS_METRICS_COUNTERS_ENABLED
+    #define AWS_IOT_SECURE_SOCKETS_METRICS_COUNTERS_ENABLED    ( 0 )
+#endif
+
+/**
+ * @brief Number of buckets in the secure sockets metrics connection hash set.
+ *
+ * Connection records are looked up by socket in a hash set with this many
+ * buckets. It should be about the number of sockets expected to be open at
+ * the same time.
+ */
+#ifndef AWS_IOT_SECURE_SOCKETS_METRICS_HASH_BUCKETS
+    #define AWS_IOT_SECURE_SOCKETS_METRICS_HASH_BUCKETS    ( 8 )
+#endif
+
+/**
+ * @brief By default, SOCKETS_DnsResolve() calls SOCKETS_GetHostByName() on
+ * every call.
+ *
+ * When set to 1, host names are resolved by a resolver task and the results
+ * are cached. Queries for a name that is already being resolved wait for the
+ * same lookup. The network abstraction, the transport interface and the
+ * Greengrass discovery helper then resolve through the cache, so
+ * common/iot_secure_sockets_dns.c must be part of the build. When 0, they call
+ * SOCKETS_GetHostByName() directly.
+ */
+#ifndef socketsconfigUSE_DNS_CACHE
+    #define socketsconfigUSE_DNS_CACHE    ( 0 )
+#endif
+
+/**
+ * @brief Number of host names the DNS cache holds, including names being
+ * resolved.
+ */
+#ifndef socketsconfigDNS_CACHE_ENTRIES
+    #define socketsconfigDNS_CACHE_ENTRIES    ( 4 )
+#endif
+
+/**
+ * @brief How long an address is cached, in milliseconds, when the lookup does
+ * not report the TTL of the record.
+ */
+#ifndef socketsconfigDNS_CACHE_TTL_MS
+    #define socketsconfigDNS_CACHE_TTL_MS    ( 300000 )
+#endif
+
+/**
+ * @brief Longest time an address is cached, in milliseconds, whatever the TTL
+ * of the record.
+ */
+#ifndef socketsconfigDNS_CACHE_MAX_TTL_MS
+    #define socketsconfigDNS_CACHE_MAX_TTL_MS    ( 3600000 )
+#endif
+
+/**
+ * @brief How long a failed lookup is cached, in milliseconds.
+ */
+#ifndef socketsconfigDNS_NEGATIVE_TTL_MS
+    #define socketsconfigDNS_NEGATIVE_TTL_MS    ( 10000 )
+#endif
+
+/**
+ * @brief Stack size of the DNS resolver task.
+ */
+#ifndef socketsconfigDNS_TASK_STACK_SIZE
+    #define socketsconfigDNS_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4 )
+#endif
+
+/**
+ * @brief Priority of the DNS resolver task.
+ */
+#ifndef socketsconfigDNS_TASK_PRIORITY
+    #define socketsconfigDNS_TASK_PRIORITY    ( tskIDLE_PRIORITY + 5 )
+#endif
+
 #endif /* AWS_INC_SECURE_SOCKETS_CONFIG_DEFAULTS_H_ */
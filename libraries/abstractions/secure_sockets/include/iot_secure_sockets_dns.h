@@ -0,0 +1,151 @@
+/*
+ * FreeRTOS Secure Sockets V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_secure_sockets_dns.h
+ * @brief Cached, asynchronous host name resolution on top of
+ * SOCKETS_GetHostByName().
+ *
+ * With socketsconfigUSE_DNS_CACHE set to 1, lookups run on a resolver task
+ * and their results are kept for the TTL of the record, or for
+ * socketsconfigDNS_CACHE_TTL_MS when the lookup does not report it. Failed
+ * lookups are kept for socketsconfigDNS_NEGATIVE_TTL_MS. Queries for a name
+ * that is already being resolved wait for the same lookup instead of starting
+ * another one.
+ */
+
+#ifndef _AWS_SECURE_SOCKETS_DNS_H_
+#define _AWS_SECURE_SOCKETS_DNS_H_
+
+#include "iot_secure_sockets.h"
+
+/**
+ * @brief Function called with the result of SOCKETS_DnsResolveAsync().
+ *
+ * @param[in] pvContext The context given to SOCKETS_DnsResolveAsync().
+ * @param[in] pcHostName The host name that was resolved.
+ * @param[in] ulAddress The IPv4 address of the host, or 0 if it could not be
+ * resolved.
+ */
+typedef void ( * SocketsDnsCallback_t )( void * pvContext,
+                                         const char * pcHostName,
+                                         uint32_t ulAddress );
+
+/**
+ * @brief Function that looks up a host name for the resolver.
+ *
+ * @param[in] pcHostName The host name to resolve.
+ * @param[out] pulTtlMs Set to the TTL of the record in milliseconds, or left
+ * at 0 if it is not known.
+ *
+ * @return The IPv4 address of the host, or 0 if it could not be resolved.
+ */
+typedef uint32_t ( * SocketsDnsLookup_t )( const char * pcHostName,
+                                           uint32_t * pulTtlMs );
+
+/**
+ * @brief A query waiting for the resolver.
+ *
+ * The memory is provided by the caller of SOCKETS_DnsResolveAsync() and must
+ * stay valid until the callback has been called. The members are private to
+ * the resolver.
+ */
+typedef struct SocketsDnsQuery
+{
+    SocketsDnsCallback_t xCallback;  /**< @brief Called with the result. */
+    void * pvContext;                /**< @brief Passed to xCallback. */
+    struct SocketsDnsQuery * pxNext; /**< @brief Next query waiting for the same host name. */
+} SocketsDnsQuery_t;
+
+/**
+ * @brief Resolve a host name, using the DNS cache if it is enabled.
+ *
+ * This function blocks until the name is resolved. It can be used in place of
+ * SOCKETS_GetHostByName().
+ *
+ * @param[in] pcHostName The host name to resolve.
+ *
+ * @return
+ * * The IPv4 address of the specified host.
+ * * If an error has occurred, 0 is returned.
+ */
+/* @[declare_secure_sockets_dnsresolve] */
+uint32_t SOCKETS_DnsResolve( const char * pcHostName );
+/* @[declare_secure_sockets_dnsresolve] */
+
+/**
+ * @brief Start resolving a host name and return.
+ *
+ * If the name is in the cache, xCallback is called before this function
+ * returns. Otherwise, it is called from the resolver task once the lookup has
+ * finished. With socketsconfigUSE_DNS_CACHE set to 0, the name is looked up
+ * and xCallback called before this function returns.
+ *
+ * @param[in] pcHostName The host name to resolve. Only needs to be valid until
+ * this function returns.
+ * @param[in] pxQuery Memory for the query, valid until xCallback is called.
+ * @param[in] xCallback Called with the result.
+ * @param[in] pvContext Passed to xCallback.
+ *
+ * @return
+ * * SOCKETS_ERROR_NONE if xCallback has been or will be called.
+ * * SOCKETS_EINVAL if a parameter is NULL or the host name is too long.
+ * * SOCKETS_ENOMEM if every cache entry is being resolved or the resolver
+ * task could not be started. xCallback will not be called.
+ */
+/* @[declare_secure_sockets_dnsresolveasync] */
+int32_t SOCKETS_DnsResolveAsync( const char * pcHostName,
+                                 SocketsDnsQuery_t * pxQuery,
+                                 SocketsDnsCallback_t xCallback,
+                                 void * pvContext );
+/* @[declare_secure_sockets_dnsresolveasync] */
+
+/**
+ * @brief Remove a host name from the DNS cache.
+ *
+ * Callers use this when the cached address of a host no longer accepts
+ * connections, so that the next query looks it up again. Names that are being
+ * resolved are not removed.
+ *
+ * @param[in] pcHostName The host name to remove, or NULL to remove every name.
+ */
+/* @[declare_secure_sockets_dnsflush] */
+void SOCKETS_DnsFlush( const char * pcHostName );
+/* @[declare_secure_sockets_dnsflush] */
+
+/**
+ * @brief Replace the function the resolver looks names up with.
+ *
+ * By default, names are looked up with SOCKETS_GetHostByName(), which does
+ * not report the TTL of the record. Tests use this to put a local stand-in
+ * in place of the network's DNS server.
+ *
+ * @param[in] xLookup The lookup function, or NULL to restore the default.
+ */
+/* @[declare_secure_sockets_dnssetlookupfunction] */
+void SOCKETS_DnsSetLookupFunction( SocketsDnsLookup_t xLookup );
+/* @[declare_secure_sockets_dnssetlookupfunction] */
+
+#endif /* _AWS_SECURE_SOCKETS_DNS_H_ */
@@ -36,6 +36,11 @@
         #define SOCKETS_Init        Sockets_MetricsInit
         #define SOCKETS_Connect     Sockets_MetricsConnect
         #define SOCKETS_Shutdown    Sockets_MetricsShutdown
+
+        #if AWS_IOT_SECURE_SOCKETS_METRICS_COUNTERS_ENABLED == 1
+            #define SOCKETS_Send    Sockets_MetricsSend
+            #define SOCKETS_Recv    Sockets_MetricsRecv
+        #endif
     #endif
 
 #endif
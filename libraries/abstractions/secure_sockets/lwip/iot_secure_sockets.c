@@ -684,6 +684,7 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
     char ** ppcAlpnIn = ( char ** ) pvOptionValue;
     size_t xLength = 0;
     uint32_t ulProtocol;
+    SocketsTlsRecordCounts_t * pxCounts;
 
     if( SOCKETS_INVALID_SOCKET == xSocket )
     {
@@ -915,6 +916,25 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
                     break;
             #endif /* if LWIP_TCP_KEEPALIVE */
 
+        case SOCKETS_SO_TLS_RECORD_COUNTS:
+
+            if( ( NULL == pvOptionValue ) || ( sizeof( SocketsTlsRecordCounts_t * ) != xOptionLength ) )
+            {
+                return SOCKETS_EINVAL;
+            }
+
+            /* Records are only counted once TLS has been negotiated. */
+            if( !( ctx->status & SS_STATUS_SECURED ) )
+            {
+                return SOCKETS_ENOTCONN;
+            }
+
+            pxCounts = *( ( SocketsTlsRecordCounts_t * const * ) pvOptionValue );
+            TLS_GetRecordCounts( ctx->tls_ctx,
+                                 &pxCounts->ulRecordsSent,
+                                 &pxCounts->ulRecordsReceived );
+
+            break;
 
         default:
             return SOCKETS_ENOPROTOOPT;
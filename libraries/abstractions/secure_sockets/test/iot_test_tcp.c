@@ -33,10 +33,12 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
+#include "semphr.h"
 #include "event_groups.h"
 
 /* Secure Sockets includes. */
 #include "iot_secure_sockets.h"
+#include "iot_secure_sockets_dns.h"
 
 /* Test framework includes. */
 #include "unity_fixture.h"
@@ -1112,6 +1114,9 @@ TEST_GROUP_RUNNER( Full_TCP )
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_Recv_Invalid );
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_htons_HappyCase );
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_inet_addr_quick_HappyCase );
+    #if ( socketsconfigUSE_DNS_CACHE == 1 )
+        RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_DnsCache );
+    #endif
 
     #if ( tcptestSECURE_SERVER == 1 )
         RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_CloseInvalidParams );
@@ -3355,6 +3360,117 @@ TEST( Full_TCP, AFQP_SOCKETS_inet_addr_quick_HappyCase )
 }
 /*-----------------------------------------------------------*/
 
+#if ( socketsconfigUSE_DNS_CACHE == 1 )
+
+/* Names answered by the DNS stand-in, the latency of each lookup, and the TTL
+ * it reports for the resolved name. */
+    #define tcptestDNS_RESOLVED_NAME    "resolved.dns.test"
+    #define tcptestDNS_MISSING_NAME     "missing.dns.test"
+    #define tcptestDNS_ADDRESS          SOCKETS_inet_addr_quick( 10, 0, 0, 1 )
+    #define tcptestDNS_LATENCY_MS       ( 100 )
+    #define tcptestDNS_TTL_MS           ( 500 )
+    #define tcptestDNS_QUERIES          ( 4 )
+
+    static volatile uint32_t ulDnsLookups = 0;
+    static uint32_t ulDnsResults[ tcptestDNS_QUERIES ];
+    static SemaphoreHandle_t xDnsResultsDone = NULL;
+
+    static uint32_t prvDnsStandIn( const char * pcHostName,
+                                   uint32_t * pulTtlMs )
+    {
+        uint32_t ulAddress = 0;
+
+        ulDnsLookups++;
+        vTaskDelay( pdMS_TO_TICKS( tcptestDNS_LATENCY_MS ) );
+
+        if( 0 == strcmp( pcHostName, tcptestDNS_RESOLVED_NAME ) )
+        {
+            ulAddress = tcptestDNS_ADDRESS;
+            *pulTtlMs = tcptestDNS_TTL_MS;
+        }
+
+        return ulAddress;
+    }
+
+    static void prvDnsResult( void * pvContext,
+                              const char * pcHostName,
+                              uint32_t ulAddress )
+    {
+        ( void ) pcHostName;
+
+        *( ( uint32_t * ) pvContext ) = ulAddress;
+        ( void ) xSemaphoreGive( xDnsResultsDone );
+    }
+
+/* Resolves names through a local DNS stand-in and checks that concurrent
+ * queries share a lookup, and that results and failures are cached for their
+ * TTL. */
+    TEST( Full_TCP, AFQP_SOCKETS_DnsCache )
+    {
+        SocketsDnsQuery_t xQueries[ tcptestDNS_QUERIES ];
+        int32_t lStatus;
+        uint32_t ulIndex;
+
+        tcptestPRINTF( ( "Starting %s.\r\n", __FUNCTION__ ) );
+
+        xDnsResultsDone = xSemaphoreCreateCounting( tcptestDNS_QUERIES, 0 );
+        TEST_ASSERT_NOT_NULL( xDnsResultsDone );
+
+        ulDnsLookups = 0;
+        SOCKETS_DnsFlush( NULL );
+        SOCKETS_DnsSetLookupFunction( prvDnsStandIn );
+
+        if( TEST_PROTECT() )
+        {
+            /* Queries made while the name is being looked up share the lookup. */
+            for( ulIndex = 0; ulIndex < tcptestDNS_QUERIES; ulIndex++ )
+            {
+                ulDnsResults[ ulIndex ] = 0;
+                lStatus = SOCKETS_DnsResolveAsync( tcptestDNS_RESOLVED_NAME,
+                                                   &xQueries[ ulIndex ],
+                                                   prvDnsResult,
+                                                   &ulDnsResults[ ulIndex ] );
+                TEST_ASSERT_EQUAL_INT32( SOCKETS_ERROR_NONE, lStatus );
+            }
+
+            for( ulIndex = 0; ulIndex < tcptestDNS_QUERIES; ulIndex++ )
+            {
+                TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( xDnsResultsDone, pdMS_TO_TICKS( tcptestDNS_LATENCY_MS * 10 ) ) );
+                TEST_ASSERT_EQUAL_UINT32( tcptestDNS_ADDRESS, ulDnsResults[ ulIndex ] );
+            }
+
+            TEST_ASSERT_EQUAL_UINT32( 1, ulDnsLookups );
+
+            /* The address is cached. */
+            TEST_ASSERT_EQUAL_UINT32( tcptestDNS_ADDRESS, SOCKETS_DnsResolve( tcptestDNS_RESOLVED_NAME ) );
+            TEST_ASSERT_EQUAL_UINT32( 1, ulDnsLookups );
+
+            /* So is a failure. */
+            TEST_ASSERT_EQUAL_UINT32( 0, SOCKETS_DnsResolve( tcptestDNS_MISSING_NAME ) );
+            TEST_ASSERT_EQUAL_UINT32( 0, SOCKETS_DnsResolve( tcptestDNS_MISSING_NAME ) );
+            TEST_ASSERT_EQUAL_UINT32( 2, ulDnsLookups );
+
+            /* The address is looked up again once its TTL has passed. */
+            vTaskDelay( pdMS_TO_TICKS( tcptestDNS_TTL_MS ) );
+            TEST_ASSERT_EQUAL_UINT32( tcptestDNS_ADDRESS, SOCKETS_DnsResolve( tcptestDNS_RESOLVED_NAME ) );
+            TEST_ASSERT_EQUAL_UINT32( 3, ulDnsLookups );
+
+            /* Or once it has been flushed. */
+            SOCKETS_DnsFlush( tcptestDNS_RESOLVED_NAME );
+            TEST_ASSERT_EQUAL_UINT32( tcptestDNS_ADDRESS, SOCKETS_DnsResolve( tcptestDNS_RESOLVED_NAME ) );
+            TEST_ASSERT_EQUAL_UINT32( 4, ulDnsLookups );
+        }
+
+        SOCKETS_DnsSetLookupFunction( NULL );
+        SOCKETS_DnsFlush( NULL );
+        vSemaphoreDelete( xDnsResultsDone );
+        xDnsResultsDone = NULL;
+
+        tcptestPRINTF( ( "%s complete.\r\n", __FUNCTION__ ) );
+    }
+    /*-----------------------------------------------------------*/
+#endif /* if ( socketsconfigUSE_DNS_CACHE == 1 ) */
+
 TEST( Full_TCP, AFQP_SECURE_SOCKETS_SetSecureOptionsAfterConnect )
 {
     BaseType_t xResult = pdFAIL;
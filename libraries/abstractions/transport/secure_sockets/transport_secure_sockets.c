@@ -34,6 +34,57 @@
 /* TCP/IP abstraction includes. */
 #include "transport_secure_sockets.h"
 
+/* Secure sockets DNS cache include. */
+#if ( socketsconfigUSE_DNS_CACHE == 1 )
+    #include "iot_secure_sockets_dns.h"
+#endif
+
+#if ( TRANSPORT_SOCKET_CONNECT_RACE_ENABLED == 1 )
+    /* Kernel include for the race's semaphore. */
+    #include "semphr.h"
+#endif
+
+/*-----------------------------------------------------------*/
+
+#if ( TRANSPORT_SOCKET_CONNECT_RACE_ENABLED == 1 )
+
+    typedef struct ConnectRace ConnectRace_t;
+
+/**
+ * @brief An endpoint connected by a race task.
+ *
+ * The endpoint is copied as the caller's #ServerInfo_t may go away before the
+ * task ends.
+ */
+    typedef struct ConnectAttempt
+    {
+        ConnectRace_t * pRace;                                   /**< @brief The race the attempt belongs to. */
+        Socket_t tcpSocket;                                      /**< @brief Socket set up for the endpoint. */
+        char hostName[ securesocketsMAX_DNS_NAME_LENGTH + 1U ];  /**< @brief Host name of the endpoint. */
+        uint16_t port;                                           /**< @brief Port of the endpoint. */
+    } ConnectAttempt_t;
+
+/**
+ * @brief State shared by #SecureSocketsTransport_Connect and the tasks racing
+ * the endpoints of a server.
+ *
+ * Tasks whose connection is still being set up when the race is decided keep
+ * running until it completes, so the state is freed by whichever of the caller
+ * and the tasks lets go of it last.
+ */
+    struct ConnectRace
+    {
+        SemaphoreHandle_t attemptDone;          /**< @brief Given by each task when its attempt ends. */
+        uint32_t sendTimeoutMs;                 /**< @brief Send timeout of the connections. */
+        uint32_t recvTimeoutMs;                 /**< @brief Receive timeout of the connections. */
+        Socket_t winner;                        /**< @brief First connected socket, or SOCKETS_INVALID_SOCKET. */
+        TransportSocketStatus_t failureStatus;  /**< @brief Status of the last attempt that failed. */
+        bool decided;                           /**< @brief Set once the caller stops waiting. */
+        size_t references;                      /**< @brief The caller and the running tasks. */
+        ConnectAttempt_t attempts[ TRANSPORT_SOCKET_MAX_FALLBACKS + 1U ]; /**< @brief One per endpoint. */
+    };
+
+#endif /* if ( TRANSPORT_SOCKET_CONNECT_RACE_ENABLED == 1 ) */
 
 /*-----------------------------------------------------------*/
 
@@ -94,6 +145,150 @@ static int32_t tlsSetup( const SocketsConfig_t * pSocketsConfig,
 static TransportSocketStatus_t connectToServer( Socket_t tcpSocket,
                                                 const ServerInfo_t * pServerInfo );
 
+/**
+ * @brief Get an endpoint of a server.
+ *
+ * @param[in] pServerInfo Server connection info.
+ * @param[in] index 0 for the server itself, n for its n-th fallback.
+ *
+ * @return The endpoint.
+ */
+static const ServerInfo_t * getEndpoint( const ServerInfo_t * pServerInfo,
+                                         size_t index );
+
+/**
+ * @brief Create a socket for an endpoint and set up TLS on it.
+ *
+ * @param[in] pEndpoint The endpoint to connect to.
+ * @param[in] pSocketsConfig Socket configurations for the connection.
+ * @param[out] pTcpSocket Set to the new socket on success.
+ *
+ * @return #TRANSPORT_SOCKET_STATUS_SUCCESS on success;
+ *         #TRANSPORT_SOCKET_STATUS_INSUFFICIENT_MEMORY, #TRANSPORT_SOCKET_STATUS_INVALID_CREDENTIALS on failure.
+ */
+static TransportSocketStatus_t createSocket( const ServerInfo_t * pEndpoint,
+                                             const SocketsConfig_t * pSocketsConfig,
+                                             Socket_t * pTcpSocket );
+
+/**
+ * @brief Connect a socket created by #createSocket and set its timeouts.
+ *
+ * @param[in] tcpSocket The socket to connect.
+ * @param[in] pEndpoint The endpoint to connect to.
+ * @param[in] sendTimeoutMs Timeout for transport send.
+ * @param[in] recvTimeoutMs Timeout for transport recv.
+ *
+ * @return #TRANSPORT_SOCKET_STATUS_SUCCESS on success;
+ *         #TRANSPORT_SOCKET_STATUS_DNS_FAILURE, #TRANSPORT_SOCKET_STATUS_CONNECT_FAILURE,
+ *         #TRANSPORT_SOCKET_STATUS_INTERNAL_ERROR on failure.
+ */
+static TransportSocketStatus_t connectSocket( Socket_t tcpSocket,
+                                              const ServerInfo_t * pEndpoint,
+                                              uint32_t sendTimeoutMs,
+                                              uint32_t recvTimeoutMs );
+
+/**
+ * @brief Connect to a single endpoint.
+ *
+ * @param[in] pEndpoint The endpoint to connect to.
+ * @param[in] pSocketsConfig Socket configurations for the connection.
+ * @param[out] pTcpSocket Set to the connected socket on success.
+ *
+ * @return The status of #createSocket or #connectSocket.
+ */
+static TransportSocketStatus_t connectEndpoint( const ServerInfo_t * pEndpoint,
+                                                const SocketsConfig_t * pSocketsConfig,
+                                                Socket_t * pTcpSocket );
+
+#if ( TRANSPORT_SOCKET_CONNECT_RACE_ENABLED == 1 )
+
+/**
+ * @brief Race the endpoints of a server and keep the first connection that
+ * completes.
+ *
+ * Endpoints are started in order, each one
+ * #TRANSPORT_SOCKET_CONNECT_RACE_DELAY_MS after the previous one or as soon
+ * as every endpoint started so far has failed. Endpoints not started by the
+ * time a connection completes are not tried.
+ *
+ * @param[in] pServerInfo Server connection info.
+ * @param[in] pSocketsConfig Socket configurations for the connection.
+ * @param[out] pTcpSocket Set to the connected socket on success.
+ *
+ * @return #TRANSPORT_SOCKET_STATUS_SUCCESS on success; the status of the last
+ *         endpoint that failed otherwise.
+ */
+    static TransportSocketStatus_t raceEndpoints( const ServerInfo_t * pServerInfo,
+                                                  const SocketsConfig_t * pSocketsConfig,
+                                                  Socket_t * pTcpSocket );
+
+/**
+ * @brief Set up the socket of an endpoint and start a task to connect it.
+ *
+ * @param[in] pRace The race to add the endpoint to.
+ * @param[in] pAttempt The attempt to use for the endpoint.
+ * @param[in] pEndpoint The endpoint to connect to.
+ * @param[in] pSocketsConfig Socket configurations for the connection.
+ *
+ * @return #TRANSPORT_SOCKET_STATUS_SUCCESS if the task was started;
+ *         #TRANSPORT_SOCKET_STATUS_INSUFFICIENT_MEMORY, #TRANSPORT_SOCKET_STATUS_INVALID_CREDENTIALS on failure.
+ */
+    static TransportSocketStatus_t startAttempt( ConnectRace_t * pRace,
+                                                 ConnectAttempt_t * pAttempt,
+                                                 const ServerInfo_t * pEndpoint,
+                                                 const SocketsConfig_t * pSocketsConfig );
+
+/**
+ * @brief Task that connects the endpoint of an attempt.
+ *
+ * @param[in] pParameters The #ConnectAttempt_t to connect.
+ */
+    static void connectAttemptTask( void * pParameters );
+
+/**
+ * @brief Drop a reference to a race, freeing it if it was the last one.
+ *
+ * @param[in] pRace The race.
+ */
+    static void releaseRace( ConnectRace_t * pRace );
+
+#else /* if ( TRANSPORT_SOCKET_CONNECT_RACE_ENABLED == 1 ) */
+
+/**
+ * @brief Check whether a failure to connect to an endpoint is worth trying
+ * another endpoint for.
+ *
+ * @param[in] status The status of the endpoint.
+ *
+ * @return true for DNS and connection failures, false otherwise.
+ */
+    static bool canTryNextEndpoint( TransportSocketStatus_t status );
+
+/**
+ * @brief Try the endpoints of a server one after another until one connects.
+ *
+ * @param[in] pServerInfo Server connection info.
+ * @param[in] pSocketsConfig Socket configurations for the connection.
+ * @param[out] pTcpSocket Set to the connected socket on success.
+ *
+ * @return #TRANSPORT_SOCKET_STATUS_SUCCESS on success; the status of the last
+ *         endpoint tried otherwise.
+ */
+    static TransportSocketStatus_t tryEndpoints( const ServerInfo_t * pServerInfo,
+                                                 const SocketsConfig_t * pSocketsConfig,
+                                                 Socket_t * pTcpSocket );
+
+#endif /* if ( TRANSPORT_SOCKET_CONNECT_RACE_ENABLED == 1 ) */
+
+/**
+ * @brief Count a Secure Sockets call in a blocking time histogram.
+ *
+ * @param[in] pHistogram The histogram to update.
+ * @param[in] startTime The tick count before the call.
+ */
+static void recordBlockingTime( uint32_t * pHistogram,
+                                TickType_t startTime );
+
 /*-----------------------------------------------------------*/
 
 int32_t SecureSocketsTransport_Send( NetworkContext_t * pNetworkContext,
@@ -101,6 +296,7 @@ int32_t SecureSocketsTransport_Send( NetworkContext_t * pNetworkContext,
                                      size_t bytesToSend )
 {
     int32_t bytesSent = 0;
+    TickType_t startTime = 0;
 
     if( ( pMessage == NULL ) ||
         ( bytesToSend == 0UL ) ||
@@ -117,14 +313,20 @@ int32_t SecureSocketsTransport_Send( NetworkContext_t * pNetworkContext,
     }
     else
     {
+        startTime = xTaskGetTickCount();
         bytesSent = SOCKETS_Send( pNetworkContext->tcpSocket,
                                   pMessage,
                                   bytesToSend,
                                   0 );
 
+        recordBlockingTime( pNetworkContext->statistics.sendBlockingMs, startTime );
+        pNetworkContext->statistics.sendCalls++;
+
         /* If an error occurred, a negative value is returned. @ref SocketsErrors. */
         if( bytesSent >= 0 )
         {
+            pNetworkContext->statistics.bytesSent += ( uint64_t ) bytesSent;
+
             if( bytesSent < ( int32_t ) bytesToSend )
             {
                 LogWarn( ( "bytesSent %d < bytesToSend %lu.", bytesSent, bytesToSend ) );
@@ -136,6 +338,7 @@ int32_t SecureSocketsTransport_Send( NetworkContext_t * pNetworkContext,
         }
         else
         {
+            pNetworkContext->statistics.sendErrors++;
             LogError( ( "Failed to send data over network. bytesSent=%d.", bytesSent ) );
         }
     }
@@ -151,6 +354,7 @@ int32_t SecureSocketsTransport_Recv( NetworkContext_t * pNetworkContext,
 {
     int32_t bytesReceived = SOCKETS_SOCKET_ERROR;
     uint8_t * pRecvBuffer = ( uint8_t * ) pBuffer;
+    TickType_t startTime = 0;
 
     if( ( pBuffer == NULL ) ||
         ( bytesToRecv == 0UL ) ||
@@ -167,11 +371,15 @@ int32_t SecureSocketsTransport_Recv( NetworkContext_t * pNetworkContext,
     }
     else
     {
+        startTime = xTaskGetTickCount();
         bytesReceived = SOCKETS_Recv( pNetworkContext->tcpSocket,
                                       pRecvBuffer,
                                       bytesToRecv,
                                       0 );
 
+        recordBlockingTime( pNetworkContext->statistics.receiveBlockingMs, startTime );
+        pNetworkContext->statistics.receiveCalls++;
+
         if( bytesReceived == SOCKETS_EWOULDBLOCK )
         {
             /* The return value EWOULDBLOCK means no data was received within
@@ -180,10 +388,13 @@ int32_t SecureSocketsTransport_Recv( NetworkContext_t * pNetworkContext,
         }
         else if( bytesReceived < 0 )
         {
+            pNetworkContext->statistics.receiveErrors++;
             LogError( ( "Failed to receive data over network. bytesReceived=%d", bytesReceived ) );
         }
         else
         {
+            pNetworkContext->statistics.bytesReceived += ( uint64_t ) bytesReceived;
+
             if( bytesReceived < ( int32_t ) bytesToRecv )
             {
                 LogInfo( ( "Receive requested %d bytes, but %lu bytes received instead.",
@@ -293,7 +504,12 @@ static TransportSocketStatus_t connectToServer( Socket_t tcpSocket,
     /* Establish connection. */
     serverAddress.ucSocketDomain = SOCKETS_AF_INET;
     serverAddress.usPort = SOCKETS_htons( pServerInfo->port );
-    serverAddress.ulAddress = SOCKETS_GetHostByName( pServerInfo->pHostName );
+
+    #if ( socketsconfigUSE_DNS_CACHE == 1 )
+        serverAddress.ulAddress = SOCKETS_DnsResolve( pServerInfo->pHostName );
+    #else
+        serverAddress.ulAddress = SOCKETS_GetHostByName( pServerInfo->pHostName );
+    #endif
 
     /* Check for errors from DNS lookup. */
     if( serverAddress.ulAddress == ( uint32_t ) 0 )
@@ -312,6 +528,11 @@ static TransportSocketStatus_t connectToServer( Socket_t tcpSocket,
         {
             LogError( ( "Failed to establish new connection. secureSocketStatus=%d.", secureSocketStatus ) );
             returnStatus = TRANSPORT_SOCKET_STATUS_CONNECT_FAILURE;
+
+            #if ( socketsconfigUSE_DNS_CACHE == 1 )
+                /* Look the host up again on the next attempt, its address may have changed. */
+                SOCKETS_DnsFlush( pServerInfo->pHostName );
+            #endif
         }
     }
 
@@ -380,40 +601,30 @@ static int32_t transportTimeoutSetup( Socket_t tcpSocket,
 
 /*-----------------------------------------------------------*/
 
-static TransportSocketStatus_t establishConnect( NetworkContext_t * pNetworkContext,
-                                                 const ServerInfo_t * pServerInfo,
-                                                 const SocketsConfig_t * pSocketsConfig )
+static const ServerInfo_t * getEndpoint( const ServerInfo_t * pServerInfo,
+                                         size_t index )
 {
-    Socket_t tcpSocket = ( Socket_t ) SOCKETS_INVALID_SOCKET;
-    TransportSocketStatus_t returnStatus = TRANSPORT_SOCKET_STATUS_SUCCESS;
-    int32_t secureSocketStatus = ( int32_t ) SOCKETS_ERROR_NONE;
-    size_t hostnameLength = 0U;
+    return ( index == 0U ) ? pServerInfo : &( pServerInfo->pFallbacks[ index - 1U ] );
+}
 
-    configASSERT( pNetworkContext != NULL );
-    configASSERT( pServerInfo != NULL );
-    configASSERT( pSocketsConfig != NULL );
+/*-----------------------------------------------------------*/
 
-    hostnameLength = pServerInfo->hostNameLength;
+static TransportSocketStatus_t createSocket( const ServerInfo_t * pEndpoint,
+                                             const SocketsConfig_t * pSocketsConfig,
+                                             Socket_t * pTcpSocket )
+{
+    Socket_t tcpSocket = ( Socket_t ) SOCKETS_INVALID_SOCKET;
+    TransportSocketStatus_t returnStatus = TRANSPORT_SOCKET_STATUS_SUCCESS;
 
-    if( ( hostnameLength > ( size_t ) securesocketsMAX_DNS_NAME_LENGTH ) )
-    {
-        LogError( ( "Host name length %lu exceeds max length %d",
-                    hostnameLength, securesocketsMAX_DNS_NAME_LENGTH ) );
-        returnStatus = TRANSPORT_SOCKET_STATUS_INVALID_PARAMETER;
-    }
+    /* Create a new TCP socket. */
+    tcpSocket = SOCKETS_Socket( SOCKETS_AF_INET,
+                                SOCKETS_SOCK_STREAM,
+                                SOCKETS_IPPROTO_TCP );
 
-    if( returnStatus == TRANSPORT_SOCKET_STATUS_SUCCESS )
+    if( tcpSocket == SOCKETS_INVALID_SOCKET )
     {
-        /* Create a new TCP socket. */
-        tcpSocket = SOCKETS_Socket( SOCKETS_AF_INET,
-                                    SOCKETS_SOCK_STREAM,
-                                    SOCKETS_IPPROTO_TCP );
-
-        if( tcpSocket == SOCKETS_INVALID_SOCKET )
-        {
-            LogError( ( "Failed to create new socket. tcpSocket=%p\n", ( void * ) tcpSocket ) );
-            returnStatus = TRANSPORT_SOCKET_STATUS_INSUFFICIENT_MEMORY;
-        }
+        LogError( ( "Failed to create new socket. tcpSocket=%p\n", ( void * ) tcpSocket ) );
+        returnStatus = TRANSPORT_SOCKET_STATUS_INSUFFICIENT_MEMORY;
     }
 
     if( returnStatus == TRANSPORT_SOCKET_STATUS_SUCCESS )
@@ -423,25 +634,41 @@ static TransportSocketStatus_t establishConnect( NetworkContext_t * pNetworkCont
         {
             if( ( int32_t ) SOCKETS_ERROR_NONE != tlsSetup( pSocketsConfig,
                                                             tcpSocket,
-                                                            pServerInfo->pHostName,
-                                                            hostnameLength ) )
+                                                            pEndpoint->pHostName,
+                                                            pEndpoint->hostNameLength ) )
             {
                 returnStatus = TRANSPORT_SOCKET_STATUS_INVALID_CREDENTIALS;
+                ( void ) SOCKETS_Close( tcpSocket );
             }
         }
     }
 
     if( returnStatus == TRANSPORT_SOCKET_STATUS_SUCCESS )
     {
-        /* Establish the TCP connection. */
-        returnStatus = connectToServer( tcpSocket,
-                                        pServerInfo );
+        *pTcpSocket = tcpSocket;
     }
 
+    return returnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static TransportSocketStatus_t connectSocket( Socket_t tcpSocket,
+                                              const ServerInfo_t * pEndpoint,
+                                              uint32_t sendTimeoutMs,
+                                              uint32_t recvTimeoutMs )
+{
+    TransportSocketStatus_t returnStatus = TRANSPORT_SOCKET_STATUS_SUCCESS;
+    int32_t secureSocketStatus = ( int32_t ) SOCKETS_ERROR_NONE;
+
+    /* Establish the TCP connection. */
+    returnStatus = connectToServer( tcpSocket,
+                                    pEndpoint );
+
     if( returnStatus == TRANSPORT_SOCKET_STATUS_SUCCESS )
     {
         /* Configure send and receive timeouts for the socket. */
-        secureSocketStatus = transportTimeoutSetup( tcpSocket, pSocketsConfig->sendTimeoutMs, pSocketsConfig->recvTimeoutMs );
+        secureSocketStatus = transportTimeoutSetup( tcpSocket, sendTimeoutMs, recvTimeoutMs );
 
         if( secureSocketStatus != ( int32_t ) SOCKETS_ERROR_NONE )
         {
@@ -450,18 +677,354 @@ static TransportSocketStatus_t establishConnect( NetworkContext_t * pNetworkCont
         }
     }
 
+    return returnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static TransportSocketStatus_t connectEndpoint( const ServerInfo_t * pEndpoint,
+                                                const SocketsConfig_t * pSocketsConfig,
+                                                Socket_t * pTcpSocket )
+{
+    Socket_t tcpSocket = ( Socket_t ) SOCKETS_INVALID_SOCKET;
+    TransportSocketStatus_t returnStatus = TRANSPORT_SOCKET_STATUS_SUCCESS;
+
+    returnStatus = createSocket( pEndpoint, pSocketsConfig, &tcpSocket );
+
     if( returnStatus == TRANSPORT_SOCKET_STATUS_SUCCESS )
     {
-        /* Set the socket in the network context. */
-        pNetworkContext->tcpSocket = tcpSocket;
+        returnStatus = connectSocket( tcpSocket,
+                                      pEndpoint,
+                                      pSocketsConfig->sendTimeoutMs,
+                                      pSocketsConfig->recvTimeoutMs );
+
+        if( returnStatus == TRANSPORT_SOCKET_STATUS_SUCCESS )
+        {
+            *pTcpSocket = tcpSocket;
+        }
+        else
+        {
+            /* Clean up socket on failure. */
+            ( void ) SOCKETS_Close( tcpSocket );
+        }
     }
-    else
+
+    return returnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( TRANSPORT_SOCKET_CONNECT_RACE_ENABLED == 1 )
+
+    static TransportSocketStatus_t raceEndpoints( const ServerInfo_t * pServerInfo,
+                                                  const SocketsConfig_t * pSocketsConfig,
+                                                  Socket_t * pTcpSocket )
     {
-        /* Clean up socket on failure. */
-        if( tcpSocket != ( Socket_t ) SOCKETS_INVALID_SOCKET )
+        TransportSocketStatus_t returnStatus = TRANSPORT_SOCKET_STATUS_SUCCESS;
+        ConnectRace_t * pRace = NULL;
+        size_t endpointCount = pServerInfo->fallbackCount + 1U;
+        size_t next = 0U, started = 0U, ended = 0U;
+        TickType_t waitTicks = portMAX_DELAY;
+        bool decided = false;
+
+        if( pServerInfo->fallbackCount == 0U )
         {
-            ( void ) SOCKETS_Close( tcpSocket );
+            /* There is nothing to race. */
+            returnStatus = connectEndpoint( pServerInfo, pSocketsConfig, pTcpSocket );
         }
+        else
+        {
+            pRace = pvPortMalloc( sizeof( ConnectRace_t ) );
+
+            if( pRace != NULL )
+            {
+                ( void ) memset( pRace, 0x00, sizeof( ConnectRace_t ) );
+                pRace->attemptDone = xSemaphoreCreateCounting( ( UBaseType_t ) endpointCount, 0U );
+
+                if( pRace->attemptDone == NULL )
+                {
+                    vPortFree( pRace );
+                    pRace = NULL;
+                }
+            }
+
+            if( pRace == NULL )
+            {
+                LogError( ( "Failed to allocate the state of the connection race." ) );
+                returnStatus = TRANSPORT_SOCKET_STATUS_INSUFFICIENT_MEMORY;
+            }
+        }
+
+        if( pRace != NULL )
+        {
+            pRace->sendTimeoutMs = pSocketsConfig->sendTimeoutMs;
+            pRace->recvTimeoutMs = pSocketsConfig->recvTimeoutMs;
+            pRace->winner = ( Socket_t ) SOCKETS_INVALID_SOCKET;
+            pRace->failureStatus = TRANSPORT_SOCKET_STATUS_CONNECT_FAILURE;
+            pRace->references = 1U;
+
+            while( decided == false )
+            {
+                waitTicks = portMAX_DELAY;
+
+                if( next < endpointCount )
+                {
+                    returnStatus = startAttempt( pRace,
+                                                 &( pRace->attempts[ next ] ),
+                                                 getEndpoint( pServerInfo, next ),
+                                                 pSocketsConfig );
+                    next++;
+
+                    if( returnStatus == TRANSPORT_SOCKET_STATUS_SUCCESS )
+                    {
+                        started++;
+
+                        if( next < endpointCount )
+                        {
+                            waitTicks = pdMS_TO_TICKS( TRANSPORT_SOCKET_CONNECT_RACE_DELAY_MS );
+                        }
+                    }
+                    else
+                    {
+                        /* The other endpoints would fail the same way. */
+                        taskENTER_CRITICAL();
+                        pRace->failureStatus = returnStatus;
+                        taskEXIT_CRITICAL();
+
+                        next = endpointCount;
+                    }
+                }
+
+                if( started == ended )
+                {
+                    /* Every endpoint started so far has failed. */
+                    decided = ( next == endpointCount );
+                }
+                else if( xSemaphoreTake( pRace->attemptDone, waitTicks ) == pdTRUE )
+                {
+                    ended++;
+
+                    taskENTER_CRITICAL();
+                    decided = ( pRace->winner != ( Socket_t ) SOCKETS_INVALID_SOCKET );
+                    taskEXIT_CRITICAL();
+                }
+                else
+                {
+                    /* The last endpoint started is slow, start the next one. */
+                }
+            }
+
+            /* Connections that complete from now on are closed by their task. */
+            taskENTER_CRITICAL();
+            pRace->decided = true;
+            *pTcpSocket = pRace->winner;
+            returnStatus = pRace->failureStatus;
+            taskEXIT_CRITICAL();
+
+            if( *pTcpSocket != ( Socket_t ) SOCKETS_INVALID_SOCKET )
+            {
+                returnStatus = TRANSPORT_SOCKET_STATUS_SUCCESS;
+            }
+
+            releaseRace( pRace );
+        }
+
+        return returnStatus;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static TransportSocketStatus_t startAttempt( ConnectRace_t * pRace,
+                                                 ConnectAttempt_t * pAttempt,
+                                                 const ServerInfo_t * pEndpoint,
+                                                 const SocketsConfig_t * pSocketsConfig )
+    {
+        TransportSocketStatus_t returnStatus = TRANSPORT_SOCKET_STATUS_SUCCESS;
+
+        /* The socket is set up here, as the TLS configuration is only valid
+         * during #SecureSocketsTransport_Connect. */
+        returnStatus = createSocket( pEndpoint, pSocketsConfig, &( pAttempt->tcpSocket ) );
+
+        if( returnStatus == TRANSPORT_SOCKET_STATUS_SUCCESS )
+        {
+            pAttempt->pRace = pRace;
+            ( void ) memcpy( pAttempt->hostName, pEndpoint->pHostName, pEndpoint->hostNameLength );
+            pAttempt->hostName[ pEndpoint->hostNameLength ] = '\0';
+            pAttempt->port = pEndpoint->port;
+
+            taskENTER_CRITICAL();
+            pRace->references++;
+            taskEXIT_CRITICAL();
+
+            if( xTaskCreate( connectAttemptTask,
+                             "ConnectRace",
+                             TRANSPORT_SOCKET_CONNECT_RACE_TASK_STACK_SIZE,
+                             pAttempt,
+                             TRANSPORT_SOCKET_CONNECT_RACE_TASK_PRIORITY,
+                             NULL ) != pdPASS )
+            {
+                LogError( ( "Failed to create the task to connect to %s.", pAttempt->hostName ) );
+                releaseRace( pRace );
+                ( void ) SOCKETS_Close( pAttempt->tcpSocket );
+                returnStatus = TRANSPORT_SOCKET_STATUS_INSUFFICIENT_MEMORY;
+            }
+        }
+
+        return returnStatus;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void connectAttemptTask( void * pParameters )
+    {
+        ConnectAttempt_t * pAttempt = ( ConnectAttempt_t * ) pParameters;
+        ConnectRace_t * pRace = pAttempt->pRace;
+        ServerInfo_t endpoint = { 0 };
+        TransportSocketStatus_t returnStatus = TRANSPORT_SOCKET_STATUS_SUCCESS;
+        bool keepSocket = false;
+
+        endpoint.pHostName = pAttempt->hostName;
+        endpoint.hostNameLength = strlen( pAttempt->hostName );
+        endpoint.port = pAttempt->port;
+
+        returnStatus = connectSocket( pAttempt->tcpSocket,
+                                      &endpoint,
+                                      pRace->sendTimeoutMs,
+                                      pRace->recvTimeoutMs );
+
+        taskENTER_CRITICAL();
+
+        if( returnStatus != TRANSPORT_SOCKET_STATUS_SUCCESS )
+        {
+            pRace->failureStatus = returnStatus;
+        }
+        else if( ( pRace->decided == false ) && ( pRace->winner == ( Socket_t ) SOCKETS_INVALID_SOCKET ) )
+        {
+            pRace->winner = pAttempt->tcpSocket;
+            keepSocket = true;
+        }
+        else
+        {
+            /* Another endpoint won the race. */
+        }
+
+        taskEXIT_CRITICAL();
+
+        if( keepSocket == false )
+        {
+            ( void ) SOCKETS_Close( pAttempt->tcpSocket );
+        }
+
+        ( void ) xSemaphoreGive( pRace->attemptDone );
+        releaseRace( pRace );
+
+        vTaskDelete( NULL );
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void releaseRace( ConnectRace_t * pRace )
+    {
+        bool lastReference = false;
+
+        taskENTER_CRITICAL();
+        pRace->references--;
+        lastReference = ( pRace->references == 0U );
+        taskEXIT_CRITICAL();
+
+        if( lastReference == true )
+        {
+            vSemaphoreDelete( pRace->attemptDone );
+            vPortFree( pRace );
+        }
+    }
+
+#else /* if ( TRANSPORT_SOCKET_CONNECT_RACE_ENABLED == 1 ) */
+
+    static bool canTryNextEndpoint( TransportSocketStatus_t status )
+    {
+        return ( status == TRANSPORT_SOCKET_STATUS_DNS_FAILURE ) ||
+               ( status == TRANSPORT_SOCKET_STATUS_CONNECT_FAILURE );
+    }
+
+/*-----------------------------------------------------------*/
+
+    static TransportSocketStatus_t tryEndpoints( const ServerInfo_t * pServerInfo,
+                                                 const SocketsConfig_t * pSocketsConfig,
+                                                 Socket_t * pTcpSocket )
+    {
+        TransportSocketStatus_t returnStatus = TRANSPORT_SOCKET_STATUS_CONNECT_FAILURE;
+        size_t index = 0U;
+
+        for( index = 0U; ( index <= pServerInfo->fallbackCount ) && canTryNextEndpoint( returnStatus ); index++ )
+        {
+            if( index > 0U )
+            {
+                LogWarn( ( "Failed to connect to %s, trying endpoint %lu.",
+                           getEndpoint( pServerInfo, index - 1U )->pHostName,
+                           ( unsigned long ) index ) );
+            }
+
+            returnStatus = connectEndpoint( getEndpoint( pServerInfo, index ),
+                                            pSocketsConfig,
+                                            pTcpSocket );
+        }
+
+        return returnStatus;
+    }
+
+#endif /* if ( TRANSPORT_SOCKET_CONNECT_RACE_ENABLED == 1 ) */
+
+/*-----------------------------------------------------------*/
+
+static TransportSocketStatus_t establishConnect( NetworkContext_t * pNetworkContext,
+                                                 const ServerInfo_t * pServerInfo,
+                                                 const SocketsConfig_t * pSocketsConfig )
+{
+    Socket_t tcpSocket = ( Socket_t ) SOCKETS_INVALID_SOCKET;
+    TransportSocketStatus_t returnStatus = TRANSPORT_SOCKET_STATUS_SUCCESS;
+    const ServerInfo_t * pEndpoint = NULL;
+    size_t index = 0U;
+
+    configASSERT( pNetworkContext != NULL );
+    configASSERT( pServerInfo != NULL );
+    configASSERT( pSocketsConfig != NULL );
+
+    for( index = 0U; ( index <= pServerInfo->fallbackCount ) && ( returnStatus == TRANSPORT_SOCKET_STATUS_SUCCESS ); index++ )
+    {
+        pEndpoint = getEndpoint( pServerInfo, index );
+
+        if( ( pEndpoint->pHostName == NULL ) || ( pEndpoint->hostNameLength == 0UL ) )
+        {
+            LogError( ( "Parameter check failed: endpoint %lu has no host name.", ( unsigned long ) index ) );
+            returnStatus = TRANSPORT_SOCKET_STATUS_INVALID_PARAMETER;
+        }
+        else if( pEndpoint->hostNameLength > ( size_t ) securesocketsMAX_DNS_NAME_LENGTH )
+        {
+            LogError( ( "Host name length %lu exceeds max length %d",
+                        pEndpoint->hostNameLength, securesocketsMAX_DNS_NAME_LENGTH ) );
+            returnStatus = TRANSPORT_SOCKET_STATUS_INVALID_PARAMETER;
+        }
+        else
+        {
+            /* The endpoint is valid. */
+        }
+    }
+
+    if( returnStatus == TRANSPORT_SOCKET_STATUS_SUCCESS )
+    {
+        #if ( TRANSPORT_SOCKET_CONNECT_RACE_ENABLED == 1 )
+            returnStatus = raceEndpoints( pServerInfo, pSocketsConfig, &tcpSocket );
+        #else
+            returnStatus = tryEndpoints( pServerInfo, pSocketsConfig, &tcpSocket );
+        #endif
+    }
+
+    if( returnStatus == TRANSPORT_SOCKET_STATUS_SUCCESS )
+    {
+        /* Set the socket in the network context and start its statistics. */
+        pNetworkContext->tcpSocket = tcpSocket;
+        ( void ) memset( &( pNetworkContext->statistics ), 0x00, sizeof( IotNetworkStatistics_t ) );
     }
 
     return returnStatus;
@@ -501,6 +1064,18 @@ TransportSocketStatus_t SecureSocketsTransport_Connect( NetworkContext_t * pNetw
         LogError( ( "Parameter check failed: hostNameLength must be greater than 0." ) );
         returnStatus = TRANSPORT_SOCKET_STATUS_INVALID_PARAMETER;
     }
+    else if( ( pServerInfo->fallbackCount > 0UL ) && ( pServerInfo->pFallbacks == NULL ) )
+    {
+        LogError( ( "Parameter check failed: pServerInfo->pFallbacks is NULL." ) );
+        returnStatus = TRANSPORT_SOCKET_STATUS_INVALID_PARAMETER;
+    }
+    else if( pServerInfo->fallbackCount > ( size_t ) TRANSPORT_SOCKET_MAX_FALLBACKS )
+    {
+        LogError( ( "Parameter check failed: fallbackCount %lu exceeds max %lu.",
+                    ( unsigned long ) pServerInfo->fallbackCount,
+                    ( unsigned long ) TRANSPORT_SOCKET_MAX_FALLBACKS ) );
+        returnStatus = TRANSPORT_SOCKET_STATUS_INVALID_PARAMETER;
+    }
     else
     {
         /* Establish the TCP connection. */
@@ -554,3 +1129,57 @@ TransportSocketStatus_t SecureSocketsTransport_Disconnect( const NetworkContext_
 }
 
 /*-----------------------------------------------------------*/
+
+TransportSocketStatus_t SecureSocketsTransport_GetStatistics( const NetworkContext_t * pNetworkContext,
+                                                              IotNetworkStatistics_t * pStatistics )
+{
+    TransportSocketStatus_t returnStatus = TRANSPORT_SOCKET_STATUS_INVALID_PARAMETER;
+    SocketsTlsRecordCounts_t tlsRecordCounts = { 0 };
+    SocketsTlsRecordCounts_t * pTlsRecordCounts = &tlsRecordCounts;
+
+    if( ( pNetworkContext == NULL ) || ( pStatistics == NULL ) )
+    {
+        LogError( ( "Invalid parameter: pNetworkContext=%p, pStatistics=%p",
+                    ( const void * ) pNetworkContext, ( void * ) pStatistics ) );
+    }
+    else
+    {
+        *pStatistics = pNetworkContext->statistics;
+
+        /* The TLS record counts stay 0 for connections without TLS and for
+         * Secure Sockets ports that do not count records. */
+        if( SOCKETS_SetSockOpt( pNetworkContext->tcpSocket,
+                                0,
+                                SOCKETS_SO_TLS_RECORD_COUNTS,
+                                &pTlsRecordCounts,
+                                sizeof( pTlsRecordCounts ) ) == ( int32_t ) SOCKETS_ERROR_NONE )
+        {
+            pStatistics->tlsRecordsSent = tlsRecordCounts.ulRecordsSent;
+            pStatistics->tlsRecordsReceived = tlsRecordCounts.ulRecordsReceived;
+        }
+
+        returnStatus = TRANSPORT_SOCKET_STATUS_SUCCESS;
+    }
+
+    return returnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static void recordBlockingTime( uint32_t * pHistogram,
+                                TickType_t startTime )
+{
+    uint32_t blockingMs = ( uint32_t ) ( ( xTaskGetTickCount() - startTime ) * portTICK_PERIOD_MS );
+    size_t bucket = 0U;
+
+    /* Bucket n holds times in [2^(n-1), 2^n) ms, the last bucket everything longer. */
+    while( ( blockingMs > 0U ) && ( bucket < ( ( size_t ) IOT_NETWORK_STATISTICS_HISTOGRAM_BUCKETS - 1U ) ) )
+    {
+        blockingMs >>= 1;
+        bucket++;
+    }
+
+    pHistogram[ bucket ]++;
+}
+
+/*-----------------------------------------------------------*/
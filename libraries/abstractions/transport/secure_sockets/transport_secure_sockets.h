@@ -44,6 +44,9 @@
 #include "transport_interface.h"
 #include "iot_secure_sockets.h"
 
+/* Network statistics include. */
+#include "platform/iot_network.h"
+
 /* Kernel include. */
 #include "FreeRTOS.h"
 #include "task.h"
@@ -63,6 +66,49 @@
 /* Logging implementation header include. */
 #include "logging_stack.h"
 
+/**
+ * @brief Most fallback endpoints a #ServerInfo_t may list.
+ */
+#ifndef TRANSPORT_SOCKET_MAX_FALLBACKS
+    #define TRANSPORT_SOCKET_MAX_FALLBACKS    ( 3U )
+#endif
+
+/**
+ * @brief By default, #SecureSocketsTransport_Connect tries the fallback
+ * endpoints of a server one after another.
+ *
+ * When set to 1, the endpoints are raced instead. Each one is connected from
+ * its own task, started #TRANSPORT_SOCKET_CONNECT_RACE_DELAY_MS after the
+ * previous one or as soon as the previous one fails, and the first connection
+ * that completes is kept.
+ */
+#ifndef TRANSPORT_SOCKET_CONNECT_RACE_ENABLED
+    #define TRANSPORT_SOCKET_CONNECT_RACE_ENABLED    ( 0 )
+#endif
+
+/**
+ * @brief Head start, in milliseconds, each raced endpoint gets over the next.
+ */
+#ifndef TRANSPORT_SOCKET_CONNECT_RACE_DELAY_MS
+    #define TRANSPORT_SOCKET_CONNECT_RACE_DELAY_MS    ( 250U )
+#endif
+
+/**
+ * @brief Stack size of the tasks that connect raced endpoints.
+ *
+ * The TCP connection and the TLS handshake run on this stack.
+ */
+#ifndef TRANSPORT_SOCKET_CONNECT_RACE_TASK_STACK_SIZE
+    #define TRANSPORT_SOCKET_CONNECT_RACE_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 8 )
+#endif
+
+/**
+ * @brief Priority of the tasks that connect raced endpoints.
+ */
+#ifndef TRANSPORT_SOCKET_CONNECT_RACE_TASK_PRIORITY
+    #define TRANSPORT_SOCKET_CONNECT_RACE_TASK_PRIORITY    ( tskIDLE_PRIORITY + 5 )
+#endif
+
 /**
  * @brief Definition of the network context for the transport interface
  * implementation that uses Secure Sockets API.
@@ -70,6 +116,7 @@
 struct NetworkContext
 {
     Socket_t tcpSocket;
+    IotNetworkStatistics_t statistics; /**< @brief I/O statistics, without the TLS record counts. */
 };
 
 /**
@@ -95,6 +142,20 @@ typedef struct ServerInfo
     const char * pHostName; /**< @brief Server host name. Must be NULL-terminated. */
     size_t hostNameLength;  /**< @brief Length of the server host name. */
     uint16_t port;          /**< @brief Server port in host-order. */
+
+    /**
+     * @brief Other endpoints of the same server, such as another host name or
+     * port, to connect to if this one cannot be reached.
+     *
+     * The fallbacks of the endpoints in this array are ignored.
+     */
+    const struct ServerInfo * pFallbacks;
+
+    /**
+     * @brief Number of endpoints in #ServerInfo_t.pFallbacks, at most
+     * #TRANSPORT_SOCKET_MAX_FALLBACKS.
+     */
+    size_t fallbackCount;
 } ServerInfo_t;
 
 
@@ -146,6 +207,12 @@ typedef struct SocketsConfig
 /**
  * @brief Sets up a TCP only connection or a TLS session on top of a TCP connection with Secure Sockets API.
  *
+ * If the server has fallback endpoints, they are tried when the connection to
+ * the first endpoint fails, or raced against it when
+ * #TRANSPORT_SOCKET_CONNECT_RACE_ENABLED is 1. Either way, the connection to
+ * the first endpoint that completes is kept. On failure, the status of the
+ * last endpoint tried is returned.
+ *
  * @param[out] pNetworkContext The output parameter to return the created network context.
  * @param[in] pServerInfo Server connection info.
  * @param[in] pSocketsConfig socket configs for the connection.
@@ -205,4 +272,20 @@ int32_t SecureSocketsTransport_Send( NetworkContext_t * pNetworkContext,
                                      const void * pMessage,
                                      size_t bytesToSend );
 
+/**
+ * @brief Gets the I/O statistics of a connection made with the Secure Sockets API.
+ *
+ * The statistics count the calls to #SecureSocketsTransport_Send and
+ * #SecureSocketsTransport_Recv since #SecureSocketsTransport_Connect. The TLS
+ * record counts are read from the socket.
+ *
+ * @param[in] pNetworkContext The network context created using Secure Sockets API.
+ * @param[out] pStatistics Set to a copy of the connection's statistics.
+ *
+ * @return #TRANSPORT_SOCKET_STATUS_SUCCESS on success;
+ *         #TRANSPORT_SOCKET_STATUS_INVALID_PARAMETER on failure.
+ */
+TransportSocketStatus_t SecureSocketsTransport_GetStatistics( const NetworkContext_t * pNetworkContext,
+                                                              IotNetworkStatistics_t * pStatistics );
+
 #endif /* TRANSPORT_SECURE_SOCKETS_H */
@@ -34,5 +34,7 @@ afr_module_include_dirs(
     PUBLIC
        "${transport_interface_dir}"
        "${src_dir}"
+       # For the IotNetworkStatistics_t definition in platform/iot_network.h.
+       "${AFR_MODULES_ABSTRACTIONS_DIR}/platform/include"
 )
 
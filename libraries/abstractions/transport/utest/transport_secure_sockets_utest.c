@@ -41,6 +41,10 @@
 #define INVALID_HOSTNAME_LENGTH     ( 254U )
 #define PORT                        ( 80 )
 
+/* The fallback endpoint of the server. */
+#define FALLBACK_HOSTNAME           "fallback.amazon.com"
+#define FALLBACK_PORT               ( 443 )
+
 /* Configuration parameters for the TLS connection. */
 #define MFLN                        ( 42 )
 #define ALPN_PROTOS                 "x-amzn-mqtt-ca"
@@ -48,6 +52,7 @@
 #define MOCK_ROOT_CA                "mockRootCA"
 #define MOCK_SERVER_ADDRESS         ( 100 )
 #define MOCT_TCP_SOCKET             ( 100 )
+#define MOCK_FALLBACK_TCP_SOCKET    ( 101 )
 #define MOCK_SECURE_SOCKET_ERROR    ( -1 )
 
 
@@ -90,14 +95,72 @@ static SocketsConfig_t socketsConfig =
 
 static uint8_t networkBuffer[ BUFFER_LEN ] = { 0 };
 static Socket_t mockTcpSocket = ( Socket_t ) MOCT_TCP_SOCKET;
+static Socket_t mockFallbackTcpSocket = ( Socket_t ) MOCK_FALLBACK_TCP_SOCKET;
 static NetworkContext_t networkContext = { 0 };
 
+/* The tick count returned by the xTaskGetTickCount stub. */
+static TickType_t tickCount = 0;
+
+/* TLS record counts returned by the SOCKETS_SO_TLS_RECORD_COUNTS stub. */
+#define TLS_RECORDS_SENT        ( 3U )
+#define TLS_RECORDS_RECEIVED    ( 5U )
+
+/* ========================================================================== */
+
+/* Stub for the kernel function used to time Secure Sockets calls. */
+TickType_t xTaskGetTickCount( void )
+{
+    return tickCount;
+}
+
+/* Stub for SOCKETS_SetSockOpt that answers SOCKETS_SO_TLS_RECORD_COUNTS. */
+static int32_t SetSockOpt_TlsRecordCounts( Socket_t xSocket,
+                                           int32_t lLevel,
+                                           int32_t lOptionName,
+                                           const void * pvOptionValue,
+                                           size_t xOptionLength,
+                                           int numCalls )
+{
+    SocketsTlsRecordCounts_t * pCounts = *( ( SocketsTlsRecordCounts_t * const * ) pvOptionValue );
+
+    ( void ) xSocket;
+    ( void ) lLevel;
+    ( void ) numCalls;
+
+    TEST_ASSERT_EQUAL( SOCKETS_SO_TLS_RECORD_COUNTS, lOptionName );
+    TEST_ASSERT_EQUAL( sizeof( SocketsTlsRecordCounts_t * ), xOptionLength );
+
+    pCounts->ulRecordsSent = TLS_RECORDS_SENT;
+    pCounts->ulRecordsReceived = TLS_RECORDS_RECEIVED;
+
+    return SOCKETS_ERROR_NONE;
+}
+
+/* Stub for SOCKETS_Send that blocks for 3 ms, then sends everything. */
+static int32_t Send_Blocks3Ms( Socket_t xSocket,
+                               const void * pvBuffer,
+                               size_t xDataLength,
+                               uint32_t ulFlags,
+                               int numCalls )
+{
+    ( void ) xSocket;
+    ( void ) pvBuffer;
+    ( void ) ulFlags;
+    ( void ) numCalls;
+
+    tickCount += pdMS_TO_TICKS( 3U );
+
+    return ( int32_t ) xDataLength;
+}
+
 /* ============================   UNITY FIXTURES ============================ */
 
 /* Called before each test method. */
 void setUp()
 {
     networkContext.tcpSocket = mockTcpSocket;
+    memset( &networkContext.statistics, 0x00, sizeof( networkContext.statistics ) );
+    tickCount = 0;
 }
 
 /* Called after each test method. */
@@ -807,6 +870,151 @@ void test_SecureSocketsTransport_Connect_Credentials_NotSet( void )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Test that #SecureSocketsTransport_Connect fails with invalid fallback
+ * endpoints and verify the error code.
+ */
+void test_SecureSocketsTransport_Connect_Invalid_Fallbacks( void )
+{
+    TransportSocketStatus_t returnStatus;
+    ServerInfo_t fallbacks[ TRANSPORT_SOCKET_MAX_FALLBACKS + 1U ] = { 0 };
+    ServerInfo_t localServerInfo = serverInfo;
+
+    localServerInfo.pFallbacks = NULL;
+    localServerInfo.fallbackCount = 1U;
+
+    returnStatus = SecureSocketsTransport_Connect( &networkContext,
+                                                   &localServerInfo,
+                                                   &socketsConfig );
+    TEST_ASSERT_EQUAL( TRANSPORT_SOCKET_STATUS_INVALID_PARAMETER, returnStatus );
+
+    localServerInfo.pFallbacks = fallbacks;
+    localServerInfo.fallbackCount = TRANSPORT_SOCKET_MAX_FALLBACKS + 1U;
+
+    returnStatus = SecureSocketsTransport_Connect( &networkContext,
+                                                   &localServerInfo,
+                                                   &socketsConfig );
+    TEST_ASSERT_EQUAL( TRANSPORT_SOCKET_STATUS_INVALID_PARAMETER, returnStatus );
+
+    /* The fallback has no host name. */
+    localServerInfo.fallbackCount = 1U;
+
+    returnStatus = SecureSocketsTransport_Connect( &networkContext,
+                                                   &localServerInfo,
+                                                   &socketsConfig );
+    TEST_ASSERT_EQUAL( TRANSPORT_SOCKET_STATUS_INVALID_PARAMETER, returnStatus );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that #SecureSocketsTransport_Connect connects to the fallback
+ * endpoint when the server cannot be reached.
+ */
+void test_SecureSocketsTransport_Connect_Succeeds_with_Fallback( void )
+{
+    TransportSocketStatus_t returnStatus;
+    ServerInfo_t fallback =
+    {
+        .pHostName      = FALLBACK_HOSTNAME,
+        .hostNameLength = strlen( FALLBACK_HOSTNAME ),
+        .port           = FALLBACK_PORT
+    };
+    ServerInfo_t localServerInfo = serverInfo;
+    SocketsConfig_t localSocketsConfig =
+    {
+        .enableTls         = false,
+        .pAlpnProtos       = NULL,
+        .maxFragmentLength = MFLN,
+        .disableSni        = true,
+        .pRootCa           = NULL,
+        .rootCaSize        = 0,
+        .sendTimeoutMs     = TEST_TRANSPORT_SND_TIMEOUT_MS,
+        .recvTimeoutMs     = TEST_TRANSPORT_RCV_TIMEOUT_MS
+    };
+
+    localServerInfo.pFallbacks = &fallback;
+    localServerInfo.fallbackCount = 1U;
+
+    SOCKETS_Socket_ExpectAndReturn( SOCKETS_AF_INET,
+                                    SOCKETS_SOCK_STREAM,
+                                    SOCKETS_IPPROTO_TCP,
+                                    mockTcpSocket );
+    SOCKETS_GetHostByName_ExpectAndReturn( HOSTNAME,
+                                           MOCK_SERVER_ADDRESS );
+    SOCKETS_Connect_ExpectAndReturn( mockTcpSocket,
+                                     NULL,
+                                     sizeof( SocketsSockaddr_t ),
+                                     MOCK_SECURE_SOCKET_ERROR );
+    SOCKETS_Connect_IgnoreArg_pxAddress();
+    SOCKETS_Close_ExpectAndReturn( mockTcpSocket,
+                                   SOCKETS_ERROR_NONE );
+    SOCKETS_Socket_ExpectAndReturn( SOCKETS_AF_INET,
+                                    SOCKETS_SOCK_STREAM,
+                                    SOCKETS_IPPROTO_TCP,
+                                    mockFallbackTcpSocket );
+    SOCKETS_GetHostByName_ExpectAndReturn( FALLBACK_HOSTNAME,
+                                           MOCK_SERVER_ADDRESS );
+    SOCKETS_Connect_ExpectAndReturn( mockFallbackTcpSocket,
+                                     NULL,
+                                     sizeof( SocketsSockaddr_t ),
+                                     SOCKETS_ERROR_NONE );
+    SOCKETS_Connect_IgnoreArg_pxAddress();
+    SOCKETS_SetSockOpt_ExpectAndReturn( mockFallbackTcpSocket,
+                                        0,
+                                        SOCKETS_SO_RCVTIMEO,
+                                        NULL,
+                                        0,
+                                        SOCKETS_ERROR_NONE );
+    SOCKETS_SetSockOpt_IgnoreArg_pvOptionValue();
+    SOCKETS_SetSockOpt_IgnoreArg_xOptionLength();
+    SOCKETS_SetSockOpt_ExpectAndReturn( mockFallbackTcpSocket,
+                                        0,
+                                        SOCKETS_SO_SNDTIMEO,
+                                        NULL,
+                                        0,
+                                        SOCKETS_ERROR_NONE );
+    SOCKETS_SetSockOpt_IgnoreArg_pvOptionValue();
+    SOCKETS_SetSockOpt_IgnoreArg_xOptionLength();
+    returnStatus = SecureSocketsTransport_Connect( &networkContext,
+                                                   &localServerInfo,
+                                                   &localSocketsConfig );
+    TEST_ASSERT_EQUAL( TRANSPORT_SOCKET_STATUS_SUCCESS, returnStatus );
+    TEST_ASSERT_EQUAL_PTR( mockFallbackTcpSocket, networkContext.tcpSocket );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that #SecureSocketsTransport_Connect does not try the fallback
+ * endpoint when the failure is not specific to the server.
+ */
+void test_SecureSocketsTransport_Connect_Fallback_Not_Tried_Insufficient_Memory( void )
+{
+    TransportSocketStatus_t returnStatus;
+    ServerInfo_t fallback =
+    {
+        .pHostName      = FALLBACK_HOSTNAME,
+        .hostNameLength = strlen( FALLBACK_HOSTNAME ),
+        .port           = FALLBACK_PORT
+    };
+    ServerInfo_t localServerInfo = serverInfo;
+
+    localServerInfo.pFallbacks = &fallback;
+    localServerInfo.fallbackCount = 1U;
+
+    SOCKETS_Socket_ExpectAndReturn( SOCKETS_AF_INET,
+                                    SOCKETS_SOCK_STREAM,
+                                    SOCKETS_IPPROTO_TCP,
+                                    SOCKETS_INVALID_SOCKET );
+    returnStatus = SecureSocketsTransport_Connect( &networkContext,
+                                                   &localServerInfo,
+                                                   &socketsConfig );
+    TEST_ASSERT_EQUAL( TRANSPORT_SOCKET_STATUS_INSUFFICIENT_MEMORY, returnStatus );
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Test #SecureSocketsTransport_Disconnect with invalid parameters.
  */
@@ -1022,6 +1230,108 @@ void test_SecureSocketsTransport_Recv_Bytes_Received_Partially( void )
 }
 
 
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that #SecureSocketsTransport_GetStatistics fails with NULL parameters.
+ */
+void test_SecureSocketsTransport_GetStatistics_Invalid_Params( void )
+{
+    IotNetworkStatistics_t statistics;
+
+    TEST_ASSERT_EQUAL( TRANSPORT_SOCKET_STATUS_INVALID_PARAMETER,
+                       SecureSocketsTransport_GetStatistics( NULL, &statistics ) );
+    TEST_ASSERT_EQUAL( TRANSPORT_SOCKET_STATUS_INVALID_PARAMETER,
+                       SecureSocketsTransport_GetStatistics( &networkContext, NULL ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that #SecureSocketsTransport_Send and #SecureSocketsTransport_Recv
+ * are counted, and that the TLS record counts stay 0 when the socket does not
+ * report them.
+ */
+void test_SecureSocketsTransport_GetStatistics_Counts_Calls( void )
+{
+    IotNetworkStatistics_t statistics;
+
+    SOCKETS_Send_ExpectAndReturn( networkContext.tcpSocket, networkBuffer, BYTES_TO_SEND, 0, BYTES_TO_SEND );
+    ( void ) SecureSocketsTransport_Send( &networkContext, networkBuffer, BYTES_TO_SEND );
+
+    SOCKETS_Send_ExpectAndReturn( networkContext.tcpSocket, networkBuffer, BYTES_TO_SEND, 0, SECURE_SOCKETS_READ_WRITE_ERROR );
+    ( void ) SecureSocketsTransport_Send( &networkContext, networkBuffer, BYTES_TO_SEND );
+
+    SOCKETS_Recv_ExpectAndReturn( networkContext.tcpSocket, NULL, BYTES_TO_RECV, 0, BYTES_TO_RECV - 1 );
+    SOCKETS_Recv_IgnoreArg_pvBuffer();
+    ( void ) SecureSocketsTransport_Recv( &networkContext, networkBuffer, BYTES_TO_RECV );
+
+    SOCKETS_Recv_ExpectAndReturn( networkContext.tcpSocket, NULL, BYTES_TO_RECV, 0, SOCKETS_EWOULDBLOCK );
+    SOCKETS_Recv_IgnoreArg_pvBuffer();
+    ( void ) SecureSocketsTransport_Recv( &networkContext, networkBuffer, BYTES_TO_RECV );
+
+    SOCKETS_SetSockOpt_ExpectAndReturn( mockTcpSocket, 0, SOCKETS_SO_TLS_RECORD_COUNTS, NULL, 0, SOCKETS_ENOPROTOOPT );
+    SOCKETS_SetSockOpt_IgnoreArg_pvOptionValue();
+    SOCKETS_SetSockOpt_IgnoreArg_xOptionLength();
+
+    TEST_ASSERT_EQUAL( TRANSPORT_SOCKET_STATUS_SUCCESS,
+                       SecureSocketsTransport_GetStatistics( &networkContext, &statistics ) );
+
+    TEST_ASSERT_EQUAL( BYTES_TO_SEND, statistics.bytesSent );
+    TEST_ASSERT_EQUAL( BYTES_TO_RECV - 1, statistics.bytesReceived );
+    TEST_ASSERT_EQUAL( 2, statistics.sendCalls );
+    TEST_ASSERT_EQUAL( 2, statistics.receiveCalls );
+    TEST_ASSERT_EQUAL( 1, statistics.sendErrors );
+    TEST_ASSERT_EQUAL( 0, statistics.receiveErrors );
+    TEST_ASSERT_EQUAL( 2, statistics.sendBlockingMs[ 0 ] );
+    TEST_ASSERT_EQUAL( 2, statistics.receiveBlockingMs[ 0 ] );
+    TEST_ASSERT_EQUAL( 0, statistics.tlsRecordsSent );
+    TEST_ASSERT_EQUAL( 0, statistics.tlsRecordsReceived );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that #SecureSocketsTransport_GetStatistics reads the TLS record
+ * counts from the socket.
+ */
+void test_SecureSocketsTransport_GetStatistics_Tls_Record_Counts( void )
+{
+    IotNetworkStatistics_t statistics;
+
+    SOCKETS_SetSockOpt_Stub( SetSockOpt_TlsRecordCounts );
+
+    TEST_ASSERT_EQUAL( TRANSPORT_SOCKET_STATUS_SUCCESS,
+                       SecureSocketsTransport_GetStatistics( &networkContext, &statistics ) );
+    TEST_ASSERT_EQUAL( TLS_RECORDS_SENT, statistics.tlsRecordsSent );
+    TEST_ASSERT_EQUAL( TLS_RECORDS_RECEIVED, statistics.tlsRecordsReceived );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that the time a send blocks is counted in the bucket of
+ * the power of 2 below it.
+ */
+void test_SecureSocketsTransport_GetStatistics_Blocking_Histogram( void )
+{
+    IotNetworkStatistics_t statistics;
+
+    SOCKETS_Send_Stub( Send_Blocks3Ms );
+    ( void ) SecureSocketsTransport_Send( &networkContext, networkBuffer, BYTES_TO_SEND );
+
+    SOCKETS_SetSockOpt_ExpectAndReturn( mockTcpSocket, 0, SOCKETS_SO_TLS_RECORD_COUNTS, NULL, 0, SOCKETS_ENOPROTOOPT );
+    SOCKETS_SetSockOpt_IgnoreArg_pvOptionValue();
+    SOCKETS_SetSockOpt_IgnoreArg_xOptionLength();
+
+    TEST_ASSERT_EQUAL( TRANSPORT_SOCKET_STATUS_SUCCESS,
+                       SecureSocketsTransport_GetStatistics( &networkContext, &statistics ) );
+
+    /* 3 ms is in [2, 4) ms, bucket 2. */
+    TEST_ASSERT_EQUAL( 0, statistics.sendBlockingMs[ 0 ] );
+    TEST_ASSERT_EQUAL( 1, statistics.sendBlockingMs[ 2 ] );
+}
+
 /*-------------------------------------------------------------------*/
 /*-----------------------End Tests-----------------------------------*/
 /*-------------------------------------------------------------------*/
@@ -170,7 +170,8 @@ AwsIotDefenderError_t AwsIotDefender_Start( AwsIotDefenderStartInfo_t * pStartIn
     /* Initialize flow control states to false. */
     bool buildTopicsNamesSuccess = false,
          doneSemaphoreCreateSuccess = false,
-         metricsMutexCreateSuccess = false;
+         metricsMutexCreateSuccess = false,
+         collectorStartSuccess = false;
 
     if( !_started )
     {
@@ -209,6 +210,15 @@ AwsIotDefenderError_t AwsIotDefender_Start( AwsIotDefenderStartInfo_t * pStartIn
         }
 
         if( metricsMutexCreateSuccess )
+        {
+            collectorStartSuccess = AwsIotDefenderInternal_StartCollector();
+        }
+        else
+        {
+            status = AWS_IOT_DEFENDER_INTERNAL_FAILURE;
+        }
+
+        if( collectorStartSuccess )
         {
             /*  Subscribe to Metrics Publish topic */
             mqttError = _metricsSubscribeRoutine();
@@ -259,6 +269,11 @@ AwsIotDefenderError_t AwsIotDefender_Start( AwsIotDefenderStartInfo_t * pStartIn
                 IotMutex_Destroy( &_AwsIotDefenderMetrics.mutex );
             }
 
+            if( collectorStartSuccess )
+            {
+                AwsIotDefenderInternal_StopCollector();
+            }
+
             IotLogError( "Defender agent failed to start due to error %s.", AwsIotDefender_strerror( status ) );
         }
     }
@@ -297,6 +312,9 @@ void AwsIotDefender_Stop( void )
         IotLogInfo( "Unsubscribing from MQTT topics" );
         _unsubscribeMqtt();
 
+        /* Stop collecting metrics. */
+        AwsIotDefenderInternal_StopCollector();
+
         /* Destroy metrics' mutex. */
         IotMutex_Destroy( &_AwsIotDefenderMetrics.mutex );
 
@@ -25,6 +25,7 @@
 
 /* Standard includes */
 #include <stdio.h>
+#include <string.h>
 
 /* Defender internal include. */
 #include "private/aws_iot_defender_internal.h"
@@ -66,6 +67,33 @@ static _metricsReport_t _report =
     .size        = 0
 };
 
+#if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1
+
+/**
+ * Structure to hold the copies of the established TCP connections.
+ */
+    typedef struct _trackedConnections
+    {
+        /* Protects the members below, except the reported ones that are only used by the publish job. It may be locked while the metrics TCP connection list is locked, but not the other way around. */
+        IotMutex_t mutex;
+
+        IotListDouble_t freeRecords; /* Unused connection records. */
+        IotListDouble_t active;      /* Copies of the established connections. */
+        size_t untracked;            /* Number of established connections without a copy. */
+
+        IotListDouble_t reported;    /* Connections in the current report. */
+        bool reportFromCopies;       /* Whether the current report lists the copied connections. */
+
+        /* Connection records used by the active list. */
+        IotMetricsTcpConnection_t records[ AWS_IOT_DEFENDER_MAX_TRACKED_CONNECTIONS ];
+
+        /* Connection records used by the reported list. */
+        IotMetricsTcpConnection_t reportedRecords[ AWS_IOT_DEFENDER_MAX_TRACKED_CONNECTIONS ];
+    } _trackedConnections_t;
+
+    static _trackedConnections_t _trackedConnections;
+#endif /* if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1 */
+
 /* Define a "snapshot" global array of metrics flag. */
 static uint32_t _metricsFlagSnapshot[ DEFENDER_METRICS_GROUP_COUNT ];
 
@@ -85,9 +113,22 @@ static void _copyMetricsFlag( void );
 
 static void serializeReport( void );
 
+static void _serializeTcpConnectionsMetrics( IotSerializerEncoderObject_t * pMetricsObject );
+
 static void _serializeTcpConnections( void * param1,
                                       const IotListDouble_t * pTcpConnectionsMetricsList );
 
+#if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1
+    static bool _connectionMatch( const IotLink_t * pConnectionLink,
+                                  void * pContext );
+
+    static void _takeConnections( void );
+
+    static void _connectionChangeCallback( void * pContext,
+                                           const IotMetricsTcpConnection_t * pTcpConnection,
+                                           bool established );
+#endif
+
 #if DEBUG_CBOR_PRINT == 1
     static void _printReport();
 #endif
@@ -110,6 +151,50 @@ void _assertSuccessOrBufferToSmall( IotSerializerError_t error )
 
 /*-----------------------------------------------------------*/
 
+bool AwsIotDefenderInternal_StartCollector( void )
+{
+    bool result = true;
+
+    #if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1
+        uint32_t i = 0;
+
+        IotListDouble_Create( &( _trackedConnections.freeRecords ) );
+        IotListDouble_Create( &( _trackedConnections.active ) );
+        IotListDouble_Create( &( _trackedConnections.reported ) );
+        _trackedConnections.untracked = 0;
+        _trackedConnections.reportFromCopies = false;
+
+        for( i = 0; i < AWS_IOT_DEFENDER_MAX_TRACKED_CONNECTIONS; i++ )
+        {
+            IotListDouble_InsertTail( &( _trackedConnections.freeRecords ),
+                                      &( _trackedConnections.records[ i ].link ) );
+        }
+
+        result = IotMutex_Create( &( _trackedConnections.mutex ), false );
+
+        if( result )
+        {
+            /* The active connections are reported to the callback, so they are
+             * copied before the first report. */
+            IotMetrics_SetTcpConnectionCallback( NULL, _connectionChangeCallback );
+        }
+    #endif /* if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1 */
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+void AwsIotDefenderInternal_StopCollector( void )
+{
+    #if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1
+        IotMetrics_SetTcpConnectionCallback( NULL, NULL );
+        IotMutex_Destroy( &( _trackedConnections.mutex ) );
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
 uint8_t * AwsIotDefenderInternal_GetReportBuffer( void )
 {
     return _report.pDataBuffer;
@@ -144,6 +229,12 @@ bool AwsIotDefenderInternal_CreateReport( void )
     /* Generate report id based on current time. */
     _AwsIotDefenderReportId = IotClock_GetTimeMs();
 
+    /* Copy the connections to report, so that both serialization passes see
+     * the same connections. */
+    #if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1
+        _takeConnections();
+    #endif
+
     /* Dry-run serialization to calculate the required size. */
     serializeReport();
 
@@ -273,7 +364,7 @@ static void serializeReport( void )
             switch( i )
             {
                 case AWS_IOT_DEFENDER_METRICS_TCP_CONNECTIONS:
-                    IotMetrics_GetTcpConnections( ( void * ) &metricsMap, _serializeTcpConnections );
+                    _serializeTcpConnectionsMetrics( &metricsMap );
                     break;
 
                 default:
@@ -307,6 +398,24 @@ static void _copyMetricsFlag( void )
 
 /*-----------------------------------------------------------*/
 
+static void _serializeTcpConnectionsMetrics( IotSerializerEncoderObject_t * pMetricsObject )
+{
+    #if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1
+        if( _trackedConnections.reportFromCopies )
+        {
+            /* The reported list is only modified by the publish job, so it is
+             * read here without locking. */
+            _serializeTcpConnections( ( void * ) pMetricsObject, &( _trackedConnections.reported ) );
+
+            return;
+        }
+    #endif
+
+    IotMetrics_GetTcpConnections( ( void * ) pMetricsObject, _serializeTcpConnections );
+}
+
+/*-----------------------------------------------------------*/
+
 static void _serializeTcpConnections( void * param1,
                                       const IotListDouble_t * pTcpConnectionsMetricsList )
 {
@@ -408,6 +517,108 @@ static void _serializeTcpConnections( void * param1,
     assertNoError( serializerError );
 }
 
+#if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1
+
+/*-----------------------------------------------------------*/
+
+    static bool _connectionMatch( const IotLink_t * pConnectionLink,
+                                  void * pContext )
+    {
+        const IotMetricsTcpConnection_t * pTcpConnection = IotLink_Container( IotMetricsTcpConnection_t,
+                                                                              pConnectionLink,
+                                                                              link );
+
+        return( pTcpConnection->pNetworkContext == pContext );
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void _takeConnections( void )
+    {
+        IotLink_t * pConnectionLink = NULL;
+        IotMetricsTcpConnection_t * pReportedRecord = _trackedConnections.reportedRecords;
+
+        IotListDouble_Create( &( _trackedConnections.reported ) );
+
+        IotMutex_Lock( &( _trackedConnections.mutex ) );
+
+        _trackedConnections.reportFromCopies = ( _trackedConnections.untracked == 0 );
+
+        if( _trackedConnections.reportFromCopies )
+        {
+            IotContainers_ForEach( &( _trackedConnections.active ), pConnectionLink )
+            {
+                ( void ) memcpy( pReportedRecord,
+                                 IotLink_Container( IotMetricsTcpConnection_t, pConnectionLink, link ),
+                                 sizeof( IotMetricsTcpConnection_t ) );
+
+                IotListDouble_InsertTail( &( _trackedConnections.reported ), &( pReportedRecord->link ) );
+                pReportedRecord++;
+            }
+        }
+        else
+        {
+            IotLogInfo( "Too many TCP connections to track. Reporting the connection list of the metrics component." );
+        }
+
+        IotMutex_Unlock( &( _trackedConnections.mutex ) );
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void _connectionChangeCallback( void * pContext,
+                                           const IotMetricsTcpConnection_t * pTcpConnection,
+                                           bool established )
+    {
+        IotLink_t * pConnectionLink = NULL;
+
+        /* Unused parameter; silence the compiler. */
+        ( void ) pContext;
+
+        IotMutex_Lock( &( _trackedConnections.mutex ) );
+
+        if( established )
+        {
+            pConnectionLink = IotListDouble_RemoveHead( &( _trackedConnections.freeRecords ) );
+
+            if( pConnectionLink != NULL )
+            {
+                ( void ) memcpy( IotLink_Container( IotMetricsTcpConnection_t, pConnectionLink, link ),
+                                 pTcpConnection,
+                                 sizeof( IotMetricsTcpConnection_t ) );
+
+                IotListDouble_InsertTail( &( _trackedConnections.active ), pConnectionLink );
+            }
+            else
+            {
+                /* Reports read the complete connection list until this
+                 * connection is closed. */
+                _trackedConnections.untracked++;
+            }
+        }
+        else
+        {
+            pConnectionLink = IotListDouble_RemoveFirstMatch( &( _trackedConnections.active ),
+                                                              NULL,
+                                                              _connectionMatch,
+                                                              pTcpConnection->pNetworkContext );
+
+            if( pConnectionLink != NULL )
+            {
+                IotListDouble_InsertTail( &( _trackedConnections.freeRecords ), pConnectionLink );
+            }
+            else if( _trackedConnections.untracked > 0 )
+            {
+                /* A connection without a copy was closed. */
+                _trackedConnections.untracked--;
+            }
+        }
+
+        IotMutex_Unlock( &( _trackedConnections.mutex ) );
+    }
+
+#endif /* if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1 */
+
 #if DEBUG_CBOR_PRINT == 1
     #include "cbor.h"
     /*-----------------------------------------------------------*/
@@ -426,3 +637,10 @@ static void _serializeTcpConnections( void * param1,
         cbor_value_to_pretty( stdout, &cborValue );
     }
 #endif /* if DEBUG_CBOR_PRINT == 1 */
+
+/*-----------------------------------------------------------*/
+
+/* Provide access to internal functions and variables if testing. */
+#if IOT_BUILD_TESTS == 1
+    #include "aws_iot_test_access_defender_collector.c"
+#endif
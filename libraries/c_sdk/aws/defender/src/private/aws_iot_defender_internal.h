@@ -190,6 +190,29 @@
  * <b>Recommended values:</b>  greater than or equal to `300` seconds; defender service might throttle if the period is too short <br>
  * <b>Default value (if undefined):</b>  `300` <br>
  *
+ * @section AWS_IOT_DEFENDER_INCREMENTAL_METRICS
+ * @brief Track the TCP connections as they change instead of reading the
+ * complete list for every report.
+ *
+ * When enabled, Defender is notified of established and closed TCP connections
+ * as they happen and keeps its own copy of the established connections. Reports
+ * are built from this copy, so the TCP connection list of the metrics component
+ * is not locked while a report is serialized. The report format does not change:
+ * it lists the established connections and their total.
+ *
+ * <b>Possible values:</b>  `0` or `1` <br>
+ * <b>Default value (if undefined):</b> `0` <br>
+ *
+ * @section AWS_IOT_DEFENDER_MAX_TRACKED_CONNECTIONS
+ * @brief The maximum number of established TCP connections copied by Defender
+ * when #AWS_IOT_DEFENDER_INCREMENTAL_METRICS is enabled.
+ *
+ * While more connections are established, reports read the complete connection
+ * list from the metrics component instead.
+ *
+ * <b>Possible values:</b>  greater than 0 <br>
+ * <b>Default value (if undefined):</b> `32` <br>
+ *
  * @section AWS_IOT_DEFENDER_MQTT_CONNECT_TIMEOUT_SECONDS
  * @brief Default MQTT connect timeout.
  *
@@ -243,6 +266,18 @@
     #define AWS_IOT_DEFENDER_USE_LONG_TAG    ( 0 )
 #endif
 
+#ifndef AWS_IOT_DEFENDER_INCREMENTAL_METRICS
+    #define AWS_IOT_DEFENDER_INCREMENTAL_METRICS    ( 0 )
+#endif
+
+#ifndef AWS_IOT_DEFENDER_MAX_TRACKED_CONNECTIONS
+    #define AWS_IOT_DEFENDER_MAX_TRACKED_CONNECTIONS    ( 32 )
+#endif
+
+#if AWS_IOT_DEFENDER_MAX_TRACKED_CONNECTIONS <= 0
+    #error "AWS_IOT_DEFENDER_MAX_TRACKED_CONNECTIONS cannot be 0 or negative."
+#endif
+
 /*----------------- Below this line is INTERNAL used only --------------------*/
 
 /* This MUST be consistent with enum AwsIotDefenderMetricsGroup_t. */
@@ -292,6 +327,16 @@ typedef struct _defenderMetrics
     IotMutex_t mutex;
 } _defenderMetrics_t;
 
+/**
+ * Start collecting metrics. Called once when defender starts.
+ */
+bool AwsIotDefenderInternal_StartCollector( void );
+
+/**
+ * Stop collecting metrics. Called once when defender stops.
+ */
+void AwsIotDefenderInternal_StopCollector( void );
+
 /**
  * Create a report, memory is allocated inside the function.
  */
@@ -26,6 +26,9 @@
 /* The config header is always included first. */
 #include "iot_config.h"
 
+/* Standard includes. */
+#include <stdio.h>
+
 /* Defender internal includes. */
 #include "private/aws_iot_defender_internal.h"
 
@@ -38,6 +41,9 @@
 /* Platform network include. */
 #include "platform/iot_network.h"
 
+/* Test access include. */
+#include "aws_iot_test_access_defender.h"
+
 #include "iot_init.h"
 #include "unity_fixture.h"
 
@@ -67,8 +73,41 @@ static IotMqttConnection_t _mqttConnection = IOT_MQTT_CONNECTION_INITIALIZER;
 static AwsIotDefenderStartInfo_t _startInfo = AWS_IOT_DEFENDER_START_INFO_INITIALIZER;
 
 static bool _mockedMqttConnection = false;
+
+#if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1
+
+/* Network contexts of the TCP connections reported to the collector. */
+    static uint8_t _networkContexts[ AWS_IOT_DEFENDER_MAX_TRACKED_CONNECTIONS + 1 ];
+#endif
+
 /*------------------ Functions -----------------------------*/
 
+#if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1
+
+/* Report an established or closed TCP connection to the collector. */
+    static void _changeConnection( size_t index,
+                                   bool established )
+    {
+        IotMetricsTcpConnection_t tcpConnection = { .link = { 0 } };
+
+        tcpConnection.pNetworkContext = &( _networkContexts[ index ] );
+        tcpConnection.addressLength = ( size_t ) snprintf( tcpConnection.pRemoteAddress,
+                                                           IOT_METRICS_IP_ADDRESS_LENGTH,
+                                                           "10.0.0.%u:443",
+                                                           ( unsigned ) index );
+
+        AwsIotTestDefender_connectionChangeCallback( &tcpConnection, established );
+    }
+
+/* Get the network context of the first connection in a list. */
+    static void * _firstConnection( const IotListDouble_t * pConnectionsList )
+    {
+        return IotLink_Container( IotMetricsTcpConnection_t,
+                                  IotListDouble_PeekHead( pConnectionsList ),
+                                  link )->pNetworkContext;
+    }
+#endif /* if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1 */
+
 TEST_GROUP( Defender_Unit );
 
 TEST_SETUP( Defender_Unit )
@@ -183,6 +222,26 @@ TEST_GROUP_RUNNER( Defender_Unit )
      * Expectation: Start API return "already started" error
      */
     RUN_TEST_CASE( Defender_Unit, Start_should_return_err_if_already_started );
+
+    #if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1
+
+        /*
+         * Setup: collector started
+         * Action: open and close connections around two reports
+         * Expectation:
+         * - each report lists the connections established when it was taken
+         * - a taken report does not change with later connections
+         */
+        RUN_TEST_CASE( Defender_Unit, Reports_list_copied_connections );
+
+        /*
+         * Setup: collector started
+         * Action: open more connections than can be copied; close them again
+         * Expectation: reports read the metrics connection list until every
+         * established connection has a copy
+         */
+        RUN_TEST_CASE( Defender_Unit, Untracked_connections_fall_back_to_metrics_list );
+    #endif
 }
 
 TEST( Defender_Unit, SetMetrics_with_invalid_metrics_group )
@@ -299,3 +358,77 @@ TEST( Defender_Unit, SetPeriod_after_started )
 
     TEST_ASSERT_EQUAL( 2 * AWS_IOT_DEFENDER_DEFAULT_PERIOD_SECONDS, AwsIotDefender_GetPeriod() );
 }
+
+#if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1
+
+    TEST( Defender_Unit, Reports_list_copied_connections )
+    {
+        TEST_ASSERT_TRUE( AwsIotDefenderInternal_StartCollector() );
+
+        /* Connection 0 is closed before the report is taken. */
+        _changeConnection( 0, true );
+        _changeConnection( 1, true );
+        _changeConnection( 0, false );
+        _changeConnection( 2, true );
+
+        AwsIotTestDefender_takeConnections();
+
+        TEST_ASSERT_TRUE( AwsIotTestDefender_reportFromCopies() );
+        TEST_ASSERT_EQUAL( 2, IotListDouble_Count( AwsIotTestDefender_getReportedConnections() ) );
+        TEST_ASSERT_EQUAL_PTR( &( _networkContexts[ 1 ] ), _firstConnection( AwsIotTestDefender_getReportedConnections() ) );
+
+        /* Changes after the report is taken do not modify it. */
+        _changeConnection( 1, false );
+
+        TEST_ASSERT_EQUAL( 2, IotListDouble_Count( AwsIotTestDefender_getReportedConnections() ) );
+
+        /* The next report lists only the remaining connection. */
+        AwsIotTestDefender_takeConnections();
+
+        TEST_ASSERT_EQUAL( 1, IotListDouble_Count( AwsIotTestDefender_getReportedConnections() ) );
+        TEST_ASSERT_EQUAL_PTR( &( _networkContexts[ 2 ] ), _firstConnection( AwsIotTestDefender_getReportedConnections() ) );
+
+        _changeConnection( 2, false );
+        AwsIotDefenderInternal_StopCollector();
+    }
+
+    TEST( Defender_Unit, Untracked_connections_fall_back_to_metrics_list )
+    {
+        size_t i = 0;
+
+        TEST_ASSERT_TRUE( AwsIotDefenderInternal_StartCollector() );
+
+        /* One more connection than can be copied. */
+        for( i = 0; i < AWS_IOT_DEFENDER_MAX_TRACKED_CONNECTIONS + 1; i++ )
+        {
+            _changeConnection( i, true );
+        }
+
+        AwsIotTestDefender_takeConnections();
+
+        TEST_ASSERT_FALSE( AwsIotTestDefender_reportFromCopies() );
+        TEST_ASSERT_EQUAL( 0, IotListDouble_Count( AwsIotTestDefender_getReportedConnections() ) );
+
+        /* Closing a copied connection does not account for the one without a copy. */
+        _changeConnection( 0, false );
+        AwsIotTestDefender_takeConnections();
+
+        TEST_ASSERT_FALSE( AwsIotTestDefender_reportFromCopies() );
+
+        /* Once the connection without a copy is closed, reports use the copies again. */
+        _changeConnection( AWS_IOT_DEFENDER_MAX_TRACKED_CONNECTIONS, false );
+        AwsIotTestDefender_takeConnections();
+
+        TEST_ASSERT_TRUE( AwsIotTestDefender_reportFromCopies() );
+        TEST_ASSERT_EQUAL( AWS_IOT_DEFENDER_MAX_TRACKED_CONNECTIONS - 1,
+                           IotListDouble_Count( AwsIotTestDefender_getReportedConnections() ) );
+
+        for( i = 1; i < AWS_IOT_DEFENDER_MAX_TRACKED_CONNECTIONS; i++ )
+        {
+            _changeConnection( i, false );
+        }
+
+        AwsIotDefenderInternal_StopCollector();
+    }
+
+#endif /* if AWS_IOT_DEFENDER_INCREMENTAL_METRICS == 1 */
@@ -66,6 +66,14 @@
  * @function_brief{shadow_function_setupdatedcallback}
  * - @function_name{shadow_function_removepersistentsubscriptions}
  * @function_brief{shadow_function_removepersistentsubscriptions}
+ * - @function_name{shadow_function_enabledocumentcache}
+ * @function_brief{shadow_function_enabledocumentcache}
+ * - @function_name{shadow_function_disabledocumentcache}
+ * @function_brief{shadow_function_disabledocumentcache}
+ * - @function_name{shadow_function_getcacheddocument}
+ * @function_brief{shadow_function_getcacheddocument}
+ * - @function_name{shadow_function_diffreportedstate}
+ * @function_brief{shadow_function_diffreportedstate}
  * - @function_name{shadow_function_strerror}
  * @function_brief{shadow_function_strerror}
  */
@@ -107,6 +115,18 @@
  * @function_page{AwsIotShadow_RemovePersistentSubscriptions,shadow,removepersistentsubscriptions}
  * @function_snippet{shadow,removepersistentsubscriptions,this}
  * @copydoc AwsIotShadow_RemovePersistentSubscriptions
+ * @function_page{AwsIotShadow_EnableDocumentCache,shadow,enabledocumentcache}
+ * @function_snippet{shadow,enabledocumentcache,this}
+ * @copydoc AwsIotShadow_EnableDocumentCache
+ * @function_page{AwsIotShadow_DisableDocumentCache,shadow,disabledocumentcache}
+ * @function_snippet{shadow,disabledocumentcache,this}
+ * @copydoc AwsIotShadow_DisableDocumentCache
+ * @function_page{AwsIotShadow_GetCachedDocument,shadow,getcacheddocument}
+ * @function_snippet{shadow,getcacheddocument,this}
+ * @copydoc AwsIotShadow_GetCachedDocument
+ * @function_page{AwsIotShadow_DiffReportedState,shadow,diffreportedstate}
+ * @function_snippet{shadow,diffreportedstate,this}
+ * @copydoc AwsIotShadow_DiffReportedState
  * @function_page{AwsIotShadow_strerror,shadow,strerror}
  * @function_snippet{shadow,strerror,this}
  * @copydoc AwsIotShadow_strerror
@@ -900,6 +920,126 @@ AwsIotShadowError_t AwsIotShadow_RemovePersistentSubscriptions( IotMqttConnectio
                                                                 uint32_t flags );
 /* @[declare_shadow_removepersistentsubscriptions] */
 
+/**
+ * @brief Keep a local copy of a Thing Shadow.
+ *
+ * When the document cache is enabled, the Shadow library keeps the `desired`
+ * and `reported` state and the version of a Thing Shadow. The cache is updated
+ * from the following Shadow documents for the Thing:
+ * - Accepted responses to @ref shadow_function_get, which replace the cache.
+ * - Accepted responses to @ref shadow_function_update, which are merged into
+ * the cache. The cached `reported` state is therefore the last state acknowledged
+ * by the Shadow service.
+ * - Accepted responses to @ref shadow_function_delete, which clear the cache.
+ * - Delta documents, if a callback is set with @ref shadow_function_setdeltacallback.
+ * - Updated documents, if a callback is set with @ref shadow_function_setupdatedcallback.
+ *
+ * Documents older than the cached version are ignored. The cache may be read with
+ * @ref shadow_function_getcacheddocument once a complete Shadow document has been
+ * received, i.e. after a Shadow GET or an updated document.
+ *
+ * @param[in] pThingName The Thing Name of the Shadow to cache.
+ * @param[in] thingNameLength The length of `pThingName`.
+ *
+ * @return One of the following:
+ * - #AWS_IOT_SHADOW_SUCCESS
+ * - #AWS_IOT_SHADOW_BAD_PARAMETER
+ * - #AWS_IOT_SHADOW_NO_MEMORY
+ *
+ * @note The document cache is freed by @ref shadow_function_disabledocumentcache
+ * or @ref shadow_function_cleanup.
+ */
+/* @[declare_shadow_enabledocumentcache] */
+AwsIotShadowError_t AwsIotShadow_EnableDocumentCache( const char * pThingName,
+                                                     size_t thingNameLength );
+/* @[declare_shadow_enabledocumentcache] */
+
+/**
+ * @brief Stop keeping a local copy of a Thing Shadow and free the cached
+ * document.
+ *
+ * @param[in] pThingName The Thing Name passed to @ref shadow_function_enabledocumentcache.
+ * @param[in] thingNameLength The length of `pThingName`.
+ *
+ * @return #AWS_IOT_SHADOW_SUCCESS or #AWS_IOT_SHADOW_BAD_PARAMETER.
+ */
+/* @[declare_shadow_disabledocumentcache] */
+AwsIotShadowError_t AwsIotShadow_DisableDocumentCache( const char * pThingName,
+                                                      size_t thingNameLength );
+/* @[declare_shadow_disabledocumentcache] */
+
+/**
+ * @brief Read a Thing Shadow from the document cache without contacting the
+ * Shadow service.
+ *
+ * The cached document is written to `pDocumentBuffer` in the form
+ * `{"state":{"desired":{...},"reported":{...}},"version":N}`.
+ *
+ * @param[in] pThingName The Thing Name of the cached Shadow.
+ * @param[in] thingNameLength The length of `pThingName`.
+ * @param[in] minimumVersion The oldest acceptable Shadow version. Pass `0` to
+ * accept any version.
+ * @param[out] pDocumentBuffer Buffer for the cached document.
+ * @param[in] documentBufferSize The size of `pDocumentBuffer`.
+ * @param[out] pDocumentLength Set to the length of the cached document. If
+ * `pDocumentBuffer` is too small, set to the required length excluding the
+ * terminating `NUL`.
+ * @param[out] pVersion Set to the version of the cached document. Optional;
+ * pass `NULL` to ignore.
+ *
+ * @return One of the following:
+ * - #AWS_IOT_SHADOW_SUCCESS
+ * - #AWS_IOT_SHADOW_BAD_PARAMETER if a parameter is invalid or `pDocumentBuffer`
+ * is too small.
+ * - #AWS_IOT_SHADOW_NOT_FOUND if the document cache is not enabled or has not
+ * yet received a complete Shadow document.
+ * - #AWS_IOT_SHADOW_CONFLICT if the cached version is older than `minimumVersion`.
+ * Call @ref shadow_function_get to refresh the cache.
+ */
+/* @[declare_shadow_getcacheddocument] */
+AwsIotShadowError_t AwsIotShadow_GetCachedDocument( const char * pThingName,
+                                                   size_t thingNameLength,
+                                                   uint32_t minimumVersion,
+                                                   char * pDocumentBuffer,
+                                                   size_t documentBufferSize,
+                                                   size_t * pDocumentLength,
+                                                   uint32_t * pVersion );
+/* @[declare_shadow_getcacheddocument] */
+
+/**
+ * @brief Compute the members of a `reported` state that differ from the last
+ * `reported` state acknowledged by the Shadow service.
+ *
+ * The difference may be used as the `reported` state of a Shadow update document,
+ * so that unchanged members are not sent. Nested objects are compared member by
+ * member; other values are compared as text. The difference is `{}` if nothing
+ * changed, in which case the update may be skipped.
+ *
+ * @param[in] pThingName The Thing Name of the cached Shadow.
+ * @param[in] thingNameLength The length of `pThingName`.
+ * @param[in] pReportedState The complete `reported` state as a JSON object.
+ * @param[in] reportedStateLength The length of `pReportedState`.
+ * @param[out] pDiffBuffer Buffer for the difference. A buffer of
+ * `reportedStateLength` bytes is always large enough.
+ * @param[in] diffBufferSize The size of `pDiffBuffer`.
+ * @param[out] pDiffLength Set to the length of the difference.
+ *
+ * @return One of the following:
+ * - #AWS_IOT_SHADOW_SUCCESS
+ * - #AWS_IOT_SHADOW_BAD_PARAMETER if a parameter is invalid, `pReportedState` is
+ * not a JSON object, or `pDiffBuffer` is too small.
+ * - #AWS_IOT_SHADOW_NOT_FOUND if the document cache is not enabled.
+ */
+/* @[declare_shadow_diffreportedstate] */
+AwsIotShadowError_t AwsIotShadow_DiffReportedState( const char * pThingName,
+                                                   size_t thingNameLength,
+                                                   const char * pReportedState,
+                                                   size_t reportedStateLength,
+                                                   char * pDiffBuffer,
+                                                   size_t diffBufferSize,
+                                                   size_t * pDiffLength );
+/* @[declare_shadow_diffreportedstate] */
+
 /*------------------------- Shadow helper functions -------------------------*/
 
 /**
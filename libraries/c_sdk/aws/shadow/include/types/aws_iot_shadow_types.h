@@ -522,6 +522,8 @@ typedef struct AwsIotShadowDocumentInfo
  *   @copybrief AWS_IOT_SHADOW_FLAG_WAITABLE
  * - #AWS_IOT_SHADOW_FLAG_KEEP_SUBSCRIPTIONS <br>
  *   @copybrief AWS_IOT_SHADOW_FLAG_KEEP_SUBSCRIPTIONS
+ * - #AWS_IOT_SHADOW_FLAG_COALESCE <br>
+ *   @copybrief AWS_IOT_SHADOW_FLAG_COALESCE
  *
  * The following flags are valid for @ref shadow_function_removepersistentsubscriptions.
  * These flags are not valid for the Shadow operation functions.
@@ -585,6 +587,35 @@ typedef struct AwsIotShadowDocumentInfo
  */
 #define AWS_IOT_SHADOW_FLAG_KEEP_SUBSCRIPTIONS             ( 0x00000002 )
 
+/**
+ * @brief Merge this Shadow update with other updates of the same Thing that
+ * are sent within a short window.
+ *
+ * This flag is only valid if passed to the function @ref shadow_function_update
+ * or @ref shadow_function_timedupdate.
+ *
+ * By default, every call to @ref shadow_function_update publishes its own
+ * Shadow document. When a Thing's state changes several times in quick
+ * succession, every intermediate state is sent to the Shadow service, which
+ * responds to each one. This flag instead holds the update for
+ * @ref AWS_IOT_SHADOW_COALESCE_WINDOW_MS. Any other updates of the same Thing
+ * with this flag that are made during this window have their `state` merged
+ * into the held update, with later values replacing earlier ones. When the
+ * window ends, the merged state is published as a single Shadow update.
+ *
+ * All merged updates complete together when the Shadow service accepts or
+ * rejects the merged update. The client token of the first merged update is
+ * used for the merged document, and the QoS, retry settings, and MQTT
+ * connection of the first merged update are used to publish it.
+ *
+ * Update documents that contain a `version` key are not merged and are sent
+ * immediately, since their `version` applies to the document as a whole.
+ *
+ * @note Shadow updates without this flag are never merged, even when a merged
+ * update is being held for the same Thing.
+ */
+#define AWS_IOT_SHADOW_FLAG_COALESCE                       ( 0x00000004 )
+
 /**
  * @brief Remove the persistent subscriptions from a Shadow delete operation.
  *
@@ -223,6 +223,16 @@ static AwsIotShadowError_t _validateThingNameFlags( _shadowOperationType_t type,
         }
     }
 
+    /* Only Shadow UPDATEs can be merged. */
+    if( ( type != _SHADOW_UPDATE ) &&
+        ( ( flags & AWS_IOT_SHADOW_FLAG_COALESCE ) == AWS_IOT_SHADOW_FLAG_COALESCE ) )
+    {
+        IotLogError( "Coalesce flag is not valid for Shadow %s.",
+                     _pAwsIotShadowOperationNames[ type ] );
+
+        return AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
     /* A callback info must be passed to a non-waitable GET. */
     if( ( type == _SHADOW_GET ) &&
         ( ( flags & AWS_IOT_SHADOW_FLAG_WAITABLE ) == 0 ) &&
@@ -460,22 +470,11 @@ static AwsIotShadowError_t _modifyCallbackSubscriptions( IotMqttConnection_t mqt
     AwsIotShadow_Assert( ( mqttOperation == IotMqtt_TimedSubscribe ) ||
                          ( mqttOperation == IotMqtt_TimedUnsubscribe ) );
 
-    /* Use the subscription's topic buffer if available. */
-    if( pSubscription->pTopicBuffer != NULL )
-    {
-        pTopicFilter = pSubscription->pTopicBuffer;
-    }
-
-    /* Generate the prefix portion of the Shadow callback topic filter. Both
-     * callbacks share the same callback as the Shadow Update operation. */
-    if( _AwsIotShadow_GenerateShadowTopic( _SHADOW_UPDATE,
-                                           pSubscription->pThingName,
-                                           pSubscription->thingNameLength,
-                                           &pTopicFilter,
-                                           &operationTopicLength ) != AWS_IOT_SHADOW_SUCCESS )
-    {
-        return AWS_IOT_SHADOW_NO_MEMORY;
-    }
+    /* The prefix portion of the Shadow callback topic filter is the Shadow
+     * Update operation topic, which is taken from the Thing's topic table. */
+    pTopicFilter = _AwsIotShadow_GetOperationTopic( pSubscription,
+                                                    _SHADOW_UPDATE,
+                                                    &operationTopicLength );
 
     /* Place the callback suffix in the topic filter. */
     ( void ) memcpy( pTopicFilter + operationTopicLength,
@@ -530,17 +529,6 @@ static AwsIotShadowError_t _modifyCallbackSubscriptions( IotMqttConnection_t mqt
                      _pAwsIotShadowCallbackNames[ type ] );
     }
 
-    /* MQTT subscribe should check the subscription topic buffer. */
-    if( mqttOperation == IotMqtt_TimedSubscribe )
-    {
-        /* If the current subscription has no topic buffer, assign it the current
-         * topic buffer. Otherwise, free the current topic buffer. */
-        if( pSubscription->pTopicBuffer == NULL )
-        {
-            pSubscription->pTopicBuffer = pTopicFilter;
-        }
-    }
-
     return status;
 }
 
@@ -555,6 +543,14 @@ static void _callbackWrapperCommon( _shadowCallbackType_t type,
     /* Ensure that a callback function is set. */
     AwsIotShadow_Assert( pSubscription->callbacks[ type ].function != NULL );
 
+    /* Apply the document to the Thing's document cache before the callback
+     * runs, so that the callback reads an up-to-date cache. */
+    _AwsIotShadow_ApplyToCache( pSubscription->pThingName,
+                                pSubscription->thingNameLength,
+                                ( _shadowCacheSource_t ) ( type + SHADOW_OPERATION_COUNT ),
+                                pMessage->u.message.info.pPayload,
+                                pMessage->u.message.info.payloadLength );
+
     /* Set the callback type. Shadow callbacks are enumerated after the operations. */
     callbackParam.callbackType = ( AwsIotShadowCallbackType_t ) ( type + SHADOW_OPERATION_COUNT );
 
@@ -607,6 +603,16 @@ AwsIotShadowError_t AwsIotShadow_Init( uint32_t mqttTimeoutMs )
         return AWS_IOT_SHADOW_INIT_FAILED;
     }
 
+    /* Create the semaphore that cleanup waits on for merged UPDATE publish jobs. */
+    if( IotSemaphore_Create( &( _AwsIotShadowCoalescedJobsDone ), 0, 1 ) == false )
+    {
+        IotLogError( "Failed to create Shadow merged UPDATE semaphore." );
+        IotMutex_Destroy( &_AwsIotShadowSubscriptionsMutex );
+        IotMutex_Destroy( &_AwsIotShadowPendingOperationsMutex );
+
+        return AWS_IOT_SHADOW_INIT_FAILED;
+    }
+
     /* Create Shadow linear containers. */
     IotListDouble_Create( &( _AwsIotShadowPendingOperations ) );
     IotListDouble_Create( &( _AwsIotShadowSubscriptions ) );
@@ -640,6 +646,11 @@ void AwsIotShadow_Cleanup( void )
                              offsetof( _shadowSubscription_t, link ) );
     IotMutex_Unlock( &( _AwsIotShadowSubscriptionsMutex ) );
 
+    /* Publish jobs of merged UPDATEs cannot be canceled once they are executing,
+     * and they lock the Shadow mutexes. Wait for them before destroying the mutexes. */
+    _AwsIotShadow_WaitForCoalescedUpdates();
+    IotSemaphore_Destroy( &( _AwsIotShadowCoalescedJobsDone ) );
+
     /* Destroy Shadow library mutexes. */
     IotMutex_Destroy( &( _AwsIotShadowPendingOperationsMutex ) );
     IotMutex_Destroy( &( _AwsIotShadowSubscriptionsMutex ) );
@@ -870,8 +881,8 @@ AwsIotShadowError_t AwsIotShadow_Update( IotMqttConnection_t mqttConnection,
 {
     _shadowOperation_t * pOperation = NULL;
     AwsIotShadowError_t status = AWS_IOT_SHADOW_STATUS_PENDING;
-    const char * pClientToken = NULL;
-    size_t clientTokenLength = 0;
+    const char * pClientToken = NULL, * pState = NULL;
+    size_t clientTokenLength = 0, stateLength = 0;
 
     /* Validate the Thing Name and flags for Shadow UPDATE. */
     if( _validateThingNameFlags( _SHADOW_UPDATE,
@@ -919,6 +930,43 @@ AwsIotShadowError_t AwsIotShadow_Update( IotMqttConnection_t mqttConnection,
         return AWS_IOT_SHADOW_BAD_PARAMETER;
     }
 
+    /* Check an UPDATE document that will be merged with other UPDATEs. */
+    if( ( flags & AWS_IOT_SHADOW_FLAG_COALESCE ) == AWS_IOT_SHADOW_FLAG_COALESCE )
+    {
+        /* A version applies to the document as a whole, so a document with a
+         * version is sent on its own. */
+        if( _AwsIotShadow_FindJsonMember( pUpdateInfo->u.update.pUpdateDocument,
+                                          pUpdateInfo->u.update.updateDocumentLength,
+                                          VERSION_KEY,
+                                          VERSION_KEY_LENGTH,
+                                          &pState,
+                                          &stateLength ) == true )
+        {
+            IotLogDebug( "Shadow UPDATE document has a %s key and will not be merged.",
+                         VERSION_KEY );
+
+            flags &= ~AWS_IOT_SHADOW_FLAG_COALESCE;
+        }
+        /* Only the state of an UPDATE document is merged. */
+        else if( ( _AwsIotShadow_FindJsonMember( pUpdateInfo->u.update.pUpdateDocument,
+                                                 pUpdateInfo->u.update.updateDocumentLength,
+                                                 STATE_KEY,
+                                                 STATE_KEY_LENGTH,
+                                                 &pState,
+                                                 &stateLength ) == false ) ||
+                 ( pState[ 0 ] != '{' ) )
+        {
+            IotLogError( "Shadow document for a merged Shadow UPDATE must have a "
+                         "%s object.", STATE_KEY );
+
+            return AWS_IOT_SHADOW_BAD_PARAMETER;
+        }
+        else
+        {
+            /* Document can be merged. */
+        }
+    }
+
     /* Allocate a new Shadow operation for UPDATE. */
     if( _AwsIotShadow_CreateOperation( &pOperation,
                                        _SHADOW_UPDATE,
@@ -961,12 +1009,22 @@ AwsIotShadowError_t AwsIotShadow_Update( IotMqttConnection_t mqttConnection,
     }
 
     /* Process the Shadow operation. This subscribes to any required topics and
-     * sends the MQTT message for the Shadow operation. */
-    status = _AwsIotShadow_ProcessOperation( mqttConnection,
-                                             pUpdateInfo->pThingName,
-                                             pUpdateInfo->thingNameLength,
-                                             pOperation,
-                                             pUpdateInfo );
+     * sends the MQTT message for the Shadow operation. A Shadow UPDATE that will
+     * be merged is held, and sent with the other merged UPDATEs. */
+    if( ( flags & AWS_IOT_SHADOW_FLAG_COALESCE ) == AWS_IOT_SHADOW_FLAG_COALESCE )
+    {
+        status = _AwsIotShadow_CoalesceUpdate( mqttConnection,
+                                               pOperation,
+                                               pUpdateInfo );
+    }
+    else
+    {
+        status = _AwsIotShadow_ProcessOperation( mqttConnection,
+                                                 pUpdateInfo->pThingName,
+                                                 pUpdateInfo->thingNameLength,
+                                                 pOperation,
+                                                 pUpdateInfo );
+    }
 
     /* If the Shadow operation failed, clear the now invalid reference. */
     if( ( status != AWS_IOT_SHADOW_STATUS_PENDING ) && ( pUpdateOperation != NULL ) )
@@ -1065,7 +1123,6 @@ AwsIotShadowError_t AwsIotShadow_Wait( AwsIotShadowOperation_t operation,
      * count reaches 0. */
     IotMutex_Lock( &_AwsIotShadowSubscriptionsMutex );
     _AwsIotShadow_DecrementReferences( operation,
-                                       operation->pSubscription->pTopicBuffer,
                                        NULL );
     IotMutex_Unlock( &_AwsIotShadowSubscriptionsMutex );
 
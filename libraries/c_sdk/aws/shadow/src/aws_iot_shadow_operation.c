@@ -46,6 +46,39 @@
 /* MQTT include. */
 #include "iot_mqtt.h"
 
+/* Task pool include. */
+#include "iot_taskpool.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The start of a merged Shadow update document, before the merged state.
+ */
+#define COALESCED_DOCUMENT_PREFIX                  "{\"" STATE_KEY "\":"
+
+/**
+ * @brief The length of #COALESCED_DOCUMENT_PREFIX.
+ */
+#define COALESCED_DOCUMENT_PREFIX_LENGTH           ( sizeof( COALESCED_DOCUMENT_PREFIX ) - 1 )
+
+/**
+ * @brief Separates the merged state and the client token in a merged Shadow
+ * update document.
+ */
+#define COALESCED_DOCUMENT_CLIENT_TOKEN            ",\"" CLIENT_TOKEN_KEY "\":"
+
+/**
+ * @brief The length of #COALESCED_DOCUMENT_CLIENT_TOKEN.
+ */
+#define COALESCED_DOCUMENT_CLIENT_TOKEN_LENGTH     ( sizeof( COALESCED_DOCUMENT_CLIENT_TOKEN ) - 1 )
+
+/**
+ * @brief The length of a merged Shadow update document.
+ */
+#define COALESCED_DOCUMENT_LENGTH( stateLength, clientTokenLength )                     \
+    ( COALESCED_DOCUMENT_PREFIX_LENGTH + ( stateLength ) +                              \
+      COALESCED_DOCUMENT_CLIENT_TOKEN_LENGTH + ( clientTokenLength ) + 1 )
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -56,8 +89,8 @@ typedef struct _operationMatchParams
     _shadowOperationType_t type; /**< @brief DELETE, GET, or UPDATE. */
     const char * pThingName;     /**< @brief Thing Name of Shadow operation. */
     size_t thingNameLength;      /**< @brief Length of #_operationMatchParams_t.pThingName. */
-    const char * pDocument;      /**< @brief Shadow UPDATE response document. */
-    size_t documentLength;       /**< @brief Length of #_operationMatchParams_t.pDocument. */
+    const char * pClientToken;   /**< @brief Client token of a Shadow UPDATE response. */
+    size_t clientTokenLength;    /**< @brief Length of #_operationMatchParams_t.pClientToken. */
 } _operationMatchParams_t;
 
 /*-----------------------------------------------------------*/
@@ -75,6 +108,42 @@ typedef struct _operationMatchParams
 static bool _shadowOperation_match( const IotLink_t * pOperationLink,
                                     void * pMatch );
 
+/**
+ * @brief Set the result of a Shadow operation from its received response.
+ *
+ * @param[in] pOperation The Shadow operation that received a response.
+ * @param[in] status Whether the response was accepted or rejected.
+ * @param[in] pPublishInfo The received Shadow response (as an MQTT PUBLISH
+ * message).
+ *
+ * @return The result of `pOperation`.
+ */
+static AwsIotShadowError_t _processResponse( _shadowOperation_t * pOperation,
+                                             _shadowOperationStatus_t status,
+                                             const IotMqttPublishInfo_t * pPublishInfo );
+
+/**
+ * @brief Complete the pending Shadow operations that match a received response
+ * or a failed publish.
+ *
+ * Merged Shadow UPDATEs share a client token, so every matching Shadow UPDATE
+ * is completed. Only the first matching Shadow DELETE or GET is completed.
+ *
+ * @param[in] pParam Identifies the Shadow operations to complete.
+ * @param[in] status Whether the response was accepted or rejected. Ignored when
+ * `pPublishInfo` is `NULL`.
+ * @param[in] pPublishInfo The received Shadow response (as an MQTT PUBLISH
+ * message). `NULL` if the operations failed before a response was received.
+ * @param[in] failureStatus The result of the operations when `pPublishInfo` is
+ * `NULL`.
+ *
+ * @return The number of Shadow operations completed.
+ */
+static size_t _completeOperations( _operationMatchParams_t * pParam,
+                                   _shadowOperationStatus_t status,
+                                   const IotMqttPublishInfo_t * pPublishInfo,
+                                   AwsIotShadowError_t failureStatus );
+
 /**
  * @brief Common function for processing received Shadow responses.
  *
@@ -126,6 +195,62 @@ static AwsIotShadowError_t _processAcceptedGet( _shadowOperation_t * pOperation,
 static void _updateCallback( void * pArgument,
                              IotMqttCallbackParam_t * pMessage );
 
+/**
+ * @brief Start holding Shadow UPDATEs for a Thing, beginning with the given
+ * Shadow UPDATE.
+ *
+ * @param[in] pSubscription Subscription object of the Thing.
+ * @param[in] pOperation The first Shadow UPDATE to hold.
+ * @param[in] pUpdateInfo Information on the Shadow update document.
+ * @param[in] pState The `state` of the update document.
+ * @param[in] stateLength The length of `pState`.
+ *
+ * @return #AWS_IOT_SHADOW_STATUS_PENDING on success. On error, one of
+ * #AWS_IOT_SHADOW_NO_MEMORY or #AWS_IOT_SHADOW_MQTT_ERROR.
+ */
+static AwsIotShadowError_t _startCoalescedUpdate( _shadowSubscription_t * pSubscription,
+                                                  const _shadowOperation_t * pOperation,
+                                                  const AwsIotShadowDocumentInfo_t * pUpdateInfo,
+                                                  const char * pState,
+                                                  size_t stateLength );
+
+/**
+ * @brief Merge a Shadow UPDATE into the Shadow UPDATEs being held for a Thing.
+ *
+ * @param[in] pCoalescedUpdate The Shadow UPDATEs being held.
+ * @param[in] pOperation The Shadow UPDATE to merge. Its client token is
+ * replaced with the shared client token.
+ * @param[in] pState The `state` of the update document.
+ * @param[in] stateLength The length of `pState`.
+ *
+ * @return #AWS_IOT_SHADOW_STATUS_PENDING on success. On error, one of
+ * #AWS_IOT_SHADOW_NO_MEMORY or #AWS_IOT_SHADOW_BAD_PARAMETER.
+ */
+static AwsIotShadowError_t _mergeCoalescedUpdate( _shadowCoalescedUpdate_t * pCoalescedUpdate,
+                                                  _shadowOperation_t * pOperation,
+                                                  const char * pState,
+                                                  size_t stateLength );
+
+/**
+ * @brief Task pool job that publishes the merged Shadow UPDATE of a Thing.
+ *
+ * @param[in] pTaskPool Pointer to the system task pool.
+ * @param[in] pJob Pointer to the publish job.
+ * @param[in] pContext Subscription object of the Thing.
+ */
+static void _publishCoalescedUpdate( IotTaskPool_t pTaskPool,
+                                     IotTaskPoolJob_t pJob,
+                                     void * pContext );
+
+/**
+ * @brief Account for a finished publish job of a merged Shadow UPDATE, and wake
+ * #AwsIotShadow_Cleanup if it was the last one.
+ *
+ * This must be the last thing a publish job does, as the Shadow mutexes may be
+ * destroyed as soon as it returns.
+ */
+static void _finishCoalescedJob( void );
+
 /*-----------------------------------------------------------*/
 
 #if LIBRARY_LOG_LEVEL > IOT_LOG_NONE
@@ -154,6 +279,24 @@ IotListDouble_t _AwsIotShadowPendingOperations = { 0 };
  */
 IotMutex_t _AwsIotShadowPendingOperationsMutex;
 
+/**
+ * @brief Number of merged Shadow UPDATE publish jobs that are scheduled or
+ * executing. Protected by #_AwsIotShadowSubscriptionsMutex.
+ */
+uint32_t _AwsIotShadowCoalescedJobCount = 0;
+
+/**
+ * @brief Posted when the last merged Shadow UPDATE publish job finishes while
+ * #AwsIotShadow_Cleanup waits for it.
+ */
+IotSemaphore_t _AwsIotShadowCoalescedJobsDone;
+
+/**
+ * @brief Whether #AwsIotShadow_Cleanup is waiting for publish jobs to finish.
+ * Protected by #_AwsIotShadowSubscriptionsMutex.
+ */
+static bool _cleanupWaiting = false;
+
 /*-----------------------------------------------------------*/
 
 static bool _shadowOperation_match( const IotLink_t * pOperationLink,
@@ -168,11 +311,11 @@ static bool _shadowOperation_match( const IotLink_t * pOperationLink,
                                                          link );
     _operationMatchParams_t * pParam = ( _operationMatchParams_t * ) pMatch;
     _shadowSubscription_t * pSubscription = pOperation->pSubscription;
-    const char * pClientToken = NULL;
-    size_t clientTokenLength = 0;
 
-    /* Check for matching Thing Name and operation type. */
+    /* Check for matching Thing Name and operation type. A completed waitable
+     * operation remains in the list until it is waited on, so it is skipped. */
     bool match = ( pOperation->type == pParam->type ) &&
+                 ( pOperation->status == AWS_IOT_SHADOW_STATUS_PENDING ) &&
                  ( pParam->thingNameLength == pSubscription->thingNameLength ) &&
                  ( strncmp( pParam->pThingName,
                             pSubscription->pThingName,
@@ -181,38 +324,16 @@ static bool _shadowOperation_match( const IotLink_t * pOperationLink,
     /* For a Shadow UPDATE operation, compare the client tokens. */
     if( ( match == true ) && ( pOperation->type == _SHADOW_UPDATE ) )
     {
-        /* Check document pointers. */
-        AwsIotShadow_Assert( pParam->pDocument != NULL );
-        AwsIotShadow_Assert( pParam->documentLength > 0 );
+        /* Check client token pointers. */
+        AwsIotShadow_Assert( pParam->pClientToken != NULL );
+        AwsIotShadow_Assert( pParam->clientTokenLength > 0 );
         AwsIotShadow_Assert( pOperation->u.update.pClientToken != NULL );
         AwsIotShadow_Assert( pOperation->u.update.clientTokenLength > 0 );
 
-        IotLogDebug( "Verifying client tokens for Shadow UPDATE." );
-
-        /* Check for the client token in the UPDATE response document. */
-        match = IotJsonUtils_FindJsonValue( pParam->pDocument,
-                                            pParam->documentLength,
-                                            CLIENT_TOKEN_KEY,
-                                            CLIENT_TOKEN_KEY_LENGTH,
-                                            &pClientToken,
-                                            &clientTokenLength );
-
-        /* If the UPDATE response document has a client token, check that it
-         * matches. */
-        if( match == true )
-        {
-            match = ( clientTokenLength == pOperation->u.update.clientTokenLength ) &&
-                    ( strncmp( pClientToken,
-                               pOperation->u.update.pClientToken,
-                               clientTokenLength ) == 0 );
-        }
-        else
-        {
-            IotLogWarn( "Received a Shadow UPDATE response with no client token. "
-                        "This is possibly a response to a bad JSON document:\n%.*s",
-                        pParam->documentLength,
-                        pParam->pDocument );
-        }
+        match = ( pParam->clientTokenLength == pOperation->u.update.clientTokenLength ) &&
+                ( strncmp( pParam->pClientToken,
+                           pOperation->u.update.pClientToken,
+                           pParam->clientTokenLength ) == 0 );
     }
 
     return match;
@@ -220,78 +341,12 @@ static bool _shadowOperation_match( const IotLink_t * pOperationLink,
 
 /*-----------------------------------------------------------*/
 
-static void _commonOperationCallback( _shadowOperationType_t type,
-                                      IotMqttCallbackParam_t * pMessage )
+static AwsIotShadowError_t _processResponse( _shadowOperation_t * pOperation,
+                                             _shadowOperationStatus_t status,
+                                             const IotMqttPublishInfo_t * pPublishInfo )
 {
-    _shadowOperation_t * pOperation = NULL;
-    IotLink_t * pOperationLink = NULL;
-    _shadowOperationStatus_t status = _UNKNOWN_STATUS;
-    _operationMatchParams_t param = { .type = ( _shadowOperationType_t ) 0 };
-    uint32_t flags = 0;
-
-    /* Set operation type to search. */
-    param.type = type;
-
-    /* Set the response document for a Shadow UPDATE. */
-    if( type == _SHADOW_UPDATE )
-    {
-        param.pDocument = pMessage->u.message.info.pPayload;
-        param.documentLength = pMessage->u.message.info.payloadLength;
-    }
-
-    /* Parse the Thing Name from the MQTT topic name. */
-    if( _AwsIotShadow_ParseThingName( pMessage->u.message.info.pTopicName,
-                                      pMessage->u.message.info.topicNameLength,
-                                      &( param.pThingName ),
-                                      &( param.thingNameLength ) ) != AWS_IOT_SHADOW_SUCCESS )
-    {
-        return;
-    }
-
-    /* Lock the pending operations list for exclusive access. */
-    IotMutex_Lock( &( _AwsIotShadowPendingOperationsMutex ) );
-
-    /* Search for a matching pending operation. */
-    pOperationLink = IotListDouble_FindFirstMatch( &( _AwsIotShadowPendingOperations ),
-                                                   NULL,
-                                                   _shadowOperation_match,
-                                                   &param );
-
-    /* Find and remove the first Shadow operation of the given type. */
-    if( pOperationLink == NULL )
-    {
-        /* Operation is not pending. It may have already been processed. Return
-         * without doing anything */
-        IotMutex_Unlock( &( _AwsIotShadowPendingOperationsMutex ) );
-
-        IotLogWarn( "Shadow %s callback received an unknown operation.",
-                    _pAwsIotShadowOperationNames[ type ] );
-
-        return;
-    }
-    else
-    {
-        pOperation = IotLink_Container( _shadowOperation_t, pOperationLink, link );
-
-        /* Remove a non-waitable operation from the pending operation list. */
-        if( ( pOperation->flags & AWS_IOT_SHADOW_FLAG_WAITABLE ) == 0 )
-        {
-            IotListDouble_Remove( &( pOperation->link ) );
-            IotMutex_Unlock( &( _AwsIotShadowPendingOperationsMutex ) );
-        }
-    }
-
-    /* Check that the Shadow operation type and status. */
-    AwsIotShadow_Assert( pOperation->type == type );
-    AwsIotShadow_Assert( pOperation->status == AWS_IOT_SHADOW_STATUS_PENDING );
-
-    IotLogDebug( "Received Shadow response on topic %.*s",
-                 pMessage->u.message.info.topicNameLength,
-                 pMessage->u.message.info.pTopicName );
-
-    /* Parse the status from the topic name. */
-    status = _AwsIotShadow_ParseShadowStatus( pMessage->u.message.info.pTopicName,
-                                              pMessage->u.message.info.topicNameLength );
+    AwsIotShadowError_t result = AWS_IOT_SHADOW_STATUS_PENDING;
+    const _shadowOperationType_t type = pOperation->type;
 
     switch( status )
     {
@@ -305,12 +360,11 @@ static void _commonOperationCallback( _shadowOperationType_t type,
              * status to success. */
             if( type == _SHADOW_GET )
             {
-                pOperation->status = _processAcceptedGet( pOperation,
-                                                          &( pMessage->u.message.info ) );
+                result = _processAcceptedGet( pOperation, pPublishInfo );
             }
             else
             {
-                pOperation->status = AWS_IOT_SHADOW_SUCCESS;
+                result = AWS_IOT_SHADOW_SUCCESS;
             }
 
             break;
@@ -321,8 +375,8 @@ static void _commonOperationCallback( _shadowOperationType_t type,
                         pOperation->pSubscription->thingNameLength,
                         pOperation->pSubscription->pThingName );
 
-            pOperation->status = _AwsIotShadow_ParseErrorDocument( pMessage->u.message.info.pPayload,
-                                                                   pMessage->u.message.info.payloadLength );
+            result = _AwsIotShadow_ParseErrorDocument( pPublishInfo->pPayload,
+                                                       pPublishInfo->payloadLength );
             break;
 
         default:
@@ -331,21 +385,157 @@ static void _commonOperationCallback( _shadowOperationType_t type,
                         pOperation->pSubscription->thingNameLength,
                         pOperation->pSubscription->pThingName );
 
-            pOperation->status = AWS_IOT_SHADOW_BAD_RESPONSE;
+            result = AWS_IOT_SHADOW_BAD_RESPONSE;
             break;
     }
 
-    /* Copy the flags from the Shadow operation. The notify function may delete the operation. */
-    flags = pOperation->flags;
+    return result;
+}
 
-    /* Notify of operation completion. */
-    _AwsIotShadow_Notify( pOperation );
+/*-----------------------------------------------------------*/
 
-    /* For waitable operations, unlock the pending operation list mutex to signal
-     * this function's completion. */
-    if( ( flags & AWS_IOT_SHADOW_FLAG_WAITABLE ) == AWS_IOT_SHADOW_FLAG_WAITABLE )
+static size_t _completeOperations( _operationMatchParams_t * pParam,
+                                   _shadowOperationStatus_t status,
+                                   const IotMqttPublishInfo_t * pPublishInfo,
+                                   AwsIotShadowError_t failureStatus )
+{
+    _shadowOperation_t * pOperation = NULL;
+    IotLink_t * pOperationLink = NULL;
+    size_t completedCount = 0;
+    uint32_t flags = 0;
+
+    /* Lock the pending operations list for exclusive access. */
+    IotMutex_Lock( &( _AwsIotShadowPendingOperationsMutex ) );
+
+    do
     {
-        IotMutex_Unlock( &( _AwsIotShadowPendingOperationsMutex ) );
+        /* Search for a matching pending operation. */
+        pOperationLink = IotListDouble_FindFirstMatch( &( _AwsIotShadowPendingOperations ),
+                                                       NULL,
+                                                       _shadowOperation_match,
+                                                       pParam );
+
+        if( pOperationLink == NULL )
+        {
+            break;
+        }
+
+        pOperation = IotLink_Container( _shadowOperation_t, pOperationLink, link );
+
+        /* Copy the flags from the Shadow operation. The notify function may
+         * delete the operation. */
+        flags = pOperation->flags;
+
+        /* Remove a non-waitable operation from the pending operation list. */
+        if( ( flags & AWS_IOT_SHADOW_FLAG_WAITABLE ) == 0 )
+        {
+            IotListDouble_Remove( &( pOperation->link ) );
+            IotMutex_Unlock( &( _AwsIotShadowPendingOperationsMutex ) );
+        }
+
+        /* Check that the Shadow operation type and status. */
+        AwsIotShadow_Assert( pOperation->type == pParam->type );
+        AwsIotShadow_Assert( pOperation->status == AWS_IOT_SHADOW_STATUS_PENDING );
+
+        /* Set the result of the Shadow operation. */
+        if( pPublishInfo != NULL )
+        {
+            pOperation->status = _processResponse( pOperation, status, pPublishInfo );
+        }
+        else
+        {
+            pOperation->status = failureStatus;
+        }
+
+        /* Notify of operation completion. */
+        _AwsIotShadow_Notify( pOperation );
+        completedCount++;
+
+        /* Lock the pending operations list again to search for the next
+         * operation. */
+        if( ( flags & AWS_IOT_SHADOW_FLAG_WAITABLE ) == 0 )
+        {
+            IotMutex_Lock( &( _AwsIotShadowPendingOperationsMutex ) );
+        }
+    } while( pParam->type == _SHADOW_UPDATE );
+
+    /* Unlock the pending operation list mutex. For waitable operations, this
+     * signals this function's completion. */
+    IotMutex_Unlock( &( _AwsIotShadowPendingOperationsMutex ) );
+
+    return completedCount;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _commonOperationCallback( _shadowOperationType_t type,
+                                      IotMqttCallbackParam_t * pMessage )
+{
+    _shadowOperationStatus_t status = _UNKNOWN_STATUS;
+    _operationMatchParams_t param = { .type = ( _shadowOperationType_t ) 0 };
+
+    /* Set operation type to search. */
+    param.type = type;
+
+    /* Parse the Thing Name from the MQTT topic name. */
+    if( _AwsIotShadow_ParseThingName( pMessage->u.message.info.pTopicName,
+                                      pMessage->u.message.info.topicNameLength,
+                                      &( param.pThingName ),
+                                      &( param.thingNameLength ) ) != AWS_IOT_SHADOW_SUCCESS )
+    {
+        return;
+    }
+
+    /* Parse the client token of a Shadow UPDATE response. Merged Shadow UPDATEs
+     * share this client token. */
+    if( type == _SHADOW_UPDATE )
+    {
+        IotLogDebug( "Verifying client tokens for Shadow UPDATE." );
+
+        if( IotJsonUtils_FindJsonValue( pMessage->u.message.info.pPayload,
+                                        pMessage->u.message.info.payloadLength,
+                                        CLIENT_TOKEN_KEY,
+                                        CLIENT_TOKEN_KEY_LENGTH,
+                                        &( param.pClientToken ),
+                                        &( param.clientTokenLength ) ) == false )
+        {
+            IotLogWarn( "Received a Shadow UPDATE response with no client token. "
+                        "This is possibly a response to a bad JSON document:\n%.*s",
+                        pMessage->u.message.info.payloadLength,
+                        pMessage->u.message.info.pPayload );
+
+            return;
+        }
+    }
+
+    IotLogDebug( "Received Shadow response on topic %.*s",
+                 pMessage->u.message.info.topicNameLength,
+                 pMessage->u.message.info.pTopicName );
+
+    /* Parse the status from the topic name. */
+    status = _AwsIotShadow_ParseShadowStatus( pMessage->u.message.info.pTopicName,
+                                              pMessage->u.message.info.topicNameLength );
+
+    /* Apply an accepted document to the Thing's document cache. This does
+     * nothing if the document cache is not enabled. */
+    if( status == _SHADOW_ACCEPTED )
+    {
+        _AwsIotShadow_ApplyToCache( param.pThingName,
+                                    param.thingNameLength,
+                                    ( _shadowCacheSource_t ) type,
+                                    pMessage->u.message.info.pPayload,
+                                    pMessage->u.message.info.payloadLength );
+    }
+
+    /* Complete the matching Shadow operations. */
+    if( _completeOperations( &param,
+                             status,
+                             &( pMessage->u.message.info ),
+                             AWS_IOT_SHADOW_SUCCESS ) == 0 )
+    {
+        /* Operation is not pending. It may have already been processed. */
+        IotLogWarn( "Shadow %s callback received an unknown operation.",
+                    _pAwsIotShadowOperationNames[ type ] );
     }
 }
 
@@ -523,15 +713,12 @@ void _AwsIotShadow_DestroyOperation( void * pData )
 
 /*-----------------------------------------------------------*/
 
-AwsIotShadowError_t _AwsIotShadow_GenerateShadowTopic( _shadowOperationType_t type,
-                                                       const char * pThingName,
-                                                       size_t thingNameLength,
-                                                       char ** pTopicBuffer,
-                                                       uint16_t * pOperationTopicLength )
+uint16_t _AwsIotShadow_GenerateShadowTopic( _shadowOperationType_t type,
+                                            const char * pThingName,
+                                            size_t thingNameLength,
+                                            char * pTopicBuffer )
 {
-    uint16_t bufferLength = 0;
     uint16_t operationTopicLength = 0;
-    char * pBuffer = NULL;
 
     /* Lookup table for Shadow operation strings. */
     const char * const pOperationString[ SHADOW_OPERATION_COUNT ] =
@@ -555,54 +742,24 @@ AwsIotShadowError_t _AwsIotShadow_GenerateShadowTopic( _shadowOperationType_t ty
                          ( type == _SHADOW_GET ) ||
                          ( type == _SHADOW_UPDATE ) );
 
-    /* Calculate the required topic buffer length. */
-    bufferLength = ( uint16_t ) ( SHADOW_TOPIC_PREFIX_LENGTH +
-                                  thingNameLength +
-                                  pOperationStringLength[ type ] +
-                                  SHADOW_LONGEST_SUFFIX_LENGTH );
-
-    /* Allocate memory for the topic buffer if no topic buffer is given. */
-    if( *pTopicBuffer == NULL )
-    {
-        pBuffer = AwsIotShadow_MallocString( ( size_t ) bufferLength );
-
-        if( pBuffer == NULL )
-        {
-            return AWS_IOT_SHADOW_NO_MEMORY;
-        }
-    }
-    /* Otherwise, use the given topic buffer. */
-    else
-    {
-        pBuffer = *pTopicBuffer;
-    }
-
     /* Copy the Shadow topic prefix into the topic buffer. */
-    ( void ) memcpy( pBuffer, SHADOW_TOPIC_PREFIX, SHADOW_TOPIC_PREFIX_LENGTH );
+    ( void ) memcpy( pTopicBuffer, SHADOW_TOPIC_PREFIX, SHADOW_TOPIC_PREFIX_LENGTH );
     operationTopicLength = ( uint16_t ) ( operationTopicLength + SHADOW_TOPIC_PREFIX_LENGTH );
 
     /* Copy the Thing Name into the topic buffer. */
-    ( void ) memcpy( pBuffer + operationTopicLength, pThingName, thingNameLength );
+    ( void ) memcpy( pTopicBuffer + operationTopicLength, pThingName, thingNameLength );
     operationTopicLength = ( uint16_t ) ( operationTopicLength + thingNameLength );
 
     /* Copy the Shadow operation string into the topic buffer. */
-    ( void ) memcpy( pBuffer + operationTopicLength,
+    ( void ) memcpy( pTopicBuffer + operationTopicLength,
                      pOperationString[ type ],
                      pOperationStringLength[ type ] );
     operationTopicLength = ( uint16_t ) ( operationTopicLength + pOperationStringLength[ type ] );
 
     /* Ensure that the topic length is in the topic buffer. */
-    AwsIotShadow_Assert( operationTopicLength < bufferLength );
+    AwsIotShadow_Assert( operationTopicLength < SHADOW_TOPIC_TABLE_ENTRY_LENGTH( thingNameLength ) );
 
-    /* Set the output parameters. */
-    if( *pTopicBuffer == NULL )
-    {
-        *pTopicBuffer = pBuffer;
-    }
-
-    *pOperationTopicLength = operationTopicLength;
-
-    return AWS_IOT_SHADOW_SUCCESS;
+    return operationTopicLength;
 }
 
 /*-----------------------------------------------------------*/
@@ -616,10 +773,9 @@ AwsIotShadowError_t _AwsIotShadow_ProcessOperation( IotMqttConnection_t mqttConn
     _shadowSubscription_t * pSubscription = NULL;
     AwsIotShadowError_t status = AWS_IOT_SHADOW_STATUS_PENDING;
     IotMqttError_t publishStatus = IOT_MQTT_STATUS_PENDING;
-    char * pTopicBuffer = NULL;
-    uint16_t operationTopicLength = 0;
-    bool freeTopicBuffer = true;
     IotMqttPublishInfo_t publishInfo = IOT_MQTT_PUBLISH_INFO_INITIALIZER;
+    char pTopicName[ SHADOW_TOPIC_TABLE_ENTRY_LENGTH( MAX_THING_NAME_LENGTH ) ] = { 0 };
+    const char * pOperationTopic = NULL;
 
     /* Lookup table for Shadow operation callbacks. */
     const _mqttCallbackFunction_t shadowCallbacks[ SHADOW_OPERATION_COUNT ] =
@@ -637,20 +793,6 @@ AwsIotShadowError_t _AwsIotShadow_ProcessOperation( IotMqttConnection_t mqttConn
     /* Set the operation's MQTT connection. */
     pOperation->mqttConnection = mqttConnection;
 
-    /* Generate the operation topic buffer. */
-    if( _AwsIotShadow_GenerateShadowTopic( pOperation->type,
-                                           pThingName,
-                                           thingNameLength,
-                                           &pTopicBuffer,
-                                           &operationTopicLength ) != AWS_IOT_SHADOW_SUCCESS )
-    {
-        IotLogError( "No memory for Shadow operation topic buffer." );
-
-        _AwsIotShadow_DestroyOperation( pOperation );
-
-        return AWS_IOT_SHADOW_NO_MEMORY;
-    }
-
     /* Lock the subscription list mutex for exclusive access. */
     IotMutex_Lock( &_AwsIotShadowSubscriptionsMutex );
 
@@ -678,21 +820,9 @@ AwsIotShadowError_t _AwsIotShadow_ProcessOperation( IotMqttConnection_t mqttConn
         /* Set the subscription object for the Shadow operation. */
         pOperation->pSubscription = pSubscription;
 
-        /* Assign the topic buffer to the subscription to use for unsubscribing if
-         * the subscription has no topic buffer. */
-        if( pSubscription->pTopicBuffer == NULL )
-        {
-            pSubscription->pTopicBuffer = pTopicBuffer;
-
-            /* This function should not free the topic buffer. */
-            freeTopicBuffer = false;
-        }
-
         /* Increment the reference count for this Shadow operation's
          * subscriptions. */
         status = _AwsIotShadow_IncrementReferences( pOperation,
-                                                    pTopicBuffer,
-                                                    operationTopicLength,
                                                     shadowCallbacks[ pOperation->type ] );
 
         if( status != AWS_IOT_SHADOW_STATUS_PENDING )
@@ -702,6 +832,17 @@ AwsIotShadowError_t _AwsIotShadow_ProcessOperation( IotMqttConnection_t mqttConn
              * deleted. */
             _AwsIotShadow_RemoveSubscription( pSubscription, NULL );
         }
+        else
+        {
+            /* Copy the operation topic name from the Thing's topic table. Once
+             * this operation is pending, a response may complete it and remove
+             * the subscription object before the PUBLISH is sent. */
+            pOperationTopic = _AwsIotShadow_GetOperationTopic( pSubscription,
+                                                               pOperation->type,
+                                                               &( publishInfo.topicNameLength ) );
+            ( void ) memcpy( pTopicName, pOperationTopic, publishInfo.topicNameLength );
+            publishInfo.pTopicName = pTopicName;
+        }
     }
 
     /* Unlock the Shadow subscription list mutex. */
@@ -710,10 +851,6 @@ AwsIotShadowError_t _AwsIotShadow_ProcessOperation( IotMqttConnection_t mqttConn
     /* Check that all memory allocation and subscriptions succeeded. */
     if( status == AWS_IOT_SHADOW_STATUS_PENDING )
     {
-        /* Set the operation topic name. */
-        publishInfo.pTopicName = pTopicBuffer;
-        publishInfo.topicNameLength = operationTopicLength;
-
         IotLogDebug( "Shadow %s message will be published to topic %.*s",
                      _pAwsIotShadowOperationNames[ pOperation->type ],
                      publishInfo.topicNameLength,
@@ -786,7 +923,6 @@ AwsIotShadowError_t _AwsIotShadow_ProcessOperation( IotMqttConnection_t mqttConn
             {
                 IotMutex_Lock( &_AwsIotShadowSubscriptionsMutex );
                 _AwsIotShadow_DecrementReferences( pOperation,
-                                                   pTopicBuffer,
                                                    NULL );
                 IotMutex_Unlock( &_AwsIotShadowSubscriptionsMutex );
             }
@@ -803,13 +939,466 @@ AwsIotShadowError_t _AwsIotShadow_ProcessOperation( IotMqttConnection_t mqttConn
         }
     }
 
-    /* Free the topic buffer used by this function if it was not assigned to a
-     * subscription. */
-    if( ( freeTopicBuffer == true ) && ( pTopicBuffer != NULL ) )
+    /* Destroy the Shadow operation on failure. */
+    if( status != AWS_IOT_SHADOW_STATUS_PENDING )
+    {
+        _AwsIotShadow_DestroyOperation( pOperation );
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static AwsIotShadowError_t _startCoalescedUpdate( _shadowSubscription_t * pSubscription,
+                                                  const _shadowOperation_t * pOperation,
+                                                  const AwsIotShadowDocumentInfo_t * pUpdateInfo,
+                                                  const char * pState,
+                                                  size_t stateLength )
+{
+    IotTaskPoolError_t taskPoolStatus = IOT_TASKPOOL_SUCCESS;
+    _shadowCoalescedUpdate_t * pCoalescedUpdate = &( pSubscription->coalescedUpdate );
+
+    /* Copy the state of the first Shadow UPDATE. Later Shadow UPDATEs are merged
+     * into this copy. */
+    pCoalescedUpdate->pState = AwsIotShadow_MallocString( stateLength );
+
+    if( pCoalescedUpdate->pState == NULL )
+    {
+        IotLogError( "Failed to allocate memory for merged Shadow UPDATE of %.*s.",
+                     pSubscription->thingNameLength,
+                     pSubscription->pThingName );
+
+        return AWS_IOT_SHADOW_NO_MEMORY;
+    }
+
+    ( void ) memcpy( pCoalescedUpdate->pState, pState, stateLength );
+    pCoalescedUpdate->stateLength = stateLength;
+
+    /* The client token of the first Shadow UPDATE is shared by all merged
+     * Shadow UPDATEs. Its length was checked by parameter validation. */
+    AwsIotShadow_Assert( pOperation->u.update.clientTokenLength <= MAX_CLIENT_TOKEN_LENGTH );
+
+    ( void ) memcpy( pCoalescedUpdate->pClientToken,
+                     pOperation->u.update.pClientToken,
+                     pOperation->u.update.clientTokenLength );
+    pCoalescedUpdate->clientTokenLength = pOperation->u.update.clientTokenLength;
+
+    /* Publish with the settings of the first Shadow UPDATE. */
+    pCoalescedUpdate->mqttConnection = pOperation->mqttConnection;
+    pCoalescedUpdate->qos = pUpdateInfo->qos;
+    pCoalescedUpdate->retryLimit = pUpdateInfo->retryLimit;
+    pCoalescedUpdate->retryMs = pUpdateInfo->retryMs;
+    pCoalescedUpdate->updateCount = 0;
+
+    /* Schedule the publish job for the end of the window. */
+    taskPoolStatus = IotTaskPool_CreateJob( _publishCoalescedUpdate,
+                                            pSubscription,
+                                            &( pCoalescedUpdate->jobStorage ),
+                                            &( pCoalescedUpdate->job ) );
+
+    if( taskPoolStatus == IOT_TASKPOOL_SUCCESS )
+    {
+        taskPoolStatus = IotTaskPool_ScheduleDeferred( IOT_SYSTEM_TASKPOOL,
+                                                       pCoalescedUpdate->job,
+                                                       AWS_IOT_SHADOW_COALESCE_WINDOW_MS );
+    }
+
+    if( taskPoolStatus != IOT_TASKPOOL_SUCCESS )
+    {
+        IotLogError( "Failed to schedule merged Shadow UPDATE of %.*s, error %s.",
+                     pSubscription->thingNameLength,
+                     pSubscription->pThingName,
+                     IotTaskPool_strerror( taskPoolStatus ) );
+
+        AwsIotShadow_FreeString( pCoalescedUpdate->pState );
+        pCoalescedUpdate->pState = NULL;
+        pCoalescedUpdate->stateLength = 0;
+
+        return AWS_IOT_SHADOW_MQTT_ERROR;
+    }
+
+    pCoalescedUpdate->pending = true;
+    _AwsIotShadowCoalescedJobCount++;
+
+    IotLogDebug( "Holding Shadow UPDATEs of %.*s for %lu ms.",
+                 pSubscription->thingNameLength,
+                 pSubscription->pThingName,
+                 ( unsigned long ) AWS_IOT_SHADOW_COALESCE_WINDOW_MS );
+
+    return AWS_IOT_SHADOW_STATUS_PENDING;
+}
+
+/*-----------------------------------------------------------*/
+
+static AwsIotShadowError_t _mergeCoalescedUpdate( _shadowCoalescedUpdate_t * pCoalescedUpdate,
+                                                  _shadowOperation_t * pOperation,
+                                                  const char * pState,
+                                                  size_t stateLength )
+{
+    char * pMergedState = NULL, * pClientToken = NULL;
+    size_t mergedStateLength = 0;
+    const size_t mergedStateSize = pCoalescedUpdate->stateLength + stateLength + 2;
+
+    pMergedState = AwsIotShadow_MallocString( mergedStateSize );
+
+    if( pMergedState == NULL )
+    {
+        return AWS_IOT_SHADOW_NO_MEMORY;
+    }
+
+    /* The operation's client token is replaced with the shared client token.
+     * Allocate a new buffer if the lengths differ. */
+    if( pOperation->u.update.clientTokenLength != pCoalescedUpdate->clientTokenLength )
+    {
+        pClientToken = AwsIotShadow_MallocString( pCoalescedUpdate->clientTokenLength );
+
+        if( pClientToken == NULL )
+        {
+            AwsIotShadow_FreeString( pMergedState );
+
+            return AWS_IOT_SHADOW_NO_MEMORY;
+        }
+    }
+
+    /* Later values replace earlier ones. Nulls are kept so that the Shadow
+     * service removes those members. */
+    if( _AwsIotShadow_MergeJsonObjects( pCoalescedUpdate->pState,
+                                        pCoalescedUpdate->stateLength,
+                                        pState,
+                                        stateLength,
+                                        false,
+                                        pMergedState,
+                                        mergedStateSize,
+                                        &mergedStateLength ) == false )
+    {
+        IotLogError( "Failed to merge Shadow UPDATE state. The state is not valid JSON." );
+
+        AwsIotShadow_FreeString( pMergedState );
+
+        if( pClientToken != NULL )
+        {
+            AwsIotShadow_FreeString( pClientToken );
+        }
+
+        return AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
+    AwsIotShadow_FreeString( pCoalescedUpdate->pState );
+    pCoalescedUpdate->pState = pMergedState;
+    pCoalescedUpdate->stateLength = mergedStateLength;
+
+    if( pClientToken != NULL )
+    {
+        AwsIotShadow_FreeString( ( void * ) ( pOperation->u.update.pClientToken ) );
+        pOperation->u.update.pClientToken = pClientToken;
+    }
+
+    ( void ) memcpy( ( void * ) pOperation->u.update.pClientToken,
+                     pCoalescedUpdate->pClientToken,
+                     pCoalescedUpdate->clientTokenLength );
+    pOperation->u.update.clientTokenLength = pCoalescedUpdate->clientTokenLength;
+
+    return AWS_IOT_SHADOW_STATUS_PENDING;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _publishCoalescedUpdate( IotTaskPool_t pTaskPool,
+                                     IotTaskPoolJob_t pJob,
+                                     void * pContext )
+{
+    _shadowSubscription_t * pSubscription = ( _shadowSubscription_t * ) pContext;
+    _shadowCoalescedUpdate_t * pCoalescedUpdate = &( pSubscription->coalescedUpdate );
+    AwsIotShadowError_t status = AWS_IOT_SHADOW_STATUS_PENDING;
+    IotMqttError_t publishStatus = IOT_MQTT_STATUS_PENDING;
+    IotMqttConnection_t mqttConnection = IOT_MQTT_CONNECTION_INITIALIZER;
+    IotMqttPublishInfo_t publishInfo = IOT_MQTT_PUBLISH_INFO_INITIALIZER;
+    _operationMatchParams_t param = { .type = _SHADOW_UPDATE };
+    char pTopicName[ SHADOW_TOPIC_TABLE_ENTRY_LENGTH( MAX_THING_NAME_LENGTH ) ] = { 0 };
+    char pClientToken[ MAX_CLIENT_TOKEN_LENGTH ] = { 0 };
+    char * pDocument = NULL;
+    const char * pOperationTopic = NULL;
+    size_t documentLength = 0, updateCount = 0;
+
+    /* Silence warnings about unused parameters. */
+    ( void ) pTaskPool;
+    ( void ) pJob;
+
+    IotMutex_Lock( &_AwsIotShadowSubscriptionsMutex );
+
+    AwsIotShadow_Assert( pCoalescedUpdate->pending == true );
+
+    /* The subscription object was destroyed while this job was waiting for the
+     * mutex, and its pending operations were destroyed with it. Free what the
+     * destroy function left behind and do not publish. */
+    if( pCoalescedUpdate->destroyed == true )
+    {
+        IotLogDebug( "Subscription object for %.*s was destroyed. Merged Shadow "
+                     "UPDATE will not be published.",
+                     pSubscription->thingNameLength,
+                     pSubscription->pThingName );
+
+        AwsIotShadow_FreeString( pCoalescedUpdate->pState );
+        AwsIotShadow_FreeSubscription( pSubscription );
+
+        IotMutex_Unlock( &_AwsIotShadowSubscriptionsMutex );
+
+        _finishCoalescedJob();
+
+        return;
+    }
+
+    /* Copy the operation topic and client token. The subscription object may
+     * be removed once the merged update is no longer held. The Thing Name is
+     * taken from the copied topic. */
+    pOperationTopic = _AwsIotShadow_GetOperationTopic( pSubscription,
+                                                       _SHADOW_UPDATE,
+                                                       &( publishInfo.topicNameLength ) );
+    ( void ) memcpy( pTopicName, pOperationTopic, publishInfo.topicNameLength );
+    publishInfo.pTopicName = pTopicName;
+    param.pThingName = pTopicName + SHADOW_TOPIC_PREFIX_LENGTH;
+    param.thingNameLength = pSubscription->thingNameLength;
+
+    ( void ) memcpy( pClientToken, pCoalescedUpdate->pClientToken, pCoalescedUpdate->clientTokenLength );
+    param.pClientToken = pClientToken;
+    param.clientTokenLength = pCoalescedUpdate->clientTokenLength;
+
+    /* Build the merged update document. */
+    documentLength = COALESCED_DOCUMENT_LENGTH( pCoalescedUpdate->stateLength,
+                                                pCoalescedUpdate->clientTokenLength );
+    pDocument = AwsIotShadow_MallocString( documentLength );
+
+    if( pDocument != NULL )
+    {
+        ( void ) memcpy( pDocument,
+                         COALESCED_DOCUMENT_PREFIX,
+                         COALESCED_DOCUMENT_PREFIX_LENGTH );
+        ( void ) memcpy( pDocument + COALESCED_DOCUMENT_PREFIX_LENGTH,
+                         pCoalescedUpdate->pState,
+                         pCoalescedUpdate->stateLength );
+        ( void ) memcpy( pDocument + COALESCED_DOCUMENT_PREFIX_LENGTH + pCoalescedUpdate->stateLength,
+                         COALESCED_DOCUMENT_CLIENT_TOKEN,
+                         COALESCED_DOCUMENT_CLIENT_TOKEN_LENGTH );
+        ( void ) memcpy( pDocument + documentLength - pCoalescedUpdate->clientTokenLength - 1,
+                         pCoalescedUpdate->pClientToken,
+                         pCoalescedUpdate->clientTokenLength );
+        pDocument[ documentLength - 1 ] = '}';
+    }
+
+    mqttConnection = pCoalescedUpdate->mqttConnection;
+    publishInfo.qos = pCoalescedUpdate->qos;
+    publishInfo.retryLimit = pCoalescedUpdate->retryLimit;
+    publishInfo.retryMs = pCoalescedUpdate->retryMs;
+    updateCount = pCoalescedUpdate->updateCount;
+
+    /* Release the merged update. Shadow UPDATEs made from now on start a new
+     * merged update. */
+    AwsIotShadow_FreeString( pCoalescedUpdate->pState );
+    pCoalescedUpdate->pState = NULL;
+    pCoalescedUpdate->stateLength = 0;
+    pCoalescedUpdate->clientTokenLength = 0;
+    pCoalescedUpdate->updateCount = 0;
+    pCoalescedUpdate->pending = false;
+
+    /* Check if the subscription object should be removed. This also destroys
+     * this job's storage, which must not be used after this point. */
+    _AwsIotShadow_RemoveSubscription( pSubscription, NULL );
+
+    IotMutex_Unlock( &_AwsIotShadowSubscriptionsMutex );
+
+    IotLogInfo( "Publishing %lu merged Shadow UPDATEs of %.*s.",
+                ( unsigned long ) updateCount,
+                param.thingNameLength,
+                param.pThingName );
+
+    if( pDocument == NULL )
+    {
+        IotLogError( "Failed to allocate memory for merged Shadow UPDATE document." );
+
+        status = AWS_IOT_SHADOW_NO_MEMORY;
+    }
+    else
+    {
+        publishInfo.pPayload = pDocument;
+        publishInfo.payloadLength = documentLength;
+
+        /* This job runs in the system task pool, so it must not block waiting
+         * for a PUBACK. The Shadow response completes the merged operations. */
+        publishStatus = IotMqtt_Publish( mqttConnection,
+                                         &publishInfo,
+                                         0,
+                                         NULL,
+                                         NULL );
+
+        if( ( publishStatus != IOT_MQTT_SUCCESS ) &&
+            ( publishStatus != IOT_MQTT_STATUS_PENDING ) )
+        {
+            IotLogError( "Failed to publish MQTT message to UPDATE %.*s Shadow, error %s.",
+                         param.thingNameLength,
+                         param.pThingName,
+                         IotMqtt_strerror( publishStatus ) );
+
+            /* Convert the MQTT "NO MEMORY" error to a Shadow "NO MEMORY" error. */
+            if( publishStatus == IOT_MQTT_NO_MEMORY )
+            {
+                status = AWS_IOT_SHADOW_NO_MEMORY;
+            }
+            else
+            {
+                status = AWS_IOT_SHADOW_MQTT_ERROR;
+            }
+        }
+        else
+        {
+            IotLogDebug( "Merged Shadow UPDATE PUBLISH message successfully sent." );
+        }
+    }
+
+    /* No response will arrive for a merged update that was not published.
+     * Complete all merged operations with the error. */
+    if( status != AWS_IOT_SHADOW_STATUS_PENDING )
+    {
+        ( void ) _completeOperations( &param, _UNKNOWN_STATUS, NULL, status );
+    }
+
+    if( pDocument != NULL )
+    {
+        AwsIotShadow_FreeString( pDocument );
+    }
+
+    _finishCoalescedJob();
+}
+
+/*-----------------------------------------------------------*/
+
+static void _finishCoalescedJob( void )
+{
+    bool wakeCleanup = false;
+
+    IotMutex_Lock( &_AwsIotShadowSubscriptionsMutex );
+
+    AwsIotShadow_Assert( _AwsIotShadowCoalescedJobCount > 0 );
+    _AwsIotShadowCoalescedJobCount--;
+
+    wakeCleanup = ( _AwsIotShadowCoalescedJobCount == 0 ) && ( _cleanupWaiting == true );
+
+    IotMutex_Unlock( &_AwsIotShadowSubscriptionsMutex );
+
+    /* Cleanup waits for this post, so the semaphore is still valid. The Shadow
+     * mutexes must not be used after it. */
+    if( wakeCleanup == true )
+    {
+        IotSemaphore_Post( &_AwsIotShadowCoalescedJobsDone );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+AwsIotShadowError_t _AwsIotShadow_CoalesceUpdate( IotMqttConnection_t mqttConnection,
+                                                  _shadowOperation_t * pOperation,
+                                                  const AwsIotShadowDocumentInfo_t * pUpdateInfo )
+{
+    _shadowSubscription_t * pSubscription = NULL;
+    AwsIotShadowError_t status = AWS_IOT_SHADOW_STATUS_PENDING;
+    const char * pState = NULL;
+    size_t stateLength = 0;
+
+    /* Parameter validation checked that the update document has a state object. */
+    ( void ) _AwsIotShadow_FindJsonMember( pUpdateInfo->u.update.pUpdateDocument,
+                                           pUpdateInfo->u.update.updateDocumentLength,
+                                           STATE_KEY,
+                                           STATE_KEY_LENGTH,
+                                           &pState,
+                                           &stateLength );
+    AwsIotShadow_Assert( pState != NULL );
+
+    IotLogDebug( "Merging Shadow UPDATE for Thing %.*s.",
+                 pUpdateInfo->thingNameLength,
+                 pUpdateInfo->pThingName );
+
+    /* Set the operation's MQTT connection. */
+    pOperation->mqttConnection = mqttConnection;
+
+    /* Lock the subscription list mutex for exclusive access. */
+    IotMutex_Lock( &_AwsIotShadowSubscriptionsMutex );
+
+    /* Check for an existing subscription. This function will attempt to allocate
+     * a new subscription if not found. */
+    pSubscription = _AwsIotShadow_FindSubscription( pUpdateInfo->pThingName,
+                                                    pUpdateInfo->thingNameLength );
+
+    if( pSubscription == NULL )
+    {
+        /* No existing subscription was found, and no new subscription could be
+         * allocated. */
+        status = AWS_IOT_SHADOW_NO_MEMORY;
+    }
+    else
     {
-        AwsIotShadow_FreeString( pTopicBuffer );
+        /* Set the subscription object for the Shadow operation. */
+        pOperation->pSubscription = pSubscription;
+
+        /* Every merged operation holds its own reference to the Shadow UPDATE
+         * subscriptions, so that they remain until the last one completes. */
+        status = _AwsIotShadow_IncrementReferences( pOperation,
+                                                    _updateCallback );
+
+        if( status == AWS_IOT_SHADOW_STATUS_PENDING )
+        {
+            /* Start a new merged update or merge into the held one. */
+            if( pSubscription->coalescedUpdate.pending == false )
+            {
+                status = _startCoalescedUpdate( pSubscription,
+                                                pOperation,
+                                                pUpdateInfo,
+                                                pState,
+                                                stateLength );
+            }
+            else
+            {
+                status = _mergeCoalescedUpdate( &( pSubscription->coalescedUpdate ),
+                                                pOperation,
+                                                pState,
+                                                stateLength );
+            }
+
+            if( status == AWS_IOT_SHADOW_STATUS_PENDING )
+            {
+                ( pSubscription->coalescedUpdate.updateCount )++;
+
+                /* Add the Shadow operation to the pending operations list before
+                 * the subscription list mutex is released, so that the merged
+                 * update cannot be published before this operation is pending. */
+                IotMutex_Lock( &( _AwsIotShadowPendingOperationsMutex ) );
+                IotListDouble_InsertHead( &( _AwsIotShadowPendingOperations ),
+                                          &( pOperation->link ) );
+                IotMutex_Unlock( &( _AwsIotShadowPendingOperationsMutex ) );
+            }
+            else if( ( pOperation->flags & AWS_IOT_SHADOW_FLAG_KEEP_SUBSCRIPTIONS ) == 0 )
+            {
+                /* Release the reference added for this operation. This also
+                 * checks if the subscription should be deleted. */
+                _AwsIotShadow_DecrementReferences( pOperation,
+                                                   NULL );
+            }
+            else
+            {
+                /* Persistent subscriptions are kept. */
+            }
+        }
+        else
+        {
+            /* Failed to add subscriptions for a Shadow operation. The reference
+             * count was not incremented. Check if this subscription should be
+             * deleted. */
+            _AwsIotShadow_RemoveSubscription( pSubscription, NULL );
+        }
     }
 
+    /* Unlock the Shadow subscription list mutex. */
+    IotMutex_Unlock( &_AwsIotShadowSubscriptionsMutex );
+
     /* Destroy the Shadow operation on failure. */
     if( status != AWS_IOT_SHADOW_STATUS_PENDING )
     {
@@ -821,6 +1410,29 @@ AwsIotShadowError_t _AwsIotShadow_ProcessOperation( IotMqttConnection_t mqttConn
 
 /*-----------------------------------------------------------*/
 
+void _AwsIotShadow_WaitForCoalescedUpdates( void )
+{
+    uint32_t jobCount = 0;
+
+    IotMutex_Lock( &_AwsIotShadowSubscriptionsMutex );
+
+    jobCount = _AwsIotShadowCoalescedJobCount;
+    _cleanupWaiting = ( jobCount > 0 );
+
+    IotMutex_Unlock( &_AwsIotShadowSubscriptionsMutex );
+
+    if( jobCount > 0 )
+    {
+        IotLogDebug( "Waiting for %lu merged Shadow UPDATE publish jobs to finish.",
+                     ( unsigned long ) jobCount );
+
+        IotSemaphore_Wait( &_AwsIotShadowCoalescedJobsDone );
+        _cleanupWaiting = false;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 void _AwsIotShadow_Notify( _shadowOperation_t * pOperation )
 {
     AwsIotShadowCallbackParam_t callbackParam = { .callbackType = ( AwsIotShadowCallbackType_t ) 0 };
@@ -839,7 +1451,6 @@ void _AwsIotShadow_Notify( _shadowOperation_t * pOperation )
      * count reaches 0. */
     IotMutex_Lock( &_AwsIotShadowSubscriptionsMutex );
     _AwsIotShadow_DecrementReferences( pOperation,
-                                       pSubscription->pTopicBuffer,
                                        &pRemovedSubscription );
     IotMutex_Unlock( &_AwsIotShadowSubscriptionsMutex );
 
@@ -74,6 +74,41 @@
         SHADOW_ACCEPTED_SUFFIX_LENGTH :                                 \
         SHADOW_REJECTED_SUFFIX_LENGTH ) )
 
+/**
+ * @brief Check if a JSON value is the literal `null`.
+ */
+#define JSON_VALUE_IS_NULL( pValue, valueLength ) \
+    ( ( ( valueLength ) == 4 ) && ( strncmp( ( pValue ), "null", 4 ) == 0 ) )
+
+/**
+ * @brief Check if a JSON value is an object.
+ */
+#define JSON_VALUE_IS_OBJECT( pValue, valueLength ) \
+    ( ( ( valueLength ) > 0 ) && ( ( pValue )[ 0 ] == '{' ) )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Results of searching for the next member of a JSON object.
+ */
+typedef enum _jsonMemberStatus
+{
+    _JSON_MEMBER_FOUND = 0, /**< A key-value pair was found. */
+    _JSON_OBJECT_END = 1,   /**< The closing brace of the object was reached. */
+    _JSON_MALFORMED = 2     /**< The JSON object could not be parsed. */
+} _jsonMemberStatus_t;
+
+/**
+ * @brief Output buffer used when generating a JSON object.
+ */
+typedef struct _jsonWriter
+{
+    char * pBuffer;    /**< @brief Buffer for the generated JSON. */
+    size_t bufferSize; /**< @brief Size of `pBuffer`. */
+    size_t length;     /**< @brief Number of bytes written to `pBuffer`. */
+    bool error;        /**< @brief Set if `pBuffer` was too small or an input was malformed. */
+} _jsonWriter_t;
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -86,6 +121,155 @@
  */
 static AwsIotShadowError_t _codeToShadowStatus( uint32_t code );
 
+/**
+ * @brief Skip JSON whitespace.
+ *
+ * @param[in] pJson The JSON text.
+ * @param[in] jsonLength The length of `pJson`.
+ * @param[in] index Where to start skipping whitespace.
+ *
+ * @return The index of the first non-whitespace character at or after `index`.
+ */
+static size_t _skipWhitespace( const char * pJson,
+                               size_t jsonLength,
+                               size_t index );
+
+/**
+ * @brief Skip a JSON string, including its quotes.
+ *
+ * @param[in] pJson The JSON text.
+ * @param[in] jsonLength The length of `pJson`.
+ * @param[in,out] pIndex Index of the opening quote; set to the index after the
+ * closing quote on success.
+ *
+ * @return `true` if the string was terminated; `false` otherwise.
+ */
+static bool _skipJsonString( const char * pJson,
+                             size_t jsonLength,
+                             size_t * pIndex );
+
+/**
+ * @brief Skip any JSON value (string, object, array, or primitive).
+ *
+ * @param[in] pJson The JSON text.
+ * @param[in] jsonLength The length of `pJson`.
+ * @param[in,out] pIndex Index of the first character of the value; set to the
+ * index after the value on success.
+ *
+ * @return `true` if a complete value was skipped; `false` otherwise.
+ */
+static bool _skipJsonValue( const char * pJson,
+                            size_t jsonLength,
+                            size_t * pIndex );
+
+/**
+ * @brief Find the opening brace of a JSON object.
+ *
+ * @param[in] pObject The JSON object. May be `NULL`.
+ * @param[in] objectLength The length of `pObject`.
+ * @param[out] pIndex Set to the index after the opening brace.
+ *
+ * @return `true` if `pObject` starts with a JSON object; `false` otherwise.
+ */
+static bool _openJsonObject( const char * pObject,
+                             size_t objectLength,
+                             size_t * pIndex );
+
+/**
+ * @brief Read the next top-level member of a JSON object.
+ *
+ * @param[in] pObject The JSON object.
+ * @param[in] objectLength The length of `pObject`.
+ * @param[in,out] pIndex Where to start reading; updated to the index after the
+ * member that was read.
+ * @param[out] pKey Set to the key of the member, excluding its quotes.
+ * @param[out] pKeyLength Set to the length of `pKey`.
+ * @param[out] pValue Set to the value of the member.
+ * @param[out] pValueLength Set to the length of `pValue`.
+ *
+ * @return Any #_jsonMemberStatus_t.
+ */
+static _jsonMemberStatus_t _nextJsonMember( const char * pObject,
+                                            size_t objectLength,
+                                            size_t * pIndex,
+                                            const char ** pKey,
+                                            size_t * pKeyLength,
+                                            const char ** pValue,
+                                            size_t * pValueLength );
+
+/**
+ * @brief Append text to a JSON writer.
+ *
+ * @param[in] pWriter The JSON writer.
+ * @param[in] pData Text to append.
+ * @param[in] dataLength The length of `pData`.
+ */
+static void _writeJson( _jsonWriter_t * pWriter,
+                        const char * pData,
+                        size_t dataLength );
+
+/**
+ * @brief Append a member to the JSON object in a JSON writer.
+ *
+ * @param[in] pWriter The JSON writer.
+ * @param[in,out] pMemberCount Number of members already written to the object.
+ * @param[in] pKey Key of the member, excluding its quotes.
+ * @param[in] keyLength The length of `pKey`.
+ * @param[in] pValue Value of the member. Pass `NULL` to write only the key and
+ * colon, so that the value may be generated by the caller.
+ * @param[in] valueLength The length of `pValue`.
+ */
+static void _writeJsonMember( _jsonWriter_t * pWriter,
+                              size_t * pMemberCount,
+                              const char * pKey,
+                              size_t keyLength,
+                              const char * pValue,
+                              size_t valueLength );
+
+/**
+ * @brief Write the recursive merge of two JSON objects to a JSON writer.
+ *
+ * @param[in] pWriter The JSON writer.
+ * @param[in] pBase The JSON object to merge into.
+ * @param[in] baseLength The length of `pBase`.
+ * @param[in] pPatch The JSON object to merge.
+ * @param[in] patchLength The length of `pPatch`.
+ * @param[in] removeNulls Whether `null` values in `pPatch` remove members.
+ * @param[in] depth How many more levels of nested objects may be merged.
+ */
+static void _mergeJsonObjects( _jsonWriter_t * pWriter,
+                               const char * pBase,
+                               size_t baseLength,
+                               const char * pPatch,
+                               size_t patchLength,
+                               bool removeNulls,
+                               uint32_t depth );
+
+/**
+ * @brief Write the members of a JSON object that differ from another JSON
+ * object to a JSON writer.
+ *
+ * @param[in] pWriter The JSON writer.
+ * @param[in] pBase The JSON object to compare against.
+ * @param[in] baseLength The length of `pBase`.
+ * @param[in] pNew The JSON object to compare.
+ * @param[in] newLength The length of `pNew`.
+ * @param[in] depth How many more levels of nested objects may be compared.
+ */
+static void _diffJsonObjects( _jsonWriter_t * pWriter,
+                              const char * pBase,
+                              size_t baseLength,
+                              const char * pNew,
+                              size_t newLength,
+                              uint32_t depth );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief An empty JSON object, used in place of an absent base object.
+ */
+static const char _pEmptyJsonObject[] = "{}";
+
 /*-----------------------------------------------------------*/
 
 static AwsIotShadowError_t _codeToShadowStatus( uint32_t code )
@@ -137,6 +321,494 @@ static AwsIotShadowError_t _codeToShadowStatus( uint32_t code )
 
 /*-----------------------------------------------------------*/
 
+static size_t _skipWhitespace( const char * pJson,
+                               size_t jsonLength,
+                               size_t index )
+{
+    while( ( index < jsonLength ) &&
+           ( ( pJson[ index ] == ' ' ) ||
+             ( pJson[ index ] == '\t' ) ||
+             ( pJson[ index ] == '\r' ) ||
+             ( pJson[ index ] == '\n' ) ) )
+    {
+        index++;
+    }
+
+    return index;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _skipJsonString( const char * pJson,
+                             size_t jsonLength,
+                             size_t * pIndex )
+{
+    /* Skip the opening quote. */
+    size_t index = *pIndex + 1;
+
+    while( index < jsonLength )
+    {
+        if( pJson[ index ] == '\\' )
+        {
+            /* Skip the escaped character. */
+            index += 2;
+        }
+        else if( pJson[ index ] == '"' )
+        {
+            *pIndex = index + 1;
+
+            return true;
+        }
+        else
+        {
+            index++;
+        }
+    }
+
+    return false;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _skipJsonValue( const char * pJson,
+                            size_t jsonLength,
+                            size_t * pIndex )
+{
+    size_t index = *pIndex;
+    uint32_t depth = 0;
+
+    if( index >= jsonLength )
+    {
+        return false;
+    }
+
+    switch( pJson[ index ] )
+    {
+        case '"':
+
+            return _skipJsonString( pJson, jsonLength, pIndex );
+
+        case '{':
+        case '[':
+
+            /* Find the matching closing bracket, ignoring any brackets in strings. */
+            while( index < jsonLength )
+            {
+                if( pJson[ index ] == '"' )
+                {
+                    if( _skipJsonString( pJson, jsonLength, &index ) == false )
+                    {
+                        return false;
+                    }
+
+                    continue;
+                }
+
+                if( ( pJson[ index ] == '{' ) || ( pJson[ index ] == '[' ) )
+                {
+                    depth++;
+                }
+                else if( ( pJson[ index ] == '}' ) || ( pJson[ index ] == ']' ) )
+                {
+                    depth--;
+
+                    if( depth == 0 )
+                    {
+                        *pIndex = index + 1;
+
+                        return true;
+                    }
+                }
+
+                index++;
+            }
+
+            return false;
+
+        default:
+
+            /* Numbers, true, false, and null end at a delimiter or whitespace. */
+            while( ( index < jsonLength ) &&
+                   ( pJson[ index ] != ',' ) &&
+                   ( pJson[ index ] != '}' ) &&
+                   ( pJson[ index ] != ']' ) &&
+                   ( pJson[ index ] != ' ' ) &&
+                   ( pJson[ index ] != '\t' ) &&
+                   ( pJson[ index ] != '\r' ) &&
+                   ( pJson[ index ] != '\n' ) )
+            {
+                index++;
+            }
+
+            if( index == *pIndex )
+            {
+                return false;
+            }
+
+            *pIndex = index;
+
+            return true;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _openJsonObject( const char * pObject,
+                             size_t objectLength,
+                             size_t * pIndex )
+{
+    size_t index = 0;
+
+    if( pObject == NULL )
+    {
+        return false;
+    }
+
+    index = _skipWhitespace( pObject, objectLength, 0 );
+
+    if( ( index >= objectLength ) || ( pObject[ index ] != '{' ) )
+    {
+        return false;
+    }
+
+    *pIndex = index + 1;
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+static _jsonMemberStatus_t _nextJsonMember( const char * pObject,
+                                            size_t objectLength,
+                                            size_t * pIndex,
+                                            const char ** pKey,
+                                            size_t * pKeyLength,
+                                            const char ** pValue,
+                                            size_t * pValueLength )
+{
+    size_t index = _skipWhitespace( pObject, objectLength, *pIndex ), start = 0;
+
+    if( index >= objectLength )
+    {
+        return _JSON_MALFORMED;
+    }
+
+    if( pObject[ index ] == '}' )
+    {
+        *pIndex = index + 1;
+
+        return _JSON_OBJECT_END;
+    }
+
+    /* Read the key. */
+    if( ( index >= objectLength ) || ( pObject[ index ] != '"' ) )
+    {
+        return _JSON_MALFORMED;
+    }
+
+    start = index;
+
+    if( _skipJsonString( pObject, objectLength, &index ) == false )
+    {
+        return _JSON_MALFORMED;
+    }
+
+    *pKey = pObject + start + 1;
+    *pKeyLength = index - start - 2;
+
+    /* A colon separates the key and value. */
+    index = _skipWhitespace( pObject, objectLength, index );
+
+    if( ( index >= objectLength ) || ( pObject[ index ] != ':' ) )
+    {
+        return _JSON_MALFORMED;
+    }
+
+    /* Read the value. */
+    index = _skipWhitespace( pObject, objectLength, index + 1 );
+    start = index;
+
+    if( _skipJsonValue( pObject, objectLength, &index ) == false )
+    {
+        return _JSON_MALFORMED;
+    }
+
+    *pValue = pObject + start;
+    *pValueLength = index - start;
+
+    /* A member is followed by the closing brace, or by a comma and another member. */
+    index = _skipWhitespace( pObject, objectLength, index );
+
+    if( ( index < objectLength ) && ( pObject[ index ] == ',' ) )
+    {
+        index = _skipWhitespace( pObject, objectLength, index + 1 );
+
+        if( ( index >= objectLength ) || ( pObject[ index ] != '"' ) )
+        {
+            return _JSON_MALFORMED;
+        }
+    }
+    else if( ( index >= objectLength ) || ( pObject[ index ] != '}' ) )
+    {
+        return _JSON_MALFORMED;
+    }
+
+    *pIndex = index;
+
+    return _JSON_MEMBER_FOUND;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _writeJson( _jsonWriter_t * pWriter,
+                        const char * pData,
+                        size_t dataLength )
+{
+    if( pWriter->error == true )
+    {
+        return;
+    }
+
+    if( dataLength > pWriter->bufferSize - pWriter->length )
+    {
+        pWriter->error = true;
+
+        return;
+    }
+
+    ( void ) memcpy( pWriter->pBuffer + pWriter->length, pData, dataLength );
+    pWriter->length += dataLength;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _writeJsonMember( _jsonWriter_t * pWriter,
+                              size_t * pMemberCount,
+                              const char * pKey,
+                              size_t keyLength,
+                              const char * pValue,
+                              size_t valueLength )
+{
+    if( *pMemberCount > 0 )
+    {
+        _writeJson( pWriter, ",", 1 );
+    }
+
+    _writeJson( pWriter, "\"", 1 );
+    _writeJson( pWriter, pKey, keyLength );
+    _writeJson( pWriter, "\":", 2 );
+
+    if( pValue != NULL )
+    {
+        _writeJson( pWriter, pValue, valueLength );
+    }
+
+    ( *pMemberCount )++;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _mergeJsonObjects( _jsonWriter_t * pWriter,
+                               const char * pBase,
+                               size_t baseLength,
+                               const char * pPatch,
+                               size_t patchLength,
+                               bool removeNulls,
+                               uint32_t depth )
+{
+    size_t index = 0, memberCount = 0, keyLength = 0, valueLength = 0, patchValueLength = 0;
+    const char * pKey = NULL, * pValue = NULL, * pPatchValue = NULL;
+    _jsonMemberStatus_t status = _JSON_MEMBER_FOUND;
+
+    /* Documents nested deeper than the limit are rejected rather than
+     * exhausting the stack. */
+    if( depth == 0U )
+    {
+        IotLogDebug( "JSON objects are nested deeper than %lu levels.",
+                     ( unsigned long ) AWS_IOT_SHADOW_MAX_JSON_DEPTH );
+        pWriter->error = true;
+
+        return;
+    }
+
+    _writeJson( pWriter, "{", 1 );
+
+    /* Copy the members of the base object, replacing those present in the patch. */
+    if( _openJsonObject( pBase, baseLength, &index ) == false )
+    {
+        pWriter->error = true;
+
+        return;
+    }
+
+    while( ( pWriter->error == false ) &&
+           ( ( status = _nextJsonMember( pBase, baseLength, &index, &pKey, &keyLength,
+                                         &pValue, &valueLength ) ) == _JSON_MEMBER_FOUND ) )
+    {
+        if( _AwsIotShadow_FindJsonMember( pPatch,
+                                          patchLength,
+                                          pKey,
+                                          keyLength,
+                                          &pPatchValue,
+                                          &patchValueLength ) == false )
+        {
+            /* Member is not in the patch; keep it. */
+            _writeJsonMember( pWriter, &memberCount, pKey, keyLength, pValue, valueLength );
+        }
+        else if( ( removeNulls == true ) && JSON_VALUE_IS_NULL( pPatchValue, patchValueLength ) )
+        {
+            /* A null in the patch removes the member. */
+        }
+        else if( JSON_VALUE_IS_OBJECT( pValue, valueLength ) &&
+                 JSON_VALUE_IS_OBJECT( pPatchValue, patchValueLength ) )
+        {
+            /* Both values are objects; merge them. */
+            _writeJsonMember( pWriter, &memberCount, pKey, keyLength, NULL, 0 );
+            _mergeJsonObjects( pWriter, pValue, valueLength, pPatchValue, patchValueLength, removeNulls, depth - 1U );
+        }
+        else
+        {
+            /* Replace the member with the value from the patch. */
+            _writeJsonMember( pWriter, &memberCount, pKey, keyLength, pPatchValue, patchValueLength );
+        }
+    }
+
+    if( status == _JSON_MALFORMED )
+    {
+        pWriter->error = true;
+    }
+
+    /* Add the members of the patch that are not in the base object. */
+    status = _JSON_MEMBER_FOUND;
+
+    if( _openJsonObject( pPatch, patchLength, &index ) == false )
+    {
+        pWriter->error = true;
+
+        return;
+    }
+
+    while( ( pWriter->error == false ) &&
+           ( ( status = _nextJsonMember( pPatch, patchLength, &index, &pKey, &keyLength,
+                                         &pPatchValue, &patchValueLength ) ) == _JSON_MEMBER_FOUND ) )
+    {
+        if( ( ( removeNulls == false ) || ( JSON_VALUE_IS_NULL( pPatchValue, patchValueLength ) == false ) ) &&
+            ( _AwsIotShadow_FindJsonMember( pBase,
+                                            baseLength,
+                                            pKey,
+                                            keyLength,
+                                            &pValue,
+                                            &valueLength ) == false ) )
+        {
+            if( ( removeNulls == true ) && JSON_VALUE_IS_OBJECT( pPatchValue, patchValueLength ) )
+            {
+                /* Merge into an empty object to drop any nested nulls. */
+                _writeJsonMember( pWriter, &memberCount, pKey, keyLength, NULL, 0 );
+                _mergeJsonObjects( pWriter,
+                                   _pEmptyJsonObject,
+                                   sizeof( _pEmptyJsonObject ) - 1,
+                                   pPatchValue,
+                                   patchValueLength,
+                                   true,
+                                   depth - 1U );
+            }
+            else
+            {
+                _writeJsonMember( pWriter, &memberCount, pKey, keyLength, pPatchValue, patchValueLength );
+            }
+        }
+    }
+
+    if( status == _JSON_MALFORMED )
+    {
+        pWriter->error = true;
+    }
+
+    _writeJson( pWriter, "}", 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void _diffJsonObjects( _jsonWriter_t * pWriter,
+                              const char * pBase,
+                              size_t baseLength,
+                              const char * pNew,
+                              size_t newLength,
+                              uint32_t depth )
+{
+    size_t index = 0, memberCount = 0, keyLength = 0, valueLength = 0, baseValueLength = 0;
+    size_t savedLength = 0, nestedStart = 0;
+    const char * pKey = NULL, * pValue = NULL, * pBaseValue = NULL;
+    _jsonMemberStatus_t status = _JSON_MEMBER_FOUND;
+
+    if( depth == 0U )
+    {
+        IotLogDebug( "JSON objects are nested deeper than %lu levels.",
+                     ( unsigned long ) AWS_IOT_SHADOW_MAX_JSON_DEPTH );
+        pWriter->error = true;
+
+        return;
+    }
+
+    _writeJson( pWriter, "{", 1 );
+
+    if( _openJsonObject( pNew, newLength, &index ) == false )
+    {
+        pWriter->error = true;
+
+        return;
+    }
+
+    while( ( pWriter->error == false ) &&
+           ( ( status = _nextJsonMember( pNew, newLength, &index, &pKey, &keyLength,
+                                         &pValue, &valueLength ) ) == _JSON_MEMBER_FOUND ) )
+    {
+        if( _AwsIotShadow_FindJsonMember( pBase,
+                                          baseLength,
+                                          pKey,
+                                          keyLength,
+                                          &pBaseValue,
+                                          &baseValueLength ) == false )
+        {
+            /* A new member is part of the difference, unless it removes a
+             * member that is already absent. */
+            if( JSON_VALUE_IS_NULL( pValue, valueLength ) == false )
+            {
+                _writeJsonMember( pWriter, &memberCount, pKey, keyLength, pValue, valueLength );
+            }
+        }
+        else if( JSON_VALUE_IS_OBJECT( pValue, valueLength ) &&
+                 JSON_VALUE_IS_OBJECT( pBaseValue, baseValueLength ) )
+        {
+            /* Compare nested objects, and drop the member if nothing in it changed. */
+            savedLength = pWriter->length;
+            _writeJsonMember( pWriter, &memberCount, pKey, keyLength, NULL, 0 );
+            nestedStart = pWriter->length;
+            _diffJsonObjects( pWriter, pBaseValue, baseValueLength, pValue, valueLength, depth - 1U );
+
+            if( ( pWriter->error == false ) && ( pWriter->length - nestedStart == 2 ) )
+            {
+                pWriter->length = savedLength;
+                memberCount--;
+            }
+        }
+        else if( ( valueLength != baseValueLength ) ||
+                 ( strncmp( pValue, pBaseValue, valueLength ) != 0 ) )
+        {
+            _writeJsonMember( pWriter, &memberCount, pKey, keyLength, pValue, valueLength );
+        }
+    }
+
+    if( status == _JSON_MALFORMED )
+    {
+        pWriter->error = true;
+    }
+
+    _writeJson( pWriter, "}", 1 );
+}
+
+/*-----------------------------------------------------------*/
+
 _shadowOperationStatus_t _AwsIotShadow_ParseShadowStatus( const char * pTopicName,
                                                           size_t topicNameLength )
 {
@@ -295,3 +967,108 @@ AwsIotShadowError_t _AwsIotShadow_ParseThingName( const char * pTopicName,
 }
 
 /*-----------------------------------------------------------*/
+
+bool _AwsIotShadow_FindJsonMember( const char * pObject,
+                                   size_t objectLength,
+                                   const char * pKey,
+                                   size_t keyLength,
+                                   const char ** pValue,
+                                   size_t * pValueLength )
+{
+    size_t index = 0, memberKeyLength = 0, memberValueLength = 0;
+    const char * pMemberKey = NULL, * pMemberValue = NULL;
+
+    if( _openJsonObject( pObject, objectLength, &index ) == false )
+    {
+        return false;
+    }
+
+    /* Only top-level members are compared; nested objects are skipped whole. */
+    while( _nextJsonMember( pObject,
+                            objectLength,
+                            &index,
+                            &pMemberKey,
+                            &memberKeyLength,
+                            &pMemberValue,
+                            &memberValueLength ) == _JSON_MEMBER_FOUND )
+    {
+        if( ( memberKeyLength == keyLength ) &&
+            ( strncmp( pMemberKey, pKey, keyLength ) == 0 ) )
+        {
+            *pValue = pMemberValue;
+            *pValueLength = memberValueLength;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*-----------------------------------------------------------*/
+
+bool _AwsIotShadow_MergeJsonObjects( const char * pBase,
+                                     size_t baseLength,
+                                     const char * pPatch,
+                                     size_t patchLength,
+                                     bool removeNulls,
+                                     char * pOutput,
+                                     size_t outputSize,
+                                     size_t * pOutputLength )
+{
+    _jsonWriter_t writer = { .pBuffer = pOutput, .bufferSize = outputSize };
+
+    /* An absent base is treated as an empty object. */
+    if( pBase == NULL )
+    {
+        pBase = _pEmptyJsonObject;
+        baseLength = sizeof( _pEmptyJsonObject ) - 1;
+    }
+
+    _mergeJsonObjects( &writer,
+                       pBase,
+                       baseLength,
+                       pPatch,
+                       patchLength,
+                       removeNulls,
+                       AWS_IOT_SHADOW_MAX_JSON_DEPTH );
+
+    if( writer.error == true )
+    {
+        IotLogDebug( "Failed to merge JSON objects; input malformed or output buffer too small." );
+
+        return false;
+    }
+
+    *pOutputLength = writer.length;
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+bool _AwsIotShadow_DiffJsonObjects( const char * pBase,
+                                    size_t baseLength,
+                                    const char * pNew,
+                                    size_t newLength,
+                                    char * pOutput,
+                                    size_t outputSize,
+                                    size_t * pOutputLength )
+{
+    _jsonWriter_t writer = { .pBuffer = pOutput, .bufferSize = outputSize };
+
+    _diffJsonObjects( &writer, pBase, baseLength, pNew, newLength, AWS_IOT_SHADOW_MAX_JSON_DEPTH );
+
+    if( writer.error == true )
+    {
+        IotLogDebug( "Failed to diff JSON objects; input malformed or output buffer too small." );
+
+        return false;
+    }
+
+    *pOutputLength = writer.length;
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
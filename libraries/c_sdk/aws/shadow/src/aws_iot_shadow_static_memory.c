@@ -72,11 +72,11 @@
 /**
  * @brief The size of a static memory Shadow subscription.
  *
- * Since the pThingName member of #_shadowSubscription_t is variable-length,
- * the constant #MAX_THING_NAME_LENGTH is used for the length of
- * #_shadowSubscription_t.pThingName.
+ * Since the pTopicTable member of #_shadowSubscription_t is variable-length,
+ * the constant #MAX_THING_NAME_LENGTH is used to size
+ * #_shadowSubscription_t.pTopicTable.
  */
-    #define SHADOW_SUBSCRIPTION_SIZE    ( sizeof( _shadowSubscription_t ) + MAX_THING_NAME_LENGTH )
+    #define SHADOW_SUBSCRIPTION_SIZE    ( sizeof( _shadowSubscription_t ) + SHADOW_TOPIC_TABLE_LENGTH( MAX_THING_NAME_LENGTH ) )
 
 /*-----------------------------------------------------------*/
 
@@ -33,6 +33,8 @@
 #include "iot_config.h"
 
 /* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* Shadow internal include. */
@@ -44,6 +46,57 @@
 /* MQTT include. */
 #include "iot_mqtt.h"
 
+/* Task pool include. */
+#include "iot_taskpool.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The JSON key for the desired state in a Shadow document.
+ */
+#define DESIRED_KEY                 "desired"
+
+/**
+ * @brief The length of #DESIRED_KEY.
+ */
+#define DESIRED_KEY_LENGTH          ( sizeof( DESIRED_KEY ) - 1 )
+
+/**
+ * @brief The JSON key for the reported state in a Shadow document.
+ */
+#define REPORTED_KEY                "reported"
+
+/**
+ * @brief The length of #REPORTED_KEY.
+ */
+#define REPORTED_KEY_LENGTH         ( sizeof( REPORTED_KEY ) - 1 )
+
+/**
+ * @brief The JSON key for the current Shadow document in a Shadow documents
+ * topic message.
+ */
+#define CURRENT_KEY                 "current"
+
+/**
+ * @brief The length of #CURRENT_KEY.
+ */
+#define CURRENT_KEY_LENGTH          ( sizeof( CURRENT_KEY ) - 1 )
+
+/**
+ * @brief Format of the document written by @ref shadow_function_getcacheddocument.
+ */
+#define CACHED_DOCUMENT_FORMAT      "{\"state\":{\"desired\":%.*s,\"reported\":%.*s},\"version\":%lu}"
+
+/**
+ * @brief An empty JSON object, used for an absent section of a document cache.
+ */
+#define EMPTY_JSON_OBJECT           "{}"
+
+/**
+ * @brief The length of #EMPTY_JSON_OBJECT.
+ */
+#define EMPTY_JSON_OBJECT_LENGTH    ( sizeof( EMPTY_JSON_OBJECT ) - 1 )
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -88,6 +141,65 @@ static AwsIotShadowError_t _modifyOperationSubscriptions( IotMqttConnection_t mq
                                                           _mqttCallbackFunction_t callback,
                                                           _mqttOperationFunction_t mqttOperation );
 
+/**
+ * @brief Replace a section of a document cache.
+ *
+ * @param[in,out] pSection The cached section to replace.
+ * @param[in,out] pSectionLength The length of `*pSection`.
+ * @param[in] pValue The new section. If not a JSON object, the section is
+ * cleared.
+ * @param[in] valueLength The length of `pValue`.
+ *
+ * @return `true` on success; `false` if memory could not be allocated.
+ */
+static bool _replaceCacheSection( char ** pSection,
+                                  size_t * pSectionLength,
+                                  const char * pValue,
+                                  size_t valueLength );
+
+/**
+ * @brief Merge a partial state into a section of a document cache.
+ *
+ * @param[in,out] pSection The cached section to merge into.
+ * @param[in,out] pSectionLength The length of `*pSection`.
+ * @param[in] pPatch The partial state. A JSON `null` clears the section.
+ * @param[in] patchLength The length of `pPatch`.
+ *
+ * @return `true` on success; `false` if memory could not be allocated or
+ * `pPatch` is malformed.
+ */
+static bool _mergeCacheSection( char ** pSection,
+                                size_t * pSectionLength,
+                                const char * pPatch,
+                                size_t patchLength );
+
+/**
+ * @brief Find the subscription object of a Thing with an enabled document cache.
+ *
+ * @param[in] pThingName The Thing Name.
+ * @param[in] thingNameLength The length of `pThingName`.
+ *
+ * @return The subscription object; `NULL` if the Thing does not have an enabled
+ * document cache.
+ *
+ * @note This function should be called with the subscription list mutex locked.
+ */
+static _shadowSubscription_t * _findCachedSubscription( const char * pThingName,
+                                                        size_t thingNameLength );
+
+/**
+ * @brief Apply a Shadow document to a subscription object's enabled document cache.
+ *
+ * @param[in] pSubscription Subscription object with an enabled document cache.
+ * @param[in] source Where the document came from.
+ * @param[in] pDocument The received Shadow document.
+ * @param[in] documentLength The length of `pDocument`.
+ */
+static void _applyToCache( _shadowSubscription_t * pSubscription,
+                           _shadowCacheSource_t source,
+                           const char * pDocument,
+                           size_t documentLength );
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -193,9 +305,130 @@ static AwsIotShadowError_t _modifyOperationSubscriptions( IotMqttConnection_t mq
 
 /*-----------------------------------------------------------*/
 
+static bool _replaceCacheSection( char ** pSection,
+                                  size_t * pSectionLength,
+                                  const char * pValue,
+                                  size_t valueLength )
+{
+    char * pNewSection = NULL;
+
+    if( ( pValue != NULL ) && ( valueLength > 0 ) && ( pValue[ 0 ] == '{' ) )
+    {
+        pNewSection = AwsIotShadow_MallocString( valueLength );
+
+        if( pNewSection == NULL )
+        {
+            return false;
+        }
+
+        ( void ) memcpy( pNewSection, pValue, valueLength );
+    }
+    else
+    {
+        valueLength = 0;
+    }
+
+    if( *pSection != NULL )
+    {
+        AwsIotShadow_FreeString( *pSection );
+    }
+
+    *pSection = pNewSection;
+    *pSectionLength = valueLength;
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _mergeCacheSection( char ** pSection,
+                                size_t * pSectionLength,
+                                const char * pPatch,
+                                size_t patchLength )
+{
+    char * pMerged = NULL;
+    size_t mergedSize = *pSectionLength + patchLength + 2, mergedLength = 0;
+
+    /* A null clears the section; other non-object values are ignored. */
+    if( ( patchLength == 4 ) && ( strncmp( pPatch, "null", 4 ) == 0 ) )
+    {
+        return _replaceCacheSection( pSection, pSectionLength, NULL, 0 );
+    }
+
+    if( ( patchLength == 0 ) || ( pPatch[ 0 ] != '{' ) )
+    {
+        return true;
+    }
+
+    pMerged = AwsIotShadow_MallocString( mergedSize );
+
+    if( pMerged == NULL )
+    {
+        return false;
+    }
+
+    if( _AwsIotShadow_MergeJsonObjects( *pSection,
+                                        *pSectionLength,
+                                        pPatch,
+                                        patchLength,
+                                        true,
+                                        pMerged,
+                                        mergedSize,
+                                        &mergedLength ) == false )
+    {
+        AwsIotShadow_FreeString( pMerged );
+
+        return false;
+    }
+
+    if( *pSection != NULL )
+    {
+        AwsIotShadow_FreeString( *pSection );
+    }
+
+    *pSection = pMerged;
+    *pSectionLength = mergedLength;
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+static _shadowSubscription_t * _findCachedSubscription( const char * pThingName,
+                                                        size_t thingNameLength )
+{
+    _shadowSubscription_t * pSubscription = NULL;
+    IotLink_t * pSubscriptionLink = NULL;
+    _thingName_t thingName =
+    {
+        .pThingName      = pThingName,
+        .thingNameLength = thingNameLength
+    };
+
+    pSubscriptionLink = IotListDouble_FindFirstMatch( &( _AwsIotShadowSubscriptions ),
+                                                      NULL,
+                                                      _shadowSubscription_match,
+                                                      &thingName );
+
+    if( pSubscriptionLink != NULL )
+    {
+        pSubscription = IotLink_Container( _shadowSubscription_t, pSubscriptionLink, link );
+
+        if( pSubscription->cache.enabled == false )
+        {
+            pSubscription = NULL;
+        }
+    }
+
+    return pSubscription;
+}
+
+/*-----------------------------------------------------------*/
+
 _shadowSubscription_t * _AwsIotShadow_FindSubscription( const char * pThingName,
                                                         size_t thingNameLength )
 {
+    int i = 0;
     _shadowSubscription_t * pSubscription = NULL;
     IotLink_t * pSubscriptionLink = NULL;
     _thingName_t thingName =
@@ -213,17 +446,33 @@ _shadowSubscription_t * _AwsIotShadow_FindSubscription( const char * pThingName,
     /* Check if a subscription was found. */
     if( pSubscriptionLink == NULL )
     {
-        /* No subscription found. Allocate a new subscription. */
-        pSubscription = AwsIotShadow_MallocSubscription( sizeof( _shadowSubscription_t ) + thingNameLength );
+        /* No subscription found. Allocate a new subscription with space for
+         * the Thing's Shadow topic table. */
+        pSubscription = AwsIotShadow_MallocSubscription( sizeof( _shadowSubscription_t ) +
+                                                         SHADOW_TOPIC_TABLE_LENGTH( thingNameLength ) );
 
         if( pSubscription != NULL )
         {
             /* Clear the new subscription. */
-            ( void ) memset( pSubscription, 0x00, sizeof( _shadowSubscription_t ) + thingNameLength );
+            ( void ) memset( pSubscription,
+                             0x00,
+                             sizeof( _shadowSubscription_t ) + SHADOW_TOPIC_TABLE_LENGTH( thingNameLength ) );
+
+            /* Generate the Shadow topic of every operation. These topics are
+             * used by all operations and subscriptions of this Thing. */
+            for( i = 0; i < SHADOW_OPERATION_COUNT; i++ )
+            {
+                pSubscription->operationTopicLength[ i ] =
+                    _AwsIotShadow_GenerateShadowTopic( ( _shadowOperationType_t ) i,
+                                                       pThingName,
+                                                       thingNameLength,
+                                                       pSubscription->pTopicTable +
+                                                       ( i * SHADOW_TOPIC_TABLE_ENTRY_LENGTH( thingNameLength ) ) );
+            }
 
-            /* Set the Thing Name length and copy the Thing Name into the new subscription. */
+            /* Set the Thing Name, which is in the first entry of the topic table. */
+            pSubscription->pThingName = pSubscription->pTopicTable + SHADOW_TOPIC_PREFIX_LENGTH;
             pSubscription->thingNameLength = thingNameLength;
-            ( void ) strncpy( pSubscription->pThingName, pThingName, thingNameLength );
 
             /* Add the new subscription to the subscription list. */
             IotListDouble_InsertHead( &( _AwsIotShadowSubscriptions ),
@@ -303,8 +552,30 @@ void _AwsIotShadow_RemoveSubscription( _shadowSubscription_t * pSubscription,
         }
     }
 
-    /* No Shadow operation subscription references or active Shadow callbacks.
-     * Remove the subscription object. */
+    /* The document cache lives in the subscription object. */
+    if( pSubscription->cache.enabled == true )
+    {
+        IotLogDebug( "Shadow document cache is enabled for %.*s subscription object. "
+                     "Subscription will not be removed.",
+                     pSubscription->thingNameLength,
+                     pSubscription->pThingName );
+
+        return;
+    }
+
+    /* The publish job of a held Shadow UPDATE uses the subscription object. */
+    if( pSubscription->coalescedUpdate.pending == true )
+    {
+        IotLogDebug( "Merged Shadow UPDATE is waiting to be published for %.*s "
+                     "subscription object. Subscription cannot be removed yet.",
+                     pSubscription->thingNameLength,
+                     pSubscription->pThingName );
+
+        return;
+    }
+
+    /* No Shadow operation subscription references, active Shadow callbacks,
+     * document cache, or held Shadow UPDATE. Remove the subscription object. */
     IotListDouble_Remove( &( pSubscription->link ) );
 
     IotLogDebug( "Removed subscription object for %.*s.",
@@ -328,10 +599,44 @@ void _AwsIotShadow_RemoveSubscription( _shadowSubscription_t * pSubscription,
 void _AwsIotShadow_DestroySubscription( void * pData )
 {
     _shadowSubscription_t * pSubscription = ( _shadowSubscription_t * ) pData;
+    IotTaskPoolError_t taskPoolStatus = IOT_TASKPOOL_SUCCESS;
+
+    /* Free the document cache. */
+    _AwsIotShadow_ClearCache( &( pSubscription->cache ) );
+
+    /* A held Shadow UPDATE is only destroyed during cleanup. Cancel its publish
+     * job and free its merged state. */
+    if( pSubscription->coalescedUpdate.pending == true )
+    {
+        taskPoolStatus = IotTaskPool_TryCancel( IOT_SYSTEM_TASKPOOL,
+                                                pSubscription->coalescedUpdate.job,
+                                                NULL );
+
+        /* If the publish job was not canceled, it must be already executing.
+         * Any other return value is invalid. */
+        AwsIotShadow_Assert( ( taskPoolStatus == IOT_TASKPOOL_SUCCESS ) ||
+                             ( taskPoolStatus == IOT_TASKPOOL_CANCEL_FAILED ) );
 
-    /* Free the topic buffer. It should not be NULL. */
-    AwsIotShadow_Assert( pSubscription->pTopicBuffer != NULL );
-    AwsIotShadow_FreeString( pSubscription->pTopicBuffer );
+        if( taskPoolStatus != IOT_TASKPOOL_SUCCESS )
+        {
+            IotLogDebug( "Merged Shadow UPDATE of %.*s is being published. Its "
+                         "publish job will free the subscription object.",
+                         pSubscription->thingNameLength,
+                         pSubscription->pThingName );
+
+            /* The executing job is waiting for the subscription list mutex and
+             * still uses the subscription object. */
+            pSubscription->coalescedUpdate.destroyed = true;
+
+            return;
+        }
+
+        /* The canceled job will not run, so it is no longer outstanding. */
+        AwsIotShadow_Assert( _AwsIotShadowCoalescedJobCount > 0 );
+        _AwsIotShadowCoalescedJobCount--;
+
+        AwsIotShadow_FreeString( pSubscription->coalescedUpdate.pState );
+    }
 
     /* Free memory used by subscription. */
     AwsIotShadow_FreeSubscription( pSubscription );
@@ -339,15 +644,31 @@ void _AwsIotShadow_DestroySubscription( void * pData )
 
 /*-----------------------------------------------------------*/
 
+char * _AwsIotShadow_GetOperationTopic( _shadowSubscription_t * pSubscription,
+                                        _shadowOperationType_t type,
+                                        uint16_t * pOperationTopicLength )
+{
+    /* Only Shadow delete, get, and update operation types have topics. */
+    AwsIotShadow_Assert( ( type == _SHADOW_DELETE ) ||
+                         ( type == _SHADOW_GET ) ||
+                         ( type == _SHADOW_UPDATE ) );
+
+    *pOperationTopicLength = pSubscription->operationTopicLength[ type ];
+
+    return pSubscription->pTopicTable +
+           ( type * SHADOW_TOPIC_TABLE_ENTRY_LENGTH( pSubscription->thingNameLength ) );
+}
+
+/*-----------------------------------------------------------*/
+
 AwsIotShadowError_t _AwsIotShadow_IncrementReferences( _shadowOperation_t * pOperation,
-                                                       char * pTopicBuffer,
-                                                       uint16_t operationTopicLength,
                                                        _mqttCallbackFunction_t callback )
 {
-    uint16_t topicFilterLength = 0;
+    uint16_t topicFilterLength = 0, operationTopicLength = 0;
     AwsIotShadowError_t status = AWS_IOT_SHADOW_STATUS_PENDING;
     const _shadowOperationType_t type = pOperation->type;
     _shadowSubscription_t * pSubscription = pOperation->pSubscription;
+    char * pTopicBuffer = NULL;
 
     /* Do nothing if this operation has persistent subscriptions. */
     if( pSubscription->references[ type ] == PERSISTENT_SUBSCRIPTION )
@@ -368,6 +689,11 @@ AwsIotShadowError_t _AwsIotShadow_IncrementReferences( _shadowOperation_t * pOpe
     /* Check if there are any existing references for this operation. */
     if( pSubscription->references[ type ] == 0 )
     {
+        /* Get the operation topic from the topic table. */
+        pTopicBuffer = _AwsIotShadow_GetOperationTopic( pSubscription,
+                                                        type,
+                                                        &operationTopicLength );
+
         /* Place the topic "accepted" suffix at the end of the Shadow topic buffer. */
         ( void ) memcpy( pTopicBuffer + operationTopicLength,
                          SHADOW_ACCEPTED_SUFFIX,
@@ -459,13 +785,13 @@ AwsIotShadowError_t _AwsIotShadow_IncrementReferences( _shadowOperation_t * pOpe
 /*-----------------------------------------------------------*/
 
 void _AwsIotShadow_DecrementReferences( _shadowOperation_t * pOperation,
-                                        char * pTopicBuffer,
                                         _shadowSubscription_t ** pRemovedSubscription )
 {
     uint16_t topicFilterLength = 0;
     const _shadowOperationType_t type = pOperation->type;
     _shadowSubscription_t * pSubscription = pOperation->pSubscription;
     uint16_t operationTopicLength = 0;
+    char * pTopicBuffer = NULL;
 
     /* Do nothing if this Shadow operation has persistent subscriptions. */
     if( pSubscription->references[ type ] == PERSISTENT_SUBSCRIPTION )
@@ -492,16 +818,10 @@ void _AwsIotShadow_DecrementReferences( _shadowOperation_t * pOperation,
                      pSubscription->pThingName,
                      _pAwsIotShadowOperationNames[ type ] );
 
-        /* Subscription must have a topic buffer. */
-        AwsIotShadow_Assert( pSubscription->pTopicBuffer != NULL );
-
-        /* Generate the prefix of the Shadow topic. This function will not
-         * fail when given a buffer. */
-        ( void ) _AwsIotShadow_GenerateShadowTopic( ( _shadowOperationType_t ) type,
-                                                    pSubscription->pThingName,
-                                                    pSubscription->thingNameLength,
-                                                    &( pSubscription->pTopicBuffer ),
-                                                    &operationTopicLength );
+        /* Get the operation topic from the topic table. */
+        pTopicBuffer = _AwsIotShadow_GetOperationTopic( pSubscription,
+                                                        type,
+                                                        &operationTopicLength );
 
         /* Place the topic "accepted" suffix at the end of the Shadow topic buffer. */
         ( void ) memcpy( pTopicBuffer + operationTopicLength,
@@ -549,6 +869,205 @@ void _AwsIotShadow_DecrementReferences( _shadowOperation_t * pOperation,
 
 /*-----------------------------------------------------------*/
 
+static void _applyToCache( _shadowSubscription_t * pSubscription,
+                           _shadowCacheSource_t source,
+                           const char * pDocument,
+                           size_t documentLength )
+{
+    bool status = true, replace = false;
+    const char * pVersion = NULL, * pState = NULL, * pSection = NULL;
+    size_t versionLength = 0, stateLength = 0, sectionLength = 0;
+    uint32_t version = 0;
+    _shadowDocumentCache_t * pCache = &( pSubscription->cache );
+
+    /* A deleted Shadow has no state to cache. */
+    if( source == _CACHE_DELETE_ACCEPTED )
+    {
+        IotLogDebug( "Shadow of %.*s deleted. Clearing document cache.",
+                     pSubscription->thingNameLength,
+                     pSubscription->pThingName );
+
+        _AwsIotShadow_ClearCache( pCache );
+
+        return;
+    }
+
+    /* A documents topic message carries the previous and current Shadow
+     * documents. Only the current document is cached. */
+    if( ( source == _CACHE_DOCUMENTS ) &&
+        ( _AwsIotShadow_FindJsonMember( pDocument,
+                                        documentLength,
+                                        CURRENT_KEY,
+                                        CURRENT_KEY_LENGTH,
+                                        &pDocument,
+                                        &documentLength ) == false ) )
+    {
+        IotLogWarn( "Shadow documents message for %.*s has no current document.",
+                    pSubscription->thingNameLength,
+                    pSubscription->pThingName );
+
+        return;
+    }
+
+    /* The version orders documents that may arrive out of order. */
+    if( _AwsIotShadow_FindJsonMember( pDocument,
+                                      documentLength,
+                                      VERSION_KEY,
+                                      VERSION_KEY_LENGTH,
+                                      &pVersion,
+                                      &versionLength ) == false )
+    {
+        IotLogWarn( "Shadow document for %.*s has no version. Document not cached.",
+                    pSubscription->thingNameLength,
+                    pSubscription->pThingName );
+
+        return;
+    }
+
+    version = ( uint32_t ) strtoul( pVersion, NULL, 10 );
+
+    if( version < pCache->version )
+    {
+        IotLogDebug( "Ignoring Shadow document version %lu for %.*s; cache has version %lu.",
+                     ( unsigned long ) version,
+                     pSubscription->thingNameLength,
+                     pSubscription->pThingName,
+                     ( unsigned long ) pCache->version );
+
+        return;
+    }
+
+    /* A missing state leaves pState NULL, which matches no members. */
+    ( void ) _AwsIotShadow_FindJsonMember( pDocument,
+                                           documentLength,
+                                           STATE_KEY,
+                                           STATE_KEY_LENGTH,
+                                           &pState,
+                                           &stateLength );
+
+    /* GET responses and documents messages carry the complete state; UPDATE
+     * responses carry only the updated members. */
+    replace = ( source == _CACHE_GET_ACCEPTED ) || ( source == _CACHE_DOCUMENTS );
+
+    if( source == _CACHE_DELTA )
+    {
+        /* The state of a delta document holds desired members only. */
+        if( pState != NULL )
+        {
+            status = _mergeCacheSection( &( pCache->pDesired ),
+                                         &( pCache->desiredLength ),
+                                         pState,
+                                         stateLength );
+        }
+    }
+    else
+    {
+        pSection = NULL;
+        sectionLength = 0;
+
+        if( ( _AwsIotShadow_FindJsonMember( pState,
+                                            stateLength,
+                                            DESIRED_KEY,
+                                            DESIRED_KEY_LENGTH,
+                                            &pSection,
+                                            &sectionLength ) == true ) ||
+            ( replace == true ) )
+        {
+            status = ( replace == true ) ?
+                     _replaceCacheSection( &( pCache->pDesired ), &( pCache->desiredLength ), pSection, sectionLength ) :
+                     _mergeCacheSection( &( pCache->pDesired ), &( pCache->desiredLength ), pSection, sectionLength );
+        }
+
+        pSection = NULL;
+        sectionLength = 0;
+
+        if( ( status == true ) &&
+            ( ( _AwsIotShadow_FindJsonMember( pState,
+                                              stateLength,
+                                              REPORTED_KEY,
+                                              REPORTED_KEY_LENGTH,
+                                              &pSection,
+                                              &sectionLength ) == true ) ||
+              ( replace == true ) ) )
+        {
+            status = ( replace == true ) ?
+                     _replaceCacheSection( &( pCache->pReported ), &( pCache->reportedLength ), pSection, sectionLength ) :
+                     _mergeCacheSection( &( pCache->pReported ), &( pCache->reportedLength ), pSection, sectionLength );
+        }
+    }
+
+    if( status == true )
+    {
+        pCache->version = version;
+
+        if( replace == true )
+        {
+            pCache->synchronized = true;
+        }
+
+        IotLogDebug( "Shadow document cache for %.*s now has version %lu.",
+                     pSubscription->thingNameLength,
+                     pSubscription->pThingName,
+                     ( unsigned long ) version );
+    }
+    else
+    {
+        /* A partially applied document leaves the cache inconsistent. */
+        IotLogError( "Failed to apply Shadow document to the cache of %.*s. "
+                     "Cache cleared.",
+                     pSubscription->thingNameLength,
+                     pSubscription->pThingName );
+
+        _AwsIotShadow_ClearCache( pCache );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void _AwsIotShadow_ApplyToCache( const char * pThingName,
+                                 size_t thingNameLength,
+                                 _shadowCacheSource_t source,
+                                 const char * pDocument,
+                                 size_t documentLength )
+{
+    _shadowSubscription_t * pSubscription = NULL;
+
+    IotMutex_Lock( &_AwsIotShadowSubscriptionsMutex );
+
+    pSubscription = _findCachedSubscription( pThingName, thingNameLength );
+
+    if( pSubscription != NULL )
+    {
+        _applyToCache( pSubscription, source, pDocument, documentLength );
+    }
+
+    IotMutex_Unlock( &_AwsIotShadowSubscriptionsMutex );
+}
+
+/*-----------------------------------------------------------*/
+
+void _AwsIotShadow_ClearCache( _shadowDocumentCache_t * pCache )
+{
+    if( pCache->pDesired != NULL )
+    {
+        AwsIotShadow_FreeString( pCache->pDesired );
+    }
+
+    if( pCache->pReported != NULL )
+    {
+        AwsIotShadow_FreeString( pCache->pReported );
+    }
+
+    pCache->pDesired = NULL;
+    pCache->desiredLength = 0;
+    pCache->pReported = NULL;
+    pCache->reportedLength = 0;
+    pCache->version = 0;
+    pCache->synchronized = false;
+}
+
+/*-----------------------------------------------------------*/
+
 AwsIotShadowError_t AwsIotShadow_RemovePersistentSubscriptions( IotMqttConnection_t mqttConnection,
                                                                 const char * pThingName,
                                                                 size_t thingNameLength,
@@ -556,6 +1075,7 @@ AwsIotShadowError_t AwsIotShadow_RemovePersistentSubscriptions( IotMqttConnectio
 {
     int i = 0;
     uint16_t operationTopicLength = 0, topicFilterLength = 0;
+    char * pTopicBuffer = NULL;
     AwsIotShadowError_t removeAcceptedStatus = AWS_IOT_SHADOW_STATUS_PENDING,
                         removeRejectedStatus = AWS_IOT_SHADOW_STATUS_PENDING;
     _shadowSubscription_t * pSubscription = NULL;
@@ -597,27 +1117,21 @@ AwsIotShadowError_t AwsIotShadow_RemovePersistentSubscriptions( IotMqttConnectio
                              pThingName,
                              _pAwsIotShadowOperationNames[ i ] );
 
-                /* Subscription must have a topic buffer. */
-                AwsIotShadow_Assert( pSubscription->pTopicBuffer != NULL );
-
                 if( pSubscription->references[ i ] == PERSISTENT_SUBSCRIPTION )
                 {
-                    /* Generate the prefix of the Shadow topic. This function will not
-                     * fail when given a buffer. */
-                    ( void ) _AwsIotShadow_GenerateShadowTopic( ( _shadowOperationType_t ) i,
-                                                                pThingName,
-                                                                thingNameLength,
-                                                                &( pSubscription->pTopicBuffer ),
-                                                                &operationTopicLength );
+                    /* Get the operation topic from the topic table. */
+                    pTopicBuffer = _AwsIotShadow_GetOperationTopic( pSubscription,
+                                                                    ( _shadowOperationType_t ) i,
+                                                                    &operationTopicLength );
 
                     /* Remove the "accepted" topic. */
-                    ( void ) memcpy( pSubscription->pTopicBuffer + operationTopicLength,
+                    ( void ) memcpy( pTopicBuffer + operationTopicLength,
                                      SHADOW_ACCEPTED_SUFFIX,
                                      SHADOW_ACCEPTED_SUFFIX_LENGTH );
                     topicFilterLength = ( uint16_t ) ( operationTopicLength + SHADOW_ACCEPTED_SUFFIX_LENGTH );
 
                     removeAcceptedStatus = _modifyOperationSubscriptions( mqttConnection,
-                                                                          pSubscription->pTopicBuffer,
+                                                                          pTopicBuffer,
                                                                           topicFilterLength,
                                                                           NULL,
                                                                           IotMqtt_TimedUnsubscribe );
@@ -628,14 +1142,14 @@ AwsIotShadowError_t AwsIotShadow_RemovePersistentSubscriptions( IotMqttConnectio
                     }
 
                     /* Remove the "rejected" topic. */
-                    ( void ) memcpy( pSubscription->pTopicBuffer + operationTopicLength,
+                    ( void ) memcpy( pTopicBuffer + operationTopicLength,
                                      SHADOW_REJECTED_SUFFIX,
                                      SHADOW_ACCEPTED_SUFFIX_LENGTH );
                     topicFilterLength = ( uint16_t ) ( operationTopicLength +
                                                        SHADOW_REJECTED_SUFFIX_LENGTH );
 
                     removeRejectedStatus = _modifyOperationSubscriptions( mqttConnection,
-                                                                          pSubscription->pTopicBuffer,
+                                                                          pTopicBuffer,
                                                                           topicFilterLength,
                                                                           NULL,
                                                                           IotMqtt_TimedUnsubscribe );
@@ -682,3 +1196,218 @@ AwsIotShadowError_t AwsIotShadow_RemovePersistentSubscriptions( IotMqttConnectio
 }
 
 /*-----------------------------------------------------------*/
+
+AwsIotShadowError_t AwsIotShadow_EnableDocumentCache( const char * pThingName,
+                                                     size_t thingNameLength )
+{
+    AwsIotShadowError_t status = AWS_IOT_SHADOW_SUCCESS;
+    _shadowSubscription_t * pSubscription = NULL;
+
+    if( ( pThingName == NULL ) || ( thingNameLength == 0 ) ||
+        ( thingNameLength > MAX_THING_NAME_LENGTH ) )
+    {
+        IotLogError( "Invalid Thing Name for Shadow document cache." );
+
+        return AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
+    IotMutex_Lock( &( _AwsIotShadowSubscriptionsMutex ) );
+
+    /* The document cache is kept in the subscription object, which is created
+     * if needed. */
+    pSubscription = _AwsIotShadow_FindSubscription( pThingName, thingNameLength );
+
+    if( pSubscription == NULL )
+    {
+        status = AWS_IOT_SHADOW_NO_MEMORY;
+    }
+    else
+    {
+        pSubscription->cache.enabled = true;
+
+        IotLogInfo( "Shadow document cache enabled for %.*s.",
+                    thingNameLength,
+                    pThingName );
+    }
+
+    IotMutex_Unlock( &( _AwsIotShadowSubscriptionsMutex ) );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+AwsIotShadowError_t AwsIotShadow_DisableDocumentCache( const char * pThingName,
+                                                      size_t thingNameLength )
+{
+    _shadowSubscription_t * pSubscription = NULL;
+
+    if( ( pThingName == NULL ) || ( thingNameLength == 0 ) ||
+        ( thingNameLength > MAX_THING_NAME_LENGTH ) )
+    {
+        IotLogError( "Invalid Thing Name for Shadow document cache." );
+
+        return AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
+    IotMutex_Lock( &( _AwsIotShadowSubscriptionsMutex ) );
+
+    pSubscription = _findCachedSubscription( pThingName, thingNameLength );
+
+    if( pSubscription != NULL )
+    {
+        _AwsIotShadow_ClearCache( &( pSubscription->cache ) );
+        pSubscription->cache.enabled = false;
+
+        IotLogInfo( "Shadow document cache disabled for %.*s.",
+                    thingNameLength,
+                    pThingName );
+
+        /* Remove the subscription object if only the cache was using it. */
+        _AwsIotShadow_RemoveSubscription( pSubscription, NULL );
+    }
+
+    IotMutex_Unlock( &( _AwsIotShadowSubscriptionsMutex ) );
+
+    return AWS_IOT_SHADOW_SUCCESS;
+}
+
+/*-----------------------------------------------------------*/
+
+AwsIotShadowError_t AwsIotShadow_GetCachedDocument( const char * pThingName,
+                                                   size_t thingNameLength,
+                                                   uint32_t minimumVersion,
+                                                   char * pDocumentBuffer,
+                                                   size_t documentBufferSize,
+                                                   size_t * pDocumentLength,
+                                                   uint32_t * pVersion )
+{
+    AwsIotShadowError_t status = AWS_IOT_SHADOW_SUCCESS;
+    _shadowSubscription_t * pSubscription = NULL;
+    const _shadowDocumentCache_t * pCache = NULL;
+    int documentLength = 0;
+
+    if( ( pThingName == NULL ) || ( thingNameLength == 0 ) ||
+        ( pDocumentBuffer == NULL ) || ( pDocumentLength == NULL ) )
+    {
+        IotLogError( "Thing Name, document buffer, and document length must be "
+                     "set to read a cached Shadow document." );
+
+        return AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
+    IotMutex_Lock( &( _AwsIotShadowSubscriptionsMutex ) );
+
+    pSubscription = _findCachedSubscription( pThingName, thingNameLength );
+
+    if( ( pSubscription == NULL ) || ( pSubscription->cache.synchronized == false ) )
+    {
+        IotLogDebug( "No cached Shadow document for %.*s.",
+                     thingNameLength,
+                     pThingName );
+
+        status = AWS_IOT_SHADOW_NOT_FOUND;
+    }
+    else if( pSubscription->cache.version < minimumVersion )
+    {
+        IotLogDebug( "Cached Shadow document for %.*s has version %lu, older than %lu.",
+                     thingNameLength,
+                     pThingName,
+                     ( unsigned long ) pSubscription->cache.version,
+                     ( unsigned long ) minimumVersion );
+
+        status = AWS_IOT_SHADOW_CONFLICT;
+    }
+    else
+    {
+        pCache = &( pSubscription->cache );
+
+        documentLength = snprintf( pDocumentBuffer,
+                                   documentBufferSize,
+                                   CACHED_DOCUMENT_FORMAT,
+                                   ( int ) ( pCache->pDesired != NULL ? pCache->desiredLength : EMPTY_JSON_OBJECT_LENGTH ),
+                                   pCache->pDesired != NULL ? pCache->pDesired : EMPTY_JSON_OBJECT,
+                                   ( int ) ( pCache->pReported != NULL ? pCache->reportedLength : EMPTY_JSON_OBJECT_LENGTH ),
+                                   pCache->pReported != NULL ? pCache->pReported : EMPTY_JSON_OBJECT,
+                                   ( unsigned long ) pCache->version );
+
+        /* Report the required length if the buffer is too small. */
+        *pDocumentLength = ( size_t ) documentLength;
+
+        if( ( documentLength < 0 ) || ( ( size_t ) documentLength >= documentBufferSize ) )
+        {
+            IotLogError( "Buffer of size %lu is too small for cached Shadow document of %.*s.",
+                         ( unsigned long ) documentBufferSize,
+                         thingNameLength,
+                         pThingName );
+
+            status = AWS_IOT_SHADOW_BAD_PARAMETER;
+        }
+        else if( pVersion != NULL )
+        {
+            *pVersion = pCache->version;
+        }
+    }
+
+    IotMutex_Unlock( &( _AwsIotShadowSubscriptionsMutex ) );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+AwsIotShadowError_t AwsIotShadow_DiffReportedState( const char * pThingName,
+                                                   size_t thingNameLength,
+                                                   const char * pReportedState,
+                                                   size_t reportedStateLength,
+                                                   char * pDiffBuffer,
+                                                   size_t diffBufferSize,
+                                                   size_t * pDiffLength )
+{
+    AwsIotShadowError_t status = AWS_IOT_SHADOW_SUCCESS;
+    _shadowSubscription_t * pSubscription = NULL;
+
+    if( ( pThingName == NULL ) || ( thingNameLength == 0 ) ||
+        ( pReportedState == NULL ) || ( reportedStateLength == 0 ) ||
+        ( pDiffBuffer == NULL ) || ( pDiffLength == NULL ) )
+    {
+        IotLogError( "Thing Name, reported state, and diff buffer must be set to "
+                     "diff a reported state." );
+
+        return AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
+    IotMutex_Lock( &( _AwsIotShadowSubscriptionsMutex ) );
+
+    pSubscription = _findCachedSubscription( pThingName, thingNameLength );
+
+    if( pSubscription == NULL )
+    {
+        IotLogError( "Shadow document cache is not enabled for %.*s.",
+                     thingNameLength,
+                     pThingName );
+
+        status = AWS_IOT_SHADOW_NOT_FOUND;
+    }
+    else if( _AwsIotShadow_DiffJsonObjects( pSubscription->cache.pReported,
+                                            pSubscription->cache.reportedLength,
+                                            pReportedState,
+                                            reportedStateLength,
+                                            pDiffBuffer,
+                                            diffBufferSize,
+                                            pDiffLength ) == false )
+    {
+        IotLogError( "Failed to diff reported state of %.*s. The state must be a "
+                     "JSON object no larger than the diff buffer.",
+                     thingNameLength,
+                     pThingName );
+
+        status = AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
+    IotMutex_Unlock( &( _AwsIotShadowSubscriptionsMutex ) );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
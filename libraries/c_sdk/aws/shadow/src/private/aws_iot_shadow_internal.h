@@ -41,6 +41,9 @@
 /* Platform layer types include. */
 #include "types/iot_platform_types.h"
 
+/* Task pool types include. */
+#include "types/iot_taskpool_types.h"
+
 /* Shadow include. */
 #include "aws_iot_shadow.h"
 
@@ -161,6 +164,12 @@
 #ifndef AWS_IOT_SHADOW_DEFAULT_MQTT_TIMEOUT_MS
     #define AWS_IOT_SHADOW_DEFAULT_MQTT_TIMEOUT_MS    ( 5000 )
 #endif
+#ifndef AWS_IOT_SHADOW_COALESCE_WINDOW_MS
+    #define AWS_IOT_SHADOW_COALESCE_WINDOW_MS         ( 50 )
+#endif
+#ifndef AWS_IOT_SHADOW_MAX_JSON_DEPTH
+    #define AWS_IOT_SHADOW_MAX_JSON_DEPTH             ( 10 )
+#endif
 /** @endcond */
 
 /**
@@ -270,6 +279,34 @@
  */
 #define SHADOW_LONGEST_SUFFIX_LENGTH             SHADOW_UPDATED_SUFFIX_LENGTH
 
+/**
+ * @brief The length of the longest Shadow operation string.
+ */
+#define SHADOW_LONGEST_OPERATION_STRING_LENGTH    SHADOW_UPDATE_OPERATION_STRING_LENGTH
+
+/**
+ * @brief The length of one entry in a Thing's Shadow topic table.
+ *
+ * Each entry holds a Shadow operation topic followed by space for the longest
+ * Shadow suffix.
+ *
+ * @param[in] thingNameLength Length of the Thing Name.
+ */
+#define SHADOW_TOPIC_TABLE_ENTRY_LENGTH( thingNameLength ) \
+    ( SHADOW_TOPIC_PREFIX_LENGTH +                         \
+      ( thingNameLength ) +                                \
+      SHADOW_LONGEST_OPERATION_STRING_LENGTH +             \
+      SHADOW_LONGEST_SUFFIX_LENGTH )
+
+/**
+ * @brief The length of a Thing's Shadow topic table, which has one entry for
+ * each Shadow operation.
+ *
+ * @param[in] thingNameLength Length of the Thing Name.
+ */
+#define SHADOW_TOPIC_TABLE_LENGTH( thingNameLength ) \
+    ( SHADOW_OPERATION_COUNT * SHADOW_TOPIC_TABLE_ENTRY_LENGTH( thingNameLength ) )
+
 /**
  * @brief The JSON key used to represent client tokens in a Shadow update document.
  */
@@ -280,6 +317,26 @@
  */
 #define CLIENT_TOKEN_KEY_LENGTH                  ( sizeof( CLIENT_TOKEN_KEY ) - 1 )
 
+/**
+ * @brief The JSON key for the state in a Shadow document.
+ */
+#define STATE_KEY                                "state"
+
+/**
+ * @brief The length of #STATE_KEY.
+ */
+#define STATE_KEY_LENGTH                         ( sizeof( STATE_KEY ) - 1 )
+
+/**
+ * @brief The JSON key for the version in a Shadow document.
+ */
+#define VERSION_KEY                              "version"
+
+/**
+ * @brief The length of #VERSION_KEY.
+ */
+#define VERSION_KEY_LENGTH                       ( sizeof( VERSION_KEY ) - 1 )
+
 /**
  * @brief The longest client token accepted by the Shadow service, per AWS IoT
  * service limits.
@@ -360,6 +417,21 @@ typedef enum _shadowOperationStatus
     _UNKNOWN_STATUS = 2   /**< Parsed value matched neither accepted nor rejected. */
 } _shadowOperationStatus_t;
 
+/**
+ * @brief Enumerations representing each of the Shadow documents that may be
+ * applied to a document cache.
+ *
+ * The accepted operation responses share their values with #_shadowOperationType_t.
+ */
+typedef enum _shadowCacheSource
+{
+    _CACHE_DELETE_ACCEPTED = 0, /**< Accepted Shadow DELETE response. */
+    _CACHE_GET_ACCEPTED = 1,    /**< Accepted Shadow GET response. */
+    _CACHE_UPDATE_ACCEPTED = 2, /**< Accepted Shadow UPDATE response. */
+    _CACHE_DELTA = 3,           /**< Document received on the Shadow delta topic. */
+    _CACHE_DOCUMENTS = 4        /**< Document received on the Shadow documents topic. */
+} _shadowCacheSource_t;
+
 /**
  * @brief Internal structure representing a single Shadow operation (DELETE,
  * GET, or UPDATE).
@@ -410,6 +482,42 @@ typedef struct _shadowOperation
     } notify;                                /**< @brief How to notify of an operation's completion. */
 } _shadowOperation_t;
 
+/**
+ * @brief Local copy of a Thing Shadow state, kept when enabled with @ref
+ * shadow_function_enabledocumentcache.
+ */
+typedef struct _shadowDocumentCache
+{
+    bool enabled;          /**< @brief Whether the document cache is enabled for this Thing. */
+    bool synchronized;     /**< @brief Whether a complete Shadow document has been cached. */
+    uint32_t version;      /**< @brief Version of the last Shadow document applied to the cache. */
+    char * pDesired;       /**< @brief Cached `desired` state; `NULL` when empty. */
+    size_t desiredLength;  /**< @brief Length of `pDesired`. */
+    char * pReported;      /**< @brief Last acknowledged `reported` state; `NULL` when empty. */
+    size_t reportedLength; /**< @brief Length of `pReported`. */
+} _shadowDocumentCache_t;
+
+/**
+ * @brief Shadow updates being held and merged before they are published, as
+ * requested with #AWS_IOT_SHADOW_FLAG_COALESCE.
+ */
+typedef struct _shadowCoalescedUpdate
+{
+    bool pending;                                  /**< @brief Whether a merged update is waiting to be published. */
+    bool destroyed;                                /**< @brief Whether the subscription was destroyed while the publish job was executing. */
+    IotMqttConnection_t mqttConnection;            /**< @brief MQTT connection of the first merged update. */
+    IotMqttQos_t qos;                              /**< @brief QoS of the first merged update. */
+    uint32_t retryLimit;                           /**< @brief Retry limit of the first merged update. */
+    uint32_t retryMs;                              /**< @brief Retry time of the first merged update. */
+    char * pState;                                 /**< @brief Merged `state` of all held updates. */
+    size_t stateLength;                            /**< @brief Length of `pState`. */
+    char pClientToken[ MAX_CLIENT_TOKEN_LENGTH ];  /**< @brief Client token shared by all held updates, with quotes. */
+    size_t clientTokenLength;                      /**< @brief Length of `pClientToken`. */
+    size_t updateCount;                            /**< @brief Number of held updates. */
+    IotTaskPoolJobStorage_t jobStorage;            /**< @brief Storage for the publish job. */
+    IotTaskPoolJob_t job;                          /**< @brief Publishes the merged update when the window ends. */
+} _shadowCoalescedUpdate_t;
+
 /**
  * @brief Represents a Shadow subscriptions object.
  *
@@ -421,17 +529,34 @@ typedef struct _shadowSubscription
 
     int32_t references[ SHADOW_OPERATION_COUNT ];                  /**< @brief Reference counter for Shadow operation topics. */
     AwsIotShadowCallbackInfo_t callbacks[ SHADOW_CALLBACK_COUNT ]; /**< @brief Shadow callbacks for this Thing. */
+    _shadowDocumentCache_t cache;                                  /**< @brief Shadow document cache for this Thing. */
+    _shadowCoalescedUpdate_t coalescedUpdate;                      /**< @brief Shadow updates waiting to be merged and published. */
 
     /**
-     * @brief Buffer allocated for removing Shadow topics.
+     * @brief Thing Name associated with this subscriptions object.
      *
-     * This buffer is pre-allocated to ensure that memory is available when
-     * unsubscribing.
+     * Points to the Thing Name in the first entry of `pTopicTable`.
      */
-    char * pTopicBuffer;
-
+    const char * pThingName;
     size_t thingNameLength; /**< @brief Length of Thing Name. */
-    char pThingName[];      /**< @brief Thing Name associated with this subscriptions object. */
+
+    /**
+     * @brief Length of the Shadow operation topic (excluding any suffix) in
+     * each entry of `pTopicTable`.
+     */
+    uint16_t operationTopicLength[ SHADOW_OPERATION_COUNT ];
+
+    /**
+     * @brief Shadow topics of this Thing, indexed by operation.
+     *
+     * Each entry of length #SHADOW_TOPIC_TABLE_ENTRY_LENGTH is generated once
+     * when this subscriptions object is created. Shadow operations publish to
+     * the operation topic of an entry; the space after it is used for the
+     * suffixes of subscription topic filters. Suffixes may only be written
+     * with the subscription list mutex locked, and the operation topic itself
+     * is never modified.
+     */
+    char pTopicTable[];
 } _shadowSubscription_t;
 
 /* Declarations of names printed in logs. */
@@ -446,6 +571,8 @@ extern IotListDouble_t _AwsIotShadowPendingOperations;
 extern IotListDouble_t _AwsIotShadowSubscriptions;
 extern IotMutex_t _AwsIotShadowPendingOperationsMutex;
 extern IotMutex_t _AwsIotShadowSubscriptionsMutex;
+extern uint32_t _AwsIotShadowCoalescedJobCount;
+extern IotSemaphore_t _AwsIotShadowCoalescedJobsDone;
 
 /*----------------------- Shadow operation functions ------------------------*/
 
@@ -480,24 +607,18 @@ void _AwsIotShadow_DestroyOperation( void * pData );
  * @param[in] type One of: DELETE, GET, UPDATE.
  * @param[in] pThingName Thing Name to place in the topic.
  * @param[in] thingNameLength Length of `pThingName`.
- * @param[out] pTopicBuffer Address of the buffer for the Shadow topic. If the
- * pointer at this address is `NULL`, this function will allocate a new buffer;
- * otherwise, it will use the provided buffer.
- * @param[out] pOperationTopicLength Length of the Shadow operation topic (excluding
- * any suffix) placed in `pTopicBuffer`.
+ * @param[out] pTopicBuffer Buffer for the Shadow topic.
  *
- * @warning This function does not check the length of `pTopicBuffer`! Any provided
- * buffer must be large enough to accommodate the full Shadow topic, plus
- * #SHADOW_LONGEST_SUFFIX_LENGTH.
+ * @warning This function does not check the length of `pTopicBuffer`! The
+ * buffer must be at least #SHADOW_TOPIC_TABLE_ENTRY_LENGTH long.
  *
- * @return #AWS_IOT_SHADOW_SUCCESS or #AWS_IOT_SHADOW_NO_MEMORY. This function
- * will not return #AWS_IOT_SHADOW_NO_MEMORY when a buffer is provided.
+ * @return Length of the Shadow operation topic (excluding any suffix) placed in
+ * `pTopicBuffer`.
  */
-AwsIotShadowError_t _AwsIotShadow_GenerateShadowTopic( _shadowOperationType_t type,
-                                                       const char * pThingName,
-                                                       size_t thingNameLength,
-                                                       char ** pTopicBuffer,
-                                                       uint16_t * pOperationTopicLength );
+uint16_t _AwsIotShadow_GenerateShadowTopic( _shadowOperationType_t type,
+                                            const char * pThingName,
+                                            size_t thingNameLength,
+                                            char * pTopicBuffer );
 
 /**
  * @brief Process a Shadow operation by sending the necessary MQTT packets.
@@ -518,6 +639,37 @@ AwsIotShadowError_t _AwsIotShadow_ProcessOperation( IotMqttConnection_t mqttConn
                                                     _shadowOperation_t * pOperation,
                                                     const AwsIotShadowDocumentInfo_t * pDocumentInfo );
 
+/**
+ * @brief Hold a Shadow UPDATE so that it is merged with other Shadow UPDATEs
+ * of the same Thing and published with them as one document.
+ *
+ * The merged document is published #AWS_IOT_SHADOW_COALESCE_WINDOW_MS after
+ * the first Shadow UPDATE is held.
+ *
+ * @param[in] mqttConnection The MQTT connection to use.
+ * @param[in] pOperation Shadow UPDATE operation to hold. Its client token is
+ * replaced with the client token of the merged document.
+ * @param[in] pUpdateInfo Information on the Shadow update document. The
+ * document must have a `state` object and no `version` key.
+ *
+ * @return #AWS_IOT_SHADOW_STATUS_PENDING on success. On error, one of
+ * #AWS_IOT_SHADOW_NO_MEMORY, #AWS_IOT_SHADOW_BAD_PARAMETER, or
+ * #AWS_IOT_SHADOW_MQTT_ERROR. `pOperation` is destroyed on error.
+ */
+AwsIotShadowError_t _AwsIotShadow_CoalesceUpdate( IotMqttConnection_t mqttConnection,
+                                                  _shadowOperation_t * pOperation,
+                                                  const AwsIotShadowDocumentInfo_t * pUpdateInfo );
+
+/**
+ * @brief Wait until no publish jobs of merged Shadow UPDATEs are scheduled or
+ * executing.
+ *
+ * Called by #AwsIotShadow_Cleanup after all subscription objects are destroyed,
+ * since publish jobs that could not be canceled still lock the Shadow mutexes.
+ * Must be called with no Shadow mutexes locked.
+ */
+void _AwsIotShadow_WaitForCoalescedUpdates( void );
+
 /**
  * @brief Notify of a completed Shadow operation.
  *
@@ -571,6 +723,22 @@ void _AwsIotShadow_RemoveSubscription( _shadowSubscription_t * pSubscription,
  */
 void _AwsIotShadow_DestroySubscription( void * pData );
 
+/**
+ * @brief Get a Shadow operation topic from a Thing's Shadow topic table.
+ *
+ * @param[in] pSubscription Subscriptions object of the Thing.
+ * @param[in] type One of: DELETE, GET, UPDATE.
+ * @param[out] pOperationTopicLength Length of the Shadow operation topic
+ * (excluding any suffix).
+ *
+ * @return The Shadow topic table entry for `type`. Up to
+ * #SHADOW_LONGEST_SUFFIX_LENGTH bytes may be written after the operation topic
+ * with the subscription list mutex locked.
+ */
+char * _AwsIotShadow_GetOperationTopic( _shadowSubscription_t * pSubscription,
+                                        _shadowOperationType_t type,
+                                        uint16_t * pOperationTopicLength );
+
 /**
  * @brief Increment the reference count of a Shadow subscriptions object.
  *
@@ -578,23 +746,14 @@ void _AwsIotShadow_DestroySubscription( void * pData );
  *
  * @param[in] pOperation The operation for which the reference count should be
  * incremented.
- * @param[in] pTopicBuffer Topic buffer containing the operation topic, used if
- * subscriptions need to be added.
- * @param[in] operationTopicLength The length of the operation topic in `pTopicBuffer`.
  * @param[in] callback MQTT callback function for when this operation completes.
  *
- * @warning This function does not check the length of `pTopicBuffer`! Any provided
- * buffer must already contain the Shadow operation topic, plus enough space for the
- * status suffix.
- *
  * @return #AWS_IOT_SHADOW_STATUS_PENDING on success. On error, one of
  * #AWS_IOT_SHADOW_NO_MEMORY or #AWS_IOT_SHADOW_MQTT_ERROR.
  *
  * @note This function should be called with the subscription list mutex locked.
  */
 AwsIotShadowError_t _AwsIotShadow_IncrementReferences( _shadowOperation_t * pOperation,
-                                                       char * pTopicBuffer,
-                                                       uint16_t operationTopicLength,
                                                        _mqttCallbackFunction_t callback );
 
 /**
@@ -604,22 +763,47 @@ AwsIotShadowError_t _AwsIotShadow_IncrementReferences( _shadowOperation_t * pOpe
  *
  * @param[in] pOperation The operation for which the reference count should be
  * decremented.
- * @param[in] pTopicBuffer Topic buffer containing the operation topic, used if
- * subscriptions need to be removed.
  * @param[out] pRemovedSubscription Set to point to a removed subscription.
  * Optional; pass `NULL` to ignore. If not `NULL`, this function will not destroy
  * a removed subscription.
  *
- * @warning This function does not check the length of `pTopicBuffer`! Any provided
- * buffer must be large enough to accommodate the full Shadow topic, plus
- * #SHADOW_LONGEST_SUFFIX_LENGTH.
- *
  * @note This function should be called with the subscription list mutex locked.
  */
 void _AwsIotShadow_DecrementReferences( _shadowOperation_t * pOperation,
-                                        char * pTopicBuffer,
                                         _shadowSubscription_t ** pRemovedSubscription );
 
+/*--------------------- Shadow document cache functions ---------------------*/
+
+/**
+ * @brief Apply a Shadow document to a Thing's document cache.
+ *
+ * Does nothing if the document cache is not enabled for the Thing. Documents
+ * older than the cached version are ignored.
+ *
+ * @param[in] pThingName Thing Name of the Shadow document.
+ * @param[in] thingNameLength The length of `pThingName`.
+ * @param[in] source Where the document came from.
+ * @param[in] pDocument The received Shadow document.
+ * @param[in] documentLength The length of `pDocument`.
+ *
+ * @note This function locks the subscription list mutex. It must not be called
+ * with the operation list mutex locked.
+ */
+void _AwsIotShadow_ApplyToCache( const char * pThingName,
+                                 size_t thingNameLength,
+                                 _shadowCacheSource_t source,
+                                 const char * pDocument,
+                                 size_t documentLength );
+
+/**
+ * @brief Free the contents of a document cache and mark it unsynchronized.
+ *
+ * The cache remains enabled if it was enabled.
+ *
+ * @param[in] pCache The document cache to clear.
+ */
+void _AwsIotShadow_ClearCache( _shadowDocumentCache_t * pCache );
+
 /*------------------------- Shadow parser functions -------------------------*/
 
 /**
@@ -660,4 +844,82 @@ AwsIotShadowError_t _AwsIotShadow_ParseThingName( const char * pTopicName,
 AwsIotShadowError_t _AwsIotShadow_ParseErrorDocument( const char * pErrorDocument,
                                                       size_t errorDocumentLength );
 
+/**
+ * @brief Find a top-level member of a JSON object.
+ *
+ * Unlike `IotJsonUtils_FindJsonValue`, keys in nested objects are not matched.
+ *
+ * @param[in] pObject The JSON object to search. May be `NULL`.
+ * @param[in] objectLength The length of `pObject`.
+ * @param[in] pKey The key to find, without quotes.
+ * @param[in] keyLength The length of `pKey`.
+ * @param[out] pValue Set to the value of the member.
+ * @param[out] pValueLength Set to the length of `pValue`.
+ *
+ * @return `true` if the member was found; `false` otherwise.
+ */
+bool _AwsIotShadow_FindJsonMember( const char * pObject,
+                                   size_t objectLength,
+                                   const char * pKey,
+                                   size_t keyLength,
+                                   const char ** pValue,
+                                   size_t * pValueLength );
+
+/**
+ * @brief Recursively merge one JSON object into another.
+ *
+ * Members of `pPatch` replace members of `pBase` with the same key; nested
+ * objects are merged.
+ *
+ * @param[in] pBase The JSON object to merge into. `NULL` is treated as `{}`.
+ * @param[in] baseLength The length of `pBase`.
+ * @param[in] pPatch The JSON object to merge.
+ * @param[in] patchLength The length of `pPatch`.
+ * @param[in] removeNulls If `true`, a `null` value in `pPatch` removes the member,
+ * as when a Shadow document is applied. If `false`, `null` values are kept, as
+ * when Shadow update documents are combined.
+ * @param[out] pOutput Buffer for the merged object. A buffer of
+ * `baseLength + patchLength + 2` bytes is always large enough.
+ * @param[in] outputSize The size of `pOutput`.
+ * @param[out] pOutputLength Set to the length of the merged object.
+ *
+ * @return `true` on success; `false` if an input is malformed, has objects nested
+ * deeper than `AWS_IOT_SHADOW_MAX_JSON_DEPTH`, or `pOutput` is too small.
+ */
+bool _AwsIotShadow_MergeJsonObjects( const char * pBase,
+                                     size_t baseLength,
+                                     const char * pPatch,
+                                     size_t patchLength,
+                                     bool removeNulls,
+                                     char * pOutput,
+                                     size_t outputSize,
+                                     size_t * pOutputLength );
+
+/**
+ * @brief Generate a JSON object with only the members of `pNew` that differ
+ * from `pBase`.
+ *
+ * Nested objects are compared recursively; other values are compared as text.
+ * The output is `{}` if nothing changed.
+ *
+ * @param[in] pBase The JSON object to compare against. May be `NULL`.
+ * @param[in] baseLength The length of `pBase`.
+ * @param[in] pNew The JSON object to compare.
+ * @param[in] newLength The length of `pNew`.
+ * @param[out] pOutput Buffer for the difference. A buffer of `newLength` bytes
+ * is always large enough.
+ * @param[in] outputSize The size of `pOutput`.
+ * @param[out] pOutputLength Set to the length of the difference.
+ *
+ * @return `true` on success; `false` if an input is malformed, has objects nested
+ * deeper than `AWS_IOT_SHADOW_MAX_JSON_DEPTH`, or `pOutput` is too small.
+ */
+bool _AwsIotShadow_DiffJsonObjects( const char * pBase,
+                                    size_t baseLength,
+                                    const char * pNew,
+                                    size_t newLength,
+                                    char * pOutput,
+                                    size_t outputSize,
+                                    size_t * pOutputLength );
+
 #endif /* ifndef AWS_IOT_SHADOW_INTERNAL_H_ */
@@ -121,6 +121,21 @@
  */
 #define TEST_MQTT_PACKET_TYPE_PUBLISH_HEADER    ( MQTT_PACKET_TYPE_PUBLISH + 1 )
 
+/**
+ * @brief Size of the buffer that holds the payload of the last PUBLISH sent.
+ */
+#define LAST_PUBLISH_PAYLOAD_SIZE               ( 256 )
+
+/**
+ * @brief Size of the buffer that holds a simulated Shadow response.
+ */
+#define RESPONSE_PACKET_SIZE                    ( 256 )
+
+/**
+ * @brief Timeout for waiting on merged Shadow UPDATEs in these tests.
+ */
+#define COALESCE_WAIT_TIMEOUT_MS                ( AWS_IOT_SHADOW_COALESCE_WINDOW_MS + 1000 )
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -177,6 +192,21 @@ static uint16_t _lastPacketIdentifier = 0;
  */
 static _receiveContext_t _publishContext = { 0 };
 
+/**
+ * @brief The number of PUBLISH packets sent by the send thread.
+ */
+static size_t _publishCount = 0;
+
+/**
+ * @brief The payload of the last QoS 1 PUBLISH sent by the send thread.
+ */
+static char _pLastPublishPayload[ LAST_PUBLISH_PAYLOAD_SIZE ] = { 0 };
+
+/**
+ * @brief Length of #_pLastPublishPayload.
+ */
+static size_t _lastPublishPayloadLength = 0;
+
 /*-----------------------------------------------------------*/
 
 /* Using initialized connToContext variable. */
@@ -289,6 +319,8 @@ static size_t _sendSuccess( void * pSendContext,
         {
             case MQTT_PACKET_TYPE_PUBLISH:
 
+                _publishCount++;
+
                 /* Only set the last packet type to PUBLISH for QoS 1. */
                 if( ( ( *pMessage & 0x06 ) >> 1 ) == 1 )
                 {
@@ -385,6 +417,19 @@ static size_t _sendSuccess( void * pSendContext,
             status = _IotMqtt_deserializePublishWrapper( &mqttPacket );
             _lastPacketIdentifier = mqttPacket.packetIdentifier;
 
+            /* Save the payload of the PUBLISH. */
+            if( status == IOT_MQTT_SUCCESS )
+            {
+                AwsIotShadow_Assert( deserializedPublish.u.publish.publishInfo.payloadLength <
+                                     LAST_PUBLISH_PAYLOAD_SIZE );
+
+                _lastPublishPayloadLength = deserializedPublish.u.publish.publishInfo.payloadLength;
+                ( void ) memcpy( _pLastPublishPayload,
+                                 deserializedPublish.u.publish.publishInfo.pPayload,
+                                 _lastPublishPayloadLength );
+                _pLastPublishPayload[ _lastPublishPayloadLength ] = '\0';
+            }
+
             /* Clear the publish data stored. */
             if( _publishContext.dataLength != 0 )
             {
@@ -450,6 +495,104 @@ static size_t _receive( void * pConnection,
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Simulates a Shadow response by passing a QoS 0 PUBLISH to the MQTT
+ * receive callback.
+ */
+static void _receiveShadowResponse( const char * pTopicName,
+                                    const char * pPayload )
+{
+    uint8_t pReceivedData[ RESPONSE_PACKET_SIZE ] = { 0 };
+    _receiveContext_t receiveContext = { 0 };
+    const size_t topicNameLength = strlen( pTopicName );
+    const size_t payloadLength = strlen( pPayload );
+    size_t remainingLength = sizeof( uint16_t ) + topicNameLength + payloadLength;
+    size_t dataIndex = 0;
+    uint8_t encodedByte = 0;
+
+    /* Set the packet type, then encode the remaining length. */
+    pReceivedData[ dataIndex++ ] = MQTT_PACKET_TYPE_PUBLISH;
+
+    do
+    {
+        encodedByte = ( uint8_t ) ( remainingLength % 128 );
+        remainingLength = remainingLength / 128;
+
+        if( remainingLength > 0 )
+        {
+            encodedByte |= 0x80;
+        }
+
+        pReceivedData[ dataIndex++ ] = encodedByte;
+    } while( remainingLength > 0 );
+
+    AwsIotShadow_Assert( dataIndex + sizeof( uint16_t ) + topicNameLength + payloadLength <=
+                         RESPONSE_PACKET_SIZE );
+
+    /* Set the topic name and payload. */
+    pReceivedData[ dataIndex++ ] = UINT16_HIGH_BYTE( topicNameLength );
+    pReceivedData[ dataIndex++ ] = UINT16_LOW_BYTE( topicNameLength );
+    ( void ) memcpy( pReceivedData + dataIndex, pTopicName, topicNameLength );
+    dataIndex += topicNameLength;
+    ( void ) memcpy( pReceivedData + dataIndex, pPayload, payloadLength );
+    dataIndex += payloadLength;
+
+    receiveContext.pData = pReceivedData;
+    receiveContext.dataLength = dataIndex;
+
+    /* Serialize with the receive thread, which also calls the MQTT receive
+     * callback. */
+    IotMutex_Lock( &_lastPacketMutex );
+    IotMqtt_ReceiveCallback( &receiveContext,
+                             _pMqttConnection );
+    IotMutex_Unlock( &_lastPacketMutex );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Starts two merged Shadow UPDATEs and waits until the merged update
+ * would have been published.
+ */
+static void _startCoalescedUpdates( uint32_t flags,
+                                    AwsIotShadowOperation_t * pFirstOperation,
+                                    AwsIotShadowOperation_t * pSecondOperation )
+{
+    AwsIotShadowDocumentInfo_t documentInfo = AWS_IOT_SHADOW_DOCUMENT_INFO_INITIALIZER;
+
+    /* Set the members of the document info. */
+    documentInfo.pThingName = TEST_THING_NAME;
+    documentInfo.thingNameLength = TEST_THING_NAME_LENGTH;
+    documentInfo.qos = IOT_MQTT_QOS_1;
+
+    /* Both UPDATEs must be made within the same window. The first one also
+     * adds the Shadow UPDATE subscriptions. */
+    documentInfo.u.update.pUpdateDocument = "{\"state\":{\"reported\":{\"a\":1}},\"clientToken\":\"first\"}";
+    documentInfo.u.update.updateDocumentLength = strlen( documentInfo.u.update.pUpdateDocument );
+
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_STATUS_PENDING,
+                       AwsIotShadow_Update( _pMqttConnection,
+                                            &documentInfo,
+                                            AWS_IOT_SHADOW_FLAG_WAITABLE | AWS_IOT_SHADOW_FLAG_COALESCE | flags,
+                                            NULL,
+                                            pFirstOperation ) );
+
+    documentInfo.u.update.pUpdateDocument = "{\"state\":{\"reported\":{\"b\":2}},\"clientToken\":\"second\"}";
+    documentInfo.u.update.updateDocumentLength = strlen( documentInfo.u.update.pUpdateDocument );
+
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_STATUS_PENDING,
+                       AwsIotShadow_Update( _pMqttConnection,
+                                            &documentInfo,
+                                            AWS_IOT_SHADOW_FLAG_WAITABLE | AWS_IOT_SHADOW_FLAG_COALESCE | flags,
+                                            NULL,
+                                            pSecondOperation ) );
+
+    /* Nothing is published until the window ends. */
+    TEST_ASSERT_EQUAL( 0, _publishCount );
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief The time interface provided to the MQTT context used in calling MQTT LTS APIs.
  */
@@ -656,6 +799,11 @@ TEST_SETUP( Shadow_Unit_API )
     _lastPacketType = 0;
     _lastPacketIdentifier = 0;
 
+    /* Clear the information on sent PUBLISH packets. */
+    _publishCount = 0;
+    _lastPublishPayloadLength = 0;
+    ( void ) memset( _pLastPublishPayload, 0x00, LAST_PUBLISH_PAYLOAD_SIZE );
+
     /* Create the mutex that synchronizes the receive callback and send thread. */
     TEST_ASSERT_EQUAL_INT( true, IotMutex_Create( &_lastPacketMutex, false ) );
 
@@ -727,6 +875,10 @@ TEST_GROUP_RUNNER( Shadow_Unit_API )
     RUN_TEST_CASE( Shadow_Unit_API, DeleteMallocFail );
     RUN_TEST_CASE( Shadow_Unit_API, GetMallocFail );
     RUN_TEST_CASE( Shadow_Unit_API, UpdateMallocFail );
+    RUN_TEST_CASE( Shadow_Unit_API, CoalesceUpdateMerge );
+    RUN_TEST_CASE( Shadow_Unit_API, CoalesceUpdateSharedResult );
+    RUN_TEST_CASE( Shadow_Unit_API, CoalesceUpdatePublishFail );
+    RUN_TEST_CASE( Shadow_Unit_API, CoalesceUpdateCleanup );
 }
 
 /*-----------------------------------------------------------*/
@@ -1125,3 +1277,127 @@ TEST( Shadow_Unit_API, UpdateMallocFail )
 }
 
 /*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that Shadow UPDATEs made with #AWS_IOT_SHADOW_FLAG_COALESCE
+ * within one window are merged into a single PUBLISH.
+ */
+TEST( Shadow_Unit_API, CoalesceUpdateMerge )
+{
+    AwsIotShadowOperation_t firstOperation = AWS_IOT_SHADOW_OPERATION_INITIALIZER,
+                            secondOperation = AWS_IOT_SHADOW_OPERATION_INITIALIZER;
+
+    _startCoalescedUpdates( 0, &firstOperation, &secondOperation );
+
+    /* Wait for the merged update to be published. */
+    IotClock_SleepMs( AWS_IOT_SHADOW_COALESCE_WINDOW_MS + NETWORK_ROUND_TRIP_TIME_MS );
+
+    /* One PUBLISH carries the state of both UPDATEs and the client token of
+     * the first. */
+    TEST_ASSERT_EQUAL( 1, _publishCount );
+    TEST_ASSERT_NOT_NULL( strstr( _pLastPublishPayload, "\"a\":1" ) );
+    TEST_ASSERT_NOT_NULL( strstr( _pLastPublishPayload, "\"b\":2" ) );
+    TEST_ASSERT_NOT_NULL( strstr( _pLastPublishPayload, "\"clientToken\":\"first\"" ) );
+    TEST_ASSERT_NULL( strstr( _pLastPublishPayload, "second" ) );
+
+    /* Complete the merged update. */
+    _receiveShadowResponse( SHADOW_TOPIC_PREFIX TEST_THING_NAME SHADOW_UPDATE_OPERATION_STRING SHADOW_ACCEPTED_SUFFIX,
+                            "{\"state\":{\"reported\":{\"a\":1,\"b\":2}},\"version\":1,\"clientToken\":\"first\"}" );
+
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS,
+                       AwsIotShadow_Wait( firstOperation, COALESCE_WAIT_TIMEOUT_MS, NULL, NULL ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS,
+                       AwsIotShadow_Wait( secondOperation, COALESCE_WAIT_TIMEOUT_MS, NULL, NULL ) );
+
+    /* No other PUBLISH was sent. */
+    TEST_ASSERT_EQUAL( 1, _publishCount );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that every merged Shadow UPDATE completes with the result of the
+ * response to the merged update.
+ */
+TEST( Shadow_Unit_API, CoalesceUpdateSharedResult )
+{
+    AwsIotShadowOperation_t firstOperation = AWS_IOT_SHADOW_OPERATION_INITIALIZER,
+                            secondOperation = AWS_IOT_SHADOW_OPERATION_INITIALIZER;
+
+    _startCoalescedUpdates( 0, &firstOperation, &secondOperation );
+
+    /* Wait for the merged update to be published. */
+    IotClock_SleepMs( AWS_IOT_SHADOW_COALESCE_WINDOW_MS + NETWORK_ROUND_TRIP_TIME_MS );
+    TEST_ASSERT_EQUAL( 1, _publishCount );
+
+    /* Reject the merged update. Both UPDATEs must report the rejection. */
+    _receiveShadowResponse( SHADOW_TOPIC_PREFIX TEST_THING_NAME SHADOW_UPDATE_OPERATION_STRING SHADOW_REJECTED_SUFFIX,
+                            "{\"code\":400,\"message\":\"Bad request\",\"clientToken\":\"first\"}" );
+
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_REQUEST,
+                       AwsIotShadow_Wait( firstOperation, COALESCE_WAIT_TIMEOUT_MS, NULL, NULL ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_REQUEST,
+                       AwsIotShadow_Wait( secondOperation, COALESCE_WAIT_TIMEOUT_MS, NULL, NULL ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that every merged Shadow UPDATE completes with the error when
+ * the merged update cannot be published.
+ */
+TEST( Shadow_Unit_API, CoalesceUpdatePublishFail )
+{
+    AwsIotShadowOperation_t firstOperation = AWS_IOT_SHADOW_OPERATION_INITIALIZER,
+                            secondOperation = AWS_IOT_SHADOW_OPERATION_INITIALIZER;
+
+    /* Keep the subscriptions so that completing the UPDATEs does not need
+     * memory for an UNSUBSCRIBE. */
+    _startCoalescedUpdates( AWS_IOT_SHADOW_FLAG_KEEP_SUBSCRIPTIONS,
+                            &firstOperation,
+                            &secondOperation );
+
+    /* Fail the allocation of the merged update document. */
+    UnityMalloc_MakeMallocFailAfterCount( 0 );
+
+    /* No response will arrive, so both UPDATEs are completed with the error
+     * by the publish job. */
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_NO_MEMORY,
+                       AwsIotShadow_Wait( firstOperation, COALESCE_WAIT_TIMEOUT_MS, NULL, NULL ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_NO_MEMORY,
+                       AwsIotShadow_Wait( secondOperation, COALESCE_WAIT_TIMEOUT_MS, NULL, NULL ) );
+
+    UnityMalloc_MakeMallocFailAfterCount( -1 );
+
+    /* Nothing was published. */
+    TEST_ASSERT_EQUAL( 0, _publishCount );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that cleanup waits for a merged Shadow UPDATE publish job that is
+ * already executing, since the job uses the Shadow mutexes.
+ */
+TEST( Shadow_Unit_API, CoalesceUpdateCleanup )
+{
+    AwsIotShadowOperation_t firstOperation = AWS_IOT_SHADOW_OPERATION_INITIALIZER,
+                            secondOperation = AWS_IOT_SHADOW_OPERATION_INITIALIZER;
+
+    _startCoalescedUpdates( 0, &firstOperation, &secondOperation );
+
+    /* Hold the subscription list mutex past the window, so that the publish job
+     * starts executing and can no longer be canceled. */
+    IotMutex_Lock( &_AwsIotShadowSubscriptionsMutex );
+    IotClock_SleepMs( AWS_IOT_SHADOW_COALESCE_WINDOW_MS + NETWORK_ROUND_TRIP_TIME_MS );
+    IotMutex_Unlock( &_AwsIotShadowSubscriptionsMutex );
+
+    /* Cleanup returns only once the publish job is done with the mutexes. */
+    AwsIotShadow_Cleanup();
+    TEST_ASSERT_EQUAL( 0, _AwsIotShadowCoalescedJobCount );
+
+    /* Initialize the Shadow library for test clean up. */
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, AwsIotShadow_Init( 0 ) );
+}
+
+/*-----------------------------------------------------------*/
@@ -52,6 +52,21 @@
  */
 #define ERROR_DOCUMENT_BUFFER_SIZE    ( 128 )
 
+/**
+ * @brief The size of the buffers allocated for merged and diffed JSON objects.
+ */
+#define JSON_OUTPUT_BUFFER_SIZE       ( 256 )
+
+/**
+ * @brief The Thing Name used in the document cache tests.
+ */
+#define TEST_THING_NAME               "TestThingName"
+
+/**
+ * @brief The length of #TEST_THING_NAME.
+ */
+#define TEST_THING_NAME_LENGTH        ( sizeof( TEST_THING_NAME ) - 1 )
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -142,6 +157,138 @@ static void _parseThingName( const char * pTopicName,
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Wrapper for merging JSON objects and checking the result.
+ */
+static void _mergeJson( const char * pBase,
+                        const char * pPatch,
+                        bool removeNulls,
+                        const char * pExpectedResult )
+{
+    char pOutput[ JSON_OUTPUT_BUFFER_SIZE ] = { 0 };
+    size_t outputLength = 0;
+
+    TEST_ASSERT_EQUAL_INT( pExpectedResult != NULL,
+                           _AwsIotShadow_MergeJsonObjects( pBase,
+                                                           pBase == NULL ? 0 : strlen( pBase ),
+                                                           pPatch,
+                                                           strlen( pPatch ),
+                                                           removeNulls,
+                                                           pOutput,
+                                                           sizeof( pOutput ),
+                                                           &outputLength ) );
+
+    if( pExpectedResult != NULL )
+    {
+        TEST_ASSERT_EQUAL( strlen( pExpectedResult ), outputLength );
+        TEST_ASSERT_EQUAL_STRING_LEN( pExpectedResult, pOutput, outputLength );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Wrapper for diffing JSON objects and checking the result.
+ */
+static void _diffJson( const char * pBase,
+                       const char * pNew,
+                       const char * pExpectedResult )
+{
+    char pOutput[ JSON_OUTPUT_BUFFER_SIZE ] = { 0 };
+    size_t outputLength = 0;
+
+    TEST_ASSERT_EQUAL_INT( pExpectedResult != NULL,
+                           _AwsIotShadow_DiffJsonObjects( pBase,
+                                                          pBase == NULL ? 0 : strlen( pBase ),
+                                                          pNew,
+                                                          strlen( pNew ),
+                                                          pOutput,
+                                                          sizeof( pOutput ),
+                                                          &outputLength ) );
+
+    if( pExpectedResult != NULL )
+    {
+        TEST_ASSERT_EQUAL( strlen( pExpectedResult ), outputLength );
+        TEST_ASSERT_EQUAL_STRING_LEN( pExpectedResult, pOutput, outputLength );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Write a JSON object with `depth` levels of nested objects, such as
+ * `{"a":{"a":{}}}` for a depth of 3.
+ */
+static void _nestedJson( char * pBuffer,
+                         size_t bufferSize,
+                         size_t depth )
+{
+    size_t i = 0, length = 0;
+
+    TEST_ASSERT_GREATER_THAN( 6 * depth, bufferSize );
+
+    for( i = 1; i < depth; i++ )
+    {
+        ( void ) memcpy( pBuffer + length, "{\"a\":", 5 );
+        length += 5;
+    }
+
+    ( void ) memcpy( pBuffer + length, "{}", 2 );
+    length += 2;
+
+    for( i = 1; i < depth; i++ )
+    {
+        pBuffer[ length++ ] = '}';
+    }
+
+    pBuffer[ length ] = '\0';
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Apply a Shadow document to the document cache of #TEST_THING_NAME.
+ */
+static void _applyToCache( _shadowCacheSource_t source,
+                           const char * pDocument )
+{
+    _AwsIotShadow_ApplyToCache( TEST_THING_NAME,
+                                TEST_THING_NAME_LENGTH,
+                                source,
+                                pDocument,
+                                strlen( pDocument ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Read the cached document of #TEST_THING_NAME and check the result.
+ */
+static void _checkCachedDocument( uint32_t minimumVersion,
+                                  AwsIotShadowError_t expectedStatus,
+                                  const char * pExpectedDocument )
+{
+    char pDocument[ JSON_OUTPUT_BUFFER_SIZE ] = { 0 };
+    size_t documentLength = 0;
+
+    TEST_ASSERT_EQUAL( expectedStatus,
+                       AwsIotShadow_GetCachedDocument( TEST_THING_NAME,
+                                                       TEST_THING_NAME_LENGTH,
+                                                       minimumVersion,
+                                                       pDocument,
+                                                       sizeof( pDocument ),
+                                                       &documentLength,
+                                                       NULL ) );
+
+    if( expectedStatus == AWS_IOT_SHADOW_SUCCESS )
+    {
+        TEST_ASSERT_EQUAL( strlen( pExpectedDocument ), documentLength );
+        TEST_ASSERT_EQUAL_STRING_LEN( pExpectedDocument, pDocument, documentLength );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Test group for Shadow parser tests.
  */
@@ -183,6 +330,12 @@ TEST_GROUP_RUNNER( Shadow_Unit_Parser )
     RUN_TEST_CASE( Shadow_Unit_Parser, ErrorDocument );
     RUN_TEST_CASE( Shadow_Unit_Parser, ErrorDocumentInvalid );
     RUN_TEST_CASE( Shadow_Unit_Parser, ThingName );
+    RUN_TEST_CASE( Shadow_Unit_Parser, JsonMember );
+    RUN_TEST_CASE( Shadow_Unit_Parser, JsonMerge );
+    RUN_TEST_CASE( Shadow_Unit_Parser, JsonDiff );
+    RUN_TEST_CASE( Shadow_Unit_Parser, JsonMemberSeparators );
+    RUN_TEST_CASE( Shadow_Unit_Parser, JsonDepth );
+    RUN_TEST_CASE( Shadow_Unit_Parser, DocumentCache );
 }
 
 /*-----------------------------------------------------------*/
@@ -461,3 +614,248 @@ TEST( Shadow_Unit_Parser, ThingName )
 }
 
 /*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests finding top-level members of JSON objects.
+ */
+TEST( Shadow_Unit_Parser, JsonMember )
+{
+    const char pObject[] = "{ \"state\": { \"version\": 1 }, \"key\\\"}\": \"a}\", \"version\" : 12 }";
+    const char * pValue = NULL;
+    size_t valueLength = 0;
+
+    /* Keys in nested objects and string values are not matched. */
+    TEST_ASSERT_EQUAL_INT( true, _AwsIotShadow_FindJsonMember( pObject,
+                                                               sizeof( pObject ) - 1,
+                                                               "version",
+                                                               7,
+                                                               &pValue,
+                                                               &valueLength ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "12", pValue, valueLength );
+
+    /* Escaped quotes in keys and braces in strings are skipped. */
+    TEST_ASSERT_EQUAL_INT( true, _AwsIotShadow_FindJsonMember( pObject,
+                                                               sizeof( pObject ) - 1,
+                                                               "state",
+                                                               5,
+                                                               &pValue,
+                                                               &valueLength ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{ \"version\": 1 }", pValue, valueLength );
+
+    /* Missing key. */
+    TEST_ASSERT_EQUAL_INT( false, _AwsIotShadow_FindJsonMember( pObject,
+                                                                sizeof( pObject ) - 1,
+                                                                "desired",
+                                                                7,
+                                                                &pValue,
+                                                                &valueLength ) );
+
+    /* Not an object, and NULL object. */
+    TEST_ASSERT_EQUAL_INT( false, _AwsIotShadow_FindJsonMember( "[1]", 3, "a", 1, &pValue, &valueLength ) );
+    TEST_ASSERT_EQUAL_INT( false, _AwsIotShadow_FindJsonMember( NULL, 0, "a", 1, &pValue, &valueLength ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests merging JSON objects.
+ */
+TEST( Shadow_Unit_Parser, JsonMerge )
+{
+    /* Merge into an absent or empty object. */
+    _mergeJson( NULL, "{\"a\":1}", true, "{\"a\":1}" );
+    _mergeJson( "{}", "{ \"a\" : 1 }", true, "{\"a\":1}" );
+
+    /* Replace, add, and remove members. */
+    _mergeJson( "{\"a\":1,\"b\":\"x\",\"c\":true}",
+                "{\"b\":\"y\",\"c\":null,\"d\":[1,2]}",
+                true,
+                "{\"a\":1,\"b\":\"y\",\"d\":[1,2]}" );
+
+    /* Nested objects are merged, and nulls in new nested objects are dropped. */
+    _mergeJson( "{\"led\":{\"on\":true,\"color\":\"red\"}}",
+                "{\"led\":{\"color\":\"blue\"},\"fan\":{\"speed\":2,\"mode\":null}}",
+                true,
+                "{\"led\":{\"on\":true,\"color\":\"blue\"},\"fan\":{\"speed\":2}}" );
+
+    /* An object replaces a primitive. */
+    _mergeJson( "{\"a\":1}", "{\"a\":{\"b\":2}}", true, "{\"a\":{\"b\":2}}" );
+
+    /* Nulls are kept when combining update documents. */
+    _mergeJson( "{\"reported\":{\"a\":1,\"b\":2}}",
+                "{\"reported\":{\"b\":null,\"c\":{\"d\":null}}}",
+                false,
+                "{\"reported\":{\"a\":1,\"b\":null,\"c\":{\"d\":null}}}" );
+    _mergeJson( "{\"a\":null}", "{\"a\":{\"b\":1}}", false, "{\"a\":{\"b\":1}}" );
+
+    /* Malformed input. */
+    _mergeJson( "{\"a\":1}", "{\"a\"", true, NULL );
+    _mergeJson( "{\"a\":1}", "[1]", true, NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests diffing JSON objects.
+ */
+TEST( Shadow_Unit_Parser, JsonDiff )
+{
+    /* Everything differs from an absent object. */
+    _diffJson( NULL, "{ \"a\" : 1 }", "{\"a\":1}" );
+
+    /* Nothing changed. */
+    _diffJson( "{\"a\":1,\"b\":{\"c\":2}}", "{\"b\":{\"c\":2},\"a\":1}", "{}" );
+
+    /* Changed, added, and removed members. */
+    _diffJson( "{\"a\":1,\"b\":\"x\",\"c\":3}",
+               "{\"a\":1,\"b\":\"y\",\"c\":null,\"d\":null,\"e\":false}",
+               "{\"b\":\"y\",\"c\":null,\"e\":false}" );
+
+    /* Only changed members of nested objects are kept. */
+    _diffJson( "{\"led\":{\"on\":true,\"color\":\"red\"},\"fan\":{\"speed\":2}}",
+               "{\"led\":{\"on\":true,\"color\":\"blue\"},\"fan\":{\"speed\":2}}",
+               "{\"led\":{\"color\":\"blue\"}}" );
+
+    /* Malformed input. */
+    _diffJson( "{\"a\":1}", "{\"a\":", NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that the members of JSON objects must be separated by single commas.
+ */
+TEST( Shadow_Unit_Parser, JsonMemberSeparators )
+{
+    const char pMissingComma[] = "{\"a\":1 \"b\":2}";
+    const char * pValue = NULL;
+    size_t valueLength = 0;
+
+    /* Missing comma between members. */
+    TEST_ASSERT_EQUAL_INT( false, _AwsIotShadow_FindJsonMember( pMissingComma, sizeof( pMissingComma ) - 1, "b", 1, &pValue, &valueLength ) );
+    _mergeJson( "{}", "{\"a\":1 \"b\":2}", true, NULL );
+    _mergeJson( "{\"a\":{\"b\":1}\"c\":2}", "{}", true, NULL );
+    _diffJson( "{}", "{\"a\":\"x\"\"b\":2}", NULL );
+
+    /* Leading, doubled, and trailing commas. */
+    _mergeJson( "{}", "{,\"a\":1}", true, NULL );
+    _mergeJson( "{}", "{\"a\":1,,\"b\":2}", true, NULL );
+    _mergeJson( "{}", "{\"a\":1,}", true, NULL );
+    _diffJson( "{}", "{\"a\":1 , }", NULL );
+
+    /* Whitespace around commas is allowed. */
+    _mergeJson( "{}", "{ \"a\" : 1 , \"b\" : 2 }", true, "{\"a\":1,\"b\":2}" );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that merging and diffing reject objects nested too deeply.
+ */
+TEST( Shadow_Unit_Parser, JsonDepth )
+{
+    char pNested[ JSON_OUTPUT_BUFFER_SIZE ] = { 0 };
+
+    /* Objects nested up to the limit are merged and compared. */
+    _nestedJson( pNested, sizeof( pNested ), AWS_IOT_SHADOW_MAX_JSON_DEPTH );
+    _mergeJson( pNested, pNested, true, pNested );
+    _mergeJson( NULL, pNested, true, pNested );
+    _diffJson( pNested, pNested, "{}" );
+
+    /* One more level fails. */
+    _nestedJson( pNested, sizeof( pNested ), AWS_IOT_SHADOW_MAX_JSON_DEPTH + 1 );
+    _mergeJson( pNested, pNested, true, NULL );
+    _mergeJson( NULL, pNested, true, NULL );
+    _diffJson( pNested, pNested, NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests applying Shadow documents to a document cache and reading it.
+ */
+TEST( Shadow_Unit_Parser, DocumentCache )
+{
+    char pDiff[ JSON_OUTPUT_BUFFER_SIZE ] = { 0 };
+    size_t diffLength = 0;
+    const char pReported[] = "{\"temp\":21,\"led\":\"on\"}";
+
+    /* The cache must be enabled before use. */
+    _checkCachedDocument( 0, AWS_IOT_SHADOW_NOT_FOUND, NULL );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_NOT_FOUND,
+                       AwsIotShadow_DiffReportedState( TEST_THING_NAME,
+                                                       TEST_THING_NAME_LENGTH,
+                                                       pReported,
+                                                       sizeof( pReported ) - 1,
+                                                       pDiff,
+                                                       sizeof( pDiff ),
+                                                       &diffLength ) );
+
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS,
+                       AwsIotShadow_EnableDocumentCache( TEST_THING_NAME,
+                                                         TEST_THING_NAME_LENGTH ) );
+
+    /* An UPDATE response does not synchronize the cache. */
+    _applyToCache( _CACHE_UPDATE_ACCEPTED,
+                   "{\"state\":{\"reported\":{\"temp\":20}},\"version\":3}" );
+    _checkCachedDocument( 0, AWS_IOT_SHADOW_NOT_FOUND, NULL );
+
+    /* A GET response replaces the cache. */
+    _applyToCache( _CACHE_GET_ACCEPTED,
+                   "{\"state\":{\"desired\":{\"led\":\"off\"},\"reported\":{\"temp\":21,\"led\":\"off\"}},"
+                   "\"metadata\":{},\"version\":5}" );
+    _checkCachedDocument( 0,
+                          AWS_IOT_SHADOW_SUCCESS,
+                          "{\"state\":{\"desired\":{\"led\":\"off\"},\"reported\":{\"temp\":21,\"led\":\"off\"}},\"version\":5}" );
+    _checkCachedDocument( 6, AWS_IOT_SHADOW_CONFLICT, NULL );
+
+    /* Delta documents are merged into the desired state; old documents are ignored. */
+    _applyToCache( _CACHE_DELTA, "{\"state\":{\"led\":\"on\"},\"version\":6}" );
+    _applyToCache( _CACHE_DELTA, "{\"state\":{\"led\":\"blink\"},\"version\":4}" );
+    _checkCachedDocument( 6,
+                          AWS_IOT_SHADOW_SUCCESS,
+                          "{\"state\":{\"desired\":{\"led\":\"on\"},\"reported\":{\"temp\":21,\"led\":\"off\"}},\"version\":6}" );
+
+    /* Only the changed member of the reported state is in the diff. */
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS,
+                       AwsIotShadow_DiffReportedState( TEST_THING_NAME,
+                                                       TEST_THING_NAME_LENGTH,
+                                                       pReported,
+                                                       sizeof( pReported ) - 1,
+                                                       pDiff,
+                                                       sizeof( pDiff ),
+                                                       &diffLength ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{\"led\":\"on\"}", pDiff, diffLength );
+
+    /* An accepted UPDATE is merged into the reported state. */
+    _applyToCache( _CACHE_UPDATE_ACCEPTED,
+                   "{\"state\":{\"reported\":{\"led\":\"on\"}},\"version\":7}" );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS,
+                       AwsIotShadow_DiffReportedState( TEST_THING_NAME,
+                                                       TEST_THING_NAME_LENGTH,
+                                                       pReported,
+                                                       sizeof( pReported ) - 1,
+                                                       pDiff,
+                                                       sizeof( pDiff ),
+                                                       &diffLength ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{}", pDiff, diffLength );
+
+    /* A documents message replaces the cache with the current document. */
+    _applyToCache( _CACHE_DOCUMENTS,
+                   "{\"previous\":{\"state\":{},\"version\":7},"
+                   "\"current\":{\"state\":{\"reported\":{\"temp\":22}},\"version\":8}}" );
+    _checkCachedDocument( 8,
+                          AWS_IOT_SHADOW_SUCCESS,
+                          "{\"state\":{\"desired\":{},\"reported\":{\"temp\":22}},\"version\":8}" );
+
+    /* A DELETE response clears the cache. */
+    _applyToCache( _CACHE_DELETE_ACCEPTED, "{\"version\":9}" );
+    _checkCachedDocument( 0, AWS_IOT_SHADOW_NOT_FOUND, NULL );
+
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS,
+                       AwsIotShadow_DisableDocumentCache( TEST_THING_NAME,
+                                                          TEST_THING_NAME_LENGTH ) );
+    _checkCachedDocument( 0, AWS_IOT_SHADOW_NOT_FOUND, NULL );
+}
+
+/*-----------------------------------------------------------*/
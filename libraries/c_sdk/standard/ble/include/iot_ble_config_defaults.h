@@ -309,6 +309,15 @@
     #define IOT_BLE_WIFI_PROVISIONIG_MAX_SCAN_NETWORKS    ( 10 )
 #endif
 
+/**
+ * @brief Size of the buffer that list network responses are encoded in for WIFI provisioning.
+ *
+ * The buffer is reused for every response. When the GATT client asks for packed responses, networks are
+ * packed into it up to the transmit length of the BLE connection.
+ */
+#ifndef IOT_BLE_WIFI_PROVISIONING_NETWORK_MESSAGE_SIZE
+    #define IOT_BLE_WIFI_PROVISIONING_NETWORK_MESSAGE_SIZE    ( IOT_BLE_PREFERRED_MTU_SIZE - 3 )
+#endif
 
 /* @brief Controls the number of network that can be saved using WIFI provisioning.
  *
@@ -377,6 +386,22 @@
     #define IOT_BLE_DATA_TRANSFER_TIMEOUT_MS    ( 2000 )
 #endif
 
+/**
+ * @brief Framings of the messages on a data transfer channel.
+ * The peer selects one with the second byte it writes to the control characteristic; the default framing is used
+ * if it writes only the first byte or selects a framing the service does not support.
+ */
+#define IOT_BLE_DATA_TRANSFER_FRAMING_DEFAULT    ( 0 )
+#define IOT_BLE_DATA_TRANSFER_FRAMING_RAW        ( 1 )
+
+/**
+ * @brief Flag to let the peer select raw framing on the MQTT data transfer service.
+ * With raw framing, MQTT 3.1.1 packets are carried as a byte stream, split only at the MTU, instead of as CBOR messages.
+ */
+#ifndef IOT_BLE_MQTT_ENABLE_COMPACT_FRAMING
+    #define IOT_BLE_MQTT_ENABLE_COMPACT_FRAMING    ( 1 )
+#endif
+
 #define IOT_BLE_MESG_ENCODER                    ( _IotSerializerCborEncoder )
 #define IOT_BLE_MESG_DECODER                    ( _IotSerializerCborDecoder )
 
@@ -103,6 +103,55 @@ size_t IotBleDataTransfer_Send( IotBleDataTransferChannel_t * pChannel,
                                 const uint8_t * const pMessage,
                                 size_t messageLength );
 
+/**
+ * @brief Get the channel's send buffer to build a message in place.
+ * Like a large send, waits for the previous large transfer to complete or the timeout to be reached.
+ * The buffer is held until it is passed to IotBleDataTransfer_SendAcquiredBuffer() or IotBleDataTransfer_ReleaseSendBuffer().
+ *
+ * @param[in] pChannel Pointer to data transfer channel.
+ * @param[in] maxLength Largest message that will be written to the buffer.
+ *
+ * @return Pointer to at least maxLength bytes, or NULL if the channel is closed, timed out or the buffer could not be allocated.
+ */
+uint8_t * IotBleDataTransfer_AcquireSendBuffer( IotBleDataTransferChannel_t * pChannel,
+                                                size_t maxLength );
+
+/**
+ * @brief Send the message built in the buffer from IotBleDataTransfer_AcquireSendBuffer(), and give the buffer back.
+ * The message is not copied; for a large message the peer reads the rest straight from the buffer.
+ *
+ * @param[in] pChannel Pointer to data transfer channel.
+ * @param[in] messageLength Length in bytes of the message to be sent.
+ *
+ * @return Number of bytes of message actually sent.
+ */
+size_t IotBleDataTransfer_SendAcquiredBuffer( IotBleDataTransferChannel_t * pChannel,
+                                              size_t messageLength );
+
+/**
+ * @brief Give back the buffer from IotBleDataTransfer_AcquireSendBuffer() without sending anything.
+ *
+ * @param[in] pChannel Pointer to data transfer channel.
+ */
+void IotBleDataTransfer_ReleaseSendBuffer( IotBleDataTransferChannel_t * pChannel );
+
+/**
+ * @brief Get the transmit length of the BLE connection, as set by the negotiated MTU.
+ * Messages shorter than this are sent as a single indication, and longer ones are read by the peer in chunks.
+ *
+ * @return Transmit length in bytes.
+ */
+size_t IotBleDataTransfer_GetTransmitLength( void );
+
+/**
+ * @brief Get the framing of the messages on the channel, as selected by the peer when it opened the channel.
+ *
+ * @param[in] pChannel Pointer to data transfer channel.
+ *
+ * @return IOT_BLE_DATA_TRANSFER_FRAMING_DEFAULT or another framing the service supports, such as IOT_BLE_DATA_TRANSFER_FRAMING_RAW.
+ */
+uint8_t IotBleDataTransfer_GetFraming( const IotBleDataTransferChannel_t * pChannel );
+
 /**
  * @brief Function copies the requested bytes of data from the receive buffer to the user provided buffer.
  * This should always be called in the context of a IotBleDataTransferChannelCallback_t IOT_BLE_DATA_TRANSFER_CHANNEL_DATA_RECEIVED event.
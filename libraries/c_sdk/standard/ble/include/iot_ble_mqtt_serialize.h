@@ -250,6 +250,122 @@ typedef enum MQTTBLEStatus
     MQTTBLEServerRefused /**< Server refused a connection. */
 } MQTTBLEStatus_t;
 
+/**
+ * @defgroup
+ * @brief Worst case sizes of the serialized messages, for sizing the buffer given to the
+ * IotBleMqtt_Encode functions.
+ *
+ * Each message is a CBOR map with one character keys. Strings and arrays cost their contents
+ * plus a head of up to 3 bytes if the length is 16 bits, or 9 bytes if it is a size_t.
+ */
+/** @{ */
+#define IOT_BLE_MQTT_CBOR_KEY_SIZE        ( 2U ) /**< A one character text string. */
+#define IOT_BLE_MQTT_CBOR_SMALL_SIZE      ( 1U ) /**< A map head, message type, QoS or boolean. */
+#define IOT_BLE_MQTT_CBOR_UINT16_SIZE     ( 3U ) /**< A head or integer with a 16 bit argument. */
+#define IOT_BLE_MQTT_CBOR_SIZE_T_SIZE     ( 9U ) /**< A head with a size_t argument. */
+
+#define IOT_BLE_MQTT_CONNECT_SIZE_MAX( clientIdentifierLength, brokerEndpointLength )      \
+    ( IOT_BLE_MQTT_CBOR_SMALL_SIZE + ( 4U * IOT_BLE_MQTT_CBOR_KEY_SIZE ) +                   \
+      IOT_BLE_MQTT_CBOR_SMALL_SIZE + IOT_BLE_MQTT_CBOR_UINT16_SIZE + ( clientIdentifierLength ) + \
+      IOT_BLE_MQTT_CBOR_SIZE_T_SIZE + ( brokerEndpointLength ) + IOT_BLE_MQTT_CBOR_SMALL_SIZE )
+
+#define IOT_BLE_MQTT_PUBLISH_SIZE_MAX( topicNameLength, payloadLength )                    \
+    ( IOT_BLE_MQTT_CBOR_SMALL_SIZE + ( 5U * IOT_BLE_MQTT_CBOR_KEY_SIZE ) +                   \
+      IOT_BLE_MQTT_CBOR_SMALL_SIZE + IOT_BLE_MQTT_CBOR_UINT16_SIZE + ( topicNameLength ) +   \
+      IOT_BLE_MQTT_CBOR_SMALL_SIZE + IOT_BLE_MQTT_CBOR_SIZE_T_SIZE + ( payloadLength ) +     \
+      IOT_BLE_MQTT_CBOR_UINT16_SIZE )
+
+#define IOT_BLE_MQTT_PUBACK_SIZE_MAX                                                      \
+    ( IOT_BLE_MQTT_CBOR_SMALL_SIZE + ( 2U * IOT_BLE_MQTT_CBOR_KEY_SIZE ) +                   \
+      IOT_BLE_MQTT_CBOR_SMALL_SIZE + IOT_BLE_MQTT_CBOR_UINT16_SIZE )
+
+#define IOT_BLE_MQTT_SUBSCRIBE_SIZE_MAX( subscriptionCount, topicFiltersLength )           \
+    ( IOT_BLE_MQTT_CBOR_SMALL_SIZE + ( 4U * IOT_BLE_MQTT_CBOR_KEY_SIZE ) +                   \
+      IOT_BLE_MQTT_CBOR_SMALL_SIZE + ( 2U * IOT_BLE_MQTT_CBOR_SIZE_T_SIZE ) +                \
+      ( ( subscriptionCount ) * ( IOT_BLE_MQTT_CBOR_UINT16_SIZE + IOT_BLE_MQTT_CBOR_SMALL_SIZE ) ) + \
+      ( topicFiltersLength ) + IOT_BLE_MQTT_CBOR_UINT16_SIZE )
+
+#define IOT_BLE_MQTT_UNSUBSCRIBE_SIZE_MAX( subscriptionCount, topicFiltersLength )         \
+    ( IOT_BLE_MQTT_CBOR_SMALL_SIZE + ( 3U * IOT_BLE_MQTT_CBOR_KEY_SIZE ) +                   \
+      IOT_BLE_MQTT_CBOR_SMALL_SIZE + IOT_BLE_MQTT_CBOR_SIZE_T_SIZE +                         \
+      ( ( subscriptionCount ) * IOT_BLE_MQTT_CBOR_UINT16_SIZE ) +                            \
+      ( topicFiltersLength ) + IOT_BLE_MQTT_CBOR_UINT16_SIZE )
+
+#define IOT_BLE_MQTT_PINGREQ_SIZE_MAX \
+    ( IOT_BLE_MQTT_CBOR_SMALL_SIZE + IOT_BLE_MQTT_CBOR_KEY_SIZE + IOT_BLE_MQTT_CBOR_SMALL_SIZE )
+
+#define IOT_BLE_MQTT_DISCONNECT_SIZE_MAX    IOT_BLE_MQTT_PINGREQ_SIZE_MAX
+/** @} */
+
+/**
+ * @defgroup
+ * @brief Fields found by IotBleMqtt_ParsePacket(), set in MQTTBLEPacketView_t.fields.
+ */
+/** @{ */
+#define IOT_BLE_MQTT_FIELD_MSG_TYPE      ( 0x01U )
+#define IOT_BLE_MQTT_FIELD_STATUS        ( 0x02U )
+#define IOT_BLE_MQTT_FIELD_MESSAGE_ID    ( 0x04U )
+#define IOT_BLE_MQTT_FIELD_QOS           ( 0x08U )
+#define IOT_BLE_MQTT_FIELD_TOPIC         ( 0x10U )
+#define IOT_BLE_MQTT_FIELD_PAYLOAD       ( 0x20U )
+/** @} */
+
+/**
+ * @defgroup
+ * @brief A message received over BLE, decoded in place.
+ *
+ * The topic and payload point into the receive buffer and are only valid as long as it is.
+ */
+/** @{ */
+typedef struct MQTTBLEPacketView
+{
+    /**
+     * @brief Message type, or IOT_BLE_MQTT_MSG_TYPE_INVALID if it was missing.
+     */
+    uint8_t packetType;
+
+    /**
+     * @brief Which of the fields below were present in the message.
+     */
+    uint8_t fields;
+
+    /**
+     * @brief Status code of a CONNACK or SUBACK.
+     */
+    int64_t status;
+
+    /**
+     * @brief Message identifier.
+     */
+    uint16_t packetIdentifier;
+
+    /**
+     * @brief Quality of Service of a PUBLISH.
+     */
+    MQTTBLEQoS_t qos;
+
+    /**
+     * @brief Topic name of a PUBLISH.
+     */
+    const char * pTopicName;
+
+    /**
+     * @brief Length of topic name.
+     */
+    size_t topicNameLength;
+
+    /**
+     * @brief Payload of a PUBLISH.
+     */
+    const void * pPayload;
+
+    /**
+     * @brief Payload length.
+     */
+    size_t payloadLength;
+} MQTTBLEPacketView_t;
+/** @} */
+
 
 /**
  * @brief Serialize the MQTT CONNECT message sent over BLE connection.
@@ -488,6 +604,137 @@ uint8_t IotBleMqtt_GetPacketType( const uint8_t * pBuffer,
                                   size_t length );
 
 
+/**
+ * @brief Serialize the MQTT CONNECT message into a caller supplied buffer.
+ *
+ * Unlike IotBleMqtt_SerializeConnect(), the message is written in a single pass with no
+ * allocation, for example straight into the BLE channel's send buffer.
+ *
+ * @param[in] pConnectInfo MQTT CONNECT parameters.
+ * @param[out] pBuffer Buffer to write the message to.
+ * @param[in] bufferSize Size of the buffer, at least #IOT_BLE_MQTT_CONNECT_SIZE_MAX.
+ * @param[out] pPacketSize Length of the serialized message.
+ *
+ * @return #MQTTBLESuccess or #MQTTBLENoMemory if the buffer is too small.
+ */
+MQTTBLEStatus_t IotBleMqtt_EncodeConnect( const MQTTBLEConnectInfo_t * const pConnectInfo,
+                                          uint8_t * pBuffer,
+                                          size_t bufferSize,
+                                          size_t * const pPacketSize );
+
+/**
+ * @brief Serialize the MQTT PUBLISH message into a caller supplied buffer.
+ *
+ * @param[in] pPublishInfo PUBLISH message parameters.
+ * @param[in] packetIdentifier Unique identifier for a QoS 1 PUBLISH message.
+ * @param[out] pBuffer Buffer to write the message to.
+ * @param[in] bufferSize Size of the buffer, at least #IOT_BLE_MQTT_PUBLISH_SIZE_MAX.
+ * @param[out] pPacketSize Length of the serialized message.
+ *
+ * @return #MQTTBLESuccess or #MQTTBLENoMemory if the buffer is too small.
+ */
+MQTTBLEStatus_t IotBleMqtt_EncodePublish( const MQTTBLEPublishInfo_t * const pPublishInfo,
+                                          uint16_t packetIdentifier,
+                                          uint8_t * pBuffer,
+                                          size_t bufferSize,
+                                          size_t * const pPacketSize );
+
+/**
+ * @brief Serialize the MQTT PUBACK message into a caller supplied buffer.
+ *
+ * @param[in] packetIdentifier Identifier to be included in the PUBACK message.
+ * @param[out] pBuffer Buffer to write the message to.
+ * @param[in] bufferSize Size of the buffer, at least #IOT_BLE_MQTT_PUBACK_SIZE_MAX.
+ * @param[out] pPacketSize Length of the serialized message.
+ *
+ * @return #MQTTBLESuccess or #MQTTBLENoMemory if the buffer is too small.
+ */
+MQTTBLEStatus_t IotBleMqtt_EncodePuback( uint16_t packetIdentifier,
+                                         uint8_t * pBuffer,
+                                         size_t bufferSize,
+                                         size_t * const pPacketSize );
+
+/**
+ * @brief Serialize the MQTT SUBSCRIBE message into a caller supplied buffer.
+ *
+ * @param[in] pSubscriptionList Pointer to a array of subscriptions.
+ * @param[in] subscriptionCount Number of subscriptions.
+ * @param[in] packetIdentifier Unique identifier for the SUBSCRIBE message.
+ * @param[out] pBuffer Buffer to write the message to.
+ * @param[in] bufferSize Size of the buffer, at least #IOT_BLE_MQTT_SUBSCRIBE_SIZE_MAX.
+ * @param[out] pPacketSize Length of the serialized message.
+ *
+ * @return #MQTTBLESuccess or #MQTTBLENoMemory if the buffer is too small.
+ */
+MQTTBLEStatus_t IotBleMqtt_EncodeSubscribe( const MQTTBLESubscribeInfo_t * const pSubscriptionList,
+                                            size_t subscriptionCount,
+                                            uint16_t packetIdentifier,
+                                            uint8_t * pBuffer,
+                                            size_t bufferSize,
+                                            size_t * const pPacketSize );
+
+/**
+ * @brief Serialize the MQTT UNSUBSCRIBE message into a caller supplied buffer.
+ *
+ * @param[in] pSubscriptionList Pointer to a array of subscriptions.
+ * @param[in] subscriptionCount Number of subscriptions.
+ * @param[in] packetIdentifier Unique identifier for the UNSUBSCRIBE message.
+ * @param[out] pBuffer Buffer to write the message to.
+ * @param[in] bufferSize Size of the buffer, at least #IOT_BLE_MQTT_UNSUBSCRIBE_SIZE_MAX.
+ * @param[out] pPacketSize Length of the serialized message.
+ *
+ * @return #MQTTBLESuccess or #MQTTBLENoMemory if the buffer is too small.
+ */
+MQTTBLEStatus_t IotBleMqtt_EncodeUnsubscribe( const MQTTBLESubscribeInfo_t * const pSubscriptionList,
+                                              size_t subscriptionCount,
+                                              uint16_t packetIdentifier,
+                                              uint8_t * pBuffer,
+                                              size_t bufferSize,
+                                              size_t * const pPacketSize );
+
+/**
+ * @brief Serialize the MQTT PING request message into a caller supplied buffer.
+ *
+ * @param[out] pBuffer Buffer to write the message to.
+ * @param[in] bufferSize Size of the buffer, at least #IOT_BLE_MQTT_PINGREQ_SIZE_MAX.
+ * @param[out] pPacketSize Length of the serialized message.
+ *
+ * @return #MQTTBLESuccess or #MQTTBLENoMemory if the buffer is too small.
+ */
+MQTTBLEStatus_t IotBleMqtt_EncodePingreq( uint8_t * pBuffer,
+                                          size_t bufferSize,
+                                          size_t * const pPacketSize );
+
+/**
+ * @brief Serialize the MQTT DISCONNECT message into a caller supplied buffer.
+ *
+ * @param[out] pBuffer Buffer to write the message to.
+ * @param[in] bufferSize Size of the buffer, at least #IOT_BLE_MQTT_DISCONNECT_SIZE_MAX.
+ * @param[out] pPacketSize Length of the serialized message.
+ *
+ * @return #MQTTBLESuccess or #MQTTBLENoMemory if the buffer is too small.
+ */
+MQTTBLEStatus_t IotBleMqtt_EncodeDisconnect( uint8_t * pBuffer,
+                                             size_t bufferSize,
+                                             size_t * const pPacketSize );
+
+/**
+ * @brief Decode a message received over BLE connection in place.
+ *
+ * Walks the CBOR map once, without allocating, and records the fields it knows. Unknown
+ * keys, and known keys with a value of the wrong type, are skipped. The
+ * IotBleMqtt_Deserialize functions are built on this.
+ *
+ * @param[in] pBuffer Pointer to start of the message within a buffer.
+ * @param[in] length Length of the message.
+ * @param[out] pView Fields of the message. Strings point into pBuffer.
+ *
+ * @return #MQTTBLESuccess or #MQTTBLEBadResponse if the message is malformed.
+ */
+MQTTBLEStatus_t IotBleMqtt_ParsePacket( const uint8_t * pBuffer,
+                                        size_t length,
+                                        MQTTBLEPacketView_t * pView );
+
 /**
  * @brief Frees an MQTT message.
  *
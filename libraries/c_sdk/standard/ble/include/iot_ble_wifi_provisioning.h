@@ -45,6 +45,7 @@ typedef struct IotBleListNetworkRequest
 {
     int16_t maxNetworks; /**< Max Networks to scan in one request */
     int16_t timeoutMs;   /**< Timeout in MS for scanning */
+    bool packed;         /**< Pack several networks into each response, as a CBOR array of network maps. */
 } IotBleListNetworkRequest_t;
 
 /**
@@ -134,7 +134,14 @@
         }                                                                             \
     }
 
-#define _SERVICE_INITIALIZER( id )                   { .identifier = id }
+/**
+ * @brief Framings other than the default the peer may select on a service, a bit per framing.
+ */
+#define _SUPPORTED_FRAMINGS( id )                                                                                 \
+    ( ( ( ( id ) == IOT_BLE_DATA_TRANSFER_SERVICE_TYPE_MQTT ) && ( IOT_BLE_MQTT_ENABLE_COMPACT_FRAMING == 1 ) ) ? \
+      ( 1U << IOT_BLE_DATA_TRANSFER_FRAMING_RAW ) : 0U )
+
+#define _SERVICE_INITIALIZER( id )                   { .identifier = id, .supportedFramings = _SUPPORTED_FRAMINGS( id ) }
 
 #define CHAR_HANDLE( svc, ch_idx )                   ( ( svc )->pusHandlesBuffer[ ch_idx ] )
 
@@ -202,6 +209,7 @@ struct IotBleDataTransferChannel
 
     bool isUsed;                                  /**< Flag to indicate if the channel is used. */
     bool isOpen;                                  /**< Flag to indicate if the channel is ready to send/receive data. */
+    uint8_t framing;                              /**< Framing of the messages, selected by the peer when it opens the channel. */
 };
 
 
@@ -216,6 +224,7 @@ typedef struct IotBleDataTransferService
     uint8_t identifier;                                       /**< Uniquely identifies a data transfer service. */
     BTService_t gattService;                                  /**< Internal gatt Service structure. */
     IotBleDataTransferChannel_t channel;                      /**< Channel used ot send or receive data. */
+    uint8_t supportedFramings;                                /**< Framings the peer may select, a bit per framing. */
     bool isReady;
 } IotBleDataTransferService_t;
 
@@ -522,6 +531,8 @@ static void _ControlCharCallback( IotBleAttributeEvent_t * pEventParam )
     IotBleEventResponse_t resp;
     IotBleDataTransferService_t * pService;
     IotBleDataTransferChannelEvent_t channelEvent;
+    uint8_t controlValue[ 2 ];
+    uint8_t framing;
 
     resp.pAttrData = &attrData;
     resp.rspErrorStatus = eBTRspErrorNone;
@@ -534,9 +545,12 @@ static void _ControlCharCallback( IotBleAttributeEvent_t * pEventParam )
 
         if( pService != NULL )
         {
+            /* The framing is only reported once the peer has selected one, so older peers read a single byte. */
+            controlValue[ 0 ] = ( uint8_t ) pService->isReady;
+            controlValue[ 1 ] = pService->channel.framing;
             resp.pAttrData->handle = pEventParam->pParamRead->attrHandle;
-            resp.pAttrData->pData = ( uint8_t * ) &pService->isReady;
-            resp.pAttrData->size = 1;
+            resp.pAttrData->pData = controlValue;
+            resp.pAttrData->size = ( pService->channel.framing == IOT_BLE_DATA_TRANSFER_FRAMING_DEFAULT ) ? 1 : 2;
             resp.attrDataOffset = 0;
             resp.eventStatus = eBTStatusSuccess;
         }
@@ -550,6 +564,21 @@ static void _ControlCharCallback( IotBleAttributeEvent_t * pEventParam )
         if( pService != NULL )
         {
             pService->isReady = ( *( ( uint8_t * ) pEventParam->pParamWrite->pValue ) == 1 );
+            pService->channel.framing = IOT_BLE_DATA_TRANSFER_FRAMING_DEFAULT;
+
+            if( ( pService->isReady == true ) && ( pEventParam->pParamWrite->length >= 2 ) )
+            {
+                framing = pEventParam->pParamWrite->pValue[ 1 ];
+
+                if( ( framing < 8U ) && ( ( pService->supportedFramings & ( 1U << framing ) ) != 0U ) )
+                {
+                    pService->channel.framing = framing;
+                }
+                else
+                {
+                    IotLogWarn( "Peer selected unsupported framing %d, using the default framing.", framing );
+                }
+            }
 
             if( pService->channel.callback != NULL )
             {
@@ -843,6 +872,7 @@ static void _connectionCallback( BTStatus_t status,
             {
                 IotBleDataTransfer_Close( &_services[ index ].channel );
                 _services[ index ].isReady = false;
+                _services[ index ].channel.framing = IOT_BLE_DATA_TRANSFER_FRAMING_DEFAULT;
             }
 
             transmitLength = _TRANSMIT_LENGTH( IOT_BLE_PREFERRED_MTU_SIZE );
@@ -981,6 +1011,7 @@ static bool _cleanupService( IotBleDataTransferService_t * pService )
     bool ret = true;
 
     pService->isReady = false;
+    pService->channel.framing = IOT_BLE_DATA_TRANSFER_FRAMING_DEFAULT;
     status = IotBle_DeleteService( &pService->gattService );
 
     if( status != eBTStatusSuccess )
@@ -1255,3 +1286,112 @@ size_t IotBleDataTransfer_Send( IotBleDataTransferChannel_t * pChannel,
 
     return( messageLength - remainingLength );
 }
+
+/*----------------------------------------------------------------------------------------------------------------------------*/
+
+uint8_t * IotBleDataTransfer_AcquireSendBuffer( IotBleDataTransferChannel_t * pChannel,
+                                                size_t maxLength )
+{
+    uint8_t * pBuffer = NULL;
+
+    if( pChannel && pChannel->isOpen )
+    {
+        /* The peer may still be reading the previous large message out of the buffer. */
+        if( IotSemaphore_TimedWait( &pChannel->sendComplete, pChannel->timeout ) == true )
+        {
+            /* The buffer is kept between sends, so it is only reallocated when a message outgrows it. */
+            if( pChannel->sendBuffer.bufferLength < maxLength )
+            {
+                _deleteChannelBuffer( &pChannel->sendBuffer );
+            }
+
+            if( _resizeChannelBuffer( &pChannel->sendBuffer, IOT_BLE_DATA_TRANSFER_TX_BUFFER_SIZE, maxLength ) == true )
+            {
+                pBuffer = pChannel->sendBuffer.pBuffer;
+            }
+            else
+            {
+                IotLogError( "TX Failed, Failed to allocate send buffer." );
+                IotSemaphore_Post( &pChannel->sendComplete );
+            }
+        }
+        else
+        {
+            IotLogError( "TX Failed, channel timed out." );
+        }
+    }
+    else
+    {
+        IotLogError( "TX Failed, channel closed." );
+    }
+
+    return pBuffer;
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------*/
+
+size_t IotBleDataTransfer_SendAcquiredBuffer( IotBleDataTransferChannel_t * pChannel,
+                                              size_t messageLength )
+{
+    size_t bytesSent = 0;
+
+    if( messageLength < transmitLength )
+    {
+        if( _send( pChannel, false, pChannel->sendBuffer.pBuffer, messageLength ) == true )
+        {
+            bytesSent = messageLength;
+        }
+        else
+        {
+            IotLogError( "TX failed, GATT notification failed." );
+        }
+
+        IotSemaphore_Post( &pChannel->sendComplete );
+
+        if( ( bytesSent > 0 ) && ( pChannel->callback != NULL ) )
+        {
+            pChannel->callback( IOT_BLE_DATA_TRANSFER_CHANNEL_DATA_SENT, pChannel, pChannel->pContext );
+        }
+    }
+    else
+    {
+        /* The first chunk goes out as an indication, and the peer reads the rest from the tail onwards.
+         * The read of the last chunk gives the buffer back. */
+        pChannel->sendBuffer.tail = transmitLength;
+        pChannel->sendBuffer.head = messageLength;
+
+        if( _send( pChannel, true, pChannel->sendBuffer.pBuffer, transmitLength ) == true )
+        {
+            bytesSent = messageLength;
+        }
+        else
+        {
+            IotLogError( "TX Failed, GATT notification failed." );
+            pChannel->sendBuffer.head = pChannel->sendBuffer.tail = 0;
+            IotSemaphore_Post( &pChannel->sendComplete );
+        }
+    }
+
+    return bytesSent;
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------*/
+
+void IotBleDataTransfer_ReleaseSendBuffer( IotBleDataTransferChannel_t * pChannel )
+{
+    IotSemaphore_Post( &pChannel->sendComplete );
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------*/
+
+size_t IotBleDataTransfer_GetTransmitLength( void )
+{
+    return transmitLength;
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------*/
+
+uint8_t IotBleDataTransfer_GetFraming( const IotBleDataTransferChannel_t * pChannel )
+{
+    return pChannel->framing;
+}
@@ -40,7 +40,6 @@
 #include "iot_ble_config.h"
 
 /* MQTT internal includes. */
-#include "iot_serializer.h"
 #include "iot_ble_data_transfer.h"
 #include "iot_ble_mqtt_serialize.h"
 
@@ -67,10 +66,6 @@
 #endif
 #include "logging_stack.h"
 
-#define _IS_VALID_SERIALIZER_RET( ret, pSerializerBuf ) \
-    ( ( ret == IOT_SERIALIZER_SUCCESS ) ||              \
-      ( ( !pSerializerBuf ) && ( ret == IOT_SERIALIZER_BUFFER_TOO_SMALL ) ) )
-
 #define _NUM_CONNECT_PARMAS            ( 4 )
 #define _NUM_DEFAULT_PUBLISH_PARMAS    ( 4 )
 #define _NUM_PUBACK_PARMAS             ( 2 )
@@ -85,723 +80,746 @@ static inline uint16_t _getNumPublishParams( const MQTTBLEPublishInfo_t * const
     return ( pPublish->qos > 0 ) ? ( _NUM_DEFAULT_PUBLISH_PARMAS + 1 ) : _NUM_DEFAULT_PUBLISH_PARMAS;
 }
 
-static IotSerializerError_t _serializeConnect( const MQTTBLEConnectInfo_t * const pConnectInfo,
-                                               uint8_t * const pBuffer,
-                                               size_t * const pSize );
-static IotSerializerError_t _serializePublish( const MQTTBLEPublishInfo_t * const pPublishInfo,
-                                               uint8_t * pBuffer,
-                                               size_t * pSize,
-                                               uint16_t packetIdentifier );
-static IotSerializerError_t _serializePubAck( uint16_t packetIdentifier,
-                                              uint8_t * pBuffer,
-                                              size_t * pSize );
-
-static IotSerializerError_t _serializeSubscribe( const MQTTBLESubscribeInfo_t * const pSubscriptionList,
-                                                 size_t subscriptionCount,
-                                                 uint8_t * const pBuffer,
-                                                 size_t * const pSize,
-                                                 uint16_t packetIdentifier );
-
-static IotSerializerError_t _serializeUnSubscribe( const MQTTBLESubscribeInfo_t * const pSubscriptionList,
-                                                   size_t subscriptionCount,
-                                                   uint8_t * const pBuffer,
-                                                   size_t * const pSize,
-                                                   uint16_t packetIdentifier );
-
-static IotSerializerError_t _serializeDisconnect( uint8_t * const pBuffer,
-                                                  size_t * const pSize );
+/* CBOR major types, already shifted into the initial byte. */
+#define _CBOR_UNSIGNED_INT    ( 0x00U )
+#define _CBOR_NEGATIVE_INT    ( 0x20U )
+#define _CBOR_BYTE_STRING     ( 0x40U )
+#define _CBOR_TEXT_STRING     ( 0x60U )
+#define _CBOR_ARRAY           ( 0x80U )
+#define _CBOR_MAP             ( 0xA0U )
+#define _CBOR_TAG             ( 0xC0U )
+#define _CBOR_SIMPLE          ( 0xE0U )
 
+#define _CBOR_MAJOR_TYPE_MASK ( 0xE0U )
+#define _CBOR_INFO_MASK       ( 0x1FU )
 
-static IotSerializerError_t _serializePingRequest( uint8_t * const pBuffer,
-                                                   size_t * const pSize );
+/* Additional information values of the initial byte. */
+#define _CBOR_INFO_UINT8      ( 24U )
+#define _CBOR_INFO_UINT64     ( 27U )
+#define _CBOR_INFO_INDEFINITE ( 31U )
 
+#define _CBOR_FALSE           ( 0xF4U )
+#define _CBOR_TRUE            ( 0xF5U )
+#define _CBOR_BREAK           ( 0xFFU )
 
-/* Declaration of snprintf. The header stdio.h is not included because it
- * includes conflicting symbols on some platforms. */
-extern int snprintf( char * s,
-                     size_t n,
-                     const char * format,
-                     ... );
+/**
+ * @brief Position in a message being decoded.
+ */
+typedef struct _cborReader
+{
+    const uint8_t * pNext;
+    const uint8_t * pEnd;
+} _cborReader_t;
 
 /*-----------------------------------------------------------*/
 
-static IotSerializerError_t _serializeConnect( const MQTTBLEConnectInfo_t * pConnectInfo,
-                                               uint8_t * const pBuffer,
-                                               size_t * const pSize )
-{
-    IotSerializerError_t error = IOT_SERIALIZER_SUCCESS;
-    IotSerializerEncoderObject_t encoderObj = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_STREAM;
-    IotSerializerEncoderObject_t connectMap = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
-    IotSerializerScalarData_t data = { 0 };
+/* Messages are written with the shortest head for each value, as tinycbor does, so they are
+ * byte for byte what the companion device SDKs have always received. The buffer is checked
+ * against the worst case size once, before anything is written. */
 
-    error = IOT_BLE_MESG_ENCODER.init( &encoderObj, pBuffer, *pSize );
+static uint8_t * _cborPutHead( uint8_t * pOut,
+                               uint8_t majorType,
+                               uint64_t value )
+{
+    uint8_t info = ( uint8_t ) value;
+    size_t length = 0;
 
-    if( error == IOT_SERIALIZER_SUCCESS )
+    if( value >= _CBOR_INFO_UINT8 )
     {
-        error = IOT_BLE_MESG_ENCODER.openContainer(
-            &encoderObj,
-            &connectMap,
-            _NUM_CONNECT_PARMAS );
-    }
+        /* 24, 25, 26 or 27 for an argument of 1, 2, 4 or 8 bytes. */
+        info = _CBOR_INFO_UINT8;
+        length = 1U;
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        data.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
-        data.value.u.signedInt = IOT_BLE_MQTT_MSG_TYPE_CONNECT;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &connectMap, IOT_BLE_MQTT_MSG_TYPE, data );
+        while( ( length < 8U ) && ( ( value >> ( 8U * length ) ) != 0U ) )
+        {
+            info++;
+            length *= 2U;
+        }
     }
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        data.type = IOT_SERIALIZER_SCALAR_TEXT_STRING;
-        data.value.u.string.pString = ( uint8_t * ) pConnectInfo->pClientIdentifier;
-        data.value.u.string.length = pConnectInfo->clientIdentifierLength;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &connectMap, IOT_BLE_MQTT_CLIENT_ID, data );
-    }
+    *pOut++ = majorType | info;
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    while( length > 0U )
     {
-        data.type = IOT_SERIALIZER_SCALAR_TEXT_STRING;
-        data.value.u.string.pString = ( uint8_t * ) clientcredentialMQTT_BROKER_ENDPOINT;
-        data.value.u.string.length = strlen( clientcredentialMQTT_BROKER_ENDPOINT );
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &connectMap, IOT_BLE_MQTT_BROKER_EP, data );
+        length--;
+        *pOut++ = ( uint8_t ) ( value >> ( 8U * length ) );
     }
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        data.type = IOT_SERIALIZER_SCALAR_BOOL;
-        data.value.u.booleanValue = pConnectInfo->cleanSession;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &connectMap, IOT_BLE_MQTT_CLEAN_SESSION, data );
-    }
+    return pOut;
+}
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        error = IOT_BLE_MESG_ENCODER.closeContainer( &encoderObj, &connectMap );
-    }
+static uint8_t * _cborPutString( uint8_t * pOut,
+                                 uint8_t majorType,
+                                 const void * pData,
+                                 size_t length )
+{
+    pOut = _cborPutHead( pOut, majorType, length );
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    if( length > 0U )
     {
-        if( pBuffer == NULL )
-        {
-            *pSize = IOT_BLE_MESG_ENCODER.getExtraBufferSizeNeeded( &encoderObj );
-        }
-        else
-        {
-            *pSize = IOT_BLE_MESG_ENCODER.getEncodedSize( &encoderObj, pBuffer );
-        }
-
-        IOT_BLE_MESG_ENCODER.destroy( &encoderObj );
-        error = IOT_SERIALIZER_SUCCESS;
+        ( void ) memcpy( pOut, pData, length );
     }
 
-    return error;
+    return pOut + length;
 }
 
-static IotSerializerError_t _serializePublish( const MQTTBLEPublishInfo_t * const pPublishInfo,
-                                               uint8_t * pBuffer,
-                                               size_t * pSize,
-                                               uint16_t packetIdentifier )
+static uint8_t * _cborPutKey( uint8_t * pOut,
+                              const char * pKey )
 {
-    IotSerializerError_t error = IOT_SERIALIZER_SUCCESS;
-    IotSerializerEncoderObject_t encoderObj = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_STREAM;
-    IotSerializerEncoderObject_t publishMap = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
-    IotSerializerScalarData_t data = { 0 };
-    uint16_t numPublishParams = _getNumPublishParams( pPublishInfo );
+    return _cborPutString( pOut, _CBOR_TEXT_STRING, pKey, strlen( pKey ) );
+}
 
-    error = IOT_BLE_MESG_ENCODER.init( &encoderObj, pBuffer, *pSize );
+static uint8_t * _cborPutInt( uint8_t * pOut,
+                              const char * pKey,
+                              uint64_t value )
+{
+    pOut = _cborPutKey( pOut, pKey );
 
-    if( error == IOT_SERIALIZER_SUCCESS )
-    {
-        error = IOT_BLE_MESG_ENCODER.openContainer(
-            &encoderObj,
-            &publishMap,
-            numPublishParams );
-    }
+    return _cborPutHead( pOut, _CBOR_UNSIGNED_INT, value );
+}
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        data.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
-        data.value.u.signedInt = IOT_BLE_MQTT_MSG_TYPE_PUBLISH;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &publishMap, IOT_BLE_MQTT_MSG_TYPE, data );
-    }
+/*-----------------------------------------------------------*/
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        data.type = IOT_SERIALIZER_SCALAR_TEXT_STRING;
-        data.value.u.string.pString = ( uint8_t * ) pPublishInfo->pTopicName;
-        data.value.u.string.length = pPublishInfo->topicNameLength;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &publishMap, IOT_BLE_MQTT_TOPIC, data );
-    }
+/* Reads the initial byte and argument of the next item. For an indefinite length item
+ * pIndefinite is set and the value is 0. */
+static bool _cborGetHead( _cborReader_t * pReader,
+                          uint8_t * pMajorType,
+                          uint64_t * pValue,
+                          bool * pIndefinite )
+{
+    bool ret = true;
+    uint8_t info;
+    size_t length = 0;
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        data.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
-        data.value.u.signedInt = pPublishInfo->qos;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &publishMap, IOT_BLE_MQTT_QOS, data );
-    }
+    *pValue = 0;
+    *pIndefinite = false;
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    if( pReader->pNext >= pReader->pEnd )
     {
-        data.type = IOT_SERIALIZER_SCALAR_BYTE_STRING;
-        data.value.u.string.pString = ( uint8_t * ) pPublishInfo->pPayload;
-        data.value.u.string.length = pPublishInfo->payloadLength;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &publishMap, IOT_BLE_MQTT_PAYLOAD, data );
+        ret = false;
     }
-
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    else
     {
-        if( pPublishInfo->qos != 0 )
+        *pMajorType = *pReader->pNext & _CBOR_MAJOR_TYPE_MASK;
+        info = *pReader->pNext & _CBOR_INFO_MASK;
+        pReader->pNext++;
+
+        if( info < _CBOR_INFO_UINT8 )
         {
-            data.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
-            data.value.u.signedInt = packetIdentifier;
-            error = IOT_BLE_MESG_ENCODER.appendKeyValue( &publishMap, IOT_BLE_MQTT_MESSAGE_ID, data );
+            *pValue = info;
         }
-    }
-
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        error = IOT_BLE_MESG_ENCODER.closeContainer( &encoderObj, &publishMap );
-    }
+        else if( info <= _CBOR_INFO_UINT64 )
+        {
+            length = ( size_t ) 1U << ( info - _CBOR_INFO_UINT8 );
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        if( pBuffer == NULL )
+            if( ( size_t ) ( pReader->pEnd - pReader->pNext ) < length )
+            {
+                ret = false;
+            }
+            else
+            {
+                while( length > 0U )
+                {
+                    *pValue = ( *pValue << 8 ) | *pReader->pNext;
+                    pReader->pNext++;
+                    length--;
+                }
+            }
+        }
+        else if( ( info == _CBOR_INFO_INDEFINITE ) &&
+                 ( *pMajorType != _CBOR_UNSIGNED_INT ) &&
+                 ( *pMajorType != _CBOR_NEGATIVE_INT ) &&
+                 ( *pMajorType != _CBOR_TAG ) )
         {
-            *pSize = IOT_BLE_MESG_ENCODER.getExtraBufferSizeNeeded( &encoderObj );
+            *pIndefinite = true;
         }
         else
         {
-            *pSize = IOT_BLE_MESG_ENCODER.getEncodedSize( &encoderObj, pBuffer );
+            ret = false;
         }
-
-        IOT_BLE_MESG_ENCODER.destroy( &encoderObj );
-        error = IOT_SERIALIZER_SUCCESS;
     }
 
-    return error;
+    return ret;
 }
 
-static IotSerializerError_t _serializePubAck( uint16_t packetIdentifier,
-                                              uint8_t * pBuffer,
-                                              size_t * pSize )
-
+/* Reads the contents of a definite length string whose head was just read. */
+static bool _cborGetString( _cborReader_t * pReader,
+                            uint64_t length,
+                            bool indefinite,
+                            const uint8_t ** ppData )
 {
-    IotSerializerError_t error = IOT_SERIALIZER_SUCCESS;
-    IotSerializerEncoderObject_t encoderObj = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_STREAM;
-    IotSerializerEncoderObject_t pubAckMap = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
-    IotSerializerScalarData_t data = { 0 };
+    bool ret = false;
 
-    error = IOT_BLE_MESG_ENCODER.init( &encoderObj, pBuffer, *pSize );
-
-    if( error == IOT_SERIALIZER_SUCCESS )
+    if( ( indefinite == false ) &&
+        ( length <= ( uint64_t ) ( pReader->pEnd - pReader->pNext ) ) )
     {
-        error = IOT_BLE_MESG_ENCODER.openContainer(
-            &encoderObj,
-            &pubAckMap,
-            _NUM_PUBACK_PARMAS );
+        *ppData = pReader->pNext;
+        pReader->pNext += ( size_t ) length;
+        ret = true;
     }
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        data.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
-        data.value.u.signedInt = IOT_BLE_MQTT_MSG_TYPE_PUBACK;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &pubAckMap, IOT_BLE_MQTT_MSG_TYPE, data );
-    }
+    return ret;
+}
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        data.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
-        data.value.u.signedInt = packetIdentifier;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &pubAckMap, IOT_BLE_MQTT_MESSAGE_ID, data );
-    }
+/* Reads an integer value, either major type 0 or 1. */
+static bool _cborGetInt( _cborReader_t * pReader,
+                         int64_t * pValue )
+{
+    bool ret;
+    bool indefinite;
+    uint8_t majorType = _CBOR_SIMPLE;
+    uint64_t value;
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        error = IOT_BLE_MESG_ENCODER.closeContainer( &encoderObj, &pubAckMap );
-    }
+    ret = _cborGetHead( pReader, &majorType, &value, &indefinite );
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    if( ( ret == true ) && ( value <= ( uint64_t ) INT64_MAX ) )
     {
-        if( pBuffer == NULL )
+        if( majorType == _CBOR_UNSIGNED_INT )
         {
-            *pSize = IOT_BLE_MESG_ENCODER.getExtraBufferSizeNeeded( &encoderObj );
+            *pValue = ( int64_t ) value;
+        }
+        else if( majorType == _CBOR_NEGATIVE_INT )
+        {
+            *pValue = -1 - ( int64_t ) value;
         }
         else
         {
-            *pSize = IOT_BLE_MESG_ENCODER.getEncodedSize( &encoderObj, pBuffer );
+            ret = false;
         }
-
-        IOT_BLE_MESG_ENCODER.destroy( &encoderObj );
-        error = IOT_SERIALIZER_SUCCESS;
+    }
+    else
+    {
+        ret = false;
     }
 
-    return error;
+    return ret;
 }
 
-
-static IotSerializerError_t _serializeSubscribe( const MQTTBLESubscribeInfo_t * const pSubscriptionList,
-                                                 size_t subscriptionCount,
-                                                 uint8_t * const pBuffer,
-                                                 size_t * const pSize,
-                                                 uint16_t packetIdentifier )
+/* Skips over one item. Definite length containers are skipped by counting the items they
+ * hold, so there is no recursion. */
+static bool _cborSkip( _cborReader_t * pReader )
 {
-    IotSerializerError_t error = IOT_SERIALIZER_SUCCESS;
-    IotSerializerEncoderObject_t encoderObj = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_STREAM;
-    IotSerializerEncoderObject_t subscribeMap = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
-    IotSerializerEncoderObject_t subscriptionArray = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_ARRAY;
-    IotSerializerScalarData_t data = { 0 };
-    uint16_t idx;
-
-    error = IOT_BLE_MESG_ENCODER.init( &encoderObj, pBuffer, *pSize );
+    bool ret = true;
+    bool indefinite;
+    uint8_t majorType = _CBOR_SIMPLE;
+    uint64_t value;
+    uint64_t pending = 1U;
+    const uint8_t * pData;
 
-    if( error == IOT_SERIALIZER_SUCCESS )
+    while( ( ret == true ) && ( pending > 0U ) )
     {
-        error = IOT_BLE_MESG_ENCODER.openContainer(
-            &encoderObj,
-            &subscribeMap,
-            _NUM_SUBACK_PARAMS );
-    }
+        pending--;
+        ret = _cborGetHead( pReader, &majorType, &value, &indefinite );
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        data.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
-        data.value.u.signedInt = IOT_BLE_MQTT_MSG_TYPE_SUBSCRIBE;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &subscribeMap, IOT_BLE_MQTT_MSG_TYPE, data );
+        if( ret == true )
+        {
+            switch( majorType )
+            {
+                case _CBOR_BYTE_STRING:
+                case _CBOR_TEXT_STRING:
+                    ret = _cborGetString( pReader, value, indefinite, &pData );
+                    break;
+
+                case _CBOR_ARRAY:
+                case _CBOR_MAP:
+
+                    /* Every item takes at least a byte, which bounds the count. */
+                    if( ( indefinite == true ) ||
+                        ( value > ( uint64_t ) ( pReader->pEnd - pReader->pNext ) ) )
+                    {
+                        ret = false;
+                    }
+                    else
+                    {
+                        pending += ( majorType == _CBOR_MAP ) ? ( 2U * value ) : value;
+                    }
+
+                    break;
+
+                case _CBOR_TAG:
+                    pending++;
+                    break;
+
+                case _CBOR_SIMPLE:
+                    /* A break has nothing to end here. */
+                    ret = ( indefinite == false );
+                    break;
+
+                default:
+                    break;
+            }
+
+            if( pending > ( uint64_t ) ( pReader->pEnd - pReader->pNext ) )
+            {
+                ret = false;
+            }
+        }
     }
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    return ret;
+}
+
+/*-----------------------------------------------------------*/
+
+/* The serialize functions allocate a buffer of the worst case size and encode into it. */
+static MQTTBLEStatus_t _finishPacket( MQTTBLEStatus_t status,
+                                      uint8_t * pBuffer,
+                                      uint8_t ** const pPacket,
+                                      size_t * const pPacketSize )
+{
+    if( status == MQTTBLESuccess )
     {
-        error = IOT_BLE_MESG_ENCODER.openContainerWithKey(
-            &subscribeMap,
-            IOT_BLE_MQTT_TOPIC_LIST,
-            &subscriptionArray,
-            subscriptionCount );
+        *pPacket = pBuffer;
     }
-
-    for( idx = 0; idx < subscriptionCount; idx++ )
+    else
     {
-        if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-        {
-            data.type = IOT_SERIALIZER_SCALAR_TEXT_STRING;
-            data.value.u.string.pString = ( uint8_t * ) pSubscriptionList[ idx ].pTopicFilter;
-            data.value.u.string.length = pSubscriptionList[ idx ].topicFilterLength;
-            error = IOT_BLE_MESG_ENCODER.append( &subscriptionArray, data );
-        }
-        else
+        if( pBuffer != NULL )
         {
-            break;
+            IotMqtt_FreeMessage( pBuffer );
         }
-    }
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        error = IOT_BLE_MESG_ENCODER.closeContainer( &subscribeMap, &subscriptionArray );
+        *pPacket = NULL;
+        *pPacketSize = 0;
     }
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        error = IOT_BLE_MESG_ENCODER.openContainerWithKey(
-            &subscribeMap,
-            IOT_BLE_MQTT_QOS_LIST,
-            &subscriptionArray,
-            subscriptionCount );
-    }
+    return status;
+}
+
+static size_t _topicFiltersLength( const MQTTBLESubscribeInfo_t * const pSubscriptionList,
+                                   size_t subscriptionCount )
+{
+    size_t idx;
+    size_t length = 0;
 
     for( idx = 0; idx < subscriptionCount; idx++ )
     {
-        if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-        {
-            data.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
-            data.value.u.signedInt = pSubscriptionList[ idx ].qos;
-            error = IOT_BLE_MESG_ENCODER.append( &subscriptionArray, data );
-        }
-        else
-        {
-            break;
-        }
+        length += pSubscriptionList[ idx ].topicFilterLength;
     }
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    return length;
+}
+
+/*-----------------------------------------------------------*/
+
+MQTTBLEStatus_t IotBleMqtt_EncodeConnect( const MQTTBLEConnectInfo_t * const pConnectInfo,
+                                          uint8_t * pBuffer,
+                                          size_t bufferSize,
+                                          size_t * const pPacketSize )
+{
+    MQTTBLEStatus_t ret = MQTTBLESuccess;
+    size_t brokerEndpointLength = strlen( clientcredentialMQTT_BROKER_ENDPOINT );
+    uint8_t * pOut = pBuffer;
+
+    if( bufferSize < IOT_BLE_MQTT_CONNECT_SIZE_MAX( pConnectInfo->clientIdentifierLength, brokerEndpointLength ) )
     {
-        error = IOT_BLE_MESG_ENCODER.closeContainer( &subscribeMap, &subscriptionArray );
+        LogError( ( "Buffer of %lu bytes is too small for CONNECT message.", ( unsigned long ) bufferSize ) );
+        ret = MQTTBLENoMemory;
     }
-
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    else
     {
-        data.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
-        data.value.u.signedInt = packetIdentifier;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &subscribeMap, IOT_BLE_MQTT_MESSAGE_ID, data );
+        pOut = _cborPutHead( pOut, _CBOR_MAP, _NUM_CONNECT_PARMAS );
+        pOut = _cborPutInt( pOut, IOT_BLE_MQTT_MSG_TYPE, IOT_BLE_MQTT_MSG_TYPE_CONNECT );
+        pOut = _cborPutKey( pOut, IOT_BLE_MQTT_CLIENT_ID );
+        pOut = _cborPutString( pOut, _CBOR_TEXT_STRING, pConnectInfo->pClientIdentifier, pConnectInfo->clientIdentifierLength );
+        pOut = _cborPutKey( pOut, IOT_BLE_MQTT_BROKER_EP );
+        pOut = _cborPutString( pOut, _CBOR_TEXT_STRING, clientcredentialMQTT_BROKER_ENDPOINT, brokerEndpointLength );
+        pOut = _cborPutKey( pOut, IOT_BLE_MQTT_CLEAN_SESSION );
+        *pOut++ = ( pConnectInfo->cleanSession == true ) ? _CBOR_TRUE : _CBOR_FALSE;
+
+        *pPacketSize = ( size_t ) ( pOut - pBuffer );
     }
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    return ret;
+}
+
+MQTTBLEStatus_t IotBleMqtt_EncodePublish( const MQTTBLEPublishInfo_t * const pPublishInfo,
+                                          uint16_t packetIdentifier,
+                                          uint8_t * pBuffer,
+                                          size_t bufferSize,
+                                          size_t * const pPacketSize )
+{
+    MQTTBLEStatus_t ret = MQTTBLESuccess;
+    uint8_t * pOut = pBuffer;
+
+    if( bufferSize < IOT_BLE_MQTT_PUBLISH_SIZE_MAX( pPublishInfo->topicNameLength, pPublishInfo->payloadLength ) )
     {
-        error = IOT_BLE_MESG_ENCODER.closeContainer( &encoderObj, &subscribeMap );
+        LogError( ( "Buffer of %lu bytes is too small for PUBLISH message.", ( unsigned long ) bufferSize ) );
+        ret = MQTTBLENoMemory;
     }
-
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    else
     {
-        if( pBuffer == NULL )
-        {
-            *pSize = IOT_BLE_MESG_ENCODER.getExtraBufferSizeNeeded( &encoderObj );
-        }
-        else
+        pOut = _cborPutHead( pOut, _CBOR_MAP, _getNumPublishParams( pPublishInfo ) );
+        pOut = _cborPutInt( pOut, IOT_BLE_MQTT_MSG_TYPE, IOT_BLE_MQTT_MSG_TYPE_PUBLISH );
+        pOut = _cborPutKey( pOut, IOT_BLE_MQTT_TOPIC );
+        pOut = _cborPutString( pOut, _CBOR_TEXT_STRING, pPublishInfo->pTopicName, pPublishInfo->topicNameLength );
+        pOut = _cborPutInt( pOut, IOT_BLE_MQTT_QOS, ( uint64_t ) pPublishInfo->qos );
+        pOut = _cborPutKey( pOut, IOT_BLE_MQTT_PAYLOAD );
+        pOut = _cborPutString( pOut, _CBOR_BYTE_STRING, pPublishInfo->pPayload, pPublishInfo->payloadLength );
+
+        if( pPublishInfo->qos != 0 )
         {
-            *pSize = IOT_BLE_MESG_ENCODER.getEncodedSize( &encoderObj, pBuffer );
+            pOut = _cborPutInt( pOut, IOT_BLE_MQTT_MESSAGE_ID, packetIdentifier );
         }
 
-        IOT_BLE_MESG_ENCODER.destroy( &encoderObj );
-        error = IOT_SERIALIZER_SUCCESS;
+        *pPacketSize = ( size_t ) ( pOut - pBuffer );
     }
 
-    return error;
+    return ret;
 }
 
-static IotSerializerError_t _serializeUnSubscribe( const MQTTBLESubscribeInfo_t * const pSubscriptionList,
-                                                   size_t subscriptionCount,
-                                                   uint8_t * const pBuffer,
-                                                   size_t * const pSize,
-                                                   uint16_t packetIdentifier )
+MQTTBLEStatus_t IotBleMqtt_EncodePuback( uint16_t packetIdentifier,
+                                         uint8_t * pBuffer,
+                                         size_t bufferSize,
+                                         size_t * const pPacketSize )
 {
-    IotSerializerError_t error = IOT_SERIALIZER_SUCCESS;
-    IotSerializerEncoderObject_t encoderObj = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_STREAM;
-    IotSerializerEncoderObject_t subscribeMap = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
-    IotSerializerEncoderObject_t subscriptionArray = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_ARRAY;
-    IotSerializerScalarData_t data = { 0 };
-    uint16_t idx;
-
-    error = IOT_BLE_MESG_ENCODER.init( &encoderObj, pBuffer, *pSize );
+    MQTTBLEStatus_t ret = MQTTBLESuccess;
+    uint8_t * pOut = pBuffer;
 
-    if( error == IOT_SERIALIZER_SUCCESS )
+    if( bufferSize < IOT_BLE_MQTT_PUBACK_SIZE_MAX )
     {
-        error = IOT_BLE_MESG_ENCODER.openContainer(
-            &encoderObj,
-            &subscribeMap,
-            _NUM_UNSUBACK_PARAMS );
+        LogError( ( "Buffer of %lu bytes is too small for PUBACK message.", ( unsigned long ) bufferSize ) );
+        ret = MQTTBLENoMemory;
     }
-
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    else
     {
-        data.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
-        data.value.u.signedInt = IOT_BLE_MQTT_MSG_TYPE_UNSUBSCRIBE;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &subscribeMap, IOT_BLE_MQTT_MSG_TYPE, data );
+        pOut = _cborPutHead( pOut, _CBOR_MAP, _NUM_PUBACK_PARMAS );
+        pOut = _cborPutInt( pOut, IOT_BLE_MQTT_MSG_TYPE, IOT_BLE_MQTT_MSG_TYPE_PUBACK );
+        pOut = _cborPutInt( pOut, IOT_BLE_MQTT_MESSAGE_ID, packetIdentifier );
+
+        *pPacketSize = ( size_t ) ( pOut - pBuffer );
     }
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    return ret;
+}
+
+MQTTBLEStatus_t IotBleMqtt_EncodeSubscribe( const MQTTBLESubscribeInfo_t * const pSubscriptionList,
+                                            size_t subscriptionCount,
+                                            uint16_t packetIdentifier,
+                                            uint8_t * pBuffer,
+                                            size_t bufferSize,
+                                            size_t * const pPacketSize )
+{
+    MQTTBLEStatus_t ret = MQTTBLESuccess;
+    uint8_t * pOut = pBuffer;
+    size_t idx;
+
+    if( bufferSize < IOT_BLE_MQTT_SUBSCRIBE_SIZE_MAX( subscriptionCount, _topicFiltersLength( pSubscriptionList, subscriptionCount ) ) )
     {
-        error = IOT_BLE_MESG_ENCODER.openContainerWithKey(
-            &subscribeMap,
-            IOT_BLE_MQTT_TOPIC_LIST,
-            &subscriptionArray,
-            subscriptionCount );
+        LogError( ( "Buffer of %lu bytes is too small for SUBSCRIBE message.", ( unsigned long ) bufferSize ) );
+        ret = MQTTBLENoMemory;
     }
-
-    for( idx = 0; idx < subscriptionCount; idx++ )
+    else
     {
-        if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+        pOut = _cborPutHead( pOut, _CBOR_MAP, _NUM_SUBACK_PARAMS );
+        pOut = _cborPutInt( pOut, IOT_BLE_MQTT_MSG_TYPE, IOT_BLE_MQTT_MSG_TYPE_SUBSCRIBE );
+        pOut = _cborPutKey( pOut, IOT_BLE_MQTT_TOPIC_LIST );
+        pOut = _cborPutHead( pOut, _CBOR_ARRAY, subscriptionCount );
+
+        for( idx = 0; idx < subscriptionCount; idx++ )
         {
-            data.type = IOT_SERIALIZER_SCALAR_TEXT_STRING;
-            data.value.u.string.pString = ( uint8_t * ) pSubscriptionList[ idx ].pTopicFilter;
-            data.value.u.string.length = pSubscriptionList[ idx ].topicFilterLength;
-            error = IOT_BLE_MESG_ENCODER.append( &subscriptionArray, data );
+            pOut = _cborPutString( pOut,
+                                   _CBOR_TEXT_STRING,
+                                   pSubscriptionList[ idx ].pTopicFilter,
+                                   pSubscriptionList[ idx ].topicFilterLength );
         }
-        else
+
+        pOut = _cborPutKey( pOut, IOT_BLE_MQTT_QOS_LIST );
+        pOut = _cborPutHead( pOut, _CBOR_ARRAY, subscriptionCount );
+
+        for( idx = 0; idx < subscriptionCount; idx++ )
         {
-            break;
+            pOut = _cborPutHead( pOut, _CBOR_UNSIGNED_INT, ( uint64_t ) pSubscriptionList[ idx ].qos );
         }
-    }
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        error = IOT_BLE_MESG_ENCODER.closeContainer( &subscribeMap, &subscriptionArray );
-    }
+        pOut = _cborPutInt( pOut, IOT_BLE_MQTT_MESSAGE_ID, packetIdentifier );
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        data.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
-        data.value.u.signedInt = packetIdentifier;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &subscribeMap, IOT_BLE_MQTT_MESSAGE_ID, data );
+        *pPacketSize = ( size_t ) ( pOut - pBuffer );
     }
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    return ret;
+}
+
+MQTTBLEStatus_t IotBleMqtt_EncodeUnsubscribe( const MQTTBLESubscribeInfo_t * const pSubscriptionList,
+                                              size_t subscriptionCount,
+                                              uint16_t packetIdentifier,
+                                              uint8_t * pBuffer,
+                                              size_t bufferSize,
+                                              size_t * const pPacketSize )
+{
+    MQTTBLEStatus_t ret = MQTTBLESuccess;
+    uint8_t * pOut = pBuffer;
+    size_t idx;
+
+    if( bufferSize < IOT_BLE_MQTT_UNSUBSCRIBE_SIZE_MAX( subscriptionCount, _topicFiltersLength( pSubscriptionList, subscriptionCount ) ) )
     {
-        error = IOT_BLE_MESG_ENCODER.closeContainer( &encoderObj, &subscribeMap );
+        LogError( ( "Buffer of %lu bytes is too small for UNSUBSCRIBE message.", ( unsigned long ) bufferSize ) );
+        ret = MQTTBLENoMemory;
     }
-
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    else
     {
-        if( pBuffer == NULL )
-        {
-            *pSize = IOT_BLE_MESG_ENCODER.getExtraBufferSizeNeeded( &encoderObj );
-        }
-        else
+        pOut = _cborPutHead( pOut, _CBOR_MAP, _NUM_UNSUBACK_PARAMS );
+        pOut = _cborPutInt( pOut, IOT_BLE_MQTT_MSG_TYPE, IOT_BLE_MQTT_MSG_TYPE_UNSUBSCRIBE );
+        pOut = _cborPutKey( pOut, IOT_BLE_MQTT_TOPIC_LIST );
+        pOut = _cborPutHead( pOut, _CBOR_ARRAY, subscriptionCount );
+
+        for( idx = 0; idx < subscriptionCount; idx++ )
         {
-            *pSize = IOT_BLE_MESG_ENCODER.getEncodedSize( &encoderObj, pBuffer );
+            pOut = _cborPutString( pOut,
+                                   _CBOR_TEXT_STRING,
+                                   pSubscriptionList[ idx ].pTopicFilter,
+                                   pSubscriptionList[ idx ].topicFilterLength );
         }
 
-        IOT_BLE_MESG_ENCODER.destroy( &encoderObj );
-        error = IOT_SERIALIZER_SUCCESS;
+        pOut = _cborPutInt( pOut, IOT_BLE_MQTT_MESSAGE_ID, packetIdentifier );
+
+        *pPacketSize = ( size_t ) ( pOut - pBuffer );
     }
 
-    return error;
+    return ret;
 }
 
-static IotSerializerError_t _serializeDisconnect( uint8_t * const pBuffer,
-                                                  size_t * const pSize )
+static MQTTBLEStatus_t _encodeTypeOnly( uint8_t packetType,
+                                        uint8_t * pBuffer,
+                                        size_t bufferSize,
+                                        size_t * const pPacketSize )
 {
-    IotSerializerError_t error = IOT_SERIALIZER_SUCCESS;
-    IotSerializerEncoderObject_t encoderObj = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_STREAM;
-    IotSerializerEncoderObject_t disconnectMap = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
-    IotSerializerScalarData_t data = { 0 };
-
-    error = IOT_BLE_MESG_ENCODER.init( &encoderObj, pBuffer, *pSize );
+    MQTTBLEStatus_t ret = MQTTBLESuccess;
+    uint8_t * pOut = pBuffer;
 
-    if( error == IOT_SERIALIZER_SUCCESS )
+    if( bufferSize < IOT_BLE_MQTT_PINGREQ_SIZE_MAX )
     {
-        error = IOT_BLE_MESG_ENCODER.openContainer(
-            &encoderObj,
-            &disconnectMap,
-            _NUM_DISCONNECT_PARAMS );
+        LogError( ( "Buffer of %lu bytes is too small for message type %d.", ( unsigned long ) bufferSize, packetType ) );
+        ret = MQTTBLENoMemory;
     }
-
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    else
     {
-        data.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
-        data.value.u.signedInt = IOT_BLE_MQTT_MSG_TYPE_DISCONNECT;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &disconnectMap, IOT_BLE_MQTT_MSG_TYPE, data );
-    }
+        pOut = _cborPutHead( pOut, _CBOR_MAP, _NUM_PINGREQUEST_PARAMS );
+        pOut = _cborPutInt( pOut, IOT_BLE_MQTT_MSG_TYPE, packetType );
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        error = IOT_BLE_MESG_ENCODER.closeContainer( &encoderObj, &disconnectMap );
+        *pPacketSize = ( size_t ) ( pOut - pBuffer );
     }
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        if( pBuffer == NULL )
-        {
-            *pSize = IOT_BLE_MESG_ENCODER.getExtraBufferSizeNeeded( &encoderObj );
-        }
-        else
-        {
-            *pSize = IOT_BLE_MESG_ENCODER.getEncodedSize( &encoderObj, pBuffer );
-        }
-
-        IOT_BLE_MESG_ENCODER.destroy( &encoderObj );
-        error = IOT_SERIALIZER_SUCCESS;
-    }
+    return ret;
+}
 
-    return error;
+MQTTBLEStatus_t IotBleMqtt_EncodePingreq( uint8_t * pBuffer,
+                                          size_t bufferSize,
+                                          size_t * const pPacketSize )
+{
+    return _encodeTypeOnly( IOT_BLE_MQTT_MSG_TYPE_PINGREQ, pBuffer, bufferSize, pPacketSize );
 }
 
-static IotSerializerError_t _serializePingRequest( uint8_t * const pBuffer,
-                                                   size_t * const pSize )
+MQTTBLEStatus_t IotBleMqtt_EncodeDisconnect( uint8_t * pBuffer,
+                                             size_t bufferSize,
+                                             size_t * const pPacketSize )
 {
-    IotSerializerError_t error = IOT_SERIALIZER_SUCCESS;
-    IotSerializerEncoderObject_t encoderObj = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_STREAM;
-    IotSerializerEncoderObject_t pingRequest = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
-    IotSerializerScalarData_t data = { 0 };
+    return _encodeTypeOnly( IOT_BLE_MQTT_MSG_TYPE_DISCONNECT, pBuffer, bufferSize, pPacketSize );
+}
 
-    error = IOT_BLE_MESG_ENCODER.init( &encoderObj, pBuffer, *pSize );
+/*-----------------------------------------------------------*/
 
-    if( error == IOT_SERIALIZER_SUCCESS )
-    {
-        error = IOT_BLE_MESG_ENCODER.openContainer(
-            &encoderObj,
-            &pingRequest,
-            _NUM_PINGREQUEST_PARAMS );
-    }
+/* Reads the value of one key into the view. Unknown keys, and known keys whose value has
+ * the wrong type, are skipped; the deserialize functions then find the field missing. */
+static bool _parseValue( _cborReader_t * pReader,
+                         const uint8_t * pKey,
+                         size_t keyLength,
+                         MQTTBLEPacketView_t * pView )
+{
+    bool ret = false;
+    bool indefinite;
+    uint8_t majorType = _CBOR_SIMPLE;
+    uint64_t length = 0;
+    int64_t value = 0;
+    const uint8_t * pData = NULL;
+    const uint8_t * pValue = pReader->pNext;
+    char key = ( keyLength == 1U ) ? ( char ) pKey[ 0 ] : '\0';
+
+    switch( key )
+    {
+        case 'w': /* IOT_BLE_MQTT_MSG_TYPE */
+        case 's': /* IOT_BLE_MQTT_STATUS */
+        case 'i': /* IOT_BLE_MQTT_MESSAGE_ID */
+        case 'n': /* IOT_BLE_MQTT_QOS */
+            ret = _cborGetInt( pReader, &value );
+            break;
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
-    {
-        data.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
-        data.value.u.signedInt = IOT_BLE_MQTT_MSG_TYPE_PINGREQ;
-        error = IOT_BLE_MESG_ENCODER.appendKeyValue( &pingRequest, IOT_BLE_MQTT_MSG_TYPE, data );
+        case 'u': /* IOT_BLE_MQTT_TOPIC */
+        case 'k': /* IOT_BLE_MQTT_PAYLOAD */
+            ret = _cborGetHead( pReader, &majorType, &length, &indefinite ) &&
+                  ( majorType == ( ( key == 'u' ) ? _CBOR_TEXT_STRING : _CBOR_BYTE_STRING ) ) &&
+                  _cborGetString( pReader, length, indefinite, &pData );
+            break;
+
+        default:
+            break;
     }
 
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    if( ret == false )
     {
-        error = IOT_BLE_MESG_ENCODER.closeContainer( &encoderObj, &pingRequest );
+        pReader->pNext = pValue;
+        ret = _cborSkip( pReader );
     }
-
-    if( _IS_VALID_SERIALIZER_RET( error, pBuffer ) )
+    else
     {
-        if( pBuffer == NULL )
-        {
-            *pSize = IOT_BLE_MESG_ENCODER.getExtraBufferSizeNeeded( &encoderObj );
-        }
-        else
+        switch( key )
         {
-            *pSize = IOT_BLE_MESG_ENCODER.getEncodedSize( &encoderObj, pBuffer );
+            case 'w':
+                pView->packetType = ( uint8_t ) value;
+                pView->fields |= IOT_BLE_MQTT_FIELD_MSG_TYPE;
+                break;
+
+            case 's':
+                pView->status = value;
+                pView->fields |= IOT_BLE_MQTT_FIELD_STATUS;
+                break;
+
+            case 'i':
+                pView->packetIdentifier = ( uint16_t ) value;
+                pView->fields |= IOT_BLE_MQTT_FIELD_MESSAGE_ID;
+                break;
+
+            case 'n':
+                pView->qos = ( MQTTBLEQoS_t ) value;
+                pView->fields |= IOT_BLE_MQTT_FIELD_QOS;
+                break;
+
+            case 'u':
+                pView->pTopicName = ( const char * ) pData;
+                pView->topicNameLength = ( size_t ) length;
+                pView->fields |= IOT_BLE_MQTT_FIELD_TOPIC;
+                break;
+
+            default:
+                pView->pPayload = pData;
+                pView->payloadLength = ( size_t ) length;
+                pView->fields |= IOT_BLE_MQTT_FIELD_PAYLOAD;
+                break;
         }
-
-        IOT_BLE_MESG_ENCODER.destroy( &encoderObj );
-        error = IOT_SERIALIZER_SUCCESS;
     }
 
-    return error;
+    return ret;
 }
 
-MQTTBLEStatus_t IotBleMqtt_SerializeConnect( const MQTTBLEConnectInfo_t * const pConnectInfo,
-                                             uint8_t ** const pConnectPacket,
-                                             size_t * const pPacketSize )
+MQTTBLEStatus_t IotBleMqtt_ParsePacket( const uint8_t * pBuffer,
+                                        size_t length,
+                                        MQTTBLEPacketView_t * pView )
 {
-    uint8_t * pBuffer = NULL;
-    size_t bufLen = 0;
-    IotSerializerError_t error;
     MQTTBLEStatus_t ret = MQTTBLESuccess;
+    _cborReader_t reader;
+    uint8_t majorType = _CBOR_SIMPLE;
+    uint64_t pairs = 0;
+    uint64_t keyLength;
+    bool indefinite = false;
+    bool keyIndefinite;
+    const uint8_t * pKey;
 
+    ( void ) memset( pView, 0x00, sizeof( MQTTBLEPacketView_t ) );
+    pView->packetType = IOT_BLE_MQTT_MSG_TYPE_INVALID;
 
-    error = _serializeConnect( pConnectInfo, NULL, &bufLen );
+    reader.pNext = pBuffer;
+    reader.pEnd = ( pBuffer != NULL ) ? ( pBuffer + length ) : NULL;
 
-    if( error != IOT_SERIALIZER_SUCCESS )
+    if( ( _cborGetHead( &reader, &majorType, &pairs, &indefinite ) == false ) ||
+        ( majorType != _CBOR_MAP ) )
     {
-        LogError( ( "Failed to find length of serialized CONNECT message, error = %d", error ) );
-        ret = MQTTBLEBadParameter;
+        LogError( ( "Malformed message, it is not a CBOR map." ) );
+        ret = MQTTBLEBadResponse;
     }
 
-    if( ret == MQTTBLESuccess )
+    while( ( ret == MQTTBLESuccess ) && ( ( indefinite == true ) || ( pairs > 0U ) ) )
     {
-        pBuffer = IotMqtt_MallocMessage( bufLen );
-
-        /* If Memory cannot be allocated log an error and return */
-        if( pBuffer == NULL )
+        if( ( indefinite == true ) &&
+            ( reader.pNext < reader.pEnd ) &&
+            ( *reader.pNext == _CBOR_BREAK ) )
         {
-            LogError( ( "Failed to allocate memory for CONNECT packet." ) );
-            ret = MQTTBLENoMemory;
+            reader.pNext++;
+            break;
         }
-    }
 
-    if( ret == MQTTBLESuccess )
-    {
-        error = _serializeConnect( pConnectInfo, pBuffer, &bufLen );
+        pairs--;
 
-        if( error != IOT_SERIALIZER_SUCCESS )
+        if( ( _cborGetHead( &reader, &majorType, &keyLength, &keyIndefinite ) == false ) ||
+            ( majorType != _CBOR_TEXT_STRING ) ||
+            ( _cborGetString( &reader, keyLength, keyIndefinite, &pKey ) == false ) ||
+            ( _parseValue( &reader, pKey, ( size_t ) keyLength, pView ) == false ) )
         {
-            LogError( ( "Failed to serialize CONNECT message, error = %d", error ) );
-            ret = MQTTBLEBadParameter;
+            LogError( ( "Malformed message, decoding a key value pair failed." ) );
+            ret = MQTTBLEBadResponse;
         }
     }
 
-    if( ret == MQTTBLESuccess )
+    return ret;
+}
+
+/*-----------------------------------------------------------*/
+
+MQTTBLEStatus_t IotBleMqtt_SerializeConnect( const MQTTBLEConnectInfo_t * const pConnectInfo,
+                                             uint8_t ** const pConnectPacket,
+                                             size_t * const pPacketSize )
+{
+    size_t bufLen = IOT_BLE_MQTT_CONNECT_SIZE_MAX( pConnectInfo->clientIdentifierLength,
+                                                   strlen( clientcredentialMQTT_BROKER_ENDPOINT ) );
+    uint8_t * pBuffer = IotMqtt_MallocMessage( bufLen );
+    MQTTBLEStatus_t ret = MQTTBLENoMemory;
+
+    /* If Memory cannot be allocated log an error and return */
+    if( pBuffer == NULL )
     {
-        *pConnectPacket = pBuffer;
-        *pPacketSize = bufLen;
+        LogError( ( "Failed to allocate memory for CONNECT packet." ) );
     }
     else
     {
-        *pConnectPacket = NULL;
-        *pPacketSize = 0;
-
-        if( pBuffer != NULL )
-        {
-            IotMqtt_FreeMessage( pBuffer );
-        }
+        ret = IotBleMqtt_EncodeConnect( pConnectInfo, pBuffer, bufLen, pPacketSize );
     }
 
-    return ret;
+    return _finishPacket( ret, pBuffer, pConnectPacket, pPacketSize );
 }
 
 MQTTBLEStatus_t IotBleMqtt_DeserializeConnack( const uint8_t * pBuffer,
                                                size_t length )
 {
-    IotSerializerDecoderObject_t decoderObj = { 0 }, decoderValue = { 0 };
-    IotSerializerError_t error;
-    MQTTBLEStatus_t ret = MQTTBLESuccess;
-    int64_t respCode = 0L;
-
-    error = IOT_BLE_MESG_DECODER.init( &decoderObj, pBuffer, length );
+    MQTTBLEPacketView_t view;
+    MQTTBLEStatus_t ret;
 
-    if( ( error != IOT_SERIALIZER_SUCCESS ) ||
-        ( decoderObj.type != IOT_SERIALIZER_CONTAINER_MAP ) )
-    {
-        LogError( ( "Malformed CONNACK, decoding the packet failed, decoder error = %d, type: %d", error, decoderObj.type ) );
-        ret = MQTTBLEBadResponse;
-    }
+    ret = IotBleMqtt_ParsePacket( pBuffer, length, &view );
 
     if( ret == MQTTBLESuccess )
     {
-        error = IOT_BLE_MESG_DECODER.find( &decoderObj, IOT_BLE_MQTT_STATUS, &decoderValue );
-
-        if( ( error != IOT_SERIALIZER_SUCCESS ) ||
-            ( decoderValue.type != IOT_SERIALIZER_SCALAR_SIGNED_INT ) )
+        if( ( view.fields & IOT_BLE_MQTT_FIELD_STATUS ) == 0U )
         {
-            LogError( ( "Invalid CONNACK, response code decode failed, error = %d, decoded value type = %d", error, decoderValue.type ) );
+            LogError( ( "Invalid CONNACK, response code is missing." ) );
             ret = MQTTBLEBadResponse;
         }
-        else
+        else if( ( view.status != IOT_BLE_MQTT_STATUS_CONNECTING ) &&
+                 ( view.status != IOT_BLE_MQTT_STATUS_CONNECTED ) )
         {
-            respCode = decoderValue.u.value.u.signedInt;
-
-            if( ( respCode != IOT_BLE_MQTT_STATUS_CONNECTING ) &&
-                ( respCode != IOT_BLE_MQTT_STATUS_CONNECTED ) )
-            {
-                ret = MQTTBLEServerRefused;
-            }
+            ret = MQTTBLEServerRefused;
         }
     }
 
-    IOT_BLE_MESG_DECODER.destroy( &decoderObj );
-
     return ret;
 }
+
 MQTTBLEStatus_t IotBleMqtt_SerializePublish( const MQTTBLEPublishInfo_t * const pPublishInfo,
                                              uint8_t ** const pPublishPacket,
                                              size_t * const pPacketSize,
                                              uint16_t packetIdentifier )
 {
-    uint8_t * pBuffer = NULL;
-    size_t bufLen = 0;
-    IotSerializerError_t error;
-    MQTTBLEStatus_t ret = MQTTBLESuccess;
-
-    error = _serializePublish( pPublishInfo, NULL, &bufLen, packetIdentifier );
-
-    if( error != IOT_SERIALIZER_SUCCESS )
-    {
-        LogError( ( "Failed to find size of serialized PUBLISH message, error = %d", error ) );
-        ret = MQTTBLEBadParameter;
-    }
+    size_t bufLen = IOT_BLE_MQTT_PUBLISH_SIZE_MAX( pPublishInfo->topicNameLength, pPublishInfo->payloadLength );
+    uint8_t * pBuffer = IotMqtt_MallocMessage( bufLen );
+    MQTTBLEStatus_t ret = MQTTBLENoMemory;
 
-    if( ret == MQTTBLESuccess )
+    /* If Memory cannot be allocated log an error and return */
+    if( pBuffer == NULL )
     {
-        pBuffer = IotMqtt_MallocMessage( bufLen );
-
-        /* If Memory cannot be allocated log an error and return */
-        if( pBuffer == NULL )
-        {
-            LogError( ( "Failed to allocate memory for PUBLISH packet." ) );
-            ret = MQTTBLENoMemory;
-        }
-    }
-
-    if( ret == MQTTBLESuccess )
-    {
-        error = _serializePublish( pPublishInfo, pBuffer, &bufLen, packetIdentifier );
-
-        if( error != IOT_SERIALIZER_SUCCESS )
-        {
-            LogError( ( "Failed to serialize PUBLISH message, error = %d", error ) );
-            ret = MQTTBLEBadParameter;
-        }
-    }
-
-    if( ret == MQTTBLESuccess )
-    {
-        *pPublishPacket = pBuffer;
-        *pPacketSize = bufLen;
+        LogError( ( "Failed to allocate memory for PUBLISH packet." ) );
     }
     else
     {
-        if( pBuffer != NULL )
-        {
-            IotMqtt_FreeMessage( pBuffer );
-        }
-
-        *pPublishPacket = NULL;
-        *pPacketSize = 0;
+        ret = IotBleMqtt_EncodePublish( pPublishInfo, packetIdentifier, pBuffer, bufLen, pPacketSize );
     }
 
-    return ret;
+    return _finishPacket( ret, pBuffer, pPublishPacket, pPacketSize );
 }
 
 void IotBleMqtt_PublishSetDup( uint8_t * const pPublishPacket,
@@ -816,99 +834,38 @@ MQTTBLEStatus_t IotBleMqtt_DeserializePublish( uint8_t * pBuffer,
                                                MQTTBLEPublishInfo_t * publishInfo,
                                                uint16_t * packetIdentifier )
 {
-    IotSerializerDecoderObject_t decoderObj = { 0 }, decoderValue = { 0 };
-    IotSerializerError_t xSerializerRet;
-    MQTTBLEStatus_t ret = MQTTBLESuccess;
-
-    xSerializerRet = IOT_BLE_MESG_DECODER.init( &decoderObj, pBuffer, length );
+    MQTTBLEPacketView_t view;
+    MQTTBLEStatus_t ret;
+    uint8_t required = IOT_BLE_MQTT_FIELD_QOS | IOT_BLE_MQTT_FIELD_TOPIC | IOT_BLE_MQTT_FIELD_PAYLOAD;
 
-    if( ( xSerializerRet != IOT_SERIALIZER_SUCCESS ) ||
-        ( decoderObj.type != IOT_SERIALIZER_CONTAINER_MAP ) )
-    {
-        LogError( ( "Decoding PUBLISH packet failed, decoder error = %d, object type = %d", xSerializerRet, decoderObj.type ) );
-        ret = MQTTBLEBadResponse;
-    }
+    ret = IotBleMqtt_ParsePacket( pBuffer, length, &view );
 
-    if( ret == MQTTBLESuccess )
+    if( ( ret == MQTTBLESuccess ) && ( view.qos != 0 ) )
     {
-        xSerializerRet = IOT_BLE_MESG_DECODER.find( &decoderObj, IOT_BLE_MQTT_QOS, &decoderValue );
-
-        if( ( xSerializerRet != IOT_SERIALIZER_SUCCESS ) ||
-            ( decoderValue.type != IOT_SERIALIZER_SCALAR_SIGNED_INT ) )
-        {
-            LogError( ( "QOS Value decode failed, error = %d, decoded value type = %d", xSerializerRet, decoderValue.type ) );
-            ret = MQTTBLEBadResponse;
-        }
-        else
-        {
-            publishInfo->qos = decoderValue.u.value.u.signedInt;
-        }
+        required |= IOT_BLE_MQTT_FIELD_MESSAGE_ID;
     }
 
-    if( ret == MQTTBLESuccess )
+    if( ( ret == MQTTBLESuccess ) && ( ( view.fields & required ) != required ) )
     {
-        decoderValue.u.value.u.string.pString = NULL;
-        decoderValue.u.value.u.string.length = 0;
-        xSerializerRet = IOT_BLE_MESG_DECODER.find( &decoderObj, IOT_BLE_MQTT_TOPIC, &decoderValue );
-
-        if( ( xSerializerRet != IOT_SERIALIZER_SUCCESS ) ||
-            ( decoderValue.type != IOT_SERIALIZER_SCALAR_TEXT_STRING ) )
-        {
-            LogError( ( "Topic value decode failed, error = %d", xSerializerRet ) );
-            ret = MQTTBLEBadResponse;
-        }
-        else
-        {
-            publishInfo->pTopicName = ( const char * ) decoderValue.u.value.u.string.pString;
-            publishInfo->topicNameLength = decoderValue.u.value.u.string.length;
-        }
+        LogError( ( "Invalid PUBLISH, found fields 0x%02x of 0x%02x.", view.fields, required ) );
+        ret = MQTTBLEBadResponse;
     }
 
     if( ret == MQTTBLESuccess )
     {
-        decoderValue.u.value.u.string.pString = NULL;
-        decoderValue.u.value.u.string.length = 0;
-        xSerializerRet = IOT_BLE_MESG_DECODER.find( &decoderObj, IOT_BLE_MQTT_PAYLOAD, &decoderValue );
+        publishInfo->qos = view.qos;
+        publishInfo->pTopicName = view.pTopicName;
+        publishInfo->topicNameLength = ( uint16_t ) view.topicNameLength;
+        publishInfo->pPayload = view.pPayload;
+        publishInfo->payloadLength = view.payloadLength;
+        publishInfo->retain = false;
 
-        if( ( xSerializerRet != IOT_SERIALIZER_SUCCESS ) ||
-            ( decoderValue.type != IOT_SERIALIZER_SCALAR_BYTE_STRING ) )
-        {
-            LogError( ( "Payload value decode failed, error = %d", xSerializerRet ) );
-            ret = MQTTBLEBadResponse;
-        }
-        else
+        if( view.qos != 0 )
         {
-            publishInfo->pPayload = ( const char * ) decoderValue.u.value.u.string.pString;
-            publishInfo->payloadLength = decoderValue.u.value.u.string.length;
-        }
-    }
-
-    if( ret == MQTTBLESuccess )
-    {
-        if( publishInfo->qos != 0 )
-        {
-            xSerializerRet = IOT_BLE_MESG_DECODER.find( &decoderObj, IOT_BLE_MQTT_MESSAGE_ID, &decoderValue );
-
-            if( ( xSerializerRet != IOT_SERIALIZER_SUCCESS ) ||
-                ( decoderValue.type != IOT_SERIALIZER_SCALAR_SIGNED_INT ) )
-            {
-                LogError( ( "Message identifier decode failed, error = %d, decoded value type = %d", xSerializerRet, decoderValue.type ) );
-                ret = MQTTBLEBadResponse;
-            }
-            else
-            {
-                *packetIdentifier = ( uint16_t ) decoderValue.u.value.u.signedInt;
-            }
+            *packetIdentifier = view.packetIdentifier;
         }
     }
 
-    if( ret == MQTTBLESuccess )
-    {
-        publishInfo->retain = false;
-    }
-
-    IOT_BLE_MESG_DECODER.destroy( &decoderObj );
-
     return ret;
 }
 
@@ -916,158 +873,77 @@ MQTTBLEStatus_t IotBleMqtt_SerializePuback( uint16_t packetIdentifier,
                                             uint8_t ** const pPubackPacket,
                                             size_t * const pPacketSize )
 {
-    uint8_t * pBuffer = NULL;
-    size_t bufLen = 0;
-    IotSerializerError_t error;
-    MQTTBLEStatus_t ret = MQTTBLESuccess;
-
-    error = _serializePubAck( packetIdentifier, NULL, &bufLen );
-
-    if( error != IOT_SERIALIZER_SUCCESS )
-    {
-        LogError( ( "Failed to find size of serialized PUBACK message, error = %d", error ) );
-        ret = MQTTBLEBadParameter;
-    }
+    uint8_t * pBuffer = IotMqtt_MallocMessage( IOT_BLE_MQTT_PUBACK_SIZE_MAX );
+    MQTTBLEStatus_t ret = MQTTBLENoMemory;
 
-    if( ret == MQTTBLESuccess )
+    /* If Memory cannot be allocated log an error and return */
+    if( pBuffer == NULL )
     {
-        pBuffer = IotMqtt_MallocMessage( bufLen );
-
-        /* If Memory cannot be allocated log an error and return */
-        if( pBuffer == NULL )
-        {
-            LogError( ( "Failed to allocate memory for PUBACK packet, packet identifier = %d", packetIdentifier ) );
-            ret = MQTTBLENoMemory;
-        }
-    }
-
-    if( ret == MQTTBLESuccess )
-    {
-        error = _serializePubAck( packetIdentifier, pBuffer, &bufLen );
-
-        if( error != IOT_SERIALIZER_SUCCESS )
-        {
-            LogError( ( "Failed to find size of serialized PUBACK message, error = %d", error ) );
-            ret = MQTTBLEBadParameter;
-        }
-    }
-
-    if( ret == MQTTBLESuccess )
-    {
-        *pPubackPacket = pBuffer;
-        *pPacketSize = bufLen;
+        LogError( ( "Failed to allocate memory for PUBACK packet, packet identifier = %d", packetIdentifier ) );
     }
     else
     {
-        if( pBuffer != NULL )
-        {
-            IotMqtt_FreeMessage( pBuffer );
-        }
-
-        *pPubackPacket = NULL;
-        *pPacketSize = 0;
+        ret = IotBleMqtt_EncodePuback( packetIdentifier, pBuffer, IOT_BLE_MQTT_PUBACK_SIZE_MAX, pPacketSize );
     }
 
-    return ret;
+    return _finishPacket( ret, pBuffer, pPubackPacket, pPacketSize );
 }
 
-MQTTBLEStatus_t IotBleMqtt_DeserializePuback( uint8_t * pBuffer,
-                                              size_t length,
-                                              uint16_t * packetIdentifier )
+/* Deserializes a message whose only field of interest is the message identifier. */
+static MQTTBLEStatus_t _deserializeIdentifier( const uint8_t * pBuffer,
+                                               size_t length,
+                                               uint16_t * packetIdentifier )
 {
-    IotSerializerDecoderObject_t decoderObj = { 0 }, decoderValue = { 0 };
-    IotSerializerError_t error;
-    MQTTBLEStatus_t ret = MQTTBLESuccess;
+    MQTTBLEPacketView_t view;
+    MQTTBLEStatus_t ret;
 
-    error = IOT_BLE_MESG_DECODER.init( &decoderObj, pBuffer, length );
-
-    if( ( error != IOT_SERIALIZER_SUCCESS ) ||
-        ( decoderObj.type != IOT_SERIALIZER_CONTAINER_MAP ) )
-    {
-        LogError( ( "Malformed PUBACK, decoding the packet failed, decoder error = %d, object type: %d", error, decoderObj.type ) );
-        ret = MQTTBLEBadResponse;
-    }
+    ret = IotBleMqtt_ParsePacket( pBuffer, length, &view );
 
     if( ret == MQTTBLESuccess )
     {
-        error = IOT_BLE_MESG_DECODER.find( &decoderObj, IOT_BLE_MQTT_MESSAGE_ID, &decoderValue );
-
-        if( ( error != IOT_SERIALIZER_SUCCESS ) ||
-            ( decoderValue.type != IOT_SERIALIZER_SCALAR_SIGNED_INT ) )
+        if( ( view.fields & IOT_BLE_MQTT_FIELD_MESSAGE_ID ) == 0U )
         {
-            LogError( ( "Message ID decode failed, error = %d, decoded value type = %d", error, decoderValue.type ) );
+            LogError( ( "Message identifier is missing, message type = %d", view.packetType ) );
             ret = MQTTBLEBadResponse;
         }
         else
         {
-            *packetIdentifier = ( uint16_t ) decoderValue.u.value.u.signedInt;
+            *packetIdentifier = view.packetIdentifier;
         }
     }
 
-    IOT_BLE_MESG_DECODER.destroy( &decoderObj );
-
     return ret;
 }
 
+MQTTBLEStatus_t IotBleMqtt_DeserializePuback( uint8_t * pBuffer,
+                                              size_t length,
+                                              uint16_t * packetIdentifier )
+{
+    return _deserializeIdentifier( pBuffer, length, packetIdentifier );
+}
+
 MQTTBLEStatus_t IotBleMqtt_SerializeSubscribe( const MQTTBLESubscribeInfo_t * const pSubscriptionList,
                                                size_t subscriptionCount,
                                                uint8_t ** const pSubscribePacket,
                                                size_t * const pPacketSize,
                                                uint16_t * const pPacketIdentifier )
 {
-    uint8_t * pBuffer = NULL;
-    size_t bufLen = 0;
-    IotSerializerError_t error;
-    MQTTBLEStatus_t ret = MQTTBLESuccess;
-
-    error = _serializeSubscribe( pSubscriptionList, subscriptionCount, NULL, &bufLen, *pPacketIdentifier );
-
-    if( error != IOT_SERIALIZER_SUCCESS )
-    {
-        LogError( ( "Failed to find serialized length of SUBSCRIBE message, error = %d", error ) );
-        ret = MQTTBLEBadParameter;
-    }
-
-    if( ret == MQTTBLESuccess )
-    {
-        pBuffer = IotMqtt_MallocMessage( bufLen );
-
-        /* If Memory cannot be allocated log an error and return */
-        if( pBuffer == NULL )
-        {
-            LogError( ( "Failed to allocate memory for SUBSCRIBE message." ) );
-            ret = MQTTBLENoMemory;
-        }
-    }
-
-    if( ret == MQTTBLESuccess )
-    {
-        error = _serializeSubscribe( pSubscriptionList, subscriptionCount, pBuffer, &bufLen, *pPacketIdentifier );
-
-        if( error != IOT_SERIALIZER_SUCCESS )
-        {
-            LogError( ( "Failed to serialize SUBSCRIBE message, error = %d", error ) );
-            ret = MQTTBLEBadParameter;
-        }
-    }
+    size_t bufLen = IOT_BLE_MQTT_SUBSCRIBE_SIZE_MAX( subscriptionCount,
+                                                     _topicFiltersLength( pSubscriptionList, subscriptionCount ) );
+    uint8_t * pBuffer = IotMqtt_MallocMessage( bufLen );
+    MQTTBLEStatus_t ret = MQTTBLENoMemory;
 
-    if( ret == MQTTBLESuccess )
+    /* If Memory cannot be allocated log an error and return */
+    if( pBuffer == NULL )
     {
-        *pSubscribePacket = pBuffer;
-        *pPacketSize = bufLen;
+        LogError( ( "Failed to allocate memory for SUBSCRIBE message." ) );
     }
     else
     {
-        if( pBuffer != NULL )
-        {
-            IotMqtt_FreeMessage( pBuffer );
-        }
-
-        *pSubscribePacket = NULL;
-        *pPacketSize = 0;
+        ret = IotBleMqtt_EncodeSubscribe( pSubscriptionList, subscriptionCount, *pPacketIdentifier, pBuffer, bufLen, pPacketSize );
     }
 
-    return ret;
+    return _finishPacket( ret, pBuffer, pSubscribePacket, pPacketSize );
 }
 
 MQTTBLEStatus_t IotBleMqtt_DeserializeSuback( const uint8_t * pBuffer,
@@ -1075,53 +951,24 @@ MQTTBLEStatus_t IotBleMqtt_DeserializeSuback( const uint8_t * pBuffer,
                                               uint16_t * packetIdentifier,
                                               uint8_t * pStatusCode )
 {
-    IotSerializerDecoderObject_t decoderObj = { 0 }, decoderValue = { 0 };
-    IotSerializerError_t error;
-    MQTTBLEStatus_t ret = MQTTBLESuccess;
+    MQTTBLEPacketView_t view;
+    MQTTBLEStatus_t ret;
+    const uint8_t required = IOT_BLE_MQTT_FIELD_MESSAGE_ID | IOT_BLE_MQTT_FIELD_STATUS;
 
-    error = IOT_BLE_MESG_DECODER.init( &decoderObj, pBuffer, length );
+    ret = IotBleMqtt_ParsePacket( pBuffer, length, &view );
 
-    if( ( error != IOT_SERIALIZER_SUCCESS ) ||
-        ( decoderObj.type != IOT_SERIALIZER_CONTAINER_MAP ) )
+    if( ( ret == MQTTBLESuccess ) && ( ( view.fields & required ) != required ) )
     {
-        LogError( ( "Malformed SUBACK, decoding the packet failed, decoder error = %d, type: %d", error, decoderObj.type ) );
+        LogError( ( "Invalid SUBACK, found fields 0x%02x of 0x%02x.", view.fields, required ) );
         ret = MQTTBLEBadResponse;
     }
 
     if( ret == MQTTBLESuccess )
     {
-        error = IOT_BLE_MESG_DECODER.find( &decoderObj, IOT_BLE_MQTT_MESSAGE_ID, &decoderValue );
-
-        if( ( error != IOT_SERIALIZER_SUCCESS ) ||
-            ( decoderValue.type != IOT_SERIALIZER_SCALAR_SIGNED_INT ) )
-        {
-            LogError( ( "Message ID decode failed, error = %d, decoded value type = %d", error, decoderValue.type ) );
-            ret = MQTTBLEBadResponse;
-        }
-        else
-        {
-            *packetIdentifier = ( uint16_t ) decoderValue.u.value.u.signedInt;
-        }
+        *packetIdentifier = view.packetIdentifier;
+        *pStatusCode = ( uint8_t ) view.status;
     }
 
-    if( ret == MQTTBLESuccess )
-    {
-        error = IOT_BLE_MESG_DECODER.find( &decoderObj, IOT_BLE_MQTT_STATUS, &decoderValue );
-
-        if( ( error != IOT_SERIALIZER_SUCCESS ) ||
-            ( decoderValue.type != IOT_SERIALIZER_SCALAR_SIGNED_INT ) )
-        {
-            LogError( ( "Status code decode failed, error = %d, decoded value type = %d", error, decoderValue.type ) );
-            ret = MQTTBLEBadResponse;
-        }
-        else
-        {
-            *pStatusCode = ( uint8_t ) ( decoderValue.u.value.u.signedInt );
-        }
-    }
-
-    IOT_BLE_MESG_DECODER.destroy( &decoderObj );
-
     return ret;
 }
 
@@ -1131,155 +978,48 @@ MQTTBLEStatus_t IotBleMqtt_SerializeUnsubscribe( const MQTTBLESubscribeInfo_t *
                                                  size_t * const pPacketSize,
                                                  uint16_t * const pPacketIdentifier )
 {
-    uint8_t * pBuffer = NULL;
-    size_t bufLen = 0;
-    IotSerializerError_t error;
-    MQTTBLEStatus_t ret = MQTTBLESuccess;
-
-    error = _serializeUnSubscribe( pSubscriptionList, subscriptionCount, NULL, &bufLen, *pPacketIdentifier );
-
-    if( error != IOT_SERIALIZER_SUCCESS )
-    {
-        LogError( ( "Failed to find serialized length of UNSUBSCRIBE message, error = %d", error ) );
-        ret = MQTTBLEBadParameter;
-    }
-
-    if( ret == MQTTBLESuccess )
-    {
-        pBuffer = IotMqtt_MallocMessage( bufLen );
-
-        /* If Memory cannot be allocated log an error and return */
-        if( pBuffer == NULL )
-        {
-            LogError( ( "Failed to allocate memory for UNSUBSCRIBE message." ) );
-            ret = MQTTBLENoMemory;
-        }
-    }
-
-    if( ret == MQTTBLESuccess )
-    {
-        error = _serializeUnSubscribe( pSubscriptionList, subscriptionCount, pBuffer, &bufLen, *pPacketIdentifier );
+    size_t bufLen = IOT_BLE_MQTT_UNSUBSCRIBE_SIZE_MAX( subscriptionCount,
+                                                       _topicFiltersLength( pSubscriptionList, subscriptionCount ) );
+    uint8_t * pBuffer = IotMqtt_MallocMessage( bufLen );
+    MQTTBLEStatus_t ret = MQTTBLENoMemory;
 
-        if( error != IOT_SERIALIZER_SUCCESS )
-        {
-            LogError( ( "Failed to serialize UNSUBSCRIBE message, error = %d", error ) );
-            ret = MQTTBLEBadParameter;
-        }
-    }
-
-    if( ret == MQTTBLESuccess )
+    /* If Memory cannot be allocated log an error and return */
+    if( pBuffer == NULL )
     {
-        *pUnsubscribePacket = pBuffer;
-        *pPacketSize = bufLen;
+        LogError( ( "Failed to allocate memory for UNSUBSCRIBE message." ) );
     }
     else
     {
-        if( pBuffer != NULL )
-        {
-            IotMqtt_FreeMessage( pBuffer );
-        }
-
-        *pUnsubscribePacket = NULL;
-        *pPacketSize = 0;
+        ret = IotBleMqtt_EncodeUnsubscribe( pSubscriptionList, subscriptionCount, *pPacketIdentifier, pBuffer, bufLen, pPacketSize );
     }
 
-    return ret;
+    return _finishPacket( ret, pBuffer, pUnsubscribePacket, pPacketSize );
 }
 
 MQTTBLEStatus_t IotBleMqtt_DeserializeUnsuback( uint8_t * pBuffer,
                                                 size_t length,
                                                 uint16_t * packetIdentifier )
 {
-    IotSerializerDecoderObject_t decoderObj = { 0 }, decoderValue = { 0 };
-    IotSerializerError_t error;
-    MQTTBLEStatus_t ret = MQTTBLESuccess;
-
-    error = IOT_BLE_MESG_DECODER.init( &decoderObj, pBuffer, length );
-
-    if( ( error != IOT_SERIALIZER_SUCCESS ) ||
-        ( decoderObj.type != IOT_SERIALIZER_CONTAINER_MAP ) )
-    {
-        LogError( ( "Malformed UNSUBACK, decoding the packet failed, decoder error = %d, type:%d ", error, decoderObj.type ) );
-        ret = MQTTBLEBadResponse;
-    }
-
-    if( ret == MQTTBLESuccess )
-    {
-        error = IOT_BLE_MESG_DECODER.find( &decoderObj, IOT_BLE_MQTT_MESSAGE_ID, &decoderValue );
-
-        if( ( error != IOT_SERIALIZER_SUCCESS ) ||
-            ( decoderValue.type != IOT_SERIALIZER_SCALAR_SIGNED_INT ) )
-        {
-            LogError( ( "UNSUBACK Message identifier decode failed, error = %d, decoded value type = %d", error, decoderValue.type ) );
-            ret = MQTTBLEBadResponse;
-        }
-        else
-        {
-            *packetIdentifier = ( uint16_t ) decoderValue.u.value.u.signedInt;
-        }
-    }
-
-    IOT_BLE_MESG_DECODER.destroy( &decoderObj );
-
-    return ret;
+    return _deserializeIdentifier( pBuffer, length, packetIdentifier );
 }
 
 MQTTBLEStatus_t IotBleMqtt_SerializeDisconnect( uint8_t ** const pDisconnectPacket,
                                                 size_t * const pPacketSize )
 {
-    uint8_t * pBuffer = NULL;
-    size_t bufLen = 0;
-    IotSerializerError_t error;
-    MQTTBLEStatus_t ret = MQTTBLESuccess;
-
-    error = _serializeDisconnect( NULL, &bufLen );
-
-    if( error != IOT_SERIALIZER_SUCCESS )
-    {
-        LogError( ( "Failed to find serialized length of DISCONNECT message, error = %d", error ) );
-        ret = MQTTBLEBadParameter;
-    }
+    uint8_t * pBuffer = IotMqtt_MallocMessage( IOT_BLE_MQTT_DISCONNECT_SIZE_MAX );
+    MQTTBLEStatus_t ret = MQTTBLENoMemory;
 
-    if( ret == MQTTBLESuccess )
+    /* If Memory cannot be allocated log an error and return */
+    if( pBuffer == NULL )
     {
-        pBuffer = IotMqtt_MallocMessage( bufLen );
-
-        /* If Memory cannot be allocated log an error and return */
-        if( pBuffer == NULL )
-        {
-            LogError( ( "Failed to allocate memory for DISCONNECT message." ) );
-            ret = MQTTBLENoMemory;
-        }
-    }
-
-    if( ret == MQTTBLESuccess )
-    {
-        error = _serializeDisconnect( pBuffer, &bufLen );
-
-        if( error != IOT_SERIALIZER_SUCCESS )
-        {
-            LogError( ( "Failed to serialize DISCONNECT message, error = %d", error ) );
-            ret = MQTTBLEBadParameter;
-        }
-    }
-
-    if( ret == MQTTBLESuccess )
-    {
-        *pDisconnectPacket = pBuffer;
-        *pPacketSize = bufLen;
+        LogError( ( "Failed to allocate memory for DISCONNECT message." ) );
     }
     else
     {
-        if( pBuffer != NULL )
-        {
-            IotMqtt_FreeMessage( pBuffer );
-        }
-
-        *pDisconnectPacket = NULL;
-        *pPacketSize = 0;
+        ret = IotBleMqtt_EncodeDisconnect( pBuffer, IOT_BLE_MQTT_DISCONNECT_SIZE_MAX, pPacketSize );
     }
 
-    return ret;
+    return _finishPacket( ret, pBuffer, pDisconnectPacket, pPacketSize );
 }
 
 size_t IotBleMqtt_GetRemainingLength( IotBleDataTransferChannel_t * pNetworkConnection )
@@ -1296,94 +1036,37 @@ size_t IotBleMqtt_GetRemainingLength( IotBleDataTransferChannel_t * pNetworkConn
 uint8_t IotBleMqtt_GetPacketType( const uint8_t * pBuffer,
                                   size_t length )
 {
-    IotSerializerDecoderObject_t decoderObj = { 0 }, decoderValue = { 0 };
-    IotSerializerError_t error;
-    uint8_t value, packetType = IOT_BLE_MQTT_MSG_TYPE_INVALID;
+    MQTTBLEPacketView_t view;
 
-    error = IOT_BLE_MESG_DECODER.init( &decoderObj, pBuffer, length );
-
-    if( ( error == IOT_SERIALIZER_SUCCESS ) &&
-        ( decoderObj.type == IOT_SERIALIZER_CONTAINER_MAP ) )
+    if( IotBleMqtt_ParsePacket( pBuffer, length, &view ) != MQTTBLESuccess )
     {
-        error = IOT_BLE_MESG_DECODER.find( &decoderObj, IOT_BLE_MQTT_MSG_TYPE, &decoderValue );
-
-        if( ( error == IOT_SERIALIZER_SUCCESS ) &&
-            ( decoderValue.type == IOT_SERIALIZER_SCALAR_SIGNED_INT ) )
-        {
-            value = ( uint16_t ) decoderValue.u.value.u.signedInt;
-            packetType = value;
-        }
-        else
-        {
-            LogError( ( "Packet type decode failed, error = %d, decoded value type = %d", error, decoderValue.type ) );
-        }
+        view.packetType = IOT_BLE_MQTT_MSG_TYPE_INVALID;
     }
-    else
+    else if( ( view.fields & IOT_BLE_MQTT_FIELD_MSG_TYPE ) == 0U )
     {
-        LogError( ( "Decoding the packet failed, decoder error = %d, type = %d", error, decoderObj.type ) );
+        LogError( ( "Packet type is missing." ) );
     }
 
-    IOT_BLE_MESG_DECODER.destroy( &decoderObj );
-
-    return packetType;
+    return view.packetType;
 }
 
 MQTTBLEStatus_t IotBleMqtt_SerializePingreq( uint8_t ** const pPingreqPacket,
                                              size_t * const pPacketSize )
 {
-    uint8_t * pBuffer = NULL;
-    size_t bufLen = 0;
-    IotSerializerError_t error;
-    MQTTBLEStatus_t ret = MQTTBLESuccess;
-
-    error = _serializePingRequest( NULL, &bufLen );
-
-    if( error != IOT_SERIALIZER_SUCCESS )
-    {
-        LogError( ( "Failed to find serialized length of DISCONNECT message, error = %d", error ) );
-        ret = MQTTBLEBadParameter;
-    }
-
-    if( ret == MQTTBLESuccess )
-    {
-        pBuffer = IotMqtt_MallocMessage( bufLen );
-
-        /* If Memory cannot be allocated log an error and return */
-        if( pBuffer == NULL )
-        {
-            LogError( ( "Failed to allocate memory for DISCONNECT message." ) );
-            ret = MQTTBLENoMemory;
-        }
-    }
+    uint8_t * pBuffer = IotMqtt_MallocMessage( IOT_BLE_MQTT_PINGREQ_SIZE_MAX );
+    MQTTBLEStatus_t ret = MQTTBLENoMemory;
 
-    if( ret == MQTTBLESuccess )
+    /* If Memory cannot be allocated log an error and return */
+    if( pBuffer == NULL )
     {
-        error = _serializePingRequest( pBuffer, &bufLen );
-
-        if( error != IOT_SERIALIZER_SUCCESS )
-        {
-            LogError( ( "Failed to serialize DISCONNECT message, error = %d", error ) );
-            ret = MQTTBLEBadParameter;
-        }
-    }
-
-    if( ret == MQTTBLESuccess )
-    {
-        *pPingreqPacket = pBuffer;
-        *pPacketSize = bufLen;
+        LogError( ( "Failed to allocate memory for PINGREQ message." ) );
     }
     else
     {
-        if( pBuffer != NULL )
-        {
-            IotMqtt_FreeMessage( pBuffer );
-        }
-
-        *pPingreqPacket = NULL;
-        *pPacketSize = 0;
+        ret = IotBleMqtt_EncodePingreq( pBuffer, IOT_BLE_MQTT_PINGREQ_SIZE_MAX, pPacketSize );
     }
 
-    return ret;
+    return _finishPacket( ret, pBuffer, pPingreqPacket, pPacketSize );
 }
 
 MQTTBLEStatus_t IotBleMqtt_DeserializePingresp( const uint8_t * pBuffer,
@@ -658,26 +658,82 @@ static MQTTBLEStatus_t transportSerializePublish( StreamBufferHandle_t streamBuf
 
 /*-----------------------------------------------------------*/
 
-static MQTTBLEStatus_t handleOutgoingConnect( const void * buf,
+/*
+ * Outgoing packets are encoded straight into the send buffer of the BLE channel, sized for the
+ * longest encoding of the packet, so nothing is allocated or copied per packet.
+ */
+static MQTTBLEStatus_t acquireSendBuffer( IotBleDataTransferChannel_t * pChannel,
+                                          size_t maxLength,
+                                          uint8_t ** pSerializedBuf )
+{
+    MQTTBLEStatus_t status = MQTTBLESuccess;
+
+    *pSerializedBuf = IotBleDataTransfer_AcquireSendBuffer( pChannel, maxLength );
+
+    if( *pSerializedBuf == NULL )
+    {
+        LogError( ( "Could not get a %lu byte send buffer from the BLE channel.", ( unsigned long ) maxLength ) );
+        status = MQTTBLENoMemory;
+    }
+
+    return status;
+}
+
+static size_t calculateTopicFiltersLength( size_t subscriptionCount )
+{
+    size_t length = 0;
+    size_t subscriptionIndex;
+
+    for( subscriptionIndex = 0; subscriptionIndex < subscriptionCount; subscriptionIndex++ )
+    {
+        length += _subscriptions[ subscriptionIndex ].topicFilterLength;
+    }
+
+    return length;
+}
+
+static MQTTBLEStatus_t handleOutgoingConnect( IotBleDataTransferChannel_t * pChannel,
+                                              const void * buf,
                                               uint8_t ** pSerializedBuf,
                                               size_t * pSerializedBufLength )
 {
     MQTTBLEStatus_t status = MQTTBLESuccess;
     MQTTBLEConnectInfo_t connectConfig = { 0 };
+    uint8_t * pConnectPacket = NULL;
+    size_t connectPacketLength = 0;
 
     LogDebug( ( "Processing outgoing CONNECT." ) );
 
     status = parseConnect( &connectConfig, buf );
 
+    /* The broker endpoint is only known to the serializer, so CONNECT, sent once per
+     * session, is serialized on its own and then copied into the send buffer. */
+    if( status == MQTTBLESuccess )
+    {
+        status = IotBleMqtt_SerializeConnect( &connectConfig, &pConnectPacket, &connectPacketLength );
+    }
+
+    if( status == MQTTBLESuccess )
+    {
+        status = acquireSendBuffer( pChannel, connectPacketLength, pSerializedBuf );
+    }
+
     if( status == MQTTBLESuccess )
     {
-        status = IotBleMqtt_SerializeConnect( &connectConfig, pSerializedBuf, pSerializedBufLength );
+        ( void ) memcpy( *pSerializedBuf, pConnectPacket, connectPacketLength );
+        *pSerializedBufLength = connectPacketLength;
+    }
+
+    if( pConnectPacket != NULL )
+    {
+        IotMqtt_FreeMessage( pConnectPacket );
     }
 
     return status;
 }
 
-static MQTTBLEStatus_t handleOutgoingPublish( MQTTBLEPublishInfo_t * pPublishInfo,
+static MQTTBLEStatus_t handleOutgoingPublish( IotBleDataTransferChannel_t * pChannel,
+                                              MQTTBLEPublishInfo_t * pPublishInfo,
                                               const void * buf,
                                               size_t bytesToSend,
                                               uint8_t ** pSerializedBuf,
@@ -685,6 +741,7 @@ static MQTTBLEStatus_t handleOutgoingPublish( MQTTBLEPublishInfo_t * pPublishInf
 {
     MQTTBLEStatus_t status = MQTTBLESuccess;
     uint16_t packetIdentifier = 0;
+    size_t bufferSize = 0;
 
     LogDebug( ( "Processing outgoing PUBLISH." ) );
 
@@ -702,14 +759,19 @@ static MQTTBLEStatus_t handleOutgoingPublish( MQTTBLEPublishInfo_t * pPublishInf
                                               &packetIdentifier );
     }
 
-    LogDebug( ( "IotBleMqtt_SerializePublish before if" ) );
-
     if( pPublishInfo->pending == false )
     {
-        status = IotBleMqtt_SerializePublish( pPublishInfo,
-                                              pSerializedBuf,
-                                              pSerializedBufLength,
-                                              packetIdentifier );
+        bufferSize = IOT_BLE_MQTT_PUBLISH_SIZE_MAX( pPublishInfo->topicNameLength, pPublishInfo->payloadLength );
+        status = acquireSendBuffer( pChannel, bufferSize, pSerializedBuf );
+
+        if( status == MQTTBLESuccess )
+        {
+            status = IotBleMqtt_EncodePublish( pPublishInfo,
+                                               packetIdentifier,
+                                               *pSerializedBuf,
+                                               bufferSize,
+                                               pSerializedBufLength );
+        }
 
         if( pPublishInfo->pTopicName != NULL )
         {
@@ -728,7 +790,8 @@ static MQTTBLEStatus_t handleOutgoingPublish( MQTTBLEPublishInfo_t * pPublishInf
 }
 
 
-static MQTTBLEStatus_t handleOutgoingPuback( const void * buf,
+static MQTTBLEStatus_t handleOutgoingPuback( IotBleDataTransferChannel_t * pChannel,
+                                             const void * buf,
                                              uint8_t ** pSerializedBuf,
                                              size_t * pSerializedBufLength )
 {
@@ -742,21 +805,29 @@ static MQTTBLEStatus_t handleOutgoingPuback( const void * buf,
 
     packetIdentifier = UINT16_DECODE( &buffer[ 2 ] );
 
-    status = IotBleMqtt_SerializePuback( packetIdentifier,
-                                         pSerializedBuf,
-                                         pSerializedBufLength );
+    status = acquireSendBuffer( pChannel, IOT_BLE_MQTT_PUBACK_SIZE_MAX, pSerializedBuf );
+
+    if( status == MQTTBLESuccess )
+    {
+        status = IotBleMqtt_EncodePuback( packetIdentifier,
+                                          *pSerializedBuf,
+                                          IOT_BLE_MQTT_PUBACK_SIZE_MAX,
+                                          pSerializedBufLength );
+    }
 
     return status;
 }
 
 
-static MQTTBLEStatus_t handleOutgoingSubscribe( const void * buf,
+static MQTTBLEStatus_t handleOutgoingSubscribe( IotBleDataTransferChannel_t * pChannel,
+                                                const void * buf,
                                                 uint8_t ** pSerializedBuf,
                                                 size_t * pSerializedBufLength )
 {
     MQTTBLEStatus_t status = MQTTBLESuccess;
     uint16_t packetIdentifier = 0;
     size_t subscriptionCount = 0;
+    size_t bufferSize = 0;
 
     LogDebug( ( "Processing outgoing SUBSCRIBE." ) );
 
@@ -764,20 +835,33 @@ static MQTTBLEStatus_t handleOutgoingSubscribe( const void * buf,
 
     if( status == MQTTBLESuccess )
     {
-        status = IotBleMqtt_SerializeSubscribe( _subscriptions, subscriptionCount, pSerializedBuf, pSerializedBufLength, &packetIdentifier );
+        bufferSize = IOT_BLE_MQTT_SUBSCRIBE_SIZE_MAX( subscriptionCount, calculateTopicFiltersLength( subscriptionCount ) );
+        status = acquireSendBuffer( pChannel, bufferSize, pSerializedBuf );
+    }
+
+    if( status == MQTTBLESuccess )
+    {
+        status = IotBleMqtt_EncodeSubscribe( _subscriptions,
+                                             subscriptionCount,
+                                             packetIdentifier,
+                                             *pSerializedBuf,
+                                             bufferSize,
+                                             pSerializedBufLength );
     }
 
     return status;
 }
 
 
-static MQTTBLEStatus_t handleOutgoingUnsubscribe( const void * buf,
+static MQTTBLEStatus_t handleOutgoingUnsubscribe( IotBleDataTransferChannel_t * pChannel,
+                                                  const void * buf,
                                                   uint8_t ** pSerializedBuf,
                                                   size_t * pSerializedBufLength )
 {
     MQTTBLEStatus_t status = MQTTBLESuccess;
     uint16_t packetIdentifier = 0;
     size_t subscriptionCount = 0;
+    size_t bufferSize = 0;
 
     LogDebug( ( "Processing outgoing UNSUBSCRIBE." ) );
 
@@ -785,31 +869,56 @@ static MQTTBLEStatus_t handleOutgoingUnsubscribe( const void * buf,
 
     if( status == MQTTBLESuccess )
     {
-        status = IotBleMqtt_SerializeUnsubscribe( _subscriptions, subscriptionCount, pSerializedBuf, pSerializedBufLength, &packetIdentifier );
+        bufferSize = IOT_BLE_MQTT_UNSUBSCRIBE_SIZE_MAX( subscriptionCount, calculateTopicFiltersLength( subscriptionCount ) );
+        status = acquireSendBuffer( pChannel, bufferSize, pSerializedBuf );
+    }
+
+    if( status == MQTTBLESuccess )
+    {
+        status = IotBleMqtt_EncodeUnsubscribe( _subscriptions,
+                                               subscriptionCount,
+                                               packetIdentifier,
+                                               *pSerializedBuf,
+                                               bufferSize,
+                                               pSerializedBufLength );
     }
 
     return status;
 }
 
 
-static MQTTBLEStatus_t handleOutgoingPingReq( uint8_t ** pSerializedBuf,
+static MQTTBLEStatus_t handleOutgoingPingReq( IotBleDataTransferChannel_t * pChannel,
+                                              uint8_t ** pSerializedBuf,
                                               size_t * pSerializedBufLength )
 {
     MQTTBLEStatus_t status = MQTTBLESuccess;
 
     LogDebug( ( "Processing outgoing PINGREQ." ) );
-    status = IotBleMqtt_SerializePingreq( pSerializedBuf, pSerializedBufLength );
+    status = acquireSendBuffer( pChannel, IOT_BLE_MQTT_PINGREQ_SIZE_MAX, pSerializedBuf );
+
+    if( status == MQTTBLESuccess )
+    {
+        status = IotBleMqtt_EncodePingreq( *pSerializedBuf, IOT_BLE_MQTT_PINGREQ_SIZE_MAX, pSerializedBufLength );
+    }
+
     return status;
 }
 
-static MQTTBLEStatus_t handleOutgoingDisconnect( uint8_t ** pSerializedBuf,
+static MQTTBLEStatus_t handleOutgoingDisconnect( IotBleDataTransferChannel_t * pChannel,
+                                                 uint8_t ** pSerializedBuf,
                                                  size_t * pSerializedBufLength )
 {
     MQTTBLEStatus_t status = MQTTBLESuccess;
 
     LogDebug( ( "Processing outgoing DISCONNECT." ) );
 
-    status = IotBleMqtt_SerializeDisconnect( pSerializedBuf, pSerializedBufLength );
+    status = acquireSendBuffer( pChannel, IOT_BLE_MQTT_DISCONNECT_SIZE_MAX, pSerializedBuf );
+
+    if( status == MQTTBLESuccess )
+    {
+        status = IotBleMqtt_EncodeDisconnect( *pSerializedBuf, IOT_BLE_MQTT_DISCONNECT_SIZE_MAX, pSerializedBufLength );
+    }
+
     return status;
 }
 
@@ -978,16 +1087,34 @@ static MQTTBLEStatus_t handleIncomingPingresp( StreamBufferHandle_t streamBuffer
 /*-----------------------------------------------------------*/
 
 
-/**
- * @brief Transport interface send API implementation.
- *
- * @param[in] context An opaque used by transport interface.
- * @param[in] pBuffer A pointer to a buffer containing data to be sent out.
- * @param[in] bytesToWrite number of bytes to write from the buffer.
+/*
+ * With raw framing the channel carries the MQTT packets unchanged, split only at the MTU.
  */
-int32_t IotBleMqttTransportSend( NetworkContext_t * pContext,
-                                 const void * pBuffer,
-                                 size_t bytesToWrite )
+static int32_t sendCompact( NetworkContext_t * pContext,
+                            const void * pBuffer,
+                            size_t bytesToWrite )
+{
+    size_t bytesSent = 0;
+    int32_t bytesWritten = ( int32_t ) bytesToWrite;
+
+    bytesSent = IotBleDataTransfer_Send( pContext->pChannel, pBuffer, bytesToWrite );
+
+    if( bytesSent != bytesToWrite )
+    {
+        LogError( ( "Cannot send %lu bytes through BLE channel, sent %lu bytes.",
+                    bytesToWrite, bytesSent ) );
+        bytesWritten = 0;
+    }
+
+    return bytesWritten;
+}
+
+/*
+ * Otherwise each MQTT packet is converted to a CBOR message.
+ */
+static int32_t sendCbor( NetworkContext_t * pContext,
+                         const void * pBuffer,
+                         size_t bytesToWrite )
 {
     size_t bytesSent = 0;
     uint8_t * pBuf = ( uint8_t * ) pBuffer;
@@ -1006,7 +1133,8 @@ int32_t IotBleMqttTransportSend( NetworkContext_t * pContext,
 
     if( pContext->publishInfo.pending == true )
     {
-        status = handleOutgoingPublish( ( MQTTBLEPublishInfo_t * ) &pContext->publishInfo,
+        status = handleOutgoingPublish( pContext->pChannel,
+                                        ( MQTTBLEPublishInfo_t * ) &pContext->publishInfo,
                                         pBuffer,
                                         bytesToWrite,
                                         &pSerializedPacket,
@@ -1021,13 +1149,15 @@ int32_t IotBleMqttTransportSend( NetworkContext_t * pContext,
         switch( packetType )
         {
             case IOT_BLE_MQTT_MSG_TYPE_CONNECT:
-                status = handleOutgoingConnect( pBuffer,
+                status = handleOutgoingConnect( pContext->pChannel,
+                                                pBuffer,
                                                 &pSerializedPacket,
                                                 &serializedLength );
                 break;
 
             case IOT_BLE_MQTT_MSG_TYPE_PUBLISH:
-                status = handleOutgoingPublish( ( MQTTBLEPublishInfo_t * ) &pContext->publishInfo,
+                status = handleOutgoingPublish( pContext->pChannel,
+                                                ( MQTTBLEPublishInfo_t * ) &pContext->publishInfo,
                                                 pBuffer,
                                                 bytesToWrite,
                                                 &pSerializedPacket,
@@ -1035,30 +1165,35 @@ int32_t IotBleMqttTransportSend( NetworkContext_t * pContext,
                 break;
 
             case IOT_BLE_MQTT_MSG_TYPE_PUBACK:
-                status = handleOutgoingPuback( pBuffer,
+                status = handleOutgoingPuback( pContext->pChannel,
+                                               pBuffer,
                                                &pSerializedPacket,
                                                &serializedLength );
                 break;
 
             case IOT_BLE_MQTT_MSG_TYPE_SUBSCRIBE:
-                status = handleOutgoingSubscribe( pBuffer,
+                status = handleOutgoingSubscribe( pContext->pChannel,
+                                                  pBuffer,
                                                   &pSerializedPacket,
                                                   &serializedLength );
                 break;
 
             case IOT_BLE_MQTT_MSG_TYPE_UNSUBSCRIBE:
-                status = handleOutgoingUnsubscribe( pBuffer,
+                status = handleOutgoingUnsubscribe( pContext->pChannel,
+                                                    pBuffer,
                                                     &pSerializedPacket,
                                                     &serializedLength );
                 break;
 
             case IOT_BLE_MQTT_MSG_TYPE_PINGREQ:
-                status = handleOutgoingPingReq( &pSerializedPacket,
+                status = handleOutgoingPingReq( pContext->pChannel,
+                                                &pSerializedPacket,
                                                 &serializedLength );
                 break;
 
             case IOT_BLE_MQTT_MSG_TYPE_DISCONNECT:
-                status = handleOutgoingDisconnect( &pSerializedPacket,
+                status = handleOutgoingDisconnect( pContext->pChannel,
+                                                   &pSerializedPacket,
                                                    &serializedLength );
                 break;
 
@@ -1079,51 +1214,94 @@ int32_t IotBleMqttTransportSend( NetworkContext_t * pContext,
         }
     }
 
-    if( status == MQTTBLESuccess )
+    if( ( status == MQTTBLESuccess ) && ( serializedLength > 0 ) )
     {
-        if( serializedLength > 0 )
-        {
-            bytesSent = IotBleDataTransfer_Send( pContext->pChannel,
-                                                 pSerializedPacket,
-                                                 serializedLength );
+        bytesSent = IotBleDataTransfer_SendAcquiredBuffer( pContext->pChannel,
+                                                           serializedLength );
 
-            if( bytesSent != serializedLength )
-            {
-                LogError( ( "Cannot send %lu bytes through BLE channel, sent %lu bytes.",
-                            serializedLength, bytesSent ) );
-                bytesWritten = 0;
-            }
-            else
-            {
-                LogDebug( ( "Successfully sent %d bytes through BLE channel.",
-                            serializedLength ) );
-            }
-
-            IotMqtt_FreeMessage( pSerializedPacket );
+        if( bytesSent != serializedLength )
+        {
+            LogError( ( "Cannot send %lu bytes through BLE channel, sent %lu bytes.",
+                        serializedLength, bytesSent ) );
+            bytesWritten = 0;
         }
         else
         {
-            bytesWritten = 0;
+            LogDebug( ( "Successfully sent %d bytes through BLE channel.",
+                        serializedLength ) );
         }
     }
     else
     {
         /* The user would have already seen a log for the previous error */
+        if( pSerializedPacket != NULL )
+        {
+            IotBleDataTransfer_ReleaseSendBuffer( pContext->pChannel );
+        }
+
         bytesWritten = 0;
     }
 
     return bytesWritten;
 }
 
-MQTTBLEStatus_t IotBleMqttTransportAcceptData( const NetworkContext_t * pContext )
+/**
+ * @brief Transport interface send API implementation.
+ *
+ * @param[in] context An opaque used by transport interface.
+ * @param[in] pBuffer A pointer to a buffer containing data to be sent out.
+ * @param[in] bytesToWrite number of bytes to write from the buffer.
+ */
+int32_t IotBleMqttTransportSend( NetworkContext_t * pContext,
+                                 const void * pBuffer,
+                                 size_t bytesToWrite )
+{
+    int32_t bytesWritten;
+
+    if( IotBleDataTransfer_GetFraming( pContext->pChannel ) == IOT_BLE_DATA_TRANSFER_FRAMING_RAW )
+    {
+        bytesWritten = sendCompact( pContext, pBuffer, bytesToWrite );
+    }
+    else
+    {
+        bytesWritten = sendCbor( pContext, pBuffer, bytesToWrite );
+    }
+
+    return bytesWritten;
+}
+
+static MQTTBLEStatus_t acceptCompactData( const NetworkContext_t * pContext )
+{
+    MQTTBLEStatus_t status = MQTTBLESuccess;
+    const uint8_t * pData;
+    size_t dataLength;
+    size_t bytesQueued;
+
+    IotBleDataTransfer_PeekReceiveBuffer( pContext->pChannel, &pData, &dataLength );
+
+    /* The bytes are already MQTT packets, so they go straight to the MQTT library. */
+    bytesQueued = xStreamBufferSend( pContext->xStreamBuffer, pData, dataLength, pdMS_TO_TICKS( RECV_TIMEOUT_MS ) );
+
+    if( bytesQueued != dataLength )
+    {
+        LogError( ( "Dropped %lu bytes received from the channel, the transport buffer is full.",
+                    ( unsigned long ) ( dataLength - bytesQueued ) ) );
+        status = MQTTBLENoMemory;
+    }
+
+    /* A partial packet cannot be resumed, so the whole receive buffer is flushed either way. */
+    ( void ) IotBleDataTransfer_Receive( pContext->pChannel, NULL, dataLength );
+
+    return status;
+}
+
+static MQTTBLEStatus_t acceptCborData( const NetworkContext_t * pContext )
 {
     MQTTBLEStatus_t status = MQTTBLESuccess;
     uint8_t packetType;
     uint8_t * pPacket;
     size_t packetLength;
 
-    configASSERT( pContext != NULL );
-
     IotBleDataTransfer_PeekReceiveBuffer( pContext->pChannel,
                                           ( const uint8_t ** ) &pPacket,
                                           &packetLength );
@@ -1185,6 +1363,24 @@ MQTTBLEStatus_t IotBleMqttTransportAcceptData( const NetworkContext_t * pContext
     return status;
 }
 
+MQTTBLEStatus_t IotBleMqttTransportAcceptData( const NetworkContext_t * pContext )
+{
+    MQTTBLEStatus_t status;
+
+    configASSERT( pContext != NULL );
+
+    if( IotBleDataTransfer_GetFraming( pContext->pChannel ) == IOT_BLE_DATA_TRANSFER_FRAMING_RAW )
+    {
+        status = acceptCompactData( pContext );
+    }
+    else
+    {
+        status = acceptCborData( pContext );
+    }
+
+    return status;
+}
+
 
 /**
  * @brief Transport interface read prototype.
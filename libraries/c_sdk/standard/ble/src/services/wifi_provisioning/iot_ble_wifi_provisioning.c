@@ -61,6 +61,10 @@
     ( ( ret == IOT_SERIALIZER_SUCCESS ) ||              \
       ( ( !pxSerializerBuf ) && ( ret == IOT_SERIALIZER_BUFFER_TOO_SMALL ) ) )
 
+/* Buffer too small is a special error case that serialization should continue, so the shortfall is known at the end. */
+#define IS_VALID_ENCODER_RET( ret ) \
+    ( ( ret == IOT_SERIALIZER_SUCCESS ) || ( ret == IOT_SERIALIZER_BUFFER_TOO_SMALL ) )
+
 #define STORAGE_INDEX( priority )    ( wifiProvisioning.numNetworks - priority - 1 )
 #define NETWORK_INFO_DEFAULT_PARAMS    { .status = eWiFiSuccess, .RSSI = IOT_BLE_WIFI_PROV_INVALID_NETWORK_RSSI, .connected = false, .savedIdx = IOT_BLE_WIFI_PROV_INVALID_NETWORK_INDEX }
 /** @endcond */
@@ -82,6 +86,7 @@
 #define IOT_BLE_WIFI_PROV_INDEX_KEY           "g"
 #define IOT_BLE_WIFI_PROV_NEWINDEX_KEY        "j"
 #define IOT_BLE_WIFI_PROV_CONNECT_KEY         "y"
+#define IOT_BLE_WIFI_PROV_PACKED_KEY          "k"
 
 
 /**
@@ -103,6 +108,10 @@
 #define IOT_BLE_WIFI_PROV_NUM_STATUS_MESG_PARAMS          ( 2 )
 #define IOT_BLE_WIFI_PROV_DEFAULT_ALWAYS_CONNECT          ( true )
 
+/* Packed networks are sent as a CBOR array. Up to 23 networks, its header is the single byte 0x80 | count. */
+#define IOT_BLE_WIFI_PROV_CBOR_ARRAY                      ( 0x80 )
+#define IOT_BLE_WIFI_PROV_MAX_PACKED_NETWORKS             ( 23 )
+
 
 /*---------------------------------------------------------------------------------------------------------*/
 
@@ -113,6 +122,21 @@ static IotBleWifiProvService_t wifiProvisioning = { 0 };
 
 static WIFIScanResult_t scanNetworks[ IOT_BLE_WIFI_PROVISIONIG_MAX_SCAN_NETWORKS ] = { 0 };
 
+/**
+ * @brief Buffer the list network responses are encoded in, reused for every network.
+ */
+static uint8_t networkMessage[ IOT_BLE_WIFI_PROVISIONING_NETWORK_MESSAGE_SIZE ] = { 0 };
+
+/**
+ * @brief Bytes used in networkMessage, including the array header of packed networks.
+ */
+static size_t networkMessageLength = 0;
+
+/**
+ * @brief Number of networks in networkMessage waiting to be sent.
+ */
+static uint8_t networkMessageCount = 0;
+
 /*
  * @brief Callback registered for BLE write and read events received for each characteristic.
  */
@@ -186,7 +210,7 @@ WIFIReturnCode_t _addNewNetwork( WIFINetworkProfile_t * pProfile,
                                  bool connect );
 
 static IotSerializerError_t _serializeNetwork( int32_t responseType,
-                                               IotBleWifiNetworkInfo_t * pNetworkInfo,
+                                               const IotBleWifiNetworkInfo_t * pNetworkInfo,
                                                uint8_t * pBuffer,
                                                size_t * plength );
 
@@ -196,12 +220,29 @@ static IotSerializerError_t _serializeStatusResponse( int32_t responseType,
                                                       uint8_t * pBuffer,
                                                       size_t * plength );
 
+/*
+ * @brief Empty the network message buffer before a list network response.
+ */
+static void _startNetworkMessage( void );
+
+/*
+ * @brief Send the networks waiting in the network message buffer, if any.
+ */
+static void _flushNetworkMessage( void );
+
+/*
+ * @brief Encode a network into the network message buffer, and send it once it cannot take more networks.
+ */
+static void _sendNetwork( int32_t responseType,
+                          const IotBleWifiNetworkInfo_t * pNetworkInfo );
+
 static void _sendScanNetwork( int32_t responseType,
                               WIFIScanResult_t * pScanNetwork );
 
 /*
  * @brief  The task lists the saved network configurations in flash and also scans nearby networks.
- * It sends the profile information for each saved and scanned networks one at a time to the GATT client.
+ * It sends the profile information for each saved and scanned networks to the GATT client, one at a time or,
+ * if the request asks for it, packed several to a message.
  * Maximum number of networks to scan is set in the List network request.
  */
 static void _listNetworkTask( IotTaskPool_t taskPool,
@@ -385,6 +426,27 @@ static bool _deserializeListNetworkRequest( const uint8_t * pData,
         }
     }
 
+    if( result == true )
+    {
+        ret = IOT_BLE_MESG_DECODER.find( &decoderObj, IOT_BLE_WIFI_PROV_PACKED_KEY, &value );
+
+        if( ( ret == IOT_SERIALIZER_SUCCESS ) &&
+            ( value.type == IOT_SERIALIZER_SCALAR_BOOL ) )
+        {
+            pListNetworkRequest->packed = value.u.value.u.booleanValue;
+        }
+        else if( ret == IOT_SERIALIZER_NOT_FOUND )
+        {
+            /* Apps that predate packing get one network per response. */
+            pListNetworkRequest->packed = false;
+        }
+        else
+        {
+            IotLogError( "Error in getting packed flag, error = %d, value type = %d", ret, value.type );
+            result = false;
+        }
+    }
+
     IOT_BLE_MESG_DECODER.destroy( &decoderObj );
 
     return result;
@@ -408,9 +470,10 @@ static bool _handleListNetworkRequest( const uint8_t * pData,
 
         if( status == true )
         {
-            IotLogDebug( "List network request parameters: max networks = %d, timeout = %d",
+            IotLogDebug( "List network request parameters: max networks = %d, timeout = %d, packed = %d",
                          wifiProvisioning.listNetworkRequest.maxNetworks,
-                         wifiProvisioning.listNetworkRequest.timeoutMs );
+                         wifiProvisioning.listNetworkRequest.timeoutMs,
+                         wifiProvisioning.listNetworkRequest.packed );
 
             taskStatus = IotTaskPool_CreateRecyclableJob( IOT_SYSTEM_TASKPOOL,
                                                           _listNetworkTask,
@@ -915,7 +978,7 @@ static bool _handleDeleteNetworkRequest( const uint8_t * pData,
 
 
 static IotSerializerError_t _serializeNetwork( int32_t responseType,
-                                               IotBleWifiNetworkInfo_t * pNetworkInfo,
+                                               const IotBleWifiNetworkInfo_t * pNetworkInfo,
                                                uint8_t * pBuffer,
                                                size_t * plength )
 {
@@ -932,21 +995,21 @@ static IotSerializerError_t _serializeNetwork( int32_t responseType,
         ret = IOT_BLE_MESG_ENCODER.openContainer( &container, &networkMap, IOT_BLE_WIFI_PROV_NUM_NETWORK_INFO_MESG_PARAMS );
     }
 
-    if( IS_VALID_SERIALIZER_RET( ret, pBuffer ) )
+    if( IS_VALID_ENCODER_RET( ret ) )
     {
         value.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
         value.value.u.signedInt = responseType;
         ret = IOT_BLE_MESG_ENCODER.appendKeyValue( &networkMap, IOT_BLE_WIFI_PROV_MSG_TYPE_KEY, value );
     }
 
-    if( IS_VALID_SERIALIZER_RET( ret, pBuffer ) )
+    if( IS_VALID_ENCODER_RET( ret ) )
     {
         value.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
         value.value.u.signedInt = pNetworkInfo->status;
         ret = IOT_BLE_MESG_ENCODER.appendKeyValue( &networkMap, IOT_BLE_WIFI_PROV_STATUS_KEY, value );
     }
 
-    if( IS_VALID_SERIALIZER_RET( ret, pBuffer ) )
+    if( IS_VALID_ENCODER_RET( ret ) )
     {
         value.type = IOT_SERIALIZER_SCALAR_TEXT_STRING;
         value.value.u.string.pString = ( uint8_t * ) pNetworkInfo->pSSID;
@@ -954,7 +1017,7 @@ static IotSerializerError_t _serializeNetwork( int32_t responseType,
         ret = IOT_BLE_MESG_ENCODER.appendKeyValue( &networkMap, IOT_BLE_WIFI_PROV_SSID_KEY, value );
     }
 
-    if( IS_VALID_SERIALIZER_RET( ret, pBuffer ) )
+    if( IS_VALID_ENCODER_RET( ret ) )
     {
         value.type = IOT_SERIALIZER_SCALAR_BYTE_STRING;
         value.value.u.string.pString = ( uint8_t * ) pNetworkInfo->pBSSID;
@@ -962,59 +1025,64 @@ static IotSerializerError_t _serializeNetwork( int32_t responseType,
         ret = IOT_BLE_MESG_ENCODER.appendKeyValue( &networkMap, IOT_BLE_WIFI_PROV_BSSID_KEY, value );
     }
 
-    if( IS_VALID_SERIALIZER_RET( ret, pBuffer ) )
+    if( IS_VALID_ENCODER_RET( ret ) )
     {
         value.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
         value.value.u.signedInt = pNetworkInfo->security;
         ret = IOT_BLE_MESG_ENCODER.appendKeyValue( &networkMap, IOT_BLE_WIFI_PROV_KEY_MGMT_KEY, value );
     }
 
-    if( IS_VALID_SERIALIZER_RET( ret, pBuffer ) )
+    if( IS_VALID_ENCODER_RET( ret ) )
     {
         value.type = IOT_SERIALIZER_SCALAR_BOOL;
         value.value.u.booleanValue = pNetworkInfo->hidden;
         ret = IOT_BLE_MESG_ENCODER.appendKeyValue( &networkMap, IOT_BLE_WIFI_PROV_HIDDEN_KEY, value );
     }
 
-    if( IS_VALID_SERIALIZER_RET( ret, pBuffer ) )
+    if( IS_VALID_ENCODER_RET( ret ) )
     {
         value.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
         value.value.u.signedInt = pNetworkInfo->RSSI;
         ret = IOT_BLE_MESG_ENCODER.appendKeyValue( &networkMap, IOT_BLE_WIFI_PROV_RSSI_KEY, value );
     }
 
-    if( IS_VALID_SERIALIZER_RET( ret, pBuffer ) )
+    if( IS_VALID_ENCODER_RET( ret ) )
     {
         value.type = IOT_SERIALIZER_SCALAR_BOOL;
         value.value.u.booleanValue = pNetworkInfo->connected;
         ret = IOT_BLE_MESG_ENCODER.appendKeyValue( &networkMap, IOT_BLE_WIFI_PROV_CONNECTED_KEY, value );
     }
 
-    if( IS_VALID_SERIALIZER_RET( ret, pBuffer ) )
+    if( IS_VALID_ENCODER_RET( ret ) )
     {
         value.type = IOT_SERIALIZER_SCALAR_SIGNED_INT;
         value.value.u.signedInt = pNetworkInfo->savedIdx;
         ret = IOT_BLE_MESG_ENCODER.appendKeyValue( &networkMap, IOT_BLE_WIFI_PROV_INDEX_KEY, value );
     }
 
-    if( IS_VALID_SERIALIZER_RET( ret, pBuffer ) )
+    if( IS_VALID_ENCODER_RET( ret ) )
     {
         ret = IOT_BLE_MESG_ENCODER.closeContainer( &container, &networkMap );
     }
 
-    if( IS_VALID_SERIALIZER_RET( ret, pBuffer ) )
+    if( IS_VALID_ENCODER_RET( ret ) )
     {
         if( pBuffer == NULL )
         {
             *plength = IOT_BLE_MESG_ENCODER.getExtraBufferSizeNeeded( &container );
+            ret = IOT_SERIALIZER_SUCCESS;
+        }
+        else if( IOT_BLE_MESG_ENCODER.getExtraBufferSizeNeeded( &container ) > 0 )
+        {
+            ret = IOT_SERIALIZER_BUFFER_TOO_SMALL;
         }
         else
         {
             *plength = IOT_BLE_MESG_ENCODER.getEncodedSize( &container, pBuffer );
+            ret = IOT_SERIALIZER_SUCCESS;
         }
 
         IOT_BLE_MESG_ENCODER.destroy( &container );
-        ret = IOT_SERIALIZER_SUCCESS;
     }
 
     return ret;
@@ -1305,64 +1373,97 @@ WIFIReturnCode_t _insertNetwork( uint16_t index,
     return ret;
 }
 
-static void _sendSavedNetwork( int32_t responseType,
-                               WIFINetworkProfile_t * pSavedNetwork,
-                               uint16_t idx )
+static void _startNetworkMessage( void )
 {
-    IotBleWifiNetworkInfo_t networkInfo = NETWORK_INFO_DEFAULT_PARAMS;
-    uint8_t * message = NULL;
+    /* Leave room for the array header, which is written once the number of networks is known. */
+    networkMessageLength = ( wifiProvisioning.listNetworkRequest.packed == true ) ? 1 : 0;
+    networkMessageCount = 0;
+}
+
+static void _flushNetworkMessage( void )
+{
+    if( networkMessageCount > 0 )
+    {
+        if( wifiProvisioning.listNetworkRequest.packed == true )
+        {
+            networkMessage[ 0 ] = ( uint8_t ) ( IOT_BLE_WIFI_PROV_CBOR_ARRAY | networkMessageCount );
+        }
+
+        if( IotBleDataTransfer_Send( wifiProvisioning.pChannel, networkMessage, networkMessageLength ) != networkMessageLength )
+        {
+            IotLogError( "Failed to send %d networks through ble connection", networkMessageCount );
+        }
+
+        _startNetworkMessage();
+    }
+}
+
+static void _sendNetwork( int32_t responseType,
+                          const IotBleWifiNetworkInfo_t * pNetworkInfo )
+{
+    size_t limit = sizeof( networkMessage );
     size_t messageLen = 0;
     IotSerializerError_t serializerRet;
 
-    networkInfo.pSSID = pSavedNetwork->ucSSID;
-    networkInfo.SSIDLength = pSavedNetwork->ucSSIDLength;
-    networkInfo.pBSSID = pSavedNetwork->ucBSSID;
-    networkInfo.BSSIDLength = wificonfigMAX_BSSID_LEN;
-    networkInfo.connected = ( wifiProvisioning.connectedIdx == idx );
-    networkInfo.security = pSavedNetwork->xSecurity;
-    networkInfo.savedIdx = ( int32_t ) idx;
+    /* Networks are packed only as far as a single indication carries them. A network on its own may still
+     * need a large message. */
+    if( ( networkMessageCount > 0 ) && ( IotBleDataTransfer_GetTransmitLength() <= limit ) )
+    {
+        limit = IotBleDataTransfer_GetTransmitLength() - 1;
+    }
 
-    serializerRet = _serializeNetwork( responseType, &networkInfo, NULL, &messageLen );
+    messageLen = ( limit > networkMessageLength ) ? ( limit - networkMessageLength ) : 0;
+    serializerRet = _serializeNetwork( responseType, pNetworkInfo, &networkMessage[ networkMessageLength ], &messageLen );
 
-    if( serializerRet == IOT_SERIALIZER_SUCCESS )
+    if( ( serializerRet == IOT_SERIALIZER_BUFFER_TOO_SMALL ) && ( networkMessageCount > 0 ) )
     {
-        message = pvPortMalloc( messageLen );
+        _flushNetworkMessage();
 
-        if( message != NULL )
-        {
-            serializerRet = _serializeNetwork( responseType, &networkInfo, message, &messageLen );
-        }
-        else
-        {
-            serializerRet = IOT_SERIALIZER_OUT_OF_MEMORY;
-        }
+        messageLen = sizeof( networkMessage ) - networkMessageLength;
+        serializerRet = _serializeNetwork( responseType, pNetworkInfo, &networkMessage[ networkMessageLength ], &messageLen );
     }
 
     if( serializerRet == IOT_SERIALIZER_SUCCESS )
     {
-        if( IotBleDataTransfer_Send( wifiProvisioning.pChannel, message, messageLen ) != messageLen )
+        networkMessageLength += messageLen;
+        networkMessageCount++;
+
+        if( ( wifiProvisioning.listNetworkRequest.packed == false ) ||
+            ( networkMessageCount == IOT_BLE_WIFI_PROV_MAX_PACKED_NETWORKS ) )
         {
-            IotLogError( "Failed to send saved network ( SSID:%.*s )", pSavedNetwork->ucSSIDLength, ( char * ) pSavedNetwork->ucSSID );
+            _flushNetworkMessage();
         }
     }
     else
     {
-        IotLogError( "Failed to serialize saved network ( SSID:%.*s )", pSavedNetwork->ucSSIDLength, ( char * ) pSavedNetwork->ucSSID );
+        IotLogError( "Failed to serialize network ( SSID:%.*s ), error = %d",
+                     pNetworkInfo->SSIDLength,
+                     ( const char * ) pNetworkInfo->pSSID,
+                     serializerRet );
     }
+}
 
-    if( message != NULL )
-    {
-        vPortFree( message );
-    }
+static void _sendSavedNetwork( int32_t responseType,
+                               WIFINetworkProfile_t * pSavedNetwork,
+                               uint16_t idx )
+{
+    IotBleWifiNetworkInfo_t networkInfo = NETWORK_INFO_DEFAULT_PARAMS;
+
+    networkInfo.pSSID = pSavedNetwork->ucSSID;
+    networkInfo.SSIDLength = pSavedNetwork->ucSSIDLength;
+    networkInfo.pBSSID = pSavedNetwork->ucBSSID;
+    networkInfo.BSSIDLength = wificonfigMAX_BSSID_LEN;
+    networkInfo.connected = ( wifiProvisioning.connectedIdx == idx );
+    networkInfo.security = pSavedNetwork->xSecurity;
+    networkInfo.savedIdx = ( int32_t ) idx;
+
+    _sendNetwork( responseType, &networkInfo );
 }
 
 static void _sendScanNetwork( int32_t responseType,
                               WIFIScanResult_t * pScanNetwork )
 {
     IotBleWifiNetworkInfo_t networkInfo = NETWORK_INFO_DEFAULT_PARAMS;
-    uint8_t * message = NULL;
-    size_t messageLen = 0;
-    IotSerializerError_t serializerRet;
 
     networkInfo.pSSID = pScanNetwork->ucSSID;
     networkInfo.SSIDLength = pScanNetwork->ucSSIDLength;
@@ -1376,38 +1477,7 @@ static void _sendScanNetwork( int32_t responseType,
     networkInfo.hidden = false;
     networkInfo.security = pScanNetwork->xSecurity;
 
-    serializerRet = _serializeNetwork( responseType, &networkInfo, NULL, &messageLen );
-
-    if( serializerRet == IOT_SERIALIZER_SUCCESS )
-    {
-        message = pvPortMalloc( messageLen );
-
-        if( message != NULL )
-        {
-            serializerRet = _serializeNetwork( responseType, &networkInfo, message, &messageLen );
-        }
-        else
-        {
-            serializerRet = IOT_SERIALIZER_OUT_OF_MEMORY;
-        }
-    }
-
-    if( serializerRet == IOT_SERIALIZER_SUCCESS )
-    {
-        if( IotBleDataTransfer_Send( wifiProvisioning.pChannel, message, messageLen ) != messageLen )
-        {
-            IotLogError( "Failed to send scanned network network ( SSID:%.*s )", pScanNetwork->ucSSIDLength, ( const char * ) pScanNetwork->ucSSID );
-        }
-    }
-    else
-    {
-        IotLogError( "Failed to serialize scanned network network ( SSID:%.*s )", pScanNetwork->ucSSIDLength, ( const char * ) pScanNetwork->ucSSID );
-    }
-
-    if( message != NULL )
-    {
-        vPortFree( message );
-    }
+    _sendNetwork( responseType, &networkInfo );
 }
 /*-----------------------------------------------------------*/
 
@@ -1420,6 +1490,8 @@ void _listNetworkTask( IotTaskPool_t taskPool,
     WIFIReturnCode_t status;
     uint32_t networks_found = 0;
 
+    _startNetworkMessage();
+
     for( idx = 0; idx < wifiProvisioning.numNetworks; idx++ )
     {
         status = _getSavedNetwork( idx, &profile );
@@ -1430,6 +1502,9 @@ void _listNetworkTask( IotTaskPool_t taskPool,
         }
     }
 
+    /* The saved networks go out before the scan, which can take seconds. */
+    _flushNetworkMessage();
+
     memset( scanNetworks, 0x00, sizeof( WIFIScanResult_t ) * IOT_BLE_WIFI_PROVISIONIG_MAX_SCAN_NETWORKS );
 
     status = WIFI_Scan( scanNetworks, wifiProvisioning.listNetworkRequest.maxNetworks );
@@ -1445,6 +1520,8 @@ void _listNetworkTask( IotTaskPool_t taskPool,
             }
         }
 
+        _flushNetworkMessage();
+
         if( !networks_found )
         {
             _sendStatusResponse( IOT_BLE_WIFI_PROV_MSG_TYPE_LIST_NETWORK_RESP, status );
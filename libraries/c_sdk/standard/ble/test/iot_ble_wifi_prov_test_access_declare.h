@@ -69,4 +69,13 @@ WIFIReturnCode_t test_GetSavedNetwork( uint16_t usIndex,
 
 BaseType_t test_GetConnectedNetwork( WIFINetworkProfile_t * pxNetwork );
 
+void test_StartNetworkMessage( bool packed );
+
+void test_SendScanNetwork( WIFIScanResult_t * pxScanNetwork );
+
+void test_FlushNetworkMessage( void );
+
+const uint8_t * test_GetNetworkMessage( size_t * pxLength,
+                                        uint8_t * pucCount );
+
 #endif /* IOT_BLE_WIFI_PROV_TEST_ACCESS_DECLARE_H_ */
@@ -106,4 +106,29 @@ BaseType_t test_GetConnectedNetwork( WIFINetworkProfile_t * pNetwork )
     return ret;
 }
 
+void test_StartNetworkMessage( bool packed )
+{
+    wifiProvisioning.listNetworkRequest.packed = packed;
+    _startNetworkMessage();
+}
+
+void test_SendScanNetwork( WIFIScanResult_t * pScanNetwork )
+{
+    _sendScanNetwork( IOT_BLE_WIFI_PROV_MSG_TYPE_LIST_NETWORK_RESP, pScanNetwork );
+}
+
+void test_FlushNetworkMessage( void )
+{
+    _flushNetworkMessage();
+}
+
+const uint8_t * test_GetNetworkMessage( size_t * pLength,
+                                        uint8_t * pCount )
+{
+    *pLength = networkMessageLength;
+    *pCount = networkMessageCount;
+
+    return networkMessage;
+}
+
 #endif /* IOT_BLE_WIFI_PROV_TEST_ACCESS_DEFINE_H_ */
@@ -98,6 +98,9 @@ TEST_GROUP_RUNNER( BLE_Unit_MQTT_Serialize )
     RUN_TEST_CASE( BLE_Unit_MQTT_Serialize, SerializeUNSUBSCRIBE_MallocFail );
     RUN_TEST_CASE( BLE_Unit_MQTT_Serialize, SerializePUBACK_MallocFail );
     RUN_TEST_CASE( BLE_Unit_MQTT_Serialize, SerializeDISCONNECT_MallocFail );
+
+    RUN_TEST_CASE( BLE_Unit_MQTT_Serialize, EncodePUBLISH );
+    RUN_TEST_CASE( BLE_Unit_MQTT_Serialize, EncodePUBLISH_BufferTooSmall );
 }
 
 TEST( BLE_Unit_MQTT_Serialize, SerializeCONNECT )
@@ -1185,3 +1188,54 @@ TEST( BLE_Unit_MQTT_Serialize, SerializeDISCONNECT_MallocFail )
         IotBleMqtt_FreePacket( ( uint8_t * ) pMesg );
     }
 }
+
+TEST( BLE_Unit_MQTT_Serialize, EncodePUBLISH )
+{
+    MQTTBLEPublishInfo_t publishInfo = { 0 };
+    MQTTBLEPacketView_t view = { 0 };
+    MQTTBLEStatus_t status;
+    uint8_t buffer[ IOT_BLE_MQTT_PUBLISH_SIZE_MAX( TEST_TOPIC_LENGTH, TEST_DATA_LENGTH ) ];
+    size_t bufLen = 0;
+    uint16_t packetIdentifier = 2;
+
+    publishInfo.qos = TEST_QOS1;
+    publishInfo.pPayload = ( uint8_t * ) TEST_DATA;
+    publishInfo.payloadLength = TEST_DATA_LENGTH;
+    publishInfo.pTopicName = TEST_TOPIC;
+    publishInfo.topicNameLength = TEST_TOPIC_LENGTH;
+
+    status = IotBleMqtt_EncodePublish( &publishInfo, packetIdentifier, buffer, sizeof( buffer ), &bufLen );
+    TEST_ASSERT_EQUAL( MQTTBLESuccess, status );
+    TEST_ASSERT_NOT_EQUAL( 0UL, bufLen );
+    TEST_ASSERT_LESS_OR_EQUAL( sizeof( buffer ), bufLen );
+
+    /* The parsed topic and payload point back into the encoded packet. */
+    status = IotBleMqtt_ParsePacket( buffer, bufLen, &view );
+    TEST_ASSERT_EQUAL( MQTTBLESuccess, status );
+    TEST_ASSERT_EQUAL( IOT_BLE_MQTT_MSG_TYPE_PUBLISH, view.packetType );
+    TEST_ASSERT_EQUAL( TEST_QOS1, view.qos );
+    TEST_ASSERT_EQUAL( packetIdentifier, view.packetIdentifier );
+    TEST_ASSERT_EQUAL( TEST_TOPIC_LENGTH, view.topicNameLength );
+    TEST_ASSERT_EQUAL( 0, strncmp( view.pTopicName, TEST_TOPIC, view.topicNameLength ) );
+    TEST_ASSERT_TRUE( ( ( const uint8_t * ) view.pTopicName > buffer ) && ( ( const uint8_t * ) view.pTopicName < buffer + bufLen ) );
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, view.payloadLength );
+    TEST_ASSERT_EQUAL( 0, strncmp( ( const char * ) view.pPayload, TEST_DATA, view.payloadLength ) );
+    TEST_ASSERT_TRUE( ( ( const uint8_t * ) view.pPayload > buffer ) && ( ( const uint8_t * ) view.pPayload < buffer + bufLen ) );
+}
+
+TEST( BLE_Unit_MQTT_Serialize, EncodePUBLISH_BufferTooSmall )
+{
+    MQTTBLEPublishInfo_t publishInfo = { 0 };
+    MQTTBLEStatus_t status;
+    uint8_t buffer[ IOT_BLE_MQTT_PUBLISH_SIZE_MAX( TEST_TOPIC_LENGTH, TEST_DATA_LENGTH ) ];
+    size_t bufLen = 0;
+
+    publishInfo.qos = TEST_QOS1;
+    publishInfo.pPayload = ( uint8_t * ) TEST_DATA;
+    publishInfo.payloadLength = TEST_DATA_LENGTH;
+    publishInfo.pTopicName = TEST_TOPIC;
+    publishInfo.topicNameLength = TEST_TOPIC_LENGTH;
+
+    status = IotBleMqtt_EncodePublish( &publishInfo, 1, buffer, sizeof( buffer ) - 1U, &bufLen );
+    TEST_ASSERT_EQUAL( MQTTBLENoMemory, status );
+}
@@ -37,6 +37,7 @@
 #include "iot_ble_wifi_provisioning.h"
 #include "iot_ble_wifi_prov_test_access_declare.h"
 #include "iot_ble_data_transfer.h"
+#include "iot_serializer.h"
 #include "aws_clientcredential.h"
 /* Test framework includes. */
 #include "unity_fixture.h"
@@ -46,6 +47,10 @@ static void prvRemoveSavedNetworks( void );
 static void prvGetRealWIFINetwork( WIFINetworkProfile_t * pxNetwork );
 static void prvGetTestWIFINetwork( WIFINetworkProfile_t * pxNetwork,
                                    uint16_t usId );
+static void prvGetTestScanNetwork( WIFIScanResult_t * pxNetwork,
+                                   uint16_t usId );
+static bool prvHasSSID( IotSerializerDecoderObject_t * pxNetworkMap,
+                        WIFIScanResult_t * pxNetwork );
 static bool prvIsSameNetwork( WIFINetworkProfile_t * pxNetwork1,
                               WIFINetworkProfile_t * pxNetwork2 );
 static bool prvConnectRealNetwork( void );
@@ -56,6 +61,14 @@ static bool prvConnectRealNetwork( void );
 #define testMAXWIFI_WAIT_TIME    pdMS_TO_TICKS( 10000 )
 #define testWIFI_DELAY           pdMS_TO_TICKS( 2000 )
 
+/* Key of the SSID in a network map, and the CBOR headers of a packed array and of a single network map. */
+#define testSSID_KEY             "r"
+#define testCBOR_ARRAY           ( 0x80 )
+#define testCBOR_NETWORK_MAP     ( 0xA9 )
+
+/* One below the number of networks after which a packed message is sent regardless of its size. */
+#define testMAX_PACKED_NETWORKS  ( 22 )
+
 TEST_GROUP( Full_WiFi_Provisioning );
 
 /*-----------------------------------------------------------*/
@@ -126,6 +139,9 @@ TEST_GROUP_RUNNER( Full_WiFi_Provisioning )
     RUN_TEST_CASE( Full_WiFi_Provisioning, WIFI_PROVISION_DeleteConnectedNetwork );
     RUN_TEST_CASE( Full_WiFi_Provisioning, WIFI_PROVISION_GetNumNetworks );
     RUN_TEST_CASE( Full_WiFi_Provisioning, WIFI_PROVISION_ConnectSavedNetwork );
+    RUN_TEST_CASE( Full_WiFi_Provisioning, WIFI_PROVISION_PackedScanFillsMTU );
+    RUN_TEST_CASE( Full_WiFi_Provisioning, WIFI_PROVISION_PackedScanEndsOnLastResult );
+    RUN_TEST_CASE( Full_WiFi_Provisioning, WIFI_PROVISION_UnpackedScanSendsEachNetwork );
 
     prvRemoveSavedNetworks();
 
@@ -426,6 +442,139 @@ TEST( Full_WiFi_Provisioning, WIFI_PROVISION_ConnectSavedNetwork )
     }
 }
 
+TEST( Full_WiFi_Provisioning, WIFI_PROVISION_PackedScanFillsMTU )
+{
+    WIFIScanResult_t xScanNetwork;
+    const uint8_t * pucMessage;
+    size_t xLength = 0, xPrevLength = 0;
+    uint8_t ucCount = 0, ucPrevCount = 0;
+    size_t xLimit = IotBleDataTransfer_GetTransmitLength() - 1;
+    bool xFlushed = false;
+    uint16_t usId;
+
+    TEST_ASSERT_LESS_OR_EQUAL( IOT_BLE_WIFI_PROVISIONING_NETWORK_MESSAGE_SIZE, IotBleDataTransfer_GetTransmitLength() );
+
+    if( TEST_PROTECT() )
+    {
+        test_StartNetworkMessage( true );
+
+        for( usId = 0; ( usId < testMAX_PACKED_NETWORKS ) && ( xFlushed == false ); usId++ )
+        {
+            prvGetTestScanNetwork( &xScanNetwork, usId );
+            ( void ) test_GetNetworkMessage( &xPrevLength, &ucPrevCount );
+            test_SendScanNetwork( &xScanNetwork );
+            pucMessage = test_GetNetworkMessage( &xLength, &ucCount );
+
+            if( ucCount <= ucPrevCount )
+            {
+                /* The batch was sent once the next network no longer fit in the MTU, and that network starts the next batch. */
+                xFlushed = true;
+                TEST_ASSERT_EQUAL( 1, ucCount );
+                TEST_ASSERT_EQUAL_HEX8( testCBOR_ARRAY | ucPrevCount, pucMessage[ 0 ] );
+                TEST_ASSERT_LESS_OR_EQUAL( xLimit, xPrevLength );
+                TEST_ASSERT_GREATER_THAN( xLimit, xPrevLength + xLength - 1 );
+            }
+            else
+            {
+                TEST_ASSERT_EQUAL( ucPrevCount + 1, ucCount );
+                TEST_ASSERT_LESS_OR_EQUAL( xLimit, xLength );
+            }
+        }
+
+        TEST_ASSERT_TRUE( xFlushed );
+    }
+
+    test_FlushNetworkMessage();
+}
+
+TEST( Full_WiFi_Provisioning, WIFI_PROVISION_PackedScanEndsOnLastResult )
+{
+    WIFIScanResult_t xScanNetwork;
+    const uint8_t * pucMessage;
+    size_t xLength = 0, xFlushedLength = 0;
+    uint8_t ucCount = 0;
+    IotSerializerDecoderObject_t xDecoderObj = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    IotSerializerDecoderObject_t xNetworkMap = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    IotSerializerDecoderIterator_t xIterator = IOT_SERIALIZER_DECODER_ITERATOR_INITIALIZER;
+    uint16_t usId;
+
+    if( TEST_PROTECT() )
+    {
+        test_StartNetworkMessage( true );
+
+        for( usId = 0; usId < 3; usId++ )
+        {
+            prvGetTestScanNetwork( &xScanNetwork, usId );
+            test_SendScanNetwork( &xScanNetwork );
+            ( void ) test_GetNetworkMessage( &xLength, &ucCount );
+
+            /* A partial batch is held until the scan results run out. */
+            TEST_ASSERT_EQUAL( usId + 1, ucCount );
+        }
+
+        /* The list network task flushes after the last scan result. */
+        test_FlushNetworkMessage();
+        pucMessage = test_GetNetworkMessage( &xFlushedLength, &ucCount );
+        TEST_ASSERT_EQUAL( 0, ucCount );
+        TEST_ASSERT_EQUAL( 1, xFlushedLength );
+        TEST_ASSERT_EQUAL_HEX8( testCBOR_ARRAY | 3, pucMessage[ 0 ] );
+
+        /* The sent message is an array of the three networks, ending on the last scan result. */
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, IOT_BLE_MESG_DECODER.init( &xDecoderObj, pucMessage, xLength ) );
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_CONTAINER_ARRAY, xDecoderObj.type );
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, IOT_BLE_MESG_DECODER.stepIn( &xDecoderObj, &xIterator ) );
+
+        for( usId = 0; usId < 3; usId++ )
+        {
+            TEST_ASSERT_FALSE( IOT_BLE_MESG_DECODER.isEndOfContainer( xIterator ) );
+            TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, IOT_BLE_MESG_DECODER.get( xIterator, &xNetworkMap ) );
+            TEST_ASSERT_EQUAL( IOT_SERIALIZER_CONTAINER_MAP, xNetworkMap.type );
+            prvGetTestScanNetwork( &xScanNetwork, usId );
+            TEST_ASSERT_TRUE( prvHasSSID( &xNetworkMap, &xScanNetwork ) );
+            IOT_BLE_MESG_DECODER.destroy( &xNetworkMap );
+            TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, IOT_BLE_MESG_DECODER.next( xIterator ) );
+        }
+
+        TEST_ASSERT_TRUE( IOT_BLE_MESG_DECODER.isEndOfContainer( xIterator ) );
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, IOT_BLE_MESG_DECODER.stepOut( xIterator, &xDecoderObj ) );
+    }
+
+    IOT_BLE_MESG_DECODER.destroy( &xDecoderObj );
+}
+
+TEST( Full_WiFi_Provisioning, WIFI_PROVISION_UnpackedScanSendsEachNetwork )
+{
+    WIFIScanResult_t xScanNetwork;
+    const uint8_t * pucMessage;
+    size_t xLength = 0;
+    uint8_t ucCount = 0;
+    IotSerializerDecoderObject_t xNetworkMap = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    uint16_t usId;
+
+    if( TEST_PROTECT() )
+    {
+        test_StartNetworkMessage( false );
+
+        for( usId = 0; usId < 3; usId++ )
+        {
+            prvGetTestScanNetwork( &xScanNetwork, usId );
+            test_SendScanNetwork( &xScanNetwork );
+            pucMessage = test_GetNetworkMessage( &xLength, &ucCount );
+
+            /* Each network is sent on its own as a bare map, as before packing was added. */
+            TEST_ASSERT_EQUAL( 0, ucCount );
+            TEST_ASSERT_EQUAL( 0, xLength );
+            TEST_ASSERT_EQUAL_HEX8( testCBOR_NETWORK_MAP, pucMessage[ 0 ] );
+
+            TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                               IOT_BLE_MESG_DECODER.init( &xNetworkMap, pucMessage, IOT_BLE_WIFI_PROVISIONING_NETWORK_MESSAGE_SIZE ) );
+            TEST_ASSERT_EQUAL( IOT_SERIALIZER_CONTAINER_MAP, xNetworkMap.type );
+            TEST_ASSERT_TRUE( prvHasSSID( &xNetworkMap, &xScanNetwork ) );
+            IOT_BLE_MESG_DECODER.destroy( &xNetworkMap );
+        }
+    }
+}
+
 static void prvGetRealWIFINetwork( WIFINetworkProfile_t * pxNetwork )
 {
     memcpy( pxNetwork->ucSSID, clientcredentialWIFI_SSID, strlen( clientcredentialWIFI_SSID ) );
@@ -501,6 +650,34 @@ static void prvGetTestWIFINetwork( WIFINetworkProfile_t * pxNetwork,
     pxNetwork->xSecurity = clientcredentialWIFI_SECURITY;
 }
 
+static void prvGetTestScanNetwork( WIFIScanResult_t * pxNetwork,
+                                   uint16_t usId )
+{
+    /* Full length SSIDs, so that a packed message fills the MTU with as few networks as possible. */
+    memset( pxNetwork, 0x00, sizeof( WIFIScanResult_t ) );
+    memset( pxNetwork->ucSSID, 'A' + ( usId % 26 ), sizeof( pxNetwork->ucSSID ) );
+    pxNetwork->ucSSIDLength = sizeof( pxNetwork->ucSSID );
+    pxNetwork->ucBSSID[ 0 ] = ( uint8_t ) usId;
+    pxNetwork->xSecurity = clientcredentialWIFI_SECURITY;
+    pxNetwork->cRSSI = -50;
+}
+
+static bool prvHasSSID( IotSerializerDecoderObject_t * pxNetworkMap,
+                        WIFIScanResult_t * pxNetwork )
+{
+    IotSerializerDecoderObject_t xValue = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    bool xResult = false;
+
+    if( ( IOT_BLE_MESG_DECODER.find( pxNetworkMap, testSSID_KEY, &xValue ) == IOT_SERIALIZER_SUCCESS ) &&
+        ( xValue.type == IOT_SERIALIZER_SCALAR_TEXT_STRING ) &&
+        ( xValue.u.value.u.string.length == pxNetwork->ucSSIDLength ) )
+    {
+        xResult = ( memcmp( xValue.u.value.u.string.pString, pxNetwork->ucSSID, pxNetwork->ucSSIDLength ) == 0 );
+    }
+
+    return xResult;
+}
+
 static void prvRemoveSavedNetworks( void )
 {
     uint16_t usNumNetworks = IOT_BLE_WIFI_PROVISIONING_MAX_SAVED_NETWORKS;
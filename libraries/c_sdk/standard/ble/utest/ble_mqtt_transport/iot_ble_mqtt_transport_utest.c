@@ -32,6 +32,9 @@ static NetworkContext_t context;
 static MQTTFixedBuffer_t fixedBuffer;
 static size_t bufferSize = 0;
 
+/* Stands in for the send buffer of the BLE channel packets are encoded into. */
+static uint8_t sendBuffer[ 64 ];
+
 /*-----------------------------------------------------------*/
 
 void setUp( void )
@@ -40,6 +43,8 @@ void setUp( void )
 
     fixedBuffer.pBuffer = buffer;
     fixedBuffer.size = 100;
+
+    IotBleDataTransfer_GetFraming_IgnoreAndReturn( IOT_BLE_DATA_TRANSFER_FRAMING_DEFAULT );
 }
 
 /* called before each testcase */
@@ -113,6 +118,7 @@ MQTTBLEStatus_t basicConnectCallback( const MQTTBLEConnectInfo_t * const pConnec
     TEST_ASSERT_EQUAL_INT( 12U, pConnectInfo->clientIdentifierLength );
     TEST_ASSERT_EQUAL_INT( 10U, pConnectInfo->keepAliveSeconds );
 
+    *pConnectPacket = sendBuffer;
     *pPacketSize = 10U;
     return MQTTBLESuccess;
 }
@@ -132,7 +138,8 @@ void test_IotBleMqttTransportSend_ConnectBasic( void )
     size_t packetSize = 26U;
 
     IotBleMqtt_SerializeConnect_Stub( basicConnectCallback );
-    IotBleDataTransfer_Send_IgnoreAndReturn( 10U );
+    IotBleDataTransfer_AcquireSendBuffer_IgnoreAndReturn( sendBuffer );
+    IotBleDataTransfer_SendAcquiredBuffer_IgnoreAndReturn( 10U );
     vPortFree_Ignore();
 
     bytesSent = ( size_t ) IotBleMqttTransportSend( &context,
@@ -163,6 +170,7 @@ MQTTBLEStatus_t credentialConnectCallback( const MQTTBLEConnectInfo_t * const pC
     TEST_ASSERT_EQUAL_INT( 3U, pConnectInfo->passwordLength );
     TEST_ASSERT_EQUAL_INT( 3U, pConnectInfo->userNameLength );
 
+    *pConnectPacket = sendBuffer;
     *pPacketSize = 10U;
     return MQTTBLESuccess;
 }
@@ -182,7 +190,8 @@ void test_IotBleMqttTransportSend_ConnectCredentials( void )
     size_t packetSize = 42U;
 
     IotBleMqtt_SerializeConnect_Stub( credentialConnectCallback );
-    IotBleDataTransfer_Send_IgnoreAndReturn( 10U );
+    IotBleDataTransfer_AcquireSendBuffer_IgnoreAndReturn( sendBuffer );
+    IotBleDataTransfer_SendAcquiredBuffer_IgnoreAndReturn( 10U );
     vPortFree_Ignore();
     bytesSent = ( size_t ) IotBleMqttTransportSend( &context, ( void * ) MQTTPacket, packetSize );
     TEST_ASSERT_EQUAL_INT( bytesSent, packetSize );
@@ -212,7 +221,8 @@ void test_IotBleMqttTransportSend_ConnectCredentialsAndWill( void )
     size_t packetSize = 52U;
 
     IotBleMqtt_SerializeConnect_Stub( credentialConnectCallback );
-    IotBleDataTransfer_Send_IgnoreAndReturn( 10U );
+    IotBleDataTransfer_AcquireSendBuffer_IgnoreAndReturn( sendBuffer );
+    IotBleDataTransfer_SendAcquiredBuffer_IgnoreAndReturn( 10U );
     vPortFree_Ignore();
     bytesSent = ( size_t ) IotBleMqttTransportSend( &context, ( void * ) MQTTPacket, packetSize );
     TEST_ASSERT_EQUAL_INT( bytesSent, packetSize );
@@ -402,9 +412,10 @@ void test_IotBleMqttTransportSend_PublishBasic( void )
         0x54, 0x20, 0x57, 0x6f, 0x72, 0x6c, 0x64, 0x21
     };
 
-    IotBleMqtt_SerializePublish_ExpectAnyArgsAndReturn( MQTTBLESuccess );
-    IotBleMqtt_SerializePublish_ReturnThruPtr_pPacketSize( &packetSize );
-    IotBleDataTransfer_Send_ExpectAnyArgsAndReturn( 38 );
+    IotBleDataTransfer_AcquireSendBuffer_ExpectAnyArgsAndReturn( sendBuffer );
+    IotBleMqtt_EncodePublish_ExpectAnyArgsAndReturn( MQTTBLESuccess );
+    IotBleMqtt_EncodePublish_ReturnThruPtr_pPacketSize( &packetSize );
+    IotBleDataTransfer_SendAcquiredBuffer_ExpectAnyArgsAndReturn( 38 );
 
     vPortFree_Ignore();
     pvPortMalloc_IgnoreAndReturn( buffer );
@@ -438,7 +449,9 @@ void test_IotBleMqttTransportSend_PublishBadDeserialize( void )
     size_t packetSize = 38U;
 
     MQTT_DeserializePublish_IgnoreAndReturn( MQTTBadParameter );
-    IotBleMqtt_SerializePublish_IgnoreAndReturn( MQTTBLESuccess );
+    IotBleDataTransfer_AcquireSendBuffer_IgnoreAndReturn( sendBuffer );
+    IotBleMqtt_EncodePublish_IgnoreAndReturn( MQTTBLESuccess );
+    IotBleDataTransfer_ReleaseSendBuffer_Ignore();
     vPortFree_Ignore();
     pvPortMalloc_IgnoreAndReturn( buffer );
 
@@ -465,9 +478,10 @@ void test_IotBleMqttTransportSend_Puback( void )
     size_t packetSize = 4U;
 
     MQTT_DeserializeAck_IgnoreAndReturn( MQTTSuccess );
-    IotBleMqtt_SerializePuback_ExpectAnyArgsAndReturn( MQTTBLESuccess );
-    IotBleMqtt_SerializePuback_ReturnThruPtr_pPacketSize( &packetSize );
-    IotBleDataTransfer_Send_ExpectAnyArgsAndReturn( 4U );
+    IotBleDataTransfer_AcquireSendBuffer_ExpectAnyArgsAndReturn( sendBuffer );
+    IotBleMqtt_EncodePuback_ExpectAnyArgsAndReturn( MQTTBLESuccess );
+    IotBleMqtt_EncodePuback_ReturnThruPtr_pPacketSize( &packetSize );
+    IotBleDataTransfer_SendAcquiredBuffer_ExpectAnyArgsAndReturn( 4U );
     vPortFree_Ignore();
 
     bytesSent = ( size_t ) IotBleMqttTransportSend( &context,
@@ -493,7 +507,9 @@ void test_IotBleMqttTransportSend_PubackBadDeserialize( void )
 
     MQTT_DeserializeAck_IgnoreAndReturn( MQTTBadParameter );
     /* IotBleMqtt_DeserializePuback_Stub( forgePacketIdentifierGood ); */
-    IotBleMqtt_SerializePuback_IgnoreAndReturn( MQTTBLESuccess );
+    IotBleDataTransfer_AcquireSendBuffer_IgnoreAndReturn( sendBuffer );
+    IotBleMqtt_EncodePuback_IgnoreAndReturn( MQTTBLESuccess );
+    IotBleDataTransfer_ReleaseSendBuffer_Ignore();
 
     bytesSent = ( size_t ) IotBleMqttTransportSend( &context,
                                                     ( void * ) MQTTPacket,
@@ -513,9 +529,10 @@ void test_IotBleMqttTransportSend_PubackBadDeserialize( void )
  */
 MQTTBLEStatus_t basicSubscribeCallback( const MQTTSubscribeInfo_t * const pSubscriptionList,
                                         size_t subscriptionCount,
-                                        uint8_t ** const pSubscribePacket,
+                                        uint16_t packetIdentifier,
+                                        uint8_t * pBuffer,
+                                        size_t bufferLength,
                                         size_t * const pPacketSize,
-                                        uint16_t * const pPacketIdentifier,
                                         int num_calls )
 {
     TEST_ASSERT_EQUAL_INT( 1, subscriptionCount );
@@ -538,8 +555,9 @@ void test_IotBleMqttTransportSend_SubscribeBasic( void )
     };
     size_t packetSize = 21;
 
-    IotBleMqtt_SerializeSubscribe_Stub( basicSubscribeCallback );
-    IotBleDataTransfer_Send_ExpectAnyArgsAndReturn( 1U );
+    IotBleDataTransfer_AcquireSendBuffer_ExpectAnyArgsAndReturn( sendBuffer );
+    IotBleMqtt_EncodeSubscribe_Stub( basicSubscribeCallback );
+    IotBleDataTransfer_SendAcquiredBuffer_ExpectAnyArgsAndReturn( 1U );
     vPortFree_Ignore();
 
     bytesSent = ( size_t ) IotBleMqttTransportSend( &context, ( void * ) MQTTPacket, packetSize );
@@ -556,9 +574,10 @@ void test_IotBleMqttTransportSend_SubscribeBasic( void )
  */
 MQTTBLEStatus_t multiSubscribeCallback( const MQTTSubscribeInfo_t * const pSubscriptionList,
                                         size_t subscriptionCount,
-                                        uint8_t ** const pSubscribePacket,
+                                        uint16_t packetIdentifier,
+                                        uint8_t * pBuffer,
+                                        size_t bufferLength,
                                         size_t * const pPacketSize,
-                                        uint16_t * const pPacketIdentifier,
                                         int num_calls )
 {
     TEST_ASSERT_EQUAL_INT( 2, subscriptionCount );
@@ -586,8 +605,9 @@ void test_IotBleMqttTransportSend_SubscribeMulti( void )
     };
     size_t packetSize = 40;
 
-    IotBleMqtt_SerializeSubscribe_Stub( multiSubscribeCallback );
-    IotBleDataTransfer_Send_ExpectAnyArgsAndReturn( 1U );
+    IotBleDataTransfer_AcquireSendBuffer_ExpectAnyArgsAndReturn( sendBuffer );
+    IotBleMqtt_EncodeSubscribe_Stub( multiSubscribeCallback );
+    IotBleDataTransfer_SendAcquiredBuffer_ExpectAnyArgsAndReturn( 1U );
     vPortFree_Ignore();
 
     bytesSent = ( size_t ) IotBleMqttTransportSend( &context, ( void * ) MQTTPacket, packetSize );
@@ -604,9 +624,10 @@ void test_IotBleMqttTransportSend_SubscribeMulti( void )
  */
 MQTTBLEStatus_t multiQosSubscribeCallback( const MQTTSubscribeInfo_t * const pSubscriptionList,
                                            size_t subscriptionCount,
-                                           uint8_t ** const pSubscribePacket,
+                                           uint16_t packetIdentifier,
+                                           uint8_t * pBuffer,
+                                           size_t bufferLength,
                                            size_t * const pPacketSize,
-                                           uint16_t * const pPacketIdentifier,
                                            int num_calls )
 {
     TEST_ASSERT_EQUAL_INT( 2, subscriptionCount );
@@ -633,8 +654,9 @@ void test_IotBleMqttTransportSend_SubscribeMultiQos( void )
     };
     size_t packetSize = 39;
 
-    IotBleMqtt_SerializeSubscribe_Stub( multiQosSubscribeCallback );
-    IotBleDataTransfer_Send_ExpectAnyArgsAndReturn( 1U );
+    IotBleDataTransfer_AcquireSendBuffer_ExpectAnyArgsAndReturn( sendBuffer );
+    IotBleMqtt_EncodeSubscribe_Stub( multiQosSubscribeCallback );
+    IotBleDataTransfer_SendAcquiredBuffer_ExpectAnyArgsAndReturn( 1U );
     vPortFree_Ignore();
 
     bytesSent = ( size_t ) IotBleMqttTransportSend( &context, ( void * ) MQTTPacket, packetSize );
@@ -675,9 +697,10 @@ void test_IotBleMqttTransportSend_SubscribeBad( void )
  */
 MQTTBLEStatus_t unsubscribeCallback( const MQTTSubscribeInfo_t * const pSubscriptionList,
                                      size_t subscriptionCount,
-                                     uint8_t ** const pSubscribePacket,
+                                     uint16_t packetIdentifier,
+                                     uint8_t * pBuffer,
+                                     size_t bufferLength,
                                      size_t * const pPacketSize,
-                                     uint16_t * const pPacketIdentifier,
                                      int num_calls )
 {
     TEST_ASSERT_EQUAL_INT( 2, subscriptionCount );
@@ -703,8 +726,9 @@ void test_IotBleMqttTransportSend_Unsubscribe( void )
     };
     size_t packetSize = 37;
 
-    IotBleMqtt_SerializeUnsubscribe_Stub( unsubscribeCallback );
-    IotBleDataTransfer_Send_ExpectAnyArgsAndReturn( 1U );
+    IotBleDataTransfer_AcquireSendBuffer_ExpectAnyArgsAndReturn( sendBuffer );
+    IotBleMqtt_EncodeUnsubscribe_Stub( unsubscribeCallback );
+    IotBleDataTransfer_SendAcquiredBuffer_ExpectAnyArgsAndReturn( 1U );
     vPortFree_Ignore();
 
     bytesSent = ( size_t ) IotBleMqttTransportSend( &context, ( void * ) MQTTPacket, packetSize );
@@ -750,9 +774,10 @@ void test_IotBleMqttTransportSend_PingReq( void )
     uint8_t MQTTPacket[] = { 0xc0, 0x00 };
     size_t packetSize = 2U;
 
-    IotBleMqtt_SerializePingreq_ExpectAnyArgsAndReturn( MQTTBLESuccess );
-    IotBleMqtt_SerializePingreq_ReturnThruPtr_pPacketSize( &packetSize );
-    IotBleDataTransfer_Send_ExpectAnyArgsAndReturn( 2U );
+    IotBleDataTransfer_AcquireSendBuffer_ExpectAnyArgsAndReturn( sendBuffer );
+    IotBleMqtt_EncodePingreq_ExpectAnyArgsAndReturn( MQTTBLESuccess );
+    IotBleMqtt_EncodePingreq_ReturnThruPtr_pPacketSize( &packetSize );
+    IotBleDataTransfer_SendAcquiredBuffer_ExpectAnyArgsAndReturn( 2U );
     vPortFree_Ignore();
 
     bytesSent = ( size_t ) IotBleMqttTransportSend( &context,
@@ -776,7 +801,9 @@ void test_IotBleMqttTransportSend_PingReqBadSerialize( void )
     uint8_t MQTTPacket[] = { 0xc0, 0x00 };
     size_t packetSize = 2U;
 
-    IotBleMqtt_SerializePingreq_IgnoreAndReturn( MQTTBLENoMemory );
+    IotBleDataTransfer_AcquireSendBuffer_IgnoreAndReturn( sendBuffer );
+    IotBleMqtt_EncodePingreq_IgnoreAndReturn( MQTTBLENoMemory );
+    IotBleDataTransfer_ReleaseSendBuffer_Ignore();
 
     bytesSent = ( size_t ) IotBleMqttTransportSend( &context,
                                                     ( void * ) MQTTPacket,
@@ -785,6 +812,27 @@ void test_IotBleMqttTransportSend_PingReqBadSerialize( void )
 }
 /* ----- End Ping Request Bad Test ----- */
 
+/* ----- Begin Ping Request No Send Buffer Test ----- */
+
+/**
+ * @brief Sends a ping request packet while the channel has no send buffer
+ * @details Mock out a NULL send buffer and make sure nothing is encoded or sent
+ */
+void test_IotBleMqttTransportSend_PingReqNoSendBuffer( void )
+{
+    size_t bytesSent = 0;
+    uint8_t MQTTPacket[] = { 0xc0, 0x00 };
+    size_t packetSize = 2U;
+
+    IotBleDataTransfer_AcquireSendBuffer_ExpectAnyArgsAndReturn( NULL );
+
+    bytesSent = ( size_t ) IotBleMqttTransportSend( &context,
+                                                    ( void * ) MQTTPacket,
+                                                    packetSize );
+    TEST_ASSERT_EQUAL_INT( 0, bytesSent );
+}
+/* ----- End Ping Request No Send Buffer Test ----- */
+
 /* Outgoing Disconnect Packets */
 /*-----------------------------------------------------------*/
 
@@ -800,9 +848,10 @@ void test_IotBleMqttTransportSend_Disconnect( void )
     uint8_t MQTTPacket[] = { 0xe0, 0x00 }; /* IOT_BLE_MQTT_MSG_TYPE_DISCONNECT */
     size_t packetSize = 2U;
 
-    IotBleMqtt_SerializeDisconnect_ExpectAnyArgsAndReturn( MQTTBLESuccess );
-    IotBleMqtt_SerializeDisconnect_ReturnThruPtr_pPacketSize( &packetSize );
-    IotBleDataTransfer_Send_ExpectAnyArgsAndReturn( 2U );
+    IotBleDataTransfer_AcquireSendBuffer_ExpectAnyArgsAndReturn( sendBuffer );
+    IotBleMqtt_EncodeDisconnect_ExpectAnyArgsAndReturn( MQTTBLESuccess );
+    IotBleMqtt_EncodeDisconnect_ReturnThruPtr_pPacketSize( &packetSize );
+    IotBleDataTransfer_SendAcquiredBuffer_ExpectAnyArgsAndReturn( 2U );
     vPortFree_Ignore();
 
     bytesSent = ( size_t ) IotBleMqttTransportSend( &context,
@@ -826,7 +875,9 @@ void test_IotBleMqttTransportSend_DisconnectBadSerialize( void )
     uint8_t MQTTPacket[] = { 0xe0, 0x00 }; /* IOT_BLE_MQTT_MSG_TYPE_DISCONNECT */
     size_t packetSize = 2U;
 
-    IotBleMqtt_SerializeDisconnect_IgnoreAndReturn( MQTTBLENoMemory );
+    IotBleDataTransfer_AcquireSendBuffer_IgnoreAndReturn( sendBuffer );
+    IotBleMqtt_EncodeDisconnect_IgnoreAndReturn( MQTTBLENoMemory );
+    IotBleDataTransfer_ReleaseSendBuffer_Ignore();
 
     bytesSent = ( size_t ) IotBleMqttTransportSend( &context,
                                                     ( void * ) MQTTPacket,
@@ -851,9 +902,10 @@ void test_IotBleMqttTransportSend_ChannelFails( void )
     uint8_t MQTTPacket[] = { 0xc0, 0x00 }; /* IOT_BLE_MQTT_MSG_TYPE_PINGREQ */
     size_t packetSize = 2U;
 
-    IotBleMqtt_SerializePingreq_ExpectAnyArgsAndReturn( MQTTBLESuccess );
-    IotBleMqtt_SerializePingreq_ReturnThruPtr_pPacketSize( &packetSize );
-    IotBleDataTransfer_Send_ExpectAnyArgsAndReturn( 0U );
+    IotBleDataTransfer_AcquireSendBuffer_ExpectAnyArgsAndReturn( sendBuffer );
+    IotBleMqtt_EncodePingreq_ExpectAnyArgsAndReturn( MQTTBLESuccess );
+    IotBleMqtt_EncodePingreq_ReturnThruPtr_pPacketSize( &packetSize );
+    IotBleDataTransfer_SendAcquiredBuffer_ExpectAnyArgsAndReturn( 0U );
     vPortFree_Ignore();
     context.publishInfo.pending = false;
 
@@ -874,8 +926,10 @@ void test_IotBleMqttTransportSend_ChannelFails_packetSizeZero( void )
     size_t packetSize = 2U;
     size_t ret_packetSize = 0U;
 
-    IotBleMqtt_SerializePingreq_ExpectAnyArgsAndReturn( MQTTBLESuccess );
-    IotBleMqtt_SerializePingreq_ReturnThruPtr_pPacketSize( &ret_packetSize );
+    IotBleDataTransfer_AcquireSendBuffer_ExpectAnyArgsAndReturn( sendBuffer );
+    IotBleMqtt_EncodePingreq_ExpectAnyArgsAndReturn( MQTTBLESuccess );
+    IotBleMqtt_EncodePingreq_ReturnThruPtr_pPacketSize( &ret_packetSize );
+    IotBleDataTransfer_ReleaseSendBuffer_Ignore();
     vPortFree_Ignore();
     context.publishInfo.pending = false;
 
@@ -1500,6 +1554,97 @@ void test_IotBleMqttTransportAccept_PingRespBadDeserialize( void )
 /* ----- End PingResp Bad Deserialize Test ----- */
 
 
+/*******************************************************************************
+ * Compact framing
+ ******************************************************************************/
+
+/* ----- Begin Compact Framing Send Test ----- */
+
+/**
+ * @brief Sends a packet on a channel the peer opened with raw framing
+ * @details The MQTT packet goes out unchanged, without being converted to CBOR
+ */
+void test_IotBleMqttTransportSend_CompactFraming( void )
+{
+    size_t bytesSent = 0;
+    uint8_t MQTTPacket[] = { 0x40, 0x02, 0x00, 0x01 };
+    size_t packetSize = 4U;
+
+    IotBleDataTransfer_GetFraming_IgnoreAndReturn( IOT_BLE_DATA_TRANSFER_FRAMING_RAW );
+    IotBleDataTransfer_Send_ExpectAndReturn( context.pChannel, MQTTPacket, packetSize, packetSize );
+
+    bytesSent = ( size_t ) IotBleMqttTransportSend( &context,
+                                                    ( void * ) MQTTPacket,
+                                                    packetSize );
+    TEST_ASSERT_EQUAL_INT( packetSize, bytesSent );
+}
+
+/**
+ * @brief Sends a packet with raw framing but the channel fails
+ * @details Nothing is reported as sent unless the whole packet is sent
+ */
+void test_IotBleMqttTransportSend_CompactFramingChannelFails( void )
+{
+    size_t bytesSent = 0;
+    uint8_t MQTTPacket[] = { 0x40, 0x02, 0x00, 0x01 };
+    size_t packetSize = 4U;
+
+    IotBleDataTransfer_GetFraming_IgnoreAndReturn( IOT_BLE_DATA_TRANSFER_FRAMING_RAW );
+    IotBleDataTransfer_Send_ExpectAnyArgsAndReturn( 2U );
+
+    bytesSent = ( size_t ) IotBleMqttTransportSend( &context,
+                                                    ( void * ) MQTTPacket,
+                                                    packetSize );
+    TEST_ASSERT_EQUAL_INT( 0, bytesSent );
+}
+/* ----- End Compact Framing Send Test ----- */
+
+/* ----- Begin Compact Framing Accept Test ----- */
+
+/**
+ * @brief Accepts data on a channel the peer opened with raw framing
+ * @details The received bytes go to the stream buffer unchanged and are flushed from the channel
+ */
+void test_IotBleMqttTransportAccept_CompactFraming( void )
+{
+    MQTTBLEStatus_t status = MQTTBLESuccess;
+    uint8_t buf[] = { 0x90, 0x03, 0x00, 0x01, 0x00, 0xd0, 0x00 };
+
+    fixedBuffer.pBuffer = buf;
+    bufferSize = sizeof( buf );
+    IotBleDataTransfer_GetFraming_IgnoreAndReturn( IOT_BLE_DATA_TRANSFER_FRAMING_RAW );
+    IotBleDataTransfer_PeekReceiveBuffer_Stub( receiveCallback );
+    xStreamBufferSend_ExpectAnyArgsAndReturn( sizeof( buf ) );
+    IotBleDataTransfer_Receive_ExpectAndReturn( context.pChannel, NULL, sizeof( buf ), sizeof( buf ) );
+
+    status = IotBleMqttTransportAcceptData( &context );
+    bufferSize = 0;
+    TEST_ASSERT_EQUAL_INT( MQTTBLESuccess, status );
+}
+
+/**
+ * @brief Accepts data with raw framing when the stream buffer is full
+ * @details The data is still flushed from the channel, since a partial packet cannot be resumed
+ */
+void test_IotBleMqttTransportAccept_CompactFramingStreamBufferFull( void )
+{
+    MQTTBLEStatus_t status = MQTTBLESuccess;
+    uint8_t buf[] = { 0x90, 0x03, 0x00, 0x01, 0x00, 0xd0, 0x00 };
+
+    fixedBuffer.pBuffer = buf;
+    bufferSize = sizeof( buf );
+    IotBleDataTransfer_GetFraming_IgnoreAndReturn( IOT_BLE_DATA_TRANSFER_FRAMING_RAW );
+    IotBleDataTransfer_PeekReceiveBuffer_Stub( receiveCallback );
+    xStreamBufferSend_ExpectAnyArgsAndReturn( 3U );
+    IotBleDataTransfer_Receive_ExpectAndReturn( context.pChannel, NULL, sizeof( buf ), sizeof( buf ) );
+
+    status = IotBleMqttTransportAcceptData( &context );
+    bufferSize = 0;
+    TEST_ASSERT_EQUAL_INT( MQTTBLENoMemory, status );
+}
+/* ----- End Compact Framing Accept Test ----- */
+
+
 /*******************************************************************************
  * Other functions and tests
  ******************************************************************************/
@@ -882,6 +882,80 @@ void test_IotBleDataTransfer_Send_WithChannelDNE( void )
     TEST_ASSERT( n_sent == 0 );
 }
 
+/*******************************************************************************
+ * IotBleDataTransfer_AcquireSendBuffer / IotBleDataTransfer_SendAcquiredBuffer
+ ******************************************************************************/
+
+/**
+ * @brief Happy path. Build messages in the channel send buffer and send them
+ */
+void test_IotBleDataTransfer_SendAcquiredBuffer_HappyPath( void )
+{
+    size_t n_sent = 0;
+    uint8_t * pBuffer = NULL;
+    const uint8_t service_variant = IOT_BLE_DATA_TRANSFER_SERVICE_TYPE_MQTT;
+
+    init_transfers();
+    IotBleDataTransferChannel_t * pChannel = get_open_channel( service_variant );
+    IotBleDataTransfer_SetCallback( pChannel, channel_callback, NULL );
+
+    /* Fits in one indication. */
+    pBuffer = IotBleDataTransfer_AcquireSendBuffer( pChannel, get_max_data_len() );
+    TEST_ASSERT_NOT_NULL( pBuffer );
+    memset( pBuffer, 0xDC, get_max_data_len() - 1 );
+    IotBle_SendIndication_ExpectAnyArgsAndReturn( eBTStatusSuccess );
+    n_sent = IotBleDataTransfer_SendAcquiredBuffer( pChannel, get_max_data_len() - 1 );
+    TEST_ASSERT_MESSAGE( n_sent == get_max_data_len() - 1, "Did not send all expected bytes" );
+
+    /* The rest is read by the client straight out of the send buffer. */
+    pBuffer = IotBleDataTransfer_AcquireSendBuffer( pChannel, get_max_data_len() + 1 );
+    TEST_ASSERT_NOT_NULL( pBuffer );
+    memset( pBuffer, 0xDC, get_max_data_len() + 1 );
+    IotBle_SendIndication_ExpectAnyArgsAndReturn( eBTStatusSuccess );
+    n_sent = IotBleDataTransfer_SendAcquiredBuffer( pChannel, get_max_data_len() + 1 );
+    TEST_ASSERT_MESSAGE( n_sent == get_max_data_len() + 1, "Did not send all expected bytes" );
+
+    IotBle_SendResponse_ExpectAnyArgsAndReturn( eBTStatusSuccess );
+    generate_client_read_event( service_variant, IOT_BLE_DATA_TRANSFER_TX_LARGE_CHAR );
+}
+
+/**
+ * @brief Acquired message is built but the indication fails
+ */
+void test_IotBleDataTransfer_SendAcquiredBuffer_WithIndicationFail( void )
+{
+    size_t n_sent = 0;
+    uint8_t * pBuffer = NULL;
+    const uint8_t service_variant = IOT_BLE_DATA_TRANSFER_SERVICE_TYPE_MQTT;
+
+    init_transfers();
+    IotBleDataTransferChannel_t * pChannel = get_open_channel( service_variant );
+
+    pBuffer = IotBleDataTransfer_AcquireSendBuffer( pChannel, get_max_data_len() + 1 );
+    TEST_ASSERT_NOT_NULL( pBuffer );
+    IotBle_SendIndication_ExpectAnyArgsAndReturn( eBTStatusFail );
+    n_sent = IotBleDataTransfer_SendAcquiredBuffer( pChannel, get_max_data_len() + 1 );
+    TEST_ASSERT( n_sent == 0 );
+}
+
+/**
+ * @brief Attempt to acquire the send buffer when the channel doesn't exist or is busy
+ */
+void test_IotBleDataTransfer_AcquireSendBuffer_WithUnavailableChannel( void )
+{
+    const uint8_t service_variant = IOT_BLE_DATA_TRANSFER_SERVICE_TYPE_MQTT;
+
+    init_transfers();
+    IotBleDataTransferChannel_t * pChannel = get_open_channel( service_variant );
+
+    TEST_ASSERT_NULL( IotBleDataTransfer_AcquireSendBuffer( NULL, 1 ) );
+
+    IotSemaphore_TimedWait_Stub( NULL );
+    IotSemaphore_TimedWait_ExpectAnyArgsAndReturn( false );
+    TEST_ASSERT_NULL( IotBleDataTransfer_AcquireSendBuffer( pChannel, 1 ) );
+    IotSemaphore_TimedWait_Stub( IotSemaphore_TimedWait_Callback );
+}
+
 /*******************************************************************************
  * IotBleDataTransfer_Receive
  ******************************************************************************/
@@ -1498,6 +1572,51 @@ void test_ControlCharCallback_HappyRead()
     generate_client_read_event( service_variant, IOT_BLE_DATA_TRANSFER_CONTROL_CHAR );
 }
 
+static uint8_t control_read_value[ 2 ];
+static size_t control_read_size = 0;
+
+static BTStatus_t IotBle_SendResponse_ControlRead_Callback( IotBleEventResponse_t * pResp,
+                                                            uint16_t connId,
+                                                            uint32_t transId,
+                                                            int numCalls )
+{
+    control_read_size = pResp->pAttrData->size;
+    memcpy( control_read_value, pResp->pAttrData->pData, control_read_size );
+    return eBTStatusSuccess;
+}
+
+/**
+ * @brief Client opens the channel selecting a framing, which is then reported back on read
+ */
+void test_ControlCharCallback_SelectFraming()
+{
+    const uint8_t service_variant = IOT_BLE_DATA_TRANSFER_SERVICE_TYPE_MQTT;
+    uint8_t config[ 2 ] = { 1, IOT_BLE_DATA_TRANSFER_FRAMING_RAW };
+
+    init_transfers();
+
+    IotBleDataTransferChannel_t * pChannel = get_open_channel( service_variant );
+    TEST_ASSERT_EQUAL( IOT_BLE_DATA_TRANSFER_FRAMING_DEFAULT, IotBleDataTransfer_GetFraming( pChannel ) );
+
+    IotBle_SendResponse_Stub( IotBle_SendResponse_ControlRead_Callback );
+
+    generate_client_write_event( service_variant, IOT_BLE_DATA_TRANSFER_CONTROL_CHAR, config, sizeof( config ), false );
+    TEST_ASSERT_EQUAL( IOT_BLE_DATA_TRANSFER_FRAMING_RAW, IotBleDataTransfer_GetFraming( pChannel ) );
+    generate_client_read_event( service_variant, IOT_BLE_DATA_TRANSFER_CONTROL_CHAR );
+    TEST_ASSERT_EQUAL( 2, control_read_size );
+    TEST_ASSERT_EQUAL( 1, control_read_value[ 0 ] );
+    TEST_ASSERT_EQUAL( IOT_BLE_DATA_TRANSFER_FRAMING_RAW, control_read_value[ 1 ] );
+
+    /* An unknown framing falls back to the default, which older clients read as a single byte. */
+    config[ 1 ] = 0x7F;
+    generate_client_write_event( service_variant, IOT_BLE_DATA_TRANSFER_CONTROL_CHAR, config, sizeof( config ), false );
+    TEST_ASSERT_EQUAL( IOT_BLE_DATA_TRANSFER_FRAMING_DEFAULT, IotBleDataTransfer_GetFraming( pChannel ) );
+    generate_client_read_event( service_variant, IOT_BLE_DATA_TRANSFER_CONTROL_CHAR );
+    TEST_ASSERT_EQUAL( 1, control_read_size );
+
+    IotBle_SendResponse_Stub( NULL );
+}
+
 /**
  * @brief Write when channel isn't ready
  */
@@ -71,6 +71,8 @@
  * @function_brief{taskpool_function_scheduledeferred}
  * - @function_name{taskpool_function_getstatus}
  * @function_brief{taskpool_function_getstatus}
+ * - @function_name{taskpool_function_getstatistics}
+ * @function_brief{taskpool_function_getstatistics}
  * - @function_name{taskpool_function_trycancel}
  * @function_brief{taskpool_function_trycancel}
  * - @function_name{taskpool_function_getjobstoragefromhandle}
@@ -116,6 +118,9 @@
  * @function_page{IotTaskPool_GetStatus,taskpool,getstatus}
  * @function_snippet{taskpool,getstatus,this}
  * @copydoc IotTaskPool_GetStatus
+ * @function_page{IotTaskPool_GetStatistics,taskpool,getstatistics}
+ * @function_snippet{taskpool,getstatistics,this}
+ * @copydoc IotTaskPool_GetStatistics
  * @function_page{IotTaskPool_TryCancel,taskpool,trycancel}
  * @function_snippet{taskpool,trycancel,this}
  * @copydoc IotTaskPool_TryCancel
@@ -512,6 +517,25 @@ IotTaskPoolError_t IotTaskPool_GetStatus( IotTaskPool_t taskPool,
                                           IotTaskPoolJobStatus_t * const pStatus );
 /* @[declare_taskpool_getstatus] */
 
+/**
+ * @brief Take a snapshot of the load on a task pool, for instance to diagnose throughput.
+ *
+ * @param[in] taskPool A handle to the task pool that must have been previously initialized with
+ * a call to @ref IotTaskPool_Create.
+ * @param[out] pStatistics Receives the snapshot.
+ *
+ * @return One of the following:
+ * - #IOT_TASKPOOL_SUCCESS
+ * - #IOT_TASKPOOL_BAD_PARAMETER
+ * - #IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS
+ *
+ * @note The counters are taken under the task pool lock, but may change as soon as it is released.
+ */
+/* @[declare_taskpool_getstatistics] */
+IotTaskPoolError_t IotTaskPool_GetStatistics( IotTaskPool_t taskPool,
+                                              IotTaskPoolStatistics_t * const pStatistics );
+/* @[declare_taskpool_getstatistics] */
+
 /**
  * @brief This function tries to cancel a job that was previously scheduled with @ref IotTaskPool_Schedule.
  *
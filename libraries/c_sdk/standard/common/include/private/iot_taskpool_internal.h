@@ -121,6 +121,30 @@
     #define IotTaskPool_Assert( expression )
 #endif
 
+/**
+ * @brief Hooks called as a job moves through its lifecycle.
+ *
+ * They are empty by default. Define them in iot_config.h to trace jobs, for
+ * example with the Linux trace port in vendors/pc/boards/linux/ports/trace.
+ * The job passed to #IotTaskPool_TraceJobFinished may already have been freed
+ * or recycled by its callback, so only its address may be used.
+ */
+#ifndef IotTaskPool_TraceJobScheduled
+    #define IotTaskPool_TraceJobScheduled( pJob )
+#endif
+#ifndef IotTaskPool_TraceJobDeferred
+    #define IotTaskPool_TraceJobDeferred( pJob, timeMs )
+#endif
+#ifndef IotTaskPool_TraceJobStarted
+    #define IotTaskPool_TraceJobStarted( pJob )
+#endif
+#ifndef IotTaskPool_TraceJobFinished
+    #define IotTaskPool_TraceJobFinished( pJob )
+#endif
+#ifndef IotTaskPool_TraceJobCanceled
+    #define IotTaskPool_TraceJobCanceled( pJob )
+#endif
+
 /* Configure logs for TASKPOOL functions. */
 #ifdef IOT_LOG_LEVEL_TASKPOOL
     #define LIBRARY_LOG_LEVEL        IOT_LOG_LEVEL_TASKPOOL
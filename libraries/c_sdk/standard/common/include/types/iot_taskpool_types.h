@@ -291,6 +291,23 @@ typedef struct IotTaskPoolInfo
     int32_t priority;    /**< @brief priority for every task pool thread. The priority for each thread is fixed after the task pool is created and cannot be changed. */
 } IotTaskPoolInfo_t;
 
+/**
+ * @ingroup taskpool_datatypes_paramstructs
+ * @brief A snapshot of the load on a task pool.
+ *
+ * @paramfor @ref taskpool_function_getstatistics.
+ */
+typedef struct IotTaskPoolStatistics
+{
+    uint32_t queuedJobs;    /**< @brief Jobs scheduled and waiting for a worker thread. */
+    uint32_t deferredJobs;  /**< @brief Jobs waiting for their deferral time to expire. */
+    uint32_t activeJobs;    /**< @brief Jobs scheduled or executing. */
+    uint32_t activeThreads; /**< @brief Worker threads in the task pool. */
+    uint32_t minThreads;    /**< @brief Minimum number of worker threads. */
+    uint32_t maxThreads;    /**< @brief Maximum number of worker threads. */
+    uint32_t cachedJobs;    /**< @brief Jobs held in the cache for reuse. */
+} IotTaskPoolStatistics_t;
+
 /*------------------------- TASKPOOL defined constants --------------------------*/
 
 /**
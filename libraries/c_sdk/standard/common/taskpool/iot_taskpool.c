@@ -787,6 +787,7 @@ IotTaskPoolError_t IotTaskPool_ScheduleDeferred( IotTaskPool_t taskPoolHandle,
 
             /* Update the job status to 'scheduled'. */
             pJob->status = IOT_TASKPOOL_STATUS_DEFERRED;
+            IotTaskPool_TraceJobDeferred( pJob, timeMs );
 
             /* Peek the first event in the timer event list. There must be at least one,
              * since we just inserted it. */
@@ -851,6 +852,43 @@ IotTaskPoolError_t IotTaskPool_GetStatus( IotTaskPool_t taskPoolHandle,
 
 /*-----------------------------------------------------------*/
 
+IotTaskPoolError_t IotTaskPool_GetStatistics( IotTaskPool_t taskPoolHandle,
+                                              IotTaskPoolStatistics_t * const pStatistics )
+{
+    TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
+    _taskPool_t * pTaskPool = NULL;
+
+    /* Parameter checking. */
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( taskPoolHandle );
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( pStatistics );
+
+    pTaskPool = ( _taskPool_t * ) taskPoolHandle;
+
+    TASKPOOL_ENTER_CRITICAL();
+    {
+        /* Bail out early if this task pool is shutting down. */
+        if( _IsShutdownStarted( pTaskPool ) )
+        {
+            TASKPOOL_EXIT_CRITICAL();
+
+            TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS );
+        }
+
+        pStatistics->queuedJobs = ( uint32_t ) IotDeQueue_Count( &pTaskPool->dispatchQueue );
+        pStatistics->deferredJobs = ( uint32_t ) IotListDouble_Count( &pTaskPool->timerEventsList );
+        pStatistics->activeJobs = pTaskPool->activeJobs;
+        pStatistics->activeThreads = pTaskPool->activeThreads;
+        pStatistics->minThreads = pTaskPool->minThreads;
+        pStatistics->maxThreads = pTaskPool->maxThreads;
+        pStatistics->cachedJobs = pTaskPool->jobsCache.freeCount;
+    }
+    TASKPOOL_EXIT_CRITICAL();
+
+    TASKPOOL_NO_FUNCTION_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
 IotTaskPoolError_t IotTaskPool_TryCancel( IotTaskPool_t taskPoolHandle,
                                           IotTaskPoolJob_t pJob,
                                           IotTaskPoolJobStatus_t * const pStatus )
@@ -1236,8 +1274,12 @@ static void _taskPoolWorker( void * pUserContext )
                 IotTaskPool_Assert( IotLink_IsLinked( &pJob->link ) == false );
                 IotTaskPool_Assert( userCallback != NULL );
 
+                IotTaskPool_TraceJobStarted( pJob );
+
                 userCallback( pTaskPool, pJob, pJob->pUserContext );
 
+                IotTaskPool_TraceJobFinished( pJob );
+
                 /* This job is finished, clear its pointer. */
                 pJob = NULL;
                 userCallback = NULL;
@@ -1437,6 +1479,7 @@ static IotTaskPoolError_t _scheduleInternal( _taskPool_t * const pTaskPool,
 
     /* Update the job status to 'scheduled'. */
     pJob->status = IOT_TASKPOOL_STATUS_SCHEDULED;
+    IotTaskPool_TraceJobScheduled( pJob );
 
     /* Update the number of active jobs optimistically, so new requests can be served by creating new threads. */
     pTaskPool->activeJobs++;
@@ -1592,6 +1635,7 @@ static IotTaskPoolError_t _tryCancelInternal( _taskPool_t * const pTaskPool,
     {
         /* Update the status of the job. */
         pJob->status = IOT_TASKPOOL_STATUS_CANCELED;
+        IotTaskPool_TraceJobCanceled( pJob );
 
         /* If the job is cancelable and its current status is 'scheduled' then unlink it from the dispatch
          * queue and signal any waiting threads. */
@@ -124,6 +124,7 @@ TEST_GROUP_RUNNER( Common_Unit_Task_Pool )
     RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_ReSchedule );
     RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_ReScheduleDeferred );
     RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_CancelTasks );
+    RUN_TEST_CASE( Common_Unit_Task_Pool, Statistics );
 }
 
 /*-----------------------------------------------------------*/
@@ -1853,3 +1854,57 @@ TEST( Common_Unit_Task_Pool, ScheduleTasks_CancelTasks )
 }
 
 /*-----------------------------------------------------------*/
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test the counters reported by IotTaskPool_GetStatistics.
+ */
+TEST( Common_Unit_Task_Pool, Statistics )
+{
+    IotTaskPool_t taskPool = IOT_TASKPOOL_INITIALIZER;
+    const IotTaskPoolInfo_t tpInfo = { .minThreads = 2, .maxThreads = 3, .stackSize = IOT_THREAD_DEFAULT_STACK_SIZE, .priority = IOT_THREAD_DEFAULT_PRIORITY };
+    IotTaskPoolStatistics_t statistics;
+    IotTaskPoolJobStorage_t jobStorage;
+    IotTaskPoolJob_t job;
+    IotTaskPoolJobStatus_t status;
+    JobUserContext_t userContext;
+
+    memset( &userContext, 0, sizeof( JobUserContext_t ) );
+
+    /* Initialize user context. */
+    TEST_ASSERT( IotMutex_Create( &userContext.lock, false ) );
+
+    TEST_ASSERT( IotTaskPool_Create( &tpInfo, &taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    if( TEST_PROTECT() )
+    {
+        TEST_ASSERT( IotTaskPool_GetStatistics( NULL, &statistics ) == IOT_TASKPOOL_BAD_PARAMETER );
+        TEST_ASSERT( IotTaskPool_GetStatistics( taskPool, NULL ) == IOT_TASKPOOL_BAD_PARAMETER );
+
+        TEST_ASSERT( IotTaskPool_GetStatistics( taskPool, &statistics ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT_EQUAL_UINT32( 0, statistics.queuedJobs );
+        TEST_ASSERT_EQUAL_UINT32( 0, statistics.deferredJobs );
+        TEST_ASSERT_EQUAL_UINT32( 0, statistics.activeJobs );
+        TEST_ASSERT_EQUAL_UINT32( tpInfo.minThreads, statistics.minThreads );
+        TEST_ASSERT_EQUAL_UINT32( tpInfo.maxThreads, statistics.maxThreads );
+        TEST_ASSERT( statistics.activeThreads >= tpInfo.minThreads );
+
+        /* A job deferred well into the future is counted until it is canceled. */
+        TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionWithoutDestroyCb, &userContext, &jobStorage, &job ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_ScheduleDeferred( taskPool, job, 60000 ) == IOT_TASKPOOL_SUCCESS );
+
+        TEST_ASSERT( IotTaskPool_GetStatistics( taskPool, &statistics ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT_EQUAL_UINT32( 1, statistics.deferredJobs );
+
+        TEST_ASSERT( IotTaskPool_TryCancel( taskPool, job, &status ) == IOT_TASKPOOL_SUCCESS );
+
+        TEST_ASSERT( IotTaskPool_GetStatistics( taskPool, &statistics ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT_EQUAL_UINT32( 0, statistics.deferredJobs );
+        TEST_ASSERT_EQUAL_UINT32( 0, userContext.counter );
+    }
+
+    TEST_ASSERT( IotTaskPool_Destroy( taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    IotMutex_Destroy( &userContext.lock );
+}
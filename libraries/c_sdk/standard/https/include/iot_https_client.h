@@ -70,6 +70,8 @@
  * @function_brief{https_client_function_readheader}
  * - @function_name{https_client_function_readresponsebody}
  * @function_brief{https_client_function_readresponsebody}
+ * - @function_name{https_client_function_getnetworkstatistics}
+ * @function_brief{https_client_function_getnetworkstatistics}
  */
 
 /**
@@ -118,6 +120,9 @@
  * @page https_client_function_readresponsebody IotHttpsClient_ReadResponseBody
  * @snippet this declare_https_client_readresponsebody
  * @copydoc IotHttpsClient_ReadResponseBody
+ * @page https_client_function_getnetworkstatistics IotHttpsClient_GetNetworkStatistics
+ * @snippet this declare_https_client_getnetworkstatistics
+ * @copydoc IotHttpsClient_GetNetworkStatistics
  */
 
 
@@ -895,4 +900,28 @@ IotHttpsReturnCode_t IotHttpsClient_ReadResponseBody( IotHttpsResponseHandle_t r
                                                       uint32_t * pLen );
 /* @[declare_https_client_readresponsebody] */
 
+/**
+ * @brief Read the I/O statistics of the network connection under an HTTPS connection.
+ *
+ * The statistics come from #IotNetworkInterface_t::getStatistics of the network interface in
+ * #IotHttpsConnectionInfo_t.pNetworkInterface. Comparing them with the bytes of the requests and responses shows
+ * whether lost throughput is spent in the network, in TLS or in HTTP.
+ *
+ * This function may be called on a connection closed by the server, but not after
+ * @ref https_client_function_disconnect has released the network connection.
+ *
+ * @param[in] connHandle - Valid handle representing a connection.
+ * @param[out] pStatistics - Receives the statistics.
+ *
+ * @return One of the following:
+ * - #IOT_HTTPS_OK if the statistics were read.
+ * - #IOT_HTTPS_INVALID_PARAMETER if NULL parameters were passed in.
+ * - #IOT_HTTPS_NOT_SUPPORTED if the network interface does not keep statistics.
+ * - #IOT_HTTPS_NETWORK_ERROR if the network connection was released or the network interface failed to read them.
+ */
+/* @[declare_https_client_getnetworkstatistics] */
+IotHttpsReturnCode_t IotHttpsClient_GetNetworkStatistics( IotHttpsConnectionHandle_t connHandle,
+                                                          IotNetworkStatistics_t * pStatistics );
+/* @[declare_https_client_getnetworkstatistics] */
+
 #endif /* IOT_HTTPS_CLIENT_ */
@@ -3395,6 +3395,44 @@ IotHttpsReturnCode_t IotHttpsClient_ReadContentLength( IotHttpsResponseHandle_t
 
 /*-----------------------------------------------------------*/
 
+IotHttpsReturnCode_t IotHttpsClient_GetNetworkStatistics( IotHttpsConnectionHandle_t connHandle,
+                                                          IotNetworkStatistics_t * pStatistics )
+{
+    HTTPS_FUNCTION_ENTRY( IOT_HTTPS_OK );
+
+    HTTPS_ON_NULL_ARG_GOTO_CLEANUP( connHandle );
+    HTTPS_ON_NULL_ARG_GOTO_CLEANUP( pStatistics );
+
+    /* Statistics are optional for network interfaces. */
+    if( connHandle->pNetworkInterface->getStatistics == NULL )
+    {
+        IotLogError( "The network interface does not keep statistics." );
+        HTTPS_SET_AND_GOTO_CLEANUP( IOT_HTTPS_NOT_SUPPORTED );
+    }
+
+    /* Hold the connection mutex so that IotHttpsClient_Disconnect() cannot
+     * destroy the network connection while it is read. */
+    IotMutex_Lock( &( connHandle->connectionMutex ) );
+
+    if( connHandle->isDestroyed == true )
+    {
+        IotLogError( "The network connection has been released." );
+        status = IOT_HTTPS_NETWORK_ERROR;
+    }
+    else if( connHandle->pNetworkInterface->getStatistics( connHandle->pNetworkConnection,
+                                                           pStatistics ) != IOT_NETWORK_SUCCESS )
+    {
+        IotLogError( "Failed to read the network statistics." );
+        status = IOT_HTTPS_NETWORK_ERROR;
+    }
+
+    IotMutex_Unlock( &( connHandle->connectionMutex ) );
+
+    HTTPS_FUNCTION_EXIT_NO_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
 /* Provide access to internal functions and variables if testing. */
 #if IOT_BUILD_TESTS == 1
     #include "iot_test_access_https_client.c"
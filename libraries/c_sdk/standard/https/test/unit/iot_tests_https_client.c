@@ -281,6 +281,33 @@ static size_t _httpParserExecuteFail( http_parser * parser,
     return 0;
 }
 
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Network Abstraction getStatistics function that succeeds.
+ */
+static IotNetworkError_t _networkGetStatisticsSuccess( void * pConnection,
+                                                       IotNetworkStatistics_t * pStatistics )
+{
+    ( void ) pConnection;
+    ( void ) memset( pStatistics, 0x00, sizeof( IotNetworkStatistics_t ) );
+    pStatistics->bytesReceived = HTTPS_TEST_RESP_BODY_BUFFER_SIZE;
+    return IOT_NETWORK_SUCCESS;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Network Abstraction getStatistics function that fails.
+ */
+static IotNetworkError_t _networkGetStatisticsFail( void * pConnection,
+                                                    IotNetworkStatistics_t * pStatistics )
+{
+    ( void ) pConnection;
+    ( void ) pStatistics;
+    return IOT_NETWORK_FAILURE;
+}
+
 
 /*-----------------------------------------------------------*/
 
@@ -350,6 +377,7 @@ TEST_GROUP_RUNNER( HTTPS_Client_Unit_API )
     RUN_TEST_CASE( HTTPS_Client_Unit_API, ReadResponseBodyNetworkReceiveFailure );
     RUN_TEST_CASE( HTTPS_Client_Unit_API, ReadResponseBodyParsingFailure );
     RUN_TEST_CASE( HTTPS_Client_Unit_API, ReadResponseBodySuccess );
+    RUN_TEST_CASE( HTTPS_Client_Unit_API, GetNetworkStatistics );
 }
 
 /*-----------------------------------------------------------*/
@@ -1405,3 +1433,50 @@ TEST( HTTPS_Client_Unit_API, ReadResponseBodySuccess )
     returnCode = IotHttpsClient_ReadResponseBody( respHandle, _pRespBodyBuffer, &bodyLength );
     TEST_ASSERT_EQUAL( IOT_HTTPS_OK, returnCode );
 }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test IotHttpsClient_GetNetworkStatistics() with network interfaces that do and do not keep statistics.
+ */
+TEST( HTTPS_Client_Unit_API, GetNetworkStatistics )
+{
+    IotHttpsReturnCode_t returnCode;
+    IotHttpsConnectionHandle_t connHandle = IOT_HTTPS_CONNECTION_HANDLE_INITIALIZER;
+    IotNetworkStatistics_t statistics = { 0 };
+
+    connHandle = _getConnHandle();
+    TEST_ASSERT_NOT_NULL( connHandle );
+
+    /* NULL parameters. */
+    returnCode = IotHttpsClient_GetNetworkStatistics( NULL, &statistics );
+    TEST_ASSERT_EQUAL( IOT_HTTPS_INVALID_PARAMETER, returnCode );
+    returnCode = IotHttpsClient_GetNetworkStatistics( connHandle, NULL );
+    TEST_ASSERT_EQUAL( IOT_HTTPS_INVALID_PARAMETER, returnCode );
+
+    /* A network interface without statistics. */
+    _networkInterface.getStatistics = NULL;
+    returnCode = IotHttpsClient_GetNetworkStatistics( connHandle, &statistics );
+    TEST_ASSERT_EQUAL( IOT_HTTPS_NOT_SUPPORTED, returnCode );
+
+    /* A network interface that fails to read them. */
+    _networkInterface.getStatistics = _networkGetStatisticsFail;
+    returnCode = IotHttpsClient_GetNetworkStatistics( connHandle, &statistics );
+    TEST_ASSERT_EQUAL( IOT_HTTPS_NETWORK_ERROR, returnCode );
+
+    /* A network interface that reads them. */
+    _networkInterface.getStatistics = _networkGetStatisticsSuccess;
+    returnCode = IotHttpsClient_GetNetworkStatistics( connHandle, &statistics );
+    TEST_ASSERT_EQUAL( IOT_HTTPS_OK, returnCode );
+    TEST_ASSERT_EQUAL( HTTPS_TEST_RESP_BODY_BUFFER_SIZE, statistics.bytesReceived );
+
+    /* The network connection is released by the disconnect. */
+    _networkInterface.close = _networkCloseSuccess;
+    _networkInterface.destroy = _networkDestroySuccess;
+    returnCode = IotHttpsClient_Disconnect( connHandle );
+    TEST_ASSERT_EQUAL( IOT_HTTPS_OK, returnCode );
+    returnCode = IotHttpsClient_GetNetworkStatistics( connHandle, &statistics );
+    TEST_ASSERT_EQUAL( IOT_HTTPS_NETWORK_ERROR, returnCode );
+
+    _networkInterface.getStatistics = NULL;
+}
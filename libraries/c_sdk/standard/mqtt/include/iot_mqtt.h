@@ -72,6 +72,10 @@
  * @function_brief{mqtt_function_operationtype}
  * - @function_name{mqtt_function_issubscribed}
  * @function_brief{mqtt_function_issubscribed}
+ * - @function_name{mqtt_function_getstatistics}
+ * @function_brief{mqtt_function_getstatistics}
+ * - @function_name{mqtt_function_getnetworkstatistics}
+ * @function_brief{mqtt_function_getnetworkstatistics}
  */
 
 /**
@@ -120,6 +124,12 @@
  * @page mqtt_function_issubscribed IotMqtt_IsSubscribed
  * @snippet this declare_mqtt_issubscribed
  * @copydoc IotMqtt_IsSubscribed
+ * @page mqtt_function_getstatistics IotMqtt_GetStatistics
+ * @snippet this declare_mqtt_getstatistics
+ * @copydoc IotMqtt_GetStatistics
+ * @page mqtt_function_getnetworkstatistics IotMqtt_GetNetworkStatistics
+ * @snippet this declare_mqtt_getnetworkstatistics
+ * @copydoc IotMqtt_GetNetworkStatistics
  */
 
 /**
@@ -866,4 +876,42 @@ bool IotMqtt_IsSubscribed( IotMqttConnection_t mqttConnection,
                            IotMqttSubscription_t * pCurrentSubscription );
 /* @[declare_mqtt_issubscribed] */
 
+/**
+ * @brief Read the counters shared by all MQTT connections.
+ *
+ * The counters are updated atomically, so this function may be called from any
+ * task at any time, for instance from a diagnostics console.
+ *
+ * @param[out] pStatistics Receives the counters.
+ */
+/* @[declare_mqtt_getstatistics] */
+void IotMqtt_GetStatistics( IotMqttStatistics_t * pStatistics );
+/* @[declare_mqtt_getstatistics] */
+
+/**
+ * @brief Read the I/O statistics of an MQTT connection's network connection.
+ *
+ * The statistics come from #IotNetworkInterface_t::getStatistics of the
+ * network interface passed to @ref mqtt_function_connect. They cover all
+ * traffic on the network connection, so comparing them with the MQTT
+ * packets sent and received shows whether lost throughput is spent in the
+ * network, in TLS or in MQTT.
+ *
+ * This function may be called at any time before @ref mqtt_function_disconnect,
+ * including after the network connection was lost.
+ *
+ * @param[in] mqttConnection The MQTT connection to read.
+ * @param[out] pStatistics Receives the statistics.
+ *
+ * @return One of the following:
+ * - #IOT_MQTT_SUCCESS
+ * - #IOT_MQTT_BAD_PARAMETER if a parameter is `NULL` or the network interface
+ * does not keep statistics.
+ * - #IOT_MQTT_NETWORK_ERROR if the network interface failed to read them.
+ */
+/* @[declare_mqtt_getnetworkstatistics] */
+IotMqttError_t IotMqtt_GetNetworkStatistics( IotMqttConnection_t mqttConnection,
+                                             IotNetworkStatistics_t * pStatistics );
+/* @[declare_mqtt_getnetworkstatistics] */
+
 #endif /* ifndef IOT_MQTT_H_ */
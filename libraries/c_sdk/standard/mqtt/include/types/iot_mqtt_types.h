@@ -151,6 +151,7 @@ typedef enum IotMqttError
      * - @ref mqtt_function_unsubscribe and @ref mqtt_function_timedunsubscribe
      * - @ref mqtt_function_publish and @ref mqtt_function_timedpublish
      * - @ref mqtt_function_wait
+     * - @ref mqtt_function_getnetworkstatistics
      */
     IOT_MQTT_BAD_PARAMETER,
 
@@ -176,6 +177,7 @@ typedef enum IotMqttError
      * - @ref mqtt_function_timedsubscribe
      * - @ref mqtt_function_timedunsubscribe
      * - @ref mqtt_function_timedpublish
+     * - @ref mqtt_function_getnetworkstatistics
      *
      * May also be the value of an operation completion callback's
      * #IotMqttCallbackParam_t.result.
@@ -997,6 +999,20 @@ typedef struct IotMqttNetworkInfo
     #endif
 } IotMqttNetworkInfo_t;
 
+/**
+ * @ingroup mqtt_datatypes_paramstructs
+ * @brief Counters shared by all MQTT connections.
+ *
+ * @paramfor @ref mqtt_function_getstatistics
+ */
+typedef struct IotMqttStatistics
+{
+    uint32_t operationsInFlight;      /**< @brief Outgoing operations created and not yet destroyed. */
+    uint32_t operationsCreated;       /**< @brief Outgoing operations created since the library was initialized. */
+    uint32_t publishRetransmissions;  /**< @brief QoS 1 PUBLISH packets sent again because no PUBACK arrived in time. */
+    uint32_t publishRetryLimitReached; /**< @brief QoS 1 PUBLISH operations that failed after their last retry. */
+} IotMqttStatistics_t;
+
 /*------------------------- MQTT defined constants --------------------------*/
 
 /**
@@ -2085,6 +2085,55 @@ const char * IotMqtt_OperationType( IotMqttOperationType_t operation )
 
 /*-----------------------------------------------------------*/
 
+IotMqttError_t IotMqtt_GetNetworkStatistics( IotMqttConnection_t mqttConnection,
+                                             IotNetworkStatistics_t * pStatistics )
+{
+    IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_SUCCESS );
+
+    if( ( mqttConnection == NULL ) || ( pStatistics == NULL ) )
+    {
+        IotLogError( "MQTT connection and statistics must not be NULL." );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Statistics are optional for network interfaces. */
+    if( mqttConnection->pNetworkInterface->getStatistics == NULL )
+    {
+        IotLogError( "(MQTT connection %p) Network interface does not keep statistics.",
+                     mqttConnection );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* The network connection is only destroyed with the MQTT connection, so
+     * it can be read after it was closed. */
+    if( mqttConnection->pNetworkInterface->getStatistics( mqttConnection->pNetworkConnection,
+                                                          pStatistics ) != IOT_NETWORK_SUCCESS )
+    {
+        IotLogError( "(MQTT connection %p) Failed to read network statistics.",
+                     mqttConnection );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_NETWORK_ERROR );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    IOT_FUNCTION_EXIT_NO_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
 /* Provide access to internal functions and variables if testing. */
 #if IOT_BUILD_TESTS == 1
     #include "iot_test_access_mqtt_api.c"
@@ -44,11 +44,24 @@
 #include "platform/iot_clock.h"
 #include "platform/iot_threads.h"
 
+/* Atomic operations. */
+#include "iot_atomic.h"
+
 /* Using initialized connToContext variable. */
 extern _connContext_t connToContext[ MAX_NO_OF_MQTT_CONNECTIONS ];
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Counters reported by @ref mqtt_function_getstatistics.
+ */
+static uint32_t _operationsInFlight = 0;
+static uint32_t _operationsCreated = 0;
+static uint32_t _publishRetransmissions = 0;
+static uint32_t _publishRetryLimitReached = 0;
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief First parameter to #_mqttOperation_match.
  */
@@ -176,6 +189,8 @@ static bool _checkRetryLimit( _mqttOperation_t * pOperation )
                      pOperation,
                      pOperation->u.operation.retry.limit );
 
+        ( void ) Atomic_Increment_u32( &_publishRetryLimitReached );
+
         status = false;
     }
     /* Check if this is the first retry. */
@@ -202,6 +217,16 @@ static bool _checkRetryLimit( _mqttOperation_t * pOperation )
         }
     }
 
+    /* Every send after the first is a retransmission. */
+    if( ( status == true ) && ( pOperation->u.operation.retry.count > 0U ) )
+    {
+        ( void ) Atomic_Increment_u32( &_publishRetransmissions );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
     return status;
 }
 
@@ -432,6 +457,9 @@ IotMqttError_t _IotMqtt_CreateOperation( _mqttConnection_t * pMqttConnection,
     /* Set the output parameter. */
     *pNewOperation = pOperation;
 
+    ( void ) Atomic_Increment_u32( &_operationsInFlight );
+    ( void ) Atomic_Increment_u32( &_operationsCreated );
+
     /* Clean up operation and decrement reference count if this function failed. */
     IOT_FUNCTION_CLEANUP_BEGIN();
 
@@ -556,6 +584,8 @@ void _IotMqtt_DestroyOperation( _mqttOperation_t * pOperation )
     /* Default free packet function. */
     void ( * freePacket )( uint8_t * ) = _IotMqtt_FreePacket;
 
+    ( void ) Atomic_Decrement_u32( &_operationsInFlight );
+
     IotLogDebug( "(MQTT connection %p, %s operation %p) Destroying operation.",
                  pMqttConnection,
                  IotMqtt_OperationType( pOperation->u.operation.type ),
@@ -1541,3 +1571,13 @@ void _IotMqtt_FreePacket( uint8_t * pPacket )
 }
 
 /*-----------------------------------------------------------*/
+
+/*-----------------------------------------------------------*/
+
+void IotMqtt_GetStatistics( IotMqttStatistics_t * pStatistics )
+{
+    pStatistics->operationsInFlight = Atomic_Add_u32( &_operationsInFlight, 0 );
+    pStatistics->operationsCreated = Atomic_Add_u32( &_operationsCreated, 0 );
+    pStatistics->publishRetransmissions = Atomic_Add_u32( &_publishRetransmissions, 0 );
+    pStatistics->publishRetryLimitReached = Atomic_Add_u32( &_publishRetryLimitReached, 0 );
+}
@@ -513,6 +513,22 @@ static IotNetworkError_t _close( void * pCloseContext )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief A network statistics function that reports the connection it was
+ * given in the sent byte count.
+ */
+static IotNetworkError_t _getStatistics( void * pConnection,
+                                         IotNetworkStatistics_t * pStatistics )
+{
+    ( void ) memset( pStatistics, 0x00, sizeof( IotNetworkStatistics_t ) );
+    pStatistics->bytesSent = ( uint64_t ) ( uintptr_t ) pConnection;
+    pStatistics->sendCalls = 1;
+
+    return IOT_NETWORK_SUCCESS;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief An MQTT disconnect callback that counts how many times it was invoked.
  */
@@ -854,6 +870,7 @@ TEST_GROUP_RUNNER( MQTT_Unit_API )
     RUN_TEST_CASE( MQTT_Unit_API, KeepAlivePeriodic );
     RUN_TEST_CASE( MQTT_Unit_API, KeepAliveJobCleanup );
     RUN_TEST_CASE( MQTT_Unit_API, WaitAfterDisconnect );
+    RUN_TEST_CASE( MQTT_Unit_API, GetNetworkStatistics );
 }
 
 /*-----------------------------------------------------------*/
@@ -1416,6 +1433,7 @@ TEST( MQTT_Unit_API, PublishDuplicates )
     IotMqttOperation_t publishOperation = IOT_MQTT_OPERATION_INITIALIZER;
     bool dupCheckResult = false;
     uint64_t startTime = 0;
+    IotMqttStatistics_t statisticsBefore, statisticsAfter;
 
     /* Initializer parameters. */
     serializer.serialize.publishSetDup = _publishSetDup;
@@ -1443,6 +1461,7 @@ TEST( MQTT_Unit_API, PublishDuplicates )
     publishInfo.retryLimit = DUP_CHECK_RETRY_LIMIT;
 
     startTime = IotClock_GetTimeMs();
+    IotMqtt_GetStatistics( &statisticsBefore );
 
     if( TEST_PROTECT() )
     {
@@ -1464,6 +1483,14 @@ TEST( MQTT_Unit_API, PublishDuplicates )
 
         /* Check that at least the minimum wait time elapsed. */
         TEST_ASSERT_TRUE( startTime + DUP_CHECK_MINIMUM_WAIT <= IotClock_GetTimeMs() );
+
+        /* Every retry was counted, as was giving up after the last one. */
+        IotMqtt_GetStatistics( &statisticsAfter );
+        TEST_ASSERT_EQUAL_UINT32( statisticsBefore.operationsCreated + 1, statisticsAfter.operationsCreated );
+        TEST_ASSERT_EQUAL_UINT32( statisticsBefore.publishRetransmissions + DUP_CHECK_RETRY_LIMIT,
+                                  statisticsAfter.publishRetransmissions );
+        TEST_ASSERT_EQUAL_UINT32( statisticsBefore.publishRetryLimitReached + 1,
+                                  statisticsAfter.publishRetryLimitReached );
     }
 
     /* Clean up MQTT connection. */
@@ -1828,3 +1855,41 @@ TEST( MQTT_Unit_API, WaitAfterDisconnect )
 }
 
 /*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that @ref mqtt_function_getnetworkstatistics reads the statistics
+ * of the connection's network connection.
+ */
+TEST( MQTT_Unit_API, GetNetworkStatistics )
+{
+    IotNetworkStatistics_t statistics = { 0 };
+
+    /* Create a new MQTT connection. */
+    _pMqttConnection = IotTestMqtt_createMqttConnection( AWS_IOT_MQTT_SERVER,
+                                                         &_networkInfo,
+                                                         0 );
+    TEST_ASSERT_NOT_NULL( _pMqttConnection );
+
+    /* Set the MQTT Context for the new MQTT Connection*/
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, _setContext( _pMqttConnection, transportSend ) );
+
+    if( TEST_PROTECT() )
+    {
+        /* NULL parameters. */
+        TEST_ASSERT_EQUAL( IOT_MQTT_BAD_PARAMETER, IotMqtt_GetNetworkStatistics( NULL, &statistics ) );
+        TEST_ASSERT_EQUAL( IOT_MQTT_BAD_PARAMETER, IotMqtt_GetNetworkStatistics( _pMqttConnection, NULL ) );
+
+        /* Network interface without statistics. */
+        TEST_ASSERT_EQUAL( IOT_MQTT_BAD_PARAMETER, IotMqtt_GetNetworkStatistics( _pMqttConnection, &statistics ) );
+
+        /* Network interface with statistics. */
+        _networkInterface.getStatistics = _getStatistics;
+        TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, IotMqtt_GetNetworkStatistics( _pMqttConnection, &statistics ) );
+        TEST_ASSERT_EQUAL_UINT64( ( uint64_t ) ( uintptr_t ) _pMqttConnection->pNetworkConnection, statistics.bytesSent );
+        TEST_ASSERT_EQUAL_UINT32( 1, statistics.sendCalls );
+    }
+
+    IotMqtt_Disconnect( _pMqttConnection, IOT_MQTT_FLAG_CLEANUP_ONLY );
+}
+
+/*-----------------------------------------------------------*/
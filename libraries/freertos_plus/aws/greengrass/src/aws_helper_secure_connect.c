@@ -42,6 +42,11 @@
 #include "aws_ggd_config.h"
 #include "aws_ggd_config_defaults.h"
 
+/* Secure sockets DNS cache include. */
+#if ( socketsconfigUSE_DNS_CACHE == 1 )
+    #include "iot_secure_sockets_dns.h"
+#endif
+
 /* Standard includes. */
 #include <string.h>
 
@@ -104,8 +109,14 @@ BaseType_t GGD_SecureConnect_Connect( const GGD_HostAddressData_t * pxHostAddres
 
             xServerAddress.ucLength = sizeof( SocketsSockaddr_t );
             xServerAddress.usPort = SOCKETS_htons( pxHostAddressData->usPort );
-            xServerAddress.ulAddress =
-                SOCKETS_GetHostByName( pxHostAddressData->pcHostAddress );
+
+            #if ( socketsconfigUSE_DNS_CACHE == 1 )
+                xServerAddress.ulAddress =
+                    SOCKETS_DnsResolve( pxHostAddressData->pcHostAddress );
+            #else
+                xServerAddress.ulAddress =
+                    SOCKETS_GetHostByName( pxHostAddressData->pcHostAddress );
+            #endif
 
             if( xServerAddress.ulAddress == 0u )
             {
@@ -182,6 +193,9 @@ BaseType_t GGD_SecureConnect_Connect( const GGD_HostAddressData_t * pxHostAddres
                 {
                     ggdconfigPRINT( "ERROR! SOCKETS_Connect call failed: ServerAddress=%lu, Port=%u, ReturnCode=%d\r\n",
                                     xServerAddress.ulAddress, xServerAddress.usPort, returnCode );
+                    #if ( socketsconfigUSE_DNS_CACHE == 1 )
+                        SOCKETS_DnsFlush( pxHostAddressData->pcHostAddress );
+                    #endif
                     GGD_SecureConnect_Disconnect( pxSocket );
                     xStatus = pdFAIL;
                 }
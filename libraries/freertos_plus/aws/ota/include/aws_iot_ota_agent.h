@@ -40,6 +40,9 @@
 #include "FreeRTOS.h"
 #include "timers.h"
 
+/* Network statistics types. */
+#include "platform/iot_network.h"
+
 /* Evaluates to the length of a constant string defined like 'static const char str[]= "xyz"; */
 #define CONST_STRLEN( s )    ( ( ( uint32_t ) sizeof( s ) ) - 1UL )
 
@@ -164,6 +167,8 @@ typedef enum
     eOTA_JobParseErr_BadModelInitParams,  /* There was an invalid initialization parameter used in the document model. */
     eOTA_JobParseErr_NoContextAvailable,  /* There wasn't an OTA context available. */
     eOTA_JobParseErr_NoActiveJobs,        /* No active jobs are available in the service. */
+    eOTA_JobParseErr_DeltaNotSupported,   /* The job is a delta update but the platform can't read its base image. */
+    eOTA_JobParseErr_CompressionNotSupported, /* The job's file is compressed with an unknown scheme. */
 } OTA_JobParseErr_t;
 
 
@@ -361,6 +366,59 @@ typedef int16_t (* pxOTAPALWriteBlockCallback_t)( OTA_FileContext_t * const C,
                                                   uint8_t * const pacData,
                                                   uint32_t iBlockSize );
 
+/**
+ * @ingroup ota_datatypes_functionpointers
+ * @brief OTA save download checkpoint callback function typedef.
+ *
+ * Optional. The user may register this callback to make interrupted downloads resumable.
+ * It is called every otaconfigCHECKPOINT_INTERVAL_BLOCKS received blocks and must persist
+ * the job name, server file ID, file size and the receive block bitmap of the file context.
+ * The PAL must make the file data written so far durable before it stores the bitmap so a
+ * restored bitmap never claims a block that was lost. The PAL discards the checkpoint when
+ * the file is closed or a new file is created. It is kept across an abort, since the agent
+ * also aborts open files when it shuts down.
+ *
+ * @param[in] C File context of the file being received.
+ * @param[in] ulBitmapLen Length of C->pucRxBlockBitmap in bytes.
+ */
+typedef OTA_Err_t (* pxOTAPALSaveCheckpointCallback_t)( OTA_FileContext_t * const C,
+                                                        uint32_t ulBitmapLen );
+
+/**
+ * @ingroup ota_datatypes_functionpointers
+ * @brief OTA resume file to store received data callback function typedef.
+ *
+ * Optional. Called instead of the create file callback when a job is started. If the PAL
+ * holds a checkpoint for the same job name, server file ID and file size, it reopens the
+ * file without erasing it, copies the saved bitmap into C->pucRxBlockBitmap and returns
+ * kOTA_Err_None. Otherwise it must leave the bitmap untouched and return an error, after
+ * which the agent creates a new file as usual.
+ *
+ * @param[in] C File context of the job being started.
+ * @param[in] ulBitmapLen Length of C->pucRxBlockBitmap in bytes.
+ */
+typedef OTA_Err_t (* pxOTAPALResumeFileForRxCallback_t)( OTA_FileContext_t * const C,
+                                                         uint32_t ulBitmapLen );
+
+/**
+ * @ingroup ota_datatypes_functionpointers
+ * @brief OTA read base image callback function typedef.
+ *
+ * Optional. The user may register this callback to accept delta (patch) updates. It
+ * reads the currently running image, which a delta job's patch is applied against.
+ * It is only called when otaconfigENABLE_DELTA_UPDATES is set to 1.
+ *
+ * @param[in] ulOffset Offset into the running image to read from.
+ * @param[out] pucBuffer Buffer to read into.
+ * @param[in] ulLength Number of bytes to read.
+ *
+ * @return The number of bytes read, which is less than ulLength only at the end of
+ * the image, or a negative value on error.
+ */
+typedef int32_t (* pxOTAPALReadBaseImageCallback_t)( uint32_t ulOffset,
+                                                     uint8_t * pucBuffer,
+                                                     uint32_t ulLength );
+
 /**
  * @ingroup ota_datatypes_functionpointers
  * @brief Custom Job callback function typedef.
@@ -424,6 +482,11 @@ typedef struct OTA_FileContext
     uint32_t ulUpdaterVersion;  /*!< Used by OTA self-test detection, the version of FW that did the update. */
     bool bIsInSelfTest;         /*!< True if the job is in self test mode. */
     uint8_t * pucProtocols;     /*!< Authorization scheme. */
+    uint32_t ulDeltaImageSize;  /*!< Size of the image rebuilt from a delta patch, or 0 if the file is a full image.
+                                 * For a delta the streamed file (ulFileSize) is the patch. */
+    uint8_t * pucDeltaBase;     /*!< Hex SHA-256 of the running image a delta patch applies to. */
+    uint8_t * pucCompression;   /*!< Compression scheme of the streamed file, or NULL if it is sent as is. */
+    uint32_t ulUncompressedSize; /*!< Size of the streamed file once decompressed. */
 } OTA_FileContext_t;
 
 /**
@@ -455,6 +518,10 @@ typedef struct
     pxOTAPALWriteBlockCallback_t xWriteBlock;                       /* OTA Write Block callback pointer */
     pxOTACompleteCallback_t xCompleteCallback;                      /* OTA Job Completed callback pointer */
     pxOTACustomJobCallback_t xCustomJobCallback;                    /* OTA Custom Job callback pointer */
+    pxOTAPALSaveCheckpointCallback_t xSaveCheckpoint;               /* OTA Save Checkpoint callback pointer (optional, may be NULL) */
+    pxOTAPALResumeFileForRxCallback_t xResumeFileForRx;             /* OTA Resume File for Receive callback pointer (optional, may be NULL) */
+    pxOTAPALReadBaseImageCallback_t xReadBaseImage;                 /* OTA Read Base Image callback pointer (optional, may be NULL) */
+    bool bAcceptCompressedFiles;                                    /* The PAL sizes a compressed file by its uncompressed size (optional, may be false) */
 } OTA_PAL_Callbacks_t;
 
 
@@ -517,6 +584,11 @@ typedef struct
 #define kOTA_Err_EventQueueSendFailed    0x2c000000UL     /*!< Posting event message to the event queue failed. */
 #define kOTA_Err_InvalidDataProtocol     0x2d000000UL     /*!< Job does not have a valid protocol for data transfer. */
 #define kOTA_Err_OTAAgentStopped         0x2e000000UL     /*!< Returned when operations are performed that requires OTA Agent running & its stopped. */
+#define kOTA_Err_CheckpointFailed        0x2f000000UL     /*!< The PAL failed to save or restore a download checkpoint. */
+#define kOTA_Err_DeltaBaseMismatch       0x30000000UL     /*!< The running image is not the base a delta patch was made against. */
+#define kOTA_Err_DeltaPatchInvalid       0x31000000UL     /*!< A delta patch was malformed or referenced data outside the base image. */
+#define kOTA_Err_DecompressFailed        0x32000000UL     /*!< A compressed file did not decompress to its expected size. */
+#define kOTA_Err_NoNetworkStatistics     0x33000000UL     /*!< The connection used by the OTA agent cannot report network statistics. */
 /* @[define_ota_err_codes] */
 
 /* @[define_ota_err_code_helpers] */
@@ -543,6 +615,7 @@ typedef struct
  * - @functionname{ota_function_getpacketsqueued}
  * - @functionname{ota_function_getpacketsprocessed}
  * - @functionname{ota_function_getpacketsdropped}
+ * - @functionname{ota_function_getnetworkstatistics}
  */
 
 /**
@@ -559,6 +632,7 @@ typedef struct
  * @functionpage{OTA_GetPacketsQueued,ota,getpacketsqueued}
  * @functionpage{OTA_GetPacketsProcessed,ota,getpacketsprocessed}
  * @functionpage{OTA_GetPacketsDropped,ota,getpacketsdropped}
+ * @functionpage{OTA_GetNetworkStatistics,ota,getnetworkstatistics}
  */
 
 /**
@@ -739,4 +813,24 @@ uint32_t OTA_GetPacketsProcessed( void );
  */
 uint32_t OTA_GetPacketsDropped( void );
 
+/**
+ * @brief Get the network statistics of the connections used by the OTA agent.
+ *
+ * The control plane statistics come from the MQTT connection in the OTA connection
+ * context. The data plane statistics come from the connection the current file is
+ * downloaded over, which is the same MQTT connection when the data protocol is MQTT.
+ *
+ * @note The data plane connection only exists while a file is being downloaded.
+ * Call this function from the OTA agent task or while the agent is downloading.
+ *
+ * @param[out] pxControl Set to the control plane statistics. May be NULL.
+ * @param[out] pxData Set to the data plane statistics. May be NULL.
+ *
+ * @return kOTA_Err_None if successful, kOTA_Err_OTAAgentStopped if the agent is not
+ * running, or kOTA_Err_NoNetworkStatistics if a requested connection does not exist
+ * or cannot report statistics.
+ */
+OTA_Err_t OTA_GetNetworkStatistics( IotNetworkStatistics_t * pxControl,
+                                    IotNetworkStatistics_t * pxData );
+
 #endif /* ifndef _AWS_IOT_OTA_AGENT_H_ */
@@ -59,6 +59,12 @@
 /* OTA interface includes. */
 #include "aws_iot_ota_interface.h"
 
+/* OTA delta patch includes. */
+#include "aws_iot_ota_delta.h"
+
+/* OTA decompression includes. */
+#include "aws_iot_ota_decompress.h"
+
 /* OTA event handler definiton. */
 
 typedef OTA_Err_t ( * OTAEventHandler_t )( OTA_EventData_t * pxEventMsg );
@@ -89,6 +95,15 @@ typedef union MultiParmPtr
     void ** ppvPtr;
 } MultiParmPtr_t;
 
+/* What the JSON document parser expects to see next. */
+
+typedef enum
+{
+    eJSONExpect_Key,
+    eJSONExpect_Value,
+    eJSONExpect_Separator
+} JSONExpect_t;
+
 /* Array containing pointer to the OTA event structures used to send events to the OTA task. */
 
 static OTA_EventMsg_t xQueueData[ OTA_NUM_MSG_Q_ENTRIES ];
@@ -156,6 +171,34 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
 static OTA_FileContext_t * prvGetFileContextFromJob( const char * pcRawMsg,
                                                      uint32_t ulMsgLen );
 
+/* Sanitize a block bitmap restored from a PAL checkpoint and recount the blocks remaining. */
+
+static void prvResumeBlockBitmap( OTA_FileContext_t * C,
+                                  uint32_t ulNumBlocks,
+                                  uint32_t ulBitmapLen );
+
+/* Ask the PAL to persist the download progress of the file. */
+
+static void prvSaveCheckpoint( OTA_FileContext_t * C );
+
+#if ( otaconfigENABLE_DELTA_UPDATES == 1 )
+
+/* Set up the patch decoder for a delta update. */
+
+    static OTA_Err_t prvStartDelta( OTA_FileContext_t * C );
+#endif
+
+#if ( otaconfigENABLE_COMPRESSED_FILES == 1 )
+
+/* Set up the decompressor for a compressed file. */
+
+    static OTA_Err_t prvStartDecompress( OTA_FileContext_t * C );
+#endif
+
+/* Number of blocks the file is streamed in. */
+
+static uint32_t prvNumBlocks( const OTA_FileContext_t * C );
+
 /* Get an available OTA file context structure or NULL if none available. */
 
 static OTA_FileContext_t * prvGetFreeContext( void );
@@ -219,6 +262,26 @@ static DocParseErr_t prvSearchModelForTokenKey( JSON_DocModel_t * pxDocModel,
                                                 uint32_t ulStrLen,
                                                 uint16_t * pulMatchingIndexResult );
 
+/* Hash a JSON key to its home slot in the document model key index. */
+
+static uint32_t prvHashModelKey( const char * pcKey,
+                                 uint32_t ulLen );
+
+/* Store the value of a document model parameter found in the JSON document. */
+
+static DocParseErr_t prvExtractParameter( const JSON_DocModel_t * pxDocModel,
+                                          uint16_t usModelParamIndex,
+                                          const char * pcValue,
+                                          uint32_t ulValueLen );
+
+/* Find the extent of a JSON string or primitive token while parsing a document. */
+
+static bool prvScanJSONScalar( const char * pcJSON,
+                               uint32_t ulMsgLen,
+                               uint32_t * pulIndex,
+                               uint32_t * pulStart,
+                               uint32_t * pulEnd );
+
 /*
  * Prepare the document model for use by sanity checking the initialization parameters
  * and detecting all required parameters.
@@ -271,7 +334,11 @@ static OTA_Err_t prvJobNotificationHandler( OTA_EventData_t * pxEventData );
         .xSetPlatformImageState = prvPAL_DefaultSetPlatformImageState, \
         .xWriteBlock = prvPAL_WriteBlock,                              \
         .xCompleteCallback = prvDefaultOTACompleteCallback,            \
-        .xCustomJobCallback = prvDefaultCustomJobCallback              \
+        .xCustomJobCallback = prvDefaultCustomJobCallback,             \
+        .xSaveCheckpoint = NULL,                                       \
+        .xResumeFileForRx = NULL,                                      \
+        .xReadBaseImage = NULL,                                        \
+        .bAcceptCompressedFiles = false                                \
     }
 
 /* This is THE OTA agent context and initialization state. */
@@ -786,6 +853,16 @@ static void prvSetPALCallbacks( const OTA_PAL_Callbacks_t * pxCallbacks )
     {
         xOTA_Agent.xPALCallbacks.xCustomJobCallback = prvDefaultCustomJobCallback;
     }
+
+    /* Checkpointing is optional and has no default. A NULL callback disables resuming. */
+    xOTA_Agent.xPALCallbacks.xSaveCheckpoint = pxCallbacks->xSaveCheckpoint;
+    xOTA_Agent.xPALCallbacks.xResumeFileForRx = pxCallbacks->xResumeFileForRx;
+
+    /* Likewise for delta updates, which are rejected unless the base image can be read. */
+    xOTA_Agent.xPALCallbacks.xReadBaseImage = pxCallbacks->xReadBaseImage;
+
+    /* And for compressed files, which the PAL must create at their uncompressed size. */
+    xOTA_Agent.xPALCallbacks.bAcceptCompressedFiles = pxCallbacks->bAcceptCompressedFiles;
 }
 
 static OTA_Err_t prvStartHandler( OTA_EventData_t * pxEventData )
@@ -1473,6 +1550,18 @@ static void prvOTA_FreeContext( OTA_FileContext_t * const C )
             vPortFree( C->pucProtocols ); /* Free the pucProtocols string memory. */
             C->pucProtocols = NULL;
         }
+
+        if( C->pucDeltaBase != NULL )
+        {
+            vPortFree( C->pucDeltaBase ); /* Free the delta base hash string memory. */
+            C->pucDeltaBase = NULL;
+        }
+
+        if( C->pucCompression != NULL )
+        {
+            vPortFree( C->pucCompression ); /* Free the compression scheme string memory. */
+            C->pucCompression = NULL;
+        }
     }
 }
 
@@ -1499,6 +1588,20 @@ static bool prvOTA_Close( OTA_FileContext_t * const C )
          */
         ( void ) xOTA_Agent.xPALCallbacks.xAbort( C );
 
+        /* Free the patch decoder of a delta update. */
+        if( xOTA_Agent.pxDelta != NULL )
+        {
+            vPortFree( xOTA_Agent.pxDelta );
+            xOTA_Agent.pxDelta = NULL;
+        }
+
+        /* Free the decompressor of a compressed file. */
+        if( xOTA_Agent.pxDecompress != NULL )
+        {
+            vPortFree( xOTA_Agent.pxDecompress );
+            xOTA_Agent.pxDecompress = NULL;
+        }
+
         /* Free the resources. */
         prvOTA_FreeContext( C );
 
@@ -1559,6 +1662,31 @@ static bool JSON_IsCStringEqual( const char * pcJSONString,
 }
 
 
+/* Hash a JSON key for the document model key index. The key length and its first and last
+ * two characters are enough to tell the keys of a job document apart. The multipliers are
+ * chosen so every key of the OTA job document model, with any of the supported signature
+ * keys, gets its own slot; the OTA agent unit tests check this. Other models still work but
+ * may need to probe past a collision. */
+
+static uint32_t prvHashModelKey( const char * pcKey,
+                                 uint32_t ulLen )
+{
+    uint32_t ulHash = ulLen * 2U;
+
+    if( ulLen > 0U )
+    {
+        ulHash ^= ( uint32_t ) ( uint8_t ) pcKey[ 0 ] * 12U;
+        ulHash ^= ( uint32_t ) ( uint8_t ) pcKey[ ulLen - 1U ];
+    }
+
+    if( ulLen > 1U )
+    {
+        ulHash ^= ( uint32_t ) ( uint8_t ) pcKey[ ulLen - 2U ];
+    }
+
+    return ulHash & ( OTA_DOC_MODEL_INDEX_SIZE - 1U );
+}
+
 /* Search our document model for a key match with the given token. */
 
 static DocParseErr_t prvSearchModelForTokenKey( JSON_DocModel_t * pxDocModel,
@@ -1567,10 +1695,15 @@ static DocParseErr_t prvSearchModelForTokenKey( JSON_DocModel_t * pxDocModel,
                                                 uint16_t * pulMatchingIndexResult )
 {
     DocParseErr_t eErr = eDocParseErr_ParamKeyNotInModel;
+    uint32_t ulSlot = prvHashModelKey( pcJSONString, ulStrLen );
+    uint32_t ulProbes;
     uint16_t usParamIndex;
 
-    for( usParamIndex = 0; usParamIndex < pxDocModel->usNumModelParams; usParamIndex++ )
+    /* Follow the probe sequence from the key's home slot until we hit an empty slot. */
+    for( ulProbes = 0U; ( ulProbes < OTA_DOC_MODEL_INDEX_SIZE ) && ( pxDocModel->ucKeyIndex[ ulSlot ] != 0U ); ulProbes++ )
     {
+        usParamIndex = ( uint16_t ) pxDocModel->ucKeyIndex[ ulSlot ] - 1U;
+
         if( JSON_IsCStringEqual( pcJSONString, ulStrLen,
                                  pxDocModel->pxBodyDef[ usParamIndex ].pcSrcKey ) )
         {
@@ -1589,12 +1722,209 @@ static DocParseErr_t prvSearchModelForTokenKey( JSON_DocModel_t * pxDocModel,
 
             break; /* We found a key match so stop searching. */
         }
+
+        ulSlot = ( ulSlot + 1U ) & ( OTA_DOC_MODEL_INDEX_SIZE - 1U );
+    }
+
+    return eErr;
+}
+
+/* Store the value of a document model parameter found in the JSON document. */
+
+static DocParseErr_t prvExtractParameter( const JSON_DocModel_t * pxDocModel,
+                                          uint16_t usModelParamIndex,
+                                          const char * pcValue,
+                                          uint32_t ulValueLen )
+{
+    DEFINE_OTA_METHOD_NAME( "prvExtractParameter" );
+
+    const JSON_DocParam_t * pxModelParam = &pxDocModel->pxBodyDef[ usModelParamIndex ];
+    MultiParmPtr_t xParamAddr; /*lint !e9018 We intentionally use this union to cast the parameter address to the proper type. */
+    DocParseErr_t eErr = eDocParseErr_None;
+
+    /* Get destination offset to parameter storage location. */
+
+    /* If it's within the models context structure, add in the context instance base address. */
+    if( pxModelParam->ulDestOffset < pxDocModel->ulContextSize )
+    {
+        xParamAddr.ulVal = pxDocModel->ulContextBase + pxModelParam->ulDestOffset;
+    }
+    else
+    {
+        /* It's a raw pointer so keep it as is. */
+        xParamAddr.ulVal = pxModelParam->ulDestOffset;
+    }
+
+    if( ( eModelParamType_StringCopy == pxModelParam->xModelParamType ) ||
+        ( eModelParamType_ArrayCopy == pxModelParam->xModelParamType ) )
+    {
+        /* Malloc memory for a copy of the value string plus a zero terminator. */
+        void * pvStringCopy = pvPortMalloc( ulValueLen + 1U );
+
+        if( pvStringCopy != NULL )
+        {
+            *xParamAddr.ppvPtr = pvStringCopy;
+            char * pcStringCopy = *xParamAddr.ppcPtr;
+            /* Copy parameter string into newly allocated memory. */
+            ( void ) memcpy( pcStringCopy, pcValue, ulValueLen );
+            /* Zero terminate the new string. */
+            pcStringCopy[ ulValueLen ] = '\0';
+            OTA_LOG_L1( "[%s] Extracted parameter [ %s: %s ]\r\n",
+                        OTA_METHOD_NAME,
+                        pxModelParam->pcSrcKey,
+                        pcStringCopy );
+        }
+        else
+        { /* Stop processing on error. */
+            eErr = eDocParseErr_OutOfMemory;
+        }
+    }
+    else if( eModelParamType_StringInDoc == pxModelParam->xModelParamType )
+    {
+        /* Copy pointer to source string instead of duplicating the string. */
+        *xParamAddr.ppccPtr = pcValue;
+        OTA_LOG_L1( "[%s] Extracted parameter [ %s: %.*s ]\r\n",
+                    OTA_METHOD_NAME,
+                    pxModelParam->pcSrcKey,
+                    ulValueLen, pcValue );
+    }
+    else if( eModelParamType_UInt32 == pxModelParam->xModelParamType )
+    {
+        char * pEnd;
+        *xParamAddr.pulPtr = strtoul( pcValue, &pEnd, 0 );
+
+        if( pEnd == &pcValue[ ulValueLen ] )
+        {
+            OTA_LOG_L1( "[%s] Extracted parameter [ %s: %u ]\r\n",
+                        OTA_METHOD_NAME,
+                        pxModelParam->pcSrcKey,
+                        *xParamAddr.pulPtr );
+        }
+        else
+        {
+            eErr = eDocParseErr_InvalidNumChar;
+        }
+    }
+    else if( eModelParamType_SigBase64 == pxModelParam->xModelParamType )
+    {
+        /* Allocate space for and decode the base64 signature. */
+        void * pvSignature = pvPortMalloc( sizeof( Sig256_t ) );
+
+        if( pvSignature != NULL )
+        {
+            size_t xActualLen = 0;
+            *xParamAddr.ppvPtr = pvSignature;
+            Sig256_t * pxSig256 = *xParamAddr.ppxSig256Ptr;
+
+            if( mbedtls_base64_decode( pxSig256->ucData, sizeof( pxSig256->ucData ), &xActualLen,
+                                       ( const uint8_t * ) pcValue, ulValueLen ) != 0 )
+            { /* Stop processing on error. */
+                OTA_LOG_L1( "[%s] mbedtls_base64_decode failed.\r\n", OTA_METHOD_NAME );
+                eErr = eDocParseErr_Base64Decode;
+            }
+            else
+            {
+                pxSig256->usSize = ( uint16_t ) xActualLen;
+                OTA_LOG_L1( "[%s] Extracted parameter [ %s: %.32s... ]\r\n",
+                            OTA_METHOD_NAME,
+                            pxModelParam->pcSrcKey,
+                            pcValue );
+            }
+        }
+        else
+        {
+            /* We failed to allocate needed memory. Everything will be freed below upon failure. */
+            eErr = eDocParseErr_OutOfMemory;
+        }
+    }
+    else if( eModelParamType_Ident == pxModelParam->xModelParamType )
+    {
+        OTA_LOG_L1( "[%s] Identified parameter [ %s ]\r\n",
+                    OTA_METHOD_NAME,
+                    pxModelParam->pcSrcKey );
+        *xParamAddr.pbBoolPtr = true;
+    }
+    else
+    {
+        /* Ignore invalid document model type. */
     }
 
     return eErr;
 }
 
-/* Extract the desired fields from the JSON document based on the specified document model. */
+/* Find the end of the JSON string or primitive starting at ulIndex. Strings are returned
+ * without their quotes, like Jasmine string tokens. Returns false if the token is malformed. */
+
+static bool prvScanJSONScalar( const char * pcJSON,
+                               uint32_t ulMsgLen,
+                               uint32_t * pulIndex,
+                               uint32_t * pulStart,
+                               uint32_t * pulEnd )
+{
+    uint32_t ulIndex = *pulIndex;
+    bool bValid = false;
+    char c;
+
+    if( pcJSON[ ulIndex ] == '"' )
+    {
+        ulIndex++;
+        *pulStart = ulIndex;
+
+        while( ( ulIndex < ulMsgLen ) && ( pcJSON[ ulIndex ] != '\0' ) )
+        {
+            c = pcJSON[ ulIndex ];
+
+            if( c == '"' )
+            {
+                *pulEnd = ulIndex;
+                ulIndex++; /* Step past the closing quote. */
+                bValid = true;
+                break;
+            }
+
+            /* Skip the escaped character so an escaped quote doesn't end the string. */
+            ulIndex += ( c == '\\' ) ? 2U : 1U;
+        }
+    }
+    else
+    {
+        *pulStart = ulIndex;
+
+        while( ulIndex < ulMsgLen )
+        {
+            c = pcJSON[ ulIndex ];
+
+            if( ( c == '\0' ) || ( c == ' ' ) || ( c == '\t' ) || ( c == '\r' ) || ( c == '\n' ) ||
+                ( c == ',' ) || ( c == ':' ) || ( c == ']' ) || ( c == '}' ) )
+            {
+                break;
+            }
+
+            if( ( ( uint8_t ) c < 32U ) || ( ( uint8_t ) c >= 127U ) )
+            {
+                /* Primitives are plain ASCII. Flag the token as malformed. */
+                ulIndex = *pulStart;
+                break;
+            }
+
+            ulIndex++;
+        }
+
+        *pulEnd = ulIndex;
+        bValid = ( ulIndex > *pulStart );
+    }
+
+    *pulIndex = ulIndex;
+
+    return bValid;
+}
+
+/* Extract the desired fields from the JSON document based on the specified document model.
+ *
+ * The document is walked once, without a token array. Keys are resolved through the key
+ * index of the model. The value of a key that is not in the model is skipped along with
+ * all of its descendants. Object and array parameters are descended into so their members
+ * can be matched, except an array that is copied whole (eModelParamType_ArrayCopy). */
 
 static DocParseErr_t prvParseJSONbyModel( const char * pcJSON,
                                           uint32_t ulMsgLen,
@@ -1603,20 +1933,24 @@ static DocParseErr_t prvParseJSONbyModel( const char * pcJSON,
     DEFINE_OTA_METHOD_NAME( "prvParseJSONbyModel" );
 
     const JSON_DocParam_t * pxModelParam = NULL;
-    jsmn_parser xParser;
-    jsmntok_t * pxTokens = NULL;
-    const jsmntok_t * pxValTok = NULL;
-    int32_t jsmn_result = 0;
-    uint32_t ulNumTokens = 0, ulTokenLen = 0;
-    MultiParmPtr_t xParamAddr; /*lint !e9018 We intentionally use this union to cast the parameter address to the proper type. */
+    JSONExpect_t eExpect = eJSONExpect_Value;
     uint32_t ulIndex = 0;
+    uint32_t ulStart = 0, ulEnd = 0;
+    uint32_t ulDepth = 0;            /* Number of currently open containers. */
+    uint32_t ulObjectBitmap = 0;     /* Bit n is set if the container at depth n + 1 is an object. */
+    uint32_t ulSkipDepth = 0;        /* If not 0, the depth of the container being skipped. */
+    uint32_t ulCopyStart = 0;        /* Start of the container being copied whole. */
+    uint16_t usCopyParamIndex = 0;   /* Model index of the container being copied whole. */
+    bool bCopyContainer = false;     /* The container being skipped is copied on close. */
+    bool bKeyInModel = false;        /* The last key read is in the document model. */
+    bool bHaveValue = false;         /* At least one JSON value was seen. */
+    bool bDone = false;
     uint16_t usModelParamIndex = 0;
     uint32_t ulScanIndex = 0;
+    jsmntype_t eValueType;
+    char c;
     DocParseErr_t eErr = eDocParseErr_None;
 
-    /* Reset the Jasmine tokenizer. */
-    jsmn_init( &xParser );
-
     /* Check if document model is valid. */
     if( pxDocModel == NULL )
     {
@@ -1654,264 +1988,219 @@ static DocParseErr_t prvParseJSONbyModel( const char * pcJSON,
         }
     }
 
-    /* Check if token numbe is valid. */
     if( eErr == eDocParseErr_None )
     {
         pxModelParam = pxDocModel->pxBodyDef;
-
-        /* Count the total number of tokens in our JSON document. */
-        jsmn_result = jsmn_parse( &xParser, pcJSON, ( size_t ) ulMsgLen, NULL, 1UL );
-        ulNumTokens = jsmn_result < 0 ? 0 : ( uint32_t ) jsmn_result;
-
-        if( ulNumTokens == 0 )
-        {
-            OTA_LOG_L1( "[%s] Invalid JSON document. No tokens parsed. \r\n", OTA_METHOD_NAME );
-            eErr = eDocParseErr_NoTokens;
-        }
     }
 
-    /* Check if the JSON document isn't too big for our token array. */
-    if( eErr == eDocParseErr_None )
+    /* Walk the JSON document, searching for job parameters based on our document model. */
+    while( ( eErr == eDocParseErr_None ) && ( bDone == false ) )
     {
-        if( ulNumTokens > OTA_MAX_JSON_TOKENS )
+        /* Skip white space between tokens. */
+        while( ( ulIndex < ulMsgLen ) &&
+               ( ( pcJSON[ ulIndex ] == ' ' ) || ( pcJSON[ ulIndex ] == '\t' ) ||
+                 ( pcJSON[ ulIndex ] == '\r' ) || ( pcJSON[ ulIndex ] == '\n' ) ) )
         {
-            OTA_LOG_L1( "[%s] Document has too many keys.\r\n", OTA_METHOD_NAME );
-            eErr = eDocParseErr_TooManyTokens;
+            ulIndex++;
         }
-    }
 
-    /* Allocate space on heap for temporary token array. */
-    if( eErr == eDocParseErr_None )
-    {
-        /* Allocate space for the document JSON tokens. */
-        pxTokens = ( jsmntok_t * ) pvPortMalloc( ulNumTokens * sizeof( jsmntok_t ) );
+        c = ( ulIndex < ulMsgLen ) ? pcJSON[ ulIndex ] : '\0';
 
-        if( pxTokens == NULL )
+        if( ( eExpect == eJSONExpect_Separator ) && ( ulDepth == 0U ) )
         {
-            OTA_LOG_L1( "[%s] No memory for JSON tokens.\r\n", OTA_METHOD_NAME );
-            eErr = eDocParseErr_OutOfMemory;
+            /* The root value is complete. */
+            bDone = true;
         }
-    }
-
-    /* Init Jasmine and check number of tokens.*/
-    if( eErr == eDocParseErr_None )
-    {
-        /* Reset Jasmine again and tokenize the document for real. */
-        jsmn_init( &xParser );
-        ulIndex = ( uint32_t ) jsmn_parse( &xParser, pcJSON, ulMsgLen, pxTokens, ulNumTokens );
-
-        if( ulIndex != ulNumTokens )
+        else if( c == '\0' )
         {
-            OTA_LOG_L1( "[%s] jsmn_parse didn't match token count when parsing.\r\n", OTA_METHOD_NAME );
-            eErr = eDocParseErr_JasmineCountMismatch;
+            if( bHaveValue == false )
+            {
+                OTA_LOG_L1( "[%s] Invalid JSON document. No tokens parsed. \r\n", OTA_METHOD_NAME );
+                eErr = eDocParseErr_NoTokens;
+            }
+            else
+            {
+                OTA_LOG_L1( "[%s] JSON document ended unexpectedly.\r\n", OTA_METHOD_NAME );
+                eErr = eDocParseErr_InvalidToken;
+            }
         }
-    }
-
-    /* Process JSON tokens. */
-    if( eErr == eDocParseErr_None )
-    {
-        /* Examine each JSON token, searching for job parameters based on our document model. */
-        for( ulIndex = 0U; ( eErr == eDocParseErr_None ) && ( ulIndex < ulNumTokens ); ulIndex++ )
+        else if( ( ( c == '}' ) && ( eExpect != eJSONExpect_Value ) && ( ulDepth > 0U ) &&
+                   ( ( ulObjectBitmap & ( 1UL << ( ulDepth - 1U ) ) ) != 0U ) ) ||
+                 ( ( c == ']' ) && ( eExpect != eJSONExpect_Key ) && ( ulDepth > 0U ) &&
+                   ( ( ulObjectBitmap & ( 1UL << ( ulDepth - 1U ) ) ) == 0U ) ) )
         {
-            /* All parameter keys are JSON strings. */
-            if( pxTokens[ ulIndex ].type == JSMN_STRING )
+            /* Close the innermost container. */
+            ulIndex++;
+            ulDepth--;
+            eExpect = eJSONExpect_Separator;
+
+            if( ( ulSkipDepth != 0U ) && ( ulDepth < ulSkipDepth ) )
             {
-                /* Search the document model to see if it matches the current key. */
-                ulTokenLen = ( uint32_t ) pxTokens[ ulIndex ].end - ( uint32_t ) pxTokens[ ulIndex ].start;
-                eErr = prvSearchModelForTokenKey( pxDocModel, &pcJSON[ pxTokens[ ulIndex ].start ], ulTokenLen, &usModelParamIndex );
+                /* The skipped container is complete. Copy it if the model asked for it. */
+                ulSkipDepth = 0U;
 
-                /* If we didn't find a match in the model, skip over it and its descendants. */
-                if( eErr == eDocParseErr_ParamKeyNotInModel )
+                if( bCopyContainer == true )
                 {
-                    int32_t iRoot = ( int32_t ) ulIndex; /* Create temp root from the unrecognized tokens index. Use signed int since the parent index is signed. */
-                    ulIndex++;                           /* Skip the active key since it's the one we don't recognize. */
-
-                    /* Skip tokens whose parents are equal to or deeper than the unrecognized temporary root token level. */
-                    while( ( ulIndex < ulNumTokens ) && ( pxTokens[ ulIndex ].parent >= iRoot ) )
-                    {
-                        ulIndex++; /* Skip over all descendants of the unknown parent. */
-                    }
-
-                    --ulIndex;                /* Adjust for outer for-loop increment. */
-                    eErr = eDocParseErr_None; /* Unknown key structures are simply skipped so clear the error state to continue. */
+                    bCopyContainer = false;
+                    eErr = prvExtractParameter( pxDocModel, usCopyParamIndex, &pcJSON[ ulCopyStart ], ulIndex - ulCopyStart );
                 }
-                else if( eErr == eDocParseErr_None )
-                {
-                    /* We found the parameter key in the document model. */
+            }
+        }
+        else if( eExpect == eJSONExpect_Key )
+        {
+            /* All parameter keys are JSON strings. */
+            if( ( c != '"' ) || ( prvScanJSONScalar( pcJSON, ulMsgLen, &ulIndex, &ulStart, &ulEnd ) == false ) )
+            {
+                eErr = eDocParseErr_InvalidToken;
+            }
+            else
+            {
+                bKeyInModel = false;
 
-                    /* Get the value field (i.e. the following token) for the parameter. */
-                    pxValTok = &pxTokens[ ulIndex + 1UL ];
+                if( ulSkipDepth == 0U )
+                {
+                    /* Search the document model to see if it matches the current key. */
+                    eErr = prvSearchModelForTokenKey( pxDocModel, &pcJSON[ ulStart ], ulEnd - ulStart, &usModelParamIndex );
 
-                    /* Verify the field type is what we expect for this parameter. */
-                    if( pxValTok->type != pxModelParam[ usModelParamIndex ].eJasmineType )
+                    if( eErr == eDocParseErr_None )
                     {
-                        ulTokenLen = ( uint32_t ) ( pxValTok->end ) - ( uint32_t ) ( pxValTok->start );
-                        OTA_LOG_L1( "[%s] parameter type mismatch [ %s : %.*s ] type %u, expected %u\r\n",
-                                    OTA_METHOD_NAME, pxModelParam[ usModelParamIndex ].pcSrcKey, ulTokenLen,
-                                    &pcJSON[ pxValTok->start ],
-                                    pxValTok->type, pxModelParam[ usModelParamIndex ].eJasmineType );
-                        eErr = eDocParseErr_FieldTypeMismatch;
+                        bKeyInModel = true;
                     }
-                    else if( OTA_DONT_STORE_PARAM == pxModelParam[ usModelParamIndex ].ulDestOffset )
+                    else if( eErr == eDocParseErr_ParamKeyNotInModel )
                     {
-                        /* Nothing to do with this parameter since we're not storing it. */
-                        continue;
+                        eErr = eDocParseErr_None; /* Unknown keys are simply skipped along with their value. */
                     }
                     else
                     {
-                        /* Get destination offset to parameter storage location. */
+                        /* Nothing special to do. The error will break us out of the loop. */
+                    }
+                }
 
-                        /* If it's within the models context structure, add in the context instance base address. */
-                        if( pxModelParam[ usModelParamIndex ].ulDestOffset < pxDocModel->ulContextSize )
-                        {
-                            xParamAddr.ulVal = pxDocModel->ulContextBase + pxModelParam[ usModelParamIndex ].ulDestOffset;
-                        }
-                        else
-                        {
-                            /* It's a raw pointer so keep it as is. */
-                            xParamAddr.ulVal = pxModelParam[ usModelParamIndex ].ulDestOffset;
-                        }
+                /* Step over the name separator to the value. */
+                while( ( ulIndex < ulMsgLen ) &&
+                       ( ( pcJSON[ ulIndex ] == ' ' ) || ( pcJSON[ ulIndex ] == '\t' ) ||
+                         ( pcJSON[ ulIndex ] == '\r' ) || ( pcJSON[ ulIndex ] == '\n' ) ) )
+                {
+                    ulIndex++;
+                }
 
-                        if( eModelParamType_StringCopy == pxModelParam[ usModelParamIndex ].xModelParamType )
-                        {
-                            /* Malloc memory for a copy of the value string plus a zero terminator. */
-                            ulTokenLen = ( uint32_t ) ( pxValTok->end ) - ( uint32_t ) ( pxValTok->start );
-                            void * pvStringCopy = pvPortMalloc( ulTokenLen + 1U );
+                if( ( ulIndex < ulMsgLen ) && ( pcJSON[ ulIndex ] == ':' ) )
+                {
+                    ulIndex++;
+                    eExpect = eJSONExpect_Value;
+                }
+                else if( eErr == eDocParseErr_None )
+                {
+                    eErr = eDocParseErr_InvalidToken;
+                }
+                else
+                {
+                    /* Keep the error from the model search. */
+                }
+            }
+        }
+        else if( eExpect == eJSONExpect_Value )
+        {
+            bHaveValue = true;
 
-                            if( pvStringCopy != NULL )
-                            {
-                                *xParamAddr.ppvPtr = pvStringCopy;
-                                char * pcStringCopy = *xParamAddr.ppcPtr;
-                                /* Copy parameter string into newly allocated memory. */
-                                ( void ) memcpy( pcStringCopy, &pcJSON[ pxValTok->start ], ulTokenLen );
-                                /* Zero terminate the new string. */
-                                pcStringCopy[ ulTokenLen ] = '\0';
-                                OTA_LOG_L1( "[%s] Extracted parameter [ %s: %s ]\r\n",
-                                            OTA_METHOD_NAME,
-                                            pxModelParam[ usModelParamIndex ].pcSrcKey,
-                                            pcStringCopy );
-                            }
-                            else
-                            { /* Stop processing on error. */
-                                eErr = eDocParseErr_OutOfMemory;
-                            }
-                        }
-                        else if( eModelParamType_StringInDoc == pxModelParam[ usModelParamIndex ].xModelParamType )
-                        {
-                            /* Copy pointer to source string instead of duplicating the string. */
-                            const char * pcStringInDoc = &pcJSON[ pxValTok->start ];
-                            *xParamAddr.ppccPtr = pcStringInDoc;
-                            ulTokenLen = ( uint32_t ) ( pxValTok->end ) - ( uint32_t ) ( pxValTok->start );
-                            OTA_LOG_L1( "[%s] Extracted parameter [ %s: %.*s ]\r\n",
-                                        OTA_METHOD_NAME,
-                                        pxModelParam[ usModelParamIndex ].pcSrcKey,
-                                        ulTokenLen, pcStringInDoc );
-                        }
-                        else if( eModelParamType_UInt32 == pxModelParam[ usModelParamIndex ].xModelParamType )
-                        {
-                            char * pEnd;
-                            const char * pStart = &pcJSON[ pxValTok->start ];
-                            *xParamAddr.pulPtr = strtoul( pStart, &pEnd, 0 );
+            if( c == '{' )
+            {
+                eValueType = JSMN_OBJECT;
+            }
+            else if( c == '[' )
+            {
+                eValueType = JSMN_ARRAY;
+            }
+            else if( c == '"' )
+            {
+                eValueType = JSMN_STRING;
+            }
+            else
+            {
+                eValueType = JSMN_PRIMITIVE;
+            }
 
-                            if( pEnd == &pcJSON[ pxValTok->end ] )
-                            {
-                                OTA_LOG_L1( "[%s] Extracted parameter [ %s: %u ]\r\n",
-                                            OTA_METHOD_NAME,
-                                            pxModelParam[ usModelParamIndex ].pcSrcKey,
-                                            *xParamAddr.pulPtr );
-                            }
-                            else
-                            {
-                                eErr = eDocParseErr_InvalidNumChar;
-                            }
-                        }
-                        else if( eModelParamType_SigBase64 == pxModelParam[ usModelParamIndex ].xModelParamType )
+            /* Verify the field type is what we expect for this parameter. */
+            if( ( bKeyInModel == true ) && ( eValueType != pxModelParam[ usModelParamIndex ].eJasmineType ) )
+            {
+                OTA_LOG_L1( "[%s] parameter type mismatch [ %s ] type %u, expected %u\r\n",
+                            OTA_METHOD_NAME, pxModelParam[ usModelParamIndex ].pcSrcKey,
+                            eValueType, pxModelParam[ usModelParamIndex ].eJasmineType );
+                eErr = eDocParseErr_FieldTypeMismatch;
+            }
+            else if( ( eValueType == JSMN_OBJECT ) || ( eValueType == JSMN_ARRAY ) )
+            {
+                if( ulDepth >= OTA_MAX_JSON_DEPTH )
+                {
+                    OTA_LOG_L1( "[%s] Document nests too deeply.\r\n", OTA_METHOD_NAME );
+                    eErr = eDocParseErr_TooManyTokens;
+                }
+                else
+                {
+                    if( ulSkipDepth == 0U )
+                    {
+                        if( bKeyInModel == true )
                         {
-                            /* Allocate space for and decode the base64 signature. */
-                            void * pvSignature = pvPortMalloc( sizeof( Sig256_t ) );
-
-                            if( pvSignature != NULL )
-                            {
-                                size_t xActualLen = 0;
-                                *xParamAddr.ppvPtr = pvSignature;
-                                Sig256_t * pxSig256 = *xParamAddr.ppxSig256Ptr;
-                                ulTokenLen = ( uint32_t ) ( pxValTok->end ) - ( uint32_t ) ( pxValTok->start );
-
-                                if( mbedtls_base64_decode( pxSig256->ucData, sizeof( pxSig256->ucData ), &xActualLen,
-                                                           ( const uint8_t * ) &pcJSON[ pxValTok->start ], ulTokenLen ) != 0 )
-                                { /* Stop processing on error. */
-                                    OTA_LOG_L1( "[%s] mbedtls_base64_decode failed.\r\n", OTA_METHOD_NAME );
-                                    eErr = eDocParseErr_Base64Decode;
-                                }
-                                else
-                                {
-                                    pxSig256->usSize = ( uint16_t ) xActualLen;
-                                    OTA_LOG_L1( "[%s] Extracted parameter [ %s: %.32s... ]\r\n",
-                                                OTA_METHOD_NAME,
-                                                pxModelParam[ usModelParamIndex ].pcSrcKey,
-                                                &pcJSON[ pxValTok->start ] );
-                                }
-                            }
-                            else
+                            if( pxModelParam[ usModelParamIndex ].xModelParamType == eModelParamType_ArrayCopy )
                             {
-                                /* We failed to allocate needed memory. Everything will be freed below upon failure. */
-                                eErr = eDocParseErr_OutOfMemory;
+                                /* Skip over the members and copy the whole array when it closes. */
+                                ulSkipDepth = ulDepth + 1U;
+                                bCopyContainer = ( OTA_DONT_STORE_PARAM != pxModelParam[ usModelParamIndex ].ulDestOffset );
+                                usCopyParamIndex = usModelParamIndex;
+                                ulCopyStart = ulIndex;
                             }
                         }
-                        else if( eModelParamType_Ident == pxModelParam[ usModelParamIndex ].xModelParamType )
+                        else if( ( ulDepth > 0U ) && ( ( ulObjectBitmap & ( 1UL << ( ulDepth - 1U ) ) ) != 0U ) )
                         {
-                            OTA_LOG_L1( "[%s] Identified parameter [ %s ]\r\n",
-                                        OTA_METHOD_NAME,
-                                        pxModelParam[ usModelParamIndex ].pcSrcKey );
-                            *xParamAddr.pbBoolPtr = true;
-                        }
-
-                        if( eModelParamType_ArrayCopy == pxModelParam[ usModelParamIndex ].xModelParamType )
-                        {
-                            /* Malloc memory for a copy of the value string plus a zero terminator. */
-                            ulTokenLen = ( uint32_t ) ( pxValTok->end ) - ( uint32_t ) ( pxValTok->start );
-                            void * pvStringCopy = pvPortMalloc( ulTokenLen + 1U );
-
-                            if( pvStringCopy != NULL )
-                            {
-                                *xParamAddr.ppvPtr = pvStringCopy;
-                                char * pcStringCopy = *xParamAddr.ppcPtr;
-                                /* Copy parameter string into newly allocated memory. */
-                                ( void ) memcpy( pcStringCopy, &pcJSON[ pxValTok->start ], ulTokenLen );
-                                /* Zero terminate the new string. */
-                                pcStringCopy[ ulTokenLen ] = '\0';
-                                OTA_LOG_L1( "[%s] Extracted parameter [ %s: %s ]\r\n",
-                                            OTA_METHOD_NAME,
-                                            pxModelParam[ usModelParamIndex ].pcSrcKey,
-                                            pcStringCopy );
-                            }
-                            else
-                            { /* Stop processing on error. */
-                                eErr = eDocParseErr_OutOfMemory;
-                            }
+                            /* The value of an unrecognized key. Skip it and all of its descendants. */
+                            ulSkipDepth = ulDepth + 1U;
                         }
                         else
                         {
-                            /* Ignore invalid document model type. */
+                            /* The root or an array element, so look inside it. */
                         }
                     }
-                }
-                else
-                {
-                    /* Nothing special to do. The error will break us out of the loop. */
+
+                    if( eValueType == JSMN_OBJECT )
+                    {
+                        ulObjectBitmap |= ( 1UL << ulDepth );
+                        eExpect = eJSONExpect_Key;
+                    }
+                    else
+                    {
+                        ulObjectBitmap &= ~( 1UL << ulDepth );
+                        eExpect = eJSONExpect_Value;
+                    }
+
+                    ulDepth++;
+                    ulIndex++;
                 }
             }
+            else if( prvScanJSONScalar( pcJSON, ulMsgLen, &ulIndex, &ulStart, &ulEnd ) == false )
+            {
+                eErr = eDocParseErr_InvalidToken;
+            }
             else
             {
-                /* Ignore tokens that are not strings and move on to the next. */
+                if( ( bKeyInModel == true ) && ( OTA_DONT_STORE_PARAM != pxModelParam[ usModelParamIndex ].ulDestOffset ) )
+                {
+                    eErr = prvExtractParameter( pxDocModel, usModelParamIndex, &pcJSON[ ulStart ], ulEnd - ulStart );
+                }
+
+                eExpect = eJSONExpect_Separator;
             }
-        }
-    }
 
-    if( pxTokens != NULL )
-    {
-        /* Free the token memory. */
-        vPortFree( pxTokens ); /*lint !e850 ulIndex is intentionally modified within the loop to skip over unknown tags. */
+            bKeyInModel = false;
+        }
+        else if( c == ',' )
+        {
+            ulIndex++;
+            eExpect = ( ( ulObjectBitmap & ( 1UL << ( ulDepth - 1U ) ) ) != 0U ) ? eJSONExpect_Key : eJSONExpect_Value;
+        }
+        else
+        {
+            eErr = eDocParseErr_InvalidToken;
+        }
     }
 
     if( eErr == eDocParseErr_None )
@@ -1957,6 +2246,8 @@ static DocParseErr_t prvInitDocModel( JSON_DocModel_t * pxDocModel,
 
     DocParseErr_t eErr = eDocParseErr_Unknown;
     uint32_t ulScanIndex;
+    uint32_t ulSlot;
+    const char * pcKey;
 
     /* Sanity check the model pointers and parameter count. Exclude the context base address and size since
      * it is technically possible to create a model that writes entirely into absolute memory locations.
@@ -1984,6 +2275,7 @@ static DocParseErr_t prvInitDocModel( JSON_DocModel_t * pxDocModel,
         pxDocModel->usNumModelParams = usNumJobParams;
         pxDocModel->ulParamsReceivedBitmap = 0;
         pxDocModel->ulParamsRequiredBitmap = 0;
+        ( void ) memset( pxDocModel->ucKeyIndex, 0, sizeof( pxDocModel->ucKeyIndex ) );
 
         /* Scan the model and detect all required parameters (i.e. not optional). */
         for( ulScanIndex = 0; ulScanIndex < pxDocModel->usNumModelParams; ulScanIndex++ )
@@ -1993,6 +2285,17 @@ static DocParseErr_t prvInitDocModel( JSON_DocModel_t * pxDocModel,
                 /* Add parameter to the required bitmap. */
                 pxDocModel->ulParamsRequiredBitmap |= ( 1UL << ulScanIndex );
             }
+
+            /* Add the parameter key to the key index, probing linearly past any collision. */
+            pcKey = pxDocModel->pxBodyDef[ ulScanIndex ].pcSrcKey;
+            ulSlot = prvHashModelKey( pcKey, ( uint32_t ) strlen( pcKey ) );
+
+            while( pxDocModel->ucKeyIndex[ ulSlot ] != 0U )
+            {
+                ulSlot = ( ulSlot + 1U ) & ( OTA_DOC_MODEL_INDEX_SIZE - 1U );
+            }
+
+            pxDocModel->ucKeyIndex[ ulSlot ] = ( uint8_t ) ( ulScanIndex + 1U );
         }
 
         eErr = eDocParseErr_None;
@@ -2083,6 +2386,10 @@ static OTA_FileContext_t * prvParseJobDoc( const char * pcJSON,
         { OTA_JSON_AUTH_SCHEME_KEY,     OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, pucAuthScheme )  }, eModelParamType_StringCopy,  JSMN_STRING    },
         { cOTA_JSON_FileSignatureKey,   OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, pxSignature )    }, eModelParamType_SigBase64,   JSMN_STRING    },
         { OTA_JSON_FILE_ATTRIBUTE_KEY,  OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, ulFileAttributes )}, eModelParamType_UInt32,      JSMN_PRIMITIVE },
+        { OTA_JSON_DELTA_SIZE_KEY,      OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, ulDeltaImageSize )}, eModelParamType_UInt32,      JSMN_PRIMITIVE },
+        { OTA_JSON_DELTA_BASE_KEY,      OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, pucDeltaBase )   }, eModelParamType_StringCopy,  JSMN_STRING    },
+        { OTA_JSON_COMPRESSION_KEY,     OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, pucCompression ) }, eModelParamType_StringCopy,  JSMN_STRING    },
+        { OTA_JSON_UNCOMPRESSED_SIZE_KEY, OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, ulUncompressedSize ) }, eModelParamType_UInt32,  JSMN_PRIMITIVE },
     };
 
     OTA_Err_t xOTAErr = kOTA_Err_None;
@@ -2111,6 +2418,23 @@ static OTA_FileContext_t * prvParseJobDoc( const char * pcJSON,
             OTA_LOG_L1( "[%s] Zero file size is not allowed!\r\n", OTA_METHOD_NAME );
             eErr = eOTA_JobParseErr_ZeroFileSize;
         }
+        else if( ( C->ulDeltaImageSize != 0U ) &&
+                 ( ( otaconfigENABLE_DELTA_UPDATES != 1 ) ||
+                   ( xOTA_Agent.xPALCallbacks.xReadBaseImage == NULL ) ||
+                   ( C->pucDeltaBase == NULL ) ) )
+        {
+            OTA_LOG_L1( "[%s] Delta update without a readable base image is not supported!\r\n", OTA_METHOD_NAME );
+            eErr = eOTA_JobParseErr_DeltaNotSupported;
+        }
+        else if( ( C->pucCompression != NULL ) &&
+                 ( ( otaconfigENABLE_COMPRESSED_FILES != 1 ) ||
+                   ( xOTA_Agent.xPALCallbacks.bAcceptCompressedFiles == false ) ||
+                   ( strcmp( ( const char * ) C->pucCompression, OTA_COMPRESSION_HEATSHRINK ) != 0 ) ||
+                   ( C->ulUncompressedSize == 0U ) ) )
+        {
+            OTA_LOG_L1( "[%s] Compression %s is not supported!\r\n", OTA_METHOD_NAME, ( const char * ) C->pucCompression );
+            eErr = eOTA_JobParseErr_CompressionNotSupported;
+        }
         /* If there's an active job, verify that it's the same as what's being reported now. */
         /* We already checked for missing parameters so we SHOULD have a job name in the context. */
         else if( xOTA_Agent.pcOTA_Singleton_ActiveJobName != NULL )
@@ -2328,6 +2652,147 @@ static OTA_FileContext_t * prvParseJobDoc( const char * pcJSON,
 }
 
 
+/* prvResumeBlockBitmap
+ *
+ * The PAL restored the block bitmap of an interrupted download. Clear any bits that are out of
+ * range for the file size and count the blocks that still need to be received. If the bitmap
+ * says every block is in, the device went down between the last block and closing the file, so
+ * ask for the last block again to drive the normal close and signature check.
+ */
+
+static void prvResumeBlockBitmap( OTA_FileContext_t * C,
+                                  uint32_t ulNumBlocks,
+                                  uint32_t ulBitmapLen )
+{
+    uint32_t ulIndex;
+    uint32_t ulRemaining = 0U;
+    uint8_t ucByte;
+    uint8_t ucLastMask;
+
+    /* Bits of the last byte at or above the block count are out of range. */
+    ucLastMask = ( uint8_t ) ( OTA_ERASED_BLOCKS_VAL >> ( ( ulBitmapLen * BITS_PER_BYTE ) - ulNumBlocks ) );
+    C->pucRxBlockBitmap[ ulBitmapLen - 1U ] &= ucLastMask;
+
+    for( ulIndex = 0U; ulIndex < ulBitmapLen; ulIndex++ )
+    {
+        /* Count the erased (still wanted) blocks of this byte. */
+        for( ucByte = C->pucRxBlockBitmap[ ulIndex ]; ucByte != 0U; ucByte &= ( uint8_t ) ( ucByte - 1U ) )
+        {
+            ulRemaining++;
+        }
+    }
+
+    if( ulRemaining == 0U )
+    {
+        C->pucRxBlockBitmap[ ( ulNumBlocks - 1U ) >> LOG2_BITS_PER_BYTE ] |= ( uint8_t ) ( 1U << ( ( ulNumBlocks - 1U ) % BITS_PER_BYTE ) );
+        ulRemaining = 1U;
+    }
+
+    C->ulBlocksRemaining = ulRemaining;
+}
+
+/* prvSaveCheckpoint
+ *
+ * Hand the current block bitmap to the PAL so the download can resume after a reboot or a
+ * lost connection. A failed checkpoint only costs resumability, so the download carries on.
+ */
+
+static void prvSaveCheckpoint( OTA_FileContext_t * C )
+{
+    DEFINE_OTA_METHOD_NAME( "prvSaveCheckpoint" );
+
+    uint32_t ulNumBlocks;
+    uint32_t ulBitmapLen;
+    OTA_Err_t xErr;
+
+    ulNumBlocks = ( C->ulFileSize + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE;
+    ulBitmapLen = ( ulNumBlocks + ( BITS_PER_BYTE - 1U ) ) >> LOG2_BITS_PER_BYTE;
+
+    /* The agent owns the active job name. Lend it to the PAL, which keys the checkpoint on it. */
+    C->pucJobName = xOTA_Agent.pcOTA_Singleton_ActiveJobName;
+    xErr = xOTA_Agent.xPALCallbacks.xSaveCheckpoint( C, ulBitmapLen );
+    C->pucJobName = NULL;
+
+    if( xErr != kOTA_Err_None )
+    {
+        OTA_LOG_L1( "[%s] Warning: Failed to save download checkpoint (0x%08x).\r\n", OTA_METHOD_NAME, xErr );
+    }
+}
+
+#if ( otaconfigENABLE_DELTA_UPDATES == 1 )
+
+/* prvStartDelta
+ *
+ * The job streams a patch rather than the image. Allocate the patch decoder, which also
+ * checks that the running image is the one the patch was made against.
+ */
+
+    static OTA_Err_t prvStartDelta( OTA_FileContext_t * C )
+    {
+        DEFINE_OTA_METHOD_NAME( "prvStartDelta" );
+
+        OTA_Err_t xErr;
+
+        xOTA_Agent.pxDelta = ( OTA_DeltaContext_t * ) pvPortMalloc( sizeof( OTA_DeltaContext_t ) ); /*lint !e9079 FreeRTOS malloc port returns void*. */
+
+        if( xOTA_Agent.pxDelta == NULL )
+        {
+            xErr = kOTA_Err_OutOfMemory;
+        }
+        else
+        {
+            xErr = OTA_Delta_Init( xOTA_Agent.pxDelta,
+                                   C,
+                                   xOTA_Agent.xPALCallbacks.xWriteBlock,
+                                   xOTA_Agent.xPALCallbacks.xReadBaseImage );
+        }
+
+        if( xErr == kOTA_Err_None )
+        {
+            OTA_LOG_L1( "[%s] Applying a %u byte patch to rebuild a %u byte image.\r\n", OTA_METHOD_NAME,
+                        C->ulFileSize,
+                        C->ulDeltaImageSize );
+        }
+
+        return xErr;
+    }
+#endif /* if ( otaconfigENABLE_DELTA_UPDATES == 1 ) */
+
+#if ( otaconfigENABLE_COMPRESSED_FILES == 1 )
+
+/* prvStartDecompress
+ *
+ * The job streams a compressed file. Allocate the decompressor, feeding the patch decoder
+ * if this is also a delta update.
+ */
+
+    static OTA_Err_t prvStartDecompress( OTA_FileContext_t * C )
+    {
+        DEFINE_OTA_METHOD_NAME( "prvStartDecompress" );
+
+        OTA_Err_t xErr = kOTA_Err_None;
+
+        xOTA_Agent.pxDecompress = ( OTA_DecompressContext_t * ) pvPortMalloc( sizeof( OTA_DecompressContext_t ) ); /*lint !e9079 FreeRTOS malloc port returns void*. */
+
+        if( xOTA_Agent.pxDecompress == NULL )
+        {
+            xErr = kOTA_Err_OutOfMemory;
+        }
+        else
+        {
+            OTA_Decompress_Init( xOTA_Agent.pxDecompress,
+                                 C,
+                                 xOTA_Agent.xPALCallbacks.xWriteBlock,
+                                 xOTA_Agent.pxDelta );
+            OTA_LOG_L1( "[%s] Decompressing a %u byte file to %u bytes.\r\n", OTA_METHOD_NAME,
+                        C->ulFileSize,
+                        C->ulUncompressedSize );
+        }
+
+        return xErr;
+    }
+#endif /* if ( otaconfigENABLE_COMPRESSED_FILES == 1 ) */
+
 /* prvGetFileContextFromJob
  *
  * We received an OTA update job message from the job service so process
@@ -2394,8 +2859,46 @@ static OTA_FileContext_t * prvGetFileContextFromJob( const char * pcRawMsg,
 
             pstUpdateFile->ulBlocksRemaining = ulNumBlocks; /* Initialize our blocks remaining counter. */
 
-            /* Create/Open the OTA file on the file system. */
-            xErr = xOTA_Agent.xPALCallbacks.xCreateFileForRx( pstUpdateFile );
+            /* Pick up where an interrupted download of this file left off, if the PAL saved a checkpoint.
+             * A delta or compressed file can't be resumed since the decoder state isn't part of the checkpoint. */
+            if( ( xOTA_Agent.xPALCallbacks.xResumeFileForRx != NULL ) &&
+                ( pstUpdateFile->ulDeltaImageSize == 0U ) &&
+                ( pstUpdateFile->pucCompression == NULL ) )
+            {
+                /* Lend the active job name to the PAL for matching the checkpoint, as when saving it. */
+                pstUpdateFile->pucJobName = xOTA_Agent.pcOTA_Singleton_ActiveJobName;
+                xErr = xOTA_Agent.xPALCallbacks.xResumeFileForRx( pstUpdateFile, ulBitmapLen );
+                pstUpdateFile->pucJobName = NULL;
+            }
+
+            if( xErr == kOTA_Err_None )
+            {
+                prvResumeBlockBitmap( pstUpdateFile, ulNumBlocks, ulBitmapLen );
+                OTA_LOG_L1( "[%s] Resuming download, %u of %u blocks remaining.\r\n", OTA_METHOD_NAME,
+                            pstUpdateFile->ulBlocksRemaining,
+                            ulNumBlocks );
+            }
+            else
+            {
+                /* Create/Open the OTA file on the file system. */
+                xErr = xOTA_Agent.xPALCallbacks.xCreateFileForRx( pstUpdateFile );
+            }
+
+            #if ( otaconfigENABLE_DELTA_UPDATES == 1 )
+                /* A delta streams a patch that is applied against the running image as it arrives. */
+                if( ( xErr == kOTA_Err_None ) && ( pstUpdateFile->ulDeltaImageSize != 0U ) )
+                {
+                    xErr = prvStartDelta( pstUpdateFile );
+                }
+            #endif
+
+            #if ( otaconfigENABLE_COMPRESSED_FILES == 1 )
+                /* A compressed file is decompressed as it arrives, into the patch decoder if it is a delta. */
+                if( ( xErr == kOTA_Err_None ) && ( pstUpdateFile->pucCompression != NULL ) )
+                {
+                    xErr = prvStartDecompress( pstUpdateFile );
+                }
+            #endif
 
             if( xErr != kOTA_Err_None )
             {
@@ -2415,6 +2918,17 @@ static OTA_FileContext_t * prvGetFileContextFromJob( const char * pcRawMsg,
     return pstUpdateFile; /* Return the OTA file context. */
 }
 
+/* prvNumBlocks
+ *
+ * The number of blocks the file is streamed in. For a delta update this counts the patch,
+ * and for a compressed file the compressed bytes.
+ */
+
+static uint32_t prvNumBlocks( const OTA_FileContext_t * C )
+{
+    return ( C->ulFileSize + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE;
+}
+
 /*
  * prvValidateDataBlock
  *
@@ -2467,6 +2981,7 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
     size_t xPayloadSize = 0;
     uint32_t ulByte = 0;
     uint8_t ucBitMask = 0;
+    OTA_Err_t xErr = kOTA_Err_None;
 
     /* Check if the file context is NULL. */
     if( C == NULL )
@@ -2544,6 +3059,16 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
                 eIngestResult = eIngest_Result_Duplicate_Continue;
                 *pxCloseResult = kOTA_Err_None; /* This is a success path. */
             }
+            /* A patch can only be applied, and a compressed file decompressed, in order. Leave
+             * a block that is ahead of its turn unreceived so it is requested again. */
+            else if( ( ( xOTA_Agent.pxDelta != NULL ) || ( xOTA_Agent.pxDecompress != NULL ) ) &&
+                     ( ulBlockIndex != ( prvNumBlocks( C ) - C->ulBlocksRemaining ) ) )
+            {
+                OTA_LOG_L1( "[%s] Block %u is out of order.\r\n", OTA_METHOD_NAME, ulBlockIndex );
+
+                eIngestResult = eIngest_Result_OutOfOrder_Continue;
+                *pxCloseResult = kOTA_Err_None; /* This is a success path. */
+            }
         }
         else
         {
@@ -2557,7 +3082,29 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
     {
         if( C->pucFile != NULL )
         {
-            int32_t iBytesWritten = xOTA_Agent.xPALCallbacks.xWriteBlock( C, ( ulBlockIndex * OTA_FILE_BLOCK_SIZE ), pucPayload, ulBlockSize );
+            int32_t iBytesWritten;
+
+            #if ( otaconfigENABLE_COMPRESSED_FILES == 1 )
+                if( xOTA_Agent.pxDecompress != NULL )
+                {
+                    /* The decompressor writes the file, or feeds the patch decoder, as its output window fills. */
+                    xErr = OTA_Decompress_Apply( xOTA_Agent.pxDecompress, C, pucPayload, ulBlockSize );
+                    iBytesWritten = ( xErr == kOTA_Err_None ) ? ( int32_t ) ulBlockSize : -1;
+                }
+                else
+            #endif
+            #if ( otaconfigENABLE_DELTA_UPDATES == 1 )
+                if( xOTA_Agent.pxDelta != NULL )
+                {
+                    /* The rebuilt image is written by the patch decoder as its output windows fill. */
+                    xErr = OTA_Delta_Apply( xOTA_Agent.pxDelta, C, pucPayload, ulBlockSize );
+                    iBytesWritten = ( xErr == kOTA_Err_None ) ? ( int32_t ) ulBlockSize : -1;
+                }
+                else
+            #endif
+            {
+                iBytesWritten = xOTA_Agent.xPALCallbacks.xWriteBlock( C, ( ulBlockIndex * OTA_FILE_BLOCK_SIZE ), pucPayload, ulBlockSize );
+            }
 
             if( iBytesWritten < 0 )
             {
@@ -2570,6 +3117,17 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
                 C->ulBlocksRemaining--;
                 eIngestResult = eIngest_Result_Accepted_Continue;
                 *pxCloseResult = kOTA_Err_None;
+
+                /* Periodically let the PAL persist our progress so an interrupted download can resume.
+                 * There is nothing to save once the last block is in since the file is closed next. */
+                if( ( xOTA_Agent.xPALCallbacks.xSaveCheckpoint != NULL ) &&
+                    ( xOTA_Agent.pxDelta == NULL ) &&
+                    ( xOTA_Agent.pxDecompress == NULL ) &&
+                    ( C->ulBlocksRemaining != 0U ) &&
+                    ( ( C->ulBlocksRemaining % otaconfigCHECKPOINT_INTERVAL_BLOCKS ) == 0U ) )
+                {
+                    prvSaveCheckpoint( C );
+                }
             }
         }
         else
@@ -2590,7 +3148,31 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
             vPortFree( C->pucRxBlockBitmap ); /* Free the bitmap now that we're done with the download. */
             C->pucRxBlockBitmap = NULL;
 
-            if( C->pucFile != NULL )
+            /* Write out the tail of a decompressed file, then of a rebuilt delta image, before
+             * it is closed and authenticated. */
+            xErr = kOTA_Err_None;
+
+            #if ( otaconfigENABLE_COMPRESSED_FILES == 1 )
+                if( xOTA_Agent.pxDecompress != NULL )
+                {
+                    xErr = OTA_Decompress_Finish( xOTA_Agent.pxDecompress, C );
+                }
+            #endif
+
+            #if ( otaconfigENABLE_DELTA_UPDATES == 1 )
+                if( ( xErr == kOTA_Err_None ) && ( xOTA_Agent.pxDelta != NULL ) )
+                {
+                    xErr = OTA_Delta_Finish( xOTA_Agent.pxDelta, C );
+                }
+            #endif
+
+            if( xErr != kOTA_Err_None )
+            {
+                /* The file is aborted when the agent closes the context. */
+                *pxCloseResult = xErr;
+                eIngestResult = eIngest_Result_WriteBlockFailed;
+            }
+            else if( C->pucFile != NULL )
             {
                 *pxCloseResult = xOTA_Agent.xPALCallbacks.xCloseFile( C );
 
@@ -3153,6 +3735,47 @@ uint32_t OTA_GetPacketsReceived( void )
     return xOTA_Agent.xStatistics.ulOTA_PacketsReceived;
 }
 
+/*
+ * Return the network statistics of the control and data plane connections.
+ */
+OTA_Err_t OTA_GetNetworkStatistics( IotNetworkStatistics_t * pxControl,
+                                    IotNetworkStatistics_t * pxData )
+{
+    OTA_Err_t xErr = kOTA_Err_None;
+
+    if( xOTA_Agent.eState == eOTA_AgentState_Stopped )
+    {
+        xErr = kOTA_Err_OTAAgentStopped;
+    }
+
+    if( ( xErr == kOTA_Err_None ) && ( pxControl != NULL ) )
+    {
+        if( xOTA_ControlInterface.prvGetNetworkStatistics != NULL )
+        {
+            xErr = xOTA_ControlInterface.prvGetNetworkStatistics( &xOTA_Agent, pxControl );
+        }
+        else
+        {
+            xErr = kOTA_Err_NoNetworkStatistics;
+        }
+    }
+
+    /* The data interface is only set once a job selects a data protocol. */
+    if( ( xErr == kOTA_Err_None ) && ( pxData != NULL ) )
+    {
+        if( xOTA_DataInterface.prvGetNetworkStatistics != NULL )
+        {
+            xErr = xOTA_DataInterface.prvGetNetworkStatistics( &xOTA_Agent, pxData );
+        }
+        else
+        {
+            xErr = kOTA_Err_NoNetworkStatistics;
+        }
+    }
+
+    return xErr;
+}
+
 OTA_Err_t OTA_CheckForUpdate( void )
 {
     DEFINE_OTA_METHOD_NAME( "OTA_CheckForUpdate" );
@@ -55,11 +55,21 @@
 #else
     #define OTA_NUM_MSG_Q_ENTRIES    20U                   /* Maximum number of entries in the OTA message queue. */
 #endif
+#ifndef otaconfigCHECKPOINT_INTERVAL_BLOCKS
+    #define otaconfigCHECKPOINT_INTERVAL_BLOCKS    32U     /* Received blocks between download checkpoints when the PAL supports resuming. */
+#endif
+#ifndef otaconfigENABLE_DELTA_UPDATES
+    #define otaconfigENABLE_DELTA_UPDATES          0U      /* Set to 1 to apply delta updates. The build must then include aws_iot_ota_delta.c. */
+#endif
+#ifndef otaconfigENABLE_COMPRESSED_FILES
+    #define otaconfigENABLE_COMPRESSED_FILES       0U      /* Set to 1 to receive compressed files. The build must then include aws_iot_ota_decompress.c. */
+#endif
 
 /* Job document parser constants. */
-#define OTA_MAX_JSON_TOKENS         64U                                                                         /* Number of JSON tokens supported in a single parser call. */
+#define OTA_MAX_JSON_DEPTH          32U                                                                         /* Container nesting depth tracked by the parser. It is backed by a 32 bit longword bitmap by design. */
 #define OTA_MAX_JSON_STR_LEN        256U                                                                        /* Limit our JSON string compares to something small to avoid going into the weeds. */
 #define OTA_DOC_MODEL_MAX_PARAMS    32U                                                                         /* The parameter list is backed by a 32 bit longword bitmap by design. */
+#define OTA_DOC_MODEL_INDEX_SIZE    64U                                                                         /* Slots in the document model key index. Must be a power of 2 and larger than OTA_DOC_MODEL_MAX_PARAMS. */
 #define OTA_JOB_PARAM_REQUIRED      true                                                                        /* Used to denote a required document model parameter. */
 #define OTA_JOB_PARAM_OPTIONAL      false                                                                       /* Used to denote an optional document model parameter. */
 #define OTA_DONT_STORE_PARAM        0xffffffffUL                                                                /* If ulDestOffset in the model is 0xffffffff, do not store the value. */
@@ -91,6 +101,7 @@ typedef enum
     eIngest_Result_Uninitialized = -127,    /* Software BUG: We forgot to set the result code. */
     eIngest_Result_Accepted_Continue = 0,   /* The block was accepted and we're expecting more. */
     eIngest_Result_Duplicate_Continue = 1,  /* The block was a duplicate but that's OK. Continue. */
+    eIngest_Result_OutOfOrder_Continue = 2, /* A delta or compressed file block arrived ahead of its turn. It will be requested again. */
 } IngestResult_t;
 
 /* Generic JSON document parser errors. */
@@ -105,8 +116,7 @@ typedef enum
     eDocParseErr_InvalidNumChar,        /* There was an invalid character in a numeric value field. */
     eDocParseErr_DuplicatesNotAllowed,  /* A duplicate parameter was found in the job document. */
     eDocParseErr_MalformedDoc,          /* The document didn't fulfill the model requirements. */
-    eDocParseErr_JasmineCountMismatch,  /* The second pass of jsmn_parse() didn't match the first pass. */
-    eDocParseErr_TooManyTokens,         /* We can't support the number of JSON tokens in the document. */
+    eDocParseErr_TooManyTokens,         /* The JSON document nests deeper than OTA_MAX_JSON_DEPTH. */
     eDocParseErr_NoTokens,              /* No JSON tokens were detected in the document. */
     eDocParseErr_NullModelPointer,      /* The pointer to the document model was NULL. */
     eDocParseErr_NullBodyPointer,       /* The document model's internal body pointer was NULL. */
@@ -114,7 +124,7 @@ typedef enum
     eDocParseErr_TooManyParams,         /* The document model has more parameters than we can handle. */
     eDocParseErr_ParamKeyNotInModel,    /* The document model doesn't include the specified parameter key. */
     eDocParseErr_InvalidModelParamType, /* The document model specified an invalid parameter type. */
-    eDocParseErr_InvalidToken           /* The Jasmine token was invalid, producing a NULL pointer. */
+    eDocParseErr_InvalidToken           /* The JSON document contained a malformed token. */
 } DocParseErr_t;
 
 /* Document model parameter types used by the JSON document parser. */
@@ -167,6 +177,10 @@ typedef struct
  * document and where to store the parameters, if desired, in a destination context.
  * We currently only store parameters into an OTA_FileContext_t but it could be used
  * for any structure since we don't use a type pointer.
+ *
+ * The key index is built by prvInitDocModel() from the key names of the model body so
+ * the parser can resolve a JSON key with one hash probe instead of comparing it against
+ * every parameter.
  */
 typedef struct
 {
@@ -176,6 +190,7 @@ typedef struct
     uint16_t usNumModelParams;         /* The number of entries in the document model (limited to 32). */
     uint32_t ulParamsReceivedBitmap;   /* Bitmap of the parameters received based on the model. */
     uint32_t ulParamsRequiredBitmap;   /* Bitmap of the parameters required from the model. */
+    uint8_t ucKeyIndex[ OTA_DOC_MODEL_INDEX_SIZE ]; /* Key hash index into the model body. Slots hold the parameter index plus 1, or 0 if empty. */
 } JSON_DocModel_t;
 
 /*lint -esym(749,OTA_JobStatus_t::eJobStatus_Rejected) Until the Job Service supports it, this is unused. */
@@ -205,7 +220,7 @@ enum
  * size, attributes, etc. The following value specifies the number of parameters
  * that are included in the job document model although some may be optional. */
 
-#define OTA_NUM_JOB_PARAMS              ( 20 ) /* Number of parameters in the job document. */
+#define OTA_NUM_JOB_PARAMS              ( 24 ) /* Number of parameters in the job document. */
 
 /* Keys in OTA job doc . */
 #define OTA_JSON_CLIENT_TOKEN_KEY       "clientToken"
@@ -227,6 +242,10 @@ enum
 #define OTA_JSON_FILE_CERT_NAME_KEY     "certfile"
 #define OTA_JSON_UPDATE_DATA_URL_KEY    "update_data_url"
 #define OTA_JSON_AUTH_SCHEME_KEY        "auth_scheme"
+#define OTA_JSON_DELTA_SIZE_KEY         "delta_size"
+#define OTA_JSON_DELTA_BASE_KEY         "delta_base"
+#define OTA_JSON_COMPRESSION_KEY        "compression"
+#define OTA_JSON_UNCOMPRESSED_SIZE_KEY  "uncompressed_size"
 
 /* This is the OTA statistics structure to hold useful info. */
 
@@ -260,6 +279,8 @@ typedef struct ota_agent_context
     OTA_AgentStatistics_t xStatistics;                      /* The OTA agent statistics block. */
     SemaphoreHandle_t xOTA_ThreadSafetyMutex;               /* Mutex used to ensure thread safety while managing data buffers. */
     uint32_t ulRequestMomentum;                             /* The number of requests sent before a response was received. */
+    struct OTA_DeltaContext * pxDelta;                      /* Patch decoder of the current file if it is a delta update, else NULL. */
+    struct OTA_DecompressContext * pxDecompress;            /* Decompressor of the current file if it is compressed, else NULL. */
 } OTA_AgentContext_t;
 
 /* The OTA Agent event and data structures. */
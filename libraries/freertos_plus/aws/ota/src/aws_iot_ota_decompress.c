@@ -0,0 +1,255 @@
+/*
+ * FreeRTOS OTA V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_iot_ota_decompress.c
+ * @brief Streaming heatshrink decompression for AWS IoT Over-the-Air updates.
+ *
+ * heatshrink is LZSS over a bit stream, read most significant bit first. A 1 bit is
+ * followed by an 8 bit literal. A 0 bit is followed by a window_sz2 bit distance and a
+ * lookahead_sz2 bit length, each stored minus one, of a match in the window of recent
+ * output. The window starts out zeroed, as in the reference decoder.
+ */
+
+/* Standard library includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* OTA includes. */
+#include "aws_iot_ota_decompress.h"
+
+/* Decoder states. */
+#define OTA_DECOMPRESS_STATE_TAG        0U /* Waiting for a tag bit. */
+#define OTA_DECOMPRESS_STATE_LITERAL    1U /* Waiting for a literal byte. */
+#define OTA_DECOMPRESS_STATE_INDEX      2U /* Waiting for a match distance. */
+#define OTA_DECOMPRESS_STATE_COUNT      3U /* Waiting for a match length. */
+#define OTA_DECOMPRESS_STATE_BACKREF    4U /* Copying a match. */
+
+#define OTA_HEATSHRINK_WINDOW_MASK      ( OTA_HEATSHRINK_WINDOW_SIZE - 1UL )
+
+/*-----------------------------------------------------------*/
+
+/* Pass the decompressed bytes waiting in the output window on to the next stage. */
+
+static OTA_Err_t prvFlushOutput( OTA_DecompressContext_t * pxDecompress,
+                                 OTA_FileContext_t * const C )
+{
+    OTA_Err_t xErr = kOTA_Err_None;
+    int16_t sWritten;
+
+    if( pxDecompress->ulOutFill > 0U )
+    {
+        if( pxDecompress->pxDelta != NULL )
+        {
+            #if ( otaconfigENABLE_DELTA_UPDATES == 1 )
+                xErr = OTA_Delta_Apply( pxDecompress->pxDelta, C, pxDecompress->ucOut, pxDecompress->ulOutFill );
+            #else
+                xErr = kOTA_Err_GenericIngestError; /* The agent only starts a patch decoder when delta updates are enabled. */
+            #endif
+        }
+        else
+        {
+            sWritten = pxDecompress->xWriteBlock( C,
+                                                  pxDecompress->ulHead - pxDecompress->ulOutFill,
+                                                  pxDecompress->ucOut,
+                                                  pxDecompress->ulOutFill );
+
+            if( sWritten != ( int16_t ) pxDecompress->ulOutFill )
+            {
+                xErr = kOTA_Err_GenericIngestError | ( ( uint32_t ) sWritten & kOTA_PAL_ErrMask );
+            }
+        }
+
+        pxDecompress->ulOutFill = 0U;
+    }
+
+    return xErr;
+}
+
+/* Append one decompressed byte to the window and the output. */
+
+static OTA_Err_t prvEmit( OTA_DecompressContext_t * pxDecompress,
+                          OTA_FileContext_t * const C,
+                          uint8_t ucByte )
+{
+    OTA_Err_t xErr = kOTA_Err_None;
+
+    if( pxDecompress->ulHead >= pxDecompress->ulSize )
+    {
+        xErr = kOTA_Err_DecompressFailed;
+    }
+    else
+    {
+        pxDecompress->ucWindow[ pxDecompress->ulHead & OTA_HEATSHRINK_WINDOW_MASK ] = ucByte;
+        pxDecompress->ucOut[ pxDecompress->ulOutFill ] = ucByte;
+        pxDecompress->ulOutFill++;
+        pxDecompress->ulHead++;
+
+        if( pxDecompress->ulOutFill == OTA_FILE_BLOCK_SIZE )
+        {
+            xErr = prvFlushOutput( pxDecompress, C );
+        }
+    }
+
+    return xErr;
+}
+
+/* Take ulCount bits from the bit buffer. The caller checks there are enough. */
+
+static uint32_t prvTakeBits( OTA_DecompressContext_t * pxDecompress,
+                             uint32_t ulCount )
+{
+    pxDecompress->ulBitCount -= ulCount;
+
+    return ( pxDecompress->ulBits >> pxDecompress->ulBitCount ) & ( ( 1UL << ulCount ) - 1UL );
+}
+
+/*-----------------------------------------------------------*/
+
+void OTA_Decompress_Init( OTA_DecompressContext_t * pxDecompress,
+                          const OTA_FileContext_t * C,
+                          pxOTAPALWriteBlockCallback_t xWriteBlock,
+                          OTA_DeltaContext_t * pxDelta )
+{
+    ( void ) memset( pxDecompress, 0, sizeof( OTA_DecompressContext_t ) );
+
+    pxDecompress->xWriteBlock = xWriteBlock;
+    pxDecompress->pxDelta = pxDelta;
+    pxDecompress->ulState = OTA_DECOMPRESS_STATE_TAG;
+    pxDecompress->ulSize = C->ulUncompressedSize;
+}
+
+OTA_Err_t OTA_Decompress_Apply( OTA_DecompressContext_t * pxDecompress,
+                                OTA_FileContext_t * const C,
+                                const uint8_t * pucData,
+                                uint32_t ulDataLen )
+{
+    OTA_Err_t xErr = kOTA_Err_None;
+    uint32_t ulIndex = 0U;
+    uint32_t ulNeed;
+    uint8_t ucByte;
+
+    while( xErr == kOTA_Err_None )
+    {
+        /* Number of bits the current state needs before it can move on. */
+        switch( pxDecompress->ulState )
+        {
+            case OTA_DECOMPRESS_STATE_TAG:
+                ulNeed = 1U;
+                break;
+
+            case OTA_DECOMPRESS_STATE_LITERAL:
+                ulNeed = 8U;
+                break;
+
+            case OTA_DECOMPRESS_STATE_INDEX:
+                ulNeed = otaconfigHEATSHRINK_WINDOW_SZ2;
+                break;
+
+            case OTA_DECOMPRESS_STATE_COUNT:
+                ulNeed = otaconfigHEATSHRINK_LOOKAHEAD_SZ2;
+                break;
+
+            default:
+                ulNeed = 0U;
+                break;
+        }
+
+        if( pxDecompress->ulBitCount < ulNeed )
+        {
+            if( ulIndex == ulDataLen )
+            {
+                break; /* Wait for the next block. */
+            }
+
+            pxDecompress->ulBits = ( pxDecompress->ulBits << 8 ) | pucData[ ulIndex ];
+            pxDecompress->ulBitCount += 8U;
+            ulIndex++;
+            continue;
+        }
+
+        switch( pxDecompress->ulState )
+        {
+            case OTA_DECOMPRESS_STATE_TAG:
+                pxDecompress->ulState = ( prvTakeBits( pxDecompress, 1U ) != 0U ) ? OTA_DECOMPRESS_STATE_LITERAL : OTA_DECOMPRESS_STATE_INDEX;
+                break;
+
+            case OTA_DECOMPRESS_STATE_LITERAL:
+                xErr = prvEmit( pxDecompress, C, ( uint8_t ) prvTakeBits( pxDecompress, 8U ) );
+                pxDecompress->ulState = OTA_DECOMPRESS_STATE_TAG;
+                break;
+
+            case OTA_DECOMPRESS_STATE_INDEX:
+                pxDecompress->ulBackrefIndex = prvTakeBits( pxDecompress, otaconfigHEATSHRINK_WINDOW_SZ2 ) + 1U;
+                pxDecompress->ulState = OTA_DECOMPRESS_STATE_COUNT;
+                break;
+
+            case OTA_DECOMPRESS_STATE_COUNT:
+                pxDecompress->ulBackrefCount = prvTakeBits( pxDecompress, otaconfigHEATSHRINK_LOOKAHEAD_SZ2 ) + 1U;
+                pxDecompress->ulState = OTA_DECOMPRESS_STATE_BACKREF;
+                break;
+
+            default:
+
+                /* Copy the match one byte at a time since it may overlap its own output. */
+                while( ( xErr == kOTA_Err_None ) && ( pxDecompress->ulBackrefCount > 0U ) )
+                {
+                    ucByte = pxDecompress->ucWindow[ ( pxDecompress->ulHead - pxDecompress->ulBackrefIndex ) & OTA_HEATSHRINK_WINDOW_MASK ];
+                    xErr = prvEmit( pxDecompress, C, ucByte );
+                    pxDecompress->ulBackrefCount--;
+                }
+
+                pxDecompress->ulState = OTA_DECOMPRESS_STATE_TAG;
+                break;
+        }
+    }
+
+    return xErr;
+}
+
+OTA_Err_t OTA_Decompress_Finish( OTA_DecompressContext_t * pxDecompress,
+                                 OTA_FileContext_t * const C )
+{
+    DEFINE_OTA_METHOD_NAME( "OTA_Decompress_Finish" );
+
+    OTA_Err_t xErr = kOTA_Err_None;
+
+    /* Only the zero padding of the last byte may be left over. */
+    if( pxDecompress->ulHead != pxDecompress->ulSize )
+    {
+        OTA_LOG_L1( "[%s] Error: File decompressed to %u bytes, expected %u.\r\n", OTA_METHOD_NAME,
+                    pxDecompress->ulHead,
+                    pxDecompress->ulSize );
+        xErr = kOTA_Err_DecompressFailed;
+    }
+    else
+    {
+        xErr = prvFlushOutput( pxDecompress, C );
+    }
+
+    return xErr;
+}
@@ -0,0 +1,99 @@
+/*
+ * FreeRTOS OTA V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#ifndef __AWS_OTADECOMPRESS__H__
+#define __AWS_OTADECOMPRESS__H__
+
+#include "aws_iot_ota_agent.h"
+#include "aws_iot_ota_agent_internal.h"
+#include "aws_iot_ota_delta.h"
+
+/* Name of the compression scheme in the job document. */
+#define OTA_COMPRESSION_HEATSHRINK    "heatshrink"
+
+/* The heatshrink window and lookahead sizes (log 2) the file was compressed with, i.e.
+ * "heatshrink -w 10 -l 4". The window is the decompressor's dictionary and is held in RAM. */
+#ifndef otaconfigHEATSHRINK_WINDOW_SZ2
+    #define otaconfigHEATSHRINK_WINDOW_SZ2       10U
+#endif
+#ifndef otaconfigHEATSHRINK_LOOKAHEAD_SZ2
+    #define otaconfigHEATSHRINK_LOOKAHEAD_SZ2    4U
+#endif
+
+#define OTA_HEATSHRINK_WINDOW_SIZE    ( 1UL << otaconfigHEATSHRINK_WINDOW_SZ2 )
+
+/**
+ * @brief State of a file being decompressed.
+ *
+ * Decompressed bytes collect in an OTA_FILE_BLOCK_SIZE window. Each full window goes to
+ * the patch decoder of a delta update, or else straight to the write block callback at
+ * a block aligned offset.
+ */
+typedef struct OTA_DecompressContext
+{
+    pxOTAPALWriteBlockCallback_t xWriteBlock;           /* Writes the decompressed file. */
+    OTA_DeltaContext_t * pxDelta;                       /* Patch decoder fed instead, or NULL. */
+    uint32_t ulState;                                   /* Decoder state, see aws_iot_ota_decompress.c. */
+    uint32_t ulBits;                                    /* Input bits not yet consumed, right aligned. */
+    uint32_t ulBitCount;                                /* Number of valid bits in ulBits. */
+    uint32_t ulBackrefIndex;                            /* Distance back into the window of the current match. */
+    uint32_t ulBackrefCount;                            /* Bytes of the current match left to copy. */
+    uint32_t ulHead;                                    /* Total bytes decompressed, also the window head. */
+    uint32_t ulSize;                                    /* Expected size once decompressed. */
+    uint32_t ulOutFill;                                 /* Bytes waiting in ucOut. */
+    uint8_t ucWindow[ OTA_HEATSHRINK_WINDOW_SIZE ];     /* The most recent decompressed bytes. */
+    uint8_t ucOut[ OTA_FILE_BLOCK_SIZE ];               /* Decompressed bytes not yet passed on. */
+} OTA_DecompressContext_t;
+
+/**
+ * @brief Start decompressing the specified file.
+ *
+ * @param[in] pxDelta Patch decoder to feed for a compressed delta update, or NULL.
+ */
+void OTA_Decompress_Init( OTA_DecompressContext_t * pxDecompress,
+                          const OTA_FileContext_t * C,
+                          pxOTAPALWriteBlockCallback_t xWriteBlock,
+                          OTA_DeltaContext_t * pxDelta );
+
+/**
+ * @brief Decompress the next piece of the file. Compressed bytes must be supplied in order.
+ *
+ * @return kOTA_Err_None, kOTA_Err_DecompressFailed if the data decompresses past the
+ * expected size, or the error of the next stage.
+ */
+OTA_Err_t OTA_Decompress_Apply( OTA_DecompressContext_t * pxDecompress,
+                                OTA_FileContext_t * const C,
+                                const uint8_t * pucData,
+                                uint32_t ulDataLen );
+
+/**
+ * @brief Pass on the last partial window once the whole file has been received.
+ *
+ * @return kOTA_Err_None if the file decompressed to exactly its expected size.
+ */
+OTA_Err_t OTA_Decompress_Finish( OTA_DecompressContext_t * pxDecompress,
+                                 OTA_FileContext_t * const C );
+
+#endif /* ifndef __AWS_OTADECOMPRESS__H__ */
@@ -0,0 +1,397 @@
+/*
+ * FreeRTOS OTA V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_iot_ota_delta.c
+ * @brief Streaming delta patch application for AWS IoT Over-the-Air updates.
+ */
+
+/* Standard library includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* OTA includes. */
+#include "aws_iot_ota_delta.h"
+
+/* mbedTLS includes. */
+#include "mbedtls/sha256.h"
+
+/* Decoder states. */
+#define OTA_DELTA_STATE_HEADER     0U /* Staging the patch header. */
+#define OTA_DELTA_STATE_CONTROL    1U /* Staging a control record. */
+#define OTA_DELTA_STATE_DIFF       2U /* Adding diff bytes to the base image. */
+#define OTA_DELTA_STATE_EXTRA      3U /* Copying extra bytes. */
+#define OTA_DELTA_STATE_FAILED     4U /* The patch was rejected. Nothing more is accepted. */
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvReadLE32( const uint8_t * pucBuf )
+{
+    return ( uint32_t ) pucBuf[ 0 ] |
+           ( ( uint32_t ) pucBuf[ 1 ] << 8 ) |
+           ( ( uint32_t ) pucBuf[ 2 ] << 16 ) |
+           ( ( uint32_t ) pucBuf[ 3 ] << 24 );
+}
+
+/* Convert a hex digit to its value, or 0xff if it isn't one. */
+
+static uint8_t prvHexDigit( uint8_t ucChar )
+{
+    uint8_t ucValue = 0xffU;
+
+    if( ( ucChar >= ( uint8_t ) '0' ) && ( ucChar <= ( uint8_t ) '9' ) )
+    {
+        ucValue = ucChar - ( uint8_t ) '0';
+    }
+    else if( ( ucChar >= ( uint8_t ) 'a' ) && ( ucChar <= ( uint8_t ) 'f' ) )
+    {
+        ucValue = ucChar - ( uint8_t ) 'a' + 10U;
+    }
+    else if( ( ucChar >= ( uint8_t ) 'A' ) && ( ucChar <= ( uint8_t ) 'F' ) )
+    {
+        ucValue = ucChar - ( uint8_t ) 'A' + 10U;
+    }
+
+    return ucValue;
+}
+
+/* Write the rebuilt bytes waiting in the output window. */
+
+static OTA_Err_t prvFlushOutput( OTA_DeltaContext_t * pxDelta,
+                                 OTA_FileContext_t * const C )
+{
+    OTA_Err_t xErr = kOTA_Err_None;
+    uint32_t ulOffset;
+    int16_t sWritten;
+
+    if( pxDelta->ulOutFill > 0U )
+    {
+        ulOffset = pxDelta->ulNewPos - pxDelta->ulOutFill;
+        sWritten = pxDelta->xWriteBlock( C, ulOffset, pxDelta->ucOut, pxDelta->ulOutFill );
+
+        if( sWritten != ( int16_t ) pxDelta->ulOutFill )
+        {
+            xErr = kOTA_Err_GenericIngestError | ( ( uint32_t ) sWritten & kOTA_PAL_ErrMask );
+        }
+
+        pxDelta->ulOutFill = 0U;
+    }
+
+    return xErr;
+}
+
+/* Make sure the base window holds the current base position. Returns the number of
+ * base bytes available from there, or 0 if the position is past the end of the base. */
+
+static uint32_t prvBaseAvailable( OTA_DeltaContext_t * pxDelta )
+{
+    int32_t lRead;
+
+    if( ( pxDelta->ulOldPos < pxDelta->ulBaseStart ) ||
+        ( pxDelta->ulOldPos >= ( pxDelta->ulBaseStart + pxDelta->ulBaseLen ) ) )
+    {
+        lRead = pxDelta->xReadBaseImage( pxDelta->ulOldPos, pxDelta->ucBase, ( uint32_t ) sizeof( pxDelta->ucBase ) );
+        pxDelta->ulBaseStart = pxDelta->ulOldPos;
+        pxDelta->ulBaseLen = ( lRead > 0 ) ? ( uint32_t ) lRead : 0U;
+    }
+
+    return pxDelta->ulBaseLen - ( pxDelta->ulOldPos - pxDelta->ulBaseStart );
+}
+
+/* Check the running image against the base hash named by the job. */
+
+static OTA_Err_t prvCheckBaseImage( OTA_DeltaContext_t * pxDelta,
+                                    const uint8_t * pucBaseHex )
+{
+    DEFINE_OTA_METHOD_NAME( "prvCheckBaseImage" );
+
+    OTA_Err_t xErr = kOTA_Err_None;
+    mbedtls_sha256_context xSHA256Context;
+    uint8_t ucExpected[ OTA_DELTA_BASE_HASH_SIZE ];
+    uint8_t ucActual[ OTA_DELTA_BASE_HASH_SIZE ];
+    uint8_t ucHigh, ucLow;
+    uint32_t ulOffset = 0U;
+    uint32_t ulIndex;
+    int32_t lRead;
+
+    if( ( pucBaseHex == NULL ) || ( strlen( ( const char * ) pucBaseHex ) != ( 2U * OTA_DELTA_BASE_HASH_SIZE ) ) )
+    {
+        xErr = kOTA_Err_DeltaBaseMismatch;
+    }
+
+    for( ulIndex = 0U; ( xErr == kOTA_Err_None ) && ( ulIndex < OTA_DELTA_BASE_HASH_SIZE ); ulIndex++ )
+    {
+        ucHigh = prvHexDigit( pucBaseHex[ 2U * ulIndex ] );
+        ucLow = prvHexDigit( pucBaseHex[ ( 2U * ulIndex ) + 1U ] );
+
+        if( ( ucHigh > 0x0fU ) || ( ucLow > 0x0fU ) )
+        {
+            xErr = kOTA_Err_DeltaBaseMismatch;
+        }
+        else
+        {
+            ucExpected[ ulIndex ] = ( uint8_t ) ( ( ucHigh << 4 ) | ucLow );
+        }
+    }
+
+    if( xErr == kOTA_Err_None )
+    {
+        /* Hash the whole running image through the base window. */
+        mbedtls_sha256_init( &xSHA256Context );
+        ( void ) mbedtls_sha256_starts_ret( &xSHA256Context, 0 );
+
+        do
+        {
+            lRead = pxDelta->xReadBaseImage( ulOffset, pxDelta->ucBase, ( uint32_t ) sizeof( pxDelta->ucBase ) );
+
+            if( lRead > 0 )
+            {
+                ( void ) mbedtls_sha256_update_ret( &xSHA256Context, pxDelta->ucBase, ( size_t ) lRead );
+                ulOffset += ( uint32_t ) lRead;
+            }
+        } while( lRead == ( int32_t ) sizeof( pxDelta->ucBase ) );
+
+        ( void ) mbedtls_sha256_finish_ret( &xSHA256Context, ucActual );
+        mbedtls_sha256_free( &xSHA256Context );
+
+        if( ( lRead < 0 ) || ( memcmp( ucExpected, ucActual, sizeof( ucActual ) ) != 0 ) )
+        {
+            xErr = kOTA_Err_DeltaBaseMismatch;
+        }
+    }
+
+    if( xErr != kOTA_Err_None )
+    {
+        OTA_LOG_L1( "[%s] Error: The running image is not the base of this patch.\r\n", OTA_METHOD_NAME );
+    }
+
+    return xErr;
+}
+
+/*-----------------------------------------------------------*/
+
+OTA_Err_t OTA_Delta_Init( OTA_DeltaContext_t * pxDelta,
+                          const OTA_FileContext_t * C,
+                          pxOTAPALWriteBlockCallback_t xWriteBlock,
+                          pxOTAPALReadBaseImageCallback_t xReadBaseImage )
+{
+    ( void ) memset( pxDelta, 0, sizeof( OTA_DeltaContext_t ) );
+
+    pxDelta->xWriteBlock = xWriteBlock;
+    pxDelta->xReadBaseImage = xReadBaseImage;
+    pxDelta->ulState = OTA_DELTA_STATE_HEADER;
+    pxDelta->ulImageSize = C->ulDeltaImageSize;
+
+    return prvCheckBaseImage( pxDelta, C->pucDeltaBase );
+}
+
+OTA_Err_t OTA_Delta_Apply( OTA_DeltaContext_t * pxDelta,
+                           OTA_FileContext_t * const C,
+                           const uint8_t * pucPatch,
+                           uint32_t ulPatchLen )
+{
+    DEFINE_OTA_METHOD_NAME( "OTA_Delta_Apply" );
+
+    OTA_Err_t xErr = kOTA_Err_None;
+    uint32_t ulStageSize;
+    uint32_t ulCount;
+    uint32_t ulBase;
+    uint32_t ulIndex;
+    uint32_t ulState;
+    uint8_t * pucOut;
+    const uint8_t * pucBase;
+
+    if( pxDelta->ulState == OTA_DELTA_STATE_FAILED )
+    {
+        xErr = kOTA_Err_DeltaPatchInvalid;
+    }
+
+    while( ( xErr == kOTA_Err_None ) && ( ulPatchLen > 0U ) )
+    {
+        ulCount = 0U;
+        ulState = pxDelta->ulState;
+
+        if( ( ulState == OTA_DELTA_STATE_HEADER ) || ( ulState == OTA_DELTA_STATE_CONTROL ) )
+        {
+            /* Fixed size fields may straddle two blocks, so collect them first. */
+            ulStageSize = ( ulState == OTA_DELTA_STATE_HEADER ) ? OTA_DELTA_HEADER_SIZE : OTA_DELTA_CONTROL_SIZE;
+            ulCount = ulStageSize - pxDelta->ulStaged;
+            ulCount = ( ulCount < ulPatchLen ) ? ulCount : ulPatchLen;
+            ( void ) memcpy( &pxDelta->ucStage[ pxDelta->ulStaged ], pucPatch, ulCount );
+            pxDelta->ulStaged += ulCount;
+
+            if( pxDelta->ulStaged == ulStageSize )
+            {
+                pxDelta->ulStaged = 0U;
+
+                if( ulState == OTA_DELTA_STATE_HEADER )
+                {
+                    if( ( memcmp( pxDelta->ucStage, OTA_DELTA_MAGIC, OTA_DELTA_MAGIC_SIZE ) != 0 ) ||
+                        ( prvReadLE32( &pxDelta->ucStage[ OTA_DELTA_MAGIC_SIZE ] ) != pxDelta->ulImageSize ) )
+                    {
+                        OTA_LOG_L1( "[%s] Error: Bad patch header.\r\n", OTA_METHOD_NAME );
+                        xErr = kOTA_Err_DeltaPatchInvalid;
+                    }
+
+                    pxDelta->ulState = OTA_DELTA_STATE_CONTROL;
+                }
+                else
+                {
+                    pxDelta->ulDiffLeft = prvReadLE32( &pxDelta->ucStage[ 0 ] );
+                    pxDelta->ulExtraLeft = prvReadLE32( &pxDelta->ucStage[ 4 ] );
+                    pxDelta->lSeek = ( int32_t ) prvReadLE32( &pxDelta->ucStage[ 8 ] );
+
+                    /* A record may never build past the end of the image. */
+                    if( ( pxDelta->ulDiffLeft > ( pxDelta->ulImageSize - pxDelta->ulNewPos ) ) ||
+                        ( pxDelta->ulExtraLeft > ( pxDelta->ulImageSize - pxDelta->ulNewPos - pxDelta->ulDiffLeft ) ) )
+                    {
+                        OTA_LOG_L1( "[%s] Error: Patch record overruns the image.\r\n", OTA_METHOD_NAME );
+                        xErr = kOTA_Err_DeltaPatchInvalid;
+                    }
+
+                    if( ( pxDelta->ulDiffLeft == 0U ) && ( pxDelta->ulExtraLeft == 0U ) )
+                    {
+                        /* An empty record only moves the base position. It may be the last one
+                         * of the patch, with no more bytes to drive the diff and extra states. */
+                        pxDelta->ulOldPos = ( uint32_t ) ( ( int32_t ) pxDelta->ulOldPos + pxDelta->lSeek );
+                    }
+                    else
+                    {
+                        pxDelta->ulState = OTA_DELTA_STATE_DIFF;
+                    }
+                }
+            }
+
+            pucPatch += ulCount;
+            ulPatchLen -= ulCount;
+        }
+        else if( ulState == OTA_DELTA_STATE_DIFF )
+        {
+            /* Bounded by the patch bytes at hand, the room in the output window and the cached base window. */
+            ulCount = ( pxDelta->ulDiffLeft < ulPatchLen ) ? pxDelta->ulDiffLeft : ulPatchLen;
+            ulCount = ( ulCount < ( OTA_FILE_BLOCK_SIZE - pxDelta->ulOutFill ) ) ? ulCount : ( OTA_FILE_BLOCK_SIZE - pxDelta->ulOutFill );
+
+            if( ulCount > 0U )
+            {
+                ulBase = prvBaseAvailable( pxDelta );
+
+                if( ulBase == 0U )
+                {
+                    OTA_LOG_L1( "[%s] Error: Patch reads past the end of the base image.\r\n", OTA_METHOD_NAME );
+                    xErr = kOTA_Err_DeltaPatchInvalid;
+                    ulCount = 0U;
+                }
+
+                ulCount = ( ulCount < ulBase ) ? ulCount : ulBase;
+                pucOut = &pxDelta->ucOut[ pxDelta->ulOutFill ];
+                pucBase = &pxDelta->ucBase[ pxDelta->ulOldPos - pxDelta->ulBaseStart ];
+
+                for( ulIndex = 0U; ulIndex < ulCount; ulIndex++ )
+                {
+                    pucOut[ ulIndex ] = ( uint8_t ) ( pucPatch[ ulIndex ] + pucBase[ ulIndex ] );
+                }
+
+                pxDelta->ulDiffLeft -= ulCount;
+                pxDelta->ulOldPos += ulCount;
+            }
+
+            if( pxDelta->ulDiffLeft == 0U )
+            {
+                pxDelta->ulState = OTA_DELTA_STATE_EXTRA;
+            }
+        }
+        else if( ulState == OTA_DELTA_STATE_EXTRA )
+        {
+            ulCount = ( pxDelta->ulExtraLeft < ulPatchLen ) ? pxDelta->ulExtraLeft : ulPatchLen;
+            ulCount = ( ulCount < ( OTA_FILE_BLOCK_SIZE - pxDelta->ulOutFill ) ) ? ulCount : ( OTA_FILE_BLOCK_SIZE - pxDelta->ulOutFill );
+            ( void ) memcpy( &pxDelta->ucOut[ pxDelta->ulOutFill ], pucPatch, ulCount );
+            pxDelta->ulExtraLeft -= ulCount;
+        }
+        else
+        {
+            xErr = kOTA_Err_DeltaPatchInvalid;
+        }
+
+        if( ( ulState == OTA_DELTA_STATE_DIFF ) || ( ulState == OTA_DELTA_STATE_EXTRA ) )
+        {
+            /* The bytes just produced are rebuilt image. Write the window out once it is full. */
+            pucPatch += ulCount;
+            ulPatchLen -= ulCount;
+            pxDelta->ulOutFill += ulCount;
+            pxDelta->ulNewPos += ulCount;
+
+            if( pxDelta->ulOutFill == OTA_FILE_BLOCK_SIZE )
+            {
+                xErr = ( xErr == kOTA_Err_None ) ? prvFlushOutput( pxDelta, C ) : xErr;
+            }
+
+            if( ( pxDelta->ulState == OTA_DELTA_STATE_EXTRA ) && ( pxDelta->ulExtraLeft == 0U ) )
+            {
+                /* The record is done. Move the base position for the next one. */
+                pxDelta->ulOldPos = ( uint32_t ) ( ( int32_t ) pxDelta->ulOldPos + pxDelta->lSeek );
+                pxDelta->ulState = OTA_DELTA_STATE_CONTROL;
+            }
+        }
+    }
+
+    if( xErr != kOTA_Err_None )
+    {
+        pxDelta->ulState = OTA_DELTA_STATE_FAILED;
+    }
+
+    return xErr;
+}
+
+OTA_Err_t OTA_Delta_Finish( OTA_DeltaContext_t * pxDelta,
+                            OTA_FileContext_t * const C )
+{
+    DEFINE_OTA_METHOD_NAME( "OTA_Delta_Finish" );
+
+    OTA_Err_t xErr = kOTA_Err_None;
+
+    if( ( pxDelta->ulState != OTA_DELTA_STATE_CONTROL ) || ( pxDelta->ulStaged != 0U ) )
+    {
+        xErr = kOTA_Err_DeltaPatchInvalid;
+    }
+    else
+    {
+        xErr = prvFlushOutput( pxDelta, C );
+
+        if( ( xErr == kOTA_Err_None ) && ( pxDelta->ulNewPos != pxDelta->ulImageSize ) )
+        {
+            xErr = kOTA_Err_DeltaPatchInvalid;
+        }
+    }
+
+    if( xErr != kOTA_Err_None )
+    {
+        OTA_LOG_L1( "[%s] Error: Patch ended before the image was rebuilt (0x%08x).\r\n", OTA_METHOD_NAME, xErr );
+        pxDelta->ulState = OTA_DELTA_STATE_FAILED;
+    }
+
+    return xErr;
+}
@@ -0,0 +1,115 @@
+/*
+ * FreeRTOS OTA V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#ifndef __AWS_OTADELTA__H__
+#define __AWS_OTADELTA__H__
+
+#include "aws_iot_ota_agent.h"
+#include "aws_iot_ota_agent_internal.h"
+
+/**
+ * @brief Delta patch format.
+ *
+ * A delta job streams a patch instead of the image. The patch is bsdiff style but
+ * uncompressed, so it can be applied front to back as the blocks arrive:
+ *
+ *   header:  8 byte magic "OTADLT01", uint32 size of the rebuilt image
+ *   records: uint32 diff length, uint32 extra length, int32 base seek
+ *            diff bytes, each added (mod 256) to the next base image byte
+ *            extra bytes, copied to the image as they are
+ *
+ * All integers are little endian. After the diff bytes of a record the base
+ * position has advanced by the diff length; the seek is then added to it.
+ */
+#define OTA_DELTA_MAGIC           "OTADLT01"
+#define OTA_DELTA_MAGIC_SIZE      8U
+#define OTA_DELTA_HEADER_SIZE     12U /* Magic and image size. */
+#define OTA_DELTA_CONTROL_SIZE    12U /* One record's diff length, extra length and seek. */
+#define OTA_DELTA_BASE_HASH_SIZE  32U /* SHA-256 of the base image. */
+
+/**
+ * @brief State of a patch being applied.
+ *
+ * The rebuilt image goes out through the write block callback in OTA_FILE_BLOCK_SIZE
+ * windows at block aligned offsets, just like a full image would. The base image is
+ * read through a window of the same size.
+ */
+typedef struct OTA_DeltaContext
+{
+    pxOTAPALWriteBlockCallback_t xWriteBlock;         /* Writes the rebuilt image. */
+    pxOTAPALReadBaseImageCallback_t xReadBaseImage;   /* Reads the running image. */
+    uint32_t ulState;                                 /* Decoder state, see aws_iot_ota_delta.c. */
+    uint32_t ulImageSize;                             /* Size of the image being rebuilt. */
+    uint32_t ulNewPos;                                /* Bytes of the image rebuilt so far. */
+    uint32_t ulOldPos;                                /* Current position in the base image. */
+    uint32_t ulDiffLeft;                              /* Diff bytes left in the current record. */
+    uint32_t ulExtraLeft;                             /* Extra bytes left in the current record. */
+    int32_t lSeek;                                    /* Base seek of the current record. */
+    uint32_t ulStaged;                                /* Header or control bytes staged so far. */
+    uint8_t ucStage[ OTA_DELTA_HEADER_SIZE ];         /* Header or control record split across blocks. */
+    uint32_t ulOutFill;                               /* Bytes waiting in ucOut. */
+    uint32_t ulBaseStart;                             /* Base image offset of ucBase. */
+    uint32_t ulBaseLen;                               /* Valid bytes in ucBase. */
+    uint8_t ucOut[ OTA_FILE_BLOCK_SIZE ];             /* Rebuilt bytes not yet written. */
+    uint8_t ucBase[ OTA_FILE_BLOCK_SIZE ];            /* Cached window of the base image. */
+} OTA_DeltaContext_t;
+
+/**
+ * @brief Start applying a patch for the specified file.
+ *
+ * Checks that the running image hashes to C->pucDeltaBase (a hex SHA-256) so the
+ * patch is never applied against the wrong base.
+ *
+ * @return kOTA_Err_None, or kOTA_Err_DeltaBaseMismatch if the running image is not
+ * the base the patch was made against.
+ */
+OTA_Err_t OTA_Delta_Init( OTA_DeltaContext_t * pxDelta,
+                          const OTA_FileContext_t * C,
+                          pxOTAPALWriteBlockCallback_t xWriteBlock,
+                          pxOTAPALReadBaseImageCallback_t xReadBaseImage );
+
+/**
+ * @brief Apply the next piece of the patch.
+ *
+ * Patch bytes must be supplied in order. Rebuilt bytes are written as whole windows
+ * fill up.
+ *
+ * @return kOTA_Err_None, or kOTA_Err_DeltaPatchInvalid if the patch is malformed or
+ * the base image could not be read, or the write block error.
+ */
+OTA_Err_t OTA_Delta_Apply( OTA_DeltaContext_t * pxDelta,
+                           OTA_FileContext_t * const C,
+                           const uint8_t * pucPatch,
+                           uint32_t ulPatchLen );
+
+/**
+ * @brief Write out the last partial window once the whole patch has been applied.
+ *
+ * @return kOTA_Err_None if the image was rebuilt to its full size.
+ */
+OTA_Err_t OTA_Delta_Finish( OTA_DeltaContext_t * pxDelta,
+                            OTA_FileContext_t * const C );
+
+#endif /* ifndef __AWS_OTADELTA__H__ */
@@ -75,6 +75,7 @@ void prvSetControlInterface( OTA_ControlInterface_t * pxControlInterface )
         pxControlInterface->prvRequestJob = prvRequestJob_Mqtt;
         pxControlInterface->prvUpdateJobStatus = prvUpdateJobStatus_Mqtt;
         pxControlInterface->prvCleanup = prvCleanupControl_Mqtt;
+        pxControlInterface->prvGetNetworkStatistics = prvGetNetworkStatistics_Mqtt;
     #else
     #error "Enable MQTT control as control operations are only supported over MQTT."
     #endif
@@ -99,6 +100,7 @@ OTA_Err_t prvSetDataInterface( OTA_DataInterface_t * pxDataInterface,
                     pxDataInterface->prvRequestFileBlock = prvRequestFileBlock_Mqtt;
                     pxDataInterface->prvDecodeFileBlock = prvDecodeFileBlock_Mqtt;
                     pxDataInterface->prvCleanup = prvCleanupData_Mqtt;
+                    pxDataInterface->prvGetNetworkStatistics = prvGetNetworkStatistics_Mqtt;
 
                     OTA_LOG_L1( "[%s] Data interface is set to MQTT.\r\n", OTA_METHOD_NAME );
 
@@ -114,6 +116,7 @@ OTA_Err_t prvSetDataInterface( OTA_DataInterface_t * pxDataInterface,
                     pxDataInterface->prvRequestFileBlock = _AwsIotOTA_RequestDataBlock_HTTP;
                     pxDataInterface->prvDecodeFileBlock = _AwsIotOTA_DecodeFileBlock_HTTP;
                     pxDataInterface->prvCleanup = _AwsIotOTA_CleanupData_HTTP;
+                    pxDataInterface->prvGetNetworkStatistics = _AwsIotOTA_GetNetworkStatistics_HTTP;
 
                     OTA_LOG_L1( "[%s] Data interface is set to HTTP.\r\n", OTA_METHOD_NAME );
 
@@ -55,6 +55,8 @@ typedef struct
                                         int32_t lReason,
                                         int32_t lSubReason );
     OTA_Err_t ( * prvCleanup )( OTA_AgentContext_t * pAgentCtx );
+    OTA_Err_t ( * prvGetNetworkStatistics )( OTA_AgentContext_t * pAgentCtx,
+                                             IotNetworkStatistics_t * pxStatistics );
 } OTA_ControlInterface_t;
 
 /**
@@ -75,6 +77,8 @@ typedef struct
                                         uint8_t ** ppucPayload,
                                         size_t * pxPayloadSize );
     OTA_Err_t ( * prvCleanup )( OTA_AgentContext_t * pAgentCtx );
+    OTA_Err_t ( * prvGetNetworkStatistics )( OTA_AgentContext_t * pAgentCtx,
+                                             IotNetworkStatistics_t * pxStatistics );
 } OTA_DataInterface_t;
 
 /**
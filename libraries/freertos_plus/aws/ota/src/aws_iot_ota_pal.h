@@ -64,6 +64,10 @@ OTA_Err_t prvPAL_Abort( OTA_FileContext_t * const C );
  * The device file path is a required field in the OTA job document, so C->pucFilePath is
  * checked for NULL by the OTA agent before this function is called.
  *
+ * @note Compressed files are only received if otaconfigENABLE_COMPRESSED_FILES is set to 1
+ * and the PAL sets OTA_PAL_Callbacks_t::bAcceptCompressedFiles. It must then create a file
+ * with a non-NULL C->pucCompression at C->ulUncompressedSize rather than C->ulFileSize.
+ *
  * @param[in] C OTA file context information.
  *
  * @return The OTA PAL layer error code combined with the MCU specific error code. See OTA Agent
@@ -124,6 +128,63 @@ int16_t prvPAL_WriteBlock( OTA_FileContext_t * const C,
                            uint8_t * const pcData,
                            uint32_t ulBlockSize );
 
+/**
+ * @brief Persist the download progress of the specified file.
+ *
+ * Optional. Only PALs that support resuming interrupted downloads implement this, and
+ * the application registers it through OTA_PAL_Callbacks_t::xSaveCheckpoint.
+ *
+ * The data written so far must be durable before the bitmap is stored. C->pucJobName holds
+ * the active job name for the duration of the call.
+ *
+ * @param[in] C OTA file context information.
+ * @param[in] ulBitmapLen Length of C->pucRxBlockBitmap in bytes.
+ *
+ * @return The OTA PAL layer error code combined with the MCU specific error code. See OTA Agent
+ * error codes information in aws_iot_ota_agent.h.
+ *
+ * kOTA_Err_CheckpointFailed is returned when the checkpoint could not be stored.
+ */
+OTA_Err_t prvPAL_SaveCheckpoint( OTA_FileContext_t * const C,
+                                 uint32_t ulBitmapLen );
+
+/**
+ * @brief Reopen a partially received file from its last checkpoint.
+ *
+ * Optional. Registered through OTA_PAL_Callbacks_t::xResumeFileForRx.
+ *
+ * Succeeds only if the checkpoint belongs to the same job name, server file ID and file
+ * size. The file is then opened for write without erasing it and the saved bitmap is
+ * copied into C->pucRxBlockBitmap. On failure the bitmap is left untouched. C->pucJobName
+ * holds the active job name for the duration of the call.
+ *
+ * @param[in] C OTA file context information.
+ * @param[in] ulBitmapLen Length of C->pucRxBlockBitmap in bytes.
+ *
+ * @return kOTA_Err_None if the file was reopened, otherwise kOTA_Err_CheckpointFailed
+ * possibly combined with the MCU specific error code.
+ */
+OTA_Err_t prvPAL_ResumeFileForRx( OTA_FileContext_t * const C,
+                                  uint32_t ulBitmapLen );
+
+/**
+ * @brief Read the currently running image.
+ *
+ * Optional. Registered through OTA_PAL_Callbacks_t::xReadBaseImage by PALs that accept
+ * delta updates, whose patch is applied against the running image. Delta updates are
+ * only applied when otaconfigENABLE_DELTA_UPDATES is set to 1.
+ *
+ * @param[in] ulOffset Offset into the running image to read from.
+ * @param[out] pucBuffer Buffer to read into.
+ * @param[in] ulLength Number of bytes to read.
+ *
+ * @return The number of bytes read, which is less than ulLength only at the end of the
+ * image, or a negative value on error.
+ */
+int32_t prvPAL_ReadBaseImage( uint32_t ulOffset,
+                              uint8_t * pucBuffer,
+                              uint32_t ulLength );
+
 /**
  * @brief Activate the newest MCU image received via OTA.
  *
@@ -1183,3 +1183,35 @@ OTA_Err_t _AwsIotOTA_CleanupData_HTTP( OTA_AgentContext_t * pAgentCtx )
 
     return kOTA_Err_None;
 }
+
+
+OTA_Err_t _AwsIotOTA_GetNetworkStatistics_HTTP( OTA_AgentContext_t * pAgentCtx,
+                                                IotNetworkStatistics_t * pStatistics )
+{
+    /* Return status. */
+    OTA_Err_t status = kOTA_Err_None;
+    IotHttpsReturnCode_t httpsStatus = IOT_HTTPS_OK;
+
+    /* Unused parameters. */
+    ( void ) pAgentCtx;
+
+    /* The connection only exists between the file transfer being initialized
+     * and the data plane being cleaned up. */
+    if( _httpDownloader.httpConnection.connectionHandle == NULL )
+    {
+        status = kOTA_Err_NoNetworkStatistics;
+    }
+    else
+    {
+        httpsStatus = IotHttpsClient_GetNetworkStatistics( _httpDownloader.httpConnection.connectionHandle,
+                                                           pStatistics );
+
+        if( httpsStatus != IOT_HTTPS_OK )
+        {
+            IotLogDebug( "Failed to get the HTTP network statistics. Error code: %d.", httpsStatus );
+            status = kOTA_Err_NoNetworkStatistics;
+        }
+    }
+
+    return status;
+}
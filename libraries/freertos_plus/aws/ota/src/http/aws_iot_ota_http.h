@@ -45,4 +45,7 @@ OTA_Err_t _AwsIotOTA_DecodeFileBlock_HTTP( uint8_t * pMessageBuffer,
 
 OTA_Err_t _AwsIotOTA_CleanupData_HTTP( OTA_AgentContext_t * pxAgentCtx );
 
+OTA_Err_t _AwsIotOTA_GetNetworkStatistics_HTTP( OTA_AgentContext_t * pxAgentCtx,
+                                                IotNetworkStatistics_t * pxStatistics );
+
 #endif /* ifndef __AWS_OTA_HTTP__H__ */
@@ -974,3 +974,27 @@ OTA_Err_t prvCleanupData_Mqtt( OTA_AgentContext_t * pxAgentCtx )
 
     return kOTA_Err_None;
 }
+
+/*
+ * Get the network statistics of the MQTT connection.
+ */
+OTA_Err_t prvGetNetworkStatistics_Mqtt( OTA_AgentContext_t * pxAgentCtx,
+                                        IotNetworkStatistics_t * pxStatistics )
+{
+    DEFINE_OTA_METHOD_NAME( "prvGetNetworkStatistics_Mqtt" );
+
+    OTA_Err_t xErr = kOTA_Err_None;
+    IotMqttError_t eResult;
+
+    eResult = IotMqtt_GetNetworkStatistics( ( ( OTA_ConnectionContext_t * ) pxAgentCtx->pvConnectionContext )->pvControlClient,
+                                            pxStatistics );
+
+    if( eResult != IOT_MQTT_SUCCESS )
+    {
+        OTA_LOG_L1( "[%s] Failed to get MQTT network statistics: %s\r\n", OTA_METHOD_NAME, IotMqtt_strerror( eResult ) );
+
+        xErr = kOTA_Err_NoNetworkStatistics;
+    }
+
+    return xErr;
+}
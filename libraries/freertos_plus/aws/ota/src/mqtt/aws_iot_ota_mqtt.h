@@ -121,6 +121,21 @@ OTA_Err_t prvCleanupControl_Mqtt( OTA_AgentContext_t * pxAgentCtx );
 
 OTA_Err_t prvCleanupData_Mqtt( OTA_AgentContext_t * pxAgentCtx );
 
+/**
+ * @brief Get the network statistics of the MQTT connection.
+ *
+ * The control and data planes share the MQTT connection, so this function is
+ * used for both.
+ *
+ * @param[in] pxAgentCtx The OTA agent context.
+ * @param[out] pxStatistics Set to the statistics of the MQTT connection.
+ *
+ * @return The OTA error code. See OTA Agent error codes information in aws_iot_ota_agent.h.
+ */
+
+OTA_Err_t prvGetNetworkStatistics_Mqtt( OTA_AgentContext_t * pxAgentCtx,
+                                        IotNetworkStatistics_t * pxStatistics );
+
 /**
  * @brief Update job status over MQTT.
  *
@@ -52,6 +52,24 @@ DocParseErr_t TEST_OTA_prvParseJSONbyModel( const char * pcJSON,
                                             uint32_t ulMsgLen,
                                             JSON_DocModel_t * pxDocModel );
 
+DocParseErr_t TEST_OTA_prvInitDocModel( JSON_DocModel_t * pxDocModel,
+                                        const JSON_DocParam_t * pxBodyDef,
+                                        uint32_t ulContextBaseAddr,
+                                        uint32_t ulContextSize,
+                                        uint16_t usNumJobParams );
+
+OTA_FileContext_t * TEST_OTA_prvGetFileContextFromJob( const char * pcRawMsg,
+                                                       uint32_t ulMsgLen );
+
+void TEST_OTA_prvResumeBlockBitmap( OTA_FileContext_t * C,
+                                    uint32_t ulNumBlocks,
+                                    uint32_t ulBitmapLen );
+
+void TEST_OTA_prvSaveCheckpoint( OTA_FileContext_t * C );
+
+uint32_t TEST_OTA_prvHashModelKey( const char * pcKey,
+                                   uint32_t ulLen );
+
 void TEST_OTA_prvSetDataInterfaceMQTT();
 
 #endif /* ifndef _AWS_OTA_AGENT_TEST_ACCESS_DECLARE_H_ */
@@ -71,6 +71,49 @@ DocParseErr_t TEST_OTA_prvParseJSONbyModel( const char * pcJSON,
 
 /*-----------------------------------------------------------*/
 
+DocParseErr_t TEST_OTA_prvInitDocModel( JSON_DocModel_t * pxDocModel,
+                                        const JSON_DocParam_t * pxBodyDef,
+                                        uint32_t ulContextBaseAddr,
+                                        uint32_t ulContextSize,
+                                        uint16_t usNumJobParams )
+{
+    return prvInitDocModel( pxDocModel, pxBodyDef, ulContextBaseAddr, ulContextSize, usNumJobParams );
+}
+
+/*-----------------------------------------------------------*/
+
+OTA_FileContext_t * TEST_OTA_prvGetFileContextFromJob( const char * pcRawMsg,
+                                                       uint32_t ulMsgLen )
+{
+    return prvGetFileContextFromJob( pcRawMsg, ulMsgLen );
+}
+
+/*-----------------------------------------------------------*/
+
+void TEST_OTA_prvResumeBlockBitmap( OTA_FileContext_t * C,
+                                    uint32_t ulNumBlocks,
+                                    uint32_t ulBitmapLen )
+{
+    prvResumeBlockBitmap( C, ulNumBlocks, ulBitmapLen );
+}
+
+/*-----------------------------------------------------------*/
+
+void TEST_OTA_prvSaveCheckpoint( OTA_FileContext_t * C )
+{
+    prvSaveCheckpoint( C );
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t TEST_OTA_prvHashModelKey( const char * pcKey,
+                                   uint32_t ulLen )
+{
+    return prvHashModelKey( pcKey, ulLen );
+}
+
+/*-----------------------------------------------------------*/
+
 void TEST_OTA_prvSetDataInterfaceMQTT()
 {
     prvSetDataInterface( &xOTA_DataInterface, ( const uint8_t * ) "MQTT" );
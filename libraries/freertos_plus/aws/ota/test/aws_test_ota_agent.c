@@ -28,6 +28,7 @@
 #include "iot_init.h"
 
 /* Standard includes. */
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
@@ -118,6 +119,12 @@ static const uint8_t ucOtatestSIGNATURE[] =
  */
 #define otatestLASER_JSON_WITH_SELF_TEST         "{\"clientToken\":\"mytoken\",\"timestamp\":1508445004,\"execution\":{\"self_test\":\"true\",\"jobId\":\"15\",\"status\":\"QUEUED\",\"queuedAt\":1507697924,\"lastUpdatedAt\":1507697924,\"versionNumber\":1,\"executionNumber\":1,\"jobDocument\":{\"afr_ota\": {\"streamname\": \"1\",\"files\": [{\"filepath\": \"payload.bin\",\"version\":\"1.0.0.0\",\"filesize\": 90860,\"fileid\": 0,\"attr\": 3,\"certfile\":\"rsasigner.crt\", \"" otatestVALID_SIG_METHOD "\":\"OHj5sNjxqMNK3WNEwbyfs/PeSSS1kzLkAQ4MSu0yKNFoGxJrUKuIWhjQbQiPlXcDtXlSXE8ydAwoxnnw5lcwpJsbXxD1K1PwZJoc/3mv5XHXbvvEoFr4yA0rhY4tyrMDBesEtOVrW0yI4mM4Lde5OtdIxo8sjTSPGXo2Ejuhn+LDRD3gKdb1gtPpoJ/YBQmYKXHFQ5QW58GOSlB9prq5v+MloVCATjmzb9tu4msScXYYy41ikEhK2eyfl7/vpc2vMNX6uhyyeZhku9namI4OZmsp72tLL4D4pFt4/nDWYSAo8sQAwns1RNY+j52KfvgvKKN3u6G3suFyVQoxWJu3aA==\"}]}}}}"
 
+/**
+ * @brief Valid job document for a heatshrink compressed file.
+ */
+#define otatestLASER_JSON_COMPRESSED             "{\"clientToken\":\"mytoken\",\"timestamp\":1508445004,\"execution\":{\"jobId\":\"15\",\"status\":\"QUEUED\",\"queuedAt\":1507697924,\"lastUpdatedAt\":1507697924,\"versionNumber\":1,\"executionNumber\":1,\"jobDocument\":{\"afr_ota\": {\"protocols\":[\"MQTT\"],\"streamname\": \"1\",\"files\": [{\"filepath\": \"payload.bin\",\"version\":\"1.0.0.0\",\"filesize\": 90860,\"compression\":\"heatshrink\",\"uncompressed_size\": 181720,\"fileid\": 0,\"attr\": 3,\"certfile\":\"rsasigner.crt\", \"" otatestVALID_SIG_METHOD "\":\"OHj5sNjxqMNK3WNEwbyfs/PeSSS1kzLkAQ4MSu0yKNFoGxJrUKuIWhjQbQiPlXcDtXlSXE8ydAwoxnnw5lcwpJsbXxD1K1PwZJoc/3mv5XHXbvvEoFr4yA0rhY4tyrMDBesEtOVrW0yI4mM4Lde5OtdIxo8sjTSPGXo2Ejuhn+LDRD3gKdb1gtPpoJ/YBQmYKXHFQ5QW58GOSlB9prq5v+MloVCATjmzb9tu4msScXYYy41ikEhK2eyfl7/vpc2vMNX6uhyyeZhku9namI4OZmsp72tLL4D4pFt4/nDWYSAo8sQAwns1RNY+j52KfvgvKKN3u6G3suFyVQoxWJu3aA==\"}]}}}}"
+#define otatestUNCOMPRESSED_SIZE                 181720
+
 /**
  * @brief Shared MQTT client handle, used across setup, tests, and teardown.
  * But only used by one test at a time. */
@@ -128,19 +135,295 @@ static IotMqttConnection_t xMQTTClientHandle = NULL;
  */
 static OTA_ConnectionContext_t xOTAConnContext = { NULL, NULL, NULL };
 
+/**
+ * @brief Largest block bitmap the checkpoint tests keep, in bytes.
+ */
+#define otatestCHECKPOINT_MAX_BITMAP_LEN    ( 32U )
+
+/**
+ * @brief Job name of the job documents used by the tests.
+ */
+#define otatestJOB_NAME                     "15"
+
+/**
+ * @brief A download checkpoint kept in memory by the test PAL callbacks.
+ */
+typedef struct
+{
+    bool_t bValid;                                       /**< There is a checkpoint to resume from. */
+    char cJobName[ 16 ];                                 /**< Job name the checkpoint was saved for. */
+    uint32_t ulServerFileID;                             /**< File ID the checkpoint was saved for. */
+    uint32_t ulFileSize;                                 /**< File size the checkpoint was saved for. */
+    uint32_t ulBitmapLen;                                /**< Length of ucBitmap in use, in bytes. */
+    uint8_t ucBitmap[ otatestCHECKPOINT_MAX_BITMAP_LEN ]; /**< Saved block bitmap. */
+} TestCheckpoint_t;
+
+/**
+ * @brief The checkpoint the test PAL resumes from and saves to.
+ */
+static TestCheckpoint_t xTestCheckpoint;
+
+/**
+ * @brief Number of times the agent created or resumed a receive file.
+ */
+static uint32_t ulTestCreateCount = 0, ulTestResumeCount = 0;
+
+/**
+ * @brief Stands in for the open receive file of the test PAL.
+ */
+static uint8_t ucTestReceiveFile;
+
+/**
+ * @brief Parameters extracted by the document model of the JSON parser tests.
+ */
+typedef struct
+{
+    const char * pcName;  /**< "name", pointing into the document. */
+    char * pcList;        /**< "list", copied whole. */
+    const char * pcInner; /**< "inner", pointing into the document. */
+} TestDoc_t;
+
+/**
+ * @brief Document model of the JSON parser tests. "obj" is descended into,
+ * so its members are matched against the model as well.
+ */
+static const JSON_DocParam_t xTestDocModelParams[] =
+{
+    { "name",  OTA_JOB_PARAM_REQUIRED, { offsetof( TestDoc_t, pcName ) },  eModelParamType_StringInDoc, JSMN_STRING },
+    { "list",  OTA_JOB_PARAM_OPTIONAL, { offsetof( TestDoc_t, pcList ) },  eModelParamType_ArrayCopy,   JSMN_ARRAY  },
+    { "obj",   OTA_JOB_PARAM_OPTIONAL, { OTA_DONT_STORE_PARAM },           eModelParamType_Object,      JSMN_OBJECT },
+    { "inner", OTA_JOB_PARAM_OPTIONAL, { offsetof( TestDoc_t, pcInner ) }, eModelParamType_StringInDoc, JSMN_STRING },
+};
+
+/*-----------------------------------------------------------*/
+
+static OTA_Err_t prvTestCreateFileForRx( OTA_FileContext_t * const C )
+{
+    ulTestCreateCount++;
+    C->pucFile = &ucTestReceiveFile;
+
+    return kOTA_Err_None;
+}
+
+/*-----------------------------------------------------------*/
+
+static OTA_Err_t prvTestAbort( OTA_FileContext_t * const C )
+{
+    C->pucFile = NULL;
+
+    return kOTA_Err_None;
+}
+
+/*-----------------------------------------------------------*/
+
+static OTA_Err_t prvTestSaveCheckpoint( OTA_FileContext_t * const C,
+                                        uint32_t ulBitmapLen )
+{
+    OTA_Err_t xErr = kOTA_Err_CheckpointFailed;
+
+    if( ( C->pucJobName != NULL ) &&
+        ( strlen( ( const char * ) C->pucJobName ) < sizeof( xTestCheckpoint.cJobName ) ) &&
+        ( ulBitmapLen <= otatestCHECKPOINT_MAX_BITMAP_LEN ) )
+    {
+        ( void ) strcpy( xTestCheckpoint.cJobName, ( const char * ) C->pucJobName );
+        xTestCheckpoint.ulServerFileID = C->ulServerFileID;
+        xTestCheckpoint.ulFileSize = C->ulFileSize;
+        xTestCheckpoint.ulBitmapLen = ulBitmapLen;
+        ( void ) memcpy( xTestCheckpoint.ucBitmap, C->pucRxBlockBitmap, ulBitmapLen );
+        xTestCheckpoint.bValid = true;
+        xErr = kOTA_Err_None;
+    }
+
+    return xErr;
+}
+
+/*-----------------------------------------------------------*/
+
+static OTA_Err_t prvTestResumeFileForRx( OTA_FileContext_t * const C,
+                                         uint32_t ulBitmapLen )
+{
+    OTA_Err_t xErr = kOTA_Err_CheckpointFailed;
+
+    /* Resume only a checkpoint of the same job and file, as the PAL API requires. */
+    if( ( xTestCheckpoint.bValid == true ) &&
+        ( C->pucJobName != NULL ) &&
+        ( strcmp( xTestCheckpoint.cJobName, ( const char * ) C->pucJobName ) == 0 ) &&
+        ( xTestCheckpoint.ulServerFileID == C->ulServerFileID ) &&
+        ( xTestCheckpoint.ulFileSize == C->ulFileSize ) &&
+        ( xTestCheckpoint.ulBitmapLen == ulBitmapLen ) )
+    {
+        ulTestResumeCount++;
+        ( void ) memcpy( C->pucRxBlockBitmap, xTestCheckpoint.ucBitmap, ulBitmapLen );
+        C->pucFile = &ucTestReceiveFile;
+        xErr = kOTA_Err_None;
+    }
+
+    return xErr;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief PAL callbacks of the checkpoint tests. The callbacks left NULL use the platform's PAL.
+ */
+static const OTA_PAL_Callbacks_t xTestCheckpointCallbacks =
+{
+    .xAbort           = prvTestAbort,
+    .xCreateFileForRx = prvTestCreateFileForRx,
+    .xSaveCheckpoint  = prvTestSaveCheckpoint,
+    .xResumeFileForRx = prvTestResumeFileForRx,
+};
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Number of blocks and bitmap length of the test job's file.
+ */
+static void prvTestFileBlocks( uint32_t * pulNumBlocks,
+                               uint32_t * pulBitmapLen )
+{
+    *pulNumBlocks = ( otatestFILE_SIZE + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE;
+    *pulBitmapLen = ( *pulNumBlocks + ( BITS_PER_BYTE - 1U ) ) >> LOG2_BITS_PER_BYTE;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Save a checkpoint of the test job's file in which blocks below ulReceived are received.
+ */
+static void prvTestSetCheckpoint( const char * pcJobName,
+                                  uint32_t ulServerFileID,
+                                  uint32_t ulReceived )
+{
+    uint32_t ulNumBlocks, ulBitmapLen, ulBlock;
+
+    prvTestFileBlocks( &ulNumBlocks, &ulBitmapLen );
+    TEST_ASSERT_LESS_OR_EQUAL( otatestCHECKPOINT_MAX_BITMAP_LEN, ulBitmapLen );
+
+    ( void ) memset( &xTestCheckpoint, 0x00, sizeof( xTestCheckpoint ) );
+    ( void ) strcpy( xTestCheckpoint.cJobName, pcJobName );
+    xTestCheckpoint.ulServerFileID = ulServerFileID;
+    xTestCheckpoint.ulFileSize = otatestFILE_SIZE;
+    xTestCheckpoint.ulBitmapLen = ulBitmapLen;
+    xTestCheckpoint.bValid = true;
+
+    /* A set bit is a block still wanted. */
+    for( ulBlock = ulReceived; ulBlock < ulNumBlocks; ulBlock++ )
+    {
+        xTestCheckpoint.ucBitmap[ ulBlock >> LOG2_BITS_PER_BYTE ] |= ( uint8_t ) ( 1U << ( ulBlock % BITS_PER_BYTE ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check that the blocks wanted by a file context are exactly those at or above ulReceived.
+ */
+static void prvTestCheckWantedBlocks( const OTA_FileContext_t * C,
+                                      uint32_t ulReceived )
+{
+    uint32_t ulNumBlocks, ulBitmapLen, ulBlock;
+    bool_t bWanted;
+
+    prvTestFileBlocks( &ulNumBlocks, &ulBitmapLen );
+
+    TEST_ASSERT_EQUAL( ulNumBlocks - ulReceived, C->ulBlocksRemaining );
+
+    for( ulBlock = 0; ulBlock < ( ulBitmapLen * BITS_PER_BYTE ); ulBlock++ )
+    {
+        bWanted = ( C->pucRxBlockBitmap[ ulBlock >> LOG2_BITS_PER_BYTE ] & ( 1U << ( ulBlock % BITS_PER_BYTE ) ) ) != 0U;
+        TEST_ASSERT_EQUAL( ( ulBlock >= ulReceived ) && ( ulBlock < ulNumBlocks ), bWanted );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Start the test job with the checkpoint PAL callbacks and check how its file was opened.
+ *
+ * @param[in] bResumed Whether the file is expected to be resumed rather than created.
+ * @param[in] ulReceived Number of leading blocks expected to be received already.
+ */
+static void prvTestStartJob( bool_t bResumed,
+                             uint32_t ulReceived )
+{
+    OTA_FileContext_t * pxUpdateFile = NULL;
+
+    ulTestCreateCount = 0;
+    ulTestResumeCount = 0;
+
+    TEST_ASSERT_EQUAL( eOTA_AgentState_WaitingForJob, prvOTAAgentInit( &xTestCheckpointCallbacks ) );
+
+    if( TEST_PROTECT() )
+    {
+        pxUpdateFile = TEST_OTA_prvGetFileContextFromJob( otatestLASER_JSON, sizeof( otatestLASER_JSON ) );
+        TEST_ASSERT_NOT_NULL( pxUpdateFile );
+        TEST_ASSERT_NOT_NULL( pxUpdateFile->pucFile );
+
+        TEST_ASSERT_EQUAL( bResumed ? 0U : 1U, ulTestCreateCount );
+        TEST_ASSERT_EQUAL( bResumed ? 1U : 0U, ulTestResumeCount );
+        prvTestCheckWantedBlocks( pxUpdateFile, ulReceived );
+
+        /* The job name is only lent to the PAL during the callback. */
+        TEST_ASSERT_NULL( pxUpdateFile->pucJobName );
+    }
+
+    if( pxUpdateFile != NULL )
+    {
+        ( void ) TEST_OTA_prvOTA_Close( pxUpdateFile );
+    }
+
+    ( void ) OTA_AgentShutdown( otatestSHUTDOWN_WAIT );
+}
+
+/**
+ * @brief Parse a document with the document model of the JSON parser tests.
+ *
+ * @param[in] pcJSON Zero terminated JSON document.
+ * @param[out] pxDoc Receives the extracted parameters.
+ */
+static DocParseErr_t prvParseTestDoc( const char * pcJSON,
+                                      TestDoc_t * pxDoc )
+{
+    JSON_DocModel_t xDocModel;
+
+    ( void ) memset( pxDoc, 0, sizeof( TestDoc_t ) );
+    TEST_ASSERT_EQUAL( eDocParseErr_None,
+                       TEST_OTA_prvInitDocModel( &xDocModel,
+                                                 xTestDocModelParams,
+                                                 ( uint32_t ) pxDoc,
+                                                 sizeof( TestDoc_t ),
+                                                 sizeof( xTestDocModelParams ) / sizeof( xTestDocModelParams[ 0 ] ) ) );
+
+    return TEST_OTA_prvParseJSONbyModel( pcJSON, ( uint32_t ) strlen( pcJSON ), &xDocModel );
+}
+
 /**
  * @brief Initialize OTA agent. Some tests don't use an initialized OTA Agent, so this isn't done in SETUP.
+ *
+ * @param[in] pxCallbacks PAL callbacks to use, or NULL for the platform's PAL.
  */
-static OTA_State_t prvOTAAgentInit()
+static OTA_State_t prvOTAAgentInit( const OTA_PAL_Callbacks_t * pxCallbacks )
 {
     OTA_State_t eOtaStatus = eOTA_AgentState_Init;
     TickType_t xTicksToWait = pdMS_TO_TICKS( otatestAGENT_INIT_WAIT );
 
-    eOtaStatus = OTA_AgentInit(
-        &xOTAConnContext,
-        ( const uint8_t * ) clientcredentialIOT_THING_NAME,
-        NULL,
-        xTicksToWait );
+    if( pxCallbacks == NULL )
+    {
+        eOtaStatus = OTA_AgentInit(
+            &xOTAConnContext,
+            ( const uint8_t * ) clientcredentialIOT_THING_NAME,
+            NULL,
+            xTicksToWait );
+    }
+    else
+    {
+        eOtaStatus = OTA_AgentInit_internal(
+            &xOTAConnContext,
+            ( const uint8_t * ) clientcredentialIOT_THING_NAME,
+            pxCallbacks,
+            xTicksToWait );
+    }
 
     if( eOtaStatus != eOTA_AgentState_Ready )
     {
@@ -235,6 +518,27 @@ TEST_GROUP_RUNNER( Full_OTA_AGENT )
     RUN_TEST_CASE( Full_OTA_AGENT, OTA_GetStatistics_BeforeInit );
     RUN_TEST_CASE( Full_OTA_AGENT, prvParseJobDocFromJSONandPrvOTA_Close );
     RUN_TEST_CASE( Full_OTA_AGENT, prvParseJSONbyModel_Errors );
+    RUN_TEST_CASE( Full_OTA_AGENT, prvParseJSONbyModel_MaxDepth );
+    RUN_TEST_CASE( Full_OTA_AGENT, prvParseJSONbyModel_SkipsUnknownValues );
+    RUN_TEST_CASE( Full_OTA_AGENT, prvParseJSONbyModel_ArrayCopy );
+    RUN_TEST_CASE( Full_OTA_AGENT, prvParseJSONbyModel_EscapedQuotes );
+    RUN_TEST_CASE( Full_OTA_AGENT, prvParseJSONbyModel_KeyAtOtherLevel );
+    RUN_TEST_CASE( Full_OTA_AGENT, prvHashModelKey_JobDocKeysUnique );
+    RUN_TEST_CASE( Full_OTA_AGENT, prvParseJobDoc_CompressionNeedsPAL );
+    RUN_TEST_CASE( Full_OTA_AGENT, prvResumeBlockBitmap_PartialBitmap );
+    RUN_TEST_CASE( Full_OTA_AGENT, prvResumeBlockBitmap_AllBlocksReceived );
+    RUN_TEST_CASE( Full_OTA_AGENT, Checkpoint_ResumeFromSavedBitmap );
+    RUN_TEST_CASE( Full_OTA_AGENT, Checkpoint_OtherJobOrFileIgnored );
+    RUN_TEST_CASE( Full_OTA_AGENT, Checkpoint_Corrupt );
+
+    /* The patch decoder and decompressor are only part of the build when enabled. */
+    #if ( otaconfigENABLE_DELTA_UPDATES == 1 )
+        RUN_TEST_GROUP( Full_OTA_DELTA );
+    #endif
+
+    #if ( otaconfigENABLE_COMPRESSED_FILES == 1 )
+        RUN_TEST_GROUP( Full_OTA_DECOMPRESS );
+    #endif
 }
 
 TEST( Full_OTA_AGENT, OTA_SetImageState_AbortBeforeInit )
@@ -248,7 +552,7 @@ TEST( Full_OTA_AGENT, OTA_SetImageState_AbortAfterShutDown )
     OTA_State_t eOtaStatus = eOTA_AgentState_Init;
 
     /* Initialize the Agent. */
-    eOtaStatus = prvOTAAgentInit();
+    eOtaStatus = prvOTAAgentInit( NULL );
     TEST_ASSERT_EQUAL( eOTA_AgentState_WaitingForJob, eOtaStatus );
 
     /* Shutdown the OTA agent. */
@@ -278,7 +582,7 @@ TEST( Full_OTA_AGENT, OTA_GetAgentState_InitAndStop )
     TEST_ASSERT_EQUAL( eOTA_AgentState_Stopped, OTA_GetAgentState() );
 
     /* Initialize the Agent. */
-    TEST_ASSERT_EQUAL( eOTA_AgentState_WaitingForJob, prvOTAAgentInit() );
+    TEST_ASSERT_EQUAL( eOTA_AgentState_WaitingForJob, prvOTAAgentInit( NULL ) );
 
     /* Shutdown the OTA agent. */
     TEST_ASSERT_EQUAL( eOTA_AgentState_Stopped, OTA_AgentShutdown( otatestSHUTDOWN_WAIT ) );
@@ -299,7 +603,7 @@ TEST( Full_OTA_AGENT, OTA_AgentInit_BackToBack )
     TickType_t xTicksToWait = pdMS_TO_TICKS( otatestAGENT_INIT_WAIT );
 
     /* Initialize the Agent. */
-    TEST_ASSERT_EQUAL( eOTA_AgentState_WaitingForJob, prvOTAAgentInit() );
+    TEST_ASSERT_EQUAL( eOTA_AgentState_WaitingForJob, prvOTAAgentInit( NULL ) );
 
     /* Call init again should do nothing and only reset statistics. */
     eOtaStatus = OTA_AgentInit(
@@ -336,7 +640,7 @@ TEST( Full_OTA_AGENT, prvParseJobDocFromJSONandPrvOTA_Close )
     uint32_t ulLoopIndex = 0;
     bool_t bUpdateJob = false;
 
-    eOtaStatus = prvOTAAgentInit();
+    eOtaStatus = prvOTAAgentInit( NULL );
     TEST_ASSERT_EQUAL( eOTA_AgentState_WaitingForJob, eOtaStatus );
 
     /* Test:
@@ -442,7 +746,7 @@ TEST( Full_OTA_AGENT, prvParseJSONbyModel_Errors )
     bool_t bUpdateJob = false;
 
     /* Initialize the OTA Agent for the following tests. */
-    TEST_ASSERT_EQUAL( eOTA_AgentState_WaitingForJob, prvOTAAgentInit() );
+    TEST_ASSERT_EQUAL( eOTA_AgentState_WaitingForJob, prvOTAAgentInit( NULL ) );
 
     /* Ensure that NULL parameters are rejected. */
     TEST_ASSERT_EQUAL( eDocParseErr_NullModelPointer,
@@ -465,6 +769,11 @@ TEST( Full_OTA_AGENT, prvParseJSONbyModel_Errors )
                                                                             0,
                                                                             &xDocModel ) );
 
+    /* Ensure a truncated JSON document is rejected. */
+    TEST_ASSERT_EQUAL( eDocParseErr_InvalidToken, TEST_OTA_prvParseJSONbyModel( otatestLASER_JSON,
+                                                                                20,
+                                                                                &xDocModel ) );
+
     /* Ensure usNumModelParams is rejected if too large. */
     xDocModel.usNumModelParams = ( uint16_t ) ( 0xffffU );
     TEST_ASSERT_EQUAL( eDocParseErr_TooManyParams,
@@ -494,3 +803,281 @@ TEST( Full_OTA_AGENT, prvParseJSONbyModel_Errors )
     /* Shut down the OTA Agent. */
     ( void ) OTA_AgentShutdown( otatestSHUTDOWN_WAIT );
 }
+
+TEST( Full_OTA_AGENT, prvParseJSONbyModel_MaxDepth )
+{
+    char cJSON[ ( 2U * OTA_MAX_JSON_DEPTH ) + 32U ];
+    TestDoc_t xDoc;
+    uint32_t ulLen, ulNesting, ulIndex;
+
+    /* The root object holds an unknown value nested down to the deepest level
+     * the parser tracks. One more level is rejected. */
+    for( ulNesting = OTA_MAX_JSON_DEPTH - 1U; ulNesting <= OTA_MAX_JSON_DEPTH; ulNesting++ )
+    {
+        ( void ) strcpy( cJSON, "{\"name\":\"a\",\"x\":" );
+        ulLen = ( uint32_t ) strlen( cJSON );
+
+        for( ulIndex = 0U; ulIndex < ulNesting; ulIndex++ )
+        {
+            cJSON[ ulLen + ulIndex ] = '[';
+            cJSON[ ulLen + ulNesting + ulIndex ] = ']';
+        }
+
+        ulLen += 2U * ulNesting;
+        cJSON[ ulLen ] = '}';
+        cJSON[ ulLen + 1U ] = '\0';
+
+        TEST_ASSERT_EQUAL( ( ulNesting < OTA_MAX_JSON_DEPTH ) ? eDocParseErr_None : eDocParseErr_TooManyTokens,
+                           prvParseTestDoc( cJSON, &xDoc ) );
+    }
+}
+
+TEST( Full_OTA_AGENT, prvParseJSONbyModel_SkipsUnknownValues )
+{
+    TestDoc_t xDoc;
+
+    /* Model keys inside the values of unknown keys are not matched. */
+    TEST_ASSERT_EQUAL( eDocParseErr_None,
+                       prvParseTestDoc( "{\"unknown\":{\"name\":\"no\",\"a\":[1,{\"inner\":\"no\"},[]]},"
+                                        "\"name\":\"yes\",\"other\":[{\"list\":[1]},{}]}",
+                                        &xDoc ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "yes\"", xDoc.pcName, 4 );
+    TEST_ASSERT_NULL( xDoc.pcInner );
+    TEST_ASSERT_NULL( xDoc.pcList );
+
+    /* A required key only present in a skipped value is missing. */
+    TEST_ASSERT_EQUAL( eDocParseErr_MalformedDoc,
+                       prvParseTestDoc( "{\"unknown\":{\"name\":\"no\"}}", &xDoc ) );
+}
+
+TEST( Full_OTA_AGENT, prvParseJSONbyModel_ArrayCopy )
+{
+    TestDoc_t xDoc;
+
+    /* The array is copied whole, including its nested containers, and its
+     * members are not matched against the model. */
+    TEST_ASSERT_EQUAL( eDocParseErr_None,
+                       prvParseTestDoc( "{\"list\":[ \"MQTT\", {\"name\":[1]} ],\"name\":\"a\"}", &xDoc ) );
+    TEST_ASSERT_NOT_NULL( xDoc.pcList );
+    TEST_ASSERT_EQUAL_STRING( "[ \"MQTT\", {\"name\":[1]} ]", xDoc.pcList );
+    TEST_ASSERT_EQUAL_STRING_LEN( "a\"", xDoc.pcName, 2 );
+    vPortFree( xDoc.pcList );
+
+    /* An array copy must be an array. */
+    TEST_ASSERT_EQUAL( eDocParseErr_FieldTypeMismatch,
+                       prvParseTestDoc( "{\"name\":\"a\",\"list\":\"MQTT\"}", &xDoc ) );
+}
+
+TEST( Full_OTA_AGENT, prvParseJSONbyModel_EscapedQuotes )
+{
+    TestDoc_t xDoc;
+
+    /* An escaped quote does not end a string; an escaped backslash before the
+     * closing quote does not escape the quote. */
+    TEST_ASSERT_EQUAL( eDocParseErr_None,
+                       prvParseTestDoc( "{\"name\":\"say \\\"hi\\\", \\\"}\",\"inner\":\"x\\\\\"}", &xDoc ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "say \\\"hi\\\", \\\"}\"", xDoc.pcName, 16 );
+    TEST_ASSERT_EQUAL_STRING_LEN( "x\\\\\"", xDoc.pcInner, 4 );
+
+    /* A string ending in an escaped quote is never closed. */
+    TEST_ASSERT_EQUAL( eDocParseErr_InvalidToken,
+                       prvParseTestDoc( "{\"name\":\"a\\\"}", &xDoc ) );
+}
+
+TEST( Full_OTA_AGENT, prvParseJSONbyModel_KeyAtOtherLevel )
+{
+    TestDoc_t xDoc;
+
+    /* Members of "obj" are matched, so a key repeated inside it is a duplicate. */
+    TEST_ASSERT_EQUAL( eDocParseErr_None,
+                       prvParseTestDoc( "{\"name\":\"a\",\"obj\":{\"inner\":\"b\"}}", &xDoc ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "b\"", xDoc.pcInner, 2 );
+    TEST_ASSERT_EQUAL( eDocParseErr_DuplicatesNotAllowed,
+                       prvParseTestDoc( "{\"name\":\"a\",\"obj\":{\"name\":\"b\"}}", &xDoc ) );
+
+    /* A key repeated inside a skipped value is not. */
+    TEST_ASSERT_EQUAL( eDocParseErr_None,
+                       prvParseTestDoc( "{\"name\":\"a\",\"other\":{\"name\":\"b\",\"obj\":{}}}", &xDoc ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "a\"", xDoc.pcName, 2 );
+}
+
+TEST( Full_OTA_AGENT, prvHashModelKey_JobDocKeysUnique )
+{
+    /* Keys of the job document model, followed by the signature keys a platform may use. */
+    static const char * const pcJobDocKeys[] =
+    {
+        OTA_JSON_CLIENT_TOKEN_KEY,    OTA_JSON_TIMESTAMP_KEY,         OTA_JSON_EXECUTION_KEY,
+        OTA_JSON_JOB_ID_KEY,          OTA_JSON_STATUS_DETAILS_KEY,    OTA_JSON_SELF_TEST_KEY,
+        OTA_JSON_UPDATED_BY_KEY,      OTA_JSON_JOB_DOC_KEY,           OTA_JSON_OTA_UNIT_KEY,
+        OTA_JSON_STREAM_NAME_KEY,     OTA_JSON_PROTOCOLS_KEY,         OTA_JSON_FILE_GROUP_KEY,
+        OTA_JSON_FILE_PATH_KEY,       OTA_JSON_FILE_SIZE_KEY,         OTA_JSON_FILE_ID_KEY,
+        OTA_JSON_FILE_CERT_NAME_KEY,  OTA_JSON_UPDATE_DATA_URL_KEY,   OTA_JSON_AUTH_SCHEME_KEY,
+        OTA_JSON_FILE_ATTRIBUTE_KEY,  OTA_JSON_DELTA_SIZE_KEY,        OTA_JSON_DELTA_BASE_KEY,
+        OTA_JSON_COMPRESSION_KEY,     OTA_JSON_UNCOMPRESSED_SIZE_KEY,
+        "sig-sha256-ecdsa",           "sig-sha256-rsa",               "sig-sha1-rsa"
+    };
+    const uint32_t ulNumModelKeys = OTA_NUM_JOB_PARAMS - 1U;
+    const uint32_t ulNumKeys = sizeof( pcJobDocKeys ) / sizeof( pcJobDocKeys[ 0 ] );
+    uint8_t ucSlotUsed[ OTA_DOC_MODEL_INDEX_SIZE ];
+    uint32_t ulSig, ulIndex, ulSlot;
+
+    /* A key added to the job document must be added here as well. */
+    TEST_ASSERT_EQUAL_UINT32( ulNumModelKeys + 3U, ulNumKeys );
+
+    /* Every key must get its own slot in the model key index, with each signature key. */
+    for( ulSig = ulNumModelKeys; ulSig < ulNumKeys; ulSig++ )
+    {
+        ( void ) memset( ucSlotUsed, 0, sizeof( ucSlotUsed ) );
+
+        for( ulIndex = 0U; ulIndex <= ulNumModelKeys; ulIndex++ )
+        {
+            const char * pcKey = ( ulIndex < ulNumModelKeys ) ? pcJobDocKeys[ ulIndex ] : pcJobDocKeys[ ulSig ];
+
+            ulSlot = TEST_OTA_prvHashModelKey( pcKey, ( uint32_t ) strlen( pcKey ) );
+            TEST_ASSERT_LESS_THAN_UINT32( OTA_DOC_MODEL_INDEX_SIZE, ulSlot );
+            TEST_ASSERT_EQUAL_UINT8_MESSAGE( 0, ucSlotUsed[ ulSlot ], pcKey );
+            ucSlotUsed[ ulSlot ] = 1U;
+        }
+    }
+}
+
+TEST( Full_OTA_AGENT, prvParseJobDoc_CompressionNeedsPAL )
+{
+    OTA_PAL_Callbacks_t xCallbacks = xTestCheckpointCallbacks;
+    OTA_FileContext_t * pxUpdateFile = NULL;
+    bool_t bUpdateJob = false;
+
+    /* A compressed file is rejected unless the PAL accepts compressed files. */
+    TEST_ASSERT_EQUAL( eOTA_AgentState_WaitingForJob, prvOTAAgentInit( NULL ) );
+    pxUpdateFile = TEST_OTA_prvParseJobDoc( otatestLASER_JSON_COMPRESSED, sizeof( otatestLASER_JSON_COMPRESSED ), &bUpdateJob );
+    TEST_ASSERT_NULL( pxUpdateFile );
+    ( void ) OTA_AgentShutdown( otatestSHUTDOWN_WAIT );
+
+    xCallbacks.bAcceptCompressedFiles = true;
+    TEST_ASSERT_EQUAL( eOTA_AgentState_WaitingForJob, prvOTAAgentInit( &xCallbacks ) );
+
+    if( TEST_PROTECT() )
+    {
+        pxUpdateFile = TEST_OTA_prvParseJobDoc( otatestLASER_JSON_COMPRESSED, sizeof( otatestLASER_JSON_COMPRESSED ), &bUpdateJob );
+
+        #if ( otaconfigENABLE_COMPRESSED_FILES == 1 )
+            TEST_ASSERT_NOT_NULL( pxUpdateFile );
+            TEST_ASSERT_EQUAL_STRING( "heatshrink", ( const char * ) pxUpdateFile->pucCompression );
+            TEST_ASSERT_EQUAL_UINT32( otatestUNCOMPRESSED_SIZE, pxUpdateFile->ulUncompressedSize );
+        #else
+            /* Without decompression in the build, the file is rejected regardless. */
+            TEST_ASSERT_NULL( pxUpdateFile );
+        #endif
+    }
+
+    if( pxUpdateFile != NULL )
+    {
+        ( void ) TEST_OTA_prvOTA_Close( pxUpdateFile );
+    }
+
+    ( void ) OTA_AgentShutdown( otatestSHUTDOWN_WAIT );
+}
+
+TEST( Full_OTA_AGENT, prvResumeBlockBitmap_PartialBitmap )
+{
+    OTA_FileContext_t xContext = { 0 };
+    uint8_t ucBitmap[ 3 ] = { 0x0f, 0x00, 0xff };
+
+    xContext.pucRxBlockBitmap = ucBitmap;
+
+    /* 20 blocks: the top 4 bits of the last byte are out of range and must be cleared. */
+    TEST_OTA_prvResumeBlockBitmap( &xContext, 20, sizeof( ucBitmap ) );
+
+    TEST_ASSERT_EQUAL_HEX8( 0x0f, ucBitmap[ 0 ] );
+    TEST_ASSERT_EQUAL_HEX8( 0x00, ucBitmap[ 1 ] );
+    TEST_ASSERT_EQUAL_HEX8( 0x0f, ucBitmap[ 2 ] );
+    TEST_ASSERT_EQUAL( 8, xContext.ulBlocksRemaining );
+}
+
+TEST( Full_OTA_AGENT, prvResumeBlockBitmap_AllBlocksReceived )
+{
+    OTA_FileContext_t xContext = { 0 };
+    uint8_t ucBitmap[ 3 ] = { 0x00, 0x00, 0xf0 };
+
+    xContext.pucRxBlockBitmap = ucBitmap;
+
+    /* Every in-range block is received, so the last block is wanted again to close the file. */
+    TEST_OTA_prvResumeBlockBitmap( &xContext, 20, sizeof( ucBitmap ) );
+
+    TEST_ASSERT_EQUAL_HEX8( 0x00, ucBitmap[ 0 ] );
+    TEST_ASSERT_EQUAL_HEX8( 0x00, ucBitmap[ 1 ] );
+    TEST_ASSERT_EQUAL_HEX8( 0x08, ucBitmap[ 2 ] );
+    TEST_ASSERT_EQUAL( 1, xContext.ulBlocksRemaining );
+}
+
+TEST( Full_OTA_AGENT, Checkpoint_ResumeFromSavedBitmap )
+{
+    uint32_t ulNumBlocks, ulBitmapLen;
+    OTA_FileContext_t * pxUpdateFile = NULL;
+
+    prvTestFileBlocks( &ulNumBlocks, &ulBitmapLen );
+
+    /* Only the blocks missing from the checkpoint are wanted. */
+    prvTestSetCheckpoint( otatestJOB_NAME, otatestFILE_ID, ulNumBlocks / 2U );
+    prvTestStartJob( true, ulNumBlocks / 2U );
+
+    /* A checkpoint saved by the agent is keyed on the active job and can be resumed. */
+    ( void ) memset( &xTestCheckpoint, 0x00, sizeof( xTestCheckpoint ) );
+    TEST_ASSERT_EQUAL( eOTA_AgentState_WaitingForJob, prvOTAAgentInit( &xTestCheckpointCallbacks ) );
+
+    if( TEST_PROTECT() )
+    {
+        pxUpdateFile = TEST_OTA_prvGetFileContextFromJob( otatestLASER_JSON, sizeof( otatestLASER_JSON ) );
+        TEST_ASSERT_NOT_NULL( pxUpdateFile );
+
+        TEST_OTA_prvSaveCheckpoint( pxUpdateFile );
+
+        TEST_ASSERT_TRUE( xTestCheckpoint.bValid );
+        TEST_ASSERT_EQUAL_STRING( otatestJOB_NAME, xTestCheckpoint.cJobName );
+        TEST_ASSERT_EQUAL( otatestFILE_ID, xTestCheckpoint.ulServerFileID );
+        TEST_ASSERT_EQUAL( ulBitmapLen, xTestCheckpoint.ulBitmapLen );
+        TEST_ASSERT_EQUAL_MEMORY( pxUpdateFile->pucRxBlockBitmap, xTestCheckpoint.ucBitmap, ulBitmapLen );
+        TEST_ASSERT_NULL( pxUpdateFile->pucJobName );
+    }
+
+    if( pxUpdateFile != NULL )
+    {
+        ( void ) TEST_OTA_prvOTA_Close( pxUpdateFile );
+    }
+
+    ( void ) OTA_AgentShutdown( otatestSHUTDOWN_WAIT );
+
+    prvTestStartJob( true, 0 );
+}
+
+TEST( Full_OTA_AGENT, Checkpoint_OtherJobOrFileIgnored )
+{
+    uint32_t ulNumBlocks, ulBitmapLen;
+
+    prvTestFileBlocks( &ulNumBlocks, &ulBitmapLen );
+
+    /* A checkpoint of another job is not resumed, the file is created and every block is wanted. */
+    prvTestSetCheckpoint( "16", otatestFILE_ID, ulNumBlocks / 2U );
+    prvTestStartJob( false, 0 );
+
+    /* Nor is a checkpoint of another file of the same job. */
+    prvTestSetCheckpoint( otatestJOB_NAME, otatestFILE_ID + 1U, ulNumBlocks / 2U );
+    prvTestStartJob( false, 0 );
+}
+
+TEST( Full_OTA_AGENT, Checkpoint_Corrupt )
+{
+    uint32_t ulNumBlocks, ulBitmapLen;
+
+    prvTestFileBlocks( &ulNumBlocks, &ulBitmapLen );
+
+    /* A checkpoint whose bitmap length doesn't match the file is rejected by the PAL. */
+    prvTestSetCheckpoint( otatestJOB_NAME, otatestFILE_ID, ulNumBlocks / 2U );
+    xTestCheckpoint.ulBitmapLen = ulBitmapLen + 1U;
+    prvTestStartJob( false, 0 );
+
+    /* A matching checkpoint with every bit set, out of range bits included, is resumed as a fresh download. */
+    prvTestSetCheckpoint( otatestJOB_NAME, otatestFILE_ID, 0 );
+    ( void ) memset( xTestCheckpoint.ucBitmap, 0xff, ulBitmapLen );
+    prvTestStartJob( true, 0 );
+}
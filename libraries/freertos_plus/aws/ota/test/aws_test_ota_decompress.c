@@ -0,0 +1,346 @@
+/*
+ * FreeRTOS OTA V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Unity framework includes. */
+#include "unity_fixture.h"
+#include "unity.h"
+
+/* OTA includes. */
+#include "aws_iot_ota_agent.h"
+#include "aws_iot_ota_agent_internal.h"
+#include "aws_iot_ota_decompress.h"
+
+/**
+ * @brief Configuration for this test group.
+ */
+#define otatestDECOMPRESS_MAX_SIZE        ( ( 2U * OTA_FILE_BLOCK_SIZE ) + OTA_HEATSHRINK_WINDOW_SIZE )
+#define otatestDECOMPRESS_MAX_COMPRESSED  ( otatestDECOMPRESS_MAX_SIZE / 2U )
+#define otatestDECOMPRESS_MAX_COUNT       ( 1U << otaconfigHEATSHRINK_LOOKAHEAD_SZ2 )
+
+/* The file the compressed stream must decompress to, and the file actually written through
+ * the write block callback. */
+static uint8_t ucExpected[ otatestDECOMPRESS_MAX_SIZE ];
+static uint32_t ulExpectedLen;
+static uint8_t ucWritten[ otatestDECOMPRESS_MAX_SIZE ];
+static uint32_t ulWrittenBytes;
+
+/* The compressed stream, built a bit at a time. */
+static uint8_t ucCompressed[ otatestDECOMPRESS_MAX_COMPRESSED ];
+static uint32_t ulCompressedBits;
+
+static OTA_DecompressContext_t xDecompress;
+static OTA_FileContext_t xFile;
+
+/*-----------------------------------------------------------*/
+
+static int16_t prvTestWriteBlock( OTA_FileContext_t * const C,
+                                  uint32_t ulOffset,
+                                  uint8_t * const pucData,
+                                  uint32_t ulBlockSize )
+{
+    int16_t sResult = -1;
+
+    ( void ) C;
+
+    /* Every window but the last must be a whole block at a block aligned offset. */
+    if( ( ( ulOffset % OTA_FILE_BLOCK_SIZE ) == 0U ) &&
+        ( ulOffset <= otatestDECOMPRESS_MAX_SIZE ) &&
+        ( ulBlockSize <= ( otatestDECOMPRESS_MAX_SIZE - ulOffset ) ) )
+    {
+        ( void ) memcpy( &ucWritten[ ulOffset ], pucData, ulBlockSize );
+        ulWrittenBytes += ulBlockSize;
+        sResult = ( int16_t ) ulBlockSize;
+    }
+
+    return sResult;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestPutBits( uint32_t ulValue,
+                            uint32_t ulCount )
+{
+    uint32_t ulBit;
+
+    for( ulBit = ulCount; ulBit > 0U; ulBit-- )
+    {
+        if( ( ( ulValue >> ( ulBit - 1U ) ) & 1U ) != 0U )
+        {
+            ucCompressed[ ulCompressedBits >> 3 ] |= ( uint8_t ) ( 0x80U >> ( ulCompressedBits & 7U ) );
+        }
+
+        ulCompressedBits++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestStartStream( void )
+{
+    ( void ) memset( ucCompressed, 0, sizeof( ucCompressed ) );
+    ulCompressedBits = 0U;
+    ulExpectedLen = 0U;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestLiteral( uint8_t ucByte )
+{
+    prvTestPutBits( 1U, 1U );
+    prvTestPutBits( ucByte, 8U );
+    ucExpected[ ulExpectedLen++ ] = ucByte;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Append a match of ulCount bytes starting ulDistance bytes back. Like the decoder, read
+ * the window zeroed before the start of the file. */
+
+static void prvTestBackref( uint32_t ulDistance,
+                            uint32_t ulCount )
+{
+    uint32_t ulIndex;
+
+    prvTestPutBits( 0U, 1U );
+    prvTestPutBits( ulDistance - 1U, otaconfigHEATSHRINK_WINDOW_SZ2 );
+    prvTestPutBits( ulCount - 1U, otaconfigHEATSHRINK_LOOKAHEAD_SZ2 );
+
+    for( ulIndex = 0U; ulIndex < ulCount; ulIndex++ )
+    {
+        ucExpected[ ulExpectedLen ] = ( ulExpectedLen >= ulDistance ) ? ucExpected[ ulExpectedLen - ulDistance ] : 0U;
+        ulExpectedLen++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Decompress the stream in pieces of at most ulPieceLen bytes, then finish it. */
+
+static OTA_Err_t prvTestDecompress( uint32_t ulPieceLen )
+{
+    OTA_Err_t xErr = kOTA_Err_None;
+    uint32_t ulCompressedLen = ( ulCompressedBits + 7U ) >> 3;
+    uint32_t ulOffset = 0U;
+    uint32_t ulLen;
+
+    ( void ) memset( ucWritten, 0, sizeof( ucWritten ) );
+    ulWrittenBytes = 0U;
+
+    OTA_Decompress_Init( &xDecompress, &xFile, prvTestWriteBlock, NULL );
+
+    while( ( xErr == kOTA_Err_None ) && ( ulOffset < ulCompressedLen ) )
+    {
+        ulLen = ( ulPieceLen < ( ulCompressedLen - ulOffset ) ) ? ulPieceLen : ( ulCompressedLen - ulOffset );
+        xErr = OTA_Decompress_Apply( &xDecompress, &xFile, &ucCompressed[ ulOffset ], ulLen );
+        ulOffset += ulLen;
+    }
+
+    if( xErr == kOTA_Err_None )
+    {
+        xErr = OTA_Decompress_Finish( &xDecompress, &xFile );
+    }
+
+    return xErr;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Decompress the stream and check it rebuilt ucExpected. */
+
+static void prvTestDecompressExpected( uint32_t ulPieceLen )
+{
+    xFile.ulUncompressedSize = ulExpectedLen;
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, prvTestDecompress( ulPieceLen ) );
+    TEST_ASSERT_EQUAL_UINT32( ulExpectedLen, ulWrittenBytes );
+    TEST_ASSERT_EQUAL_UINT8_ARRAY( ucExpected, ucWritten, ulExpectedLen );
+}
+
+/*-----------------------------------------------------------*/
+
+/* A stream of literals and matches at varied distances, running through the window
+ * several times and filling more than two output blocks. */
+
+static void prvTestBuildLongStream( void )
+{
+    uint32_t ulIndex;
+    uint32_t ulReach;
+
+    prvTestStartStream();
+
+    for( ulIndex = 0U; ulExpectedLen < ( otatestDECOMPRESS_MAX_SIZE - otatestDECOMPRESS_MAX_COUNT ); ulIndex++ )
+    {
+        if( ( ulIndex % 3U ) == 0U )
+        {
+            prvTestLiteral( ( uint8_t ) ( ulIndex * 29U ) );
+        }
+        else
+        {
+            ulReach = ( ulExpectedLen < OTA_HEATSHRINK_WINDOW_SIZE ) ? ulExpectedLen : OTA_HEATSHRINK_WINDOW_SIZE;
+            prvTestBackref( ( ( ulIndex * 37U ) % ulReach ) + 1U, ( ulIndex % otatestDECOMPRESS_MAX_COUNT ) + 1U );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_OTA_DECOMPRESS );
+
+TEST_SETUP( Full_OTA_DECOMPRESS )
+{
+    ( void ) memset( &xFile, 0, sizeof( xFile ) );
+    xFile.pucCompression = ( uint8_t * ) OTA_COMPRESSION_HEATSHRINK;
+}
+
+TEST_TEAR_DOWN( Full_OTA_DECOMPRESS )
+{
+}
+
+TEST_GROUP_RUNNER( Full_OTA_DECOMPRESS )
+{
+    RUN_TEST_CASE( Full_OTA_DECOMPRESS, OTA_Decompress_Literals );
+    RUN_TEST_CASE( Full_OTA_DECOMPRESS, OTA_Decompress_OverlappingBackref );
+    RUN_TEST_CASE( Full_OTA_DECOMPRESS, OTA_Decompress_WindowWrap );
+    RUN_TEST_CASE( Full_OTA_DECOMPRESS, OTA_Decompress_SplitAcrossBlocks );
+    RUN_TEST_CASE( Full_OTA_DECOMPRESS, OTA_Decompress_Overrun );
+    RUN_TEST_CASE( Full_OTA_DECOMPRESS, OTA_Decompress_Truncated );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_OTA_DECOMPRESS, OTA_Decompress_Literals )
+{
+    const char * pcText = "heatshrink";
+    uint32_t ulIndex;
+
+    prvTestStartStream();
+
+    for( ulIndex = 0U; pcText[ ulIndex ] != '\0'; ulIndex++ )
+    {
+        prvTestLiteral( ( uint8_t ) pcText[ ulIndex ] );
+    }
+
+    prvTestDecompressExpected( otatestDECOMPRESS_MAX_COMPRESSED );
+    TEST_ASSERT_EQUAL_UINT8_ARRAY( pcText, ucWritten, strlen( pcText ) );
+}
+
+TEST( Full_OTA_DECOMPRESS, OTA_Decompress_OverlappingBackref )
+{
+    static const uint8_t ucRuns[] = { 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'b', 'c', 'b', 'c', 'b', 'c', 'b' };
+
+    /* Matches longer than their distance repeat the bytes they are copying. */
+    prvTestStartStream();
+    prvTestLiteral( 'a' );
+    prvTestBackref( 1U, 10U );
+    prvTestLiteral( 'b' );
+    prvTestLiteral( 'c' );
+    prvTestBackref( 2U, 5U );
+
+    prvTestDecompressExpected( otatestDECOMPRESS_MAX_COMPRESSED );
+    TEST_ASSERT_EQUAL_UINT32( sizeof( ucRuns ), ulExpectedLen );
+    TEST_ASSERT_EQUAL_UINT8_ARRAY( ucRuns, ucWritten, sizeof( ucRuns ) );
+
+    /* A match reaching back before the start of the file reads the zeroed window. */
+    prvTestStartStream();
+    prvTestLiteral( 'z' );
+    prvTestBackref( 4U, 3U );
+    prvTestBackref( 4U, 1U );
+
+    prvTestDecompressExpected( otatestDECOMPRESS_MAX_COMPRESSED );
+    TEST_ASSERT_EQUAL_UINT8( 0U, ucWritten[ 1 ] );
+    TEST_ASSERT_EQUAL_UINT8( 'z', ucWritten[ 4 ] );
+}
+
+TEST( Full_OTA_DECOMPRESS, OTA_Decompress_WindowWrap )
+{
+    uint32_t ulIndex;
+
+    /* Fill more than the window, then copy from its far end so the match wraps around it. */
+    prvTestStartStream();
+
+    for( ulIndex = 0U; ulIndex < ( OTA_HEATSHRINK_WINDOW_SIZE + 7U ); ulIndex++ )
+    {
+        prvTestLiteral( ( uint8_t ) ( ( ulIndex * 11U ) + ( ulIndex >> 8 ) ) );
+    }
+
+    prvTestBackref( OTA_HEATSHRINK_WINDOW_SIZE, otatestDECOMPRESS_MAX_COUNT );
+    prvTestBackref( OTA_HEATSHRINK_WINDOW_SIZE - 3U, otatestDECOMPRESS_MAX_COUNT );
+    prvTestDecompressExpected( otatestDECOMPRESS_MAX_COMPRESSED );
+
+    /* And a long stream of matches at varied distances. */
+    prvTestBuildLongStream();
+    prvTestDecompressExpected( otatestDECOMPRESS_MAX_COMPRESSED );
+}
+
+TEST( Full_OTA_DECOMPRESS, OTA_Decompress_SplitAcrossBlocks )
+{
+    /* Pieces of these sizes split literals, distances and lengths at every bit offset. */
+    static const uint32_t ulPieceLens[] = { 1U, 2U, 3U, 7U, 100U };
+    uint32_t ulIndex;
+
+    prvTestBuildLongStream();
+
+    for( ulIndex = 0U; ulIndex < ( sizeof( ulPieceLens ) / sizeof( ulPieceLens[ 0 ] ) ); ulIndex++ )
+    {
+        prvTestDecompressExpected( ulPieceLens[ ulIndex ] );
+    }
+}
+
+TEST( Full_OTA_DECOMPRESS, OTA_Decompress_Overrun )
+{
+    /* Output past ulUncompressedSize is rejected, whether by a literal or inside a match. */
+    prvTestStartStream();
+    prvTestLiteral( 'a' );
+    prvTestLiteral( 'b' );
+    xFile.ulUncompressedSize = 1U;
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DecompressFailed, prvTestDecompress( otatestDECOMPRESS_MAX_COMPRESSED ) );
+
+    prvTestStartStream();
+    prvTestLiteral( 'a' );
+    prvTestBackref( 1U, 8U );
+    xFile.ulUncompressedSize = 5U;
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DecompressFailed, prvTestDecompress( 1U ) );
+    TEST_ASSERT_EQUAL_UINT32( 0U, ulWrittenBytes );
+}
+
+TEST( Full_OTA_DECOMPRESS, OTA_Decompress_Truncated )
+{
+    /* A stream that ends short of ulUncompressedSize fails at the finish. */
+    prvTestStartStream();
+    prvTestLiteral( 'a' );
+    prvTestBackref( 1U, 4U );
+    xFile.ulUncompressedSize = ulExpectedLen + 1U;
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DecompressFailed, prvTestDecompress( otatestDECOMPRESS_MAX_COMPRESSED ) );
+    TEST_ASSERT_EQUAL_UINT32( 0U, ulWrittenBytes );
+}
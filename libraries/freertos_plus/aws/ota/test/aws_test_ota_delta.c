@@ -0,0 +1,332 @@
+/*
+ * FreeRTOS OTA V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Unity framework includes. */
+#include "unity_fixture.h"
+#include "unity.h"
+
+/* OTA includes. */
+#include "aws_iot_ota_agent.h"
+#include "aws_iot_ota_agent_internal.h"
+#include "aws_iot_ota_delta.h"
+
+/**
+ * @brief Configuration for this test group.
+ */
+#define otatestDELTA_BASE_SIZE     5000U
+#define otatestDELTA_IMAGE_SIZE    6000U
+#define otatestDELTA_MAX_RECORDS   3U
+#define otatestDELTA_PATCH_SIZE    ( OTA_DELTA_HEADER_SIZE + ( otatestDELTA_MAX_RECORDS * OTA_DELTA_CONTROL_SIZE ) + otatestDELTA_IMAGE_SIZE )
+
+/* SHA-256 of the base image filled in by prvTestFillImages. */
+#define otatestDELTA_BASE_HASH     "1b5c855ff1052578ee7d262a7a7b784281ff77178d83435e3fc858874e8a5b10"
+
+/* The running image the patch is applied against, the image it must rebuild and the image
+ * actually written through the write block callback. */
+static uint8_t ucBaseImage[ otatestDELTA_BASE_SIZE ];
+static uint8_t ucNewImage[ otatestDELTA_IMAGE_SIZE ];
+static uint8_t ucWrittenImage[ otatestDELTA_IMAGE_SIZE ];
+static uint32_t ulWrittenBytes;
+
+static uint8_t ucPatch[ otatestDELTA_PATCH_SIZE ];
+static uint32_t ulPatchLen;
+static uint32_t ulPatchOldPos;
+static uint32_t ulPatchNewPos;
+
+static OTA_DeltaContext_t xDelta;
+static OTA_FileContext_t xFile;
+
+/*-----------------------------------------------------------*/
+
+static int16_t prvTestWriteBlock( OTA_FileContext_t * const C,
+                                  uint32_t ulOffset,
+                                  uint8_t * const pucData,
+                                  uint32_t ulBlockSize )
+{
+    int16_t sResult = -1;
+
+    ( void ) C;
+
+    if( ( ulOffset <= otatestDELTA_IMAGE_SIZE ) && ( ulBlockSize <= ( otatestDELTA_IMAGE_SIZE - ulOffset ) ) )
+    {
+        ( void ) memcpy( &ucWrittenImage[ ulOffset ], pucData, ulBlockSize );
+        ulWrittenBytes += ulBlockSize;
+        sResult = ( int16_t ) ulBlockSize;
+    }
+
+    return sResult;
+}
+
+/*-----------------------------------------------------------*/
+
+static int32_t prvTestReadBaseImage( uint32_t ulOffset,
+                                     uint8_t * pucBuffer,
+                                     uint32_t ulLength )
+{
+    int32_t lRead = 0;
+
+    if( ulOffset < otatestDELTA_BASE_SIZE )
+    {
+        lRead = ( int32_t ) ( ( ulLength < ( otatestDELTA_BASE_SIZE - ulOffset ) ) ? ulLength : ( otatestDELTA_BASE_SIZE - ulOffset ) );
+        ( void ) memcpy( pucBuffer, &ucBaseImage[ ulOffset ], ( size_t ) lRead );
+    }
+
+    return lRead;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestFillImages( void )
+{
+    uint32_t ulIndex;
+
+    for( ulIndex = 0U; ulIndex < otatestDELTA_BASE_SIZE; ulIndex++ )
+    {
+        ucBaseImage[ ulIndex ] = ( uint8_t ) ( ( ulIndex * 7U ) + ( ulIndex >> 8 ) );
+    }
+
+    for( ulIndex = 0U; ulIndex < otatestDELTA_IMAGE_SIZE; ulIndex++ )
+    {
+        ucNewImage[ ulIndex ] = ( uint8_t ) ( ( ulIndex * 13U ) + 5U );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestPutLE32( uint32_t ulValue )
+{
+    ucPatch[ ulPatchLen++ ] = ( uint8_t ) ulValue;
+    ucPatch[ ulPatchLen++ ] = ( uint8_t ) ( ulValue >> 8 );
+    ucPatch[ ulPatchLen++ ] = ( uint8_t ) ( ulValue >> 16 );
+    ucPatch[ ulPatchLen++ ] = ( uint8_t ) ( ulValue >> 24 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestStartPatch( uint32_t ulImageSize )
+{
+    ulPatchLen = 0U;
+    ulPatchOldPos = 0U;
+    ulPatchNewPos = 0U;
+    ( void ) memcpy( ucPatch, OTA_DELTA_MAGIC, OTA_DELTA_MAGIC_SIZE );
+    ulPatchLen += OTA_DELTA_MAGIC_SIZE;
+    prvTestPutLE32( ulImageSize );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Append a record rebuilding the next ulDiffLen + ulExtraLen bytes of ucNewImage. */
+
+static void prvTestAddRecord( uint32_t ulDiffLen,
+                              uint32_t ulExtraLen,
+                              int32_t lSeek )
+{
+    uint32_t ulIndex;
+
+    prvTestPutLE32( ulDiffLen );
+    prvTestPutLE32( ulExtraLen );
+    prvTestPutLE32( ( uint32_t ) lSeek );
+
+    for( ulIndex = 0U; ulIndex < ulDiffLen; ulIndex++ )
+    {
+        ucPatch[ ulPatchLen++ ] = ( uint8_t ) ( ucNewImage[ ulPatchNewPos++ ] - ucBaseImage[ ulPatchOldPos++ ] );
+    }
+
+    for( ulIndex = 0U; ulIndex < ulExtraLen; ulIndex++ )
+    {
+        ucPatch[ ulPatchLen++ ] = ucNewImage[ ulPatchNewPos++ ];
+    }
+
+    ulPatchOldPos = ( uint32_t ) ( ( int32_t ) ulPatchOldPos + lSeek );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Build a patch of two records, moving the base position forward and then back. */
+
+static void prvTestBuildPatch( bool bEmptyFinalRecord )
+{
+    prvTestStartPatch( otatestDELTA_IMAGE_SIZE );
+    prvTestAddRecord( 2500U, 300U, 1000 );
+    prvTestAddRecord( 1500U, 1700U, -4000 );
+
+    if( bEmptyFinalRecord == true )
+    {
+        prvTestAddRecord( 0U, 0U, 0 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Apply the patch in pieces of at most ulPieceLen bytes, then finish it. */
+
+static OTA_Err_t prvTestApplyPatch( uint32_t ulPieceLen )
+{
+    OTA_Err_t xErr;
+    uint32_t ulOffset = 0U;
+    uint32_t ulLen;
+
+    xErr = OTA_Delta_Init( &xDelta, &xFile, prvTestWriteBlock, prvTestReadBaseImage );
+
+    while( ( xErr == kOTA_Err_None ) && ( ulOffset < ulPatchLen ) )
+    {
+        ulLen = ( ulPieceLen < ( ulPatchLen - ulOffset ) ) ? ulPieceLen : ( ulPatchLen - ulOffset );
+        xErr = OTA_Delta_Apply( &xDelta, &xFile, &ucPatch[ ulOffset ], ulLen );
+        ulOffset += ulLen;
+    }
+
+    if( xErr == kOTA_Err_None )
+    {
+        xErr = OTA_Delta_Finish( &xDelta, &xFile );
+    }
+
+    return xErr;
+}
+
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_OTA_DELTA );
+
+TEST_SETUP( Full_OTA_DELTA )
+{
+    prvTestFillImages();
+    ( void ) memset( ucWrittenImage, 0, sizeof( ucWrittenImage ) );
+    ulWrittenBytes = 0U;
+
+    ( void ) memset( &xFile, 0, sizeof( xFile ) );
+    xFile.ulDeltaImageSize = otatestDELTA_IMAGE_SIZE;
+    xFile.pucDeltaBase = ( uint8_t * ) otatestDELTA_BASE_HASH;
+}
+
+TEST_TEAR_DOWN( Full_OTA_DELTA )
+{
+}
+
+TEST_GROUP_RUNNER( Full_OTA_DELTA )
+{
+    RUN_TEST_CASE( Full_OTA_DELTA, OTA_Delta_WholePatch );
+    RUN_TEST_CASE( Full_OTA_DELTA, OTA_Delta_EmptyFinalRecord );
+    RUN_TEST_CASE( Full_OTA_DELTA, OTA_Delta_SplitAcrossBlocks );
+    RUN_TEST_CASE( Full_OTA_DELTA, OTA_Delta_WrongBase );
+    RUN_TEST_CASE( Full_OTA_DELTA, OTA_Delta_CorruptHeader );
+    RUN_TEST_CASE( Full_OTA_DELTA, OTA_Delta_RecordOverrunsImage );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_OTA_DELTA, OTA_Delta_WholePatch )
+{
+    prvTestBuildPatch( false );
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, prvTestApplyPatch( ulPatchLen ) );
+    TEST_ASSERT_EQUAL_UINT32( otatestDELTA_IMAGE_SIZE, ulWrittenBytes );
+    TEST_ASSERT_EQUAL_UINT8_ARRAY( ucNewImage, ucWrittenImage, otatestDELTA_IMAGE_SIZE );
+}
+
+TEST( Full_OTA_DELTA, OTA_Delta_EmptyFinalRecord )
+{
+    /* An empty record at the very end of the patch must still leave it complete. */
+    prvTestBuildPatch( true );
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, prvTestApplyPatch( ulPatchLen ) );
+    TEST_ASSERT_EQUAL_UINT8_ARRAY( ucNewImage, ucWrittenImage, otatestDELTA_IMAGE_SIZE );
+
+    /* Also when the empty record arrives in its own block. */
+    ( void ) memset( ucWrittenImage, 0, sizeof( ucWrittenImage ) );
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, prvTestApplyPatch( ulPatchLen - OTA_DELTA_CONTROL_SIZE ) );
+    TEST_ASSERT_EQUAL_UINT8_ARRAY( ucNewImage, ucWrittenImage, otatestDELTA_IMAGE_SIZE );
+}
+
+TEST( Full_OTA_DELTA, OTA_Delta_SplitAcrossBlocks )
+{
+    /* Pieces of these sizes split the header, the control records and the diff and extra
+     * bytes at many different places. */
+    static const uint32_t ulPieceLens[] = { 1U, 5U, 11U, 13U, 1000U };
+    uint32_t ulIndex;
+
+    prvTestBuildPatch( true );
+
+    for( ulIndex = 0U; ulIndex < ( sizeof( ulPieceLens ) / sizeof( ulPieceLens[ 0 ] ) ); ulIndex++ )
+    {
+        ( void ) memset( ucWrittenImage, 0, sizeof( ucWrittenImage ) );
+        ulWrittenBytes = 0U;
+
+        TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, prvTestApplyPatch( ulPieceLens[ ulIndex ] ) );
+        TEST_ASSERT_EQUAL_UINT32( otatestDELTA_IMAGE_SIZE, ulWrittenBytes );
+        TEST_ASSERT_EQUAL_UINT8_ARRAY( ucNewImage, ucWrittenImage, otatestDELTA_IMAGE_SIZE );
+    }
+}
+
+TEST( Full_OTA_DELTA, OTA_Delta_WrongBase )
+{
+    ucBaseImage[ 0 ] ^= 0xffU;
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DeltaBaseMismatch,
+                              OTA_Delta_Init( &xDelta, &xFile, prvTestWriteBlock, prvTestReadBaseImage ) );
+}
+
+TEST( Full_OTA_DELTA, OTA_Delta_CorruptHeader )
+{
+    /* A bad magic is rejected, and so is everything after it. */
+    prvTestBuildPatch( false );
+    ucPatch[ 0 ] ^= 0xffU;
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, OTA_Delta_Init( &xDelta, &xFile, prvTestWriteBlock, prvTestReadBaseImage ) );
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DeltaPatchInvalid,
+                              OTA_Delta_Apply( &xDelta, &xFile, ucPatch, OTA_DELTA_HEADER_SIZE ) );
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DeltaPatchInvalid,
+                              OTA_Delta_Apply( &xDelta, &xFile, &ucPatch[ OTA_DELTA_HEADER_SIZE ], 1U ) );
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DeltaPatchInvalid, OTA_Delta_Finish( &xDelta, &xFile ) );
+
+    /* A header naming a different image size than the job is rejected. */
+    prvTestStartPatch( otatestDELTA_IMAGE_SIZE + 1U );
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DeltaPatchInvalid, prvTestApplyPatch( ulPatchLen ) );
+
+    /* A patch that ends inside the header leaves the image incomplete. */
+    prvTestBuildPatch( false );
+    ulPatchLen = OTA_DELTA_HEADER_SIZE - 1U;
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DeltaPatchInvalid, prvTestApplyPatch( ulPatchLen ) );
+    TEST_ASSERT_EQUAL_UINT32( 0U, ulWrittenBytes );
+}
+
+TEST( Full_OTA_DELTA, OTA_Delta_RecordOverrunsImage )
+{
+    /* A record building past the end of the image is rejected before any of it is written. */
+    prvTestStartPatch( otatestDELTA_IMAGE_SIZE );
+    prvTestPutLE32( otatestDELTA_IMAGE_SIZE );
+    prvTestPutLE32( 1U );
+    prvTestPutLE32( 0U );
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DeltaPatchInvalid, prvTestApplyPatch( ulPatchLen ) );
+    TEST_ASSERT_EQUAL_UINT32( 0U, ulWrittenBytes );
+}
@@ -35,6 +35,28 @@
 #define cryptoSHA1_DIGEST_BYTES      20
 #define cryptoSHA256_DIGEST_BYTES    32
 
+/**
+ * @brief Use spinning mutexes with contention counters for mbedTLS.
+ *
+ * When set to 1, a held mbedTLS mutex is retried without blocking
+ * cryptoconfigMUTEX_SPIN_COUNT times before the task blocks on it. The lock is
+ * still a FreeRTOS mutex, so a blocked task passes its priority on to the
+ * holder. The counters are read with CRYPTO_GetMutexStats().
+ */
+#ifndef cryptoconfigUSE_SPIN_MUTEX
+    #define cryptoconfigUSE_SPIN_MUTEX    0
+#endif
+
+/**
+ * @brief Number of times a held mbedTLS mutex is retried before the task blocks.
+ *
+ * Spinning pays off when the holder runs on another core. Set it to 0 on
+ * single core devices.
+ */
+#ifndef cryptoconfigMUTEX_SPIN_COUNT
+    #define cryptoconfigMUTEX_SPIN_COUNT    64
+#endif
+
 /**
  * @brief Initializes the heap and threading functions for cryptography libraries.
  */
@@ -49,6 +71,36 @@ void CRYPTO_Init( void );
  */
 void CRYPTO_ConfigureThreading( void );
 
+#if ( cryptoconfigUSE_SPIN_MUTEX == 1 )
+
+/**
+ * @brief Contention counters of an mbedTLS mutex.
+ *
+ * @param[out] pvMutex The mbedtls_threading_mutex_t the counters belong to.
+ * @param[out] ulLocks Number of times the mutex was locked.
+ * @param[out] ulContended Number of locks that found the mutex held.
+ * @param[out] ulBlocked Number of contended locks that had to block after spinning.
+ */
+    typedef struct CryptoMutexStats
+    {
+        const void * pvMutex;
+        uint32_t ulLocks;
+        uint32_t ulContended;
+        uint32_t ulBlocked;
+    } CryptoMutexStats_t;
+
+/**
+ * @brief Copies the counters of the mbedTLS mutexes in use.
+ *
+ * @param[out] pxStats Array to fill with counters.
+ * @param[in] xMaxStats Number of entries in pxStats.
+ *
+ * @return Number of mutexes in use, which may exceed xMaxStats.
+ */
+    size_t CRYPTO_GetMutexStats( CryptoMutexStats_t * pxStats,
+                                 size_t xMaxStats );
+#endif /* if ( cryptoconfigUSE_SPIN_MUTEX == 1 ) */
+
 /**
  * @brief Library-independent cryptographic algorithm identifiers.
  */
@@ -25,8 +25,14 @@
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
 #include "iot_crypto.h"
 
+#if ( cryptoconfigUSE_SPIN_MUTEX == 1 )
+    #include "iot_atomic.h"
+#endif
+
 /* mbedTLS includes. */
 
 #if !defined( MBEDTLS_CONFIG_FILE )
@@ -91,37 +97,113 @@ typedef struct SignatureVerificationState
 /*--------------- See MBEDTLS_THREADING_ALT -----------------*/
 /*-----------------------------------------------------------*/
 
+#if ( cryptoconfigUSE_SPIN_MUTEX == 1 )
+
 /**
- * @brief Implementation of mbedtls_mutex_init for thread-safety.
+ * @brief Spinning mutex behind an mbedtls_threading_mutex_t, whose handle
+ * field points to it.
  *
+ * xMutex is a FreeRTOS mutex. It is first tried without blocking, and a task
+ * that still finds it held after spinning blocks on it, so the holder inherits
+ * the priority of the waiting task as with the default mutexes.
  */
-void aws_mbedtls_mutex_init( mbedtls_threading_mutex_t * mutex )
-{
-    mutex->mutex = xSemaphoreCreateMutex();
-
-    if( mutex->mutex != NULL )
+    typedef struct CryptoMutex
     {
-        mutex->is_valid = 1;
-    }
-    else
+        SemaphoreHandle_t xMutex;
+        const void * pvOwner;
+        uint32_t ulLocks;
+        uint32_t ulContended;
+        uint32_t ulBlocked;
+        struct CryptoMutex * pxPrev;
+        struct CryptoMutex * pxNext;
+    } CryptoMutex_t;
+
+/**
+ * @brief Mutexes in use, for CRYPTO_GetMutexStats().
+ */
+    static CryptoMutex_t * pxCryptoMutexList = NULL;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Implementation of mbedtls_mutex_init for thread-safety.
+ *
+ */
+    void aws_mbedtls_mutex_init( mbedtls_threading_mutex_t * mutex )
     {
+        CryptoMutex_t * pxMutex = ( CryptoMutex_t * ) pvPortMalloc( sizeof( CryptoMutex_t ) );
+
         mutex->is_valid = 0;
-        CRYPTO_PRINT( ( "Failed to initialize mbedTLS mutex.\r\n" ) );
+
+        if( pxMutex != NULL )
+        {
+            memset( pxMutex, 0, sizeof( CryptoMutex_t ) );
+            pxMutex->xMutex = xSemaphoreCreateMutex();
+
+            if( pxMutex->xMutex == NULL )
+            {
+                vPortFree( pxMutex );
+                pxMutex = NULL;
+            }
+        }
+
+        if( pxMutex != NULL )
+        {
+            pxMutex->pvOwner = mutex;
+
+            taskENTER_CRITICAL();
+            pxMutex->pxNext = pxCryptoMutexList;
+
+            if( pxCryptoMutexList != NULL )
+            {
+                pxCryptoMutexList->pxPrev = pxMutex;
+            }
+
+            pxCryptoMutexList = pxMutex;
+            taskEXIT_CRITICAL();
+
+            mutex->mutex = ( SemaphoreHandle_t ) pxMutex; /*lint !e9087 The handle is opaque to mbedTLS. */
+            mutex->is_valid = 1;
+        }
+        else
+        {
+            CRYPTO_PRINT( ( "Failed to initialize mbedTLS mutex.\r\n" ) );
+        }
     }
-}
 
 /**
  * @brief Implementation of mbedtls_mutex_free for thread-safety.
  *
  */
-void aws_mbedtls_mutex_free( mbedtls_threading_mutex_t * mutex )
-{
-    if( mutex->is_valid == 1 )
+    void aws_mbedtls_mutex_free( mbedtls_threading_mutex_t * mutex )
     {
-        vSemaphoreDelete( mutex->mutex );
-        mutex->is_valid = 0;
+        CryptoMutex_t * pxMutex = ( CryptoMutex_t * ) mutex->mutex; /*lint !e9087 The handle is opaque to mbedTLS. */
+
+        if( mutex->is_valid == 1 )
+        {
+            taskENTER_CRITICAL();
+
+            if( pxMutex->pxPrev != NULL )
+            {
+                pxMutex->pxPrev->pxNext = pxMutex->pxNext;
+            }
+            else
+            {
+                pxCryptoMutexList = pxMutex->pxNext;
+            }
+
+            if( pxMutex->pxNext != NULL )
+            {
+                pxMutex->pxNext->pxPrev = pxMutex->pxPrev;
+            }
+
+            taskEXIT_CRITICAL();
+
+            vSemaphoreDelete( pxMutex->xMutex );
+            vPortFree( pxMutex );
+            mutex->is_valid = 0;
+        }
     }
-}
 
 /**
  * @brief Implementation of mbedtls_mutex_lock for thread-safety.
@@ -129,51 +211,189 @@ void aws_mbedtls_mutex_free( mbedtls_threading_mutex_t * mutex )
  * @return 0 if successful, MBEDTLS_ERR_THREADING_MUTEX_ERROR if timeout,
  * MBEDTLS_ERR_THREADING_BAD_INPUT_DATA if the mutex is not valid.
  */
-int aws_mbedtls_mutex_lock( mbedtls_threading_mutex_t * mutex )
-{
-    int ret = MBEDTLS_ERR_THREADING_BAD_INPUT_DATA;
-
-    if( mutex->is_valid == 1 )
+    int aws_mbedtls_mutex_lock( mbedtls_threading_mutex_t * mutex )
     {
-        if( xSemaphoreTake( mutex->mutex, portMAX_DELAY ) )
+        int ret = MBEDTLS_ERR_THREADING_BAD_INPUT_DATA;
+        CryptoMutex_t * pxMutex = ( CryptoMutex_t * ) mutex->mutex; /*lint !e9087 The handle is opaque to mbedTLS. */
+        uint32_t ulSpins = 0;
+        BaseType_t xLocked;
+
+        if( mutex->is_valid == 1 )
         {
             ret = 0;
+            ( void ) Atomic_Increment_u32( &pxMutex->ulLocks );
+            xLocked = xSemaphoreTake( pxMutex->xMutex, 0 );
+
+            if( xLocked == pdFALSE )
+            {
+                ( void ) Atomic_Increment_u32( &pxMutex->ulContended );
+
+                while( ( xLocked == pdFALSE ) && ( ulSpins < cryptoconfigMUTEX_SPIN_COUNT ) )
+                {
+                    ulSpins++;
+                    xLocked = xSemaphoreTake( pxMutex->xMutex, 0 );
+                }
+            }
+
+            if( xLocked == pdFALSE )
+            {
+                ( void ) Atomic_Increment_u32( &pxMutex->ulBlocked );
+
+                /* Block on the mutex itself, so the holder inherits our
+                 * priority while we wait. */
+                if( xSemaphoreTake( pxMutex->xMutex, portMAX_DELAY ) != pdTRUE )
+                {
+                    ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
+                    CRYPTO_PRINT( ( "Failed to obtain mbedTLS mutex.\r\n" ) );
+                }
+            }
+        }
+
+        return ret;
+    }
+
+/**
+ * @brief Implementation of mbedtls_mutex_unlock for thread-safety.
+ *
+ * @return 0 if successful, MBEDTLS_ERR_THREADING_MUTEX_ERROR if the mutex
+ * was not locked by the calling task, MBEDTLS_ERR_THREADING_BAD_INPUT_DATA if
+ * the mutex is not valid.
+ */
+    int aws_mbedtls_mutex_unlock( mbedtls_threading_mutex_t * mutex )
+    {
+        int ret = MBEDTLS_ERR_THREADING_BAD_INPUT_DATA;
+        CryptoMutex_t * pxMutex = ( CryptoMutex_t * ) mutex->mutex; /*lint !e9087 The handle is opaque to mbedTLS. */
+
+        if( mutex->is_valid == 1 )
+        {
+            if( xSemaphoreGive( pxMutex->xMutex ) == pdTRUE )
+            {
+                ret = 0;
+            }
+            else
+            {
+                ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
+                CRYPTO_PRINT( ( "Failed to unlock mbedTLS mutex.\r\n" ) );
+            }
+        }
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    size_t CRYPTO_GetMutexStats( CryptoMutexStats_t * pxStats,
+                                 size_t xMaxStats )
+    {
+        CryptoMutex_t * pxMutex;
+        size_t xCount = 0;
+
+        taskENTER_CRITICAL();
+
+        for( pxMutex = pxCryptoMutexList; pxMutex != NULL; pxMutex = pxMutex->pxNext )
+        {
+            if( xCount < xMaxStats )
+            {
+                pxStats[ xCount ].pvMutex = pxMutex->pvOwner;
+                pxStats[ xCount ].ulLocks = pxMutex->ulLocks;
+                pxStats[ xCount ].ulContended = pxMutex->ulContended;
+                pxStats[ xCount ].ulBlocked = pxMutex->ulBlocked;
+            }
+
+            xCount++;
+        }
+
+        taskEXIT_CRITICAL();
+
+        return xCount;
+    }
+
+#else /* if ( cryptoconfigUSE_SPIN_MUTEX == 1 ) */
+
+/**
+ * @brief Implementation of mbedtls_mutex_init for thread-safety.
+ *
+ */
+    void aws_mbedtls_mutex_init( mbedtls_threading_mutex_t * mutex )
+    {
+        mutex->mutex = xSemaphoreCreateMutex();
+
+        if( mutex->mutex != NULL )
+        {
+            mutex->is_valid = 1;
         }
         else
         {
-            ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
-            CRYPTO_PRINT( ( "Failed to obtain mbedTLS mutex.\r\n" ) );
+            mutex->is_valid = 0;
+            CRYPTO_PRINT( ( "Failed to initialize mbedTLS mutex.\r\n" ) );
         }
     }
 
-    return ret;
-}
+/**
+ * @brief Implementation of mbedtls_mutex_free for thread-safety.
+ *
+ */
+    void aws_mbedtls_mutex_free( mbedtls_threading_mutex_t * mutex )
+    {
+        if( mutex->is_valid == 1 )
+        {
+            vSemaphoreDelete( mutex->mutex );
+            mutex->is_valid = 0;
+        }
+    }
 
 /**
- * @brief Implementation of mbedtls_mutex_unlock for thread-safety.
+ * @brief Implementation of mbedtls_mutex_lock for thread-safety.
  *
  * @return 0 if successful, MBEDTLS_ERR_THREADING_MUTEX_ERROR if timeout,
  * MBEDTLS_ERR_THREADING_BAD_INPUT_DATA if the mutex is not valid.
  */
-int aws_mbedtls_mutex_unlock( mbedtls_threading_mutex_t * mutex )
-{
-    int ret = MBEDTLS_ERR_THREADING_BAD_INPUT_DATA;
-
-    if( mutex->is_valid == 1 )
+    int aws_mbedtls_mutex_lock( mbedtls_threading_mutex_t * mutex )
     {
-        if( xSemaphoreGive( mutex->mutex ) )
+        int ret = MBEDTLS_ERR_THREADING_BAD_INPUT_DATA;
+
+        if( mutex->is_valid == 1 )
         {
-            ret = 0;
+            if( xSemaphoreTake( mutex->mutex, portMAX_DELAY ) )
+            {
+                ret = 0;
+            }
+            else
+            {
+                ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
+                CRYPTO_PRINT( ( "Failed to obtain mbedTLS mutex.\r\n" ) );
+            }
         }
-        else
+
+        return ret;
+    }
+
+/**
+ * @brief Implementation of mbedtls_mutex_unlock for thread-safety.
+ *
+ * @return 0 if successful, MBEDTLS_ERR_THREADING_MUTEX_ERROR if timeout,
+ * MBEDTLS_ERR_THREADING_BAD_INPUT_DATA if the mutex is not valid.
+ */
+    int aws_mbedtls_mutex_unlock( mbedtls_threading_mutex_t * mutex )
+    {
+        int ret = MBEDTLS_ERR_THREADING_BAD_INPUT_DATA;
+
+        if( mutex->is_valid == 1 )
         {
-            ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
-            CRYPTO_PRINT( ( "Failed to unlock mbedTLS mutex.\r\n" ) );
+            if( xSemaphoreGive( mutex->mutex ) )
+            {
+                ret = 0;
+            }
+            else
+            {
+                ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
+                CRYPTO_PRINT( ( "Failed to unlock mbedTLS mutex.\r\n" ) );
+            }
         }
-    }
 
-    return ret;
-}
+        return ret;
+    }
+#endif /* if ( cryptoconfigUSE_SPIN_MUTEX == 1 ) */
 
 /*-----------------------------------------------------------*/
 
@@ -36,6 +36,10 @@
 #include "unity_fixture.h"
 #include "unity.h"
 
+#if ( cryptoconfigUSE_SPIN_MUTEX == 1 )
+    #include "mbedtls/threading.h"
+#endif
+
 TEST_GROUP( Full_CRYPTO );
 
 TEST_SETUP( Full_CRYPTO )
@@ -49,6 +53,9 @@ TEST_TEAR_DOWN( Full_CRYPTO )
 TEST_GROUP_RUNNER( Full_CRYPTO )
 {
     RUN_TEST_CASE( Full_CRYPTO, VerifySignatureTestVectors );
+    #if ( cryptoconfigUSE_SPIN_MUTEX == 1 )
+        RUN_TEST_CASE( Full_CRYPTO, MutexStats );
+    #endif
 }
 
 TEST( Full_CRYPTO, VerifySignatureTestVectors )
@@ -281,3 +288,43 @@ TEST( Full_CRYPTO, VerifySignatureTestVectors )
     TEST_ASSERT_FALSE( xResult );
     /** @}*/
 }
+
+#if ( cryptoconfigUSE_SPIN_MUTEX == 1 )
+    TEST( Full_CRYPTO, MutexStats )
+    {
+        mbedtls_threading_mutex_t xMutex;
+        CryptoMutexStats_t xStats[ 16 ];
+        size_t xCount;
+        size_t xIndex;
+        BaseType_t xFound = pdFALSE;
+
+        CRYPTO_ConfigureThreading();
+        mbedtls_mutex_init( &xMutex );
+
+        TEST_ASSERT_EQUAL_INT( 0, mbedtls_mutex_lock( &xMutex ) );
+        TEST_ASSERT_EQUAL_INT( 0, mbedtls_mutex_unlock( &xMutex ) );
+        TEST_ASSERT_EQUAL_INT( 0, mbedtls_mutex_lock( &xMutex ) );
+        TEST_ASSERT_EQUAL_INT( 0, mbedtls_mutex_unlock( &xMutex ) );
+
+        /* Unlocking a mutex that is not locked is an error. */
+        TEST_ASSERT_NOT_EQUAL( 0, mbedtls_mutex_unlock( &xMutex ) );
+
+        xCount = CRYPTO_GetMutexStats( xStats, sizeof( xStats ) / sizeof( xStats[ 0 ] ) );
+
+        for( xIndex = 0; ( xIndex < xCount ) && ( xIndex < ( sizeof( xStats ) / sizeof( xStats[ 0 ] ) ) ); xIndex++ )
+        {
+            if( xStats[ xIndex ].pvMutex == &xMutex )
+            {
+                xFound = pdTRUE;
+                TEST_ASSERT_EQUAL_UINT32( 2, xStats[ xIndex ].ulLocks );
+                TEST_ASSERT_EQUAL_UINT32( 0, xStats[ xIndex ].ulContended );
+                TEST_ASSERT_EQUAL_UINT32( 0, xStats[ xIndex ].ulBlocked );
+            }
+        }
+
+        mbedtls_mutex_free( &xMutex );
+
+        TEST_ASSERT_TRUE( xFound );
+        TEST_ASSERT_EQUAL( xCount - 1U, CRYPTO_GetMutexStats( xStats, 0 ) );
+    }
+#endif /* if ( cryptoconfigUSE_SPIN_MUTEX == 1 ) */
@@ -0,0 +1,65 @@
+/*
+ * FreeRTOS+CLI V1.0.4
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ */
+
+#ifndef FREERTOS_CLI_STATS_H
+#define FREERTOS_CLI_STATS_H
+
+/*
+ * Which groups of counters the statistics commands report.  Each group needs
+ * the library it reports on to be part of the build.  Set any of them to 0 in
+ * FreeRTOSConfig.h to leave that group out.
+ */
+#ifndef configCLI_STATS_INCLUDE_TASKPOOL
+    #define configCLI_STATS_INCLUDE_TASKPOOL    1
+#endif
+
+#ifndef configCLI_STATS_INCLUDE_MQTT
+    #define configCLI_STATS_INCLUDE_MQTT    1
+#endif
+
+#ifndef configCLI_STATS_INCLUDE_OTA
+    #define configCLI_STATS_INCLUDE_OTA    1
+#endif
+
+/* Reports the TLS record buffer pool, which needs tlsconfigUSE_BUFFER_POOL. */
+#ifndef configCLI_STATS_INCLUDE_TLS_BUFFER_POOL
+    #define configCLI_STATS_INCLUDE_TLS_BUFFER_POOL    0
+#endif
+
+/*
+ * Register the statistics commands with the command interpreter:
+ *
+ *  heap-stats      Free heap, its low-water mark and pooled buffer use.
+ *  taskpool-stats  Job queue depth and worker use of the system task pool.
+ *  mqtt-stats      MQTT operations in flight and PUBLISH retries.
+ *  ota-stats       OTA agent state and packet counters.
+ *
+ * Each command reads counters the libraries already maintain, so running one
+ * does not disturb the work being diagnosed.
+ */
+void FreeRTOS_CLIRegisterStatsCommands( void );
+
+#endif /* FREERTOS_CLI_STATS_H */
@@ -46,10 +46,22 @@
     #define configAPPLICATION_PROVIDES_cOutputBuffer    0
 #endif
 
+/* Registered commands are looked up through a hash table of this many buckets,
+ * so the cost of finding a command does not grow with the number registered.
+ * Must be a power of 2. */
+#ifndef configCOMMAND_INT_HASH_BUCKETS
+    #define configCOMMAND_INT_HASH_BUCKETS    16
+#endif
+
+#if ( ( configCOMMAND_INT_HASH_BUCKETS & ( configCOMMAND_INT_HASH_BUCKETS - 1 ) ) != 0 )
+    #error configCOMMAND_INT_HASH_BUCKETS must be a power of 2.
+#endif
+
 typedef struct xCOMMAND_INPUT_LIST
 {
     const CLI_Command_Definition_t * pxCommandLineDefinition;
-    struct xCOMMAND_INPUT_LIST * pxNext;
+    struct xCOMMAND_INPUT_LIST * pxNext;         /* Next command in registration order, as listed by "help". */
+    struct xCOMMAND_INPUT_LIST * pxNextInBucket; /* Next command in the same hash bucket. */
 } CLI_Definition_List_Item_t;
 
 /*
@@ -65,6 +77,24 @@ static BaseType_t prvHelpCommand( char * pcWriteBuffer,
  */
 static int8_t prvGetNumberOfParameters( const char * pcCommandString );
 
+/*
+ * Hash the first word of pcCommandString, that is up to the first space or the
+ * end of the string.  Sets *pxLength to the length of the word.
+ */
+static uint32_t prvHashCommand( const char * pcCommandString,
+                                size_t * pxLength );
+
+/*
+ * Add a registered command to the hash table.  Must be called from within a
+ * critical section.
+ */
+static void prvAddToBucket( CLI_Definition_List_Item_t * pxListItem );
+
+/*
+ * Find the registered command pcCommandInput starts with, or return NULL.
+ */
+static const CLI_Definition_List_Item_t * prvFindCommand( const char * pcCommandInput );
+
 /* The definition of the "help" command.  This command is always at the front
  * of the list of registered commands. */
 static const CLI_Command_Definition_t xHelpCommand =
@@ -80,9 +110,21 @@ static const CLI_Command_Definition_t xHelpCommand =
 static CLI_Definition_List_Item_t xRegisteredCommands =
 {
     &xHelpCommand, /* The first command in the list is always the help command, defined in this file. */
-    NULL           /* The next pointer is initialised to NULL, as there are no other registered commands yet. */
+    NULL,          /* The next pointer is initialised to NULL, as there are no other registered commands yet. */
+    NULL
 };
 
+/* Hash buckets of registered commands, each a list linked through pxNextInBucket
+ * in registration order.  The help command is added the first time the table
+ * is used. */
+static CLI_Definition_List_Item_t * pxCommandBuckets[ configCOMMAND_INT_HASH_BUCKETS ] = { NULL };
+static BaseType_t xHelpCommandHashed = pdFALSE;
+
+/* Set if any registered command contains a space.  Such a command cannot be
+ * found by hashing the first word of the input, so the list is searched
+ * instead when the hash table has no match. */
+static BaseType_t xMultiWordCommandRegistered = pdFALSE;
+
 /* A buffer into which command outputs can be written is declared here, rather
 * than in the command console implementation, to allow multiple command consoles
 * to share the same buffer.  For example, an application may allow access to the
@@ -135,6 +177,10 @@ BaseType_t FreeRTOS_CLIRegisterCommand( const CLI_Command_Definition_t * const p
 
             /* Set the end of list marker to the new list item. */
             pxLastCommandInList = pxNewListItem;
+
+            /* Make the command available to lookups. */
+            pxNewListItem->pxNextInBucket = NULL;
+            prvAddToBucket( pxNewListItem );
         }
         taskEXIT_CRITICAL();
 
@@ -151,42 +197,22 @@ BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput,
 {
     static const CLI_Definition_List_Item_t * pxCommand = NULL;
     BaseType_t xReturn = pdTRUE;
-    const char * pcRegisteredCommandString;
-    size_t xCommandStringLength;
 
     /* Note:  This function is not re-entrant.  It must not be called from more
      * than one task. */
 
     if( pxCommand == NULL )
     {
-        /* Search for the command string in the list of registered commands. */
-        for( pxCommand = &xRegisteredCommands; pxCommand != NULL; pxCommand = pxCommand->pxNext )
-        {
-            pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
-            xCommandStringLength = strlen( pcRegisteredCommandString );
+        pxCommand = prvFindCommand( pcCommandInput );
 
-            /* To ensure the string lengths match exactly, so as not to pick up
-             * a sub-string of a longer command, check the byte after the expected
-             * end of the string is either the end of the string or a space before
-             * a parameter. */
-            if( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 )
+        /* If the command was found, check it has the expected number of
+         * parameters.  If cExpectedNumberOfParameters is -1, then there could be
+         * a variable number of parameters and no check is made. */
+        if( ( pxCommand != NULL ) && ( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 ) )
+        {
+            if( prvGetNumberOfParameters( pcCommandInput ) != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
             {
-                if( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) )
-                {
-                    /* The command has been found.  Check it has the expected
-                     * number of parameters.  If cExpectedNumberOfParameters is -1,
-                     * then there could be a variable number of parameters and no
-                     * check is made. */
-                    if( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
-                    {
-                        if( prvGetNumberOfParameters( pcCommandInput ) != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
-                        {
-                            xReturn = pdFALSE;
-                        }
-                    }
-
-                    break;
-                }
+                xReturn = pdFALSE;
             }
         }
     }
@@ -360,3 +386,117 @@ static int8_t prvGetNumberOfParameters( const char * pcCommandString )
      * as the first word should be the command itself. */
     return cParameters;
 }
+/*-----------------------------------------------------------*/
+
+static uint32_t prvHashCommand( const char * pcCommandString,
+                                size_t * pxLength )
+{
+    /* 32-bit FNV-1a. */
+    uint32_t ulHash = 2166136261UL;
+    size_t xLength = 0;
+
+    while( ( pcCommandString[ xLength ] != 0x00 ) && ( pcCommandString[ xLength ] != ' ' ) )
+    {
+        ulHash ^= ( uint8_t ) pcCommandString[ xLength ];
+        ulHash *= 16777619UL;
+        xLength++;
+    }
+
+    *pxLength = xLength;
+
+    return ulHash;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAddToBucket( CLI_Definition_List_Item_t * pxListItem )
+{
+    CLI_Definition_List_Item_t ** ppxLink;
+    const char * pcCommand = pxListItem->pxCommandLineDefinition->pcCommand;
+    size_t xLength;
+    uint32_t ulHash;
+
+    /* The help command is statically allocated, so it is hashed on first use
+     * rather than being registered. */
+    if( xHelpCommandHashed == pdFALSE )
+    {
+        xHelpCommandHashed = pdTRUE;
+        prvAddToBucket( &xRegisteredCommands );
+    }
+
+    ulHash = prvHashCommand( pcCommand, &xLength );
+
+    if( pcCommand[ xLength ] != 0x00 )
+    {
+        xMultiWordCommandRegistered = pdTRUE;
+    }
+
+    /* Append so that, as with the list, the first of two commands with the
+     * same name is the one found. */
+    for( ppxLink = &pxCommandBuckets[ ulHash & ( configCOMMAND_INT_HASH_BUCKETS - 1 ) ];
+         *ppxLink != NULL;
+         ppxLink = &( ( *ppxLink )->pxNextInBucket ) )
+    {
+    }
+
+    *ppxLink = pxListItem;
+}
+/*-----------------------------------------------------------*/
+
+static const CLI_Definition_List_Item_t * prvFindCommand( const char * pcCommandInput )
+{
+    const CLI_Definition_List_Item_t * pxCommand;
+    const char * pcRegisteredCommandString;
+    size_t xCommandStringLength;
+    size_t xInputLength;
+    uint32_t ulHash;
+
+    if( xHelpCommandHashed == pdFALSE )
+    {
+        taskENTER_CRITICAL();
+        {
+            if( xHelpCommandHashed == pdFALSE )
+            {
+                xHelpCommandHashed = pdTRUE;
+                prvAddToBucket( &xRegisteredCommands );
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    ulHash = prvHashCommand( pcCommandInput, &xInputLength );
+
+    for( pxCommand = pxCommandBuckets[ ulHash & ( configCOMMAND_INT_HASH_BUCKETS - 1 ) ];
+         pxCommand != NULL;
+         pxCommand = pxCommand->pxNextInBucket )
+    {
+        pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
+
+        if( ( strncmp( pcCommandInput, pcRegisteredCommandString, xInputLength ) == 0 ) &&
+            ( pcRegisteredCommandString[ xInputLength ] == 0x00 ) )
+        {
+            break;
+        }
+    }
+
+    if( ( pxCommand == NULL ) && ( xMultiWordCommandRegistered == pdTRUE ) )
+    {
+        /* Search the whole list, as before commands were hashed. */
+        for( pxCommand = &xRegisteredCommands; pxCommand != NULL; pxCommand = pxCommand->pxNext )
+        {
+            pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
+            xCommandStringLength = strlen( pcRegisteredCommandString );
+
+            /* To ensure the string lengths match exactly, so as not to pick up
+             * a sub-string of a longer command, check the byte after the expected
+             * end of the string is either the end of the string or a space before
+             * a parameter. */
+            if( ( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 ) &&
+                ( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) ) )
+            {
+                break;
+            }
+        }
+    }
+
+    return pxCommand;
+}
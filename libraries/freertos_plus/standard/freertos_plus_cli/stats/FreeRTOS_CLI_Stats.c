@@ -0,0 +1,258 @@
+/*
+ * FreeRTOS+CLI V1.0.4
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "FreeRTOS_CLI.h"
+#include "FreeRTOS_CLI_Stats.h"
+
+#if ( configCLI_STATS_INCLUDE_TASKPOOL == 1 )
+    #include "iot_taskpool.h"
+#endif
+
+#if ( configCLI_STATS_INCLUDE_MQTT == 1 )
+    #include "iot_mqtt.h"
+#endif
+
+#if ( configCLI_STATS_INCLUDE_OTA == 1 )
+    #include "aws_iot_ota_agent.h"
+#endif
+
+#if ( configCLI_STATS_INCLUDE_TLS_BUFFER_POOL == 1 )
+    #include "iot_tls.h"
+#endif
+
+/*
+ * Each command writes its counters in one go and returns pdFALSE, as there is
+ * nothing more to output.  A buffer too small for the report gets a truncated
+ * report.
+ */
+static BaseType_t prvHeapStatsCommand( char * pcWriteBuffer,
+                                       size_t xWriteBufferLen,
+                                       const char * pcCommandString );
+
+#if ( configCLI_STATS_INCLUDE_TASKPOOL == 1 )
+    static BaseType_t prvTaskPoolStatsCommand( char * pcWriteBuffer,
+                                               size_t xWriteBufferLen,
+                                               const char * pcCommandString );
+#endif
+
+#if ( configCLI_STATS_INCLUDE_MQTT == 1 )
+    static BaseType_t prvMqttStatsCommand( char * pcWriteBuffer,
+                                           size_t xWriteBufferLen,
+                                           const char * pcCommandString );
+#endif
+
+#if ( configCLI_STATS_INCLUDE_OTA == 1 )
+    static BaseType_t prvOtaStatsCommand( char * pcWriteBuffer,
+                                          size_t xWriteBufferLen,
+                                          const char * pcCommandString );
+#endif
+
+static const CLI_Command_Definition_t xHeapStats =
+{
+    "heap-stats",
+    "\r\nheap-stats:\r\n Displays free heap, its low-water mark and pooled buffer use\r\n\r\n",
+    prvHeapStatsCommand,
+    0
+};
+
+#if ( configCLI_STATS_INCLUDE_TASKPOOL == 1 )
+    static const CLI_Command_Definition_t xTaskPoolStats =
+    {
+        "taskpool-stats",
+        "\r\ntaskpool-stats:\r\n Displays job queue depth and worker use of the system task pool\r\n\r\n",
+        prvTaskPoolStatsCommand,
+        0
+    };
+#endif
+
+#if ( configCLI_STATS_INCLUDE_MQTT == 1 )
+    static const CLI_Command_Definition_t xMqttStats =
+    {
+        "mqtt-stats",
+        "\r\nmqtt-stats:\r\n Displays MQTT operations in flight and PUBLISH retries\r\n\r\n",
+        prvMqttStatsCommand,
+        0
+    };
+#endif
+
+#if ( configCLI_STATS_INCLUDE_OTA == 1 )
+    static const CLI_Command_Definition_t xOtaStats =
+    {
+        "ota-stats",
+        "\r\nota-stats:\r\n Displays the OTA agent state and packet counters\r\n\r\n",
+        prvOtaStatsCommand,
+        0
+    };
+#endif
+
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_CLIRegisterStatsCommands( void )
+{
+    ( void ) FreeRTOS_CLIRegisterCommand( &xHeapStats );
+
+    #if ( configCLI_STATS_INCLUDE_TASKPOOL == 1 )
+        ( void ) FreeRTOS_CLIRegisterCommand( &xTaskPoolStats );
+    #endif
+
+    #if ( configCLI_STATS_INCLUDE_MQTT == 1 )
+        ( void ) FreeRTOS_CLIRegisterCommand( &xMqttStats );
+    #endif
+
+    #if ( configCLI_STATS_INCLUDE_OTA == 1 )
+        ( void ) FreeRTOS_CLIRegisterCommand( &xOtaStats );
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvHeapStatsCommand( char * pcWriteBuffer,
+                                       size_t xWriteBufferLen,
+                                       const char * pcCommandString )
+{
+    int lLength;
+
+    ( void ) pcCommandString;
+    configASSERT( pcWriteBuffer );
+
+    lLength = snprintf( pcWriteBuffer, xWriteBufferLen,
+                        "Free heap:           %u\r\n"
+                        "Minimum free heap:   %u\r\n",
+                        ( unsigned ) xPortGetFreeHeapSize(),
+                        ( unsigned ) xPortGetMinimumEverFreeHeapSize() );
+
+    #if ( configCLI_STATS_INCLUDE_TLS_BUFFER_POOL == 1 )
+        if( ( lLength > 0 ) && ( ( size_t ) lLength < xWriteBufferLen ) )
+        {
+            ( void ) snprintf( pcWriteBuffer + lLength, xWriteBufferLen - ( size_t ) lLength,
+                               "TLS buffers peak:    %u of %u pooled\r\n",
+                               ( unsigned ) TLS_GetBufferPoolPeak(),
+                               ( unsigned ) tlsconfigBUFFER_POOL_SIZE );
+        }
+    #else
+        ( void ) lLength;
+    #endif
+
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configCLI_STATS_INCLUDE_TASKPOOL == 1 )
+    static BaseType_t prvTaskPoolStatsCommand( char * pcWriteBuffer,
+                                               size_t xWriteBufferLen,
+                                               const char * pcCommandString )
+    {
+        IotTaskPoolStatistics_t xStatistics;
+        IotTaskPoolError_t xError;
+
+        ( void ) pcCommandString;
+        configASSERT( pcWriteBuffer );
+
+        xError = IotTaskPool_GetStatistics( IotTaskPool_GetSystemTaskPool(), &xStatistics );
+
+        if( xError == IOT_TASKPOOL_SUCCESS )
+        {
+            ( void ) snprintf( pcWriteBuffer, xWriteBufferLen,
+                               "Queued jobs:         %u\r\n"
+                               "Deferred jobs:       %u\r\n"
+                               "Active jobs:         %u\r\n"
+                               "Worker threads:      %u (min %u, max %u)\r\n"
+                               "Cached jobs:         %u\r\n",
+                               ( unsigned ) xStatistics.queuedJobs,
+                               ( unsigned ) xStatistics.deferredJobs,
+                               ( unsigned ) xStatistics.activeJobs,
+                               ( unsigned ) xStatistics.activeThreads,
+                               ( unsigned ) xStatistics.minThreads,
+                               ( unsigned ) xStatistics.maxThreads,
+                               ( unsigned ) xStatistics.cachedJobs );
+        }
+        else
+        {
+            ( void ) snprintf( pcWriteBuffer, xWriteBufferLen, "Task pool unavailable: %s\r\n",
+                               IotTaskPool_strerror( xError ) );
+        }
+
+        return pdFALSE;
+    }
+#endif /* if ( configCLI_STATS_INCLUDE_TASKPOOL == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if ( configCLI_STATS_INCLUDE_MQTT == 1 )
+    static BaseType_t prvMqttStatsCommand( char * pcWriteBuffer,
+                                           size_t xWriteBufferLen,
+                                           const char * pcCommandString )
+    {
+        IotMqttStatistics_t xStatistics;
+
+        ( void ) pcCommandString;
+        configASSERT( pcWriteBuffer );
+
+        IotMqtt_GetStatistics( &xStatistics );
+
+        ( void ) snprintf( pcWriteBuffer, xWriteBufferLen,
+                           "Operations in flight: %u\r\n"
+                           "Operations created:   %u\r\n"
+                           "PUBLISH retries:      %u\r\n"
+                           "PUBLISH gave up:      %u\r\n",
+                           ( unsigned ) xStatistics.operationsInFlight,
+                           ( unsigned ) xStatistics.operationsCreated,
+                           ( unsigned ) xStatistics.publishRetransmissions,
+                           ( unsigned ) xStatistics.publishRetryLimitReached );
+
+        return pdFALSE;
+    }
+#endif /* if ( configCLI_STATS_INCLUDE_MQTT == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if ( configCLI_STATS_INCLUDE_OTA == 1 )
+    static BaseType_t prvOtaStatsCommand( char * pcWriteBuffer,
+                                          size_t xWriteBufferLen,
+                                          const char * pcCommandString )
+    {
+        ( void ) pcCommandString;
+        configASSERT( pcWriteBuffer );
+
+        ( void ) snprintf( pcWriteBuffer, xWriteBufferLen,
+                           "Agent state:         %d\r\n"
+                           "Packets received:    %u\r\n"
+                           "Packets queued:      %u\r\n"
+                           "Packets processed:   %u\r\n"
+                           "Packets dropped:     %u\r\n",
+                           ( int ) OTA_GetAgentState(),
+                           ( unsigned ) OTA_GetPacketsReceived(),
+                           ( unsigned ) OTA_GetPacketsQueued(),
+                           ( unsigned ) OTA_GetPacketsProcessed(),
+                           ( unsigned ) OTA_GetPacketsDropped() );
+
+        return pdFALSE;
+    }
+#endif /* if ( configCLI_STATS_INCLUDE_OTA == 1 ) */
@@ -135,6 +135,7 @@ TEST_GROUP_RUNNER( FreeRTOS_CLI )
     RUN_TEST_CASE( FreeRTOS_CLI, ExecuteCommandWithVariableParams );
     RUN_TEST_CASE( FreeRTOS_CLI, EmptyInput );
     RUN_TEST_CASE( FreeRTOS_CLI, InputWithNonRegisteredCommand );
+    RUN_TEST_CASE( FreeRTOS_CLI, InputWithPartOfRegisteredCommand );
     RUN_TEST_CASE( FreeRTOS_CLI, InputWithLesserThanExpectedParams )
     RUN_TEST_CASE( FreeRTOS_CLI, InputWithGreaterThanExpectedParams )
     RUN_TEST_CASE( FreeRTOS_CLI, InvalidInput )
@@ -259,6 +260,23 @@ TEST( FreeRTOS_CLI, InputWithNonRegisteredCommand )
     TEST_ASSERT_NULL( FreeRTOS_CLIGetParameter( pcCommand, 1, &xParamLength ) );
 }
 
+TEST( FreeRTOS_CLI, InputWithPartOfRegisteredCommand )
+{
+    /**
+     * Only the whole first word of the input selects a command. Neither a prefix of a registered
+     * command nor a registered command followed by more characters should match.
+     */
+    pcCommand = "cmd_no_param";
+    TEST_ASSERT_EQUAL( pdFALSE, FreeRTOS_CLIProcessCommand( pcCommand, outputBuffer, outputBufferLength ) );
+    TEST_ASSERT_EQUAL( 0, strncmp( "Command not recognised.  Enter 'help' to view a list of available commands.\r\n\r\n", outputBuffer, outputBufferLength ) );
+
+    pcCommand = "cmd_no_paramsx";
+    TEST_ASSERT_EQUAL( pdFALSE, FreeRTOS_CLIProcessCommand( pcCommand, outputBuffer, outputBufferLength ) );
+    TEST_ASSERT_EQUAL( 0, strncmp( "Command not recognised.  Enter 'help' to view a list of available commands.\r\n\r\n", outputBuffer, outputBufferLength ) );
+
+    TEST_ASSERT_EQUAL( 0, xNumCmdInvocations );
+}
+
 TEST( FreeRTOS_CLI, InputWithLesserThanExpectedParams )
 {
     /**
@@ -46,6 +46,85 @@
 
 /**@} */
 
+/**
+ * @brief Lease record buffers from a shared pool instead of keeping them per connection.
+ *
+ * Each connection holds the mbedTLS input and output record buffers only while it
+ * is exchanging records. Once it goes idle, the buffers go back to a pool shared by
+ * all connections, and an idle connection leases them again when data arrives.
+ */
+#ifndef tlsconfigUSE_BUFFER_POOL
+    #define tlsconfigUSE_BUFFER_POOL    0
+#endif
+
+/**
+ * @brief Number of free record buffer pairs the pool keeps for reuse.
+ *
+ * Leases beyond this are allocated and freed on demand. Size it from
+ * TLS_GetBufferPoolPeak() measured under a typical load.
+ */
+#ifndef tlsconfigBUFFER_POOL_SIZE
+    #define tlsconfigBUFFER_POOL_SIZE    2
+#endif
+
+/**
+ * @brief Time after which the shared DRBG draws fresh entropy from PKCS #11.
+ */
+#ifndef tlsconfigDRBG_RESEED_INTERVAL_MS
+    #define tlsconfigDRBG_RESEED_INTERVAL_MS    ( 60UL * 60UL * 1000UL )
+#endif
+
+/**
+ * @brief Number of random bytes the shared DRBG generates ahead for small requests.
+ *
+ * Requests no longer than this, such as the FreeRTOS+TCP random numbers or retry jitter, are
+ * served from the cache and share the cost of one DRBG call.
+ */
+#ifndef tlsconfigDRBG_CACHE_SIZE
+    #define tlsconfigDRBG_CACHE_SIZE    64
+#endif
+
+/**
+ * @brief Sign for client authentication through a shared signing service.
+ *
+ * Handshakes queue their signing requests to tasks that each own a PKCS #11
+ * session, instead of signing on their own sessions one after the other.
+ */
+#ifndef tlsconfigUSE_SIGNING_SERVICE
+    #define tlsconfigUSE_SIGNING_SERVICE    0
+#endif
+
+/**
+ * @brief Number of signing tasks, and so of PKCS #11 sessions signing at once.
+ */
+#ifndef tlsconfigSIGNING_SESSIONS
+    #define tlsconfigSIGNING_SESSIONS    2
+#endif
+
+/**
+ * @brief Number of signing requests that can wait for a signing task.
+ */
+#ifndef tlsconfigSIGNING_QUEUE_LENGTH
+    #define tlsconfigSIGNING_QUEUE_LENGTH    8
+#endif
+
+/**
+ * @brief Largest number of waiting requests a signing task serves in one go.
+ */
+#ifndef tlsconfigSIGNING_BATCH_SIZE
+    #define tlsconfigSIGNING_BATCH_SIZE    4
+#endif
+
+/**
+ * @brief Priority and stack size of the signing tasks.
+ */
+#ifndef tlsconfigSIGNING_TASK_PRIORITY
+    #define tlsconfigSIGNING_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+#endif
+#ifndef tlsconfigSIGNING_TASK_STACK_SIZE
+    #define tlsconfigSIGNING_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4 )
+#endif
+
 /**
  * @brief Defines callback type for receiving bytes from the network.
  *
@@ -99,6 +178,21 @@ typedef struct xTLS_PARAMS
     void * pvCallerContext;
 } TLSParams_t;
 
+/**
+ * @brief Fills a buffer with random bytes from the DRBG shared by all connections.
+ *
+ * The DRBG is seeded from PKCS #11 on first use and reseeded every
+ * tlsconfigDRBG_RESEED_INTERVAL_MS, so a connection does not wait on the
+ * entropy source during its handshake. Safe to call from any task.
+ *
+ * @param[out] pucRandom Buffer to fill with random bytes.
+ * @param[in] xRandomLength Length of previous parameter in bytes.
+ *
+ * @return Zero on success, otherwise TLS_ERROR_RNG.
+ */
+BaseType_t TLS_GenerateRandom( unsigned char * pucRandom,
+                               size_t xRandomLength );
+
 /**
  * @brief Initializes the TLS context.
  *
@@ -146,6 +240,18 @@ BaseType_t TLS_Send( void * pvContext,
                      const unsigned char * pucMsg,
                      size_t xMsgLength );
 
+/**
+ * @brief Gets the number of application data records sent and received on
+ * the secure connection.
+ *
+ * @param pvContext Opaque context handle for TLS library.
+ * @param[out] pulRecordsSent Number of records written by TLS_Send.
+ * @param[out] pulRecordsReceived Number of records read by TLS_Recv.
+ */
+void TLS_GetRecordCounts( void * pvContext,
+                          uint32_t * pulRecordsSent,
+                          uint32_t * pulRecordsReceived );
+
 /**
  * @brief Frees resources consumed by the TLS context.
  *
@@ -153,4 +259,49 @@ BaseType_t TLS_Send( void * pvContext,
  */
 void TLS_Cleanup( void * pvContext );
 
+#if ( tlsconfigUSE_BUFFER_POOL == 1 )
+
+/**
+ * @brief Gets the largest number of record buffer pairs that were leased at once.
+ *
+ * @return Peak number of connections exchanging records at the same time.
+ */
+    UBaseType_t TLS_GetBufferPoolPeak( void );
+#endif
+
+#if ( tlsconfigUSE_SIGNING_SERVICE == 1 )
+    #include "core_pkcs11.h"
+
+/**
+ * @brief Signs data with a private key through the signing service, and waits
+ * for the signature.
+ *
+ * The signing tasks are started by the first call.
+ *
+ * @param[in] xMechanism PKCS #11 signing mechanism.
+ * @param[in] xPrivateKey Handle of the private key object.
+ * @param[in] pucData Data to sign.
+ * @param[in] ulDataLength Length of previous parameter in bytes.
+ * @param[out] pucSignature Buffer for the signature.
+ * @param[in,out] pulSignatureLength Length of the signature buffer in bytes,
+ * then of the signature.
+ *
+ * @return CKR_OK, or the error of C_SignInit or C_Sign.
+ */
+    CK_RV TLS_Sign( CK_MECHANISM_TYPE xMechanism,
+                    CK_OBJECT_HANDLE xPrivateKey,
+                    const CK_BYTE * pucData,
+                    CK_ULONG ulDataLength,
+                    CK_BYTE * pucSignature,
+                    CK_ULONG * pulSignatureLength );
+
+/**
+ * @brief Replaces the PKCS #11 functions the signing tasks sign with, for
+ * instance to add latency under test. NULL restores the module's own.
+ *
+ * @param[in] pxFunctionList Function list to sign with.
+ */
+    void TLS_SetSigningFunctionList( CK_FUNCTION_LIST_PTR pxFunctionList );
+#endif /* if ( tlsconfigUSE_SIGNING_SERVICE == 1 ) */
+
 #endif /* ifndef __AWS__TLS__H__ */
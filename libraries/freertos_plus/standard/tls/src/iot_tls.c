@@ -31,6 +31,8 @@
 #include "core_pkcs11_config.h"
 #include "core_pkcs11.h"
 #include "task.h"
+#include "semphr.h"
+#include "queue.h"
 #include "aws_clientcredential_keys.h"
 #include "iot_default_root_certificates.h"
 #include "core_pki_utils.h"
@@ -45,6 +47,18 @@
 #include "mbedtls/pk_internal.h"
 #include "mbedtls/debug.h"
 
+#if ( tlsconfigUSE_BUFFER_POOL == 1 )
+    #include "mbedtls/version.h"
+    #include "mbedtls/ssl_internal.h"
+    #include "mbedtls/platform_util.h"
+
+/* The pool moves the record buffers of a connection, so it depends on the
+ * record pointers of mbedtls_ssl_context, which are only stable within 2.16. */
+    #if ( MBEDTLS_VERSION_NUMBER < 0x02100000 ) || ( MBEDTLS_VERSION_NUMBER >= 0x02110000 )
+        #error "tlsconfigUSE_BUFFER_POOL requires mbedTLS 2.16."
+    #endif
+#endif
+
 #ifdef MBEDTLS_DEBUG_C
     #define tlsDEBUG_VERBOSE    4
 #endif
@@ -58,94 +72,962 @@
 #include <stdio.h>
 
 /**
- * @brief Represents string to be logged when mbedTLS returned error
- * does not contain a high-level code.
+ * @brief Represents string to be logged when mbedTLS returned error
+ * does not contain a high-level code.
+ */
+static const char * pNoHighLevelMbedTlsCodeStr = "<No-High-Level-Code>";
+
+/**
+ * @brief Represents string to be logged when mbedTLS returned error
+ * does not contain a low-level code.
+ */
+static const char * pNoLowLevelMbedTlsCodeStr = "<No-Low-Level-Code>";
+
+/**
+ * @brief Utility for converting the high-level code in an mbedTLS error to string,
+ * if the code-contains a high-level code; otherwise, using a default string.
+ */
+#define mbedtlsHighLevelCodeOrDefault( mbedTlsCode )        \
+    ( mbedtls_strerror_highlevel( mbedTlsCode ) != NULL ) ? \
+    mbedtls_strerror_highlevel( mbedTlsCode ) : pNoHighLevelMbedTlsCodeStr
+
+
+/**
+ * @brief Utility for converting the level-level code in an mbedTLS error to string,
+ * if the code-contains a level-level code; otherwise, using a default string.
+ */
+#define mbedtlsLowLevelCodeOrDefault( mbedTlsCode )        \
+    ( mbedtls_strerror_lowlevel( mbedTlsCode ) != NULL ) ? \
+    mbedtls_strerror_lowlevel( mbedTlsCode ) : pNoLowLevelMbedTlsCodeStr
+
+
+/**
+ * @brief Record pointers into each of the input and output buffers, and the
+ * length of the record counter they begin with.
+ */
+#define TLS_RECORD_POINTER_COUNT     5
+#define TLS_RECORD_COUNTER_LENGTH    8
+
+/**
+ * @brief Internal context structure.
+ *
+ * @param[in] pcDestination Server location, can be a DNS name or IP address.
+ * @param[in] pcServerCertificate Server X.509 certificate in PEM format to trust.
+ * @param[in] ulServerCertificateLength Length in bytes of the server certificate.
+ * @param[in] xNetworkRecv Callback for receiving data on an open TCP socket.
+ * @param[in] xNetworkSend Callback for sending data on an open TCP socket.
+ * @param[in] pvCallerContext Opaque pointer provided by caller for above callbacks.
+ * @param[out] xTLSHandshakeState Indicates the state of the TLS handshake.
+ * @param[out] xMbedSslCtx Connection context for mbedTLS.
+ * @param[out] xMbedSslConfig Configuration context for mbedTLS.
+ * @param[out] xMbedX509CA Server certificate context for mbedTLS.
+ * @param[out] xMbedX509Cli Client certificate context for mbedTLS.
+ * @param[out] mbedPkAltCtx RSA crypto implementation context for mbedTLS.
+ * @param[out] pxP11FunctionList PKCS#11 function list structure.
+ * @param[out] xP11Session PKCS#11 session context.
+ * @param[out] xP11PrivateKey PKCS#11 private key context.
+ * @param[out] xBufferState Whether the record buffers are mbedTLS's own, leased from the pool or returned.
+ * @param[out] uxBufferUsers Number of calls into mbedTLS in progress, which keep the buffers leased.
+ * @param[out] xInOffsets Offsets of the input record pointers while the buffers are returned.
+ * @param[out] xOutOffsets Offsets of the output record pointers while the buffers are returned.
+ * @param[out] ucInCtr Incoming record counter while the buffers are returned.
+ * @param[out] ucOutCtr Outgoing record counter while the buffers are returned.
+ * @param[out] ucPeekedByte First byte of a record received before leasing the buffers.
+ * @param[out] xHasPeekedByte Whether ucPeekedByte is still to be passed to mbedTLS.
+ * @param[out] ulRecordsSent Number of application data records written since the handshake.
+ * @param[out] ulRecordsReceived Number of application data records read since the handshake.
+ */
+typedef struct TLSContext
+{
+    const char * pcDestination;
+    const char * pcServerCertificate;
+    uint32_t ulServerCertificateLength;
+    const char ** ppcAlpnProtocols;
+    uint32_t ulAlpnProtocolsCount;
+
+    NetworkRecv_t xNetworkRecv;
+    NetworkSend_t xNetworkSend;
+    void * pvCallerContext;
+    BaseType_t xTLSHandshakeState;
+
+    /* mbedTLS. */
+    mbedtls_ssl_context xMbedSslCtx;
+    mbedtls_ssl_config xMbedSslConfig;
+    mbedtls_x509_crt xMbedX509CA;
+    mbedtls_x509_crt xMbedX509Cli;
+    mbedtls_pk_context xMbedPkCtx;
+    mbedtls_pk_info_t xMbedPkInfo;
+
+    /* PKCS#11. */
+    CK_FUNCTION_LIST_PTR pxP11FunctionList;
+    CK_SESSION_HANDLE xP11Session;
+    CK_OBJECT_HANDLE xP11PrivateKey;
+    CK_KEY_TYPE xKeyType;
+
+    /* Statistics. */
+    uint32_t ulRecordsSent;
+    uint32_t ulRecordsReceived;
+
+    #if ( tlsconfigUSE_BUFFER_POOL == 1 )
+        /* Record buffer pool. */
+        BaseType_t xBufferState;
+        UBaseType_t uxBufferUsers;
+        size_t xInOffsets[ TLS_RECORD_POINTER_COUNT ];
+        size_t xOutOffsets[ TLS_RECORD_POINTER_COUNT ];
+        unsigned char ucInCtr[ TLS_RECORD_COUNTER_LENGTH ];
+        unsigned char ucOutCtr[ TLS_RECORD_COUNTER_LENGTH ];
+        unsigned char ucPeekedByte;
+        BaseType_t xHasPeekedByte;
+    #endif
+} TLSContext_t;
+
+#define TLS_HANDSHAKE_NOT_STARTED    ( 0 )      /* Must be 0 */
+#define TLS_HANDSHAKE_STARTED        ( 1 )
+#define TLS_HANDSHAKE_SUCCESSFUL     ( 2 )
+
+#define TLS_BUFFERS_OWNED            ( 0 )      /* Must be 0. Allocated by mbedTLS, as during the handshake. */
+#define TLS_BUFFERS_LEASED           ( 1 )
+#define TLS_BUFFERS_RETURNED         ( 2 )
+
+#define TLS_PRINT( X )    configPRINTF( X )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Helper routines.
+ */
+
+#if ( tlsconfigUSE_BUFFER_POOL == 1 )
+
+/**
+ * @brief Size of a pair of input and output record buffers.
+ */
+    #define tlsBUFFER_BLOCK_SIZE    ( MBEDTLS_SSL_IN_BUFFER_LEN + MBEDTLS_SSL_OUT_BUFFER_LEN )
+
+/**
+ * @brief Free buffer pairs, linked through their first bytes.
+ */
+    static unsigned char * pucBufferPoolHead = NULL;
+
+/**
+ * @brief Number of free buffer pairs in the pool.
+ */
+    static UBaseType_t uxBufferPoolCached = 0;
+
+/**
+ * @brief Number of buffer pairs leased, now and at most.
+ */
+    static UBaseType_t uxBufferPoolLeased = 0;
+    static UBaseType_t uxBufferPoolPeak = 0;
+
+    #ifdef FREERTOS_ENABLE_UNIT_TESTS
+
+/**
+ * @brief Set by tests to make allocating a buffer pair fail, since running out of
+ * heap would stop in the malloc failed hook.
+ */
+        static BaseType_t xBufferPoolFailAllocations = pdFALSE;
+    #endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Take a buffer pair from the pool, or allocate one if the pool is empty.
+ * Must be called with the scheduler suspended.
+ *
+ * @return The buffer pair, or NULL if none could be allocated.
+ */
+    static unsigned char * prvBufferPoolTake( void )
+    {
+        unsigned char * pucBlock = pucBufferPoolHead;
+
+        if( NULL != pucBlock )
+        {
+            memcpy( &pucBufferPoolHead, pucBlock, sizeof( unsigned char * ) );
+            uxBufferPoolCached--;
+        }
+        else
+        {
+            #ifdef FREERTOS_ENABLE_UNIT_TESTS
+                if( pdFALSE == xBufferPoolFailAllocations )
+            #endif
+            {
+                pucBlock = ( unsigned char * ) pvPortMalloc( tlsBUFFER_BLOCK_SIZE ); /*lint !e9079 Allow casting void* to other types. */
+            }
+        }
+
+        if( NULL != pucBlock )
+        {
+            uxBufferPoolLeased++;
+
+            if( uxBufferPoolLeased > uxBufferPoolPeak )
+            {
+                uxBufferPoolPeak = uxBufferPoolLeased;
+            }
+        }
+
+        return pucBlock;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Wipe a buffer pair and give it back to the pool, or free it if the pool is full.
+ *
+ * @param[in] pucBlock The buffer pair.
+ */
+    static void prvBufferPoolGive( unsigned char * pucBlock )
+    {
+        BaseType_t xCached = pdFALSE;
+
+        /* The buffers held plaintext of the connection that leased them. */
+        mbedtls_platform_zeroize( pucBlock, tlsBUFFER_BLOCK_SIZE );
+
+        vTaskSuspendAll();
+        {
+            uxBufferPoolLeased--;
+
+            if( uxBufferPoolCached < tlsconfigBUFFER_POOL_SIZE )
+            {
+                memcpy( pucBlock, &pucBufferPoolHead, sizeof( unsigned char * ) );
+                pucBufferPoolHead = pucBlock;
+                uxBufferPoolCached++;
+                xCached = pdTRUE;
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        if( pdFALSE == xCached )
+        {
+            vPortFree( pucBlock );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the addresses of the record pointers into the input and output buffers.
+ * Apart from a read offset, which is NULL when idle, these are all mbedTLS keeps into them.
+ *
+ * @param[in] pxSsl The mbedTLS connection.
+ * @param[out] ppucIn Input record pointers.
+ * @param[out] ppucOut Output record pointers.
+ */
+    static void prvGetRecordPointers( mbedtls_ssl_context * pxSsl,
+                                      unsigned char ** ppucIn[ TLS_RECORD_POINTER_COUNT ],
+                                      unsigned char ** ppucOut[ TLS_RECORD_POINTER_COUNT ] )
+    {
+        ppucIn[ 0 ] = &pxSsl->in_ctr;
+        ppucIn[ 1 ] = &pxSsl->in_hdr;
+        ppucIn[ 2 ] = &pxSsl->in_len;
+        ppucIn[ 3 ] = &pxSsl->in_iv;
+        ppucIn[ 4 ] = &pxSsl->in_msg;
+
+        ppucOut[ 0 ] = &pxSsl->out_ctr;
+        ppucOut[ 1 ] = &pxSsl->out_hdr;
+        ppucOut[ 2 ] = &pxSsl->out_len;
+        ppucOut[ 3 ] = &pxSsl->out_iv;
+        ppucOut[ 4 ] = &pxSsl->out_msg;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check that the connection is between records, so nothing in the
+ * buffers is needed apart from the record counters.
+ *
+ * @param[in] pxSsl The mbedTLS connection.
+ *
+ * @return pdTRUE if the buffers can be returned.
+ */
+    static BaseType_t prvIsBetweenRecords( const mbedtls_ssl_context * pxSsl )
+    {
+        /* A handshake message is dropped without being read once fully handled. */
+        return ( ( 0 == pxSsl->in_left ) &&
+                 ( 0 == pxSsl->out_left ) &&
+                 ( NULL == pxSsl->in_offt ) &&
+                 ( 0 == pxSsl->keep_current_message ) &&
+                 ( pxSsl->in_msglen == pxSsl->in_hslen ) ) ? pdTRUE : pdFALSE;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Lease buffers from the pool if the connection returned its own, and
+ * hold them until the matching prvReleaseBuffers().
+ *
+ * @param[in] pxCtx Caller context.
+ *
+ * @return pdPASS, or pdFAIL if no buffers could be allocated.
+ */
+    static BaseType_t prvAcquireBuffers( TLSContext_t * pxCtx )
+    {
+        BaseType_t xResult = pdPASS;
+        mbedtls_ssl_context * pxSsl = &pxCtx->xMbedSslCtx;
+        unsigned char ** ppucIn[ TLS_RECORD_POINTER_COUNT ];
+        unsigned char ** ppucOut[ TLS_RECORD_POINTER_COUNT ];
+        unsigned char * pucBlock = NULL;
+        size_t x = 0;
+
+        vTaskSuspendAll();
+        {
+            if( TLS_BUFFERS_RETURNED == pxCtx->xBufferState )
+            {
+                pucBlock = prvBufferPoolTake();
+
+                if( NULL != pucBlock )
+                {
+                    prvGetRecordPointers( pxSsl, ppucIn, ppucOut );
+                    pxSsl->in_buf = pucBlock;
+                    pxSsl->out_buf = pucBlock + MBEDTLS_SSL_IN_BUFFER_LEN;
+
+                    for( x = 0; x < TLS_RECORD_POINTER_COUNT; x++ )
+                    {
+                        *ppucIn[ x ] = pxSsl->in_buf + pxCtx->xInOffsets[ x ];
+                        *ppucOut[ x ] = pxSsl->out_buf + pxCtx->xOutOffsets[ x ];
+                    }
+
+                    memcpy( pxSsl->in_ctr, pxCtx->ucInCtr, TLS_RECORD_COUNTER_LENGTH );
+                    memcpy( pxSsl->out_ctr, pxCtx->ucOutCtr, TLS_RECORD_COUNTER_LENGTH );
+                    pxCtx->xBufferState = TLS_BUFFERS_LEASED;
+                }
+                else
+                {
+                    xResult = pdFAIL;
+                }
+            }
+
+            if( pdPASS == xResult )
+            {
+                pxCtx->uxBufferUsers++;
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        return xResult;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Return the buffers of an established connection with no calls in
+ * progress, if it is between records.
+ *
+ * @param[in] pxCtx Caller context.
+ */
+    static void prvReturnIdleBuffers( TLSContext_t * pxCtx )
+    {
+        mbedtls_ssl_context * pxSsl = &pxCtx->xMbedSslCtx;
+        unsigned char ** ppucIn[ TLS_RECORD_POINTER_COUNT ];
+        unsigned char ** ppucOut[ TLS_RECORD_POINTER_COUNT ];
+        unsigned char * pucIn = NULL;
+        unsigned char * pucOut = NULL;
+        BaseType_t xOwned = pdFALSE;
+        size_t x = 0;
+
+        vTaskSuspendAll();
+        {
+            if( ( TLS_HANDSHAKE_SUCCESSFUL == pxCtx->xTLSHandshakeState ) &&
+                ( TLS_BUFFERS_RETURNED != pxCtx->xBufferState ) &&
+                ( 0 == pxCtx->uxBufferUsers ) &&
+                ( pdTRUE == prvIsBetweenRecords( pxSsl ) ) )
+            {
+                prvGetRecordPointers( pxSsl, ppucIn, ppucOut );
+                memcpy( pxCtx->ucInCtr, pxSsl->in_ctr, TLS_RECORD_COUNTER_LENGTH );
+                memcpy( pxCtx->ucOutCtr, pxSsl->out_ctr, TLS_RECORD_COUNTER_LENGTH );
+
+                for( x = 0; x < TLS_RECORD_POINTER_COUNT; x++ )
+                {
+                    pxCtx->xInOffsets[ x ] = ( size_t ) ( *ppucIn[ x ] - pxSsl->in_buf );
+                    pxCtx->xOutOffsets[ x ] = ( size_t ) ( *ppucOut[ x ] - pxSsl->out_buf );
+                    *ppucIn[ x ] = NULL;
+                    *ppucOut[ x ] = NULL;
+                }
+
+                xOwned = ( TLS_BUFFERS_OWNED == pxCtx->xBufferState ) ? pdTRUE : pdFALSE;
+                pucIn = pxSsl->in_buf;
+                pucOut = pxSsl->out_buf;
+                pxSsl->in_buf = NULL;
+                pxSsl->out_buf = NULL;
+                pxCtx->xBufferState = TLS_BUFFERS_RETURNED;
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        if( pdTRUE == xOwned )
+        {
+            /* The buffers mbedTLS allocated for the handshake are freed as mbedtls_ssl_free() would. */
+            mbedtls_platform_zeroize( pucIn, MBEDTLS_SSL_IN_BUFFER_LEN );
+            mbedtls_free( pucIn );
+            mbedtls_platform_zeroize( pucOut, MBEDTLS_SSL_OUT_BUFFER_LEN );
+            mbedtls_free( pucOut );
+        }
+        else if( NULL != pucIn )
+        {
+            prvBufferPoolGive( pucIn );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief End a call into mbedTLS started with prvAcquireBuffers(), and return
+ * the buffers if the connection has gone idle.
+ *
+ * @param[in] pxCtx Caller context.
+ */
+    static void prvReleaseBuffers( TLSContext_t * pxCtx )
+    {
+        vTaskSuspendAll();
+        {
+            /* The count is cleared if the context was freed during the call. */
+            if( 0 < pxCtx->uxBufferUsers )
+            {
+                pxCtx->uxBufferUsers--;
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        prvReturnIdleBuffers( pxCtx );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Give leased buffers back before the connection is freed, since
+ * mbedtls_ssl_free() frees any buffers it finds.
+ *
+ * @param[in] pxCtx Caller context.
+ */
+    static void prvDropBuffers( TLSContext_t * pxCtx )
+    {
+        unsigned char * pucBlock = NULL;
+
+        vTaskSuspendAll();
+        {
+            if( TLS_BUFFERS_LEASED == pxCtx->xBufferState )
+            {
+                pucBlock = pxCtx->xMbedSslCtx.in_buf;
+                pxCtx->xMbedSslCtx.in_buf = NULL;
+                pxCtx->xMbedSslCtx.out_buf = NULL;
+            }
+
+            pxCtx->xBufferState = TLS_BUFFERS_OWNED;
+            pxCtx->uxBufferUsers = 0;
+            pxCtx->xHasPeekedByte = pdFALSE;
+        }
+        ( void ) xTaskResumeAll();
+
+        if( NULL != pucBlock )
+        {
+            prvBufferPoolGive( pucBlock );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Wait for the next record on an idle connection without holding
+ * buffers, by receiving its first byte into the context.
+ *
+ * @param[in] pxCtx Caller context.
+ *
+ * @return Positive if a record is arriving, zero if no data was received,
+ * or a negative value on error.
+ */
+    static BaseType_t prvPeekRecord( TLSContext_t * pxCtx )
+    {
+        BaseType_t xResult = 1;
+
+        if( ( TLS_BUFFERS_RETURNED == pxCtx->xBufferState ) &&
+            ( pdFALSE == pxCtx->xHasPeekedByte ) )
+        {
+            xResult = pxCtx->xNetworkRecv( pxCtx->pvCallerContext, &pxCtx->ucPeekedByte, 1 );
+
+            if( 0 < xResult )
+            {
+                pxCtx->xHasPeekedByte = pdTRUE;
+            }
+        }
+
+        return xResult;
+    }
+
+/*-----------------------------------------------------------*/
+
+    UBaseType_t TLS_GetBufferPoolPeak( void )
+    {
+        return uxBufferPoolPeak;
+    }
+
+/*-----------------------------------------------------------*/
+#endif /* if ( tlsconfigUSE_BUFFER_POOL == 1 ) */
+
+/**
+ * @brief The DRBG shared by all connections, and the PKCS #11 session that seeds it.
+ */
+static mbedtls_ctr_drbg_context xDrbgCtx;
+static CK_SESSION_HANDLE xDrbgSession = CK_INVALID_HANDLE;
+static BaseType_t xDrbgSeeded = pdFALSE;
+static TickType_t xDrbgSeedTime = 0;
+
+/**
+ * @brief Guards the shared DRBG and its cache.
+ */
+static SemaphoreHandle_t xDrbgLock = NULL;
+
+/**
+ * @brief Random bytes drawn ahead of time for small requests, used from the end.
+ */
+static unsigned char ucDrbgCache[ tlsconfigDRBG_CACHE_SIZE ];
+static size_t xDrbgCacheAvailable = 0;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Helper to seed the entropy module used by the DRBG. Periodically this
+ * this function will be called to get more random data from the TRNG.
+ *
+ * @param[in] pvSession The PKCS #11 session.
+ * @param[out] outputBuffer The output buffer to return the generated random data.
+ * @param[in] outputBufferLength Length of the output buffer.
+ *
+ * @return Zero on success, otherwise a negative error code telling the cause of the error.
+ */
+static int prvEntropyCallback( void * pvSession,
+                               unsigned char * outputBuffer,
+                               size_t outputBufferLength )
+{
+    int ret = MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
+    CK_RV xResult = CKR_OK;
+    CK_SESSION_HANDLE xSession = *( ( CK_SESSION_HANDLE * ) pvSession ); /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+    if( xSession != CK_INVALID_HANDLE )
+    {
+        xResult = C_GenerateRandom( xSession,
+                                    outputBuffer,
+                                    outputBufferLength );
+    }
+    else
+    {
+        xResult = CKR_SESSION_HANDLE_INVALID;
+        TLS_PRINT( ( "Error: PKCS #11 session was not initialized.\r\n" ) );
+    }
+
+    if( xResult == CKR_OK )
+    {
+        ret = 0;
+    }
+    else
+    {
+        TLS_PRINT( ( "Error: PKCS #11 C_GenerateRandom failed with error code:" \
+                     "%d\r\n", xResult ) );
+    }
+
+    return ret;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Seed the shared DRBG on first use, and reseed it once the reseed
+ * interval has passed. Must be called with xDrbgLock held.
+ *
+ * @return Zero on success, otherwise an mbedTLS or PKCS #11 error code.
+ */
+static int prvDrbgSeed( void )
+{
+    int xResult = 0;
+
+    if( pdFALSE == xDrbgSeeded )
+    {
+        if( CK_INVALID_HANDLE == xDrbgSession )
+        {
+            xResult = ( int ) xInitializePkcs11Session( &xDrbgSession );
+
+            /* It is ok if the module was previously initialized. */
+            if( xResult == CKR_CRYPTOKI_ALREADY_INITIALIZED )
+            {
+                xResult = CKR_OK;
+            }
+        }
+
+        if( xResult == CKR_OK )
+        {
+            mbedtls_ctr_drbg_init( &xDrbgCtx );
+            xResult = mbedtls_ctr_drbg_seed( &xDrbgCtx,
+                                             prvEntropyCallback,
+                                             &xDrbgSession,
+                                             NULL,
+                                             0 );
+
+            if( 0 == xResult )
+            {
+                xDrbgSeeded = pdTRUE;
+                xDrbgSeedTime = xTaskGetTickCount();
+            }
+            else
+            {
+                mbedtls_ctr_drbg_free( &xDrbgCtx );
+            }
+        }
+    }
+    else if( ( xTaskGetTickCount() - xDrbgSeedTime ) >= pdMS_TO_TICKS( tlsconfigDRBG_RESEED_INTERVAL_MS ) )
+    {
+        xResult = mbedtls_ctr_drbg_reseed( &xDrbgCtx, NULL, 0 );
+
+        if( 0 == xResult )
+        {
+            xDrbgSeedTime = xTaskGetTickCount();
+
+            /* Bytes drawn before the reseed are not handed out after it. */
+            ( void ) memset( ucDrbgCache, 0, sizeof( ucDrbgCache ) );
+            xDrbgCacheAvailable = 0;
+        }
+    }
+    else
+    {
+        /* Seeded recently enough. */
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Draw bytes from the shared DRBG, in pieces no longer than it allows
+ * per request. Must be called with xDrbgLock held.
+ *
+ * @return Zero on success, otherwise an mbedTLS error code.
+ */
+static int prvDrbgRandom( unsigned char * pucRandom,
+                          size_t xRandomLength )
+{
+    int xResult = 0;
+    size_t xChunk = 0;
+
+    while( ( 0 == xResult ) && ( xRandomLength > 0U ) )
+    {
+        xChunk = ( xRandomLength > MBEDTLS_CTR_DRBG_MAX_REQUEST ) ? MBEDTLS_CTR_DRBG_MAX_REQUEST : xRandomLength;
+        xResult = mbedtls_ctr_drbg_random( &xDrbgCtx, pucRandom, xChunk );
+        pucRandom += xChunk;
+        xRandomLength -= xChunk;
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TLS_GenerateRandom( unsigned char * pucRandom,
+                               size_t xRandomLength )
+{
+    static StaticSemaphore_t xStaticSemaphore;
+    int xResult = 0;
+
+    /* Create the lock the first time through. */
+    portENTER_CRITICAL();
+
+    if( NULL == xDrbgLock )
+    {
+        xDrbgLock = xSemaphoreCreateMutexStatic( &xStaticSemaphore );
+    }
+
+    portEXIT_CRITICAL();
+
+    ( void ) xSemaphoreTake( xDrbgLock, portMAX_DELAY );
+
+    xResult = prvDrbgSeed();
+
+    if( 0 == xResult )
+    {
+        if( xRandomLength > sizeof( ucDrbgCache ) )
+        {
+            xResult = prvDrbgRandom( pucRandom, xRandomLength );
+        }
+        else
+        {
+            /* Refill the cache when it cannot cover the request, so that small
+             * requests share the cost of a DRBG call. */
+            if( xDrbgCacheAvailable < xRandomLength )
+            {
+                xResult = prvDrbgRandom( ucDrbgCache, sizeof( ucDrbgCache ) );
+                xDrbgCacheAvailable = ( 0 == xResult ) ? sizeof( ucDrbgCache ) : 0U;
+            }
+
+            if( 0 == xResult )
+            {
+                xDrbgCacheAvailable -= xRandomLength;
+                ( void ) memcpy( pucRandom, &ucDrbgCache[ xDrbgCacheAvailable ], xRandomLength );
+                ( void ) memset( &ucDrbgCache[ xDrbgCacheAvailable ], 0, xRandomLength );
+            }
+        }
+    }
+
+    ( void ) xSemaphoreGive( xDrbgLock );
+
+    if( 0 != xResult )
+    {
+        TLS_PRINT( ( "ERROR: Failed to generate random bytes %s : %s \r\n",
+                     mbedtlsHighLevelCodeOrDefault( xResult ),
+                     mbedtlsLowLevelCodeOrDefault( xResult ) ) );
+    }
+
+    return ( 0 == xResult ) ? 0 : TLS_ERROR_RNG;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( tlsconfigUSE_SIGNING_SERVICE == 1 )
+
+/**
+ * @brief A signing request, on the stack of the task waiting for it.
  */
-static const char * pNoHighLevelMbedTlsCodeStr = "<No-High-Level-Code>";
+    typedef struct TLSSignRequest
+    {
+        CK_MECHANISM_TYPE xMechanism;
+        CK_OBJECT_HANDLE xPrivateKey;
+        const CK_BYTE * pucData;
+        CK_ULONG ulDataLength;
+        CK_BYTE * pucSignature;
+        CK_ULONG * pulSignatureLength;
+        SemaphoreHandle_t xDone;
+        CK_RV xResult;
+    } TLSSignRequest_t;
 
 /**
- * @brief Represents string to be logged when mbedTLS returned error
- * does not contain a low-level code.
+ * @brief Requests waiting for a signing task.
  */
-static const char * pNoLowLevelMbedTlsCodeStr = "<No-Low-Level-Code>";
+    static QueueHandle_t xSignQueue = NULL;
 
 /**
- * @brief Utility for converting the high-level code in an mbedTLS error to string,
- * if the code-contains a high-level code; otherwise, using a default string.
+ * @brief Functions the signing tasks sign with, if not the module's own.
  */
-#define mbedtlsHighLevelCodeOrDefault( mbedTlsCode )        \
-    ( mbedtls_strerror_highlevel( mbedTlsCode ) != NULL ) ? \
-    mbedtls_strerror_highlevel( mbedTlsCode ) : pNoHighLevelMbedTlsCodeStr
+    static CK_FUNCTION_LIST_PTR pxSignFunctionList = NULL;
 
+/*-----------------------------------------------------------*/
 
 /**
- * @brief Utility for converting the level-level code in an mbedTLS error to string,
- * if the code-contains a level-level code; otherwise, using a default string.
+ * @brief Sign one request on the session of a signing task.
  */
-#define mbedtlsLowLevelCodeOrDefault( mbedTlsCode )        \
-    ( mbedtls_strerror_lowlevel( mbedTlsCode ) != NULL ) ? \
-    mbedtls_strerror_lowlevel( mbedTlsCode ) : pNoLowLevelMbedTlsCodeStr
+    static void prvSignRequest( CK_SESSION_HANDLE xSession,
+                                TLSSignRequest_t * pxRequest )
+    {
+        CK_FUNCTION_LIST_PTR pxFunctionList = pxSignFunctionList;
+        CK_MECHANISM xMech = { 0 };
+        CK_RV xResult = CKR_OK;
+
+        if( NULL == pxFunctionList )
+        {
+            xResult = C_GetFunctionList( &pxFunctionList );
+        }
+
+        if( CKR_OK == xResult )
+        {
+            xMech.mechanism = pxRequest->xMechanism;
+            xResult = pxFunctionList->C_SignInit( xSession,
+                                                  &xMech,
+                                                  pxRequest->xPrivateKey );
+        }
+
+        if( CKR_OK == xResult )
+        {
+            xResult = pxFunctionList->C_Sign( xSession,
+                                              ( CK_BYTE_PTR ) pxRequest->pucData,
+                                              pxRequest->ulDataLength,
+                                              pxRequest->pucSignature,
+                                              pxRequest->pulSignatureLength );
+        }
+
+        pxRequest->xResult = xResult;
+        ( void ) xSemaphoreGive( pxRequest->xDone );
+    }
 
+/*-----------------------------------------------------------*/
 
 /**
- * @brief Internal context structure.
+ * @brief Signing task. Opens its own PKCS #11 session, then serves up to
+ * tlsconfigSIGNING_BATCH_SIZE waiting requests each time it wakes.
  *
- * @param[in] pcDestination Server location, can be a DNS name or IP address.
- * @param[in] pcServerCertificate Server X.509 certificate in PEM format to trust.
- * @param[in] ulServerCertificateLength Length in bytes of the server certificate.
- * @param[in] xNetworkRecv Callback for receiving data on an open TCP socket.
- * @param[in] xNetworkSend Callback for sending data on an open TCP socket.
- * @param[in] pvCallerContext Opaque pointer provided by caller for above callbacks.
- * @param[out] xTLSHandshakeState Indicates the state of the TLS handshake.
- * @param[out] xMbedSslCtx Connection context for mbedTLS.
- * @param[out] xMbedSslConfig Configuration context for mbedTLS.
- * @param[out] xMbedX509CA Server certificate context for mbedTLS.
- * @param[out] xMbedX509Cli Client certificate context for mbedTLS.
- * @param[out] mbedPkAltCtx RSA crypto implementation context for mbedTLS.
- * @param[out] pxP11FunctionList PKCS#11 function list structure.
- * @param[out] xP11Session PKCS#11 session context.
- * @param[out] xP11PrivateKey PKCS#11 private key context.
+ * @param[in] pvParameters Unused.
  */
-typedef struct TLSContext
-{
-    const char * pcDestination;
-    const char * pcServerCertificate;
-    uint32_t ulServerCertificateLength;
-    const char ** ppcAlpnProtocols;
-    uint32_t ulAlpnProtocolsCount;
+    static void prvSigningTask( void * pvParameters )
+    {
+        CK_SESSION_HANDLE xSession = CK_INVALID_HANDLE;
+        TLSSignRequest_t * pxRequest = NULL;
+        CK_RV xResult;
+        UBaseType_t uxBatch;
 
-    NetworkRecv_t xNetworkRecv;
-    NetworkSend_t xNetworkSend;
-    void * pvCallerContext;
-    BaseType_t xTLSHandshakeState;
+        ( void ) pvParameters;
 
-    /* mbedTLS. */
-    mbedtls_ssl_context xMbedSslCtx;
-    mbedtls_ssl_config xMbedSslConfig;
-    mbedtls_x509_crt xMbedX509CA;
-    mbedtls_x509_crt xMbedX509Cli;
-    mbedtls_pk_context xMbedPkCtx;
-    mbedtls_pk_info_t xMbedPkInfo;
-    mbedtls_ctr_drbg_context xMbedDrbgCtx;
+        for( ; ; )
+        {
+            ( void ) xQueueReceive( xSignQueue, &pxRequest, portMAX_DELAY );
 
-    /* PKCS#11. */
-    CK_FUNCTION_LIST_PTR pxP11FunctionList;
-    CK_SESSION_HANDLE xP11Session;
-    CK_OBJECT_HANDLE xP11PrivateKey;
-    CK_KEY_TYPE xKeyType;
-} TLSContext_t;
+            for( uxBatch = 0; uxBatch < tlsconfigSIGNING_BATCH_SIZE; uxBatch++ )
+            {
+                /* Open the session here rather than at start up, so that a
+                 * failure is reported to the request and retried by the next. */
+                if( CK_INVALID_HANDLE == xSession )
+                {
+                    xResult = xInitializePkcs11Session( &xSession );
+
+                    if( CKR_CRYPTOKI_ALREADY_INITIALIZED == xResult )
+                    {
+                        xResult = CKR_OK;
+                    }
+
+                    if( CKR_OK == xResult )
+                    {
+                        xResult = C_Login( xSession,
+                                           CKU_USER,
+                                           ( CK_UTF8CHAR_PTR ) configPKCS11_DEFAULT_USER_PIN,
+                                           sizeof( configPKCS11_DEFAULT_USER_PIN ) - 1 );
+
+                        /* Logging in is shared by the sessions of the application. */
+                        if( CKR_USER_ALREADY_LOGGED_IN == xResult )
+                        {
+                            xResult = CKR_OK;
+                        }
+                    }
+
+                    if( CKR_OK != xResult )
+                    {
+                        TLS_PRINT( ( "ERROR: Failed to open a signing session: %d \r\n", ( int ) xResult ) );
+
+                        if( CK_INVALID_HANDLE != xSession )
+                        {
+                            ( void ) C_CloseSession( xSession );
+                            xSession = CK_INVALID_HANDLE;
+                        }
+
+                        pxRequest->xResult = xResult;
+                        ( void ) xSemaphoreGive( pxRequest->xDone );
+                    }
+                }
 
-#define TLS_HANDSHAKE_NOT_STARTED    ( 0 )      /* Must be 0 */
-#define TLS_HANDSHAKE_STARTED        ( 1 )
-#define TLS_HANDSHAKE_SUCCESSFUL     ( 2 )
+                if( CK_INVALID_HANDLE != xSession )
+                {
+                    prvSignRequest( xSession, pxRequest );
+                }
 
-#define TLS_PRINT( X )    configPRINTF( X )
+                if( ( uxBatch + 1U < tlsconfigSIGNING_BATCH_SIZE ) &&
+                    ( pdTRUE != xQueueReceive( xSignQueue, &pxRequest, 0 ) ) )
+                {
+                    break;
+                }
+            }
+        }
+    }
 
 /*-----------------------------------------------------------*/
 
-/*
- * Helper routines.
+/**
+ * @brief Create the request queue and the signing tasks the first time through.
+ *
+ * @return CKR_OK if the signing service is running.
  */
+    static CK_RV prvSigningServiceStart( void )
+    {
+        static StaticSemaphore_t xStaticSemaphore;
+        static SemaphoreHandle_t xStartLock = NULL;
+        CK_RV xResult = CKR_OK;
+        UBaseType_t uxTask;
+
+        portENTER_CRITICAL();
+
+        if( NULL == xStartLock )
+        {
+            xStartLock = xSemaphoreCreateMutexStatic( &xStaticSemaphore );
+        }
+
+        portEXIT_CRITICAL();
+
+        ( void ) xSemaphoreTake( xStartLock, portMAX_DELAY );
+
+        if( NULL == xSignQueue )
+        {
+            xSignQueue = xQueueCreate( tlsconfigSIGNING_QUEUE_LENGTH, sizeof( TLSSignRequest_t * ) );
+
+            if( NULL == xSignQueue )
+            {
+                xResult = CKR_HOST_MEMORY;
+            }
+
+            /* The service keeps running with the tasks that could be created. */
+            for( uxTask = 0; ( CKR_OK == xResult ) && ( uxTask < tlsconfigSIGNING_SESSIONS ); uxTask++ )
+            {
+                if( pdPASS != xTaskCreate( prvSigningTask,
+                                           "TLSSign",
+                                           tlsconfigSIGNING_TASK_STACK_SIZE,
+                                           NULL,
+                                           tlsconfigSIGNING_TASK_PRIORITY,
+                                           NULL ) )
+                {
+                    if( 0U == uxTask )
+                    {
+                        vQueueDelete( xSignQueue );
+                        xSignQueue = NULL;
+                        xResult = CKR_HOST_MEMORY;
+                    }
+
+                    break;
+                }
+            }
+        }
+
+        ( void ) xSemaphoreGive( xStartLock );
+
+        return xResult;
+    }
+
+/*-----------------------------------------------------------*/
+
+    CK_RV TLS_Sign( CK_MECHANISM_TYPE xMechanism,
+                    CK_OBJECT_HANDLE xPrivateKey,
+                    const CK_BYTE * pucData,
+                    CK_ULONG ulDataLength,
+                    CK_BYTE * pucSignature,
+                    CK_ULONG * pulSignatureLength )
+    {
+        StaticSemaphore_t xDoneBuffer;
+        TLSSignRequest_t xRequest;
+        TLSSignRequest_t * pxRequest = &xRequest;
+        CK_RV xResult;
+
+        xResult = prvSigningServiceStart();
+
+        if( CKR_OK == xResult )
+        {
+            xRequest.xMechanism = xMechanism;
+            xRequest.xPrivateKey = xPrivateKey;
+            xRequest.pucData = pucData;
+            xRequest.ulDataLength = ulDataLength;
+            xRequest.pucSignature = pucSignature;
+            xRequest.pulSignatureLength = pulSignatureLength;
+            xRequest.xResult = CKR_FUNCTION_FAILED;
+            xRequest.xDone = xSemaphoreCreateBinaryStatic( &xDoneBuffer );
+
+            ( void ) xQueueSend( xSignQueue, &pxRequest, portMAX_DELAY );
+            ( void ) xSemaphoreTake( xRequest.xDone, portMAX_DELAY );
+
+            vSemaphoreDelete( xRequest.xDone );
+            xResult = xRequest.xResult;
+        }
+
+        return xResult;
+    }
+
+/*-----------------------------------------------------------*/
+
+    void TLS_SetSigningFunctionList( CK_FUNCTION_LIST_PTR pxFunctionList )
+    {
+        pxSignFunctionList = pxFunctionList;
+    }
+
+/*-----------------------------------------------------------*/
+#endif /* if ( tlsconfigUSE_SIGNING_SERVICE == 1 ) */
 
 /**
  * @brief TLS internal context rundown helper routine.
@@ -157,10 +1039,18 @@ static void prvFreeContext( TLSContext_t * pxCtx )
     if( NULL != pxCtx )
     {
         /* Cleanup mbedTLS. */
-        mbedtls_ssl_close_notify( &pxCtx->xMbedSslCtx ); /*lint !e534 The error is already taken care of inside mbedtls_ssl_close_notify*/
+        #if ( tlsconfigUSE_BUFFER_POOL == 1 )
+            if( pdPASS == prvAcquireBuffers( pxCtx ) )
+            {
+                mbedtls_ssl_close_notify( &pxCtx->xMbedSslCtx ); /*lint !e534 The error is already taken care of inside mbedtls_ssl_close_notify*/
+            }
+
+            prvDropBuffers( pxCtx );
+        #else
+            mbedtls_ssl_close_notify( &pxCtx->xMbedSslCtx ); /*lint !e534 The error is already taken care of inside mbedtls_ssl_close_notify*/
+        #endif
         mbedtls_ssl_free( &pxCtx->xMbedSslCtx );
         mbedtls_ssl_config_free( &pxCtx->xMbedSslConfig );
-        mbedtls_ctr_drbg_free( &pxCtx->xMbedDrbgCtx );
 
         /* Cleanup PKCS11 only if the handshake was started. */
         if( ( TLS_HANDSHAKE_NOT_STARTED != pxCtx->xTLSHandshakeState ) &&
@@ -211,14 +1101,29 @@ static int prvNetworkRecv( void * pvContext,
                            size_t xReceiveLength )
 {
     TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+    int lResult = 0;
+
+    #if ( tlsconfigUSE_BUFFER_POOL == 1 )
+        if( ( pdTRUE == pxCtx->xHasPeekedByte ) && ( 0 < xReceiveLength ) )
+        {
+            /* Pass on the byte received while the connection was idle. */
+            *pucReceiveBuffer = pxCtx->ucPeekedByte;
+            pxCtx->xHasPeekedByte = pdFALSE;
+            lResult = 1;
+        }
+        else
+    #endif
+    {
+        lResult = ( int ) pxCtx->xNetworkRecv( pxCtx->pvCallerContext, pucReceiveBuffer, xReceiveLength );
+    }
 
-    return ( int ) pxCtx->xNetworkRecv( pxCtx->pvCallerContext, pucReceiveBuffer, xReceiveLength );
+    return lResult;
 }
 
 /*-----------------------------------------------------------*/
 
 /**
- * @brief Callback that wraps PKCS#11 for pseudo-random number generation.
+ * @brief Callback that draws from the shared DRBG for pseudo-random number generation.
  *
  * @param[in] pvCtx Caller context.
  * @param[in] pucRandom Byte array to fill with random data.
@@ -230,20 +1135,10 @@ static int prvGenerateRandomBytes( void * pvCtx,
                                    unsigned char * pucRandom,
                                    size_t xRandomLength )
 {
-    TLSContext_t * pxCtx = ( TLSContext_t * ) pvCtx; /*lint !e9087 !e9079 Allow casting void* to other types. */
-    int xResult = 0;
-
-    xResult = mbedtls_ctr_drbg_random( &pxCtx->xMbedDrbgCtx, pucRandom, xRandomLength );
+    /* Unused parameter. */
+    ( void ) pvCtx;
 
-    if( xResult != 0 )
-    {
-        TLS_PRINT( ( "ERROR: Failed to generate random bytes %s : %s \r\n",
-                     mbedtlsHighLevelCodeOrDefault( xResult ),
-                     mbedtlsLowLevelCodeOrDefault( xResult ) ) );
-        xResult = TLS_ERROR_RNG;
-    }
-
-    return xResult;
+    return ( int ) TLS_GenerateRandom( pucRandom, xRandomLength );
 }
 
 /*-----------------------------------------------------------*/
@@ -389,23 +1284,37 @@ static int prvPrivateKeySigningCallback( void * pvContext,
         xResult = CKR_ARGUMENTS_BAD;
     }
 
-    if( CKR_OK == xResult )
-    {
-        /* Use the PKCS#11 module to sign. */
-        xResult = pxTLSContext->pxP11FunctionList->C_SignInit( pxTLSContext->xP11Session,
-                                                               &xMech,
-                                                               pxTLSContext->xP11PrivateKey );
-    }
+    #if ( tlsconfigUSE_SIGNING_SERVICE == 1 )
+        if( CKR_OK == xResult )
+        {
+            /* Queue the request to the signing service and wait for it. */
+            *pxSigLen = sizeof( xToBeSigned );
+            xResult = TLS_Sign( xMech.mechanism,
+                                pxTLSContext->xP11PrivateKey,
+                                xToBeSigned,
+                                xToBeSignedLen,
+                                pucSig,
+                                ( CK_ULONG_PTR ) pxSigLen );
+        }
+    #else
+        if( CKR_OK == xResult )
+        {
+            /* Use the PKCS#11 module to sign. */
+            xResult = pxTLSContext->pxP11FunctionList->C_SignInit( pxTLSContext->xP11Session,
+                                                                   &xMech,
+                                                                   pxTLSContext->xP11PrivateKey );
+        }
 
-    if( CKR_OK == xResult )
-    {
-        *pxSigLen = sizeof( xToBeSigned );
-        xResult = pxTLSContext->pxP11FunctionList->C_Sign( ( CK_SESSION_HANDLE ) pxTLSContext->xP11Session,
-                                                           xToBeSigned,
-                                                           xToBeSignedLen,
-                                                           pucSig,
-                                                           ( CK_ULONG_PTR ) pxSigLen );
-    }
+        if( CKR_OK == xResult )
+        {
+            *pxSigLen = sizeof( xToBeSigned );
+            xResult = pxTLSContext->pxP11FunctionList->C_Sign( ( CK_SESSION_HANDLE ) pxTLSContext->xP11Session,
+                                                               xToBeSigned,
+                                                               xToBeSignedLen,
+                                                               pucSig,
+                                                               ( CK_ULONG_PTR ) pxSigLen );
+        }
+    #endif /* if ( tlsconfigUSE_SIGNING_SERVICE == 1 ) */
 
     if( ( xResult == CKR_OK ) && ( CKK_EC == pxTLSContext->xKeyType ) )
     {
@@ -656,49 +1565,6 @@ static int prvInitializeClientCredential( TLSContext_t * pxCtx )
 
 /*-----------------------------------------------------------*/
 
-/**
- * @brief Helper to seed the entropy module used by the DRBG. Periodically this
- * this function will be called to get more random data from the TRNG.
- *
- * @param[in] tlsContext The TLS context.
- * @param[out] outputBuffer The output buffer to return the generated random data.
- * @param[in] outputBufferLength Length of the output buffer.
- *
- * @return Zero on success, otherwise a negative error code telling the cause of the error.
- */
-static int prvEntropyCallback( void * tlsContext,
-                               unsigned char * outputBuffer,
-                               size_t outputBufferLength )
-{
-    int ret = MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
-    CK_RV xResult = CKR_OK;
-    TLSContext_t * pxCtx = ( TLSContext_t * ) tlsContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
-
-    if( pxCtx->xP11Session != CK_INVALID_HANDLE )
-    {
-        xResult = C_GenerateRandom( pxCtx->xP11Session,
-                                    outputBuffer,
-                                    outputBufferLength );
-    }
-    else
-    {
-        xResult = CKR_SESSION_HANDLE_INVALID;
-        TLS_PRINT( ( "Error: PKCS #11 session was not initialized.\r\n" ) );
-    }
-
-    if( xResult == CKR_OK )
-    {
-        ret = 0;
-    }
-    else
-    {
-        TLS_PRINT( ( "Error: PKCS #11 C_GenerateRandom failed with error code:" \
-                     "%d\r\n", xResult ) );
-    }
-
-    return ret;
-}
-
 /*
  * Interface routines.
  */
@@ -707,7 +1573,6 @@ BaseType_t TLS_Init( void ** ppvContext,
                      TLSParams_t * pxParams )
 {
     BaseType_t xResult = CKR_OK;
-    int mbedTLSResult = 0;
     TLSContext_t * pxCtx = NULL;
     CK_C_GetFunctionList xCkGetFunctionList = NULL;
 
@@ -744,24 +1609,6 @@ BaseType_t TLS_Init( void ** ppvContext,
                 xResult = CKR_OK;
             }
         }
-
-        if( xResult == CKR_OK )
-        {
-            mbedtls_ctr_drbg_init( &pxCtx->xMbedDrbgCtx );
-            mbedTLSResult = mbedtls_ctr_drbg_seed( &pxCtx->xMbedDrbgCtx,
-                                                   prvEntropyCallback,
-                                                   pxCtx,
-                                                   NULL,
-                                                   0 );
-
-            if( 0 != mbedTLSResult )
-            {
-                TLS_PRINT( ( "ERROR: Failed to setup DRBG seed %s : %s \r\n",
-                             mbedtlsHighLevelCodeOrDefault( mbedTLSResult ),
-                             mbedtlsLowLevelCodeOrDefault( mbedTLSResult ) ) );
-                xResult = CKR_FUNCTION_FAILED;
-            }
-        }
     }
     else
     {
@@ -953,6 +1800,11 @@ BaseType_t TLS_Connect( void * pvContext )
     if( 0 == xResult )
     {
         pxCtx->xTLSHandshakeState = TLS_HANDSHAKE_SUCCESSFUL;
+
+        #if ( tlsconfigUSE_BUFFER_POOL == 1 )
+            /* Free the handshake buffers; records are exchanged in leased ones from now on. */
+            prvReturnIdleBuffers( pxCtx );
+        #endif
     }
     else if( xResult > 0 )
     {
@@ -977,13 +1829,43 @@ BaseType_t TLS_Recv( void * pvContext,
     BaseType_t xResult = 0;
     TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
     size_t xRead = 0;
+    size_t xAvailable = 0;
+    BaseType_t xLeased = pdTRUE;
 
     if( ( NULL != pxCtx ) && ( TLS_HANDSHAKE_SUCCESSFUL == pxCtx->xTLSHandshakeState ) )
+    {
+        #if ( tlsconfigUSE_BUFFER_POOL == 1 )
+
+            /* An idle connection leases buffers only once a record starts to arrive.
+             * If none are free, the byte already received waits for the next call. */
+            xResult = prvPeekRecord( pxCtx );
+
+            if( 0 < xResult )
+            {
+                xLeased = prvAcquireBuffers( pxCtx );
+                xResult = 0;
+            }
+            else
+            {
+                xLeased = pdFALSE;
+            }
+        #endif /* if ( tlsconfigUSE_BUFFER_POOL == 1 ) */
+    }
+    else
+    {
+        xResult = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+        xLeased = pdFALSE;
+    }
+
+    if( pdTRUE == xLeased )
     {
         /* This routine will return however many bytes are returned from from mbedtls_ssl_read
          * immediately unless MBEDTLS_ERR_SSL_WANT_READ is returned, in which case we try again. */
         do
         {
+            /* A read that returns data while nothing was left over from the
+             * previous one has decrypted a new record. */
+            xAvailable = mbedtls_ssl_get_bytes_avail( &pxCtx->xMbedSslCtx );
             xResult = mbedtls_ssl_read( &pxCtx->xMbedSslCtx,
                                         pucReadBuffer + xRead,
                                         xReadLength - xRead );
@@ -992,16 +1874,21 @@ BaseType_t TLS_Recv( void * pvContext,
             {
                 /* Got data, so update the tally and keep looping. */
                 xRead += ( size_t ) xResult;
+
+                if( 0U == xAvailable )
+                {
+                    pxCtx->ulRecordsReceived++;
+                }
             }
 
             /* If xResult == 0, then no data was received (and there is no error).
              * The secure sockets API supports non-blocking read, so stop the loop,
              * but don't flag an error. */
         } while( ( xResult == MBEDTLS_ERR_SSL_WANT_READ ) );
-    }
-    else
-    {
-        xResult = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+
+        #if ( tlsconfigUSE_BUFFER_POOL == 1 )
+            prvReleaseBuffers( pxCtx );
+        #endif
     }
 
     if( xResult >= 0 )
@@ -1026,8 +1913,22 @@ BaseType_t TLS_Send( void * pvContext,
     BaseType_t xResult = 0;
     TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
     size_t xWritten = 0;
+    BaseType_t xLeased = pdTRUE;
 
     if( ( NULL != pxCtx ) && ( TLS_HANDSHAKE_SUCCESSFUL == pxCtx->xTLSHandshakeState ) )
+    {
+        #if ( tlsconfigUSE_BUFFER_POOL == 1 )
+            /* With no buffers free, nothing is sent, as for a full socket. */
+            xLeased = prvAcquireBuffers( pxCtx );
+        #endif
+    }
+    else
+    {
+        xResult = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+        xLeased = pdFALSE;
+    }
+
+    if( pdTRUE == xLeased )
     {
         while( xWritten < xMsgLength )
         {
@@ -1037,8 +1938,10 @@ BaseType_t TLS_Send( void * pvContext,
 
             if( 0 < xResult )
             {
-                /* Sent data, so update the tally and keep looping. */
+                /* Sent data, so update the tally and keep looping. Each
+                 * successful write is one record. */
                 xWritten += ( size_t ) xResult;
+                pxCtx->ulRecordsSent++;
             }
             else if( ( 0 == xResult ) || ( -pdFREERTOS_ERRNO_ENOSPC == xResult ) )
             {
@@ -1055,10 +1958,10 @@ BaseType_t TLS_Send( void * pvContext,
                 break;
             }
         }
-    }
-    else
-    {
-        xResult = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+
+        #if ( tlsconfigUSE_BUFFER_POOL == 1 )
+            prvReleaseBuffers( pxCtx );
+        #endif
     }
 
     if( 0 <= xResult )
@@ -1071,6 +1974,24 @@ BaseType_t TLS_Send( void * pvContext,
 
 /*-----------------------------------------------------------*/
 
+void TLS_GetRecordCounts( void * pvContext,
+                          uint32_t * pulRecordsSent,
+                          uint32_t * pulRecordsReceived )
+{
+    TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+    *pulRecordsSent = 0;
+    *pulRecordsReceived = 0;
+
+    if( NULL != pxCtx )
+    {
+        *pulRecordsSent = pxCtx->ulRecordsSent;
+        *pulRecordsReceived = pxCtx->ulRecordsReceived;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 void TLS_Cleanup( void * pvContext )
 {
     TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
@@ -1083,3 +2004,8 @@ void TLS_Cleanup( void * pvContext )
         vPortFree( pxCtx );
     }
 }
+
+/* Provide access to private members for testing. */
+#if ( tlsconfigUSE_BUFFER_POOL == 1 ) && defined( FREERTOS_ENABLE_UNIT_TESTS )
+    #include "iot_tls_test_access_define.h"
+#endif
@@ -26,18 +26,28 @@
 /* Standard includes. */
 #include <string.h>
 
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
 /* Test framework includes. */
 #include "unity_fixture.h"
 #include "aws_test_runner.h"
 
 /* Secure sockets includes */
 #include "iot_secure_sockets.h"
+#include "iot_tls.h"
 
 /* Credential includes. */
 #include "aws_clientcredential.h"
 #include "aws_clientcredential_keys.h"
 #include "iot_test_tls.h"
 
+#if ( tlsconfigUSE_BUFFER_POOL == 1 )
+    #include "iot_tls_test_access_declare.h"
+#endif
+
 /* Configuration includes. */
 #include "core_pkcs11_config.h"
 #include "core_test_pkcs11_config.h"
@@ -47,6 +57,34 @@
 #include "core_pkcs11_config.h"
 #include "core_pkcs11.h"
 
+/*
+ * Number of back to back connections made by the connection storm benchmark.
+ */
+#ifndef tlstestCONNECT_STORM_COUNT
+    #define tlstestCONNECT_STORM_COUNT    10
+#endif
+
+#if ( tlsconfigUSE_SIGNING_SERVICE == 1 )
+
+/*
+ * Latency added to each signature by the PKCS #11 stand-in, as a secure element
+ * would, and the number of handshakes that sign at once.
+ */
+    #ifndef tlstestSIGNING_LATENCY_MS
+        #define tlstestSIGNING_LATENCY_MS    50
+    #endif
+    #define tlstestSIGNING_REQUESTS          8
+#endif
+
+#if ( tlsconfigUSE_BUFFER_POOL == 1 )
+
+/*
+ * Number of MQTT pings exchanged over a connection whose record buffers are pooled.
+ * Each ping and its response is one record.
+ */
+    #define tlstestBUFFER_POOL_PINGS    4
+#endif
+
 /*
  * Length of elliptic curve credentials included from aws_clientcredential_keys.h.
  */
@@ -85,6 +123,14 @@ TEST_TEAR_DOWN( Full_TLS )
 TEST_GROUP_RUNNER( Full_TLS )
 {
     RUN_TEST_CASE( Full_TLS, AFQP_TLS_ConnectDefault );
+    RUN_TEST_CASE( Full_TLS, AFQP_TLS_ConnectStorm );
+    #if ( tlsconfigUSE_SIGNING_SERVICE == 1 )
+        RUN_TEST_CASE( Full_TLS, AFQP_TLS_SigningServiceConcurrent );
+    #endif
+    #if ( tlsconfigUSE_BUFFER_POOL == 1 )
+        RUN_TEST_CASE( Full_TLS, AFQP_TLS_BufferPoolRecords );
+        RUN_TEST_CASE( Full_TLS, AFQP_TLS_BufferPoolAllocationFailure );
+    #endif
     #if ( pkcs11configIMPORT_PRIVATE_KEYS_SUPPORTED == 1 )
         #if ( pkcs11testEC_KEY_SUPPORT == 1 )
             RUN_TEST_CASE( Full_TLS, AFQP_TLS_ConnectEC );
@@ -307,6 +353,398 @@ TEST( Full_TLS, AFQP_TLS_ConnectDefault )
 }
 /*-----------------------------------------------------------*/
 
+/* Connects and disconnects repeatedly, as a fleet does when it reconnects at once,
+ * and reports the average time taken by a connection. */
+TEST( Full_TLS, AFQP_TLS_ConnectStorm )
+{
+    const char * pcAWSIoTAddress = clientcredentialMQTT_BROKER_ENDPOINT;
+    uint16_t usAWSIoTPort = clientcredentialMQTT_BROKER_PORT;
+    SocketsSockaddr_t xMQTTServerAddress = { 0 };
+    Socket_t xSocket;
+    BaseType_t xResult;
+    uint32_t ulConnection;
+    TickType_t xStart;
+    TickType_t xConnectTicks = 0;
+
+    xMQTTServerAddress.ulAddress = SOCKETS_GetHostByName( pcAWSIoTAddress );
+    xMQTTServerAddress.usPort = SOCKETS_htons( usAWSIoTPort );
+    xMQTTServerAddress.ucSocketDomain = SOCKETS_AF_INET;
+
+    for( ulConnection = 0; ulConnection < tlstestCONNECT_STORM_COUNT; ulConnection++ )
+    {
+        xSocket = prvSecureSocketCreate();
+
+        if( TEST_PROTECT() )
+        {
+            xResult = SOCKETS_SetSockOpt( xSocket, 0, SOCKETS_SO_SERVER_NAME_INDICATION, pcAWSIoTAddress, 1u + strlen( pcAWSIoTAddress ) );
+            TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket set sock opt server name indication failed" );
+
+            xStart = xTaskGetTickCount();
+            xResult = SOCKETS_Connect( xSocket, &xMQTTServerAddress, sizeof( xMQTTServerAddress ) );
+            xConnectTicks += xTaskGetTickCount() - xStart;
+            TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket connect failed" );
+
+            xResult = SOCKETS_Shutdown( xSocket, SOCKETS_SHUT_RDWR );
+            TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket disconnect failed" );
+        }
+
+        prvSecureSocketClose( xSocket );
+    }
+
+    configPRINTF( ( "%u TLS connections took %u ms each on average.\r\n",
+                    ( unsigned ) tlstestCONNECT_STORM_COUNT,
+                    ( unsigned ) ( ( xConnectTicks * portTICK_PERIOD_MS ) / tlstestCONNECT_STORM_COUNT ) ) );
+}
+/*-----------------------------------------------------------*/
+
+#if ( tlsconfigUSE_SIGNING_SERVICE == 1 )
+
+/* The PKCS #11 module's C_Sign, called by the stand-in after its latency. */
+    static CK_C_Sign xModuleSign = NULL;
+
+/* State shared with the tasks that sign at once. */
+    static CK_MECHANISM_TYPE xSignMechanism;
+    static CK_OBJECT_HANDLE xSignKey;
+    static CK_BYTE ucSignData[ pkcs11RSA_SIGNATURE_INPUT_LENGTH ];
+    static CK_ULONG ulSignDataLength;
+    static CK_RV xSignResults[ tlstestSIGNING_REQUESTS ];
+    static SemaphoreHandle_t xSignersDone = NULL;
+
+    static CK_RV prvSlowSign( CK_SESSION_HANDLE xSession,
+                              CK_BYTE_PTR pucData,
+                              CK_ULONG ulDataLength,
+                              CK_BYTE_PTR pucSignature,
+                              CK_ULONG_PTR pulSignatureLength )
+    {
+        vTaskDelay( pdMS_TO_TICKS( tlstestSIGNING_LATENCY_MS ) );
+
+        return xModuleSign( xSession, pucData, ulDataLength, pucSignature, pulSignatureLength );
+    }
+
+    static void prvSignerTask( void * pvParameters )
+    {
+        uint32_t ulIndex = ( uint32_t ) pvParameters;
+        CK_BYTE ucSignature[ 256 ];
+        CK_ULONG ulSignatureLength = sizeof( ucSignature );
+
+        xSignResults[ ulIndex ] = TLS_Sign( xSignMechanism,
+                                            xSignKey,
+                                            ucSignData,
+                                            ulSignDataLength,
+                                            ucSignature,
+                                            &ulSignatureLength );
+
+        ( void ) xSemaphoreGive( xSignersDone );
+        vTaskDelete( NULL );
+    }
+
+/* Signs for several handshakes at once through a PKCS #11 stand-in that takes
+ * tlstestSIGNING_LATENCY_MS per signature, and checks the signing sessions
+ * overlap those waits. */
+    TEST( Full_TLS, AFQP_TLS_SigningServiceConcurrent )
+    {
+        CK_FUNCTION_LIST_PTR pxModuleFunctionList = NULL;
+        CK_FUNCTION_LIST xSlowFunctionList;
+        CK_SESSION_HANDLE xSession = CK_INVALID_HANDLE;
+        CK_KEY_TYPE xKeyType = 0;
+        CK_ATTRIBUTE xTemplate;
+        CK_RV xResult;
+        uint32_t ulIndex;
+        uint32_t ulStarted;
+        TickType_t xStart;
+        TickType_t xElapsed;
+
+        xResult = C_GetFunctionList( &pxModuleFunctionList );
+        TEST_ASSERT_EQUAL_UINT32( CKR_OK, xResult );
+
+        xResult = xInitializePkcs11Session( &xSession );
+        TEST_ASSERT_TRUE( ( CKR_OK == xResult ) || ( CKR_CRYPTOKI_ALREADY_INITIALIZED == xResult ) );
+
+        xResult = xFindObjectWithLabelAndClass( xSession,
+                                                pkcs11configLABEL_DEVICE_PRIVATE_KEY_FOR_TLS,
+                                                CKO_PRIVATE_KEY,
+                                                &xSignKey );
+        TEST_ASSERT_EQUAL_UINT32( CKR_OK, xResult );
+        TEST_ASSERT_NOT_EQUAL( CK_INVALID_HANDLE, xSignKey );
+
+        xTemplate.type = CKA_KEY_TYPE;
+        xTemplate.pValue = &xKeyType;
+        xTemplate.ulValueLen = sizeof( xKeyType );
+        xResult = pxModuleFunctionList->C_GetAttributeValue( xSession, xSignKey, &xTemplate, 1 );
+        TEST_ASSERT_EQUAL_UINT32( CKR_OK, xResult );
+
+        /* Sign a SHA-256 sized hash, with the DigestInfo prefix for RSA. */
+        ( void ) memset( ucSignData, 0xA5, sizeof( ucSignData ) );
+
+        if( CKK_RSA == xKeyType )
+        {
+            xSignMechanism = CKM_RSA_PKCS;
+            xResult = vAppendSHA256AlgorithmIdentifierSequence( ucSignData, ucSignData );
+            TEST_ASSERT_EQUAL_UINT32( CKR_OK, xResult );
+            ulSignDataLength = pkcs11RSA_SIGNATURE_INPUT_LENGTH;
+        }
+        else
+        {
+            xSignMechanism = CKM_ECDSA;
+            ulSignDataLength = 32;
+        }
+
+        ( void ) C_CloseSession( xSession );
+
+        /* Put the latency in front of the module's C_Sign. */
+        xSlowFunctionList = *pxModuleFunctionList;
+        xModuleSign = pxModuleFunctionList->C_Sign;
+        xSlowFunctionList.C_Sign = prvSlowSign;
+        TLS_SetSigningFunctionList( &xSlowFunctionList );
+
+        xSignersDone = xSemaphoreCreateCounting( tlstestSIGNING_REQUESTS, 0 );
+        TEST_ASSERT_NOT_NULL( xSignersDone );
+
+        if( TEST_PROTECT() )
+        {
+            xStart = xTaskGetTickCount();
+
+            for( ulIndex = 0; ulIndex < tlstestSIGNING_REQUESTS; ulIndex++ )
+            {
+                xSignResults[ ulIndex ] = CKR_FUNCTION_FAILED;
+
+                if( pdPASS != xTaskCreate( prvSignerTask,
+                                           "Signer",
+                                           configMINIMAL_STACK_SIZE * 4,
+                                           ( void * ) ulIndex,
+                                           tskIDLE_PRIORITY + 1,
+                                           NULL ) )
+                {
+                    break;
+                }
+            }
+
+            /* Wait for the signers that were started, whether or not all were. */
+            ulStarted = ulIndex;
+
+            for( ulIndex = 0; ulIndex < ulStarted; ulIndex++ )
+            {
+                ( void ) xSemaphoreTake( xSignersDone, portMAX_DELAY );
+            }
+
+            TEST_ASSERT_EQUAL_UINT32_MESSAGE( tlstestSIGNING_REQUESTS, ulStarted, "Failed to start the signing tasks" );
+
+            xElapsed = xTaskGetTickCount() - xStart;
+            configPRINTF( ( "%u signatures of %u ms each took %u ms.\r\n",
+                            ( unsigned ) tlstestSIGNING_REQUESTS,
+                            ( unsigned ) tlstestSIGNING_LATENCY_MS,
+                            ( unsigned ) ( xElapsed * portTICK_PERIOD_MS ) ) );
+
+            for( ulIndex = 0; ulIndex < tlstestSIGNING_REQUESTS; ulIndex++ )
+            {
+                TEST_ASSERT_EQUAL_UINT32( CKR_OK, xSignResults[ ulIndex ] );
+            }
+
+            #if ( tlsconfigSIGNING_SESSIONS > 1 )
+                TEST_ASSERT_LESS_THAN_UINT32( tlstestSIGNING_REQUESTS * pdMS_TO_TICKS( tlstestSIGNING_LATENCY_MS ), xElapsed );
+            #endif
+        }
+
+        TLS_SetSigningFunctionList( NULL );
+        vSemaphoreDelete( xSignersDone );
+        xSignersDone = NULL;
+    }
+/*-----------------------------------------------------------*/
+#endif /* if ( tlsconfigUSE_SIGNING_SERVICE == 1 ) */
+
+#if ( tlsconfigUSE_BUFFER_POOL == 1 )
+
+/* MQTT ping request and response, used as small records that the broker always answers. */
+    static const unsigned char ucPingRequest[] = { 0xC0, 0x00 };
+    static const unsigned char ucPingResponse[] = { 0xD0, 0x00 };
+
+/* Network callbacks of a TLS context used directly, over an unsecured socket. */
+    static BaseType_t prvPlainSocketRecv( void * pvCallerContext,
+                                          unsigned char * pucReceiveBuffer,
+                                          size_t xReceiveLength )
+    {
+        return SOCKETS_Recv( ( Socket_t ) pvCallerContext, pucReceiveBuffer, xReceiveLength, 0 );
+    }
+
+    static BaseType_t prvPlainSocketSend( void * pvCallerContext,
+                                          const unsigned char * pucData,
+                                          size_t xDataLength )
+    {
+        return SOCKETS_Send( ( Socket_t ) pvCallerContext, pucData, xDataLength, 0 );
+    }
+
+/* Connects to the broker over TLS and sends an MQTT CONNECT, so that the broker
+ * answers pings. The context is returned before any assert can fail, so that the
+ * caller always cleans up. */
+    static void prvBufferPoolConnect( Socket_t * pxSocket,
+                                      void ** ppvTLSContext )
+    {
+        const char * pcAWSIoTAddress = clientcredentialMQTT_BROKER_ENDPOINT;
+        size_t xClientIdLength = strlen( clientcredentialIOT_THING_NAME );
+        const unsigned char ucConnAck[] = { 0x20, 0x02, 0x00, 0x00 };
+        unsigned char ucPacket[ 128 ];
+        SocketsSockaddr_t xMQTTServerAddress = { 0 };
+        TLSParams_t xTLSParams = { 0 };
+        size_t xLength = 0;
+        BaseType_t xResult;
+
+        xMQTTServerAddress.ulAddress = SOCKETS_GetHostByName( pcAWSIoTAddress );
+        xMQTTServerAddress.usPort = SOCKETS_htons( clientcredentialMQTT_BROKER_PORT );
+        xMQTTServerAddress.ucSocketDomain = SOCKETS_AF_INET;
+
+        *pxSocket = SOCKETS_Socket( SOCKETS_AF_INET, SOCKETS_SOCK_STREAM, SOCKETS_IPPROTO_TCP );
+        TEST_ASSERT_NOT_EQUAL( SOCKETS_INVALID_SOCKET, *pxSocket );
+
+        xResult = SOCKETS_Connect( *pxSocket, &xMQTTServerAddress, sizeof( xMQTTServerAddress ) );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket connect failed" );
+
+        xTLSParams.ulSize = sizeof( xTLSParams );
+        xTLSParams.pcDestination = pcAWSIoTAddress;
+        xTLSParams.pxNetworkRecv = prvPlainSocketRecv;
+        xTLSParams.pxNetworkSend = prvPlainSocketSend;
+        xTLSParams.pvCallerContext = *pxSocket;
+
+        xResult = TLS_Init( ppvTLSContext, &xTLSParams );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( 0, xResult, "TLS init failed" );
+
+        xResult = TLS_Connect( *ppvTLSContext );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( 0, xResult, "TLS handshake failed" );
+
+        /* The handshake buffers are freed once it completes. */
+        TEST_ASSERT_FALSE( test_TLS_HasBuffers( *ppvTLSContext ) );
+
+        /* MQTT 3.1.1 CONNECT with a clean session, a 60 second keep alive and the thing name as client ID. */
+        TEST_ASSERT_LESS_THAN( sizeof( ucPacket ) - 14U, xClientIdLength );
+        ucPacket[ xLength++ ] = 0x10;
+        ucPacket[ xLength++ ] = ( unsigned char ) ( 12U + xClientIdLength );
+        memcpy( &ucPacket[ xLength ], "\x00\x04MQTT\x04\x02\x00\x3C", 10 );
+        xLength += 10;
+        ucPacket[ xLength++ ] = 0x00;
+        ucPacket[ xLength++ ] = ( unsigned char ) xClientIdLength;
+        memcpy( &ucPacket[ xLength ], clientcredentialIOT_THING_NAME, xClientIdLength );
+        xLength += xClientIdLength;
+
+        xResult = TLS_Send( *ppvTLSContext, ucPacket, xLength );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( xLength, xResult, "Failed to send MQTT CONNECT" );
+
+        xResult = TLS_Recv( *ppvTLSContext, ucPacket, sizeof( ucConnAck ) );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( sizeof( ucConnAck ), xResult, "Failed to receive MQTT CONNACK" );
+        TEST_ASSERT_EQUAL_MEMORY( ucConnAck, ucPacket, sizeof( ucConnAck ) );
+    }
+
+    static void prvBufferPoolDisconnect( Socket_t xSocket,
+                                         void * pvTLSContext )
+    {
+        if( NULL != pvTLSContext )
+        {
+            TLS_Cleanup( pvTLSContext );
+        }
+
+        if( SOCKETS_INVALID_SOCKET != xSocket )
+        {
+            ( void ) SOCKETS_Shutdown( xSocket, SOCKETS_SHUT_RDWR );
+            prvSecureSocketClose( xSocket );
+        }
+    }
+
+/* Exchanges several records and checks that the connection holds no buffers
+ * between them. */
+    TEST( Full_TLS, AFQP_TLS_BufferPoolRecords )
+    {
+        Socket_t xSocket = SOCKETS_INVALID_SOCKET;
+        void * pvTLSContext = NULL;
+        unsigned char ucResponse[ sizeof( ucPingResponse ) ];
+        uint32_t ulRecordsSent = 0;
+        uint32_t ulRecordsReceived = 0;
+        uint32_t ulPing;
+        BaseType_t xResult;
+
+        if( TEST_PROTECT() )
+        {
+            prvBufferPoolConnect( &xSocket, &pvTLSContext );
+            TEST_ASSERT_FALSE( test_TLS_HasBuffers( pvTLSContext ) );
+
+            for( ulPing = 0; ulPing < tlstestBUFFER_POOL_PINGS; ulPing++ )
+            {
+                xResult = TLS_Send( pvTLSContext, ucPingRequest, sizeof( ucPingRequest ) );
+                TEST_ASSERT_EQUAL_INT32( sizeof( ucPingRequest ), xResult );
+                TEST_ASSERT_FALSE( test_TLS_HasBuffers( pvTLSContext ) );
+                TEST_ASSERT_EQUAL( 0, test_TLS_GetBuffersLeased() );
+
+                xResult = TLS_Recv( pvTLSContext, ucResponse, sizeof( ucResponse ) );
+                TEST_ASSERT_EQUAL_INT32( sizeof( ucPingResponse ), xResult );
+                TEST_ASSERT_EQUAL_MEMORY( ucPingResponse, ucResponse, sizeof( ucPingResponse ) );
+                TEST_ASSERT_FALSE( test_TLS_HasBuffers( pvTLSContext ) );
+                TEST_ASSERT_EQUAL( 0, test_TLS_GetBuffersLeased() );
+            }
+
+            /* CONNECT and CONNACK, then one record each way per ping. */
+            TLS_GetRecordCounts( pvTLSContext, &ulRecordsSent, &ulRecordsReceived );
+            TEST_ASSERT_EQUAL_UINT32( 1 + tlstestBUFFER_POOL_PINGS, ulRecordsSent );
+            TEST_ASSERT_EQUAL_UINT32( 1 + tlstestBUFFER_POOL_PINGS, ulRecordsReceived );
+            TEST_ASSERT_GREATER_OR_EQUAL( 1, TLS_GetBufferPoolPeak() );
+        }
+
+        prvBufferPoolDisconnect( xSocket, pvTLSContext );
+    }
+/*-----------------------------------------------------------*/
+
+/* With no buffers to lease, sends and receives make no progress, and the
+ * connection carries on once buffers can be allocated again. */
+    TEST( Full_TLS, AFQP_TLS_BufferPoolAllocationFailure )
+    {
+        Socket_t xSocket = SOCKETS_INVALID_SOCKET;
+        void * pvTLSContext = NULL;
+        unsigned char ucResponse[ sizeof( ucPingResponse ) ];
+        uint32_t ulRecordsSent = 0;
+        uint32_t ulRecordsReceived = 0;
+        BaseType_t xResult;
+
+        if( TEST_PROTECT() )
+        {
+            prvBufferPoolConnect( &xSocket, &pvTLSContext );
+
+            xResult = TLS_Send( pvTLSContext, ucPingRequest, sizeof( ucPingRequest ) );
+            TEST_ASSERT_EQUAL_INT32( sizeof( ucPingRequest ), xResult );
+
+            test_TLS_FailBufferAllocations( pdTRUE );
+
+            /* The response starts to arrive, but cannot be decrypted yet. */
+            xResult = TLS_Recv( pvTLSContext, ucResponse, sizeof( ucResponse ) );
+            TEST_ASSERT_EQUAL_INT32( 0, xResult );
+            TEST_ASSERT_TRUE( test_TLS_HasPeekedByte( pvTLSContext ) );
+            TEST_ASSERT_FALSE( test_TLS_HasBuffers( pvTLSContext ) );
+
+            xResult = TLS_Send( pvTLSContext, ucPingRequest, sizeof( ucPingRequest ) );
+            TEST_ASSERT_EQUAL_INT32( 0, xResult );
+            TEST_ASSERT_FALSE( test_TLS_HasBuffers( pvTLSContext ) );
+
+            TLS_GetRecordCounts( pvTLSContext, &ulRecordsSent, &ulRecordsReceived );
+            TEST_ASSERT_EQUAL_UINT32( 2, ulRecordsSent );
+            TEST_ASSERT_EQUAL_UINT32( 1, ulRecordsReceived );
+
+            test_TLS_FailBufferAllocations( pdFALSE );
+
+            /* The held back response is received, and the connection is still usable. */
+            xResult = TLS_Recv( pvTLSContext, ucResponse, sizeof( ucResponse ) );
+            TEST_ASSERT_EQUAL_INT32( sizeof( ucPingResponse ), xResult );
+            TEST_ASSERT_EQUAL_MEMORY( ucPingResponse, ucResponse, sizeof( ucPingResponse ) );
+
+            xResult = TLS_Send( pvTLSContext, ucPingRequest, sizeof( ucPingRequest ) );
+            TEST_ASSERT_EQUAL_INT32( sizeof( ucPingRequest ), xResult );
+
+            xResult = TLS_Recv( pvTLSContext, ucResponse, sizeof( ucResponse ) );
+            TEST_ASSERT_EQUAL_INT32( sizeof( ucPingResponse ), xResult );
+            TEST_ASSERT_EQUAL_MEMORY( ucPingResponse, ucResponse, sizeof( ucPingResponse ) );
+            TEST_ASSERT_FALSE( test_TLS_HasBuffers( pvTLSContext ) );
+        }
+
+        test_TLS_FailBufferAllocations( pdFALSE );
+        prvBufferPoolDisconnect( xSocket, pvTLSContext );
+    }
+/*-----------------------------------------------------------*/
+#endif /* if ( tlsconfigUSE_BUFFER_POOL == 1 ) */
+
 TEST( Full_TLS, AFQP_TLS_ConnectEC )
 {
     ProvisioningParams_t xParams;
@@ -0,0 +1,46 @@
+/*
+ * FreeRTOS TLS V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tls_test_access_declare.h
+ * @brief Declarations for functions that access private members in iot_tls.c.
+ *
+ * Required to test the record buffer pool in iot_tls.c.
+ */
+
+#ifndef IOT_TLS_TEST_ACCESS_DECLARE_H_
+#define IOT_TLS_TEST_ACCESS_DECLARE_H_
+
+#include "FreeRTOS.h"
+
+BaseType_t test_TLS_HasBuffers( void * pvContext );
+
+BaseType_t test_TLS_HasPeekedByte( void * pvContext );
+
+UBaseType_t test_TLS_GetBuffersLeased( void );
+
+void test_TLS_FailBufferAllocations( BaseType_t xFail );
+
+#endif /* IOT_TLS_TEST_ACCESS_DECLARE_H_ */
@@ -233,6 +233,7 @@ INCLUDES+=\
 
 SOURCES+=\
 	$(wildcard $(CY_AFR_ROOT)/libraries/abstractions/platform/freertos/*c)\
+	$(wildcard $(CY_AFR_ROOT)/libraries/abstractions/secure_sockets/common/*c)\
 	$(wildcard $(CY_AFR_ROOT)/libraries/abstractions/secure_sockets/lwip/*c)\
 	$(wildcard $(CY_AFR_ROOT)/libraries/abstractions/pkcs11/corePKCS11/source/*.c)\
 	$(wildcard $(CY_AFR_ROOT)/libraries/abstractions/pkcs11/corePKCS11/source/*.c)\
@@ -388,6 +389,7 @@ INCLUDES+=\
 	$(CY_AFR_ROOT)/libraries/freertos_plus/standard/freertos_plus_posix/include\
 	$(CY_AFR_ROOT)/libraries/freertos_plus/standard/tls\
 	$(CY_AFR_ROOT)/libraries/freertos_plus/standard/tls/include\
+	$(CY_AFR_ROOT)/libraries/freertos_plus/standard/tls/test\
 	$(CY_AFR_ROOT)/libraries/freertos_plus/standard/utils\
 	$(CY_AFR_ROOT)/libraries/freertos_plus/standard/utils/include
 
@@ -444,6 +446,8 @@ SOURCES+=\
 	$(wildcard $(CY_EXTAPP_PATH)/ota/ports/$(CY_AFR_TARGET)/*.c)\
 	$(CY_AFR_ROOT)/libraries/freertos_plus/aws/ota/src/aws_iot_ota_agent.c\
 	$(CY_AFR_ROOT)/libraries/freertos_plus/aws/ota/src/aws_iot_ota_interface.c\
+	$(CY_AFR_ROOT)/libraries/freertos_plus/aws/ota/src/aws_iot_ota_delta.c\
+	$(CY_AFR_ROOT)/libraries/freertos_plus/aws/ota/src/aws_iot_ota_decompress.c\
 	$(CY_AFR_ROOT)/libraries/freertos_plus/aws/ota/src/http/aws_iot_ota_http.c\
 	$(CY_AFR_ROOT)/libraries/freertos_plus/aws/ota/src/mqtt/aws_iot_ota_mqtt.c\
 	$(CY_AFR_ROOT)/libraries/freertos_plus/aws/ota/src/mqtt/aws_iot_ota_cbor.c\
@@ -458,6 +462,8 @@ SOURCES+=\
 # Test code
 SOURCES+=\
 	$(CY_AFR_ROOT)/libraries/freertos_plus/aws/ota/test/aws_test_ota_agent.c\
+	$(CY_AFR_ROOT)/libraries/freertos_plus/aws/ota/test/aws_test_ota_decompress.c\
+	$(CY_AFR_ROOT)/libraries/freertos_plus/aws/ota/test/aws_test_ota_delta.c\
 	$(CY_AFR_ROOT)/libraries/freertos_plus/aws/ota/test/aws_test_ota_pal.c
 
 INCLUDES+=\
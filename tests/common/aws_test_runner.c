@@ -186,6 +186,10 @@ static void RunTests( void )
         RUN_TEST_GROUP( UTIL_Platform_Threads );
     #endif
 
+    #if ( testrunnerUTIL_PLATFORM_METRICS_ENABLED == 1 )
+        RUN_TEST_GROUP( UTIL_Platform_Metrics );
+    #endif
+
     #if ( testrunnerFULL_BLE_ENABLED == 1 )
         RUN_TEST_GROUP( Full_BLE );
     #endif
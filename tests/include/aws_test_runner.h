@@ -33,6 +33,13 @@
 
 #include "aws_test_runner_config.h"
 
+/*
+ * @brief Test groups that are off unless enabled in aws_test_runner_config.h.
+ */
+#ifndef testrunnerUTIL_PLATFORM_METRICS_ENABLED
+    #define testrunnerUTIL_PLATFORM_METRICS_ENABLED    ( 0 )
+#endif
+
 /*
  * @brief If set to 1, will run DQP_FR tests only.
  */
@@ -0,0 +1,189 @@
+"""
+Convert a trace recorded by vendors/pc/boards/linux/ports/trace into Chrome
+Trace Event JSON, which opens in chrome://tracing and ui.perfetto.dev.
+
+usage: iot_trace_to_json.py trace.bin [-o trace.json]
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = b"IOTTRACE"
+VERSION = 1
+NAME_LENGTH = 24
+RECORD = struct.Struct("<QQQII")
+
+TASK_SWITCHED_IN = 1
+TASK_SWITCHED_OUT = 2
+TASK_CREATE = 3
+TASK_DELETE = 4
+QUEUE_SEND = 5
+QUEUE_RECEIVE = 6
+QUEUE_BLOCK_SEND = 7
+QUEUE_BLOCK_RECEIVE = 8
+JOB_SCHEDULED = 9
+JOB_DEFERRED = 10
+JOB_STARTED = 11
+JOB_FINISHED = 12
+JOB_CANCELED = 13
+NAME = 14
+
+# Process ids of the two groups of tracks in the output.
+TASKS_PID = 1
+THREADS_PID = 2
+
+
+def read_records(data):
+    """Return (names, events), each a list of (timestamp, object, arg, thread, type[, name])."""
+    if data[:len(MAGIC)] != MAGIC:
+        raise ValueError("not a trace file")
+
+    offset = len(MAGIC)
+    version, record_size = struct.unpack_from("<II", data, offset)
+    offset += 8
+
+    if version != VERSION or record_size != RECORD.size:
+        raise ValueError("unsupported trace version %u" % version)
+
+    names = []
+    events = []
+
+    while offset + RECORD.size <= len(data):
+        record = RECORD.unpack_from(data, offset)
+        offset += RECORD.size
+
+        if record[4] == NAME:
+            raw = data[offset:offset + NAME_LENGTH]
+            offset += NAME_LENGTH
+            names.append(record + (raw.split(b"\0", 1)[0].decode("utf-8", "replace"),))
+        else:
+            events.append(record)
+
+    return names, events
+
+
+def convert(names, events):
+    # Writer threads drain buffers one at a time, so merge them by timestamp.
+    names.sort(key=lambda record: record[0])
+    events.sort(key=lambda record: record[0])
+
+    if not events:
+        return {"traceEvents": []}
+
+    base = events[0][0]
+    out = []
+    object_names = {}
+    task_tids = {}
+    running = {}
+    job_state = {}
+    name_index = 0
+
+    def us(timestamp):
+        return (timestamp - base) / 1000.0
+
+    def name_of(obj):
+        return object_names.get(obj, "0x%x" % obj)
+
+    def task_tid(tcb):
+        if tcb not in task_tids:
+            task_tids[tcb] = len(task_tids) + 1
+        return task_tids[tcb]
+
+    def end_job_wait(ts, job, thread):
+        state = job_state.pop(job, None)
+
+        if state is not None:
+            out.append({"ph": "e", "cat": "job", "name": state, "id": hex(job),
+                        "ts": us(ts), "pid": THREADS_PID, "tid": thread})
+
+    for ts, obj, arg, thread, kind in events:
+        # Apply names recorded up to this point, a TCB or queue address may be reused.
+        while name_index < len(names) and names[name_index][0] <= ts:
+            object_names[names[name_index][1]] = names[name_index][5]
+            name_index += 1
+
+        if kind == TASK_SWITCHED_IN:
+            running.setdefault(obj, ts)
+        elif kind in (TASK_SWITCHED_OUT, TASK_DELETE):
+            start = running.pop(obj, None)
+
+            if start is not None:
+                out.append({"ph": "X", "name": name_of(obj), "cat": "task",
+                            "ts": us(start), "dur": us(ts) - us(start),
+                            "pid": TASKS_PID, "tid": task_tid(obj)})
+        elif kind == TASK_CREATE:
+            task_tid(obj)
+        elif kind in (QUEUE_SEND, QUEUE_RECEIVE):
+            send = kind == QUEUE_SEND
+            out.append({"ph": "i", "s": "t", "cat": "queue",
+                        "name": ("send " if send else "receive ") + name_of(obj),
+                        "ts": us(ts), "pid": THREADS_PID, "tid": thread})
+            out.append({"ph": "C", "name": "queue " + name_of(obj), "ts": us(ts),
+                        "pid": THREADS_PID,
+                        "args": {"waiting": arg + 1 if send else max(arg - 1, 0)}})
+        elif kind in (QUEUE_BLOCK_SEND, QUEUE_BLOCK_RECEIVE):
+            out.append({"ph": "i", "s": "t", "cat": "queue",
+                        "name": ("block on send " if kind == QUEUE_BLOCK_SEND else "block on receive ") + name_of(obj),
+                        "ts": us(ts), "pid": THREADS_PID, "tid": thread})
+        elif kind in (JOB_SCHEDULED, JOB_DEFERRED):
+            # A deferred job is scheduled again when its timer expires.
+            end_job_wait(ts, obj, thread)
+            state = "job queued" if kind == JOB_SCHEDULED else "job deferred"
+            job_state[obj] = state
+            out.append({"ph": "b", "cat": "job", "name": state, "id": hex(obj),
+                        "ts": us(ts), "pid": THREADS_PID, "tid": thread,
+                        "args": {"delay_ms": arg} if kind == JOB_DEFERRED else {}})
+        elif kind == JOB_STARTED:
+            end_job_wait(ts, obj, thread)
+            out.append({"ph": "B", "cat": "job", "name": "job 0x%x" % arg,
+                        "ts": us(ts), "pid": THREADS_PID, "tid": thread,
+                        "args": {"job": hex(obj), "callback": hex(arg)}})
+        elif kind == JOB_FINISHED:
+            out.append({"ph": "E", "cat": "job", "ts": us(ts),
+                        "pid": THREADS_PID, "tid": thread})
+        elif kind == JOB_CANCELED:
+            end_job_wait(ts, obj, thread)
+            out.append({"ph": "i", "s": "t", "cat": "job", "name": "job canceled",
+                        "ts": us(ts), "pid": THREADS_PID, "tid": thread,
+                        "args": {"job": hex(obj)}})
+
+    # Tasks still running when tracing stopped.
+    for tcb, start in running.items():
+        out.append({"ph": "X", "name": name_of(tcb), "cat": "task", "ts": us(start),
+                    "dur": us(events[-1][0]) - us(start), "pid": TASKS_PID, "tid": task_tid(tcb)})
+
+    for name in names[name_index:]:
+        object_names[name[1]] = name[5]
+
+    meta = [{"ph": "M", "name": "process_name", "pid": TASKS_PID, "args": {"name": "FreeRTOS tasks"}},
+            {"ph": "M", "name": "process_name", "pid": THREADS_PID, "args": {"name": "Linux threads"}}]
+
+    for tcb, tid in task_tids.items():
+        meta.append({"ph": "M", "name": "thread_name", "pid": TASKS_PID, "tid": tid,
+                     "args": {"name": name_of(tcb)}})
+
+    return {"traceEvents": meta + out, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("trace", help="binary trace written by IotTraceLinux_Start()")
+    parser.add_argument("-o", "--output", help="JSON file to write, standard output by default")
+    args = parser.parse_args()
+
+    with open(args.trace, "rb") as trace:
+        names, events = read_records(trace.read())
+
+    result = convert(names, events)
+
+    if args.output:
+        with open(args.output, "w") as output:
+            json.dump(result, output)
+    else:
+        json.dump(result, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,93 @@
+#!/usr/bin/python
+
+import json
+import os
+import struct
+import subprocess
+import sys
+my_path = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.dirname(my_path))
+
+import pytest
+
+import iot_trace_to_json
+
+
+def record(timestamp, obj, arg, thread, kind):
+    return iot_trace_to_json.RECORD.pack(timestamp, obj, arg, thread, kind)
+
+
+def name(timestamp, obj, thread, text):
+    raw = text.encode("utf-8")
+    return (record(timestamp, obj, 0, thread, iot_trace_to_json.NAME) +
+            raw + b"\0" * (iot_trace_to_json.NAME_LENGTH - len(raw)))
+
+
+def header(version=iot_trace_to_json.VERSION):
+    return iot_trace_to_json.MAGIC + struct.pack("<II", version, iot_trace_to_json.RECORD.size)
+
+
+# A task that runs once and sends to a queue on thread 7, then a task pool job
+# on thread 8. The writer drains thread 8's buffer first, as it may.
+FIXTURE_TRACE = (header() +
+                 name(100, 0x1000, 7, "Task A") +
+                 name(200, 0x2000, 7, "Q") +
+                 record(3500, 0x3000, 0, 8, iot_trace_to_json.JOB_SCHEDULED) +
+                 record(4000, 0x3000, 0x4000, 8, iot_trace_to_json.JOB_STARTED) +
+                 record(4500, 0x3000, 0, 8, iot_trace_to_json.JOB_FINISHED) +
+                 record(1000, 0x1000, 0, 7, iot_trace_to_json.TASK_CREATE) +
+                 record(2000, 0x1000, 0, 7, iot_trace_to_json.TASK_SWITCHED_IN) +
+                 record(2500, 0x2000, 0, 7, iot_trace_to_json.QUEUE_SEND) +
+                 record(3000, 0x1000, 0, 7, iot_trace_to_json.TASK_SWITCHED_OUT))
+
+FIXTURE_JSON = {
+    "displayTimeUnit": "ns",
+    "traceEvents": [
+        {"ph": "M", "name": "process_name", "pid": 1, "args": {"name": "FreeRTOS tasks"}},
+        {"ph": "M", "name": "process_name", "pid": 2, "args": {"name": "Linux threads"}},
+        {"ph": "M", "name": "thread_name", "pid": 1, "tid": 1, "args": {"name": "Task A"}},
+        {"ph": "i", "s": "t", "cat": "queue", "name": "send Q", "ts": 1.5, "pid": 2, "tid": 7},
+        {"ph": "C", "name": "queue Q", "ts": 1.5, "pid": 2, "args": {"waiting": 1}},
+        {"ph": "X", "name": "Task A", "cat": "task", "ts": 1.0, "dur": 1.0, "pid": 1, "tid": 1},
+        {"ph": "b", "cat": "job", "name": "job queued", "id": "0x3000", "ts": 2.5,
+         "pid": 2, "tid": 8, "args": {}},
+        {"ph": "e", "cat": "job", "name": "job queued", "id": "0x3000", "ts": 3.0,
+         "pid": 2, "tid": 8},
+        {"ph": "B", "cat": "job", "name": "job 0x4000", "ts": 3.0, "pid": 2, "tid": 8,
+         "args": {"job": "0x3000", "callback": "0x4000"}},
+        {"ph": "E", "cat": "job", "ts": 3.5, "pid": 2, "tid": 8},
+    ],
+}
+
+
+def test_convert_fixture(tmp_path):
+    trace = tmp_path / "trace.bin"
+    output = tmp_path / "trace.json"
+    trace.write_bytes(FIXTURE_TRACE)
+
+    subprocess.check_call([sys.executable,
+                           os.path.join(os.path.dirname(my_path), "iot_trace_to_json.py"),
+                           str(trace), "-o", str(output)])
+
+    assert FIXTURE_JSON == json.loads(output.read_text())
+
+
+def test_read_records_names():
+    names, events = iot_trace_to_json.read_records(FIXTURE_TRACE)
+
+    assert ["Task A", "Q"] == [record[5] for record in names]
+    assert 7 == len(events)
+
+
+def test_convert_empty():
+    assert {"traceEvents": []} == iot_trace_to_json.convert(*iot_trace_to_json.read_records(header()))
+
+
+bad_trace_params = [
+    b"NOTTRACE" + struct.pack("<II", iot_trace_to_json.VERSION, iot_trace_to_json.RECORD.size),
+    header(version=iot_trace_to_json.VERSION + 1),
+]
+@pytest.mark.parametrize("data", bad_trace_params)
+def test_read_records_rejects(data):
+    with pytest.raises(ValueError):
+        iot_trace_to_json.read_records(data)
@@ -63,6 +63,7 @@
 #define testrunnerFULL_SERIALIZER_ENABLED             0
 #define testrunnerUTIL_PLATFORM_CLOCK_ENABLED         0
 #define testrunnerUTIL_PLATFORM_THREADS_ENABLED       0
+#define testrunnerUTIL_PLATFORM_METRICS_ENABLED       0
 #define testrunnerFULL_DEVICE_SHADOW_ENABLED          0
 
 /* On systems using FreeRTOS+TCP (such as this one) the TCP segments must be
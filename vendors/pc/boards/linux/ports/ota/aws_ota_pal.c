@@ -0,0 +1,1008 @@
+/*
+ * FreeRTOS OTA PAL for Linux V1.0.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/* OTA PAL implementation for Linux hosts.
+ *
+ * The receive file is preallocated to its final size when it is created and mapped
+ * into memory, so each block is a copy into the mapping and the signature is checked
+ * over the mapped image without reading the file back. Data is flushed to storage with
+ * fdatasync() once every OTA_PAL_LINUX_SYNC_BYTES bytes rather than once per block,
+ * and a final time before the signature check.
+ *
+ * The mapped image pointer is kept in C->pucFile, which the OTA agent uses to tell
+ * whether the file is open. The descriptor and size live in xRxFile since the agent
+ * only receives one file at a time (OTA_MAX_FILES).
+ *
+ * prvPAL_SaveCheckpoint() and prvPAL_ResumeFileForRx() may be registered as the
+ * optional checkpoint callbacks. The checkpoint is a small file next to
+ * PlatformImageState.txt holding the job name, file ID, size and block bitmap. It is
+ * replaced atomically with rename() after the image has been flushed.
+ *
+ * prvPAL_ReadBaseImage() may be registered to accept delta updates. The running image
+ * is this process's executable, read through /proc/self/exe. Compressed files are created
+ * at their uncompressed size, so OTA_PAL_Callbacks_t::bAcceptCompressedFiles may be set. */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "FreeRTOS.h"
+#include "iot_crypto.h"
+#include "aws_iot_ota_pal.h"
+#include "aws_iot_ota_agent_internal.h"
+#include "aws_ota_codesigner_certificate.h"
+
+/* Specify the OTA signature algorithm we support on this platform. */
+const char cOTA_JSON_FileSignatureKey[ OTA_FILE_SIG_KEY_STR_MAX_LENGTH ] = "sig-sha256-ecdsa";
+
+static OTA_Err_t prvPAL_CheckFileSignature( OTA_FileContext_t * const C );
+static uint8_t * prvPAL_ReadAndAssumeCertificate( const uint8_t * const pucCertName,
+                                                  uint32_t * const ulSignerCertSize );
+static int32_t prvPAL_UnmapAndClose( void );
+static size_t prvPAL_ImageSize( const OTA_FileContext_t * C );
+static int32_t prvPAL_MapRxFile( OTA_FileContext_t * const C );
+static int32_t prvPAL_WriteCheckpoint( OTA_FileContext_t * const C,
+                                       uint32_t ulBitmapLen );
+
+/*-----------------------------------------------------------*/
+
+/* Used to set the high bit of Linux error codes for a negative return value. */
+#define OTA_PAL_INT16_NEGATIVE_MASK    ( 1 << 15 )
+
+/* Number of bytes written to the receive file between calls to fdatasync(). A larger
+ * value means fewer flushes, at the cost of more data to receive again if the device
+ * loses power during a transfer. */
+#ifndef OTA_PAL_LINUX_SYNC_BYTES
+    #define OTA_PAL_LINUX_SYNC_BYTES    ( ( size_t ) ( 4UL * 1024UL * 1024UL ) )
+#endif
+
+/* State of the open receive file. */
+typedef struct
+{
+    int iFd;                  /* Descriptor of the receive file, or -1 if none is open. */
+    uint8_t * pucImage;       /* Shared mapping of the whole receive file. */
+    size_t xImageSize;        /* Size of the receive file and the mapping, in bytes. */
+    size_t xBytesSinceSync;   /* Bytes written to the mapping since the last fdatasync(). */
+    int iBaseFd;              /* Descriptor of the running image for a delta update, or -1. */
+} OTA_PAL_LinuxFile_t;
+
+static OTA_PAL_LinuxFile_t xRxFile = { -1, NULL, 0, 0, -1 };
+
+/* Download checkpoint files, in the current working directory like PlatformImageState.txt. */
+#define OTA_PAL_LINUX_CHECKPOINT_FILE     "OTACheckpoint.bin"
+#define OTA_PAL_LINUX_CHECKPOINT_TEMP     "OTACheckpoint.bin.tmp"
+#define OTA_PAL_LINUX_CHECKPOINT_MAGIC    0x4f544143UL /* "OTAC" */
+#define OTA_PAL_LINUX_MAX_JOB_NAME_LEN    256U         /* Sanity limit for a job name read back from a checkpoint. */
+
+/* Checkpoint file header. It is followed by the job name (not terminated) and the block bitmap. */
+typedef struct
+{
+    uint32_t ulMagic;        /* OTA_PAL_LINUX_CHECKPOINT_MAGIC. */
+    uint32_t ulServerFileID; /* File ID of the file being received. */
+    uint32_t ulFileSize;     /* Size of the file being received, in bytes. */
+    uint32_t ulBitmapLen;    /* Length of the block bitmap, in bytes. */
+    uint32_t ulJobNameLen;   /* Length of the job name, in bytes. */
+} OTA_PAL_LinuxCheckpoint_t;
+
+/*-----------------------------------------------------------*/
+
+static inline BaseType_t prvContextValidate( OTA_FileContext_t * C )
+{
+    return( ( C != NULL ) &&
+            ( C->pucFile != NULL ) &&
+            ( C->pucFile == xRxFile.pucImage ) );
+}
+
+/* Unmap and close the receive file, if open. Returns 0 or the first errno seen. */
+
+static int32_t prvPAL_UnmapAndClose( void )
+{
+    int32_t lError = 0;
+
+    if( xRxFile.pucImage != NULL )
+    {
+        if( munmap( xRxFile.pucImage, xRxFile.xImageSize ) != 0 )
+        {
+            lError = errno;
+        }
+
+        xRxFile.pucImage = NULL;
+    }
+
+    if( xRxFile.iFd >= 0 )
+    {
+        if( ( close( xRxFile.iFd ) != 0 ) && ( lError == 0 ) )
+        {
+            lError = errno;
+        }
+
+        xRxFile.iFd = -1;
+    }
+
+    if( xRxFile.iBaseFd >= 0 )
+    {
+        ( void ) close( xRxFile.iBaseFd );
+        xRxFile.iBaseFd = -1;
+    }
+
+    xRxFile.xImageSize = 0;
+    xRxFile.xBytesSinceSync = 0;
+
+    return lError;
+}
+
+/* Size of the file being stored. For a delta update that is the rebuilt image, not the patch,
+ * and for a compressed file it is the decompressed size. */
+
+static size_t prvPAL_ImageSize( const OTA_FileContext_t * C )
+{
+    size_t xSize = ( size_t ) C->ulFileSize;
+
+    if( C->ulDeltaImageSize != 0U )
+    {
+        xSize = ( size_t ) C->ulDeltaImageSize;
+    }
+    else if( C->pucCompression != NULL )
+    {
+        xSize = ( size_t ) C->ulUncompressedSize;
+    }
+
+    return xSize;
+}
+
+/* Map the whole receive file open in xRxFile.iFd. Returns 0 or errno. */
+
+static int32_t prvPAL_MapRxFile( OTA_FileContext_t * const C )
+{
+    int32_t lError = 0;
+    size_t xSize = prvPAL_ImageSize( C );
+    void * pvImage;
+
+    pvImage = mmap( NULL, xSize, PROT_READ | PROT_WRITE, MAP_SHARED, xRxFile.iFd, 0 );
+
+    if( pvImage == MAP_FAILED )
+    {
+        lError = errno;
+    }
+    else
+    {
+        /* Blocks are requested in ascending order, so let the kernel write back behind us. */
+        ( void ) madvise( pvImage, xSize, MADV_SEQUENTIAL );
+
+        xRxFile.pucImage = ( uint8_t * ) pvImage;
+        xRxFile.xImageSize = xSize;
+        xRxFile.xBytesSinceSync = 0;
+        C->pucFile = xRxFile.pucImage;
+    }
+
+    return lError;
+}
+
+/* Attempt to create a new receive file for the file chunks as they come in. */
+
+OTA_Err_t prvPAL_CreateFileForRx( OTA_FileContext_t * const C )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_CreateFileForRx" );
+
+    OTA_Err_t eResult = kOTA_Err_Uninitialized; /* For MISRA mandatory. */
+    int32_t lError = 0;
+
+    if( ( C != NULL ) && ( C->pucFilePath != NULL ) && ( C->ulFileSize > 0U ) )
+    {
+        /* Only one file is received at a time. Drop anything left over from an earlier transfer. */
+        ( void ) prvPAL_UnmapAndClose();
+
+        xRxFile.iFd = open( ( const char * ) C->pucFilePath, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+
+        if( xRxFile.iFd < 0 )
+        {
+            lError = errno;
+        }
+        else
+        {
+            /* Reserve the blocks for the whole image now, so a full disk is reported here
+             * rather than as a fault part way through the transfer. */
+            lError = posix_fallocate( xRxFile.iFd, 0, ( off_t ) prvPAL_ImageSize( C ) );
+        }
+
+        if( lError == 0 )
+        {
+            lError = prvPAL_MapRxFile( C );
+        }
+
+        if( lError == 0 )
+        {
+            /* Any checkpoint left behind belongs to a transfer that is not being resumed. */
+            ( void ) unlink( OTA_PAL_LINUX_CHECKPOINT_FILE );
+
+            eResult = kOTA_Err_None;
+            OTA_LOG_L1( "[%s] Receive file created.\r\n", OTA_METHOD_NAME );
+        }
+        else
+        {
+            ( void ) prvPAL_UnmapAndClose();
+            eResult = ( kOTA_Err_RxFileCreateFailed | ( lError & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                       * Errno is being used in accordance with host API documentation.
+                                                                                       * Bitmasking is being used to preserve host API error with library status code. */
+            OTA_LOG_L1( "[%s] ERROR - Failed to create receive file: %s\r\n", OTA_METHOD_NAME, strerror( lError ) );
+        }
+    }
+    else
+    {
+        eResult = kOTA_Err_RxFileCreateFailed;
+        OTA_LOG_L1( "[%s] ERROR - Invalid context provided.\r\n", OTA_METHOD_NAME );
+    }
+
+    return eResult;
+}
+
+
+/* Abort receiving the specified OTA update by closing the file. */
+
+OTA_Err_t prvPAL_Abort( OTA_FileContext_t * const C )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_Abort" );
+
+    /* Set default return status to uninitialized. */
+    OTA_Err_t eResult = kOTA_Err_Uninitialized;
+    int32_t lError;
+
+    if( NULL != C )
+    {
+        /* Close the OTA update file if it's open. */
+        if( NULL != C->pucFile )
+        {
+            lError = prvPAL_UnmapAndClose();
+            C->pucFile = NULL;
+
+            if( 0 == lError )
+            {
+                OTA_LOG_L1( "[%s] OK\r\n", OTA_METHOD_NAME );
+                eResult = kOTA_Err_None;
+            }
+            else /* Failed to close file. */
+            {
+                OTA_LOG_L1( "[%s] ERROR - Closing file failed.\r\n", OTA_METHOD_NAME );
+                eResult = ( kOTA_Err_FileAbort | ( lError & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                   * Errno is being used in accordance with host API documentation.
+                                                                                   * Bitmasking is being used to preserve host API error with library status code. */
+            }
+        }
+        else
+        {
+            /* Nothing to do. No open file associated with this context. */
+            eResult = kOTA_Err_None;
+        }
+    }
+    else /* Context was not valid. */
+    {
+        OTA_LOG_L1( "[%s] ERROR - Invalid context.\r\n", OTA_METHOD_NAME );
+        eResult = kOTA_Err_FileAbort;
+    }
+
+    return eResult;
+}
+
+/* Write a block of data to the specified file. */
+int16_t prvPAL_WriteBlock( OTA_FileContext_t * const C,
+                           uint32_t ulOffset,
+                           uint8_t * const pacData,
+                           uint32_t ulBlockSize )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_WriteBlock" );
+
+    int32_t lResult = 0;
+
+    if( prvContextValidate( C ) == pdTRUE )
+    {
+        if( ( ( size_t ) ulOffset <= xRxFile.xImageSize ) &&
+            ( ( size_t ) ulBlockSize <= ( xRxFile.xImageSize - ( size_t ) ulOffset ) ) )
+        {
+            ( void ) memcpy( &xRxFile.pucImage[ ulOffset ], pacData, ulBlockSize );
+            lResult = ( int32_t ) ulBlockSize;
+
+            xRxFile.xBytesSinceSync += ulBlockSize;
+
+            if( xRxFile.xBytesSinceSync >= OTA_PAL_LINUX_SYNC_BYTES )
+            {
+                xRxFile.xBytesSinceSync = 0;
+
+                if( fdatasync( xRxFile.iFd ) != 0 )
+                {
+                    OTA_LOG_L1( "[%s] ERROR - fdatasync failed\r\n", OTA_METHOD_NAME );
+                    /* Mask to return a negative value. */
+                    lResult = OTA_PAL_INT16_NEGATIVE_MASK | errno; /*lint !e40 !e9027
+                                                                    * Errno is being used in accordance with host API documentation.
+                                                                    * Bitmasking is being used to preserve host API error with library status code. */
+                }
+            }
+        }
+        else
+        {
+            OTA_LOG_L1( "[%s] ERROR - Block at offset %u is outside the file\r\n", OTA_METHOD_NAME, ulOffset );
+            /* Mask to return a negative value. */
+            lResult = OTA_PAL_INT16_NEGATIVE_MASK | EINVAL;
+        }
+    }
+    else /* Invalid context or file pointer provided. */
+    {
+        OTA_LOG_L1( "[%s] ERROR - Invalid context.\r\n", OTA_METHOD_NAME );
+        /* No receive file is open for this context. Mask to return a negative value. */
+        lResult = OTA_PAL_INT16_NEGATIVE_MASK | EBADF;
+    }
+
+    return ( int16_t ) lResult;
+}
+
+/* Write the checkpoint to a temporary file and move it over the previous one, so a crash
+ * part way through leaves the last complete checkpoint in place. Returns 0 or errno. */
+
+static int32_t prvPAL_WriteCheckpoint( OTA_FileContext_t * const C,
+                                       uint32_t ulBitmapLen )
+{
+    int32_t lError = 0;
+    int iFd;
+    ssize_t xWritten;
+    size_t xTotal;
+    OTA_PAL_LinuxCheckpoint_t xHeader;
+    struct iovec xIov[ 3 ];
+
+    xHeader.ulMagic = OTA_PAL_LINUX_CHECKPOINT_MAGIC;
+    xHeader.ulServerFileID = C->ulServerFileID;
+    xHeader.ulFileSize = C->ulFileSize;
+    xHeader.ulBitmapLen = ulBitmapLen;
+    xHeader.ulJobNameLen = ( uint32_t ) strlen( ( const char * ) C->pucJobName );
+
+    xIov[ 0 ].iov_base = &xHeader;
+    xIov[ 0 ].iov_len = sizeof( xHeader );
+    xIov[ 1 ].iov_base = C->pucJobName;
+    xIov[ 1 ].iov_len = xHeader.ulJobNameLen;
+    xIov[ 2 ].iov_base = C->pucRxBlockBitmap;
+    xIov[ 2 ].iov_len = ulBitmapLen;
+    xTotal = xIov[ 0 ].iov_len + xIov[ 1 ].iov_len + xIov[ 2 ].iov_len;
+
+    iFd = open( OTA_PAL_LINUX_CHECKPOINT_TEMP, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+
+    if( iFd < 0 )
+    {
+        lError = errno;
+    }
+    else
+    {
+        xWritten = writev( iFd, xIov, 3 );
+
+        if( xWritten < 0 )
+        {
+            lError = errno;
+        }
+        else if( ( size_t ) xWritten != xTotal )
+        {
+            lError = EIO;
+        }
+        else if( fdatasync( iFd ) != 0 )
+        {
+            lError = errno;
+        }
+
+        if( ( close( iFd ) != 0 ) && ( lError == 0 ) )
+        {
+            lError = errno;
+        }
+
+        if( lError == 0 )
+        {
+            if( rename( OTA_PAL_LINUX_CHECKPOINT_TEMP, OTA_PAL_LINUX_CHECKPOINT_FILE ) != 0 )
+            {
+                lError = errno;
+            }
+        }
+        else
+        {
+            ( void ) unlink( OTA_PAL_LINUX_CHECKPOINT_TEMP );
+        }
+    }
+
+    return lError;
+}
+
+/* Persist the download progress so the transfer can resume after a restart. */
+
+OTA_Err_t prvPAL_SaveCheckpoint( OTA_FileContext_t * const C,
+                                 uint32_t ulBitmapLen )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_SaveCheckpoint" );
+
+    OTA_Err_t eResult = kOTA_Err_None;
+    int32_t lError;
+
+    if( ( prvContextValidate( C ) == pdTRUE ) && ( C->pucJobName != NULL ) && ( C->pucRxBlockBitmap != NULL ) )
+    {
+        /* Every block the bitmap marks as received must be on disk before the bitmap is. */
+        if( fdatasync( xRxFile.iFd ) != 0 )
+        {
+            lError = errno;
+        }
+        else
+        {
+            xRxFile.xBytesSinceSync = 0;
+            lError = prvPAL_WriteCheckpoint( C, ulBitmapLen );
+        }
+
+        if( lError != 0 )
+        {
+            OTA_LOG_L1( "[%s] ERROR - Failed to save checkpoint: %s\r\n", OTA_METHOD_NAME, strerror( lError ) );
+            eResult = ( kOTA_Err_CheckpointFailed | ( lError & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                      * Errno is being used in accordance with host API documentation.
+                                                                                      * Bitmasking is being used to preserve host API error with library status code. */
+        }
+    }
+    else
+    {
+        OTA_LOG_L1( "[%s] ERROR - Invalid context.\r\n", OTA_METHOD_NAME );
+        eResult = kOTA_Err_CheckpointFailed;
+    }
+
+    return eResult;
+}
+
+/* Reopen the receive file of an interrupted transfer of the same job and file, if one was checkpointed. */
+
+OTA_Err_t prvPAL_ResumeFileForRx( OTA_FileContext_t * const C,
+                                  uint32_t ulBitmapLen )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_ResumeFileForRx" );
+
+    OTA_Err_t eResult = kOTA_Err_CheckpointFailed;
+    OTA_PAL_LinuxCheckpoint_t xHeader;
+    uint8_t * pucSaved = NULL; /* Saved job name followed by the saved bitmap. */
+    size_t xSavedLen = 0;
+    struct stat xStat;
+    int32_t lError = 0;
+    int iFd;
+
+    if( ( C == NULL ) || ( C->pucFilePath == NULL ) || ( C->pucJobName == NULL ) || ( C->ulFileSize == 0U ) )
+    {
+        lError = EINVAL;
+    }
+    else
+    {
+        iFd = open( OTA_PAL_LINUX_CHECKPOINT_FILE, O_RDONLY | O_CLOEXEC );
+
+        if( iFd < 0 )
+        {
+            lError = errno; /* ENOENT is the usual case of nothing to resume. */
+        }
+        else
+        {
+            if( ( read( iFd, &xHeader, sizeof( xHeader ) ) != ( ssize_t ) sizeof( xHeader ) ) ||
+                ( xHeader.ulMagic != OTA_PAL_LINUX_CHECKPOINT_MAGIC ) ||
+                ( xHeader.ulServerFileID != C->ulServerFileID ) ||
+                ( xHeader.ulFileSize != C->ulFileSize ) ||
+                ( xHeader.ulBitmapLen != ulBitmapLen ) ||
+                ( xHeader.ulJobNameLen != ( uint32_t ) strlen( ( const char * ) C->pucJobName ) ) ||
+                ( xHeader.ulJobNameLen > OTA_PAL_LINUX_MAX_JOB_NAME_LEN ) )
+            {
+                lError = ESTALE;
+            }
+            else
+            {
+                xSavedLen = ( size_t ) xHeader.ulJobNameLen + ( size_t ) ulBitmapLen;
+                pucSaved = pvPortMalloc( xSavedLen );
+
+                if( pucSaved == NULL )
+                {
+                    lError = ENOMEM;
+                }
+                else if( ( read( iFd, pucSaved, xSavedLen ) != ( ssize_t ) xSavedLen ) ||
+                         ( memcmp( pucSaved, C->pucJobName, xHeader.ulJobNameLen ) != 0 ) )
+                {
+                    lError = ESTALE;
+                }
+            }
+
+            ( void ) close( iFd );
+        }
+    }
+
+    if( lError == 0 )
+    {
+        ( void ) prvPAL_UnmapAndClose();
+
+        /* Open without O_TRUNC, the blocks received before the interruption are still needed. */
+        xRxFile.iFd = open( ( const char * ) C->pucFilePath, O_RDWR | O_CLOEXEC );
+
+        if( xRxFile.iFd < 0 )
+        {
+            lError = errno;
+        }
+        else if( fstat( xRxFile.iFd, &xStat ) != 0 )
+        {
+            lError = errno;
+        }
+        else if( xStat.st_size != ( off_t ) C->ulFileSize )
+        {
+            lError = ESTALE;
+        }
+        else
+        {
+            lError = prvPAL_MapRxFile( C );
+        }
+
+        if( lError == 0 )
+        {
+            ( void ) memcpy( C->pucRxBlockBitmap, &pucSaved[ xHeader.ulJobNameLen ], ulBitmapLen );
+            eResult = kOTA_Err_None;
+            OTA_LOG_L1( "[%s] Receive file reopened from checkpoint.\r\n", OTA_METHOD_NAME );
+        }
+        else
+        {
+            ( void ) prvPAL_UnmapAndClose();
+        }
+    }
+
+    if( lError != 0 )
+    {
+        OTA_LOG_L1( "[%s] No checkpoint to resume from: %s\r\n", OTA_METHOD_NAME, strerror( lError ) );
+        eResult = ( kOTA_Err_CheckpointFailed | ( lError & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                  * Errno is being used in accordance with host API documentation.
+                                                                                  * Bitmasking is being used to preserve host API error with library status code. */
+    }
+
+    if( pucSaved != NULL )
+    {
+        vPortFree( pucSaved );
+    }
+
+    return eResult;
+}
+
+/* Read the running image, which a delta update's patch is applied against. */
+
+int32_t prvPAL_ReadBaseImage( uint32_t ulOffset,
+                              uint8_t * pucBuffer,
+                              uint32_t ulLength )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_ReadBaseImage" );
+
+    int32_t lResult = 0;
+    ssize_t xRead;
+
+    if( xRxFile.iBaseFd < 0 )
+    {
+        xRxFile.iBaseFd = open( "/proc/self/exe", O_RDONLY | O_CLOEXEC );
+    }
+
+    if( xRxFile.iBaseFd < 0 )
+    {
+        OTA_LOG_L1( "[%s] ERROR - Unable to open the running image: %s\r\n", OTA_METHOD_NAME, strerror( errno ) );
+        lResult = -1;
+    }
+
+    /* pread() may return less than asked for, so keep going until the end of the image. */
+    while( ( lResult >= 0 ) && ( ( uint32_t ) lResult < ulLength ) )
+    {
+        xRead = pread( xRxFile.iBaseFd, &pucBuffer[ lResult ], ( size_t ) ( ulLength - ( uint32_t ) lResult ), ( off_t ) ulOffset + lResult );
+
+        if( xRead < 0 )
+        {
+            lResult = ( errno == EINTR ) ? lResult : -1;
+        }
+        else if( xRead == 0 )
+        {
+            break;
+        }
+        else
+        {
+            lResult += ( int32_t ) xRead;
+        }
+    }
+
+    return lResult;
+}
+
+/* Close the specified file. This shall authenticate the file if it is marked as secure. */
+
+OTA_Err_t prvPAL_CloseFile( OTA_FileContext_t * const C )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_CloseFile" );
+
+    OTA_Err_t eResult = kOTA_Err_None;
+    int32_t lError = 0;
+    int32_t lCloseError;
+
+    if( prvContextValidate( C ) == pdTRUE )
+    {
+        /* Flush what is left before judging the image, so a good signature means a good file. */
+        if( fdatasync( xRxFile.iFd ) != 0 )
+        {
+            lError = errno;
+        }
+
+        if( C->pxSignature != NULL )
+        {
+            /* Verify the file signature, close the file and return the signature verification result. */
+            eResult = prvPAL_CheckFileSignature( C );
+        }
+        else
+        {
+            OTA_LOG_L1( "[%s] ERROR - NULL OTA Signature structure.\r\n", OTA_METHOD_NAME );
+            eResult = kOTA_Err_SignatureCheckFailed;
+        }
+
+        /* Close the file. */
+        lCloseError = prvPAL_UnmapAndClose();
+
+        if( ( lError != 0 ) || ( lCloseError != 0 ) )
+        {
+            lError = ( lError != 0 ) ? lError : lCloseError;
+            OTA_LOG_L1( "[%s] ERROR - Failed to close OTA update file.\r\n", OTA_METHOD_NAME );
+            eResult = ( kOTA_Err_FileClose | ( lError & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                               * Errno is being used in accordance with host API documentation.
+                                                                               * Bitmasking is being used to preserve host API error with library status code. */
+        }
+
+        C->pucFile = NULL;
+
+        /* The transfer is over either way, there is nothing left to resume. */
+        ( void ) unlink( OTA_PAL_LINUX_CHECKPOINT_FILE );
+
+        if( eResult == kOTA_Err_None )
+        {
+            OTA_LOG_L1( "[%s] %s signature verification passed.\r\n", OTA_METHOD_NAME, cOTA_JSON_FileSignatureKey );
+        }
+        else
+        {
+            OTA_LOG_L1( "[%s] ERROR - Failed to pass %s signature verification: %d.\r\n", OTA_METHOD_NAME,
+                        cOTA_JSON_FileSignatureKey, eResult );
+
+            /* If we fail to verify the file signature that means the image is not valid. We need to set the image state to aborted. */
+            prvPAL_SetPlatformImageState( eOTA_ImageState_Aborted );
+        }
+    }
+    else /* Invalid OTA Context. */
+    {
+        OTA_LOG_L1( "[%s] ERROR - Invalid context.\r\n", OTA_METHOD_NAME );
+        /* No receive file is open for this context. */
+        eResult = ( kOTA_Err_FileClose | ( EBADF & kOTA_PAL_ErrMask ) );
+    }
+
+    return eResult;
+}
+
+
+/* Verify the signature of the specified file. */
+
+static OTA_Err_t prvPAL_CheckFileSignature( OTA_FileContext_t * const C )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_CheckFileSignature" );
+
+    OTA_Err_t eResult = kOTA_Err_None;
+    uint32_t ulSignerCertSize;
+    uint8_t * pucSignerCert;
+    void * pvSigVerifyContext;
+
+    if( prvContextValidate( C ) == pdTRUE )
+    {
+        /* Verify an ECDSA-SHA256 signature. */
+        if( pdFALSE == CRYPTO_SignatureVerificationStart( &pvSigVerifyContext, cryptoASYMMETRIC_ALGORITHM_ECDSA, cryptoHASH_ALGORITHM_SHA256 ) )
+        {
+            eResult = kOTA_Err_SignatureCheckFailed;
+        }
+        else
+        {
+            OTA_LOG_L1( "[%s] Started %s signature verification, file: %s\r\n", OTA_METHOD_NAME,
+                        cOTA_JSON_FileSignatureKey, ( const char * ) C->pucCertFilepath );
+            pucSignerCert = prvPAL_ReadAndAssumeCertificate( ( const uint8_t * const ) C->pucCertFilepath, &ulSignerCertSize );
+
+            if( pucSignerCert != NULL )
+            {
+                /* Hash the image straight from the mapping. It is read front to back once. */
+                ( void ) madvise( xRxFile.pucImage, xRxFile.xImageSize, MADV_WILLNEED );
+                CRYPTO_SignatureVerificationUpdate( pvSigVerifyContext, xRxFile.pucImage, xRxFile.xImageSize );
+
+                if( pdFALSE == CRYPTO_SignatureVerificationFinal( pvSigVerifyContext,
+                                                                  ( char * ) pucSignerCert,
+                                                                  ( size_t ) ulSignerCertSize,
+                                                                  C->pxSignature->ucData,
+                                                                  C->pxSignature->usSize ) ) /*lint !e732 !e9034 Allow comparison in this context. */
+                {
+                    eResult = kOTA_Err_SignatureCheckFailed;
+                }
+
+                pvSigVerifyContext = NULL; /* The context has been freed by CRYPTO_SignatureVerificationFinal(). */
+
+                /* Free the signer certificate that we now own after prvReadAndAssumeCertificate(). */
+                vPortFree( pucSignerCert );
+            }
+            else
+            {
+                eResult = kOTA_Err_BadSignerCert;
+            }
+        }
+    }
+    else
+    {
+        OTA_LOG_L1( "[%s] ERROR - Invalid OTA file context.\r\n", OTA_METHOD_NAME );
+        /* The context has no mapped receive file to verify. */
+        eResult = kOTA_Err_NullFilePtr;
+    }
+
+    return eResult;
+}
+
+
+/* Read the specified signer certificate from the filesystem into a local buffer. The allocated
+ * memory becomes the property of the caller who is responsible for freeing it.
+ */
+
+static uint8_t * prvPAL_ReadAndAssumeCertificate( const uint8_t * const pucCertName,
+                                                  uint32_t * const ulSignerCertSize )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_ReadAndAssumeCertificate" );
+
+    FILE * pxFile;
+    uint8_t * pucSignerCert = NULL;
+    uint8_t * pucCertData = NULL;
+    int32_t lSize = 0; /* For MISRA mandatory. */
+    int32_t lLinuxError;
+
+    pxFile = fopen( ( const char * ) pucCertName, "rb" ); /*lint !e586
+                                                            * C standard library call is being used for portability. */
+
+    if( pxFile != NULL )
+    {
+        lLinuxError = fseek( pxFile, 0, SEEK_END );         /*lint !e586
+                                                              * C standard library call is being used for portability. */
+
+        if( lLinuxError == 0 )                               /* fseek returns a non-zero value on error. */
+        {
+            lSize = ( int32_t ) ftell( pxFile );             /*lint !e586 Allow call in this context. */
+
+            if( lSize != -1L )                               /* ftell returns -1 on error. */
+            {
+                lLinuxError = fseek( pxFile, 0, SEEK_SET ); /*lint !e586
+                                                              * C standard library call is being used for portability. */
+            }
+            else /* ftell returned an error, pucSignerCert remains NULL. */
+            {
+                lLinuxError = -1L;
+            }
+        } /* else fseek returned an error, pucSignerCert remains NULL. */
+
+        if( lLinuxError == 0 )
+        {
+            /* Allocate memory for the signer certificate plus a terminating zero so we can load and return it to the caller. */
+            pucSignerCert = pvPortMalloc( lSize + 1 ); /*lint !e732 !e9034 !e9079 Allow conversion. */
+        }
+
+        if( pucSignerCert != NULL )
+        {
+            if( fread( pucSignerCert, 1, lSize, pxFile ) == ( size_t ) lSize ) /*lint !e586 !e732 !e9034
+                                                                                 * C standard library call is being used for portability. */
+            {
+                /* The crypto code requires the terminating zero to be part of the length so add 1 to the size. */
+                *ulSignerCertSize = lSize + 1;
+                pucSignerCert[ lSize ] = 0;
+            }
+            else
+            {   /* There was a problem reading the certificate file so free the memory and abort. */
+                vPortFree( pucSignerCert );
+                pucSignerCert = NULL;
+            }
+        }
+        else
+        {
+            OTA_LOG_L1( "[%s] ERROR - Failed to allocate memory for signer cert contents.\r\n", OTA_METHOD_NAME );
+            /* Nothing special to do. */
+        }
+
+        lLinuxError = fclose( pxFile ); /*lint !e586
+                                          * C standard library call is being used for portability. */
+
+        if( lLinuxError != 0 )
+        {
+            OTA_LOG_L1( "[%s] ERROR - File pointer operation failed.\r\n", OTA_METHOD_NAME );
+            vPortFree( pucSignerCert );
+            pucSignerCert = NULL;
+        }
+    }
+    else
+    {
+        OTA_LOG_L1( "[%s] No such certificate file: %s. Using aws_ota_codesigner_certificate.h.\r\n", OTA_METHOD_NAME,
+                    ( const char * ) pucCertName );
+
+        /* Allocate memory for the signer certificate plus a terminating zero so we can copy it and return to the caller. */
+        lSize = sizeof( signingcredentialSIGNING_CERTIFICATE_PEM );
+        pucSignerCert = pvPortMalloc( lSize );                                /*lint !e9029 !e9079 !e838 malloc proto requires void*. */
+        pucCertData = ( uint8_t * ) signingcredentialSIGNING_CERTIFICATE_PEM; /*lint !e9005 we don't modify the cert but it could be set by PKCS11 so it's not const. */
+
+        if( pucSignerCert != NULL )
+        {
+            memcpy( pucSignerCert, pucCertData, lSize );
+            *ulSignerCertSize = lSize;
+        }
+        else
+        {
+            OTA_LOG_L1( "[%s] Error: No memory for certificate of size %d!\r\n", OTA_METHOD_NAME, lSize );
+        }
+    }
+
+    return pucSignerCert; /*lint !e480 !e481 fopen and fclose are being used by-design. */
+}
+
+/*-----------------------------------------------------------*/
+
+OTA_Err_t prvPAL_ResetDevice( void )
+{
+    /* Return no error.  Linux implementation does not reset device. */
+    return kOTA_Err_None;
+}
+
+/*-----------------------------------------------------------*/
+
+OTA_Err_t prvPAL_ActivateNewImage( void )
+{
+    /* Return no error. Linux implementation simply does nothing on activate.
+     * To run the new firmware image, start the newly downloaded executable. */
+    return kOTA_Err_None;
+}
+
+
+/*
+ * Set the final state of the last transferred (final) OTA file (or bundle).
+ * On Linux, the state of the OTA image is stored in PlatformImageState.txt.
+ */
+
+OTA_Err_t prvPAL_SetPlatformImageState( OTA_ImageState_t eState )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_SetPlatformImageState" );
+
+    OTA_Err_t eResult = kOTA_Err_None;
+    FILE * pstPlatformImageState;
+
+    if( ( eState != eOTA_ImageState_Unknown ) && ( eState <= eOTA_LastImageState ) )
+    {
+        pstPlatformImageState = fopen( "PlatformImageState.txt", "w+b" ); /*lint !e586
+                                                                           * C standard library call is being used for portability. */
+
+        if( pstPlatformImageState != NULL )
+        {
+            /* Write the image state to PlatformImageState.txt. */
+            if( 1 != fwrite( &eState, sizeof( OTA_ImageState_t ), 1, pstPlatformImageState ) ) /*lint !e586 !e9029
+                                                                                                * C standard library call is being used for portability. */
+            {
+                OTA_LOG_L1( "[%s] ERROR - Unable to write to image state file.\r\n", OTA_METHOD_NAME );
+                eResult = ( kOTA_Err_BadImageState | ( errno & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                      * Errno is being used in accordance with host API documentation.
+                                                                                      * Bitmasking is being used to preserve host API error with library status code. */
+            }
+
+            /* Close PlatformImageState.txt. */
+            if( 0 != fclose( pstPlatformImageState ) ) /*lint !e586 Allow call in this context. */
+            {
+                OTA_LOG_L1( "[%s] ERROR - Unable to close image state file.\r\n", OTA_METHOD_NAME );
+                eResult = ( kOTA_Err_BadImageState | ( errno & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                      * Errno is being used in accordance with host API documentation.
+                                                                                      * Bitmasking is being used to preserve host API error with library status code. */
+            }
+        }
+        else
+        {
+            OTA_LOG_L1( "[%s] ERROR - Unable to open image state file.\r\n", OTA_METHOD_NAME );
+            eResult = ( kOTA_Err_BadImageState | ( errno & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                  * Errno is being used in accordance with host API documentation.
+                                                                                  * Bitmasking is being used to preserve host API error with library status code. */
+        }
+    } /*lint !e481 Allow fopen and fclose calls in this context. */
+    else /* Image state invalid. */
+    {
+        OTA_LOG_L1( "[%s] ERROR - Invalid image state provided.\r\n", OTA_METHOD_NAME );
+        eResult = kOTA_Err_BadImageState;
+    }
+
+    return eResult; /*lint !e480 !e481 Allow calls to fopen and fclose in this context. */
+}
+
+/* Get the state of the currently running image.
+ *
+ * On Linux, this is simulated by looking for and reading the state from
+ * the PlatformImageState.txt file in the current working directory.
+ *
+ * We read this at OTA_Init time so we can tell if the image is in self
+ * test mode. If it is, we expect a successful connection to the OTA services
+ * within a reasonable amount of time. If we don't satisfy that requirement,
+ * we assume there is something wrong with the firmware and reset the device,
+ * causing it to rollback to the previous code. On Linux, this is not
+ * fully simulated as the process does not restart itself.
+ */
+OTA_PAL_ImageState_t prvPAL_GetPlatformImageState( void )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_GetPlatformImageState" );
+
+    FILE * pstPlatformImageState;
+    OTA_ImageState_t eSavedAgentState = eOTA_ImageState_Unknown;
+    OTA_PAL_ImageState_t ePalState = eOTA_PAL_ImageState_Unknown;
+
+    pstPlatformImageState = fopen( "PlatformImageState.txt", "r+b" ); /*lint !e586
+                                                                       * C standard library call is being used for portability. */
+
+    if( pstPlatformImageState != NULL )
+    {
+        if( 1 != fread( &eSavedAgentState, sizeof( OTA_ImageState_t ), 1, pstPlatformImageState ) ) /*lint !e586 !e9029
+                                                                                                     * C standard library call is being used for portability. */
+        {
+            /* If an error occured reading the file, mark the state as aborted. */
+            OTA_LOG_L1( "[%s] ERROR - Unable to read image state file.\r\n", OTA_METHOD_NAME );
+            ePalState = ( eOTA_PAL_ImageState_Invalid | ( errno & kOTA_PAL_ErrMask ) );
+        }
+        else
+        {
+            switch( eSavedAgentState )
+            {
+                case eOTA_ImageState_Testing:
+                    ePalState = eOTA_PAL_ImageState_PendingCommit;
+                    break;
+
+                case eOTA_ImageState_Accepted:
+                    ePalState = eOTA_PAL_ImageState_Valid;
+                    break;
+
+                case eOTA_ImageState_Rejected:
+                case eOTA_ImageState_Aborted:
+                default:
+                    ePalState = eOTA_PAL_ImageState_Invalid;
+                    break;
+            }
+        }
+
+        if( 0 != fclose( pstPlatformImageState ) ) /*lint !e586
+                                                    * C standard library call is being used for portability. */
+        {
+            OTA_LOG_L1( "[%s] ERROR - Unable to close image state file.\r\n", OTA_METHOD_NAME );
+            ePalState = ( eOTA_PAL_ImageState_Invalid | ( errno & kOTA_PAL_ErrMask ) );
+        }
+    }
+    else
+    {
+        /* If no image state file exists, assume a factory image. */
+        ePalState = eOTA_PAL_ImageState_Valid; /*lint !e64 Allow assignment. */
+    }
+
+    return ePalState; /*lint !e64 !e480 !e481 I/O calls and return type are used per design. */
+}
+
+/*-----------------------------------------------------------*/
+
+/* Provide access to private members for testing. */
+#ifdef FREERTOS_ENABLE_UNIT_TESTS
+    #include "aws_ota_pal_test_access_define.h"
+#endif
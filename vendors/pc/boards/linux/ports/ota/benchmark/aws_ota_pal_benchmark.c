@@ -0,0 +1,154 @@
+/*
+ * FreeRTOS OTA PAL for Linux Benchmark V1.0.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/* Measures how fast the Linux OTA PAL stores a received file.
+ *
+ * For each file size the benchmark creates the receive file, writes every block in
+ * ascending order the way the OTA agent does, and closes the file. The close includes
+ * the final flush and the signature hash over the whole image. The signature is all
+ * zeros, so the verification is expected to fail and the PAL marks
+ * PlatformImageState.txt as aborted. Run it from a scratch directory with room for the
+ * largest file.
+ *
+ * To use it, add this file to a Linux simulator build next to aws_ota_pal.c and call
+ * vOTA_PAL_Benchmark() from a task after the scheduler has started. */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "FreeRTOS.h"
+#include "aws_iot_ota_pal.h"
+#include "aws_iot_ota_agent_internal.h"
+
+/* Receive file written by the benchmark. It is removed after each run. */
+#ifndef OTA_PAL_BENCHMARK_FILE
+    #define OTA_PAL_BENCHMARK_FILE    "OTABenchmark.bin"
+#endif
+
+/* File sizes to measure, in megabytes. */
+static const uint32_t ulBenchmarkSizesMB[] = { 1UL, 16UL, 128UL, 512UL };
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvMonotonicUs( void )
+{
+    struct timespec xNow;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( ( uint64_t ) xNow.tv_sec * 1000000ULL ) + ( ( uint64_t ) xNow.tv_nsec / 1000ULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Receive one file of ulFileSize bytes. Returns the elapsed microseconds, or 0 if the
+ * PAL reported an error other than the expected signature failure. */
+
+static uint64_t prvBenchmarkFile( uint32_t ulFileSize )
+{
+    static uint8_t ucBlock[ OTA_FILE_BLOCK_SIZE ];
+    static Sig256_t xSignature;
+    OTA_FileContext_t xContext;
+    uint64_t ullStart, ullElapsed = 0;
+    uint32_t ulOffset, ulBlockSize;
+    OTA_Err_t eResult;
+
+    ( void ) memset( &xContext, 0x00, sizeof( xContext ) );
+    ( void ) memset( &xSignature, 0x00, sizeof( xSignature ) );
+    ( void ) memset( ucBlock, 0xa5, sizeof( ucBlock ) );
+
+    xSignature.usSize = 64U;
+    xContext.pucFilePath = ( uint8_t * ) OTA_PAL_BENCHMARK_FILE;
+    xContext.ulFileSize = ulFileSize;
+    xContext.pxSignature = &xSignature;
+    xContext.pucCertFilepath = ( uint8_t * ) "";
+
+    ullStart = prvMonotonicUs();
+
+    eResult = prvPAL_CreateFileForRx( &xContext );
+
+    for( ulOffset = 0; ( eResult == kOTA_Err_None ) && ( ulOffset < ulFileSize ); ulOffset += ulBlockSize )
+    {
+        ulBlockSize = ulFileSize - ulOffset;
+
+        if( ulBlockSize > OTA_FILE_BLOCK_SIZE )
+        {
+            ulBlockSize = OTA_FILE_BLOCK_SIZE;
+        }
+
+        if( prvPAL_WriteBlock( &xContext, ulOffset, ucBlock, ulBlockSize ) != ( int16_t ) ulBlockSize )
+        {
+            eResult = kOTA_Err_FileClose;
+            ( void ) prvPAL_Abort( &xContext );
+        }
+    }
+
+    if( eResult == kOTA_Err_None )
+    {
+        eResult = prvPAL_CloseFile( &xContext );
+
+        if( ( eResult == kOTA_Err_None ) || ( eResult == kOTA_Err_SignatureCheckFailed ) )
+        {
+            ullElapsed = prvMonotonicUs() - ullStart;
+        }
+    }
+
+    if( ullElapsed == 0U )
+    {
+        configPRINTF( ( "OTA PAL benchmark: %u byte file failed: 0x%08x\r\n", ulFileSize, eResult ) );
+    }
+
+    ( void ) unlink( OTA_PAL_BENCHMARK_FILE );
+
+    return ullElapsed;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Receive a file of each size in ulBenchmarkSizesMB and print the throughput. */
+
+void vOTA_PAL_Benchmark( void )
+{
+    uint32_t ulIndex, ulFileSize;
+    uint64_t ullElapsed;
+
+    for( ulIndex = 0; ulIndex < ( sizeof( ulBenchmarkSizesMB ) / sizeof( ulBenchmarkSizesMB[ 0 ] ) ); ulIndex++ )
+    {
+        ulFileSize = ulBenchmarkSizesMB[ ulIndex ] * 1024UL * 1024UL;
+        ullElapsed = prvBenchmarkFile( ulFileSize );
+
+        if( ullElapsed != 0U )
+        {
+            configPRINTF( ( "OTA PAL benchmark: %4u MB in %llu ms, %llu MB/s, %u byte blocks.\r\n",
+                            ulBenchmarkSizesMB[ ulIndex ],
+                            ( unsigned long long ) ( ullElapsed / 1000U ),
+                            ( unsigned long long ) ( ( ( uint64_t ) ulBenchmarkSizesMB[ ulIndex ] * 1000000ULL ) / ullElapsed ),
+                            ( uint32_t ) OTA_FILE_BLOCK_SIZE ) );
+        }
+    }
+}
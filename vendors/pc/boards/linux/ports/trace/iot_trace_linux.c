@@ -0,0 +1,383 @@
+/*
+ * FreeRTOS Trace for Linux V1.0.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_trace_linux.c
+ * @brief Event tracing for the Linux simulator.
+ *
+ * The file starts with a header (magic, version, record size) followed by
+ * fixed size records. A name record is followed by IOT_TRACE_LINUX_NAME_LENGTH
+ * bytes holding the name.
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "iot_trace_linux.h"
+
+#if ( IOT_TRACE_LINUX_BUFFER_EVENTS & ( IOT_TRACE_LINUX_BUFFER_EVENTS - 1U ) ) != 0U
+    #error "IOT_TRACE_LINUX_BUFFER_EVENTS must be a power of 2."
+#endif
+
+#define TRACE_MAGIC      "IOTTRACE"
+#define TRACE_VERSION    1U
+
+/* Keeps the producer and consumer indexes of a buffer on separate cache lines. */
+#define TRACE_CACHE_LINE    64
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief One event as written to the file.
+ */
+typedef struct TraceRecord
+{
+    uint64_t ullTimestampNs; /* CLOCK_MONOTONIC. */
+    uint64_t ullObject;
+    uint64_t ullArg;
+    uint32_t ulThreadId;     /* Linux thread id of the recording thread. */
+    uint32_t ulType;
+} TraceRecord_t;
+
+/**
+ * @brief Ring buffer written only by its owning thread and read only by the writer thread.
+ */
+typedef struct TraceBuffer
+{
+    uint64_t ullHead __attribute__( ( aligned( TRACE_CACHE_LINE ) ) ); /* Next slot to write, owned by the producer. */
+    uint64_t ullDropped;
+    uint32_t ulThreadId;
+    uint64_t ullTail __attribute__( ( aligned( TRACE_CACHE_LINE ) ) ); /* Next slot to read, owned by the writer. */
+    TraceRecord_t xRecords[ IOT_TRACE_LINUX_BUFFER_EVENTS ];
+} TraceBuffer_t;
+
+/**
+ * @brief A task or queue name. Published by setting ulReady once the rest is filled in.
+ */
+typedef struct TraceName
+{
+    TraceRecord_t xRecord;
+    char cName[ IOT_TRACE_LINUX_NAME_LENGTH ];
+    uint32_t ulReady;
+} TraceName_t;
+
+/*-----------------------------------------------------------*/
+
+static TraceBuffer_t xBuffers[ IOT_TRACE_LINUX_MAX_THREADS ];
+static uint32_t ulBuffersUsed = 0;
+static uint64_t ullNoBufferDropped = 0;
+
+static TraceName_t xNames[ IOT_TRACE_LINUX_MAX_NAMES ];
+static uint32_t ulNamesUsed = 0;
+static uint32_t ulNamesWritten = 0;
+
+static __thread TraceBuffer_t * pxThreadBuffer = NULL;
+static __thread int xThreadHasNoBuffer = 0;
+static __thread volatile int xThreadRecording = 0;
+
+static uint32_t ulTracing = 0;
+static uint32_t ulWriterRunning = 0;
+static int xStarted = 0;
+static FILE * pxTraceFile = NULL;
+static pthread_t xWriterThread;
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNow( void )
+{
+    struct timespec xTime;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+    return ( ( uint64_t ) xTime.tv_sec * 1000000000ULL ) + ( uint64_t ) xTime.tv_nsec;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Claim a buffer for the calling thread. Only atomics are used, as the first
+ * event of a thread may be recorded from a signal handler. */
+static TraceBuffer_t * prvThreadBuffer( void )
+{
+    uint32_t ulIndex;
+
+    if( ( pxThreadBuffer == NULL ) && ( xThreadHasNoBuffer == 0 ) )
+    {
+        ulIndex = __atomic_fetch_add( &ulBuffersUsed, 1U, __ATOMIC_RELAXED );
+
+        if( ulIndex < IOT_TRACE_LINUX_MAX_THREADS )
+        {
+            pxThreadBuffer = &xBuffers[ ulIndex ];
+            pxThreadBuffer->ulThreadId = ( uint32_t ) syscall( SYS_gettid );
+        }
+        else
+        {
+            xThreadHasNoBuffer = 1;
+        }
+    }
+
+    return pxThreadBuffer;
+}
+
+/*-----------------------------------------------------------*/
+
+void IotTraceLinux_Record( uint32_t ulType,
+                           const void * pvObject,
+                           uint64_t ullArg )
+{
+    TraceBuffer_t * pxBuffer;
+    TraceRecord_t * pxRecord;
+    uint64_t ullHead;
+
+    if( __atomic_load_n( &ulTracing, __ATOMIC_RELAXED ) != 0U )
+    {
+        pxBuffer = prvThreadBuffer();
+
+        if( pxBuffer == NULL )
+        {
+            ( void ) __atomic_fetch_add( &ullNoBufferDropped, 1U, __ATOMIC_RELAXED );
+        }
+        else if( xThreadRecording != 0 )
+        {
+            /* A signal handler interrupted this thread while it was recording.
+             * Writing now would reuse the slot the interrupted call is filling in. */
+            ( void ) __atomic_fetch_add( &pxBuffer->ullDropped, 1U, __ATOMIC_RELAXED );
+        }
+        else
+        {
+            xThreadRecording = 1;
+
+            /* Only this thread moves the head, so it can be read without ordering. */
+            ullHead = pxBuffer->ullHead;
+
+            if( ( ullHead - __atomic_load_n( &pxBuffer->ullTail, __ATOMIC_ACQUIRE ) ) >= IOT_TRACE_LINUX_BUFFER_EVENTS )
+            {
+                ( void ) __atomic_fetch_add( &pxBuffer->ullDropped, 1U, __ATOMIC_RELAXED );
+            }
+            else
+            {
+                pxRecord = &pxBuffer->xRecords[ ullHead & ( IOT_TRACE_LINUX_BUFFER_EVENTS - 1U ) ];
+                pxRecord->ullTimestampNs = prvNow();
+                pxRecord->ullObject = ( uint64_t ) ( uintptr_t ) pvObject;
+                pxRecord->ullArg = ullArg;
+                pxRecord->ulThreadId = pxBuffer->ulThreadId;
+                pxRecord->ulType = ulType;
+
+                /* Publish the record to the writer. */
+                __atomic_store_n( &pxBuffer->ullHead, ullHead + 1U, __ATOMIC_RELEASE );
+            }
+
+            xThreadRecording = 0;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void IotTraceLinux_Name( const void * pvObject,
+                         const char * pcName )
+{
+    uint32_t ulIndex;
+    TraceName_t * pxName;
+
+    /* Names are kept even before tracing starts so that tasks and queues created
+     * early still show up by name. */
+    ulIndex = __atomic_fetch_add( &ulNamesUsed, 1U, __ATOMIC_RELAXED );
+
+    if( ulIndex < IOT_TRACE_LINUX_MAX_NAMES )
+    {
+        pxName = &xNames[ ulIndex ];
+        pxName->xRecord.ullTimestampNs = prvNow();
+        pxName->xRecord.ullObject = ( uint64_t ) ( uintptr_t ) pvObject;
+        pxName->xRecord.ulThreadId = ( uint32_t ) syscall( SYS_gettid );
+        pxName->xRecord.ulType = IOT_TRACE_LINUX_NAME;
+
+        if( pcName != NULL )
+        {
+            ( void ) strncpy( pxName->cName, pcName, IOT_TRACE_LINUX_NAME_LENGTH - 1U );
+        }
+
+        __atomic_store_n( &pxName->ulReady, 1U, __ATOMIC_RELEASE );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Write out every record published so far. Only called by one thread at a time. */
+static void prvDrain( void )
+{
+    uint32_t ulCount;
+    uint32_t ulIndex;
+    uint64_t ullHead;
+    uint64_t ullTail;
+    TraceBuffer_t * pxBuffer;
+
+    ulCount = __atomic_load_n( &ulNamesUsed, __ATOMIC_RELAXED );
+
+    if( ulCount > IOT_TRACE_LINUX_MAX_NAMES )
+    {
+        ulCount = IOT_TRACE_LINUX_MAX_NAMES;
+    }
+
+    /* Names are written in order, stopping at the first one still being filled in. */
+    while( ( ulNamesWritten < ulCount ) &&
+           ( __atomic_load_n( &xNames[ ulNamesWritten ].ulReady, __ATOMIC_ACQUIRE ) != 0U ) )
+    {
+        ( void ) fwrite( &xNames[ ulNamesWritten ].xRecord, sizeof( TraceRecord_t ), 1, pxTraceFile );
+        ( void ) fwrite( xNames[ ulNamesWritten ].cName, IOT_TRACE_LINUX_NAME_LENGTH, 1, pxTraceFile );
+        ulNamesWritten++;
+    }
+
+    ulCount = __atomic_load_n( &ulBuffersUsed, __ATOMIC_RELAXED );
+
+    if( ulCount > IOT_TRACE_LINUX_MAX_THREADS )
+    {
+        ulCount = IOT_TRACE_LINUX_MAX_THREADS;
+    }
+
+    for( ulIndex = 0; ulIndex < ulCount; ulIndex++ )
+    {
+        pxBuffer = &xBuffers[ ulIndex ];
+        ullHead = __atomic_load_n( &pxBuffer->ullHead, __ATOMIC_ACQUIRE );
+
+        for( ullTail = pxBuffer->ullTail; ullTail != ullHead; ullTail++ )
+        {
+            ( void ) fwrite( &pxBuffer->xRecords[ ullTail & ( IOT_TRACE_LINUX_BUFFER_EVENTS - 1U ) ],
+                             sizeof( TraceRecord_t ), 1, pxTraceFile );
+        }
+
+        /* Hand the slots back to the producer. */
+        __atomic_store_n( &pxBuffer->ullTail, ullHead, __ATOMIC_RELEASE );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void * prvWriterThread( void * pvArg )
+{
+    struct timespec xPeriod;
+
+    ( void ) pvArg;
+
+    xPeriod.tv_sec = IOT_TRACE_LINUX_FLUSH_PERIOD_MS / 1000U;
+    xPeriod.tv_nsec = ( long ) ( IOT_TRACE_LINUX_FLUSH_PERIOD_MS % 1000U ) * 1000000L;
+
+    while( __atomic_load_n( &ulWriterRunning, __ATOMIC_ACQUIRE ) != 0U )
+    {
+        ( void ) nanosleep( &xPeriod, NULL );
+        prvDrain();
+    }
+
+    return NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+int IotTraceLinux_Start( const char * pcPath )
+{
+    int xResult = -1;
+    uint32_t ulHeader[ 2 ] = { TRACE_VERSION, ( uint32_t ) sizeof( TraceRecord_t ) };
+    sigset_t xAllSignals;
+    sigset_t xOldSignals;
+
+    if( xStarted == 0 )
+    {
+        pxTraceFile = fopen( pcPath, "wb" );
+
+        if( pxTraceFile != NULL )
+        {
+            ( void ) fwrite( TRACE_MAGIC, strlen( TRACE_MAGIC ), 1, pxTraceFile );
+            ( void ) fwrite( ulHeader, sizeof( ulHeader ), 1, pxTraceFile );
+
+            __atomic_store_n( &ulWriterRunning, 1U, __ATOMIC_RELEASE );
+
+            /* The writer inherits a fully blocked signal mask, so the simulator's
+             * tick and yield signals are never delivered to it. */
+            ( void ) sigfillset( &xAllSignals );
+            ( void ) pthread_sigmask( SIG_SETMASK, &xAllSignals, &xOldSignals );
+
+            if( pthread_create( &xWriterThread, NULL, prvWriterThread, NULL ) == 0 )
+            {
+                xStarted = 1;
+                __atomic_store_n( &ulTracing, 1U, __ATOMIC_RELEASE );
+                xResult = 0;
+            }
+            else
+            {
+                ( void ) fclose( pxTraceFile );
+                pxTraceFile = NULL;
+            }
+
+            ( void ) pthread_sigmask( SIG_SETMASK, &xOldSignals, NULL );
+        }
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+void IotTraceLinux_Stop( void )
+{
+    if( pxTraceFile != NULL )
+    {
+        __atomic_store_n( &ulTracing, 0U, __ATOMIC_RELEASE );
+        __atomic_store_n( &ulWriterRunning, 0U, __ATOMIC_RELEASE );
+        ( void ) pthread_join( xWriterThread, NULL );
+
+        /* Pick up whatever was recorded since the writer's last pass. */
+        prvDrain();
+
+        ( void ) fclose( pxTraceFile );
+        pxTraceFile = NULL;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+uint64_t IotTraceLinux_GetDropped( void )
+{
+    uint64_t ullDropped = __atomic_load_n( &ullNoBufferDropped, __ATOMIC_RELAXED );
+    uint32_t ulCount = __atomic_load_n( &ulBuffersUsed, __ATOMIC_RELAXED );
+    uint32_t ulIndex;
+
+    if( ulCount > IOT_TRACE_LINUX_MAX_THREADS )
+    {
+        ulCount = IOT_TRACE_LINUX_MAX_THREADS;
+    }
+
+    for( ulIndex = 0; ulIndex < ulCount; ulIndex++ )
+    {
+        ullDropped += __atomic_load_n( &xBuffers[ ulIndex ].ullDropped, __ATOMIC_RELAXED );
+    }
+
+    return ullDropped;
+}
@@ -0,0 +1,164 @@
+/*
+ * FreeRTOS Trace for Linux V1.0.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_trace_linux.h
+ * @brief Event tracing for the Linux simulator.
+ *
+ * Every thread that records an event gets its own single producer ring buffer,
+ * so recording never takes a lock and is safe from the simulator's tick signal.
+ * A background thread drains the buffers into a binary file, which
+ * tools/trace/iot_trace_to_json.py converts to Chrome Trace Event JSON for
+ * chrome://tracing or Perfetto.
+ *
+ * To use it, include this header at the end of FreeRTOSConfig.h in place of
+ * trcRecorder.h and from iot_config.h, then call IotTraceLinux_Start() before
+ * starting the scheduler.
+ */
+
+#ifndef IOT_TRACE_LINUX_H_
+#define IOT_TRACE_LINUX_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Number of events each thread can hold before the writer drains them.
+ * Must be a power of 2. Events recorded while a buffer is full are dropped and
+ * counted.
+ */
+#ifndef IOT_TRACE_LINUX_BUFFER_EVENTS
+    #define IOT_TRACE_LINUX_BUFFER_EVENTS    4096U
+#endif
+
+/**
+ * @brief Number of threads that can record events. The buffers are allocated
+ * statically so that a thread's first event does not need the heap.
+ */
+#ifndef IOT_TRACE_LINUX_MAX_THREADS
+    #define IOT_TRACE_LINUX_MAX_THREADS    64U
+#endif
+
+/**
+ * @brief Number of task and queue names that can be recorded.
+ */
+#ifndef IOT_TRACE_LINUX_MAX_NAMES
+    #define IOT_TRACE_LINUX_MAX_NAMES    256U
+#endif
+
+/**
+ * @brief How often the writer thread drains the buffers, in milliseconds.
+ */
+#ifndef IOT_TRACE_LINUX_FLUSH_PERIOD_MS
+    #define IOT_TRACE_LINUX_FLUSH_PERIOD_MS    10U
+#endif
+
+/**
+ * @brief Longest name kept, including the terminating NUL.
+ */
+#define IOT_TRACE_LINUX_NAME_LENGTH    24U
+
+/**
+ * @brief Event types. The values are part of the file format.
+ */
+#define IOT_TRACE_LINUX_TASK_SWITCHED_IN     1U  /* Object is the TCB. */
+#define IOT_TRACE_LINUX_TASK_SWITCHED_OUT    2U  /* Object is the TCB. */
+#define IOT_TRACE_LINUX_TASK_CREATE          3U  /* Object is the TCB. */
+#define IOT_TRACE_LINUX_TASK_DELETE          4U  /* Object is the TCB. */
+#define IOT_TRACE_LINUX_QUEUE_SEND           5U  /* Object is the queue, argument is the items waiting before the send. */
+#define IOT_TRACE_LINUX_QUEUE_RECEIVE        6U  /* Object is the queue, argument is the items waiting before the receive. */
+#define IOT_TRACE_LINUX_QUEUE_BLOCK_SEND     7U  /* Object is the queue. */
+#define IOT_TRACE_LINUX_QUEUE_BLOCK_RECEIVE  8U  /* Object is the queue. */
+#define IOT_TRACE_LINUX_JOB_SCHEDULED        9U  /* Object is the job. */
+#define IOT_TRACE_LINUX_JOB_DEFERRED         10U /* Object is the job, argument is the delay in milliseconds. */
+#define IOT_TRACE_LINUX_JOB_STARTED          11U /* Object is the job, argument is its callback. */
+#define IOT_TRACE_LINUX_JOB_FINISHED         12U /* Object is the job. */
+#define IOT_TRACE_LINUX_JOB_CANCELED         13U /* Object is the job. */
+#define IOT_TRACE_LINUX_NAME                 14U /* Object is named by a name record. */
+
+/**
+ * @brief Start tracing to a file.
+ *
+ * Tracing can only be started once per process.
+ *
+ * @param[in] pcPath File the trace is written to.
+ *
+ * @return 0 on success, -1 if the file or the writer thread cannot be created.
+ */
+int IotTraceLinux_Start( const char * pcPath );
+
+/**
+ * @brief Stop tracing, write out everything recorded so far and close the file.
+ */
+void IotTraceLinux_Stop( void );
+
+/**
+ * @brief Record an event on the calling thread. Does nothing unless tracing
+ * has been started.
+ *
+ * @param[in] ulType One of the IOT_TRACE_LINUX_* event types.
+ * @param[in] pvObject Task, queue or job the event is about.
+ * @param[in] ullArg Event specific argument.
+ */
+void IotTraceLinux_Record( uint32_t ulType,
+                           const void * pvObject,
+                           uint64_t ullArg );
+
+/**
+ * @brief Record the name of a task or queue.
+ */
+void IotTraceLinux_Name( const void * pvObject,
+                         const char * pcName );
+
+/**
+ * @brief Number of events dropped because a buffer was full.
+ */
+uint64_t IotTraceLinux_GetDropped( void );
+
+/* Kernel trace hooks. They are expanded inside tasks.c and queue.c, where the
+ * TCB and queue structures are visible. */
+#define traceTASK_CREATE( pxNewTCB )                                                 \
+    do {                                                                             \
+        IotTraceLinux_Name( ( pxNewTCB ), ( pxNewTCB )->pcTaskName );                \
+        IotTraceLinux_Record( IOT_TRACE_LINUX_TASK_CREATE, ( pxNewTCB ), 0U );       \
+    } while( 0 )
+#define traceTASK_DELETE( pxTaskToDelete )              IotTraceLinux_Record( IOT_TRACE_LINUX_TASK_DELETE, ( pxTaskToDelete ), 0U )
+#define traceTASK_SWITCHED_IN()                         IotTraceLinux_Record( IOT_TRACE_LINUX_TASK_SWITCHED_IN, pxCurrentTCB, 0U )
+#define traceTASK_SWITCHED_OUT()                        IotTraceLinux_Record( IOT_TRACE_LINUX_TASK_SWITCHED_OUT, pxCurrentTCB, 0U )
+#define traceQUEUE_SEND( pxQueue )                      IotTraceLinux_Record( IOT_TRACE_LINUX_QUEUE_SEND, ( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )             IotTraceLinux_Record( IOT_TRACE_LINUX_QUEUE_SEND, ( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_RECEIVE( pxQueue )                   IotTraceLinux_Record( IOT_TRACE_LINUX_QUEUE_RECEIVE, ( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )          IotTraceLinux_Record( IOT_TRACE_LINUX_QUEUE_RECEIVE, ( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )          IotTraceLinux_Record( IOT_TRACE_LINUX_QUEUE_BLOCK_SEND, ( pxQueue ), 0U )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )       IotTraceLinux_Record( IOT_TRACE_LINUX_QUEUE_BLOCK_RECEIVE, ( pxQueue ), 0U )
+#define traceQUEUE_REGISTRY_ADD( xQueue, pcQueueName )  IotTraceLinux_Name( ( xQueue ), ( pcQueueName ) )
+
+/* Task pool job hooks, see iot_taskpool_internal.h. */
+#define IotTaskPool_TraceJobScheduled( pJob )           IotTraceLinux_Record( IOT_TRACE_LINUX_JOB_SCHEDULED, ( pJob ), 0U )
+#define IotTaskPool_TraceJobDeferred( pJob, timeMs )    IotTraceLinux_Record( IOT_TRACE_LINUX_JOB_DEFERRED, ( pJob ), ( timeMs ) )
+#define IotTaskPool_TraceJobStarted( pJob )             IotTraceLinux_Record( IOT_TRACE_LINUX_JOB_STARTED, ( pJob ), ( uint64_t ) ( uintptr_t ) ( pJob )->userCallback )
+#define IotTaskPool_TraceJobFinished( pJob )            IotTraceLinux_Record( IOT_TRACE_LINUX_JOB_FINISHED, ( pJob ), 0U )
+#define IotTaskPool_TraceJobCanceled( pJob )            IotTraceLinux_Record( IOT_TRACE_LINUX_JOB_CANCELED, ( pJob ), 0U )
+
+#endif /* ifndef IOT_TRACE_LINUX_H_ */
@@ -0,0 +1,281 @@
+/*
+ * FreeRTOS Trace for Linux V1.0.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_trace_linux_utest.c
+ * @brief Records from several pthreads and their signal handlers, then reads
+ * the trace file back. The same test is also built with ThreadSanitizer.
+ */
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <unity.h>
+
+#include "iot_trace_linux.h"
+
+/* Layout of the file, as read by tools/trace/iot_trace_to_json.py. */
+#define TRACE_MAGIC          "IOTTRACE"
+#define TRACE_HEADER_SIZE    16U
+#define TRACE_RECORD_SIZE    32U
+
+#define TEST_THREADS            8U
+#define TEST_EVENTS_PER_THREAD  20000U
+#define TEST_SIGNAL_PERIOD      1000U
+
+/* Events recorded from the signal handler carry this bit in their argument. */
+#define TEST_SIGNAL_ARG         ( 1ULL << 63 )
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static char cTracePath[] = "/tmp/iot_trace_linux_utestXXXXXX";
+static const char * const pcQueueName = "test queue";
+static int xQueue;
+
+static __thread uint64_t ullSignalCount = 0;
+
+/*******************************************************************************
+ * Internal helpers
+ ******************************************************************************/
+
+/* One decoded record. */
+typedef struct TestRecord
+{
+    uint64_t ullTimestampNs;
+    uint64_t ullObject;
+    uint64_t ullArg;
+    uint32_t ulThreadId;
+    uint32_t ulType;
+} TestRecord_t;
+
+/* What the file holds for one recording thread. */
+typedef struct TestThread
+{
+    uint32_t ulThreadId;
+    uint64_t ullEvents;
+    uint64_t ullSignalEvents;
+    uint64_t ullLastArg;
+    uint64_t ullLastSignalArg;
+    uint64_t ullLastTimestampNs;
+} TestThread_t;
+
+static void prvSignalHandler( int xSignal )
+{
+    ( void ) xSignal;
+
+    ullSignalCount++;
+    IotTraceLinux_Record( IOT_TRACE_LINUX_QUEUE_BLOCK_SEND, &xQueue, TEST_SIGNAL_ARG | ullSignalCount );
+}
+
+static void * prvRecordingThread( void * pvArg )
+{
+    uint64_t ullIndex;
+
+    ( void ) pvArg;
+
+    for( ullIndex = 1; ullIndex <= TEST_EVENTS_PER_THREAD; ullIndex++ )
+    {
+        IotTraceLinux_Record( IOT_TRACE_LINUX_QUEUE_SEND, &xQueue, ullIndex );
+
+        if( ( ullIndex % TEST_SIGNAL_PERIOD ) == 0U )
+        {
+            ( void ) pthread_kill( pthread_self(), SIGUSR1 );
+        }
+    }
+
+    return NULL;
+}
+
+static void prvReadRecord( const uint8_t * pucData,
+                           TestRecord_t * pxRecord )
+{
+    memcpy( &pxRecord->ullTimestampNs, pucData, 8 );
+    memcpy( &pxRecord->ullObject, pucData + 8, 8 );
+    memcpy( &pxRecord->ullArg, pucData + 16, 8 );
+    memcpy( &pxRecord->ulThreadId, pucData + 24, 4 );
+    memcpy( &pxRecord->ulType, pucData + 28, 4 );
+}
+
+static TestThread_t * prvFindThread( TestThread_t * pxThreads,
+                                     size_t * pxThreadCount,
+                                     uint32_t ulThreadId )
+{
+    size_t xIndex;
+
+    for( xIndex = 0; xIndex < *pxThreadCount; xIndex++ )
+    {
+        if( pxThreads[ xIndex ].ulThreadId == ulThreadId )
+        {
+            return &pxThreads[ xIndex ];
+        }
+    }
+
+    TEST_ASSERT_LESS_THAN( TEST_THREADS, *pxThreadCount );
+    memset( &pxThreads[ *pxThreadCount ], 0, sizeof( TestThread_t ) );
+    pxThreads[ *pxThreadCount ].ulThreadId = ulThreadId;
+
+    return &pxThreads[ ( *pxThreadCount )++ ];
+}
+
+/*******************************************************************************
+ * Unity fixtures
+ ******************************************************************************/
+void setUp( void )
+{
+}
+
+void tearDown( void )
+{
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+/**
+ * @brief Events from concurrent threads and their signal handlers are written
+ * once each and in order per thread, or counted as dropped.
+ */
+void test_IotTraceLinux_ConcurrentThreads( void )
+{
+    pthread_t xThreads[ TEST_THREADS ];
+    TestThread_t xSeen[ TEST_THREADS ];
+    size_t xSeenCount = 0;
+    TestThread_t * pxThread;
+    TestRecord_t xRecord;
+    struct sigaction xAction;
+    uint8_t * pucData;
+    long lSize;
+    long lOffset;
+    FILE * pxFile;
+    uint32_t ulIndex;
+    uint32_t ulHeader[ 2 ];
+    uint64_t ullEvents = 0;
+    uint64_t ullSignalEvents = 0;
+    int xNames = 0;
+    int xFd;
+
+    memset( &xAction, 0, sizeof( xAction ) );
+    xAction.sa_handler = prvSignalHandler;
+    TEST_ASSERT_EQUAL_INT( 0, sigaction( SIGUSR1, &xAction, NULL ) );
+
+    xFd = mkstemp( cTracePath );
+    TEST_ASSERT_NOT_EQUAL( -1, xFd );
+    ( void ) close( xFd );
+
+    /* Names are kept from before the start, events are not recorded. */
+    IotTraceLinux_Name( &xQueue, pcQueueName );
+    IotTraceLinux_Record( IOT_TRACE_LINUX_QUEUE_SEND, &xQueue, 0U );
+
+    TEST_ASSERT_EQUAL_INT( 0, IotTraceLinux_Start( cTracePath ) );
+
+    for( ulIndex = 0; ulIndex < TEST_THREADS; ulIndex++ )
+    {
+        TEST_ASSERT_EQUAL_INT( 0, pthread_create( &xThreads[ ulIndex ], NULL, prvRecordingThread, NULL ) );
+    }
+
+    for( ulIndex = 0; ulIndex < TEST_THREADS; ulIndex++ )
+    {
+        TEST_ASSERT_EQUAL_INT( 0, pthread_join( xThreads[ ulIndex ], NULL ) );
+    }
+
+    IotTraceLinux_Stop();
+
+    /* A second start is refused. */
+    TEST_ASSERT_EQUAL_INT( -1, IotTraceLinux_Start( cTracePath ) );
+
+    pxFile = fopen( cTracePath, "rb" );
+    TEST_ASSERT_NOT_NULL( pxFile );
+    TEST_ASSERT_EQUAL_INT( 0, fseek( pxFile, 0, SEEK_END ) );
+    lSize = ftell( pxFile );
+    rewind( pxFile );
+    pucData = malloc( ( size_t ) lSize );
+    TEST_ASSERT_NOT_NULL( pucData );
+    TEST_ASSERT_EQUAL( 1, fread( pucData, ( size_t ) lSize, 1, pxFile ) );
+    ( void ) fclose( pxFile );
+    ( void ) unlink( cTracePath );
+
+    TEST_ASSERT_EQUAL_MEMORY( TRACE_MAGIC, pucData, strlen( TRACE_MAGIC ) );
+    memcpy( ulHeader, pucData + strlen( TRACE_MAGIC ), sizeof( ulHeader ) );
+    TEST_ASSERT_EQUAL_UINT32( 1, ulHeader[ 0 ] );
+    TEST_ASSERT_EQUAL_UINT32( TRACE_RECORD_SIZE, ulHeader[ 1 ] );
+
+    for( lOffset = TRACE_HEADER_SIZE; lOffset < lSize; lOffset += TRACE_RECORD_SIZE )
+    {
+        TEST_ASSERT_LESS_OR_EQUAL( lSize, lOffset + TRACE_RECORD_SIZE );
+        prvReadRecord( pucData + lOffset, &xRecord );
+        TEST_ASSERT_EQUAL_PTR( &xQueue, ( void * ) ( uintptr_t ) xRecord.ullObject );
+
+        if( xRecord.ulType == IOT_TRACE_LINUX_NAME )
+        {
+            TEST_ASSERT_LESS_OR_EQUAL( lSize, lOffset + TRACE_RECORD_SIZE + IOT_TRACE_LINUX_NAME_LENGTH );
+            TEST_ASSERT_EQUAL_STRING( pcQueueName, ( const char * ) ( pucData + lOffset + TRACE_RECORD_SIZE ) );
+            lOffset += IOT_TRACE_LINUX_NAME_LENGTH;
+            xNames++;
+            continue;
+        }
+
+        pxThread = prvFindThread( xSeen, &xSeenCount, xRecord.ulThreadId );
+
+        /* Records of one thread are written in the order they were recorded,
+         * so their timestamps never go back. */
+        TEST_ASSERT_TRUE( xRecord.ullTimestampNs >= pxThread->ullLastTimestampNs );
+        pxThread->ullLastTimestampNs = xRecord.ullTimestampNs;
+
+        if( xRecord.ulType == IOT_TRACE_LINUX_QUEUE_BLOCK_SEND )
+        {
+            TEST_ASSERT_TRUE( ( xRecord.ullArg & TEST_SIGNAL_ARG ) != 0U );
+            TEST_ASSERT_TRUE( xRecord.ullArg > pxThread->ullLastSignalArg );
+            pxThread->ullLastSignalArg = xRecord.ullArg;
+            pxThread->ullSignalEvents++;
+        }
+        else
+        {
+            TEST_ASSERT_EQUAL_UINT32( IOT_TRACE_LINUX_QUEUE_SEND, xRecord.ulType );
+            TEST_ASSERT_TRUE( xRecord.ullArg > pxThread->ullLastArg );
+            TEST_ASSERT_TRUE( xRecord.ullArg <= TEST_EVENTS_PER_THREAD );
+            pxThread->ullLastArg = xRecord.ullArg;
+            pxThread->ullEvents++;
+        }
+    }
+
+    free( pucData );
+
+    for( ulIndex = 0; ulIndex < xSeenCount; ulIndex++ )
+    {
+        ullEvents += xSeen[ ulIndex ].ullEvents;
+        ullSignalEvents += xSeen[ ulIndex ].ullSignalEvents;
+    }
+
+    /* Every event was either written or counted as dropped. */
+    TEST_ASSERT_EQUAL_INT( 1, xNames );
+    TEST_ASSERT_TRUE( ullEvents + ullSignalEvents + IotTraceLinux_GetDropped() ==
+                      ( uint64_t ) TEST_THREADS * ( TEST_EVENTS_PER_THREAD + ( TEST_EVENTS_PER_THREAD / TEST_SIGNAL_PERIOD ) ) );
+}
@@ -229,6 +229,9 @@ extern void vLoggingPrint(const char* pcMessage);
 extern uint32_t ulRand();
 #define configRAND32()    ulRand()
 
+/* Retry backoff jitter drawn from the DRBG shared with TLS. */
+#define retryutilsconfigGENERATE_RANDOM    TLS_GenerateRandom
+
 /* The platform that FreeRTOS is running on. */
 #define configPLATFORM_NAME    "WinSim"
 